@@ -32,6 +32,7 @@
 
 #include <fstream>
 #include <memory>
+#include <set>
 
 #include <binder/IBinder.h>
 #include <binder/IServiceManager.h>
@@ -649,21 +650,21 @@ static bool setAppCmdlineProperty(char* cmdline)
     return true;
 }
 
-// Disable all /sys/ enable files.
-static bool disableKernelTraceEvents() {
+// Disable all /sys/ enable files, except for the ones in keepEnabled.
+static bool disableKernelTraceEvents(const std::set<std::string>& keepEnabled = {}) {
     bool ok = true;
     for (size_t i = 0; i < arraysize(k_categories); i++) {
         const TracingCategory &c = k_categories[i];
         for (int j = 0; j < MAX_SYS_FILES; j++) {
             const char* path = c.sysfiles[j].path;
-            if (path != nullptr && fileIsWritable(path)) {
+            if (path != nullptr && keepEnabled.count(path) == 0 && fileIsWritable(path)) {
                 ok &= setKernelOptionEnable(path, false);
             }
         }
     }
     for (const TracingVendorFileCategory& c : g_vendorFileCategories) {
         for (const std::string& path : c.ftrace_enable_paths) {
-            if (fileIsWritable(path.c_str())) {
+            if (keepEnabled.count(path) == 0 && fileIsWritable(path.c_str())) {
                 ok &= setKernelOptionEnable(path.c_str(), false);
             }
         }
@@ -876,11 +877,9 @@ static bool setUpKernelTracing()
     ok &= setPrintTgidEnableIfPresent(true);
     ok &= setKernelTraceFuncs(g_kernelTraceFuncs);
 
-    // Disable all the sysfs enables.  This is done as a separate loop from
-    // the enables to allow the same enable to exist in multiple categories.
-    ok &= disableKernelTraceEvents();
-
-    // Enable all the sysfs enables that are in an enabled category.
+    // Collect all the sysfs enables that are in an enabled category.  The
+    // same enable may exist in multiple categories.
+    std::set<std::string> enables;
     for (size_t i = 0; i < arraysize(k_categories); i++) {
         if (g_categoryEnables[i]) {
             const TracingCategory &c = k_categories[i];
@@ -889,7 +888,7 @@ static bool setUpKernelTracing()
                 bool required = c.sysfiles[j].required == REQ;
                 if (path != nullptr) {
                     if (fileIsWritable(path)) {
-                        ok &= setKernelOptionEnable(path, true);
+                        enables.insert(path);
                     } else if (required) {
                         fprintf(stderr, "error writing file %s\n", path);
                         ok = false;
@@ -903,12 +902,21 @@ static bool setUpKernelTracing()
         if (c.enabled) {
             for (const std::string& path : c.ftrace_enable_paths) {
                 if (fileIsWritable(path.c_str())) {
-                    ok &= setKernelOptionEnable(path.c_str(), true);
+                    enables.insert(path);
                 }
             }
         }
     }
 
+    // Disable all the other sysfs enables.  Events that stay enabled are not
+    // toggled, since disabling an event unregisters its tracepoint probe and
+    // waits for an RCU grace period, only for the probe to be registered again.
+    ok &= disableKernelTraceEvents(enables);
+
+    for (const std::string& path : enables) {
+        ok &= setKernelOptionEnable(path.c_str(), true);
+    }
+
     return ok;
 }
 
@@ -244,6 +244,10 @@ static const std::string DUMP_HALS_TASK = "DUMP HALS";
 static const std::string DUMP_BOARD_TASK = "dumpstate_board()";
 static const std::string DUMP_CHECKINS_TASK = "DUMP CHECKINS";
 static const std::string POST_PROCESS_UI_TRACES_TASK = "POST-PROCESS UI TRACES";
+static const std::string TAKE_EARLY_SCREENSHOT_TASK = "TAKE EARLY SCREENSHOT";
+static const std::string SNAPSHOT_UI_TRACES_TASK = "SNAPSHOT UI TRACES";
+static const std::string DUMP_KERNEL_MODULES_TASK = "DUMP KERNEL MODULES";
+static const std::string DUMP_OPEN_FILES_TASK = "DUMP OPEN FILES";
 
 namespace android {
 namespace os {
@@ -839,9 +843,16 @@ static const std::set<std::string> PROBLEMATIC_FILE_EXTENSIONS = {
       ".shb", ".sys", ".vb",  ".vbe", ".vbs", ".vxd", ".wsc", ".wsf", ".wsh"
 };
 
+// List of file extensions whose content is already compressed, so deflating it again only costs
+// time. Entries with these extensions are stored as is.
+static const std::set<std::string> COMPRESSED_FILE_EXTENSIONS = {
+      ".br", ".bz2", ".gz", ".jpeg", ".jpg", ".lz4", ".png", ".webp", ".xz", ".zip", ".zst"
+};
+
 status_t Dumpstate::AddZipEntryFromFd(const std::string& entry_name, int fd,
                                       std::chrono::milliseconds timeout = 0ms) {
     std::string valid_name = entry_name;
+    size_t flags = ZipWriter::kCompress | ZipWriter::kDefaultCompression;
 
     // Rename extension if necessary.
     size_t idx = entry_name.rfind('.');
@@ -852,11 +863,13 @@ status_t Dumpstate::AddZipEntryFromFd(const std::string& entry_name, int fd,
             valid_name = entry_name + ".renamed";
             MYLOGI("Renaming entry %s to %s\n", entry_name.c_str(), valid_name.c_str());
         }
+        if (COMPRESSED_FILE_EXTENSIONS.count(extension) != 0) {
+            flags = 0;
+        }
     }
 
     // Logging statement  below is useful to time how long each entry takes, but it's too verbose.
     // MYLOGD("Adding zip entry %s\n", entry_name.c_str());
-    size_t flags = ZipWriter::kCompress | ZipWriter::kDefaultCompression;
     int32_t err = zip_writer_->StartEntryWithTime(valid_name.c_str(), flags,
                                                   get_mtime(fd, ds.now_));
     if (err != 0) {
@@ -1559,6 +1572,25 @@ static void DumpstateLimitedOnly() {
     printf("========================================================\n");
 }
 
+// Runs modinfo once per loaded module, which adds up to several seconds on devices with many
+// vendor modules.
+static void DumpKernelModules(int out_fd = STDOUT_FILENO) {
+    struct stat s;
+    if (stat("/proc/modules", &s) != 0) {
+        MYLOGD("Skipping 'lsmod' because /proc/modules does not exist\n");
+        return;
+    }
+    RunCommand("LSMOD", {"lsmod"}, CommandOptions::DEFAULT, false, out_fd);
+    RunCommand("MODULES INFO",
+               {"sh", "-c", "cat /proc/modules | cut -d' ' -f1 | "
+                "    while read MOD ; do echo modinfo:$MOD ; modinfo $MOD ; "
+                "done"}, CommandOptions::AS_ROOT, false, out_fd);
+}
+
+static void DumpOpenFiles(int out_fd = STDOUT_FILENO) {
+    RunCommand("LIST OF OPEN FILES", {"lsof"}, CommandOptions::AS_ROOT, false, out_fd);
+}
+
 /*
  * |out_fd| A fd to support the DumpPool to output results to a temporary file.
  * Dumpstate can pick up later and output to the bugreport. Using STDOUT_FILENO
@@ -1634,11 +1666,11 @@ Dumpstate::RunStatus Dumpstate::dumpstate() {
 
     // Enqueue slow functions into the thread pool, if the parallel run is enabled.
     std::future<std::string> dump_hals, dump_incident_report, dump_board, dump_checkins,
-            dump_netstats_report, post_process_ui_traces;
+            dump_netstats_report, post_process_ui_traces, dump_kernel_modules, dump_open_files;
     if (ds.dump_pool_) {
         // Pool was shutdown in DumpstateDefaultAfterCritical method in order to
         // drop root user. Restarts it.
-        ds.dump_pool_->start(/* thread_counts = */3);
+        ds.dump_pool_->start(/* thread_counts = */4);
 
         dump_hals = ds.dump_pool_->enqueueTaskWithFd(DUMP_HALS_TASK, &DumpHals, _1);
         dump_incident_report = ds.dump_pool_->enqueueTask(
@@ -1650,6 +1682,11 @@ Dumpstate::RunStatus Dumpstate::dumpstate() {
         dump_checkins = ds.dump_pool_->enqueueTaskWithFd(DUMP_CHECKINS_TASK, &DumpCheckins, _1);
         post_process_ui_traces = ds.dump_pool_->enqueueTask(
             POST_PROCESS_UI_TRACES_TASK, &Dumpstate::MaybePostProcessUiTraces, &ds);
+        // Queued last, since the tasks above are waited for sooner or take longer.
+        dump_kernel_modules = ds.dump_pool_->enqueueTaskWithFd(
+            DUMP_KERNEL_MODULES_TASK, &DumpKernelModules, _1);
+        dump_open_files = ds.dump_pool_->enqueueTaskWithFd(
+            DUMP_OPEN_FILES_TASK, &DumpOpenFiles, _1);
     }
 
     // Dump various things. Note that anything that takes "long" (i.e. several seconds) should
@@ -1688,15 +1725,10 @@ Dumpstate::RunStatus Dumpstate::dumpstate() {
 
     RunCommand("PRINTENV", {"printenv"});
     RunCommand("NETSTAT", {"netstat", "-nW"});
-    struct stat s;
-    if (stat("/proc/modules", &s) != 0) {
-        MYLOGD("Skipping 'lsmod' because /proc/modules does not exist\n");
+    if (ds.dump_pool_) {
+        WAIT_TASK_WITH_CONSENT_CHECK(std::move(dump_kernel_modules));
     } else {
-        RunCommand("LSMOD", {"lsmod"});
-        RunCommand("MODULES INFO",
-                   {"sh", "-c", "cat /proc/modules | cut -d' ' -f1 | "
-                    "    while read MOD ; do echo modinfo:$MOD ; modinfo $MOD ; "
-                    "done"}, CommandOptions::AS_ROOT);
+        RUN_SLOW_FUNCTION_WITH_CONSENT_CHECK_AND_LOG(DUMP_KERNEL_MODULES_TASK, DumpKernelModules);
     }
 
     if (android::base::GetBoolProperty("ro.logd.kernel", false)) {
@@ -1707,7 +1739,11 @@ Dumpstate::RunStatus Dumpstate::dumpstate() {
 
     DumpVintf();
 
-    RunCommand("LIST OF OPEN FILES", {"lsof"}, CommandOptions::AS_ROOT);
+    if (ds.dump_pool_) {
+        WAIT_TASK_WITH_CONSENT_CHECK(std::move(dump_open_files));
+    } else {
+        RUN_SLOW_FUNCTION_WITH_CONSENT_CHECK_AND_LOG(DUMP_OPEN_FILES_TASK, DumpOpenFiles);
+    }
 
     for_each_tid(show_wchan, "BLOCKED PROCESS WAIT-CHANNELS");
     for_each_pid(show_showtime, "PROCESS TIMES (pid cmd user system iowait+percentage)");
@@ -3242,7 +3278,15 @@ Dumpstate::RunStatus Dumpstate::RunInternal(int32_t calling_uid,
         // Invoke critical dumpsys first to preserve system state, before doing anything else.
         RunDumpsysCritical();
     }
-    MaybeTakeEarlyScreenshot();
+    // If the parallel run is enabled, the screenshot and the UI trace snapshots are taken in the
+    // pool while the system trace is snapshotted below.
+    std::vector<std::future<std::string>> ui_capture_tasks;
+    if (dump_pool_) {
+        ui_capture_tasks = EnqueueEarlyUiCapture(/* snapshot_ui_traces = */
+                                                 !is_dumpstate_restricted);
+    } else {
+        MaybeTakeEarlyScreenshot();
+    }
 
     if (!is_dumpstate_restricted) {
         // Snapshot the system trace now (if running) to avoid that dumpstate's
@@ -3250,9 +3294,14 @@ Dumpstate::RunStatus Dumpstate::RunInternal(int32_t calling_uid,
         // The trace file is added to the zip by MaybeAddSystemTraceToZip().
         MaybeSnapshotSystemTrace();
 
-        // Snapshot the UI traces now (if running).
-        // The trace files will be added to bugreport later.
-        MaybeSnapshotUiTraces();
+        if (!dump_pool_) {
+            // Snapshot the UI traces now (if running).
+            // The trace files will be added to bugreport later.
+            MaybeSnapshotUiTraces();
+        }
+    }
+    if (dump_pool_) {
+        WaitForEarlyUiCapture(std::move(ui_capture_tasks));
     }
     onUiIntensiveBugreportDumpsFinished(calling_uid);
     MaybeCheckUserConsent(calling_uid, calling_package);
@@ -3368,8 +3417,15 @@ void Dumpstate::MaybeSnapshotSystemTrace() {
 }
 
 void Dumpstate::MaybeSnapshotUiTraces() {
+    for (const auto& snapshot_ui_trace : GetUiTraceSnapshots()) {
+        snapshot_ui_trace(STDOUT_FILENO);
+    }
+}
+
+std::vector<std::function<void(int)>> Dumpstate::GetUiTraceSnapshots() {
+    std::vector<std::function<void(int)>> snapshots;
     if (PropertiesHelper::IsUserBuild() || options_->use_predumped_ui_data) {
-        return;
+        return snapshots;
     }
 
     const std::vector<std::vector<std::string>> dumpTracesForBugReportCommands = {
@@ -3383,22 +3439,55 @@ void Dumpstate::MaybeSnapshotUiTraces() {
     };
 
     for (const auto& command : dumpTracesForBugReportCommands) {
-        RunCommand(
-            // Empty name because it's not intended to be classified as a bugreport section.
-            // Actual tracing files can be found in "/data/misc/wmtrace/" in the bugreport.
-            "", command,
-            CommandOptions::WithTimeout(10).Always().DropRoot().RedirectStderr().Build());
+        snapshots.push_back([this, command](int out_fd) {
+            RunCommand(
+                // Empty name because it's not intended to be classified as a bugreport section.
+                // Actual tracing files can be found in "/data/misc/wmtrace/" in the bugreport.
+                "", command,
+                CommandOptions::WithTimeout(10).Always().DropRoot().RedirectStderr().Build(),
+                false, out_fd);
+        });
     }
 
     // This command needs to be run as root
     static const auto SURFACEFLINGER_COMMAND_SAVE_ALL_TRACES = std::vector<std::string> {
         "service", "call", "SurfaceFlinger", "1042"
     };
-    // Empty name because it's not intended to be classified as a bugreport section.
-    // Actual tracing files can be found in "/data/misc/wmtrace/" in the bugreport.
-    RunCommand(
-        "", SURFACEFLINGER_COMMAND_SAVE_ALL_TRACES,
-        CommandOptions::WithTimeout(10).Always().AsRoot().RedirectStderr().Build());
+    snapshots.push_back([this](int out_fd) {
+        // Empty name because it's not intended to be classified as a bugreport section.
+        // Actual tracing files can be found in "/data/misc/wmtrace/" in the bugreport.
+        RunCommand(
+            "", SURFACEFLINGER_COMMAND_SAVE_ALL_TRACES,
+            CommandOptions::WithTimeout(10).Always().AsRoot().RedirectStderr().Build(),
+            false, out_fd);
+    });
+    return snapshots;
+}
+
+std::vector<std::future<std::string>> Dumpstate::EnqueueEarlyUiCapture(bool snapshot_ui_traces) {
+    std::vector<std::future<std::string>> tasks;
+    dump_pool_->start();
+
+    tasks.push_back(dump_pool_->enqueueTask(
+        TAKE_EARLY_SCREENSHOT_TASK, &Dumpstate::MaybeTakeEarlyScreenshot, this));
+    if (snapshot_ui_traces) {
+        // The UI components save their traces independently of each other.
+        for (auto& snapshot_ui_trace : GetUiTraceSnapshots()) {
+            tasks.push_back(dump_pool_->enqueueTaskWithFd(
+                SNAPSHOT_UI_TRACES_TASK, std::move(snapshot_ui_trace), _1));
+        }
+    }
+    return tasks;
+}
+
+void Dumpstate::WaitForEarlyUiCapture(std::vector<std::future<std::string>> tasks) {
+    for (auto& task : tasks) {
+        WaitForTask(std::move(task));
+    }
+
+    // The threads in the pool are root, and the later stages start the pool with their own
+    // thread counts. Make a new one, as it was before the early stage.
+    dump_pool_ = std::make_unique<DumpPool>(bugreport_internal_dir_);
 }
 
 void Dumpstate::MaybePostProcessUiTraces() {
@@ -22,6 +22,8 @@
 #include <stdbool.h>
 #include <stdio.h>
 
+#include <functional>
+#include <future>
 #include <string>
 #include <vector>
 
@@ -568,6 +570,13 @@ class Dumpstate {
     void MaybeTakeEarlyScreenshot();
     void MaybeSnapshotSystemTrace();
     void MaybeSnapshotUiTraces();
+    // Returns one function per UI component whose trace should be saved for the bugreport. Each
+    // function writes its output to the given fd.
+    std::vector<std::function<void(int)>> GetUiTraceSnapshots();
+    // Enqueues the early screenshot and, if requested, the UI trace snapshots into the dump pool,
+    // so that they run alongside each other and the rest of the early stage.
+    std::vector<std::future<std::string>> EnqueueEarlyUiCapture(bool snapshot_ui_traces);
+    void WaitForEarlyUiCapture(std::vector<std::future<std::string>> tasks);
     void MaybePostProcessUiTraces();
     void MaybeAddUiTracesToZip();
 
@@ -15,8 +15,11 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <iomanip>
+#include <mutex>
 #include <thread>
 
 #include <android-base/file.h>
@@ -39,6 +42,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/poll.h>
 #include <sys/socket.h>
 #include <sys/time.h>
@@ -66,7 +70,7 @@ static void usage() {
         "         To dump all services.\n"
         "or:\n"
         "       dumpsys [-t TIMEOUT] [--priority LEVEL] [--clients] [--dump] [--pid] [--thread] "
-        "[--help | "
+        "[--parallel JOBS] [--deadline DEADLINE_MS] [--help | "
         "-l | --skip SERVICES "
         "| SERVICE [ARGS]]\n"
         "         --help: shows this help\n"
@@ -74,7 +78,11 @@ static void usage() {
         "         -t TIMEOUT_SEC: TIMEOUT to use in seconds instead of default 10 seconds\n"
         "         -T TIMEOUT_MS: TIMEOUT to use in milliseconds instead of default 10 seconds\n"
         "         --clients: dump client PIDs instead of usual dump\n"
+        "         --deadline DEADLINE_MS: stop dumping services once DEADLINE_MS milliseconds\n"
+        "               have passed in total; later services are reported as skipped\n"
         "         --dump: ask the service to dump itself (this is the default)\n"
+        "         --parallel JOBS: dump up to JOBS services at once, buffering each dump and\n"
+        "               printing them in the usual order\n"
         "         --pid: dump PID instead of usual dump\n"
         "         --proto: filter services that support dumping data in proto format. Dumps\n"
         "               will be in proto format.\n"
@@ -135,13 +143,16 @@ int Dumpsys::main(int argc, char* const argv[]) {
     bool asProto = false;
     int dumpTypeFlags = 0;
     int timeoutArgMs = 10000;
+    int deadlineArgMs = 0;
+    int jobs = 1;
     int priorityFlags = IServiceManager::DUMP_FLAG_PRIORITY_ALL;
     static struct option longOptions[] = {
         {"help", no_argument, 0, 0},           {"clients", no_argument, 0, 0},
         {"dump", no_argument, 0, 0},           {"pid", no_argument, 0, 0},
         {"priority", required_argument, 0, 0}, {"proto", no_argument, 0, 0},
         {"skip", no_argument, 0, 0},           {"stability", no_argument, 0, 0},
-        {"thread", no_argument, 0, 0},         {0, 0, 0, 0}};
+        {"thread", no_argument, 0, 0},         {"parallel", required_argument, 0, 0},
+        {"deadline", required_argument, 0, 0}, {0, 0, 0, 0}};
 
     // Must reset optind, otherwise subsequent calls will fail (wouldn't happen on main.cpp, but
     // happens on test cases).
@@ -182,6 +193,21 @@ int Dumpsys::main(int argc, char* const argv[]) {
                 dumpTypeFlags |= TYPE_THREAD;
             } else if (!strcmp(longOptions[optionIndex].name, "clients")) {
                 dumpTypeFlags |= TYPE_CLIENTS;
+            } else if (!strcmp(longOptions[optionIndex].name, "parallel")) {
+                char* endptr;
+                jobs = strtol(optarg, &endptr, 10);
+                if (*endptr != '\0' || jobs <= 0) {
+                    fprintf(stderr, "Error: invalid number of jobs: '%s'\n", optarg);
+                    return -1;
+                }
+            } else if (!strcmp(longOptions[optionIndex].name, "deadline")) {
+                char* endptr;
+                deadlineArgMs = strtol(optarg, &endptr, 10);
+                if (*endptr != '\0' || deadlineArgMs <= 0) {
+                    fprintf(stderr, "Error: invalid deadline(milliseconds) number: '%s'\n",
+                            optarg);
+                    return -1;
+                }
             }
             break;
 
@@ -271,37 +297,133 @@ int Dumpsys::main(int argc, char* const argv[]) {
         return 0;
     }
 
-    for (size_t i = 0; i < N; i++) {
-        const String16& serviceName = services[i];
-        if (IsSkipped(skippedServices, serviceName)) continue;
+    Vector<String16> dumpedServices;
+    for (const auto& serviceName : services) {
+        if (!IsSkipped(skippedServices, serviceName)) {
+            dumpedServices.add(serviceName);
+        }
+    }
 
-        if (startDumpThread(dumpTypeFlags, serviceName, args) == OK) {
-            bool addSeparator = (N > 1);
-            if (addSeparator) {
-                writeDumpHeader(STDOUT_FILENO, serviceName, priorityFlags);
-            }
-            std::chrono::duration<double> elapsedDuration;
-            size_t bytesWritten = 0;
-            status_t status =
-                writeDump(STDOUT_FILENO, serviceName, std::chrono::milliseconds(timeoutArgMs),
-                          asProto, elapsedDuration, bytesWritten);
-
-            if (status == TIMED_OUT) {
-                std::cout << std::endl
-                     << "*** SERVICE '" << serviceName << "' DUMP TIMEOUT (" << timeoutArgMs
-                     << "ms) EXPIRED ***" << std::endl
-                     << std::endl;
+    DumpOptions options = {
+            .dumpTypeFlags = dumpTypeFlags,
+            .priorityFlags = priorityFlags,
+            .addSeparator = (N > 1),
+            .asProto = asProto,
+            .timeout = std::chrono::milliseconds(timeoutArgMs),
+            .deadline = deadlineArgMs > 0
+                    ? std::chrono::steady_clock::now() + std::chrono::milliseconds(deadlineArgMs)
+                    : std::chrono::steady_clock::time_point::max(),
+    };
+    if (jobs > 1 && dumpedServices.size() > 1) {
+        dumpServicesInParallel(dumpedServices, args, options, jobs);
+    } else {
+        for (const auto& serviceName : dumpedServices) {
+            dumpService(STDOUT_FILENO, serviceName, args, options);
+        }
+    }
+
+    return 0;
+}
+
+void Dumpsys::dumpService(int fd, const String16& serviceName, const Vector<String16>& args,
+                          const DumpOptions& options) {
+    std::chrono::milliseconds timeout = options.timeout;
+    if (options.deadline != std::chrono::steady_clock::time_point::max()) {
+        auto timeLeft = std::chrono::duration_cast<std::chrono::milliseconds>(
+                options.deadline - std::chrono::steady_clock::now());
+        if (timeLeft.count() <= 0) {
+            if (!options.asProto) {
+                WriteStringToFd(StringPrintf("*** SERVICE '%s' SKIPPED, DEADLINE EXPIRED ***\n",
+                                             String8(serviceName).c_str()),
+                                fd);
             }
+            return;
+        }
+        timeout = std::min(timeout, timeLeft);
+    }
+
+    if (startDumpThread(options.dumpTypeFlags, serviceName, args) != OK) {
+        return;
+    }
+    if (options.addSeparator) {
+        writeDumpHeader(fd, serviceName, options.priorityFlags);
+    }
+    std::chrono::duration<double> elapsedDuration;
+    size_t bytesWritten = 0;
+    status_t status =
+            writeDump(fd, serviceName, timeout, options.asProto, elapsedDuration, bytesWritten);
+
+    if (status == TIMED_OUT) {
+        WriteStringToFd(StringPrintf("\n*** SERVICE '%s' DUMP TIMEOUT (%lldms) EXPIRED ***\n\n",
+                                     String8(serviceName).c_str(),
+                                     static_cast<long long>(timeout.count())),
+                        fd);
+    }
+
+    if (options.addSeparator) {
+        writeDumpFooter(fd, serviceName, elapsedDuration);
+    }
+    bool dumpComplete = (status == OK);
+    stopDumpThread(dumpComplete);
+}
 
-            if (addSeparator) {
-                writeDumpFooter(STDOUT_FILENO, serviceName, elapsedDuration);
+void Dumpsys::dumpServicesInParallel(const Vector<String16>& services,
+                                     const Vector<String16>& args, const DumpOptions& options,
+                                     size_t jobs) {
+    struct Result {
+        unique_fd fd;
+        bool done = false;
+    };
+    std::vector<Result> results(services.size());
+    std::mutex lock;
+    std::condition_variable resultReady;
+    std::atomic<size_t> nextService = 0;
+
+    // Each worker has its own Dumpsys, since a Dumpsys tracks a single dump thread and pipe.
+    auto work = [&]() {
+        Dumpsys dumpsys(sm_);
+        for (size_t i = nextService++; i < services.size(); i = nextService++) {
+            unique_fd fd(memfd_create("dumpsys", MFD_CLOEXEC));
+            if (fd == -1) {
+                std::cerr << "Failed to create buffer to dump service " << services[i] << ": "
+                          << strerror(errno) << std::endl;
+            } else {
+                dumpsys.dumpService(fd.get(), services[i], args, options);
+            }
+            std::lock_guard guard(lock);
+            results[i].fd = std::move(fd);
+            results[i].done = true;
+            resultReady.notify_all();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < std::min(jobs, services.size()); i++) {
+        workers.emplace_back(work);
+    }
+
+    // Print each dump as soon as it and all the ones before it are complete.
+    for (auto& result : results) {
+        unique_fd fd;
+        {
+            std::unique_lock guard(lock);
+            resultReady.wait(guard, [&result]() { return result.done; });
+            fd = std::move(result.fd);
+        }
+        if (fd == -1 || lseek(fd.get(), 0, SEEK_SET) != 0) {
+            continue;
+        }
+        char buf[4096];
+        ssize_t rc;
+        while ((rc = TEMP_FAILURE_RETRY(read(fd.get(), buf, sizeof(buf)))) > 0) {
+            if (!WriteFully(STDOUT_FILENO, buf, rc)) {
+                break;
             }
-            bool dumpComplete = (status == OK);
-            stopDumpThread(dumpComplete);
         }
     }
 
-    return 0;
+    for (auto& worker : workers) {
+        worker.join();
+    }
 }
 
 Vector<String16> Dumpsys::listServices(int priorityFilterFlags, bool filterByProto) const {
@@ -372,7 +494,8 @@ static status_t dumpThreadsToFd(const sp<IBinder>& service, const unique_fd& fd)
         return status;
     }
     WriteStringToFd("Threads in use: " + std::to_string(pidInfo.threadUsage) + "/" +
-                        std::to_string(pidInfo.threadCount) + "\n",
+                        std::to_string(pidInfo.threadCount) + ", pending transactions: " +
+                        std::to_string(pidInfo.pendingTransactions) + "\n",
                     fd.get());
     return OK;
 }
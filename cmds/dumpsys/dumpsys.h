@@ -17,6 +17,7 @@
 #ifndef FRAMEWORK_NATIVE_CMD_DUMPSYS_H_
 #define FRAMEWORK_NATIVE_CMD_DUMPSYS_H_
 
+#include <chrono>
 #include <thread>
 
 #include <android-base/unique_fd.h>
@@ -126,6 +127,30 @@ class Dumpsys {
     }
 
   private:
+    struct DumpOptions {
+        int dumpTypeFlags;
+        int priorityFlags;
+        bool addSeparator;
+        bool asProto;
+        std::chrono::milliseconds timeout;
+        // Services are skipped once this passes; time_point::max() if there is no deadline.
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    /**
+     * Dumps a single service to a file descriptor, with the header, footer and timeout
+     * messages selected by {@code options}.
+     */
+    void dumpService(int fd, const String16& serviceName, const Vector<String16>& args,
+                     const DumpOptions& options);
+
+    /**
+     * Dumps up to {@code jobs} services at once. Each dump goes to a buffer of its own, and the
+     * buffers are written to stdout in the order of {@code services}.
+     */
+    void dumpServicesInParallel(const Vector<String16>& services, const Vector<String16>& args,
+                                const DumpOptions& options, size_t jobs);
+
     android::IServiceManager* sm_;
     std::thread activeThread_;
     mutable android::base::unique_fd redirectFd_;
@@ -237,6 +237,14 @@ class DumpsysTest : public Test {
         EXPECT_THAT(stdout_, testing::MatchesRegex(format));
     }
 
+    void AssertOutputInOrder(const std::vector<std::string>& expected) {
+        size_t pos = 0;
+        for (const std::string& part : expected) {
+            pos = stdout_.find(part, pos);
+            ASSERT_NE(pos, std::string::npos) << "'" << part << "' missing or out of order";
+        }
+    }
+
     void AssertDumped(const std::string& service, const std::string& dump) {
         EXPECT_THAT(stdout_, HasSubstr("DUMP OF SERVICE " + service + ":\n" + dump));
         EXPECT_THAT(stdout_, HasSubstr("was the duration of dumpsys " + service + ", ending at: "));
@@ -473,6 +481,39 @@ TEST_F(DumpsysTest, DumpWithSkip) {
     AssertNotDumped("dump5");
 }
 
+// Tests 'dumpsys --parallel 2', which should keep the order of the services in its output
+TEST_F(DumpsysTest, DumpMultipleServicesInParallel) {
+    ExpectListServices({"slow1", "stopped2", "fast3"});
+    ExpectDumpAndHang("slow1", 1, "dump1");
+    ExpectCheckService("stopped2", false);
+    ExpectDump("fast3", "dump3");
+
+    CallMain({"--parallel", "2"});
+
+    AssertRunningServices({"slow1", "fast3"});
+    AssertDumped("slow1", "dump1");
+    AssertStopped("stopped2");
+    AssertDumped("fast3", "dump3");
+    AssertOutputInOrder({"DUMP OF SERVICE slow1:", "DUMP OF SERVICE fast3:"});
+}
+
+// Tests 'dumpsys --deadline 500' when the first service takes up the whole deadline
+TEST_F(DumpsysTest, DumpWithDeadline) {
+    ExpectListServices({"slow1", "running2"});
+    sp<BinderMock> binder_mock = ExpectDumpAndHang("slow1", 2, "dump1");
+    ExpectDump("running2", "dump2");
+
+    CallMain({"--deadline", "500"});
+
+    AssertOutputContains("SERVICE 'slow1' DUMP TIMEOUT (");
+    AssertOutputContains("*** SERVICE 'running2' SKIPPED, DEADLINE EXPIRED ***");
+    AssertNotDumped("dump1");
+    AssertNotDumped("dump2");
+
+    // TODO(b/65056227): BinderMock is not destructed because thread is detached on dumpsys.cpp
+    Mock::AllowLeak(binder_mock.get());
+}
+
 // Tests 'dumpsys --skip skipped3 skipped5 --priority CRITICAL', which should skip these services
 TEST_F(DumpsysTest, DumpWithSkipAndPriority) {
     ExpectListServicesWithPriority({"running1", "stopped2", "skipped3", "running4", "skipped5"},
@@ -620,7 +661,8 @@ TEST_F(DumpsysTest, ListAllServicesWithThread) {
 
     AssertRunningServices({"Locksmith", "Valet"});
 
-    const std::string format("(.|\n)*((Threads in use: [0-9]+/[0-9]+)?\n-(.|\n)*){2}");
+    const std::string format(
+            "(.|\n)*((Threads in use: [0-9]+/[0-9]+, pending transactions: [0-9]+)?\n-(.|\n)*){2}");
     AssertOutputFormat(format);
 }
 
@@ -630,7 +672,7 @@ TEST_F(DumpsysTest, ListServiceWithThread) {
 
     CallMain({"--thread", "Locksmith"});
     // returns an empty string without root enabled
-    const std::string format("(^$|Threads in use: [0-9]/[0-9]+\n)");
+    const std::string format("(^$|Threads in use: [0-9]/[0-9]+, pending transactions: [0-9]+\n)");
     AssertOutputFormat(format);
 }
 
@@ -17,6 +17,8 @@
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
 
+#include <algorithm>
+
 #include "Flatland.h"
 #include "GLHelper.h"
 
@@ -25,10 +27,12 @@ namespace android {
 class Blitter {
 public:
 
-    bool setUp(GLHelper* helper) {
+    bool setUp(GLHelper* helper, const char* pgmName = "Blit", float cornerRadius = 0.0f) {
         bool result;
 
-        result = helper->getShaderProgram("Blit", &mBlitPgm);
+        mCornerRadius = cornerRadius;
+
+        result = helper->getShaderProgram(pgmName, &mBlitPgm);
         if (!result) {
             return false;
         }
@@ -40,6 +44,10 @@ public:
         mBlitSrcSamplerLoc = glGetUniformLocation(mBlitPgm, "blitSrc");
         mModColorUniformLoc = glGetUniformLocation(mBlitPgm, "modColor");
 
+        // Only present in the rounded corner program.
+        mLayerSizeUniformLoc = glGetUniformLocation(mBlitPgm, "layerSize");
+        mCornerRadiusUniformLoc = glGetUniformLocation(mBlitPgm, "cornerRadius");
+
         return true;
     }
 
@@ -82,6 +90,10 @@ public:
         glUniformMatrix4fv(mObjToNdcUniformLoc, 1, GL_FALSE, screenToNdc);
         glUniformMatrix4fv(mUVToTexUniformLoc, 1, GL_FALSE, texMatrix);
         glUniform4fv(mModColorUniformLoc, 1, modColor);
+        if (mLayerSizeUniformLoc >= 0) {
+            glUniform2f(mLayerSizeUniformLoc, float(w), float(h));
+            glUniform1f(mCornerRadiusUniformLoc, mCornerRadius);
+        }
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_EXTERNAL_OES, texName);
@@ -107,6 +119,9 @@ private:
     GLint mObjToNdcUniformLoc;
     GLint mBlitSrcSamplerLoc;
     GLint mModColorUniformLoc;
+    GLint mLayerSizeUniformLoc;
+    GLint mCornerRadiusUniformLoc;
+    float mCornerRadius;
 };
 
 class ComposerBase : public Composer {
@@ -282,4 +297,55 @@ Composer* blendShrink() {
     return new BlendShrinkComp();
 }
 
+// Like blendShrink, but with the corners of the layer masked off the way SurfaceFlinger rounds the
+// corners of a window during an app transition.
+Composer* roundedBlendShrink() {
+    class RoundedBlendShrinkComp : public ComposerBase {
+        virtual bool setUp(GLHelper* helper) {
+            mParity = false;
+            float radius = float(std::min(mLayerDesc.width, mLayerDesc.height)) / 24.0f;
+            return mBlitter.setUp(helper, "RoundedBlit", radius);
+        }
+
+        virtual bool compose(GLuint texName, const sp<GLConsumer>& glc) {
+            bool result;
+
+            float texMatrix[16];
+            glc->getTransformMatrix(texMatrix);
+
+            float modColor[4] = { .75f, .75f, .75f, .75f };
+
+            int32_t x = mLayerDesc.x;
+            int32_t y = mLayerDesc.y;
+            int32_t w = mLayerDesc.width;
+            int32_t h = mLayerDesc.height;
+
+            mParity = !mParity;
+            if (mParity) {
+                x += w / 128;
+                y += h / 128;
+                w -= w / 64;
+                h -= h / 64;
+            }
+
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+            result = mBlitter.modBlit(texName, texMatrix, modColor,
+                    x, y, w, h);
+            if (!result) {
+                return false;
+            }
+
+            glDisable(GL_BLEND);
+
+            return true;
+        }
+
+        Blitter mBlitter;
+        bool mParity;
+    };
+    return new RoundedBlendShrinkComp();
+}
+
 } // namespace android
@@ -57,6 +57,7 @@ Composer* opaque();
 Composer* opaqueShrink();
 Composer* blend();
 Composer* blendShrink();
+Composer* roundedBlendShrink();
 
 class Renderer {
 public:
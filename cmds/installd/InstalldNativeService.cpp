@@ -35,6 +35,7 @@
 #include <sys/xattr.h>
 #include <unistd.h>
 #include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <fstream>
 #include <functional>
@@ -1295,6 +1296,102 @@ static gid_t get_cache_gid(uid_t uid) {
     return (gid != -1) ? gid : uid;
 }
 
+/**
+ * Fixes up the GIDs beneath a single package data directory, which is expected to be owned by
+ * the app's UID, with cache directories owned by its cache GID.
+ */
+static bool fixup_package_data_tree(const std::string& path, int32_t flags) {
+    FTS* fts;
+    FTSENT* p;
+    char *argv[] = { (char*) path.c_str(), nullptr };
+    if (!(fts = fts_open(argv, FTS_PHYSICAL | FTS_NOCHDIR | FTS_XDEV, nullptr))) {
+        PLOG(ERROR) << "Failed to fts_open " << path;
+        return false;
+    }
+    while ((p = fts_read(fts)) != nullptr) {
+        if (p->fts_info == FTS_D && p->fts_level == 0) {
+            // Track down inodes of cache directories
+            uint64_t raw = 0;
+            ino_t inode_cache = 0;
+            ino_t inode_code_cache = 0;
+            if (getxattr(p->fts_path, kXattrInodeCache, &raw, sizeof(raw)) == sizeof(raw)) {
+                inode_cache = raw;
+            }
+            if (getxattr(p->fts_path, kXattrInodeCodeCache, &raw, sizeof(raw)) == sizeof(raw)) {
+                inode_code_cache = raw;
+            }
+
+            // Figure out expected GID of each child
+            FTSENT* child = fts_children(fts, 0);
+            while (child != nullptr) {
+                if ((child->fts_statp->st_ino == inode_cache)
+                        || (child->fts_statp->st_ino == inode_code_cache)
+                        || !strcmp(child->fts_name, "cache")
+                        || !strcmp(child->fts_name, "code_cache")) {
+                    child->fts_number = get_cache_gid(p->fts_statp->st_uid);
+                } else {
+                    child->fts_number = p->fts_statp->st_uid;
+                }
+                child = child->fts_link;
+            }
+        } else if (p->fts_level >= 1) {
+            if (p->fts_level > 1) {
+                // Inherit GID from parent once we're deeper into tree
+                p->fts_number = p->fts_parent->fts_number;
+            }
+
+            uid_t uid = p->fts_parent->fts_statp->st_uid;
+            gid_t cache_gid = get_cache_gid(uid);
+            gid_t expected = p->fts_number;
+            gid_t actual = p->fts_statp->st_gid;
+            if (actual == expected) {
+#if FIXUP_DEBUG
+                LOG(DEBUG) << "Ignoring " << p->fts_path << " with expected GID " << expected;
+#endif
+                if (!(flags & FLAG_FORCE)) {
+                    fts_set(fts, p, FTS_SKIP);
+                }
+            } else if ((actual == uid) || (actual == cache_gid)) {
+                // Only consider fixing up when current GID belongs to app
+                if (p->fts_info != FTS_D) {
+                    LOG(INFO) << "Fixing " << p->fts_path << " with unexpected GID " << actual
+                            << " instead of " << expected;
+                }
+                switch (p->fts_info) {
+                case FTS_DP:
+                    // If we're moving towards cache GID, we need to set S_ISGID
+                    if (expected == cache_gid) {
+                        if (chmod(p->fts_path, 02771) != 0) {
+                            PLOG(WARNING) << "Failed to chmod " << p->fts_path;
+                        }
+                    }
+                    [[fallthrough]]; // also set GID
+                case FTS_F:
+                    if (chown(p->fts_path, -1, expected) != 0) {
+                        PLOG(WARNING) << "Failed to chown " << p->fts_path;
+                    }
+                    break;
+                case FTS_SL:
+                case FTS_SLNONE:
+                    if (lchown(p->fts_path, -1, expected) != 0) {
+                        PLOG(WARNING) << "Failed to chown " << p->fts_path;
+                    }
+                    break;
+                }
+            } else {
+                // Ignore all other GID transitions, since they're kinda shady
+                LOG(WARNING) << "Ignoring " << p->fts_path << " with unexpected GID " << actual
+                        << " instead of " << expected;
+                if (!(flags & FLAG_FORCE)) {
+                    fts_set(fts, p, FTS_SKIP);
+                }
+            }
+        }
+    }
+    fts_close(fts);
+    return true;
+}
+
 binder::Status InstalldNativeService::fixupAppData(const std::optional<std::string>& uuid,
         int32_t flags) {
     ENFORCE_UID(AID_SYSTEM);
@@ -1304,96 +1401,25 @@ binder::Status InstalldNativeService::fixupAppData(const std::optional<std::stri
     for (auto userId : get_known_users(uuid_)) {
         LOCK_USER();
         atrace_pm_begin("fixup user");
-        FTS* fts;
-        FTSENT* p;
-        auto ce_path = create_data_user_ce_path(uuid_, userId);
-        auto de_path = create_data_user_de_path(uuid_, userId);
-        char *argv[] = { (char*) ce_path.c_str(), (char*) de_path.c_str(), nullptr };
-        if (!(fts = fts_open(argv, FTS_PHYSICAL | FTS_NOCHDIR | FTS_XDEV, nullptr))) {
-            return error("Failed to fts_open");
+        // Package directories are independent of each other, so walk them in parallel. The
+        // workers run under the user lock held by this thread.
+        std::vector<std::string> paths;
+        for (const auto& userPath : { create_data_user_ce_path(uuid_, userId),
+                create_data_user_de_path(uuid_, userId) }) {
+            foreach_subdir(userPath, [&userPath, &paths](const std::string& name) {
+                paths.push_back(userPath + "/" + name);
+            });
         }
-        while ((p = fts_read(fts)) != nullptr) {
-            if (p->fts_info == FTS_D && p->fts_level == 1) {
-                // Track down inodes of cache directories
-                uint64_t raw = 0;
-                ino_t inode_cache = 0;
-                ino_t inode_code_cache = 0;
-                if (getxattr(p->fts_path, kXattrInodeCache, &raw, sizeof(raw)) == sizeof(raw)) {
-                    inode_cache = raw;
-                }
-                if (getxattr(p->fts_path, kXattrInodeCodeCache, &raw, sizeof(raw)) == sizeof(raw)) {
-                    inode_code_cache = raw;
-                }
-
-                // Figure out expected GID of each child
-                FTSENT* child = fts_children(fts, 0);
-                while (child != nullptr) {
-                    if ((child->fts_statp->st_ino == inode_cache)
-                            || (child->fts_statp->st_ino == inode_code_cache)
-                            || !strcmp(child->fts_name, "cache")
-                            || !strcmp(child->fts_name, "code_cache")) {
-                        child->fts_number = get_cache_gid(p->fts_statp->st_uid);
-                    } else {
-                        child->fts_number = p->fts_statp->st_uid;
-                    }
-                    child = child->fts_link;
-                }
-            } else if (p->fts_level >= 2) {
-                if (p->fts_level > 2) {
-                    // Inherit GID from parent once we're deeper into tree
-                    p->fts_number = p->fts_parent->fts_number;
-                }
-
-                uid_t uid = p->fts_parent->fts_statp->st_uid;
-                gid_t cache_gid = get_cache_gid(uid);
-                gid_t expected = p->fts_number;
-                gid_t actual = p->fts_statp->st_gid;
-                if (actual == expected) {
-#if FIXUP_DEBUG
-                    LOG(DEBUG) << "Ignoring " << p->fts_path << " with expected GID " << expected;
-#endif
-                    if (!(flags & FLAG_FORCE)) {
-                        fts_set(fts, p, FTS_SKIP);
-                    }
-                } else if ((actual == uid) || (actual == cache_gid)) {
-                    // Only consider fixing up when current GID belongs to app
-                    if (p->fts_info != FTS_D) {
-                        LOG(INFO) << "Fixing " << p->fts_path << " with unexpected GID " << actual
-                                << " instead of " << expected;
-                    }
-                    switch (p->fts_info) {
-                    case FTS_DP:
-                        // If we're moving towards cache GID, we need to set S_ISGID
-                        if (expected == cache_gid) {
-                            if (chmod(p->fts_path, 02771) != 0) {
-                                PLOG(WARNING) << "Failed to chmod " << p->fts_path;
-                            }
-                        }
-                        [[fallthrough]]; // also set GID
-                    case FTS_F:
-                        if (chown(p->fts_path, -1, expected) != 0) {
-                            PLOG(WARNING) << "Failed to chown " << p->fts_path;
-                        }
-                        break;
-                    case FTS_SL:
-                    case FTS_SLNONE:
-                        if (lchown(p->fts_path, -1, expected) != 0) {
-                            PLOG(WARNING) << "Failed to chown " << p->fts_path;
-                        }
-                        break;
-                    }
-                } else {
-                    // Ignore all other GID transitions, since they're kinda shady
-                    LOG(WARNING) << "Ignoring " << p->fts_path << " with unexpected GID " << actual
-                            << " instead of " << expected;
-                    if (!(flags & FLAG_FORCE)) {
-                        fts_set(fts, p, FTS_SKIP);
-                    }
-                }
+        std::atomic<bool> failed = false;
+        run_in_parallel(paths.size(), [&paths, &failed, flags](size_t i) {
+            if (!fixup_package_data_tree(paths[i], flags)) {
+                failed = true;
             }
-        }
-        fts_close(fts);
+        });
         atrace_pm_end();
+        if (failed) {
+            return error("Failed to fts_open");
+        }
     }
     return ok();
 }
@@ -1413,6 +1439,20 @@ static int32_t copy_directory_recursive(const char* from, const char* to) {
     return logwrap_fork_execvp(ARRAY_SIZE(argv), argv, nullptr, false, LOG_ALOG, false, nullptr);
 }
 
+// Rollback snapshots live on the same volume as the data they're taken from, so they can share
+// its blocks when the filesystem supports cloning. Anything the clone can't handle is redone by
+// cp, which replaces whatever partial copy the clone left behind.
+static int32_t clone_or_copy_directory_recursive(const char* from, const char* to) {
+    LOG(DEBUG) << "Cloning " << from << " to " << to;
+    if (clone_directory_recursive(from, to) == 0) {
+        return 0;
+    }
+    if (errno != EOPNOTSUPP) {
+        PLOG(WARNING) << "Failed cloning " << from << " to " << to;
+    }
+    return copy_directory_recursive(from, to);
+}
+
 binder::Status InstalldNativeService::snapshotAppData(const std::optional<std::string>& volumeUuid,
                                                       const std::string& packageName,
                                                       int32_t userId, int32_t snapshotId,
@@ -1473,7 +1513,7 @@ binder::Status InstalldNativeService::snapshotAppData(const std::optional<std::s
 
         // Check if we have data to copy.
         if (access(from.c_str(), F_OK) == 0) {
-          rc = copy_directory_recursive(from.c_str(), to.c_str());
+          rc = clone_or_copy_directory_recursive(from.c_str(), to.c_str());
         }
         if (rc != 0) {
             res = error(rc, "Failed copying " + from + " to " + to);
@@ -1525,7 +1565,7 @@ binder::Status InstalldNativeService::snapshotAppData(const std::optional<std::s
             return error(rc, "Failed clearing existing snapshot " + rollback_package_path);
         }
 
-        rc = copy_directory_recursive(from.c_str(), to.c_str());
+        rc = clone_or_copy_directory_recursive(from.c_str(), to.c_str());
         if (rc != 0) {
             res = error(rc, "Failed copying " + from + " to " + to);
             clear_ce_on_exit = true;
@@ -1590,7 +1630,7 @@ binder::Status InstalldNativeService::restoreAppDataSnapshot(
 
     if (needs_ce_rollback) {
         auto to_ce = create_data_user_ce_path(volume_uuid, userId);
-        int rc = copy_directory_recursive(from_ce.c_str(), to_ce.c_str());
+        int rc = clone_or_copy_directory_recursive(from_ce.c_str(), to_ce.c_str());
         if (rc != 0) {
             res = error(rc, "Failed copying " + from_ce + " to " + to_ce);
             return res;
@@ -1600,7 +1640,7 @@ binder::Status InstalldNativeService::restoreAppDataSnapshot(
 
     if (needs_de_rollback) {
         auto to_de = create_data_user_de_path(volume_uuid, userId);
-        int rc = copy_directory_recursive(from_de.c_str(), to_de.c_str());
+        int rc = clone_or_copy_directory_recursive(from_de.c_str(), to_de.c_str());
         if (rc != 0) {
             if (needs_ce_rollback) {
                 auto ce_data = create_data_user_ce_package_path(volume_uuid, userId, package_name);
@@ -2036,9 +2076,18 @@ binder::Status InstalldNativeService::freeCache(const std::optional<std::string>
         };
         std::priority_queue<std::shared_ptr<CacheTracker>,
                 std::vector<std::shared_ptr<CacheTracker>>, decltype(cmp)> queue(cmp);
+        // Trackers without quota support walk their cache trees, which is slow enough to
+        // spread across threads; each tracker only updates its own stats.
+        std::vector<std::shared_ptr<CacheTracker>> trackerList;
+        trackerList.reserve(trackers.size());
         for (const auto& it : trackers) {
-            it.second->loadStats();
-            queue.push(it.second);
+            trackerList.push_back(it.second);
+        }
+        run_in_parallel(trackerList.size(), [&trackerList](size_t i) {
+            trackerList[i]->loadStats();
+        });
+        for (const auto& tracker : trackerList) {
+            queue.push(tracker);
         }
         atrace_pm_end();
 
@@ -2154,6 +2203,12 @@ struct stats {
     int64_t cacheSize;
 };
 
+static void addStats(struct stats* to, const struct stats& from) {
+    to->codeSize += from.codeSize;
+    to->dataSize += from.dataSize;
+    to->cacheSize += from.cacheSize;
+}
+
 #if MEASURE_DEBUG
 static std::string toString(std::vector<int64_t> values) {
     std::stringstream res;
@@ -2716,53 +2771,72 @@ binder::Status InstalldNativeService::getUserSize(const std::optional<std::strin
         extStats.dataSize = dataSize;
         atrace_pm_end();
     } else {
-        atrace_pm_begin("obb");
-        auto obbPath = create_data_path(uuid_) + "/media/obb";
-        calculate_tree_size(obbPath, &extStats.codeSize);
-        atrace_pm_end();
-
-        atrace_pm_begin("code");
-        calculate_tree_size(create_data_app_path(uuid_), &stats.codeSize);
-        atrace_pm_end();
-
-        atrace_pm_begin("data");
+        // The trees are disjoint, so each walk measures into its own stats and they can run
+        // on separate threads; the results are summed once every walk is done.
         auto cePath = create_data_user_ce_path(uuid_, userId);
-        collectManualStatsForUser(cePath, &stats);
         auto dePath = create_data_user_de_path(uuid_, userId);
-        collectManualStatsForUser(dePath, &stats);
-        atrace_pm_end();
-
-        atrace_pm_begin("sdksandbox");
         auto sdkSandboxCePath = create_data_misc_sdk_sandbox_path(uuid_, true, userId);
-        collectManualStatsForUser(sdkSandboxCePath, &stats, false, true);
         auto sdkSandboxDePath = create_data_misc_sdk_sandbox_path(uuid_, false, userId);
-        collectManualStatsForUser(sdkSandboxDePath, &stats, false, true);
-        atrace_pm_end();
-
+        std::vector<std::function<void(struct stats*, struct stats*)>> walks = {
+            [&](struct stats*, struct stats* ext) {
+                atrace_pm_begin("obb");
+                calculate_tree_size(create_data_path(uuid_) + "/media/obb", &ext->codeSize);
+                atrace_pm_end();
+            },
+            [&](struct stats* in, struct stats*) {
+                atrace_pm_begin("code");
+                calculate_tree_size(create_data_app_path(uuid_), &in->codeSize);
+                atrace_pm_end();
+            },
+            [&](struct stats* in, struct stats*) {
+                atrace_pm_begin("data");
+                collectManualStatsForUser(cePath, in);
+                atrace_pm_end();
+            },
+            [&](struct stats* in, struct stats*) {
+                atrace_pm_begin("data");
+                collectManualStatsForUser(dePath, in);
+                atrace_pm_end();
+            },
+            [&](struct stats* in, struct stats*) {
+                atrace_pm_begin("sdksandbox");
+                collectManualStatsForUser(sdkSandboxCePath, in, false, true);
+                collectManualStatsForUser(sdkSandboxDePath, in, false, true);
+                atrace_pm_end();
+            },
+            [&](struct stats*, struct stats* ext) {
+                atrace_pm_begin("external");
+                collectManualExternalStatsForUser(create_data_media_path(uuid_, userId), ext);
+                atrace_pm_end();
+            },
+        };
         if (!uuid) {
-            atrace_pm_begin("profile");
-            auto userProfilePath = create_primary_cur_profile_dir_path(userId);
-            calculate_tree_size(userProfilePath, &stats.dataSize);
-            auto refProfilePath = create_primary_ref_profile_dir_path();
-            calculate_tree_size(refProfilePath, &stats.codeSize);
-            atrace_pm_end();
+            walks.push_back([&](struct stats* in, struct stats*) {
+                atrace_pm_begin("profile");
+                calculate_tree_size(create_primary_cur_profile_dir_path(userId), &in->dataSize);
+                calculate_tree_size(create_primary_ref_profile_dir_path(), &in->codeSize);
+                atrace_pm_end();
+            });
+            walks.push_back([&](struct stats* in, struct stats*) {
+                atrace_pm_begin("dalvik");
+                calculate_tree_size(create_data_dalvik_cache_path(), &in->codeSize);
+                calculate_tree_size(create_primary_cur_profile_dir_path(userId), &in->dataSize);
+                atrace_pm_end();
+            });
         }
 
-        atrace_pm_begin("external");
-        auto dataMediaPath = create_data_media_path(uuid_, userId);
-        collectManualExternalStatsForUser(dataMediaPath, &extStats);
+        std::vector<struct stats> walkStats(walks.size() * 2);
+        run_in_parallel(walks.size(), [&walks, &walkStats](size_t i) {
+            walks[i](&walkStats[i * 2], &walkStats[i * 2 + 1]);
+        });
+        for (size_t i = 0; i < walks.size(); i++) {
+            addStats(&stats, walkStats[i * 2]);
+            addStats(&extStats, walkStats[i * 2 + 1]);
+        }
 #if MEASURE_DEBUG
         LOG(DEBUG) << "Measured external data " << extStats.dataSize << " cache "
                 << extStats.cacheSize;
 #endif
-        atrace_pm_end();
-
-        if (!uuid) {
-            atrace_pm_begin("dalvik");
-            calculate_tree_size(create_data_dalvik_cache_path(), &stats.codeSize);
-            calculate_tree_size(create_primary_cur_profile_dir_path(userId), &stats.dataSize);
-            atrace_pm_end();
-        }
     }
 
     std::vector<int64_t> ret;
@@ -25,11 +25,13 @@
 #include <array>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <sstream>
 
 #include <android-base/file.h>
 #include <android-base/logging.h>
 #include <android-base/macros.h>
+#include <android-base/properties.h>
 #include <android-base/scopeguard.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
@@ -53,6 +55,12 @@ namespace installd {
 // so just try the possibilities one by one.
 static constexpr std::array kTryMountFsTypes = {"ext4", "erofs"};
 
+// Number of otapreopt processes to run at once. Each package is compiled into its own output files,
+// so packages can be compiled concurrently. Devices should only raise this together with lowering
+// the dex2oat thread count, to keep the total load and memory use in check.
+static constexpr const char* kJobsProperty = "ro.otapreopt.jobs";
+static constexpr int kMaxJobs = 8;
+
 static void CloseDescriptor(const char* descriptor_string) {
     int fd = -1;
     std::istringstream stream(descriptor_string);
@@ -143,9 +151,9 @@ static void TryExtraMount(const char* name, const char* slot, const char* target
 //
 //   "dexopt" [dexopt-params]
 //
-// are then read from stdin until EOF and passed on to /system/bin/otapreopt one
-// by one. After each call a line with the current command count is written to
-// stdout and flushed.
+// are then read from stdin until EOF and passed on to /system/bin/otapreopt,
+// running up to ro.otapreopt.jobs of them at once. After each call completes, a
+// line with the number of completed commands is written to stdout and flushed.
 static int otapreopt_chroot(const int argc, char **arg) {
     // Validate arguments
     if (argc == 2 && std::string_view(arg[1]) == "--version") {
@@ -352,6 +360,32 @@ static int otapreopt_chroot(const int argc, char **arg) {
 
     // Now go on and read dexopt lines from stdin and pass them on to otapreopt.
 
+    const int max_jobs = android::base::GetIntProperty(kJobsProperty, 1, 1, kMaxJobs);
+    LOG(INFO) << "Running up to " << max_jobs << " otapreopt jobs at once";
+
+    // Commands in flight, by pid.
+    std::map<pid_t, std::vector<std::string>> jobs;
+    int completed = 0;
+    auto wait_for_job = [&jobs, &completed]() {
+        int status;
+        pid_t pid = TEMP_FAILURE_RETRY(waitpid(-1, &status, 0));
+        auto job = jobs.find(pid);
+        if (job == jobs.end()) {
+            PLOG(ERROR) << "waitpid returned unexpected pid " << pid;
+            // Nothing left to wait for; forget the jobs rather than spin.
+            jobs.clear();
+            return;
+        }
+        std::string error_msg;
+        if (!CheckExecStatus(job->second, status, &error_msg)) {
+            LOG(ERROR) << "Running otapreopt failed: " << error_msg;
+        }
+        jobs.erase(job);
+
+        // Print the count to stdout and flush to indicate progress.
+        std::cout << ++completed << std::endl;
+    };
+
     int count = 1;
     for (std::array<char, 1000> linebuf;
          std::cin.clear(), std::cin.getline(&linebuf[0], linebuf.size()); ++count) {
@@ -360,6 +394,7 @@ static int otapreopt_chroot(const int argc, char **arg) {
 
         if (std::cin.fail()) {
             LOG(ERROR) << "Command exceeds max length " << linebuf.size() << " - skipped: " << line;
+            std::cout << ++completed << std::endl;
             continue;
         }
 
@@ -369,15 +404,23 @@ static int otapreopt_chroot(const int argc, char **arg) {
 
         LOG(INFO) << "Command " << count << ": " << android::base::Join(cmd, " ");
 
+        while (jobs.size() >= static_cast<size_t>(max_jobs)) {
+            wait_for_job();
+        }
+
         // Fork and execute otapreopt in its own process.
         std::string error_msg;
-        bool exec_result = Exec(cmd, &error_msg);
-        if (!exec_result) {
+        pid_t pid = ExecAsync(cmd, &error_msg);
+        if (pid == -1) {
             LOG(ERROR) << "Running otapreopt failed: " << error_msg;
+            std::cout << ++completed << std::endl;
+            continue;
         }
+        jobs.emplace(pid, std::move(cmd));
+    }
 
-        // Print the count to stdout and flush to indicate progress.
-        std::cout << count << std::endl;
+    while (!jobs.empty()) {
+        wait_for_job();
     }
 
     LOG(INFO) << "No more dexopt commands";
@@ -17,6 +17,8 @@
 #ifndef OTAPREOPT_UTILS_H_
 #define OTAPREOPT_UTILS_H_
 
+#include <sys/types.h>
+
 #include <regex>
 #include <string>
 #include <vector>
@@ -33,6 +35,16 @@ static inline bool ValidateTargetSlotSuffix(const std::string& input) {
 // Wrapper on fork/execv to run a command in a subprocess.
 bool Exec(const std::vector<std::string>& arg_vector, std::string* error_msg);
 
+// Starts a command in a subprocess without waiting for it. Returns the pid of the subprocess, or -1
+// with error_msg set if it could not be started. The caller must reap it with waitpid(), and may
+// pass the status to CheckExecStatus().
+pid_t ExecAsync(const std::vector<std::string>& arg_vector, std::string* error_msg);
+
+// Returns whether a command started by ExecAsync() exited successfully with the given waitpid()
+// status, setting error_msg otherwise.
+bool CheckExecStatus(const std::vector<std::string>& arg_vector, int status,
+                     std::string* error_msg);
+
 }  // namespace installd
 }  // namespace android
 
@@ -17,8 +17,10 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include <android-base/file.h>
 #include <android-base/logging.h>
 #include <android-base/scopeguard.h>
 #include <gmock/gmock.h>
@@ -48,6 +50,7 @@
 namespace android {
 namespace installd {
 
+using ::testing::Each;
 using ::testing::UnorderedElementsAre;
 
 class UtilsTest : public testing::Test {
@@ -754,5 +757,66 @@ TEST_F(UtilsTest, RemoveFileAtFd) {
     close(fd);
 }
 
+TEST_F(UtilsTest, RunInParallel) {
+    std::vector<int> calls(100, 0);
+    run_in_parallel(calls.size(), [&calls](size_t i) { calls[i]++; });
+    EXPECT_THAT(calls, Each(1));
+
+    bool called = false;
+    run_in_parallel(0, [&called](size_t) { called = true; });
+    EXPECT_FALSE(called);
+}
+
+TEST_F(UtilsTest, CloneDirectoryRecursive) {
+    auto deleter = [&]() {
+        delete_dir_contents_and_dir("/data/local/tmp/clone", true /* ignore_if_missing */);
+    };
+    auto scope_guard = android::base::make_scope_guard(deleter);
+
+    system("mkdir -p /data/local/tmp/clone/from/sub /data/local/tmp/clone/to");
+    system("echo foo > /data/local/tmp/clone/from/sub/file");
+    system("chmod 0640 /data/local/tmp/clone/from/sub/file");
+    system("ln -s sub/file /data/local/tmp/clone/from/link");
+
+    if (clone_directory_recursive("/data/local/tmp/clone/from", "/data/local/tmp/clone/to") != 0) {
+        if (errno == EOPNOTSUPP) {
+            GTEST_SKIP() << "Filesystem doesn't support FICLONE";
+        }
+        FAIL() << "Failed to clone: " << strerror(errno);
+    }
+
+    std::string content;
+    ASSERT_TRUE(android::base::ReadFileToString("/data/local/tmp/clone/to/from/sub/file",
+                                                &content));
+    EXPECT_EQ("foo\n", content);
+    struct stat st;
+    ASSERT_EQ(0, stat("/data/local/tmp/clone/to/from/sub/file", &st));
+    EXPECT_EQ(0640u, st.st_mode & 07777);
+    std::string target;
+    ASSERT_TRUE(android::base::Readlink("/data/local/tmp/clone/to/from/link", &target));
+    EXPECT_EQ("sub/file", target);
+}
+
+TEST_F(UtilsTest, CloneDirectoryRecursiveDoesNotFollowSymlinks) {
+    auto deleter = [&]() {
+        delete_dir_contents_and_dir("/data/local/tmp/clone", true /* ignore_if_missing */);
+    };
+    auto scope_guard = android::base::make_scope_guard(deleter);
+
+    system("mkdir -p /data/local/tmp/clone/from/sub /data/local/tmp/clone/to/from");
+    system("mkdir -p /data/local/tmp/clone/outside");
+    system("echo foo > /data/local/tmp/clone/from/sub/file");
+    // A directory in the destination replaced by a symlink to somewhere else.
+    system("ln -s ../../outside /data/local/tmp/clone/to/from/sub");
+
+    int rc = clone_directory_recursive("/data/local/tmp/clone/from", "/data/local/tmp/clone/to");
+    if (rc != 0 && errno == EOPNOTSUPP) {
+        GTEST_SKIP() << "Filesystem doesn't support FICLONE";
+    }
+    EXPECT_NE(0, rc);
+    struct stat st;
+    EXPECT_NE(0, lstat("/data/local/tmp/clone/outside/file", &st));
+}
+
 }  // namespace installd
 }  // namespace android
@@ -22,14 +22,20 @@
 #include <poll.h>
 #include <stdlib.h>
 #include <sys/capability.h>
+#include <sys/ioctl.h>
 #include <sys/pidfd.h>
 #include <sys/stat.h>
 #include <sys/statvfs.h>
+#include <sys/vfs.h>
 #include <sys/wait.h>
 #include <sys/xattr.h>
 #include <unistd.h>
 #include <uuid/uuid.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include <android-base/file.h>
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
@@ -38,6 +44,7 @@
 #include <cutils/fs.h>
 #include <cutils/properties.h>
 #include <linux/fs.h>
+#include <linux/magic.h>
 #include <log/log.h>
 #include <private/android_filesystem_config.h>
 #include <private/android_projectid_config.h>
@@ -65,6 +72,9 @@ using namespace std::literals;
 
 static constexpr auto deletedSuffix = "==deleted=="sv;
 
+// Walks are bound by the storage device, more threads than this only add contention.
+static constexpr size_t kMaxParallelWorkers = 4;
+
 /**
  * Check that given string is valid filename, and that it attempts no
  * parent or child directory traversal.
@@ -729,13 +739,18 @@ int rename_delete_dir_contents_and_dir(const std::string& pathname, bool ignore_
     return rename_delete_dir_contents(pathname, nullptr, ignore_if_missing);
 }
 
+struct DirCloser {
+    void operator()(DIR* d) const noexcept { ::closedir(d); }
+};
+
 static auto open_dir(const char* dir) {
-    struct DirCloser {
-        void operator()(DIR* d) const noexcept { ::closedir(d); }
-    };
     return std::unique_ptr<DIR, DirCloser>(::opendir(dir));
 }
 
+static auto open_dir(unique_fd fd) {
+    return std::unique_ptr<DIR, DirCloser>(Fdopendir(std::move(fd)));
+}
+
 // Collects filename of subdirectories of given directory and passes it to the function
 int foreach_subdir(const std::string& pathname, const std::function<void(const std::string&)> fn) {
     auto dir = open_dir(pathname.c_str());
@@ -764,6 +779,28 @@ int foreach_subdir(const std::string& pathname, const std::function<void(const s
     return 0;
 }
 
+void run_in_parallel(size_t count, const std::function<void(size_t)>& fn) {
+    size_t workers = std::min<size_t>({count, kMaxParallelWorkers,
+            std::max(1u, std::thread::hardware_concurrency())});
+    std::atomic<size_t> next = 0;
+    auto work = [&]() {
+        size_t i;
+        while ((i = next.fetch_add(1)) < count) {
+            fn(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers > 0 ? workers - 1 : 0);
+    for (size_t i = 1; i < workers; i++) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
 void cleanup_invalid_package_dirs_under_path(const std::string& pathname) {
     auto dir = open_dir(pathname.c_str());
     if (!dir) {
@@ -1440,5 +1477,207 @@ bool remove_file_at_fd(int fd, /*out*/ std::string* path) {
     return true;
 }
 
+// The walk below runs as root over app-controlled trees, so it never resolves a path of more than
+// one component: every entry is reached through its parent's fd with O_NOFOLLOW, and the app
+// cannot redirect it by swapping a directory for a symlink midway.
+
+// Path for the l*xattr calls on symlinks, which can't be opened. The parent is pinned by its fd and
+// the last component is not followed.
+static std::string entry_path(int dir_fd, const char* name) {
+    return StringPrintf("/proc/self/fd/%d/%s", dir_fd, name);
+}
+
+// Copies the xattrs between the opened entries, or between the symlinks at the given paths if the
+// fds are -1.
+static int copy_xattrs(int from_fd, const std::string& from_path, int to_fd,
+                       const std::string& to_path) {
+    auto list = [&](char* names, size_t size) {
+        return from_fd >= 0 ? flistxattr(from_fd, names, size)
+                            : llistxattr(from_path.c_str(), names, size);
+    };
+    auto get = [&](const char* name, void* value, size_t size) {
+        return from_fd >= 0 ? fgetxattr(from_fd, name, value, size)
+                            : lgetxattr(from_path.c_str(), name, value, size);
+    };
+    auto set = [&](const char* name, const void* value, size_t size) {
+        return to_fd >= 0 ? fsetxattr(to_fd, name, value, size, 0)
+                          : lsetxattr(to_path.c_str(), name, value, size, 0);
+    };
+
+    ssize_t names_size = list(nullptr, 0);
+    if (names_size <= 0) {
+        return names_size;
+    }
+    std::vector<char> names(names_size);
+    names_size = list(names.data(), names.size());
+    if (names_size < 0) {
+        return -1;
+    }
+    for (const char* name = names.data(); name < names.data() + names_size;
+         name += strlen(name) + 1) {
+        ssize_t value_size = get(name, nullptr, 0);
+        if (value_size < 0) {
+            return -1;
+        }
+        std::vector<char> value(value_size);
+        value_size = get(name, value.data(), value.size());
+        if (value_size < 0 || set(name, value.data(), value_size) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Owner, mode, xattrs and then timestamps, since each of the others may change the ctime or
+// clear the set-id bits. |to_fd| is the opened copy of a file or directory.
+static int copy_attributes(int from_fd, int to_fd, const struct stat& st) {
+    if (fchown(to_fd, st.st_uid, st.st_gid) != 0 || fchmod(to_fd, st.st_mode & 07777) != 0 ||
+        copy_xattrs(from_fd, "", to_fd, "") != 0) {
+        return -1;
+    }
+    const struct timespec times[] = {st.st_atim, st.st_mtim};
+    return futimens(to_fd, times);
+}
+
+// Same as above for the symlink |name|, which exists in both directories.
+static int copy_symlink_attributes(int from_dir, int to_dir, const char* name,
+                                   const struct stat& st) {
+    if (fchownat(to_dir, name, st.st_uid, st.st_gid, AT_SYMLINK_NOFOLLOW) != 0 ||
+        copy_xattrs(-1, entry_path(from_dir, name), -1, entry_path(to_dir, name)) != 0) {
+        return -1;
+    }
+    const struct timespec times[] = {st.st_atim, st.st_mtim};
+    return utimensat(to_dir, name, times, AT_SYMLINK_NOFOLLOW);
+}
+
+static int clone_file(int from_fd, int to_dir, const char* name, const struct stat& st) {
+    // Like "cp -F", replace rather than overwrite an existing destination.
+    if (unlinkat(to_dir, name, 0) != 0 && errno != ENOENT) {
+        return -1;
+    }
+    unique_fd to_fd(openat(to_dir, name, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC,
+                           0600));
+    if (to_fd < 0) {
+        return -1;
+    }
+
+    if (ioctl(to_fd.get(), FICLONE, from_fd) != 0) {
+        if (errno == EOPNOTSUPP || errno == ENOTTY || errno == EXDEV) {
+            errno = EOPNOTSUPP;
+            return -1;
+        }
+        // The filesystem can clone, but not this file, e.g. because of its inline data.
+        off_t remaining = st.st_size;
+        while (remaining > 0) {
+            ssize_t copied = copy_file_range(from_fd, nullptr, to_fd.get(), nullptr, remaining, 0);
+            if (copied < 0) {
+                return -1;
+            }
+            if (copied == 0) {
+                break;
+            }
+            remaining -= copied;
+        }
+    }
+    return copy_attributes(from_fd, to_fd.get(), st);
+}
+
+// Clones the entry |name| of |from_dir| to the same name in |to_dir|.
+static int clone_entry(int from_dir, int to_dir, const char* name) {
+    struct stat st;
+    if (fstatat(from_dir, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+        return -1;
+    }
+
+    if (S_ISLNK(st.st_mode)) {
+        std::string target(st.st_size + 1, '\0');
+        ssize_t size = readlinkat(from_dir, name, target.data(), target.size());
+        if (size < 0 || static_cast<size_t>(size) >= target.size()) {
+            // Retargeted since the fstatat, let cp handle it.
+            errno = size < 0 ? errno : EAGAIN;
+            return -1;
+        }
+        target.resize(size);
+        if ((unlinkat(to_dir, name, 0) != 0 && errno != ENOENT) ||
+            symlinkat(target.c_str(), to_dir, name) != 0) {
+            return -1;
+        }
+        return copy_symlink_attributes(from_dir, to_dir, name, st);
+    }
+    if (!S_ISDIR(st.st_mode) && !S_ISREG(st.st_mode)) {
+        // Leave sockets, pipes and device nodes to cp.
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+
+    // O_NONBLOCK so that a file swapped for a FIFO since the fstatat can't block the open. What
+    // was opened is checked again below, and only that fd is used from here on.
+    unique_fd from_fd(openat(from_dir, name,
+                             O_RDONLY | O_NOFOLLOW | O_NONBLOCK | O_CLOEXEC |
+                                     (S_ISDIR(st.st_mode) ? O_DIRECTORY : 0)));
+    if (from_fd < 0) {
+        return -1;
+    }
+    const mode_t type = st.st_mode & S_IFMT;
+    if (fstat(from_fd.get(), &st) != 0) {
+        return -1;
+    }
+    if ((st.st_mode & S_IFMT) != type) {
+        errno = EAGAIN;
+        return -1;
+    }
+    if (S_ISREG(st.st_mode)) {
+        return clone_file(from_fd.get(), to_dir, name, st);
+    }
+
+    // Like "cp -R", merge into an existing destination directory.
+    if (mkdirat(to_dir, name, 0700) != 0 && errno != EEXIST) {
+        return -1;
+    }
+    unique_fd to_fd(openat(to_dir, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC));
+    if (to_fd < 0) {
+        return -1;
+    }
+    unique_fd list_fd(dup(from_fd.get()));
+    if (list_fd < 0) {
+        return -1;
+    }
+    auto dir = open_dir(std::move(list_fd));
+    if (!dir) {
+        return -1;
+    }
+    struct dirent* de;
+    while ((de = readdir(dir.get()))) {
+        if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, "..")) {
+            continue;
+        }
+        if (clone_entry(from_fd.get(), to_fd.get(), de->d_name) != 0) {
+            return -1;
+        }
+    }
+    return copy_attributes(from_fd.get(), to_fd.get(), st);
+}
+
+int clone_directory_recursive(const std::string& from, const std::string& to) {
+    // ext4 and f2fs, which hold /data on most devices, cannot clone. Fail before touching the
+    // destination, rather than at the first file.
+    struct statfs fs;
+    if (statfs(from.c_str(), &fs) != 0) {
+        return -1;
+    }
+    if (fs.f_type == EXT4_SUPER_MAGIC || fs.f_type == F2FS_SUPER_MAGIC) {
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+
+    // Both paths are built by installd, only what lies below them is app-controlled.
+    unique_fd from_parent(open(Dirname(from).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+    unique_fd to_fd(open(to.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC));
+    if (from_parent < 0 || to_fd < 0) {
+        return -1;
+    }
+    return clone_entry(from_parent.get(), to_fd.get(), android::base::Basename(from).c_str());
+}
+
 }  // namespace installd
 }  // namespace android
@@ -134,6 +134,13 @@ int rename_delete_dir_contents_and_dir(const std::string& pathname, bool ignore_
 
 int foreach_subdir(const std::string& pathname, std::function<void(const std::string&)> fn);
 
+/**
+ * Calls fn(i) for every i in [0, count), spreading the calls over a small pool of worker
+ * threads that includes the calling thread. Returns once every call has returned. The calls
+ * may run concurrently and in any order, so fn must only touch state owned by its index.
+ */
+void run_in_parallel(size_t count, const std::function<void(size_t)>& fn);
+
 void cleanup_invalid_package_dirs_under_path(const std::string& pathname);
 
 int delete_dir_contents(const char *pathname,
@@ -188,6 +195,14 @@ void drop_capabilities(uid_t uid);
 // `path` if present.
 bool remove_file_at_fd(int fd, /*out*/ std::string* path = nullptr);
 
+// Copies the tree at `from` into the directory `to`, like "cp -R", preserving mode, ownership,
+// timestamps and xattrs. File contents are shared with the source through FICLONE, so the copy
+// costs neither time nor flash writes until either side is modified; a file that cannot be
+// cloned is copied instead. Returns 0 on success. Returns -1 with errno set to EOPNOTSUPP if the
+// filesystem cannot clone files, or with the errno of the failure otherwise, in both cases the
+// destination may hold a partial copy.
+int clone_directory_recursive(const std::string& from, const std::string& to);
+
 }  // namespace installd
 }  // namespace android
 
@@ -19,6 +19,7 @@
 #include <getopt.h>
 
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <functional>
 #include <iomanip>
@@ -26,6 +27,7 @@
 #include <map>
 #include <regex>
 #include <sstream>
+#include <thread>
 
 #include <android-base/file.h>
 #include <android-base/hex.h>
@@ -211,6 +213,7 @@ bool ListCommand::getPidInfo(
 }
 
 const BinderPidInfo* ListCommand::getPidInfoCached(pid_t serverPid) {
+    std::lock_guard<std::mutex> lock(mLock);
     auto pair = mCachedPidInfos.insert({serverPid, BinderPidInfo{}});
     if (pair.second /* did insertion take place? */) {
         if (!getPidInfo(serverPid, &pair.first->second)) {
@@ -613,16 +616,34 @@ Status ListCommand::fetchBinderized(const sp<IServiceManager> &manager) {
         return DUMP_BINDERIZED_ERROR;
     }
 
-    Status status = OK;
     std::map<std::string, TableEntry> allTableEntries;
+    std::vector<TableEntry*> entries;
     for (const auto& fqInstanceName : *fqInstanceNames) {
         // create entry and default assign all fields.
         TableEntry& entry = allTableEntries[fqInstanceName];
         entry.interfaceName = fqInstanceName;
         entry.transport = mode;
         entry.serviceStatus = ServiceStatus::NON_RESPONSIVE;
+        entries.push_back(&entry);
+    }
 
-        status |= fetchBinderizedEntry(manager, &entry);
+    // Each entry takes several IPCs, each of which may wait for a timeout, so query
+    // a few services at a time.
+    constexpr size_t kMaxFetchThreads = 8;
+    std::atomic<size_t> nextEntry = 0;
+    std::atomic<Status> status = OK;
+    auto fetchEntries = [&] {
+        for (size_t i = nextEntry++; i < entries.size(); i = nextEntry++) {
+            status |= fetchBinderizedEntry(manager, entries[i]);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min(kMaxFetchThreads, entries.size()); ++i) {
+        threads.emplace_back(fetchEntries);
+    }
+    fetchEntries();
+    for (auto& thread : threads) {
+        thread.join();
     }
 
     for (auto& pair : allTableEntries) {
@@ -635,7 +656,11 @@ Status ListCommand::fetchBinderizedEntry(const sp<IServiceManager> &manager,
                                          TableEntry *entry) {
     Status status = OK;
     const auto handleError = [&](Status additionalError, const std::string& msg) {
-        err() << "Warning: Skipping \"" << entry->interfaceName << "\": " << msg << std::endl;
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            err() << "Warning: Skipping \"" << entry->interfaceName << "\": " << msg
+                  << std::endl;
+        }
         status |= DUMP_BINDERIZED_ERROR | additionalError;
     };
 
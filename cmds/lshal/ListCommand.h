@@ -20,6 +20,7 @@
 #include <stdint.h>
 
 #include <fstream>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -187,6 +188,8 @@ protected:
 
     // Cache for getPidInfo.
     std::map<pid_t, BinderPidInfo> mCachedPidInfos;
+    // Guards mCachedPidInfos and err() while binderized entries are fetched in parallel.
+    std::mutex mLock;
 
     // Cache for getPartition.
     std::map<pid_t, Partition> mPartitions;
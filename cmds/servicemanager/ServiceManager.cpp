@@ -24,6 +24,7 @@
 #include <binder/Stability.h>
 #include <cutils/android_filesystem_config.h>
 #include <cutils/multiuser.h>
+#include <algorithm>
 #include <thread>
 
 #ifndef VENDORSERVICEMANAGER
@@ -282,9 +283,26 @@ Status ServiceManager::checkService(const std::string& name, sp<IBinder>* outBin
     return Status::ok();
 }
 
-sp<IBinder> ServiceManager::tryGetService(const std::string& name, bool startIfNotFound) {
+Status ServiceManager::checkServices(const std::vector<std::string>& names,
+                                     std::optional<std::vector<sp<IBinder>>>* outBinders) {
+    // The calling context is looked up once for the whole batch.
     auto ctx = mAccess->getCallingContext();
 
+    outBinders->emplace();
+    (*outBinders)->reserve(names.size());
+    for (const std::string& name : names) {
+        (*outBinders)->push_back(tryGetService(ctx, name, false));
+    }
+    // returns ok regardless of result, like checkService
+    return Status::ok();
+}
+
+sp<IBinder> ServiceManager::tryGetService(const std::string& name, bool startIfNotFound) {
+    return tryGetService(mAccess->getCallingContext(), name, startIfNotFound);
+}
+
+sp<IBinder> ServiceManager::tryGetService(const Access::CallingContext& ctx,
+                                          const std::string& name, bool startIfNotFound) {
     sp<IBinder> out;
     Service* service = nullptr;
     if (auto it = mNameToService.find(name); it != mNameToService.end()) {
@@ -300,6 +318,11 @@ sp<IBinder> ServiceManager::tryGetService(const std::string& name, bool startIfN
         return nullptr;
     }
 
+    if (startIfNotFound) {
+        startFollower(ctx, name);
+        learnFollower(ctx, name, out != nullptr);
+    }
+
     if (!out && startIfNotFound) {
         tryStartService(name);
     }
@@ -318,6 +341,65 @@ sp<IBinder> ServiceManager::tryGetService(const std::string& name, bool startIfN
     return out;
 }
 
+// A lazy service started within this time of getting another service is considered to follow it.
+static constexpr auto kFollowerWindow = std::chrono::seconds(1);
+// The number of times (net of other followers) a lazy service must have followed another service
+// before it is started ahead of time.
+static constexpr size_t kMinFollowerConfidence = 3;
+static constexpr size_t kMaxFollowerConfidence = 8;
+// Above this many client processes, lookups older than kFollowerWindow are forgotten.
+static constexpr size_t kMaxLastLookups = 64;
+
+void ServiceManager::learnFollower(const Access::CallingContext& ctx, const std::string& name,
+                                   bool found) {
+    const auto now = std::chrono::steady_clock::now();
+    auto [it, inserted] = mPidToLastLookup.try_emplace(ctx.debugPid);
+    LastLookup& last = it->second;
+
+    // Only learn lazy services following registered ones, so that the followers are keyed by a
+    // bounded set of names.
+    if (!inserted && last.found && !found && last.name != name &&
+        now - last.time <= kFollowerWindow) {
+        Follower& follower = mNameToFollower[last.name];
+        if (follower.name == name) {
+            follower.confidence = std::min(follower.confidence + 1, kMaxFollowerConfidence);
+        } else if (follower.confidence > 0) {
+            follower.confidence--;
+        } else {
+            follower = Follower{name, 1};
+        }
+    }
+    last = LastLookup{name, found, now};
+
+    if (mPidToLastLookup.size() > kMaxLastLookups) {
+        for (auto lookupIt = mPidToLastLookup.begin(); lookupIt != mPidToLastLookup.end();) {
+            if (now - lookupIt->second.time > kFollowerWindow) {
+                lookupIt = mPidToLastLookup.erase(lookupIt);
+            } else {
+                ++lookupIt;
+            }
+        }
+    }
+}
+
+void ServiceManager::startFollower(const Access::CallingContext& ctx, const std::string& name) {
+    auto it = mNameToFollower.find(name);
+    if (it == mNameToFollower.end() || it->second.confidence < kMinFollowerConfidence) {
+        return;
+    }
+
+    const std::string& follower = it->second.name;
+    if (mNameToService.count(follower) > 0 || !mAccess->canFind(ctx, follower)) {
+        return;
+    }
+
+    // If it turns out not to be used, the service will shut down again like any lazy service
+    // without clients.
+    ALOGI("Starting '%s' ahead of time, since it usually follows '%s'.", follower.c_str(),
+          name.c_str());
+    tryStartService(follower);
+}
+
 bool isValidServiceName(const std::string& name) {
     if (name.size() == 0) return false;
     if (name.size() > 127) return false;
@@ -897,6 +979,8 @@ void ServiceManager::clear() {
     mNameToService.clear();
     mNameToRegistrationCallback.clear();
     mNameToClientCallback.clear();
+    mNameToFollower.clear();
+    mPidToLastLookup.clear();
 }
 
 }  // namespace android
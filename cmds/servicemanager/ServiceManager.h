@@ -22,6 +22,8 @@
 
 #include "Access.h"
 
+#include <chrono>
+
 namespace android {
 
 using os::ConnectionInfo;
@@ -37,6 +39,8 @@ public:
     // getService will try to start any services it cannot find
     binder::Status getService(const std::string& name, sp<IBinder>* outBinder) override;
     binder::Status checkService(const std::string& name, sp<IBinder>* outBinder) override;
+    binder::Status checkServices(const std::vector<std::string>& names,
+                                 std::optional<std::vector<sp<IBinder>>>* outBinders) override;
     binder::Status addService(const std::string& name, const sp<IBinder>& binder,
                               bool allowIsolated, int32_t dumpPriority) override;
     binder::Status listServices(int32_t dumpPriority, std::vector<std::string>* outList) override;
@@ -84,6 +88,19 @@ private:
         ~Service();
     };
 
+    // A lazy service that clients tend to get right after getting the service this is keyed by.
+    struct Follower {
+        std::string name;
+        size_t confidence = 0;
+    };
+
+    // The last service a client process tried to get, to learn followers from.
+    struct LastLookup {
+        std::string name;
+        bool found;
+        std::chrono::steady_clock::time_point time;
+    };
+
     using ServiceCallbackMap = std::map<std::string, std::vector<sp<IServiceCallback>>>;
     using ClientCallbackMap = std::map<std::string, std::vector<sp<IClientCallback>>>;
     using ServiceMap = std::map<std::string, Service>;
@@ -103,11 +120,21 @@ private:
     // this updates the iterator to the next location
     void removeClientCallback(const wp<IBinder>& who, ClientCallbackMap::iterator* it);
 
+    // learns whether 'name', which had to be started if not found, followed the client's
+    // previous lookup
+    void learnFollower(const Access::CallingContext& ctx, const std::string& name, bool found);
+    // starts the service which usually follows 'name', if it isn't running already
+    void startFollower(const Access::CallingContext& ctx, const std::string& name);
+
     sp<IBinder> tryGetService(const std::string& name, bool startIfNotFound);
+    sp<IBinder> tryGetService(const Access::CallingContext& ctx, const std::string& name,
+                              bool startIfNotFound);
 
     ServiceMap mNameToService;
     ServiceCallbackMap mNameToRegistrationCallback;
     ClientCallbackMap mNameToClientCallback;
+    std::map<std::string, Follower> mNameToFollower;
+    std::map<pid_t, LastLookup> mPidToLastLookup;
 
     std::unique_ptr<Access> mAccess;
 };
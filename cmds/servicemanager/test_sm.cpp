@@ -262,6 +262,69 @@ TEST(GetService, NotAllowedFromIsolated) {
     EXPECT_EQ(nullptr, out.get());
 }
 
+TEST(GetService, StartsUsualFollowerAheadOfTime) {
+    std::unique_ptr<MockAccess> access = std::make_unique<NiceMock<MockAccess>>();
+
+    ON_CALL(*access, getCallingContext()).WillByDefault(Return(Access::CallingContext{}));
+    ON_CALL(*access, canAdd(_, _)).WillByDefault(Return(true));
+    ON_CALL(*access, canFind(_, _)).WillByDefault(Return(true));
+
+    sp<MockServiceManager> sm = sp<NiceMock<MockServiceManager>>::make(std::move(access));
+
+    EXPECT_TRUE(sm->addService("foo", getBinder(), false /*allowIsolated*/,
+        IServiceManager::DUMP_FLAG_PRIORITY_DEFAULT).isOk());
+
+    // three lookups of "bar" right after "foo" start it, and then the next lookup of "foo" does
+    EXPECT_CALL(*sm, tryStartService("bar")).Times(4);
+
+    sp<IBinder> out;
+    for (int i = 0; i < 3; i++) {
+        EXPECT_TRUE(sm->getService("foo", &out).isOk());
+        EXPECT_TRUE(sm->getService("bar", &out).isOk());
+    }
+    EXPECT_TRUE(sm->getService("foo", &out).isOk());
+}
+
+TEST(CheckServices, HappyHappy) {
+    auto sm = getPermissiveServiceManager();
+    sp<IBinder> foo = getBinder();
+    sp<IBinder> bar = getBinder();
+
+    EXPECT_TRUE(sm->addService("foo", foo, false /*allowIsolated*/,
+        IServiceManager::DUMP_FLAG_PRIORITY_DEFAULT).isOk());
+    EXPECT_TRUE(sm->addService("bar", bar, false /*allowIsolated*/,
+        IServiceManager::DUMP_FLAG_PRIORITY_DEFAULT).isOk());
+
+    std::optional<std::vector<sp<IBinder>>> out;
+    EXPECT_TRUE(sm->checkServices({"bar", "baz", "foo"}, &out).isOk());
+    ASSERT_TRUE(out.has_value());
+    EXPECT_EQ((std::vector<sp<IBinder>>{bar, nullptr, foo}), *out);
+}
+
+TEST(CheckServices, CallingContextLookedUpOnce) {
+    std::unique_ptr<MockAccess> access = std::make_unique<NiceMock<MockAccess>>();
+
+    EXPECT_CALL(*access, getCallingContext())
+        // something adds it
+        .WillOnce(Return(Access::CallingContext{}))
+        // one lookup for the whole batch
+        .WillOnce(Return(Access::CallingContext{}));
+    EXPECT_CALL(*access, canAdd(_, _)).WillOnce(Return(true));
+    EXPECT_CALL(*access, canFind(_, "foo")).WillOnce(Return(true));
+    EXPECT_CALL(*access, canFind(_, "bar")).WillOnce(Return(false));
+
+    sp<ServiceManager> sm = sp<NiceMock<MockServiceManager>>::make(std::move(access));
+
+    sp<IBinder> service = getBinder();
+    EXPECT_TRUE(sm->addService("foo", service, false /*allowIsolated*/,
+        IServiceManager::DUMP_FLAG_PRIORITY_DEFAULT).isOk());
+
+    std::optional<std::vector<sp<IBinder>>> out;
+    EXPECT_TRUE(sm->checkServices({"foo", "bar"}, &out).isOk());
+    ASSERT_TRUE(out.has_value());
+    EXPECT_EQ((std::vector<sp<IBinder>>{service, nullptr}), *out);
+}
+
 TEST(ListServices, NoPermissions) {
     std::unique_ptr<MockAccess> access = std::make_unique<NiceMock<MockAccess>>();
 
@@ -115,6 +115,11 @@ status_t Replayer::replay() {
 
     initReplay();
 
+    // Increments are scheduled against the recorded timeline, anchored at the start of the replay,
+    // so that the time spent issuing each increment doesn't add up to drift over a long trace.
+    const int64_t firstTimeStamp = mCurrentTime;
+    auto replayStart = std::chrono::steady_clock::now();
+
     ALOGV("Starting actual Replay!");
     while (!mPendingIncrements.empty()) {
         mCurrentIncrement = mTrace.increment(mIncrementIndex);
@@ -124,10 +129,17 @@ status_t Replayer::replay() {
             sReplayingManually.store(true);
         }
 
+        // Time spent paused in manual replay shifts the rest of the timeline.
+        const auto pauseStart = std::chrono::steady_clock::now();
         waitForConsoleCommmand();
+        replayStart += std::chrono::steady_clock::now() - pauseStart;
 
         if (mWaitForTimeStamps) {
-            waitUntilTimestamp(mCurrentIncrement.time_stamp());
+            const auto deadline = replayStart +
+                    std::chrono::nanoseconds(mCurrentIncrement.time_stamp() - firstTimeStamp);
+            ALOGV("Waiting until %lld nanoseconds into the replay...",
+                  static_cast<long long>(mCurrentIncrement.time_stamp() - firstTimeStamp));
+            std::this_thread::sleep_until(deadline);
         }
 
         auto event = mPendingIncrements.front();
@@ -652,11 +664,6 @@ void Replayer::updatePowerMode(const PowerModeUpdate& pmu, const std::shared_ptr
     SurfaceComposerClient::setDisplayPowerMode(mDisplays[pmu.id()], pmu.mode());
 }
 
-void Replayer::waitUntilTimestamp(int64_t timestamp) {
-    ALOGV("Waiting for %lld nanoseconds...", static_cast<int64_t>(timestamp - mCurrentTime));
-    std::this_thread::sleep_for(std::chrono::nanoseconds(timestamp - mCurrentTime));
-}
-
 status_t Replayer::loadSurfaceComposerClient() {
     mComposerClient = new SurfaceComposerClient;
     return mComposerClient->initCheck();
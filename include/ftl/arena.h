@@ -0,0 +1,163 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace android::ftl {
+
+// Monotonic allocator for short-lived objects, e.g. the temporaries of a single frame. Allocation
+// bumps a pointer within a chunk of memory, and deallocation is a no-op. Memory is reclaimed in bulk
+// by reset(), which keeps the chunks for reuse, so a workload that repeats every frame stops
+// allocating from the heap once the arena has grown to its peak size.
+//
+// Objects must be destroyed before reset() is called, and the arena must outlive any container
+// whose ArenaAllocator refers to it. The arena is not thread-safe.
+//
+// Example usage:
+//
+//   ftl::Arena arena;
+//
+//   for (int frame = 0; frame < 3; ++frame) {
+//     {
+//       ftl::ArenaVector<int> layers(arena);
+//       layers.push_back(frame);
+//       assert(arena.bytes_used() > 0);
+//     }
+//     arena.reset();
+//     assert(arena.bytes_used() == 0);
+//   }
+//
+class Arena final {
+ public:
+  static constexpr std::size_t kDefaultChunkSize = 4096;
+
+  explicit Arena(std::size_t chunk_size = kDefaultChunkSize) : chunk_size_(chunk_size) {}
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Returns uninitialized memory of the given size and alignment, which must be a power of two.
+  void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+    if (void* ptr = bump(size, alignment)) return ptr;
+
+    // Move on to the next chunk that is large enough, or add one.
+    const std::size_t needed = size + alignment - 1;
+    std::size_t next = chunks_.empty() ? 0 : current_ + 1;
+    while (next < chunks_.size() && chunks_[next].size < needed) ++next;
+    if (next == chunks_.size()) {
+      const std::size_t chunk_size = std::max(chunk_size_, needed);
+      chunks_.push_back({std::make_unique<std::byte[]>(chunk_size), chunk_size});
+    }
+
+    used_ += offset_;
+    offset_ = 0;
+    current_ = next;
+    return bump(size, alignment);
+  }
+
+  // Reclaims all allocations at once, without returning memory to the heap.
+  void reset() {
+    current_ = 0;
+    offset_ = 0;
+    used_ = 0;
+  }
+
+  // Returns the number of bytes handed out since the last reset, including alignment padding.
+  std::size_t bytes_used() const { return used_ + offset_; }
+
+  // Returns the number of bytes held by the arena.
+  std::size_t bytes_reserved() const {
+    std::size_t bytes = 0;
+    for (const auto& chunk : chunks_) bytes += chunk.size;
+    return bytes;
+  }
+
+ private:
+  struct Chunk {
+    std::unique_ptr<std::byte[]> data;
+    std::size_t size;
+  };
+
+  void* bump(std::size_t size, std::size_t alignment) {
+    if (current_ >= chunks_.size()) return nullptr;
+
+    const Chunk& chunk = chunks_[current_];
+    const auto base = reinterpret_cast<std::uintptr_t>(chunk.data.get());
+    const std::uintptr_t aligned = (base + offset_ + alignment - 1) & ~(alignment - 1);
+    const std::size_t end = static_cast<std::size_t>(aligned - base) + size;
+    if (end > chunk.size) return nullptr;
+
+    offset_ = end;
+    return reinterpret_cast<void*>(aligned);
+  }
+
+  const std::size_t chunk_size_;
+
+  std::vector<Chunk> chunks_;
+
+  // Index of the chunk being bumped, and the offset of its first free byte.
+  std::size_t current_ = 0;
+  std::size_t offset_ = 0;
+
+  // Bytes used in chunks preceding |current_|.
+  std::size_t used_ = 0;
+};
+
+// Allocator that draws from an Arena, for use with standard containers.
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  ArenaAllocator(Arena& arena) : arena_(&arena) {}  // NOLINT(google-explicit-constructor)
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena_) {}
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T*, std::size_t) {}
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U>& other) const {
+    return arena_ == other.arena_;
+  }
+
+  // TODO: Remove in C++20.
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U>& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  template <typename>
+  friend class ArenaAllocator;
+
+  Arena* arena_;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+}  // namespace android::ftl
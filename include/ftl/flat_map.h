@@ -0,0 +1,438 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <ftl/optional.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace android::ftl {
+
+// Associative container with unique, unordered keys, backed by an open-addressing hash table with
+// linear probing. Unlike std::unordered_map, key-value pairs are stored inline in a single array of
+// slots rather than in per-node allocations, so lookups touch contiguous memory. Erasure moves later
+// mappings of the cluster into the vacated slot instead of leaving a tombstone, so lookup cost does
+// not degrade as mappings churn. The API follows SmallMap, which remains the better choice for maps
+// that hold a handful of mappings and can avoid hashing altogether.
+//
+// Mappings are relocated by move construction on rehash and erase, so neither pointers nor
+// iterators to them are stable across those operations. As the key of a mapping is const, it is
+// copied on relocation.
+//
+// Example usage:
+//
+//   ftl::FlatMap<int, std::string> map;
+//   assert(map.empty());
+//
+//   map.try_emplace(123, "abc");
+//   map.try_emplace(-1);
+//   map.try_emplace(42, 3u, '?');
+//   assert(map.size() == 3u);
+//
+//   assert(map.contains(123));
+//   assert(map.get(42).transform([](const std::string& s) { return s.size(); }) == 3u);
+//
+//   const auto opt = map.get(-1);
+//   assert(opt);
+//
+//   std::string& ref = *opt;
+//   assert(ref.empty());
+//   ref = "xyz";
+//
+//   map.emplace_or_replace(0, "vanilla", 2u, 3u);
+//   assert(map.get(0)->get() == "nil");
+//
+//   assert(map.erase(123));
+//   assert(!map.contains(123));
+//
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class FlatMap final {
+  struct Slot;
+
+  template <bool kConst>
+  class Iterator;
+
+ public:
+  using key_type = K;
+  using mapped_type = V;
+
+  using value_type = std::pair<const K, V>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  using reference = value_type&;
+  using iterator = Iterator<false>;
+
+  using const_reference = const value_type&;
+  using const_iterator = Iterator<true>;
+
+  // Creates an empty map, which does not allocate until the first mapping is emplaced.
+  FlatMap() = default;
+
+  FlatMap(const FlatMap& other) : FlatMap() {
+    reserve(other.size());
+    for (const auto& [k, v] : other) {
+      try_emplace(k, v);
+    }
+  }
+
+  FlatMap(FlatMap&& other) noexcept
+      : slots_(std::move(other.slots_)),
+        capacity_(std::exchange(other.capacity_, 0)),
+        size_(std::exchange(other.size_, 0)) {}
+
+  FlatMap& operator=(FlatMap other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  ~FlatMap() { clear(); }
+
+  void swap(FlatMap& other) noexcept {
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+  }
+
+  size_type size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Returns the number of slots, which is zero or a power of two. The map is rehashed when it would
+  // otherwise exceed a load factor of kMaxLoadNumerator / kMaxLoadDenominator.
+  size_type capacity() const { return capacity_; }
+
+  iterator begin() { return {slots_.get(), slots_.get() + capacity_}; }
+  const_iterator begin() const { return cbegin(); }
+  const_iterator cbegin() const { return {slots_.get(), slots_.get() + capacity_}; }
+
+  iterator end() { return {slots_.get() + capacity_, slots_.get() + capacity_}; }
+  const_iterator end() const { return cend(); }
+  const_iterator cend() const { return {slots_.get() + capacity_, slots_.get() + capacity_}; }
+
+  // Ensures that n mappings fit without rehashing.
+  void reserve(size_type n) {
+    size_type capacity = kMinCapacity;
+    while (capacity * kMaxLoadNumerator < n * kMaxLoadDenominator) {
+      capacity *= 2;
+    }
+    if (capacity > capacity_) rehash(capacity);
+  }
+
+  // Returns whether a mapping exists for the given key.
+  bool contains(const key_type& key) const { return find_slot(key) != nullptr; }
+
+  // Returns a reference to the value for the given key, or std::nullopt if the key was not found.
+  auto get(const key_type& key) const -> Optional<std::reference_wrapper<const mapped_type>> {
+    if (const Slot* slot = find_slot(key)) {
+      return std::cref(slot->pair().second);
+    }
+    return {};
+  }
+
+  auto get(const key_type& key) -> Optional<std::reference_wrapper<mapped_type>> {
+    if (Slot* slot = const_cast<Slot*>(std::as_const(*this).find_slot(key))) {
+      return std::ref(slot->pair().second);
+    }
+    return {};
+  }
+
+  // Returns an iterator to an existing mapping for the given key, or the end() iterator otherwise.
+  const_iterator find(const key_type& key) const {
+    const Slot* slot = find_slot(key);
+    return slot ? const_iterator(slot, slots_.get() + capacity_) : cend();
+  }
+
+  iterator find(const key_type& key) {
+    Slot* slot = const_cast<Slot*>(std::as_const(*this).find_slot(key));
+    return slot ? iterator(slot, slots_.get() + capacity_) : end();
+  }
+
+  // Inserts a mapping unless it exists. Returns an iterator to the inserted or existing mapping,
+  // and whether the mapping was inserted.
+  //
+  // On emplace, all iterators are invalidated if the map is rehashed. Otherwise, iterators remain
+  // valid, but may no longer visit every mapping.
+  //
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args) {
+    if (const auto it = find(key); it != end()) {
+      return {it, false};
+    }
+
+    reserve(size_ + 1);
+
+    Slot* slot = slots_.get() + home(key);
+    Slot* const last = slots_.get() + capacity_;
+    std::uint32_t probe = 1;
+    while (slot->occupied()) {
+      ++probe;
+      if (++slot == last) slot = slots_.get();
+    }
+
+    slot->emplace(probe, std::piecewise_construct, std::forward_as_tuple(key),
+                  std::forward_as_tuple(std::forward<Args>(args)...));
+    ++size_;
+    return {iterator(slot, last), true};
+  }
+
+  // Replaces a mapping if it exists, and returns an iterator to it. Returns the end() iterator
+  // otherwise.
+  //
+  // The value is replaced via move constructor, so type V does not need to define copy/move
+  // assignment, e.g. its data members may be const.
+  //
+  // Iterators to the replaced mapping point to its replacement, and others remain valid.
+  //
+  template <typename... Args>
+  iterator try_replace(const key_type& key, Args&&... args) {
+    const auto it = find(key);
+    if (it == end()) return it;
+    it.slot_->replace(std::forward<Args>(args)...);
+    return it;
+  }
+
+  // In-place counterpart of std::unordered_map's insert_or_assign. Returns true on emplace, or
+  // false on replace.
+  //
+  // The value is emplaced and replaced via move constructor, so type V does not need to define
+  // copy/move assignment, e.g. its data members may be const.
+  //
+  // On emplace, iterators are invalidated as for try_emplace. On replace, iterators to the replaced
+  // mapping point to its replacement, and others remain valid.
+  //
+  template <typename... Args>
+  std::pair<iterator, bool> emplace_or_replace(const key_type& key, Args&&... args) {
+    const auto [it, ok] = try_emplace(key, std::forward<Args>(args)...);
+    if (ok) return {it, ok};
+    it.slot_->replace(std::forward<Args>(args)...);
+    return {it, ok};
+  }
+
+  // Removes a mapping if it exists, and returns whether it did.
+  //
+  // All iterators are invalidated.
+  //
+  bool erase(const key_type& key) {
+    Slot* slot = const_cast<Slot*>(std::as_const(*this).find_slot(key));
+    if (!slot) return false;
+
+    // Fill the hole left by the mapping with a later mapping of the same cluster, if the hole is
+    // on that mapping's probe sequence. Repeat for the hole that this leaves, until the cluster
+    // ends at an empty slot.
+    const size_type mask = capacity_ - 1;
+    size_type hole = static_cast<size_type>(slot - slots_.get());
+    for (size_type i = (hole + 1) & mask; slots_[i].occupied(); i = (i + 1) & mask) {
+      const size_type distance = (i - hole) & mask;
+      if (slots_[i].probe_ <= distance) continue;
+
+      slots_[hole].destroy();
+      slots_[hole].emplace(slots_[i].probe_ - static_cast<std::uint32_t>(distance),
+                           std::move(slots_[i].pair()));
+      hole = i;
+    }
+
+    slots_[hole].destroy();
+    --size_;
+    return true;
+  }
+
+  // Removes all mappings, but keeps the allocated slots.
+  //
+  // All iterators are invalidated.
+  //
+  void clear() {
+    if (size_ == 0) return;
+    for (size_type i = 0; i < capacity_; ++i) {
+      if (slots_[i].occupied()) slots_[i].destroy();
+    }
+    size_ = 0;
+  }
+
+ private:
+  static constexpr size_type kMinCapacity = 8;
+  static constexpr size_type kMaxLoadNumerator = 3;
+  static constexpr size_type kMaxLoadDenominator = 4;
+
+  struct Slot {
+    bool occupied() const { return probe_ != 0; }
+
+    value_type& pair() { return *std::launder(reinterpret_cast<value_type*>(storage_)); }
+    const value_type& pair() const {
+      return *std::launder(reinterpret_cast<const value_type*>(storage_));
+    }
+
+    template <typename... Args>
+    void emplace(std::uint32_t probe, Args&&... args) {
+      new (storage_) value_type(std::forward<Args>(args)...);
+      probe_ = probe;
+    }
+
+    template <typename... Args>
+    void replace(Args&&... args) {
+      // Construct the replacement first, as the arguments may refer to the replaced value.
+      V value(std::forward<Args>(args)...);
+      auto& ref = pair().second;
+      ref.~V();
+      new (&ref) V(std::move(value));
+    }
+
+    void destroy() {
+      pair().~value_type();
+      probe_ = 0;
+    }
+
+    // Zero if the slot is empty. Otherwise, one more than the distance from the home slot of the
+    // key, i.e. the length of the probe sequence that ends at this slot.
+    std::uint32_t probe_ = 0;
+    alignas(value_type) std::byte storage_[sizeof(value_type)];
+  };
+
+  template <bool kConst>
+  class Iterator {
+    friend FlatMap;
+
+    using SlotPtr = std::conditional_t<kConst, const Slot*, Slot*>;
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename FlatMap::value_type;
+    using difference_type = typename FlatMap::difference_type;
+    using pointer = std::conditional_t<kConst, const value_type*, value_type*>;
+    using reference = std::conditional_t<kConst, const value_type&, value_type&>;
+
+    Iterator() = default;
+
+    Iterator(SlotPtr slot, SlotPtr last) : slot_(slot), last_(last) { skip_empty(); }
+
+    // Converts from iterator to const_iterator.
+    template <bool kOtherConst, typename = std::enable_if_t<kConst && !kOtherConst>>
+    Iterator(const Iterator<kOtherConst>& other) : slot_(other.slot_), last_(other.last_) {}
+
+    reference operator*() const { return slot_->pair(); }
+    pointer operator->() const { return &slot_->pair(); }
+
+    Iterator& operator++() {
+      ++slot_;
+      skip_empty();
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator it = *this;
+      ++*this;
+      return it;
+    }
+
+    friend bool operator==(const Iterator& lhs, const Iterator& rhs) {
+      return lhs.slot_ == rhs.slot_;
+    }
+
+    friend bool operator!=(const Iterator& lhs, const Iterator& rhs) { return !(lhs == rhs); }
+
+   private:
+    template <bool>
+    friend class Iterator;
+
+    void skip_empty() {
+      while (slot_ != last_ && !slot_->occupied()) ++slot_;
+    }
+
+    SlotPtr slot_ = nullptr;
+    SlotPtr last_ = nullptr;
+  };
+
+  // Returns the index of the slot where the probe sequence for the key starts. The hash is scrambled
+  // by Fibonacci hashing, since std::hash is the identity for integers, and keys that are multiples
+  // of a power of two would otherwise collide on the low bits.
+  size_type home(const key_type& key) const {
+    constexpr std::uint64_t kGoldenRatio = 0x9e3779b97f4a7c15ull;
+    const std::uint64_t hash = static_cast<std::uint64_t>(Hash{}(key)) * kGoldenRatio;
+    return static_cast<size_type>(hash >> 32) & (capacity_ - 1);
+  }
+
+  const Slot* find_slot(const key_type& key) const {
+    if (size_ == 0) return nullptr;
+
+    const Slot* slot = slots_.get() + home(key);
+    const Slot* const last = slots_.get() + capacity_;
+    while (slot->occupied()) {
+      if (KeyEqual{}(slot->pair().first, key)) return slot;
+      if (++slot == last) slot = slots_.get();
+    }
+    return nullptr;
+  }
+
+  void rehash(size_type capacity) {
+    FlatMap other;
+    other.slots_ = std::make_unique<Slot[]>(capacity);
+    other.capacity_ = capacity;
+
+    for (size_type i = 0; i < capacity_; ++i) {
+      Slot& source = slots_[i];
+      if (!source.occupied()) continue;
+
+      Slot* slot = other.slots_.get() + other.home(source.pair().first);
+      Slot* const last = other.slots_.get() + capacity;
+      std::uint32_t probe = 1;
+      while (slot->occupied()) {
+        ++probe;
+        if (++slot == last) slot = other.slots_.get();
+      }
+
+      slot->emplace(probe, std::move(source.pair()));
+      source.destroy();
+    }
+
+    other.size_ = std::exchange(size_, 0);
+    swap(other);
+  }
+
+  std::unique_ptr<Slot[]> slots_;
+  size_type capacity_ = 0;
+  size_type size_ = 0;
+};
+
+// Returns whether the key-value pairs of two maps are equal.
+template <typename K, typename V, typename H, typename E>
+bool operator==(const FlatMap<K, V, H, E>& lhs, const FlatMap<K, V, H, E>& rhs) {
+  if (lhs.size() != rhs.size()) return false;
+
+  for (const auto& [k, v] : lhs) {
+    const auto& lv = v;
+    if (!rhs.get(k).transform([&lv](const V& rv) { return lv == rv; }).value_or(false)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// TODO: Remove in C++20.
+template <typename K, typename V, typename H, typename E>
+inline bool operator!=(const FlatMap<K, V, H, E>& lhs, const FlatMap<K, V, H, E>& rhs) {
+  return !(lhs == rhs);
+}
+
+}  // namespace android::ftl
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <future>
 #include <type_traits>
 #include <utility>
@@ -48,6 +49,17 @@ class Future final : public details::BaseFuture<Future<T, FutureImpl>, T, Future
     return std::holds_alternative<T>(future_) || std::get<FutureImpl<T>>(future_).valid();
   }
 
+  // Waits for the result for at most the given duration, as if by FutureImpl<T>::wait_for. A pure
+  // value created via ftl::yield is always ready.
+  template <typename Rep, typename Period>
+  std::future_status wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+    if (std::holds_alternative<T>(future_)) {
+      return std::future_status::ready;
+    }
+
+    return std::get<FutureImpl<T>>(future_).wait_for(timeout);
+  }
+
   // Forwarding functions. Base::share is only defined when FutureImpl is std::future, whereas the
   // following are defined for either FutureImpl:
   using Base::get;
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace android::ftl {
+
+// Unbounded FIFO queue with lock-free push from any number of producer threads, and pop from a
+// single consumer thread.
+//
+// Producers push onto a lock-free stack (a Treiber stack) with a compare-and-swap loop. When the
+// consumer runs out of popped elements, it takes the entire stack with a single exchange, and then
+// reverses it into a list that only the consumer touches, so that elements are popped in the order
+// they were pushed. Since nodes are never reused while reachable by producers, the compare-and-swap
+// is not subject to the ABA problem.
+//
+// Example usage:
+//
+//   ftl::MpscQueue<std::string> queue;
+//   assert(queue.empty());
+//
+//   std::thread producer([&queue] {
+//     queue.push("abc");
+//     queue.emplace(3u, '?');
+//   });
+//   producer.join();
+//
+//   assert(queue.pop() == "abc");
+//   assert(queue.pop() == "???");
+//   assert(!queue.pop());
+//
+template <typename T>
+class MpscQueue final {
+ public:
+  using value_type = T;
+
+  MpscQueue() = default;
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  ~MpscQueue() {
+    destroy(push_.load(std::memory_order_acquire));
+    destroy(pop_.load(std::memory_order_relaxed));
+  }
+
+  // Returns whether the queue was empty at some point during the call. This may be called from any
+  // thread, but the result is only a hint unless producers are quiescent.
+  bool empty() const {
+    return pop_.load(std::memory_order_relaxed) == nullptr &&
+        push_.load(std::memory_order_relaxed) == nullptr;
+  }
+
+  // Constructs an element at the back of the queue. Safe to call from multiple threads.
+  template <typename... Args>
+  void emplace(Args&&... args) {
+    Node* const node = new Node{T(std::forward<Args>(args)...), push_.load(std::memory_order_relaxed)};
+    while (!push_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                        std::memory_order_relaxed));
+  }
+
+  void push(T value) { emplace(std::move(value)); }
+
+  // Removes the front element, or returns std::nullopt if the queue is empty. Must only be called
+  // from the consumer thread.
+  std::optional<T> pop() {
+    Node* node = pop_.load(std::memory_order_relaxed);
+    if (!node) {
+      node = push_.exchange(nullptr, std::memory_order_acquire);
+      if (!node) return std::nullopt;
+
+      // Reverse the stack, such that |node| is the element that was pushed first.
+      Node* reversed = nullptr;
+      while (Node* const next = node->next) {
+        node->next = reversed;
+        reversed = node;
+        node = next;
+      }
+      node->next = reversed;
+    }
+
+    pop_.store(node->next, std::memory_order_relaxed);
+
+    std::optional<T> value(std::move(node->value));
+    delete node;
+    return value;
+  }
+
+ private:
+  struct Node {
+    T value;
+    Node* next;
+  };
+
+  static void destroy(Node* node) {
+    while (node) {
+      delete std::exchange(node, node->next);
+    }
+  }
+
+  // Stack of pushed elements, most recent first.
+  std::atomic<Node*> push_ = nullptr;
+
+  // List of elements taken from |push_| by the consumer, least recent first. Atomic only so that
+  // empty() may be called from any thread.
+  std::atomic<Node*> pop_ = nullptr;
+};
+
+}  // namespace android::ftl
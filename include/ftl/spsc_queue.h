@@ -0,0 +1,115 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <utility>
+
+namespace android::ftl {
+
+// Bounded FIFO queue with lock-free, allocation-free handoff from a single producer thread to a
+// single consumer thread. Elements are stored in a ring buffer of N slots, where N is a power of
+// two. The producer and consumer each own one index, which the other side only reads, and the two
+// indices live on separate cache lines to avoid false sharing.
+//
+// Example usage:
+//
+//   ftl::SpscQueue<int, 2> queue;
+//
+//   std::thread producer([&queue] {
+//     assert(queue.try_push(1));
+//     assert(queue.try_emplace(2));
+//     assert(!queue.try_push(3));
+//   });
+//   producer.join();
+//
+//   assert(queue.pop() == 1);
+//   assert(queue.pop() == 2);
+//   assert(!queue.pop());
+//
+template <typename T, std::size_t N>
+class SpscQueue final {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "Capacity must be a power of two");
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  SpscQueue() = default;
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  ~SpscQueue() {
+    while (pop());
+  }
+
+  static constexpr size_type capacity() { return N; }
+
+  // Returns the number of elements at some point during the call. This may be called from any
+  // thread, but the result is only a hint unless both sides are quiescent.
+  size_type size() const {
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+  }
+
+  bool empty() const { return size() == 0; }
+
+  // Constructs an element at the back of the queue, unless the queue is full. Returns whether the
+  // element was constructed. Must only be called from the producer thread.
+  template <typename... Args>
+  bool try_emplace(Args&&... args) {
+    const size_type tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == N) return false;
+
+    new (slot(tail)) T(std::forward<Args>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool try_push(T value) { return try_emplace(std::move(value)); }
+
+  // Removes the front element, or returns std::nullopt if the queue is empty. Must only be called
+  // from the consumer thread.
+  std::optional<T> pop() {
+    const size_type head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) return std::nullopt;
+
+    T* const element = std::launder(reinterpret_cast<T*>(slot(head)));
+    std::optional<T> value(std::move(*element));
+    element->~T();
+
+    head_.store(head + 1, std::memory_order_release);
+    return value;
+  }
+
+ private:
+  static constexpr std::size_t kCacheLineSize = 64;
+
+  std::byte* slot(size_type index) { return storage_ + (index & (N - 1)) * sizeof(T); }
+
+  // Indices increase monotonically, and are reduced modulo N to address a slot. Unsigned overflow
+  // is harmless since N divides the range of size_type.
+  alignas(kCacheLineSize) std::atomic<size_type> head_ = 0;
+  alignas(kCacheLineSize) std::atomic<size_type> tail_ = 0;
+
+  alignas(kCacheLineSize) alignas(T) std::byte storage_[N * sizeof(T)];
+};
+
+}  // namespace android::ftl
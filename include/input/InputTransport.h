@@ -271,6 +271,16 @@ public:
      */
     status_t sendMessage(const InputMessage* msg);
 
+    /* Send a sequence of messages to the other endpoint, with as few system calls as possible.
+     *
+     * The messages are sent in order. Stops at the first message that could not be sent, and
+     * sets outSentCount to the number of messages that were sent before it.
+     *
+     * Returns the same values as sendMessage for the first message that could not be sent,
+     * OK if all of them were sent.
+     */
+    status_t sendMessages(const InputMessage* msgs, size_t count, size_t* outSentCount);
+
     /* Receive a message sent by the other endpoint.
      *
      * If there is no message present, try again after poll() indicates that the fd
@@ -658,6 +668,8 @@ private:
     nsecs_t getConsumeTime(uint32_t seq) const;
     void popConsumeTime(uint32_t seq);
     status_t sendUnchainedFinishedSignal(uint32_t seq, bool handled);
+    status_t sendUnchainedFinishedSignals(const uint32_t* seqs, size_t count, bool handled,
+                                          size_t* outSentCount);
 
     static void rewriteMessage(TouchState& state, InputMessage& msg);
     static void initializeKeyEvent(KeyEvent* event, const InputMessage* msg);
@@ -21,6 +21,7 @@
 #include <utils/Errors.h>
 #include <utils/Tokenizer.h>
 #include <set>
+#include <vector>
 
 #include <input/InputDevice.h>
 
@@ -83,6 +84,8 @@ public:
     virtual ~KeyLayoutMap();
 
 private:
+    static base::Result<std::shared_ptr<KeyLayoutMap>> parse(const std::string& filename,
+                                                             const char* contents);
     static base::Result<std::shared_ptr<KeyLayoutMap>> load(Tokenizer* tokenizer);
 
     struct Key {
@@ -100,6 +103,10 @@ private:
     };
 
     std::unordered_map<int32_t, Key> mKeysByScanCode;
+    // Copy of mKeysByScanCode indexed directly by scan code, since every key event looks up its
+    // scan code. Holes have a negative keyCode. Empty if the layout uses scan codes too large for a
+    // dense table.
+    std::vector<Key> mDenseKeysByScanCode;
     std::unordered_map<int32_t, Key> mKeysByUsageCode;
     std::unordered_map<int32_t, AxisInfo> mAxes;
     std::unordered_map<int32_t, Led> mLedsByScanCode;
@@ -111,6 +118,7 @@ private:
     KeyLayoutMap();
 
     const Key* getKey(int32_t scanCode, int32_t usageCode) const;
+    void buildDenseScanCodeTable();
 
     class Parser {
         KeyLayoutMap* mMap;
@@ -16,11 +16,15 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <cstdint>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include <android-base/result.h>
 #include <android-base/thread_annotations.h>
@@ -68,9 +72,15 @@ public:
      *
      * checkEnableMotionPredition: the function to check whether the prediction should run. Used to
      * provide an additional way of turning prediction on and off. Can be toggled at runtime.
+     *
+     * runInferenceAsynchronously: whether to run the model on a dedicated thread as soon as new
+     * samples are recorded. predict() then returns the result of the latest completed inference
+     * instead of running the model on the calling thread.
      */
     MotionPredictor(nsecs_t predictionTimestampOffsetNanos,
-                    std::function<bool()> checkEnableMotionPrediction = isMotionPredictionEnabled);
+                    std::function<bool()> checkEnableMotionPrediction = isMotionPredictionEnabled,
+                    bool runInferenceAsynchronously = false);
+    ~MotionPredictor();
 
     /**
      * Record the actual motion received by the view. This event will be used for calculating the
@@ -86,15 +96,45 @@ public:
     bool isPredictionAvailable(int32_t deviceId, int32_t source);
 
 private:
+    // The output of the model for the samples recorded up to lastTimestamp.
+    struct Inference {
+        std::vector<float> r;
+        std::vector<float> phi;
+        std::vector<float> pressure;
+        TfLiteMotionPredictorSample::Point axisFrom;
+        TfLiteMotionPredictorSample::Point axisTo;
+        int64_t lastTimestamp;
+    };
+
     const nsecs_t mPredictionTimestampOffsetNanos;
     const std::function<bool()> mCheckMotionPredictionEnabled;
+    const bool mRunInferenceAsynchronously;
 
+    // Only invoked by one thread: the inference thread if inference is asynchronous, the caller of
+    // predict() otherwise.
     std::unique_ptr<TfLiteMotionPredictorModel> mModel;
 
+    std::mutex mLock;
+    std::condition_variable mInferenceRequested;
+    // Accessed with mLock held once created.
     std::unique_ptr<TfLiteMotionPredictorBuffers> mBuffers;
+    // Whether samples were recorded since the last inference.
+    bool mInputsChanged GUARDED_BY(mLock) = false;
+    // Incremented whenever the buffers are reset, so that inferences of ended gestures are dropped.
+    uint64_t mInputGeneration GUARDED_BY(mLock) = 0;
+    std::optional<Inference> mInference GUARDED_BY(mLock);
+    bool mStopInference GUARDED_BY(mLock) = false;
+    std::thread mInferenceThread;
+
     std::optional<MotionEvent> mLastEvent;
 
     std::optional<MotionPredictorMetricsManager> mMetricsManager;
+
+    // Copies the recorded samples into the model inputs.
+    void prepareInferenceLocked(Inference& inference) REQUIRES(mLock);
+    // Runs the model on its inputs and reads out the predictions.
+    void invokeModel(Inference& inference);
+    void runInferenceLoop();
 };
 
 } // namespace android
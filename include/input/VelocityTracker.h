@@ -218,8 +218,11 @@ private:
 
     const uint32_t mDegree;
     const Weighting mWeighting;
-    std::map<int32_t /*pointerId*/, size_t /*positionInArray*/> mIndex;
-    std::map<int32_t /*pointerId*/, std::array<Movement, HISTORY_SIZE>> mMovements;
+    // The history of every pointer is a circular buffer indexed by pointer id, so that tracking
+    // pointers doesn't allocate. mIndex holds the position of the newest movement in it.
+    BitSet32 mPointerIdBits;
+    std::array<size_t, MAX_POINTER_ID + 1> mIndex;
+    std::array<std::array<Movement, HISTORY_SIZE>, MAX_POINTER_ID + 1> mMovements;
 };
 
 
@@ -282,8 +285,10 @@ private:
         float position;
     };
 
-    std::map<int32_t /*pointerId*/, size_t /*positionInArray*/> mIndex;
-    std::map<int32_t /*pointerId*/, std::array<Movement, HISTORY_SIZE>> mMovements;
+    // Circular buffers indexed by pointer id, like in LeastSquaresVelocityTrackerStrategy.
+    BitSet32 mPointerIdBits;
+    std::array<size_t, MAX_POINTER_ID + 1> mIndex;
+    std::array<std::array<Movement, HISTORY_SIZE>, MAX_POINTER_ID + 1> mMovements;
 };
 
 class ImpulseVelocityTrackerStrategy : public VelocityTrackerStrategy {
@@ -314,8 +319,10 @@ private:
     // velocity calculation.
     const bool mDeltaValues;
 
-    std::map<int32_t /*pointerId*/, size_t /*positionInArray*/> mIndex;
-    std::map<int32_t /*pointerId*/, std::array<Movement, HISTORY_SIZE>> mMovements;
+    // Circular buffers indexed by pointer id, like in LeastSquaresVelocityTrackerStrategy.
+    BitSet32 mPointerIdBits;
+    std::array<size_t, MAX_POINTER_ID + 1> mIndex;
+    std::array<std::array<Movement, HISTORY_SIZE>, MAX_POINTER_ID + 1> mMovements;
 };
 
 } // namespace android
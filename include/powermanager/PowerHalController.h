@@ -24,6 +24,11 @@
 #include <android/hardware/power/Mode.h>
 #include <powermanager/PowerHalWrapper.h>
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+
 namespace android {
 
 namespace power {
@@ -46,6 +51,8 @@ public:
 // This relies on HalConnector to connect to the underlying Power HAL
 // service and reconnects to it after each failed api call. This also ensures
 // connecting to the service is thread-safe.
+// Redundant requests are not forwarded to the HAL: setting a mode to the state it was last
+// successfully set to, or repeating a boost while more than half of its duration remains.
 class PowerHalController : public HalWrapper {
 public:
     PowerHalController() : PowerHalController(std::make_unique<HalConnector>()) {}
@@ -71,9 +78,34 @@ private:
     std::shared_ptr<HalWrapper> mConnectedHal GUARDED_BY(mConnectedHalMutex) = nullptr;
     const std::shared_ptr<HalWrapper> mDefaultHal = std::make_shared<EmptyHalWrapper>();
 
+    // Last request accepted by the HAL for a single boost or mode. Its mutex is held across the
+    // redundancy check, the HAL call and the update, so concurrent callers of the same boost or
+    // mode are serialized and never race on what was last sent.
+    struct BoostRequest {
+        std::mutex mutex;
+        int32_t durationMs GUARDED_BY(mutex) = 0;
+        std::chrono::steady_clock::time_point sentTime GUARDED_BY(mutex);
+        uint64_t generation GUARDED_BY(mutex) = 0;
+    };
+    struct ModeRequest {
+        std::mutex mutex;
+        bool enabled GUARDED_BY(mutex) = false;
+        uint64_t generation GUARDED_BY(mutex) = 0;
+    };
+
+    // Requests are only valid for the generation they were recorded in. The generation is bumped
+    // whenever the HAL is reconnected, since a new HAL instance does not carry over the state
+    // requested from the previous one. Entries are never erased, so references to them stay valid
+    // after mRequestsMutex is released.
+    std::atomic<uint64_t> mRequestsGeneration = 1;
+    std::mutex mRequestsMutex;
+    std::unordered_map<hardware::power::Boost, BoostRequest> mLastBoosts GUARDED_BY(mRequestsMutex);
+    std::unordered_map<hardware::power::Mode, ModeRequest> mLastModes GUARDED_BY(mRequestsMutex);
+
     std::shared_ptr<HalWrapper> initHal();
     template <typename T>
     HalResult<T> processHalResult(HalResult<T> result, const char* functionName);
+    void clearLastRequests();
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -274,7 +274,7 @@ public:
     std::set<sp<RpcServerLink>> mRpcServerLinks;
     BpBinder::ObjectManager mObjects;
 
-    android::base::unique_fd mRecordingFd;
+    sp<binder::debug::TransactionRecorder> mRecorder;
 };
 
 // ---------------------------------------------------------------------------
@@ -311,10 +311,12 @@ status_t BBinder::startRecordingTransactions(const Parcel& data) {
         LOG(INFO) << "Could not start Binder recording. Another is already in progress.";
         return INVALID_OPERATION;
     } else {
-        status_t readStatus = data.readUniqueFileDescriptor(&(e->mRecordingFd));
+        android::base::unique_fd recordingFd;
+        status_t readStatus = data.readUniqueFileDescriptor(&recordingFd);
         if (readStatus != OK) {
             return readStatus;
         }
+        e->mRecorder = sp<binder::debug::TransactionRecorder>::make(std::move(recordingFd));
         mRecordingOn = true;
         LOG(INFO) << "Started Binder recording.";
         return NO_ERROR;
@@ -338,7 +340,9 @@ status_t BBinder::stopRecordingTransactions() {
     Extras* e = getOrCreateExtras();
     AutoMutex lock(e->mLock);
     if (mRecordingOn) {
-        e->mRecordingFd.reset();
+        // Finishes writing what was recorded, so it's all in the file once this returns.
+        e->mRecorder->stop();
+        e->mRecorder.clear();
         mRecordingOn = false;
         LOG(INFO) << "Stopped Binder recording.";
         return NO_ERROR;
@@ -413,8 +417,11 @@ status_t BBinder::transact(
                     fromDetails(getInterfaceDescriptor(), code, flags, ts, data,
                                 reply ? *reply : emptyReply, err);
             if (transaction) {
-                if (status_t err = transaction->dumpToFile(e->mRecordingFd); err != NO_ERROR) {
-                    LOG(INFO) << "Failed to dump RecordedTransaction to file with error " << err;
+                std::vector<std::byte> serialized;
+                if (status_t err = transaction->serialize(&serialized); err == NO_ERROR) {
+                    e->mRecorder->record(std::move(serialized));
+                } else {
+                    LOG(INFO) << "Failed to serialize RecordedTransaction with error " << err;
                 }
             } else {
                 LOG(INFO) << "Failed to create RecordedTransaction object.";
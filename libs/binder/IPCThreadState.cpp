@@ -29,6 +29,7 @@
 #include <utils/SystemClock.h>
 
 #include <atomic>
+#include <chrono>
 #include <errno.h>
 #include <inttypes.h>
 #include <pthread.h>
@@ -39,6 +40,8 @@
 #include <sys/resource.h>
 #include <unistd.h>
 
+#include "OnewayDispatcher.h"
+#include "TransactionLatency.h"
 #include "binder_module.h"
 
 #if LOG_NDEBUG
@@ -114,6 +117,16 @@ static const char *kCommandStrings[] = {
 
 static const int64_t kWorkSourcePropagatedBitIndex = 32;
 
+// Reply buffers kept by binder threads between transactions are capped at this
+// size, so that one large reply doesn't pin memory for the life of the thread.
+static constexpr size_t kMaxCachedReplyCapacity = 4096;
+
+static uint64_t elapsedUs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                 start)
+            .count();
+}
+
 static const char* getReturnString(uint32_t cmd)
 {
     size_t idx = cmd & _IOC_NRMASK;
@@ -826,6 +839,9 @@ status_t IPCThreadState::transact(int32_t handle,
 
     LOG_ONEWAY(">>>> SEND from pid %d uid %d %s", getpid(), getuid(),
         (flags & TF_ONE_WAY) == 0 ? "READ REPLY" : "ONE WAY");
+    const bool trackLatency = TransactionLatencyStats::isEnabled();
+    std::chrono::steady_clock::time_point start;
+    if (trackLatency) start = std::chrono::steady_clock::now();
     err = writeTransactionData(BC_TRANSACTION, flags, handle, code, data, nullptr);
 
     if (err != NO_ERROR) {
@@ -880,6 +896,8 @@ status_t IPCThreadState::transact(int32_t handle,
         err = waitForResponse(nullptr, nullptr);
     }
 
+    if (trackLatency) latencyStats()->recordOutgoing(handle, code, elapsedUs(start));
+
     return err;
 }
 
@@ -979,6 +997,7 @@ IPCThreadState::IPCThreadState()
         mPropagateWorkSource(false),
         mIsLooper(false),
         mIsFlushing(false),
+        mCachedReplyInUse(false),
         mStrictModePolicy(0),
         mLastTransactionBinderFlags(0),
         mCallRestriction(mProcess->mCallRestriction) {
@@ -993,6 +1012,60 @@ IPCThreadState::~IPCThreadState()
 {
 }
 
+void IPCThreadState::executeOnewayTransaction(OnewayTransaction& transaction) {
+    // Same as the state set up for BR_TRANSACTION in executeCommand.
+    const void* origServingStackPointer = mServingStackPointer;
+    mServingStackPointer = __builtin_frame_address(0);
+
+    const pid_t origPid = mCallingPid;
+    const char* origSid = mCallingSid;
+    const uid_t origUid = mCallingUid;
+    const bool origHasExplicitIdentity = mHasExplicitIdentity;
+    const int32_t origStrictModePolicy = mStrictModePolicy;
+    const int32_t origTransactionBinderFlags = mLastTransactionBinderFlags;
+    const int32_t origWorkSource = mWorkSource;
+    const bool origPropagateWorkSet = mPropagateWorkSource;
+    clearCallingWorkSource();
+    clearPropagateWorkSource();
+
+    mCallingPid = transaction.callingPid;
+    mCallingSid = transaction.callingSid;
+    mCallingUid = transaction.callingUid;
+    mHasExplicitIdentity = false;
+    mLastTransactionBinderFlags = transaction.flags;
+
+    const bool trackLatency = TransactionLatencyStats::isEnabled();
+    std::chrono::steady_clock::time_point start;
+    if (trackLatency) start = std::chrono::steady_clock::now();
+    Parcel reply;
+    status_t error = transaction.target->transact(transaction.code, transaction.data, &reply,
+                                                  transaction.flags);
+    if (trackLatency) {
+        latencyStats()->recordIncoming(transaction.target->getInterfaceDescriptor(),
+                                       transaction.code, elapsedUs(start));
+    }
+    if (error != OK) {
+        ALOGI("oneway function results for code %" PRIu32 " on binder at %p will be dropped but "
+              "finished with status %s",
+              transaction.code, transaction.target.get(), statusToString(error).c_str());
+    }
+
+    mServingStackPointer = origServingStackPointer;
+    mCallingPid = origPid;
+    mCallingSid = origSid;
+    mCallingUid = origUid;
+    mHasExplicitIdentity = origHasExplicitIdentity;
+    mStrictModePolicy = origStrictModePolicy;
+    mLastTransactionBinderFlags = origTransactionBinderFlags;
+    mWorkSource = origWorkSource;
+    mPropagateWorkSource = origPropagateWorkSet;
+}
+
+TransactionLatencyStats* IPCThreadState::latencyStats() {
+    if (mLatencyStats == nullptr) mLatencyStats = std::make_unique<TransactionLatencyStats>();
+    return mLatencyStats.get();
+}
+
 status_t IPCThreadState::sendReply(const Parcel& reply, uint32_t flags)
 {
     status_t err;
@@ -1370,6 +1443,32 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
                 "Not enough command data for brTRANSACTION");
             if (result != NO_ERROR) break;
 
+            if ((tr.flags & TF_ONE_WAY) != 0 && tr.target.ptr) {
+                OnewayDispatcher* dispatcher = mProcess->mOnewayDispatcher.load();
+                // If the target is being destroyed, fall through so that the transaction fails
+                // like any other.
+                if (dispatcher != nullptr &&
+                    reinterpret_cast<RefBase::weakref_type*>(tr.target.ptr)
+                            ->attemptIncStrong(this)) {
+                    BBinder* target = reinterpret_cast<BBinder*>(tr.cookie);
+                    auto transaction = std::make_unique<OnewayTransaction>();
+                    transaction->target = sp<BBinder>::fromExisting(target);
+                    target->decStrong(this);
+                    transaction->data.ipcSetDataReference(
+                        reinterpret_cast<const uint8_t*>(tr.data.ptr.buffer),
+                        tr.data_size,
+                        reinterpret_cast<const binder_size_t*>(tr.data.ptr.offsets),
+                        tr.offsets_size/sizeof(binder_size_t), freeBuffer);
+                    transaction->code = tr.code;
+                    transaction->flags = tr.flags;
+                    transaction->callingPid = tr.sender_pid;
+                    transaction->callingSid = reinterpret_cast<const char*>(tr_secctx.secctx);
+                    transaction->callingUid = tr.sender_euid;
+                    dispatcher->dispatch(std::move(transaction));
+                    break;
+                }
+            }
+
             Parcel buffer;
             buffer.ipcSetDataReference(
                 reinterpret_cast<const uint8_t*>(tr.data.ptr.buffer),
@@ -1403,7 +1502,14 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
             // ALOGI(">>>> TRANSACT from pid %d sid %s uid %d\n", mCallingPid,
             //    (mCallingSid ? mCallingSid : "<N/A>"), mCallingUid);
 
-            Parcel reply;
+            // Replies are built in a Parcel owned by this thread so that its
+            // buffers can be reused by the next transaction. Nested incoming
+            // transactions, which can happen while the outer one is still
+            // building its reply, fall back to a Parcel on the stack.
+            Parcel localReply;
+            Parcel& reply = mCachedReplyInUse ? localReply : mCachedReply;
+            const bool usingCachedReply = !mCachedReplyInUse;
+            mCachedReplyInUse = true;
             status_t error;
             IF_LOG_TRANSACTIONS() {
                 std::ostringstream logStream;
@@ -1416,20 +1522,31 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
                 std::string message = logStream.str();
                 ALOGI("%s", message.c_str());
             }
+            const bool trackLatency = TransactionLatencyStats::isEnabled();
+            std::chrono::steady_clock::time_point start;
+            if (trackLatency) start = std::chrono::steady_clock::now();
             if (tr.target.ptr) {
                 // We only have a weak reference on the target object, so we must first try to
                 // safely acquire a strong reference before doing anything else with it.
                 if (reinterpret_cast<RefBase::weakref_type*>(
                         tr.target.ptr)->attemptIncStrong(this)) {
-                    error = reinterpret_cast<BBinder*>(tr.cookie)->transact(tr.code, buffer,
-                            &reply, tr.flags);
-                    reinterpret_cast<BBinder*>(tr.cookie)->decStrong(this);
+                    BBinder* target = reinterpret_cast<BBinder*>(tr.cookie);
+                    error = target->transact(tr.code, buffer, &reply, tr.flags);
+                    if (trackLatency) {
+                        latencyStats()->recordIncoming(target->getInterfaceDescriptor(), tr.code,
+                                                       elapsedUs(start));
+                    }
+                    target->decStrong(this);
                 } else {
                     error = UNKNOWN_TRANSACTION;
                 }
 
             } else {
                 error = the_context_object->transact(tr.code, buffer, &reply, tr.flags);
+                if (trackLatency) {
+                    latencyStats()->recordIncoming(the_context_object->getInterfaceDescriptor(),
+                                                   tr.code, elapsedUs(start));
+                }
             }
 
             //ALOGI("<<<< TRANSACT from pid %d restore pid %d sid %s uid %d\n",
@@ -1469,6 +1586,11 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
                 LOG_ONEWAY("NOT sending reply to %d!", mCallingPid);
             }
 
+            if (usingCachedReply) {
+                reply.recycle(kMaxCachedReplyCapacity);
+                mCachedReplyInUse = false;
+            }
+
             mServingStackPointer = origServingStackPointer;
             mCallingPid = origPid;
             mCallingSid = origSid;
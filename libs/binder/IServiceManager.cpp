@@ -19,13 +19,16 @@
 #include <binder/IServiceManager.h>
 
 #include <inttypes.h>
+#include <set>
 #include <unistd.h>
 
 #include <android-base/properties.h>
 #include <android/os/BnServiceCallback.h>
 #include <android/os/IServiceManager.h>
+#include <binder/BpBinder.h>
 #include <binder/IPCThreadState.h>
 #include <binder/Parcel.h>
+#include <private/android_filesystem_config.h>
 #include <utils/Log.h>
 #include <utils/String8.h>
 #include <utils/SystemClock.h>
@@ -66,6 +69,15 @@ const String16& IServiceManager::getInterfaceDescriptor() const {
 IServiceManager::IServiceManager() {}
 IServiceManager::~IServiceManager() {}
 
+Vector<sp<IBinder>> IServiceManager::checkServices(const Vector<String16>& names) const {
+    Vector<sp<IBinder>> ret;
+    ret.setCapacity(names.size());
+    for (const String16& name : names) {
+        ret.push(checkService(name));
+    }
+    return ret;
+}
+
 // From the old libbinder IServiceManager interface to IServiceManager.
 class ServiceManagerShim : public IServiceManager
 {
@@ -74,6 +86,7 @@ public:
 
     sp<IBinder> getService(const String16& name) const override;
     sp<IBinder> checkService(const String16& name) const override;
+    Vector<sp<IBinder>> checkServices(const Vector<String16>& names) const override;
     status_t addService(const String16& name, const sp<IBinder>& service,
                         bool allowIsolated, int dumpsysPriority) override;
     Vector<String16> listServices(int dumpsysPriority) override;
@@ -112,7 +125,39 @@ public:
     }
 
 protected:
+    // Process-local cache of services found through this shim. servicemanager keeps it correct
+    // by calling a registration callback whenever a cached name is added again, and entries whose
+    // binder dies are dropped. Only weak references are kept, so caching doesn't keep lazy
+    // services running.
+    class ServiceCache : public android::os::BnServiceCallback, public IBinder::DeathRecipient {
+    public:
+        sp<IBinder> get(const std::string& name);
+        void put(const sp<AidlServiceManager>& sm, const std::string& name,
+                 const sp<IBinder>& binder);
+
+        Status onRegistration(const std::string& name, const sp<IBinder>& binder) override;
+        void binderDied(const wp<IBinder>& who) override;
+
+    private:
+        // returns false if 'binder' is already dead
+        bool setLocked(const std::string& name, const sp<IBinder>& binder);
+
+        // Each registration keeps a callback alive in servicemanager for the lifetime of this
+        // process, so only this many names are cached.
+        static constexpr size_t kMaxRegistrations = 64;
+
+        std::mutex mLock;
+        std::map<std::string, wp<IBinder>> mServices;
+        // names this cache is registered with servicemanager for
+        std::set<std::string> mRegistered;
+        // names whose registration failed, they are never cached or registered again
+        std::set<std::string> mUnregistrable;
+        // set once servicemanager denies registrations to this process
+        bool mDisabled = false;
+    };
+
     sp<AidlServiceManager> mTheRealServiceManager;
+    sp<ServiceCache> mServiceCache;
     // AidlRegistrationCallback -> services that its been registered for
     // notifications.
     using LocalRegistrationAndWaiter =
@@ -264,9 +309,100 @@ bool checkPermission(const String16& permission, pid_t pid, uid_t uid, bool logP
 // ----------------------------------------------------------------------
 
 ServiceManagerShim::ServiceManagerShim(const sp<AidlServiceManager>& impl)
- : mTheRealServiceManager(impl)
+ : mTheRealServiceManager(impl), mServiceCache(sp<ServiceCache>::make())
 {}
 
+sp<IBinder> ServiceManagerShim::ServiceCache::get(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mLock);
+    auto it = mServices.find(name);
+    if (it == mServices.end()) return nullptr;
+    sp<IBinder> binder = it->second.promote();
+    // If the death notification hasn't been processed yet, the binder may
+    // already be known to be dead.
+    if (binder == nullptr || !binder->isBinderAlive()) {
+        mServices.erase(it);
+        return nullptr;
+    }
+    return binder;
+}
+
+void ServiceManagerShim::ServiceCache::put(const sp<AidlServiceManager>& sm,
+                                           const std::string& name, const sp<IBinder>& binder) {
+    if (binder == nullptr) return;
+    // Invalidations are delivered on the threadpool, and RPC binders (from the host shim) can't
+    // be promoted from weak references. In both cases, every lookup goes to servicemanager.
+    if (!ProcessState::self()->isThreadPoolStarted()) return;
+    if (BpBinder* remote = binder->remoteBinder(); remote != nullptr && remote->isRpcBinder()) {
+        return;
+    }
+    // servicemanager doesn't let isolated processes register for notifications.
+    static const bool isIsolated = [] {
+        const uid_t appId = getuid() % AID_USER_OFFSET;
+        return appId >= AID_ISOLATED_START && appId <= AID_ISOLATED_END;
+    }();
+    if (isIsolated) return;
+
+    bool needsRegistration;
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        if (mDisabled || mUnregistrable.count(name) != 0) return;
+        needsRegistration = mRegistered.count(name) == 0;
+        if (needsRegistration && mRegistered.size() >= kMaxRegistrations) return;
+        if (!setLocked(name, binder)) return;
+        if (needsRegistration) mRegistered.insert(name);
+    }
+    if (!needsRegistration) return;
+
+    // The entry is set before registering, so that if the service is replaced in the meantime,
+    // the callback servicemanager makes during registration overwrites it.
+    if (Status status = sm->registerForNotifications(name, sp<ServiceCache>::fromExisting(this));
+        !status.isOk()) {
+        ALOGW("Not caching service %s, failed to registerForNotifications: %s", name.c_str(),
+              status.toString8().c_str());
+        std::lock_guard<std::mutex> lock(mLock);
+        mServices.erase(name);
+        mRegistered.erase(name);
+        // Don't pay for a failing registration on every lookup.
+        mUnregistrable.insert(name);
+        if (status.exceptionCode() == Status::EX_SECURITY) mDisabled = true;
+    }
+}
+
+bool ServiceManagerShim::ServiceCache::setLocked(const std::string& name,
+                                                 const sp<IBinder>& binder) {
+    wp<IBinder>& entry = mServices[name];
+    if (entry.unsafe_get() == binder.get()) return true;
+    entry = binder;
+    if (binder->remoteBinder() == nullptr) return true;
+    if (binder->linkToDeath(sp<ServiceCache>::fromExisting(this)) != OK) {
+        mServices.erase(name);
+        return false;
+    }
+    return true;
+}
+
+Status ServiceManagerShim::ServiceCache::onRegistration(const std::string& name,
+                                                        const sp<IBinder>& binder) {
+    std::lock_guard<std::mutex> lock(mLock);
+    if (binder == nullptr) {
+        mServices.erase(name);
+    } else {
+        setLocked(name, binder);
+    }
+    return Status::ok();
+}
+
+void ServiceManagerShim::ServiceCache::binderDied(const wp<IBinder>& who) {
+    std::lock_guard<std::mutex> lock(mLock);
+    for (auto it = mServices.begin(); it != mServices.end();) {
+        if (it->second == who) {
+            it = mServices.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 // This implementation could be simplified and made more efficient by delegating
 // to waitForService. However, this changes the threading structure in some
 // cases and could potentially break prebuilts. Once we have higher logistical
@@ -317,10 +453,49 @@ sp<IBinder> ServiceManagerShim::getService(const String16& name) const
 
 sp<IBinder> ServiceManagerShim::checkService(const String16& name) const
 {
+    const std::string nameStr = String8(name).c_str();
+    if (sp<IBinder> cached = mServiceCache->get(nameStr); cached != nullptr) return cached;
+
     sp<IBinder> ret;
-    if (!mTheRealServiceManager->checkService(String8(name).c_str(), &ret).isOk()) {
+    if (!mTheRealServiceManager->checkService(nameStr, &ret).isOk()) {
         return nullptr;
     }
+    mServiceCache->put(mTheRealServiceManager, nameStr, ret);
+    return ret;
+}
+
+Vector<sp<IBinder>> ServiceManagerShim::checkServices(const Vector<String16>& names) const
+{
+    Vector<sp<IBinder>> ret;
+    ret.insertAt(0, names.size());
+
+    // only names which aren't cached are sent to servicemanager
+    std::vector<std::string> missingNames;
+    std::vector<size_t> missingIndices;
+    for (size_t i = 0; i < names.size(); i++) {
+        std::string name = String8(names[i]).c_str();
+        if (sp<IBinder> cached = mServiceCache->get(name); cached != nullptr) {
+            ret.editItemAt(i) = cached;
+        } else {
+            missingNames.push_back(std::move(name));
+            missingIndices.push_back(i);
+        }
+    }
+    if (missingNames.empty()) return ret;
+
+    std::optional<std::vector<sp<IBinder>>> found;
+    if (Status status = mTheRealServiceManager->checkServices(missingNames, &found);
+        !status.isOk() || !found.has_value() || found->size() != missingNames.size()) {
+        // For instance, an older servicemanager which doesn't support checkServices.
+        for (size_t i : missingIndices) {
+            ret.editItemAt(i) = checkService(names[i]);
+        }
+        return ret;
+    }
+    for (size_t j = 0; j < missingNames.size(); j++) {
+        mServiceCache->put(mTheRealServiceManager, missingNames[j], (*found)[j]);
+        ret.editItemAt(missingIndices[j]) = (*found)[j];
+    }
     return ret;
 }
 
@@ -376,6 +551,7 @@ sp<IBinder> ServiceManagerShim::waitForService(const String16& name16)
     };
 
     const std::string name = String8(name16).c_str();
+    if (sp<IBinder> cached = mServiceCache->get(name); cached != nullptr) return cached;
 
     sp<IBinder> out;
     if (Status status = realGetService(name, &out); !status.isOk()) {
@@ -390,7 +566,10 @@ sp<IBinder> ServiceManagerShim::waitForService(const String16& name16)
         }
         return nullptr;
     }
-    if (out != nullptr) return out;
+    if (out != nullptr) {
+        mServiceCache->put(mTheRealServiceManager, name, out);
+        return out;
+    }
 
     sp<Waiter> waiter = sp<Waiter>::make();
     if (Status status = mTheRealServiceManager->registerForNotifications(name, waiter);
@@ -37,6 +37,9 @@
 #include <sys/mman.h>
 #include <sys/file.h>
 
+#include <map>
+#include <unordered_map>
+
 namespace android {
 // ----------------------------------------------------------------------------
 
@@ -151,6 +154,8 @@ private:
 
     ssize_t  alloc(size_t size, uint32_t flags);
     chunk_t* dealloc(size_t start);
+    void     addFreeChunk(chunk_t* chunk);
+    void     removeFreeChunk(chunk_t* chunk);
     void     dump_l(const char* what) const;
     void     dump_l(String8& res, const char* what) const;
 
@@ -158,6 +163,11 @@ private:
     mutable Mutex       mLock;
     LinkedList<chunk_t> mList;
     size_t              mHeapSize;
+
+    // Indices into mList, so that neither alloc nor dealloc walks the list:
+    // free chunks by size for best fit, and allocated chunks by start.
+    std::multimap<size_t, chunk_t*>         mFreeChunks;
+    std::unordered_map<size_t, chunk_t*>    mAllocatedChunks;
 };
 
 // ----------------------------------------------------------------------------
@@ -281,6 +291,7 @@ SimpleBestFitAllocator::SimpleBestFitAllocator(size_t size)
 
     chunk_t* node = new chunk_t(0, mHeapSize / kMemoryAlign);
     mList.insertHead(node);
+    addFreeChunk(node);
 }
 
 SimpleBestFitAllocator::~SimpleBestFitAllocator()
@@ -320,6 +331,24 @@ status_t SimpleBestFitAllocator::deallocate(size_t offset)
     return NAME_NOT_FOUND;
 }
 
+void SimpleBestFitAllocator::addFreeChunk(chunk_t* chunk)
+{
+    mFreeChunks.emplace(size_t(chunk->size), chunk);
+}
+
+void SimpleBestFitAllocator::removeFreeChunk(chunk_t* chunk)
+{
+    auto range = mFreeChunks.equal_range(chunk->size);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == chunk) {
+            mFreeChunks.erase(it);
+            return;
+        }
+    }
+    LOG_ALWAYS_FATAL("free chunk at offset 0x%08lX of size 0x%08X is not indexed",
+            chunk->start * kMemoryAlign, chunk->size * kMemoryAlign);
+}
+
 ssize_t SimpleBestFitAllocator::alloc(size_t size, uint32_t flags)
 {
     if (size == 0) {
@@ -327,24 +356,20 @@ ssize_t SimpleBestFitAllocator::alloc(size_t size, uint32_t flags)
     }
     size = (size + kMemoryAlign-1) / kMemoryAlign;
     chunk_t* free_chunk = nullptr;
-    chunk_t* cur = mList.head();
 
+    // best fit: the smallest free chunk that is large enough
     size_t pagesize = getpagesize();
-    while (cur) {
+    for (auto it = mFreeChunks.lower_bound(size); it != mFreeChunks.end(); ++it) {
+        chunk_t* const cur = it->second;
         int extra = 0;
         if (flags & PAGE_ALIGNED)
             extra = ( -cur->start & ((pagesize/kMemoryAlign)-1) ) ;
 
-        // best fit
-        if (cur->free && (cur->size >= (size+extra))) {
-            if ((!free_chunk) || (cur->size < free_chunk->size)) {
-                free_chunk = cur;
-            }
-            if (cur->size == size) {
-                break;
-            }
+        if (cur->size >= (size+extra)) {
+            free_chunk = cur;
+            mFreeChunks.erase(it);
+            break;
         }
-        cur = cur->next;
     }
 
     if (free_chunk) {
@@ -359,6 +384,7 @@ ssize_t SimpleBestFitAllocator::alloc(size_t size, uint32_t flags)
                 chunk_t* split = new chunk_t(free_chunk->start, extra);
                 free_chunk->start += extra;
                 mList.insertBefore(free_chunk, split);
+                addFreeChunk(split);
             }
 
             ALOGE_IF((flags&PAGE_ALIGNED) && 
@@ -370,8 +396,10 @@ ssize_t SimpleBestFitAllocator::alloc(size_t size, uint32_t flags)
                 chunk_t* split = new chunk_t(
                         free_chunk->start + free_chunk->size, tail_free);
                 mList.insertAfter(free_chunk, split);
+                addFreeChunk(split);
             }
         }
+        mAllocatedChunks.emplace(free_chunk->start, free_chunk);
         return (free_chunk->start)*kMemoryAlign;
     }
     return NO_MEMORY;
@@ -380,42 +408,32 @@ ssize_t SimpleBestFitAllocator::alloc(size_t size, uint32_t flags)
 SimpleBestFitAllocator::chunk_t* SimpleBestFitAllocator::dealloc(size_t start)
 {
     start = start / kMemoryAlign;
-    chunk_t* cur = mList.head();
-    while (cur) {
-        if (cur->start == start) {
-            LOG_FATAL_IF(cur->free,
-                "block at offset 0x%08lX of size 0x%08X already freed",
-                cur->start*kMemoryAlign, cur->size*kMemoryAlign);
-
-            // merge freed blocks together
-            chunk_t* freed = cur;
-            cur->free = 1;
-            do {
-                chunk_t* const p = cur->prev;
-                chunk_t* const n = cur->next;
-                if (p && (p->free || !cur->size)) {
-                    freed = p;
-                    p->size += cur->size;
-                    mList.remove(cur);
-                    delete cur;
-                }
-                cur = n;
-            } while (cur && cur->free);
-
-            #ifndef NDEBUG
-                if (!freed->free) {
-                    dump_l("dealloc (!freed->free)");
-                }
-            #endif
-            LOG_FATAL_IF(!freed->free,
-                "freed block at offset 0x%08lX of size 0x%08X is not free!",
-                freed->start * kMemoryAlign, freed->size * kMemoryAlign);
-
-            return freed;
-        }
-        cur = cur->next;
+    auto it = mAllocatedChunks.find(start);
+    if (it == mAllocatedChunks.end()) {
+        return nullptr;
+    }
+    chunk_t* freed = it->second;
+    mAllocatedChunks.erase(it);
+    freed->free = 1;
+
+    // merge freed blocks together
+    chunk_t* const p = freed->prev;
+    if (p && p->free) {
+        removeFreeChunk(p);
+        p->size += freed->size;
+        mList.remove(freed);
+        delete freed;
+        freed = p;
+    }
+    chunk_t* const n = freed->next;
+    if (n && n->free) {
+        removeFreeChunk(n);
+        freed->size += n->size;
+        mList.remove(n);
+        delete n;
     }
-    return nullptr;
+    addFreeChunk(freed);
+    return freed;
 }
 
 void SimpleBestFitAllocator::dump(const char* what) const
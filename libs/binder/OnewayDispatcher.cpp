@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "OnewayDispatcher"
+
+#include "OnewayDispatcher.h"
+
+#include <binder/IPCThreadState.h>
+#include <utils/Log.h>
+#include <utils/String8.h>
+#include <utils/Thread.h>
+
+#include <unistd.h>
+
+namespace android {
+
+class OnewayDispatcher::WorkerThread : public Thread {
+public:
+    explicit WorkerThread(OnewayDispatcher* dispatcher) : mDispatcher(dispatcher) {}
+
+protected:
+    bool threadLoop() override {
+        std::unique_ptr<OnewayTransaction> transaction = mDispatcher->waitForTransaction();
+        IPCThreadState* self = IPCThreadState::self();
+        self->executeOnewayTransaction(*transaction);
+        // frees the transaction buffer, so that the kernel can deliver the
+        // next oneway transaction for this binder
+        transaction.reset();
+        self->flushCommands();
+        return true;
+    }
+
+    // never destroyed, see ProcessState::setOnewayThreadPoolMaxThreadCount
+    OnewayDispatcher* const mDispatcher;
+};
+
+OnewayDispatcher::OnewayDispatcher(size_t maxThreads) : mMaxThreads(maxThreads) {}
+
+void OnewayDispatcher::setMaxThreads(size_t maxThreads) {
+    std::lock_guard<std::mutex> _l(mLock);
+    LOG_ALWAYS_FATAL_IF(maxThreads < mMaxThreads, "Oneway threadpool cannot be shrunk");
+    mMaxThreads = maxThreads;
+}
+
+void OnewayDispatcher::dispatch(std::unique_ptr<OnewayTransaction> transaction) {
+    size_t threadNum = 0;
+    {
+        std::lock_guard<std::mutex> _l(mLock);
+        mQueue.push_back(std::move(transaction));
+        if (mIdleThreads < mQueue.size() && mThreads < mMaxThreads) {
+            threadNum = ++mThreads;
+        }
+    }
+    mCv.notify_one();
+
+    if (threadNum != 0) {
+        String8 name = String8::format("binder_oneway:%d_%zX", getpid(), threadNum);
+        ALOGV("Spawning oneway thread, name=%s", name.c_str());
+        sp<Thread> t = sp<WorkerThread>::make(this);
+        t->run(name.c_str());
+    }
+}
+
+std::unique_ptr<OnewayTransaction> OnewayDispatcher::waitForTransaction() {
+    std::unique_lock<std::mutex> lock(mLock);
+    mIdleThreads++;
+    mCv.wait(lock, [&] { return !mQueue.empty(); });
+    mIdleThreads--;
+    std::unique_ptr<OnewayTransaction> transaction = std::move(mQueue.front());
+    mQueue.pop_front();
+    return transaction;
+}
+
+} // namespace android
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include <binder/Binder.h>
+#include <binder/Parcel.h>
+
+namespace android {
+
+// A oneway transaction for a local binder, received by a binder thread.
+struct OnewayTransaction {
+    sp<BBinder> target;
+    // references the transaction buffer, which is freed with it
+    Parcel data;
+    uint32_t code;
+    uint32_t flags;
+    pid_t callingPid;
+    // points into the transaction buffer
+    const char* callingSid;
+    uid_t callingUid;
+};
+
+// Executes oneway transactions for local binders on a pool of threads of its
+// own, so that binder threads stay available for twoway transactions.
+//
+// The kernel doesn't deliver the next oneway transaction for a binder node
+// until the buffer of the previous one is freed. The buffer is only freed
+// after the transaction has been executed here, so oneway transactions to the
+// same binder are still executed one at a time and in order.
+class OnewayDispatcher {
+public:
+    explicit OnewayDispatcher(size_t maxThreads);
+
+    // Can't be lower than the current maximum.
+    void setMaxThreads(size_t maxThreads);
+
+    // Queues 'transaction', and starts a thread for it if none is idle and
+    // the maximum isn't reached yet.
+    void dispatch(std::unique_ptr<OnewayTransaction> transaction);
+
+private:
+    class WorkerThread;
+
+    std::unique_ptr<OnewayTransaction> waitForTransaction();
+
+    std::mutex mLock;
+    std::condition_variable mCv;
+    std::deque<std::unique_ptr<OnewayTransaction>> mQueue;
+    size_t mMaxThreads;
+    size_t mThreads = 0;
+    size_t mIdleThreads = 0;
+};
+
+} // namespace android
@@ -2762,6 +2762,31 @@ void Parcel::freeDataNoInit()
     }
 }
 
+void Parcel::recycle(size_t maxCapacity) {
+    auto* kernelFields = maybeKernelFields();
+    if (mOwner || mDeallocZero || kernelFields == nullptr || mDataCapacity > maxCapacity) {
+        freeData();
+        return;
+    }
+
+    LOG_ALLOC("Parcel %p: recycling with %zu capacity", this, mDataCapacity);
+    releaseObjects();
+    kernelFields->mObjectsSize = 0;
+    kernelFields->mNextObjectHint = 0;
+    kernelFields->mWorkSourceRequestHeaderPosition = 0;
+    kernelFields->mRequestHeaderPresent = false;
+    kernelFields->mObjectsSorted = false;
+    kernelFields->mFdsKnown = true;
+    kernelFields->mHasFds = false;
+
+    mError = NO_ERROR;
+    mDataSize = mDataPos = 0;
+    ALOGV("recycle Setting data size of %p to %zu", this, mDataSize);
+    ALOGV("recycle Setting data pos of %p to %zu", this, mDataPos);
+    mAllowFds = true;
+    mEnforceNoDataAvail = true;
+}
+
 status_t Parcel::growData(size_t len)
 {
     if (len > INT32_MAX) {
@@ -19,6 +19,7 @@
 #include <binder/PersistableBundle.h>
 
 #include <limits>
+#include <utility>
 
 #include <binder/IBinder.h>
 #include <binder/Parcel.h>
@@ -420,51 +421,51 @@ status_t PersistableBundle::readFromParcelInner(const Parcel* parcel, size_t len
 
         /*
          * We assume that both the C++ and Java APIs ensure that all keys in a PersistableBundle
-         * are unique.
+         * are unique. The key is moved into its map since it is not needed afterwards.
          */
         switch (value_type) {
             case VAL_STRING: {
-                RETURN_IF_FAILED(parcel->readString16(&mStringMap[key]));
+                RETURN_IF_FAILED(parcel->readString16(&mStringMap[std::move(key)]));
                 break;
             }
             case VAL_INTEGER: {
-                RETURN_IF_FAILED(parcel->readInt32(&mIntMap[key]));
+                RETURN_IF_FAILED(parcel->readInt32(&mIntMap[std::move(key)]));
                 break;
             }
             case VAL_LONG: {
-                RETURN_IF_FAILED(parcel->readInt64(&mLongMap[key]));
+                RETURN_IF_FAILED(parcel->readInt64(&mLongMap[std::move(key)]));
                 break;
             }
             case VAL_DOUBLE: {
-                RETURN_IF_FAILED(parcel->readDouble(&mDoubleMap[key]));
+                RETURN_IF_FAILED(parcel->readDouble(&mDoubleMap[std::move(key)]));
                 break;
             }
             case VAL_BOOLEAN: {
-                RETURN_IF_FAILED(parcel->readBool(&mBoolMap[key]));
+                RETURN_IF_FAILED(parcel->readBool(&mBoolMap[std::move(key)]));
                 break;
             }
             case VAL_STRINGARRAY: {
-                RETURN_IF_FAILED(parcel->readString16Vector(&mStringVectorMap[key]));
+                RETURN_IF_FAILED(parcel->readString16Vector(&mStringVectorMap[std::move(key)]));
                 break;
             }
             case VAL_INTARRAY: {
-                RETURN_IF_FAILED(parcel->readInt32Vector(&mIntVectorMap[key]));
+                RETURN_IF_FAILED(parcel->readInt32Vector(&mIntVectorMap[std::move(key)]));
                 break;
             }
             case VAL_LONGARRAY: {
-                RETURN_IF_FAILED(parcel->readInt64Vector(&mLongVectorMap[key]));
+                RETURN_IF_FAILED(parcel->readInt64Vector(&mLongVectorMap[std::move(key)]));
                 break;
             }
             case VAL_BOOLEANARRAY: {
-                RETURN_IF_FAILED(parcel->readBoolVector(&mBoolVectorMap[key]));
+                RETURN_IF_FAILED(parcel->readBoolVector(&mBoolVectorMap[std::move(key)]));
                 break;
             }
             case VAL_PERSISTABLEBUNDLE: {
-                RETURN_IF_FAILED(mPersistableBundleMap[key].readFromParcel(parcel));
+                RETURN_IF_FAILED(mPersistableBundleMap[std::move(key)].readFromParcel(parcel));
                 break;
             }
             case VAL_DOUBLEARRAY: {
-                RETURN_IF_FAILED(parcel->readDoubleVector(&mDoubleVectorMap[key]));
+                RETURN_IF_FAILED(parcel->readDoubleVector(&mDoubleVectorMap[std::move(key)]));
                 break;
             }
             default: {
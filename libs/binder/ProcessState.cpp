@@ -31,7 +31,9 @@
 #include <utils/String8.h>
 #include <utils/Thread.h>
 
+#include "OnewayDispatcher.h"
 #include "Static.h"
+#include "TransactionLatency.h"
 #include "binder_module.h"
 
 #include <errno.h>
@@ -429,6 +431,16 @@ status_t ProcessState::setThreadPoolMaxThreadCount(size_t maxThreads) {
     return result;
 }
 
+status_t ProcessState::setOnewayThreadPoolMaxThreadCount(size_t maxThreads) {
+    AutoMutex _l(mLock);
+    if (OnewayDispatcher* dispatcher = mOnewayDispatcher.load(); dispatcher != nullptr) {
+        dispatcher->setMaxThreads(maxThreads);
+    } else if (maxThreads > 0) {
+        mOnewayDispatcher.store(new OnewayDispatcher(maxThreads));
+    }
+    return NO_ERROR;
+}
+
 size_t ProcessState::getThreadPoolMaxTotalThreadCount() const {
     pthread_mutex_lock(&mThreadCountLock);
     base::ScopeGuard detachGuard = [&]() { pthread_mutex_unlock(&mThreadCountLock); };
@@ -485,6 +497,14 @@ status_t ProcessState::enableOnewaySpamDetection(bool enable) {
     return NO_ERROR;
 }
 
+void ProcessState::setTransactionLatencyTrackingEnabled(bool enabled) {
+    TransactionLatencyStats::setEnabled(enabled);
+}
+
+void ProcessState::dumpTransactionLatencies(int fd) {
+    TransactionLatencyStats::dump(fd);
+}
+
 void ProcessState::giveThreadPoolName() {
     androidSetThreadName( makeBinderThreadName().string() );
 }
@@ -541,7 +561,8 @@ ProcessState::ProcessState(const char* driver)
         mForked(false),
         mThreadPoolStarted(false),
         mThreadPoolSeq(1),
-        mCallRestriction(CallRestriction::NONE) {
+        mCallRestriction(CallRestriction::NONE),
+        mOnewayDispatcher(nullptr) {
     base::Result<int> opened = open_driver(driver);
 
     if (opened.ok()) {
@@ -297,8 +297,9 @@ std::optional<RecordedTransaction> RecordedTransaction::fromFile(const unique_fd
     return std::optional<RecordedTransaction>(std::move(t));
 }
 
-android::status_t RecordedTransaction::writeChunk(borrowed_fd fd, uint32_t chunkType,
-                                                  size_t byteCount, const uint8_t* data) const {
+android::status_t RecordedTransaction::writeChunk(std::vector<std::byte>* buffer,
+                                                  uint32_t chunkType, size_t byteCount,
+                                                  const uint8_t* data) const {
     if (byteCount > kMaxChunkDataSize) {
         LOG(ERROR) << "Chunk data exceeds maximum size";
         return BAD_VALUE;
@@ -309,56 +310,71 @@ android::status_t RecordedTransaction::writeChunk(borrowed_fd fd, uint32_t chunk
     const std::byte* descriptorBytes = reinterpret_cast<const std::byte*>(&descriptor);
     const std::byte* dataBytes = reinterpret_cast<const std::byte*>(data);
 
-    // Add Chunk to intermediate buffer, except checksum
-    std::vector<std::byte> buffer;
-    buffer.insert(buffer.end(), descriptorBytes, descriptorBytes + sizeof(ChunkDescriptor));
-    buffer.insert(buffer.end(), dataBytes, dataBytes + byteCount);
+    // Add Chunk to buffer, except checksum
+    const size_t chunkStart = buffer->size();
+    buffer->insert(buffer->end(), descriptorBytes, descriptorBytes + sizeof(ChunkDescriptor));
+    buffer->insert(buffer->end(), dataBytes, dataBytes + byteCount);
     std::byte zero{0};
-    buffer.insert(buffer.end(), PADDING8(byteCount), zero);
+    buffer->insert(buffer->end(), PADDING8(byteCount), zero);
 
-    // Calculate checksum from buffer
-    transaction_checksum_t* checksumData = reinterpret_cast<transaction_checksum_t*>(buffer.data());
+    // Calculate checksum from the chunk, which starts 8-byte aligned like the buffer's chunks
+    // before it
+    transaction_checksum_t* checksumData =
+            reinterpret_cast<transaction_checksum_t*>(buffer->data() + chunkStart);
     transaction_checksum_t checksumValue = 0;
-    for (size_t idx = 0; idx < (buffer.size() / sizeof(transaction_checksum_t)); idx++) {
+    for (size_t idx = 0; idx < ((buffer->size() - chunkStart) / sizeof(transaction_checksum_t));
+         idx++) {
         checksumValue ^= checksumData[idx];
     }
 
     // Write checksum to buffer
     std::byte* checksumBytes = reinterpret_cast<std::byte*>(&checksumValue);
-    buffer.insert(buffer.end(), checksumBytes, checksumBytes + sizeof(transaction_checksum_t));
-
-    // Write buffer to file
-    if (!android::base::WriteFully(fd, buffer.data(), buffer.size())) {
-        LOG(ERROR) << "Failed to write chunk fd " << fd.get();
-        return UNKNOWN_ERROR;
-    }
+    buffer->insert(buffer->end(), checksumBytes, checksumBytes + sizeof(transaction_checksum_t));
     return NO_ERROR;
 }
 
-android::status_t RecordedTransaction::dumpToFile(const unique_fd& fd) const {
+android::status_t RecordedTransaction::serialize(std::vector<std::byte>* buffer) const {
+    // Each of the five chunks adds a descriptor, up to 7 bytes of padding and a checksum.
+    constexpr size_t kChunkOverhead = sizeof(ChunkDescriptor) + 7 + sizeof(transaction_checksum_t);
+    buffer->reserve(buffer->size() + 5 * kChunkOverhead + sizeof(TransactionHeader) +
+                    mData.mInterfaceName.size() + mSent.dataBufferSize() +
+                    mReply.dataBufferSize());
     if (NO_ERROR !=
-        writeChunk(fd, HEADER_CHUNK, sizeof(TransactionHeader),
+        writeChunk(buffer, HEADER_CHUNK, sizeof(TransactionHeader),
                    reinterpret_cast<const uint8_t*>(&(mData.mHeader)))) {
-        LOG(ERROR) << "Failed to write transactionHeader to fd " << fd.get();
+        LOG(ERROR) << "Failed to write transactionHeader";
         return UNKNOWN_ERROR;
     }
     if (NO_ERROR !=
-        writeChunk(fd, INTERFACE_NAME_CHUNK, mData.mInterfaceName.size() * sizeof(uint8_t),
+        writeChunk(buffer, INTERFACE_NAME_CHUNK, mData.mInterfaceName.size() * sizeof(uint8_t),
                    reinterpret_cast<const uint8_t*>(mData.mInterfaceName.c_str()))) {
-        LOG(INFO) << "Failed to write Interface Name Chunk to fd " << fd.get();
+        LOG(INFO) << "Failed to write Interface Name Chunk";
         return UNKNOWN_ERROR;
     }
 
-    if (NO_ERROR != writeChunk(fd, DATA_PARCEL_CHUNK, mSent.dataBufferSize(), mSent.data())) {
-        LOG(ERROR) << "Failed to write sent Parcel to fd " << fd.get();
+    if (NO_ERROR != writeChunk(buffer, DATA_PARCEL_CHUNK, mSent.dataBufferSize(), mSent.data())) {
+        LOG(ERROR) << "Failed to write sent Parcel";
         return UNKNOWN_ERROR;
     }
-    if (NO_ERROR != writeChunk(fd, REPLY_PARCEL_CHUNK, mReply.dataBufferSize(), mReply.data())) {
-        LOG(ERROR) << "Failed to write reply Parcel to fd " << fd.get();
+    if (NO_ERROR !=
+        writeChunk(buffer, REPLY_PARCEL_CHUNK, mReply.dataBufferSize(), mReply.data())) {
+        LOG(ERROR) << "Failed to write reply Parcel";
         return UNKNOWN_ERROR;
     }
-    if (NO_ERROR != writeChunk(fd, END_CHUNK, 0, NULL)) {
-        LOG(ERROR) << "Failed to write end chunk to fd " << fd.get();
+    if (NO_ERROR != writeChunk(buffer, END_CHUNK, 0, NULL)) {
+        LOG(ERROR) << "Failed to write end chunk";
+        return UNKNOWN_ERROR;
+    }
+    return NO_ERROR;
+}
+
+android::status_t RecordedTransaction::dumpToFile(const unique_fd& fd) const {
+    std::vector<std::byte> buffer;
+    if (status_t err = serialize(&buffer); err != NO_ERROR) {
+        return err;
+    }
+    if (!android::base::WriteFully(fd, buffer.data(), buffer.size())) {
+        LOG(ERROR) << "Failed to write transaction to fd " << fd.get();
         return UNKNOWN_ERROR;
     }
     return NO_ERROR;
@@ -397,3 +413,62 @@ const Parcel& RecordedTransaction::getDataParcel() const {
 const Parcel& RecordedTransaction::getReplyParcel() const {
     return mReply;
 }
+
+namespace android::binder::debug {
+
+TransactionRecorder::TransactionRecorder(unique_fd fd) : mFd(std::move(fd)) {
+    mThread = std::thread(&TransactionRecorder::writeLoop, this);
+}
+
+TransactionRecorder::~TransactionRecorder() {
+    stop();
+}
+
+void TransactionRecorder::record(std::vector<std::byte>&& transaction) {
+    std::lock_guard<std::mutex> lock(mLock);
+    if (mQueuedBytes + transaction.size() > kMaxQueuedBytes) {
+        mDroppedTransactions++;
+        return;
+    }
+    mQueuedBytes += transaction.size();
+    mQueue.push_back(std::move(transaction));
+    mCondition.notify_one();
+}
+
+void TransactionRecorder::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mStopping = true;
+        mCondition.notify_one();
+    }
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+}
+
+void TransactionRecorder::writeLoop() {
+    std::unique_lock<std::mutex> lock(mLock);
+    while (true) {
+        mCondition.wait(lock, [this] { return mStopping || !mQueue.empty(); });
+        if (mQueue.empty()) {
+            break;
+        }
+
+        std::vector<std::byte> transaction = std::move(mQueue.front());
+        mQueue.pop_front();
+        mQueuedBytes -= transaction.size();
+
+        lock.unlock();
+        if (!android::base::WriteFully(mFd, transaction.data(), transaction.size())) {
+            LOG(ERROR) << "Failed to write transaction to fd " << mFd.get();
+        }
+        lock.lock();
+    }
+
+    if (mDroppedTransactions > 0) {
+        LOG(WARNING) << "Dropped " << mDroppedTransactions
+                     << " transactions while the recording fell behind.";
+    }
+}
+
+} // namespace android::binder::debug
@@ -55,6 +55,79 @@ namespace android {
 
 using base::unique_fd;
 
+#ifdef BINDER_RPC_SINGLE_THREADED
+// Never created, see setOnewayBatching.
+class RpcSession::OnewayBatchFlusher : public RefBase {
+public:
+    void schedule(std::chrono::steady_clock::time_point) {}
+    void stop() {}
+};
+#else  // BINDER_RPC_SINGLE_THREADED
+class RpcSession::OnewayBatchFlusher : public RefBase {
+public:
+    explicit OnewayBatchFlusher(const wp<RpcSession>& session) : mSession(session) {}
+
+    void schedule(std::chrono::steady_clock::time_point deadline) {
+        RpcMutexLockGuard _l(mMutex);
+        if (mStopped || (mDeadline && *mDeadline <= deadline)) return;
+        mDeadline = deadline;
+        if (!mThread.joinable()) {
+            mThread = RpcMaybeThread(
+                    [self = sp<OnewayBatchFlusher>::fromExisting(this)] { self->run(); });
+        }
+        mCv.notify_one();
+    }
+
+    void stop() {
+        RpcMaybeThread thread;
+        {
+            RpcMutexLockGuard _l(mMutex);
+            mStopped = true;
+            thread = std::move(mThread);
+            mCv.notify_one();
+        }
+        if (!thread.joinable()) return;
+        // run() may drop the last reference to the session itself
+        if (thread.get_id() == rpc_this_thread::get_id()) {
+            thread.detach();
+        } else {
+            thread.join();
+        }
+    }
+
+private:
+    void run() {
+        RpcMutexUniqueLock _l(mMutex);
+        while (!mStopped) {
+            if (!mDeadline) {
+                mCv.wait(_l);
+                continue;
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (now < *mDeadline) {
+                mCv.wait_for(_l, *mDeadline - now);
+                continue;
+            }
+            mDeadline.reset();
+            _l.unlock();
+            if (sp<RpcSession> session = mSession.promote(); session != nullptr) {
+                // errors shut the session down, and the callers which queued
+                // the transactions have already returned
+                (void)session->flushOnewayBatches(true /*expiredOnly*/);
+            }
+            _l.lock();
+        }
+    }
+
+    const wp<RpcSession> mSession;
+    RpcMutex mMutex; // for below
+    RpcConditionVariable mCv;
+    std::optional<std::chrono::steady_clock::time_point> mDeadline;
+    bool mStopped = false;
+    RpcMaybeThread mThread;
+};
+#endif // BINDER_RPC_SINGLE_THREADED
+
 RpcSession::RpcSession(std::unique_ptr<RpcTransportCtx> ctx) : mCtx(std::move(ctx)) {
     LOG_RPC_DETAIL("RpcSession created %p", this);
 
@@ -63,6 +136,8 @@ RpcSession::RpcSession(std::unique_ptr<RpcTransportCtx> ctx) : mCtx(std::move(ct
 RpcSession::~RpcSession() {
     LOG_RPC_DETAIL("RpcSession destroyed %p", this);
 
+    if (mOnewayBatchFlusher != nullptr) mOnewayBatchFlusher->stop();
+
     RpcMutexLockGuard _l(mMutex);
     LOG_ALWAYS_FATAL_IF(mConnections.mIncoming.size() != 0,
                         "Should not be able to destroy a session with servers in use.");
@@ -103,6 +178,90 @@ size_t RpcSession::getMaxOutgoingThreads() {
     return mMaxOutgoingConnections;
 }
 
+void RpcSession::setOnewayBatching(size_t maxBytes, std::chrono::microseconds window) {
+    RpcMutexLockGuard _l(mMutex);
+    LOG_ALWAYS_FATAL_IF(mStartedSetup, "Must set oneway batching before setting up connections");
+    mMaxOnewayBatchBytes = maxBytes;
+    mOnewayBatchWindow = window;
+#ifndef BINDER_RPC_SINGLE_THREADED
+    // Without threads, a batch past its deadline is only written once the
+    // connection is used again.
+    if (maxBytes > 0 && mOnewayBatchFlusher == nullptr) {
+        mOnewayBatchFlusher = sp<OnewayBatchFlusher>::make(wp<RpcSession>(this));
+    }
+#endif
+}
+
+size_t RpcSession::getMaxOnewayBatchBytes() {
+    return mMaxOnewayBatchBytes;
+}
+
+std::chrono::microseconds RpcSession::getOnewayBatchWindow() {
+    return mOnewayBatchWindow;
+}
+
+status_t RpcSession::flushOnewayBatch() {
+    return flushOnewayBatches(false /*expiredOnly*/);
+}
+
+status_t RpcSession::flushOnewayBatches(bool expiredOnly) {
+    if (mMaxOnewayBatchBytes == 0) return OK;
+
+    auto now = std::chrono::steady_clock::now();
+    std::optional<std::chrono::steady_clock::time_point> nextDeadline;
+    std::vector<sp<RpcConnection>> claimed;
+    {
+        RpcMutexLockGuard _l(mMutex);
+        for (const auto& connection : mConnections.mOutgoing) {
+            RpcMutexLockGuard _lb(connection->onewayBatchMutex);
+            if (connection->onewayBatch.empty()) continue;
+
+            if (expiredOnly && connection->onewayBatchDeadline > now) {
+                if (!nextDeadline || connection->onewayBatchDeadline < *nextDeadline) {
+                    nextDeadline = connection->onewayBatchDeadline;
+                }
+                continue;
+            }
+            // Only the thread holding a connection may write to it, and waiting
+            // for it here could deadlock, so leave it to ~ExclusiveConnection.
+            if (connection->exclusiveTid != std::nullopt) {
+                connection->onewayBatchFlushRequested = true;
+                continue;
+            }
+            connection->exclusiveTid = rpcGetThreadId();
+            claimed.push_back(connection);
+        }
+    }
+
+    status_t result = OK;
+    sp<RpcSession> session = sp<RpcSession>::fromExisting(this);
+    for (const auto& connection : claimed) {
+        status_t status = state()->flushOnewayBatch(connection, session);
+        clearConnectionTid(connection);
+        if (result == OK) result = status;
+    }
+
+    if (nextDeadline) scheduleOnewayBatchFlush(*nextDeadline);
+    return result;
+}
+
+void RpcSession::scheduleOnewayBatchFlush(std::chrono::steady_clock::time_point deadline) {
+    if (mOnewayBatchFlusher != nullptr) mOnewayBatchFlusher->schedule(deadline);
+}
+
+void RpcSession::dropOnewayBatches() {
+    RpcMutexLockGuard _l(mMutex);
+    for (const auto& connection : mConnections.mOutgoing) {
+        RpcMutexLockGuard _lb(connection->onewayBatchMutex);
+        if (connection->onewayBatch.empty()) continue;
+        ALOGE("Dropping %zu bytes of queued oneway transactions, since the session is shutting "
+              "down.",
+              connection->onewayBatch.size());
+        connection->onewayBatch.clear();
+        connection->onewayBatchFlushRequested = false;
+    }
+}
+
 bool RpcSession::setProtocolVersionInternal(uint32_t version, bool checkStarted) {
     if (version >= RPC_WIRE_PROTOCOL_VERSION_NEXT &&
         version != RPC_WIRE_PROTOCOL_VERSION_EXPERIMENTAL) {
@@ -249,6 +408,18 @@ status_t RpcSession::getRemoteMaxThreads(size_t* maxThreads) {
 }
 
 bool RpcSession::shutdownAndWait(bool wait) {
+    if (mMaxOnewayBatchBytes != 0) {
+        // An orderly shutdown delivers what is still queued. Otherwise, this is
+        // called because of an error, and the transport can't be used anymore.
+        bool flush;
+        {
+            RpcMutexLockGuard _l(mMutex);
+            flush = wait && mShutdownTrigger != nullptr && !mShutdownTrigger->isTriggered();
+        }
+        if (flush) (void)flushOnewayBatches(false /*expiredOnly*/);
+        dropOnewayBatches();
+    }
+
     RpcMutexUniqueLock _l(mMutex);
     LOG_ALWAYS_FATAL_IF(mShutdownTrigger == nullptr, "Shutdown trigger not installed");
 
@@ -994,6 +1165,18 @@ RpcSession::ExclusiveConnection::~ExclusiveConnection() {
     // is using this fd, and it retains the right to it. So, we don't give up
     // exclusive ownership, and no thread is freed.
     if (!mReentrant && mConnection != nullptr) {
+        if (mSession->mMaxOnewayBatchBytes != 0) {
+            // write out a batch which another thread or the deadline asked
+            // for while this connection was in use
+            bool due;
+            {
+                RpcMutexLockGuard _l(mConnection->onewayBatchMutex);
+                due = !mConnection->onewayBatch.empty() &&
+                        (mConnection->onewayBatchFlushRequested ||
+                         mConnection->onewayBatchDeadline <= std::chrono::steady_clock::now());
+            }
+            if (due) (void)mSession->state()->flushOnewayBatch(mConnection, mSession);
+        }
         mSession->clearConnectionTid(mConnection);
     }
 }
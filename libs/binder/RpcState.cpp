@@ -92,21 +92,21 @@ status_t RpcState::onBinderLeaving(const sp<RpcSession>& session, const sp<IBind
     RpcMutexLockGuard _l(mNodeMutex);
     if (mTerminated) return DEAD_OBJECT;
 
-    // TODO(b/182939933): maybe move address out of BpBinder, and keep binder->address map
-    // in RpcState
-    for (auto& [addr, node] : mNodeForAddress) {
-        if (binder == node.binder) {
-            if (isRpc) {
-                // check integrity of data structure
-                uint64_t actualAddr = binder->remoteBinder()->getPrivateAccessor().rpcAddress();
-                LOG_ALWAYS_FATAL_IF(addr != actualAddr, "Address mismatch %" PRIu64 " vs %" PRIu64,
-                                    addr, actualAddr);
-            }
-            node.timesSent++;
-            node.sentRef = binder; // might already be set
-            *outAddress = addr;
-            return OK;
+    if (auto indexIt = mAddressForBinder.find(binder.get()); indexIt != mAddressForBinder.end()) {
+        auto it = mNodeForAddress.find(indexIt->second);
+        LOG_ALWAYS_FATAL_IF(it == mNodeForAddress.end(),
+                            "Binder index refers to unknown address %" PRIu64, indexIt->second);
+        auto& [addr, node] = *it;
+        if (isRpc) {
+            // check integrity of data structure
+            uint64_t actualAddr = binder->remoteBinder()->getPrivateAccessor().rpcAddress();
+            LOG_ALWAYS_FATAL_IF(addr != actualAddr, "Address mismatch %" PRIu64 " vs %" PRIu64,
+                                addr, actualAddr);
         }
+        node.timesSent++;
+        node.sentRef = binder; // might already be set
+        *outAddress = addr;
+        return OK;
     }
     LOG_ALWAYS_FATAL_IF(isRpc, "RPC binder must have known address at this point");
 
@@ -141,6 +141,7 @@ status_t RpcState::onBinderLeaving(const sp<RpcSession>& session, const sp<IBind
                                                                 .timesSent = 1,
                                                         }});
         if (inserted) {
+            mAddressForBinder[binder.get()] = it->first;
             *outAddress = it->first;
             return OK;
         }
@@ -191,6 +192,7 @@ status_t RpcState::onBinderEntering(const sp<RpcSession>& session, uint64_t addr
     // device global binders in the RPC world).
     it->second.binder = *out = BpBinder::PrivateAccessor::create(session, it->first);
     it->second.timesRecd = 1;
+    mAddressForBinder[out->get()] = it->first;
     return OK;
 }
 
@@ -293,6 +295,7 @@ void RpcState::clear(RpcMutexUniqueLock nodeLock) {
     // mNodeMutex is no longer taken.
     auto temp = std::move(mNodeForAddress);
     mNodeForAddress.clear(); // RpcState isn't reusable, but for future/explicit
+    mAddressForBinder.clear();
 
     nodeLock.unlock();
     temp.clear(); // explicit
@@ -559,38 +562,37 @@ status_t RpcState::transactAddress(const sp<RpcSession::RpcConnection>& connecti
             .parcelDataSize = static_cast<uint32_t>(data.dataSize()),
     };
 
-    // Oneway calls have no sync point, so if many are sent before, whether this
-    // is a twoway or oneway transaction, they may have filled up the socket.
-    // So, make sure we drain them before polling
-    constexpr size_t kWaitMaxUs = 1000000;
-    constexpr size_t kWaitLogUs = 10000;
-    size_t waitUs = 0;
-
+    // The Parcel data and object table are referenced in place rather than
+    // being flattened into a single buffer, so large payloads are only copied
+    // by the kernel.
     iovec iovs[]{
             {&command, sizeof(RpcWireHeader)},
             {&transaction, sizeof(RpcWireTransaction)},
             {const_cast<uint8_t*>(data.data()), data.dataSize()},
             objectTableSpan.toIovec(),
     };
-    if (status_t status = rpcSend(
-                connection, session, "transaction", iovs, arraysize(iovs),
-                [&] {
-                    if (waitUs > kWaitLogUs) {
-                        ALOGE("Cannot send command, trying to process pending refcounts. Waiting "
-                              "%zuus. Too many oneway calls?",
-                              waitUs);
-                    }
 
-                    if (waitUs > 0) {
-                        usleep(waitUs);
-                        waitUs = std::min(kWaitMaxUs, waitUs * 2);
-                    } else {
-                        waitUs = 1;
-                    }
+    bool hasFds = rpcFields->mFds != nullptr && !rpcFields->mFds->empty();
+    if ((flags & IBinder::FLAG_ONEWAY) && !hasFds) {
+        bool queued = false;
+        if (status_t status =
+                    batchOnewayTransaction(connection, session, iovs, arraysize(iovs), &queued);
+            status != OK) {
+            return status;
+        }
+        if (queued) return OK;
+    } else if (status_t status = flushOnewayBatch(connection, session); status != OK) {
+        return status;
+    } else if (!(flags & IBinder::FLAG_ONEWAY)) {
+        // oneway transactions queued on other connections before this call
+        // should reach the other side before it does
+        if (status_t status = session->flushOnewayBatches(false /*expiredOnly*/); status != OK) {
+            return status;
+        }
+    }
 
-                    return drainCommands(connection, session, CommandType::CONTROL_ONLY);
-                },
-                rpcFields->mFds.get());
+    if (status_t status = rpcSendDraining(connection, session, "transaction", iovs,
+                                          arraysize(iovs), rpcFields->mFds.get());
         status != OK) {
         // rpcSend calls shutdownAndWait, so all refcounts should be reset. If we ever tolerate
         // errors here, then we may need to undo the binder-sent counts for the transaction as
@@ -619,6 +621,108 @@ static void cleanup_reply_data(const uint8_t* data, size_t dataSize, const binde
     (void)objectsCount;
 }
 
+status_t RpcState::rpcSendDraining(
+        const sp<RpcSession::RpcConnection>& connection, const sp<RpcSession>& session,
+        const char* what, iovec* iovs, int niovs,
+        const std::vector<std::variant<base::unique_fd, base::borrowed_fd>>* ancillaryFds) {
+    // Oneway calls have no sync point, so if many are sent before, whether this
+    // is a twoway or oneway transaction, they may have filled up the socket.
+    // So, make sure we drain them before polling
+    constexpr size_t kWaitMaxUs = 1000000;
+    constexpr size_t kWaitLogUs = 10000;
+    size_t waitUs = 0;
+
+    return rpcSend(
+            connection, session, what, iovs, niovs,
+            [&] {
+                if (waitUs > kWaitLogUs) {
+                    ALOGE("Cannot send command, trying to process pending refcounts. Waiting "
+                          "%zuus. Too many oneway calls?",
+                          waitUs);
+                }
+
+                if (waitUs > 0) {
+                    usleep(waitUs);
+                    waitUs = std::min(kWaitMaxUs, waitUs * 2);
+                } else {
+                    waitUs = 1;
+                }
+
+                return drainCommands(connection, session, CommandType::CONTROL_ONLY);
+            },
+            ancillaryFds);
+}
+
+status_t RpcState::batchOnewayTransaction(const sp<RpcSession::RpcConnection>& connection,
+                                          const sp<RpcSession>& session, const iovec* iovs,
+                                          int niovs, bool* queued) {
+    *queued = false;
+
+    size_t maxBytes = session->getMaxOnewayBatchBytes();
+    if (maxBytes == 0) return OK;
+
+    size_t frameSize = 0;
+    for (int i = 0; i < niovs; i++) frameSize += iovs[i].iov_len;
+
+    std::vector<uint8_t> toSend;
+    std::optional<std::chrono::steady_clock::time_point> newDeadline;
+    {
+        RpcMutexLockGuard _l(connection->onewayBatchMutex);
+        auto now = std::chrono::steady_clock::now();
+
+        if (!connection->onewayBatch.empty() &&
+            (connection->onewayBatch.size() + frameSize > maxBytes ||
+             now >= connection->onewayBatchDeadline)) {
+            toSend.swap(connection->onewayBatch);
+        }
+
+        // Frames larger than the whole budget are sent on their own, after
+        // anything that was queued before them.
+        if (frameSize <= maxBytes) {
+            if (connection->onewayBatch.empty()) {
+                connection->onewayBatchDeadline = now + session->getOnewayBatchWindow();
+                newDeadline = connection->onewayBatchDeadline;
+            }
+            connection->onewayBatch.reserve(maxBytes);
+            for (int i = 0; i < niovs; i++) {
+                const uint8_t* base = reinterpret_cast<const uint8_t*>(iovs[i].iov_base);
+                connection->onewayBatch.insert(connection->onewayBatch.end(), base,
+                                               base + iovs[i].iov_len);
+            }
+            *queued = true;
+        }
+    }
+
+    if (newDeadline) session->scheduleOnewayBatchFlush(*newDeadline);
+
+    if (!toSend.empty()) {
+        iovec iov{toSend.data(), toSend.size()};
+        if (status_t status = rpcSendDraining(connection, session, "oneway batch", &iov, 1,
+                                              nullptr);
+            status != OK) {
+            return status;
+        }
+    }
+    return OK;
+}
+
+status_t RpcState::flushOnewayBatch(const sp<RpcSession::RpcConnection>& connection,
+                                    const sp<RpcSession>& session) {
+    std::vector<uint8_t> toSend;
+    {
+        RpcMutexLockGuard _l(connection->onewayBatchMutex);
+        connection->onewayBatchFlushRequested = false;
+        if (connection->onewayBatch.empty()) return OK;
+        toSend.swap(connection->onewayBatch);
+    }
+
+    // Asynchronous transactions carry their asyncNumber, so the receiving side
+    // processes them in order even if batches on different connections are
+    // written out of order.
+    iovec iov{toSend.data(), toSend.size()};
+    return rpcSendDraining(connection, session, "oneway batch", &iov, 1, nullptr);
+}
+
 status_t RpcState::waitForReply(const sp<RpcSession::RpcConnection>& connection,
                                 const sp<RpcSession>& session, Parcel* reply) {
     std::vector<std::variant<base::unique_fd, base::borrowed_fd>> ancillaryFds;
@@ -701,6 +805,8 @@ status_t RpcState::waitForReply(const sp<RpcSession::RpcConnection>& connection,
 status_t RpcState::sendDecStrongToTarget(const sp<RpcSession::RpcConnection>& connection,
                                          const sp<RpcSession>& session, uint64_t addr,
                                          size_t target) {
+    if (status_t status = flushOnewayBatch(connection, session); status != OK) return status;
+
     RpcDecStrong body = {
             .address = RpcWireAddress::fromRaw(addr),
     };
@@ -1084,6 +1190,12 @@ processTransactInternalTailCall:
         replyStatus = status;
     }
 
+    // oneway transactions made while handling this call should reach the
+    // other side before the reply does
+    if (status_t status = session->flushOnewayBatches(false /*expiredOnly*/); status != OK) {
+        return status;
+    }
+
     auto* rpcFields = reply.maybeRpcFields();
     LOG_ALWAYS_FATAL_IF(rpcFields == nullptr);
 
@@ -1232,6 +1344,14 @@ status_t RpcState::validateParcel(const sp<RpcSession>& session, const Parcel& p
     return OK;
 }
 
+void RpcState::eraseBinderIndex(const std::map<uint64_t, BinderNode>::iterator& it) {
+    // unsafe_get is fine here, the pointer is only used as a key
+    auto indexIt = mAddressForBinder.find(it->second.binder.unsafe_get());
+    if (indexIt != mAddressForBinder.end() && indexIt->second == it->first) {
+        mAddressForBinder.erase(indexIt);
+    }
+}
+
 sp<IBinder> RpcState::tryEraseNode(const sp<RpcSession>& session, RpcMutexUniqueLock nodeLock,
                                    std::map<uint64_t, BinderNode>::iterator& it) {
     bool shouldShutdown = false;
@@ -1244,6 +1364,7 @@ sp<IBinder> RpcState::tryEraseNode(const sp<RpcSession>& session, RpcMutexUnique
         if (it->second.timesRecd == 0) {
             LOG_ALWAYS_FATAL_IF(!it->second.asyncTodo.empty(),
                                 "Can't delete binder w/ pending async transactions");
+            eraseBinderIndex(it);
             mNodeForAddress.erase(it);
 
             if (mNodeForAddress.size() == 0) {
@@ -24,6 +24,7 @@
 #include <map>
 #include <optional>
 #include <queue>
+#include <unordered_map>
 
 #include <sys/uio.h>
 
@@ -110,6 +111,14 @@ public:
                                                  const sp<RpcSession>& session, uint64_t address,
                                                  size_t target);
 
+    /**
+     * Write out any oneway transactions queued by RpcSession::setOnewayBatching
+     * on 'connection', which the caller must hold. This is done automatically
+     * before any non-batched command is sent on it.
+     */
+    [[nodiscard]] status_t flushOnewayBatch(const sp<RpcSession::RpcConnection>& connection,
+                                            const sp<RpcSession>& session);
+
     enum class CommandType {
         ANY,
         CONTROL_ONLY,
@@ -191,6 +200,12 @@ private:
             const std::optional<android::base::function_ref<status_t()>>& altPoll,
             const std::vector<std::variant<base::unique_fd, base::borrowed_fd>>* ancillaryFds =
                     nullptr);
+    // rpcSend, but while waiting for the transport to become writable, process
+    // pending refcount commands so that both sides can't deadlock on full buffers.
+    [[nodiscard]] status_t rpcSendDraining(
+            const sp<RpcSession::RpcConnection>& connection, const sp<RpcSession>& session,
+            const char* what, iovec* iovs, int niovs,
+            const std::vector<std::variant<base::unique_fd, base::borrowed_fd>>* ancillaryFds);
     [[nodiscard]] status_t rpcRec(
             const sp<RpcSession::RpcConnection>& connection, const sp<RpcSession>& session,
             const char* what, iovec* iovs, int niovs,
@@ -214,6 +229,14 @@ private:
                                             const sp<RpcSession>& session,
                                             const RpcWireHeader& command);
 
+    // If batching is enabled for `session`, append the frame in `iovs` to the
+    // oneway batch of `connection` (flushing the batch first if it is full or
+    // past its deadline).
+    // `queued` is false if the caller must send the frame itself.
+    [[nodiscard]] status_t batchOnewayTransaction(const sp<RpcSession::RpcConnection>& connection,
+                                                  const sp<RpcSession>& session, const iovec* iovs,
+                                                  int niovs, bool* queued);
+
     // Whether `parcel` is compatible with `session`.
     [[nodiscard]] static status_t validateParcel(const sp<RpcSession>& session,
                                                  const Parcel& parcel, std::string* errorMsg);
@@ -283,6 +306,9 @@ private:
     sp<IBinder> tryEraseNode(const sp<RpcSession>& session, RpcMutexUniqueLock nodeLock,
                              std::map<uint64_t, BinderNode>::iterator& it);
 
+    // Remove the mAddressForBinder entry for the node at `it`, if there is one.
+    void eraseBinderIndex(const std::map<uint64_t, BinderNode>::iterator& it);
+
     // true - success
     // false - session shutdown, halt
     [[nodiscard]] bool nodeProgressAsyncNumber(BinderNode* node);
@@ -292,6 +318,9 @@ private:
     uint32_t mNextId = 0;
     // binders known by both sides of a session
     std::map<uint64_t, BinderNode> mNodeForAddress;
+    // reverse index of mNodeForAddress, so that onBinderLeaving doesn't need to
+    // scan every node while holding mNodeMutex
+    std::unordered_map<IBinder*, uint64_t> mAddressForBinder;
 };
 
 } // namespace android
@@ -0,0 +1,409 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "RpcShmTransport"
+#include <log/log.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include <atomic>
+
+#include <binder/RpcTransportShm.h>
+
+#include "FdTrigger.h"
+#include "OS.h"
+#include "RpcState.h"
+#include "RpcTransportUtils.h"
+
+namespace android {
+
+namespace {
+
+// Size of the data area of each ring. Must be a power of two.
+constexpr size_t kRingSize = 256 * 1024;
+static_assert((kRingSize & (kRingSize - 1)) == 0);
+
+// Shared, so only lock-free (and therefore address-free) atomics may be used.
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+// Control block for one direction of a connection. Lives in shared memory.
+struct RingControl {
+    // total number of bytes ever written by the producer
+    std::atomic<uint64_t> head;
+    // total number of bytes ever consumed by the consumer
+    std::atomic<uint64_t> tail;
+    // non-zero when the consumer is waiting for head to move
+    std::atomic<uint32_t> readerWaiting;
+    // non-zero when the producer is waiting for tail to move
+    std::atomic<uint32_t> writerWaiting;
+};
+
+// Layout of the shared memory: both control blocks in the first page, then
+// the data of the client->server ring, then the data of the server->client
+// ring. The memory is zero-initialized when created, which is the valid empty
+// state of both rings.
+constexpr size_t kControlSize = 4096;
+static_assert(2 * sizeof(RingControl) <= kControlSize);
+constexpr size_t kShmSize = kControlSize + 2 * kRingSize;
+
+constexpr int kRequiredSeals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL;
+
+class Ring {
+public:
+    Ring(uint8_t* base, size_t index)
+          : mControl(reinterpret_cast<RingControl*>(base) + index),
+            mData(base + kControlSize + index * kRingSize) {}
+
+    RingControl* control() const { return mControl; }
+
+    // Number of bytes which can be consumed. The other side may have written
+    // anything into the shared memory, so this returns false if the indices
+    // are inconsistent.
+    [[nodiscard]] bool readable(size_t* out) const {
+        uint64_t head = mControl->head.load();
+        uint64_t tail = mControl->tail.load();
+        // Check before subtracting, libbinder is built with the integer
+        // sanitizer, which aborts on unsigned wraparound.
+        if (head < tail || head - tail > kRingSize) return false;
+        *out = head - tail;
+        return true;
+    }
+
+    [[nodiscard]] bool writable(size_t* out) const {
+        size_t used;
+        if (!readable(&used)) return false;
+        *out = kRingSize - used;
+        return true;
+    }
+
+    // Copy up to 'size' bytes between 'buffer' and the ring at 'position'
+    // (an index value, not an offset), handling wraparound.
+    void copyIn(uint64_t position, const uint8_t* buffer, size_t size) {
+        size_t offset = position & (kRingSize - 1);
+        size_t first = std::min(size, kRingSize - offset);
+        memcpy(mData + offset, buffer, first);
+        memcpy(mData, buffer + first, size - first);
+    }
+    void copyOut(uint64_t position, uint8_t* buffer, size_t size) const {
+        size_t offset = position & (kRingSize - 1);
+        size_t first = std::min(size, kRingSize - offset);
+        memcpy(buffer, mData + offset, first);
+        memcpy(buffer + first, mData, size - first);
+    }
+
+private:
+    RingControl* mControl;
+    uint8_t* mData;
+};
+
+// Moves up to 'available' bytes between 'iovs' and the ring. Returns the number
+// of bytes processed, and advances 'iovs' and 'niovs' in the same way as
+// interruptableReadOrWrite.
+template <typename CopyFun>
+size_t processIovecs(iovec*& iovs, int& niovs, size_t available, CopyFun copy) {
+    size_t processed = 0;
+    while (niovs > 0 && available > 0) {
+        iovec& iov = iovs[0];
+        size_t size = std::min(iov.iov_len, available);
+        copy(reinterpret_cast<uint8_t*>(iov.iov_base), size, processed);
+        processed += size;
+        available -= size;
+        iov.iov_base = reinterpret_cast<uint8_t*>(iov.iov_base) + size;
+        iov.iov_len -= size;
+        if (iov.iov_len == 0) {
+            iovs++;
+            niovs--;
+        }
+    }
+    return processed;
+}
+
+class RpcTransportShm : public RpcTransport {
+public:
+    RpcTransportShm(android::RpcTransportFd socket, uint8_t* mapping, bool isClient)
+          : mSocket(std::move(socket)),
+            mMapping(mapping),
+            mTx(mapping, isClient ? 0 : 1),
+            mRx(mapping, isClient ? 1 : 0) {}
+    ~RpcTransportShm() { munmap(mMapping, kShmSize); }
+
+    status_t pollRead(void) override {
+        size_t readable;
+        if (!mRx.readable(&readable)) return BAD_VALUE;
+        if (readable > 0) return OK;
+
+        // nothing in the ring, but the socket tells us if the other side is gone
+        if (status_t status = drainDoorbell(); status != OK) return status;
+        return WOULD_BLOCK;
+    }
+
+    status_t interruptableWriteFully(
+            FdTrigger* fdTrigger, iovec* iovs, int niovs,
+            const std::optional<android::base::function_ref<status_t()>>& altPoll,
+            const std::vector<std::variant<base::unique_fd, base::borrowed_fd>>* ancillaryFds)
+            override {
+        if (ancillaryFds != nullptr && !ancillaryFds->empty()) {
+            ALOGE("File descriptors can't be sent over the shared memory transport.");
+            return INVALID_OPERATION;
+        }
+
+        RingControl* control = mTx.control();
+        return transferFully(
+                fdTrigger, iovs, niovs, altPoll, &control->writerWaiting,
+                [&](size_t* out) { return mTx.writable(out); },
+                [&](iovec*& vecs, int& nvecs, size_t available) {
+                    uint64_t head = control->head.load(std::memory_order_relaxed);
+                    size_t written =
+                            processIovecs(vecs, nvecs, available,
+                                          [&](uint8_t* buffer, size_t size, size_t offset) {
+                                              mTx.copyIn(head + offset, buffer, size);
+                                          });
+                    control->head.store(head + written);
+                    return control->readerWaiting.load() != 0;
+                });
+    }
+
+    status_t interruptableReadFully(
+            FdTrigger* fdTrigger, iovec* iovs, int niovs,
+            const std::optional<android::base::function_ref<status_t()>>& altPoll,
+            std::vector<std::variant<base::unique_fd, base::borrowed_fd>>* /*ancillaryFds*/)
+            override {
+        RingControl* control = mRx.control();
+        return transferFully(
+                fdTrigger, iovs, niovs, altPoll, &control->readerWaiting,
+                [&](size_t* out) { return mRx.readable(out); },
+                [&](iovec*& vecs, int& nvecs, size_t available) {
+                    uint64_t tail = control->tail.load(std::memory_order_relaxed);
+                    size_t read =
+                            processIovecs(vecs, nvecs, available,
+                                          [&](uint8_t* buffer, size_t size, size_t offset) {
+                                              mRx.copyOut(tail + offset, buffer, size);
+                                          });
+                    control->tail.store(tail + read);
+                    return control->writerWaiting.load() != 0;
+                });
+    }
+
+    bool isWaiting() override { return mSocket.isInPollingState(); }
+
+private:
+    // Common loop of reads and writes. 'available' returns how many bytes
+    // can be processed right now, and 'process' processes them and returns
+    // whether the other side is waiting for us to make progress.
+    //
+    // Waiting uses the usual flag protocol: set our waiting flag, re-check
+    // the ring, and only then sleep. The other side publishes its index before
+    // checking our flag, so a wakeup can't be lost (all accesses are seq_cst).
+    template <typename AvailableFun, typename ProcessFun>
+    status_t transferFully(FdTrigger* fdTrigger, iovec* iovs, int niovs,
+                           const std::optional<android::base::function_ref<status_t()>>& altPoll,
+                           std::atomic<uint32_t>* waitingFlag, AvailableFun available,
+                           ProcessFun process) {
+        if (niovs < 0) return BAD_VALUE;
+
+        // Since we didn't poll, we need to manually check to see if it was triggered. Otherwise,
+        // we may never know we should be shutting down.
+        if (fdTrigger->isTriggered()) return DEAD_OBJECT;
+
+        while (true) {
+            size_t size;
+            if (!available(&size)) return BAD_VALUE;
+            if (size > 0) {
+                if (process(iovs, niovs, size)) ringDoorbell();
+            }
+            while (niovs > 0 && iovs[0].iov_len == 0) {
+                iovs++;
+                niovs--;
+            }
+            if (niovs == 0) return OK;
+
+            waitingFlag->store(1);
+            if (!available(&size)) return BAD_VALUE;
+            if (size == 0) {
+                status_t status = wait(fdTrigger, altPoll);
+                if (status != OK) {
+                    waitingFlag->store(0);
+                    return status;
+                }
+            }
+            waitingFlag->store(0);
+        }
+    }
+
+    status_t wait(FdTrigger* fdTrigger,
+                  const std::optional<android::base::function_ref<status_t()>>& altPoll) {
+        if (altPoll) {
+            if (status_t status = (*altPoll)(); status != OK) return status;
+            if (fdTrigger->isTriggered()) return DEAD_OBJECT;
+            return OK;
+        }
+        if (status_t status = fdTrigger->triggerablePoll(mSocket, POLLIN); status != OK) {
+            return status;
+        }
+        return drainDoorbell();
+    }
+
+    void ringDoorbell() {
+        uint8_t byte = 0;
+        // If this fails because the socket is full, there is already a wakeup
+        // pending. If it fails because the other side is gone, that is
+        // detected the next time we wait.
+        (void)TEMP_FAILURE_RETRY(
+                ::send(mSocket.fd.get(), &byte, sizeof(byte), MSG_NOSIGNAL | MSG_DONTWAIT));
+    }
+
+    // Consume all pending wakeups. Returns DEAD_OBJECT if the other side
+    // closed the socket.
+    status_t drainDoorbell() {
+        while (true) {
+            uint8_t buf[64];
+            ssize_t ret = TEMP_FAILURE_RETRY(
+                    ::recv(mSocket.fd.get(), buf, sizeof(buf), MSG_DONTWAIT));
+            if (ret == 0) return DEAD_OBJECT;
+            if (ret < 0) {
+                int savedErrno = errno;
+                if (savedErrno == EAGAIN || savedErrno == EWOULDBLOCK) return OK;
+                LOG_RPC_DETAIL("RpcTransportShm recv(): %s", strerror(savedErrno));
+                return -savedErrno;
+            }
+        }
+    }
+
+    android::RpcTransportFd mSocket;
+    uint8_t* mMapping;
+    Ring mTx;
+    Ring mRx;
+};
+
+uint8_t* mapShm(base::borrowed_fd fd) {
+    void* mapping = mmap(nullptr, kShmSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd.get(), 0);
+    if (mapping == MAP_FAILED) {
+        ALOGE("Could not map shared memory for RPC transport: %s", strerror(errno));
+        return nullptr;
+    }
+    return reinterpret_cast<uint8_t*>(mapping);
+}
+
+// RpcTransportCtx for the side of the connection which creates the shared
+// memory and sends it to the other side.
+class RpcTransportCtxShmClient : public RpcTransportCtx {
+public:
+    std::unique_ptr<RpcTransport> newTransport(android::RpcTransportFd socket,
+                                               FdTrigger* fdTrigger) const override {
+        base::unique_fd shmFd(memfd_create("RpcTransportShm", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+        if (!shmFd.ok()) {
+            ALOGE("Could not create shared memory for RPC transport: %s", strerror(errno));
+            return nullptr;
+        }
+        // The other side maps this too, so don't let its size change under it.
+        if (ftruncate(shmFd.get(), kShmSize) != 0 ||
+            fcntl(shmFd.get(), F_ADD_SEALS, kRequiredSeals) != 0) {
+            ALOGE("Could not set up shared memory for RPC transport: %s", strerror(errno));
+            return nullptr;
+        }
+        std::vector<std::variant<base::unique_fd, base::borrowed_fd>> fds;
+        fds.push_back(base::borrowed_fd(shmFd.get()));
+        uint8_t byte = 0;
+        iovec iov{&byte, sizeof(byte)};
+        bool sentFds = false;
+        auto send = [&](iovec* iovs, int niovs) -> ssize_t {
+            ssize_t ret = sendMessageOnSocket(socket, iovs, niovs, sentFds ? nullptr : &fds);
+            sentFds |= ret > 0;
+            return ret;
+        };
+        if (status_t status = interruptableReadOrWrite(socket, fdTrigger, &iov, 1, send, "sendmsg",
+                                                       POLLOUT, std::nullopt);
+            status != OK) {
+            ALOGE("Could not send shared memory for RPC transport: %s",
+                  statusToString(status).c_str());
+            return nullptr;
+        }
+
+        uint8_t* mapping = mapShm(shmFd);
+        if (mapping == nullptr) return nullptr;
+        return std::make_unique<RpcTransportShm>(std::move(socket), mapping, true);
+    }
+    std::vector<uint8_t> getCertificate(RpcCertificateFormat) const override { return {}; }
+};
+
+// RpcTransportCtx for the side of the connection which receives the shared
+// memory.
+class RpcTransportCtxShmServer : public RpcTransportCtx {
+public:
+    std::unique_ptr<RpcTransport> newTransport(android::RpcTransportFd socket,
+                                               FdTrigger* fdTrigger) const override {
+        std::vector<std::variant<base::unique_fd, base::borrowed_fd>> fds;
+        uint8_t byte;
+        iovec iov{&byte, sizeof(byte)};
+        auto recv = [&](iovec* iovs, int niovs) -> ssize_t {
+            return receiveMessageFromSocket(socket, iovs, niovs, &fds);
+        };
+        if (status_t status = interruptableReadOrWrite(socket, fdTrigger, &iov, 1, recv, "recvmsg",
+                                                       POLLIN, std::nullopt);
+            status != OK) {
+            ALOGE("Could not receive shared memory for RPC transport: %s",
+                  statusToString(status).c_str());
+            return nullptr;
+        }
+        if (fds.size() != 1) {
+            ALOGE("Expected 1 shared memory FD for RPC transport but got %zu", fds.size());
+            return nullptr;
+        }
+        base::borrowed_fd shmFd = std::visit([](const auto& fd) -> base::borrowed_fd { return fd; },
+                                             fds[0]);
+
+        // The client could otherwise shrink the memory after we map it, and
+        // crash us with SIGBUS.
+        int seals = fcntl(shmFd.get(), F_GET_SEALS);
+        struct stat st;
+        if (seals < 0 || (seals & kRequiredSeals) != kRequiredSeals ||
+            fstat(shmFd.get(), &st) != 0 || static_cast<size_t>(st.st_size) != kShmSize) {
+            ALOGE("Rejecting shared memory for RPC transport which is not sealed at the expected "
+                  "size");
+            return nullptr;
+        }
+        uint8_t* mapping = mapShm(shmFd);
+        if (mapping == nullptr) return nullptr;
+        return std::make_unique<RpcTransportShm>(std::move(socket), mapping, false);
+    }
+    std::vector<uint8_t> getCertificate(RpcCertificateFormat) const override { return {}; }
+};
+
+} // namespace
+
+std::unique_ptr<RpcTransportCtx> RpcTransportCtxFactoryShm::newServerCtx() const {
+    return std::make_unique<RpcTransportCtxShmServer>();
+}
+
+std::unique_ptr<RpcTransportCtx> RpcTransportCtxFactoryShm::newClientCtx() const {
+    return std::make_unique<RpcTransportCtxShmClient>();
+}
+
+const char* RpcTransportCtxFactoryShm::toCString() const {
+    return "shm";
+}
+
+std::unique_ptr<RpcTransportCtxFactory> RpcTransportCtxFactoryShm::make() {
+    return std::unique_ptr<RpcTransportCtxFactoryShm>(new RpcTransportCtxFactoryShm());
+}
+
+} // namespace android
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TransactionLatency.h"
+
+#include <algorithm>
+#include <atomic>
+#include <set>
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <utils/String8.h>
+
+namespace android {
+
+namespace {
+
+struct Registry {
+    std::mutex lock;
+    // all threads which currently have stats
+    std::set<const TransactionLatencyStats*> live;
+    // stats of threads which have exited
+    std::map<TransactionLatencyStats::Key, LatencyHistogram> retired;
+};
+
+Registry& registry() {
+    [[clang::no_destroy]] static Registry sRegistry;
+    return sRegistry;
+}
+
+std::atomic<bool> gEnabled = false;
+
+} // namespace
+
+void LatencyHistogram::record(uint64_t us) {
+    size_t bucket = us == 0 ? 0 : 63 - __builtin_clzll(us);
+    counts[std::min(bucket, kNumBuckets - 1)]++;
+    count++;
+    totalUs += us;
+    maxUs = std::max(maxUs, us);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < kNumBuckets; i++) counts[i] += other.counts[i];
+    count += other.count;
+    totalUs += other.totalUs;
+    maxUs = std::max(maxUs, other.maxUs);
+}
+
+bool TransactionLatencyStats::Key::operator<(const Key& o) const {
+    if (incoming != o.incoming) return incoming;
+    if (handle != o.handle) return handle < o.handle;
+    if (code != o.code) return code < o.code;
+    return descriptor < o.descriptor;
+}
+
+TransactionLatencyStats::TransactionLatencyStats() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> _l(r.lock);
+    r.live.insert(this);
+}
+
+TransactionLatencyStats::~TransactionLatencyStats() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> _l(r.lock);
+    mergeInto(&r.retired);
+    r.live.erase(this);
+}
+
+bool TransactionLatencyStats::isEnabled() {
+    return gEnabled.load(std::memory_order_relaxed);
+}
+
+void TransactionLatencyStats::setEnabled(bool enabled) {
+    gEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void TransactionLatencyStats::recordIncoming(const String16& descriptor, uint32_t code,
+                                             uint64_t us) {
+    record(Key{.incoming = true, .descriptor = descriptor, .handle = 0, .code = code}, us);
+}
+
+void TransactionLatencyStats::recordOutgoing(int32_t handle, uint32_t code, uint64_t us) {
+    record(Key{.incoming = false, .descriptor = String16(), .handle = handle, .code = code}, us);
+}
+
+void TransactionLatencyStats::record(Key&& key, uint64_t us) {
+    std::lock_guard<std::mutex> _l(mLock);
+    mHistograms[std::move(key)].record(us);
+}
+
+void TransactionLatencyStats::mergeInto(std::map<Key, LatencyHistogram>* out) const {
+    std::lock_guard<std::mutex> _l(mLock);
+    for (const auto& [key, histogram] : mHistograms) {
+        (*out)[key].merge(histogram);
+    }
+}
+
+void TransactionLatencyStats::dump(int fd) {
+    std::map<Key, LatencyHistogram> merged;
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> _l(r.lock);
+        merged = r.retired;
+        for (const TransactionLatencyStats* stats : r.live) {
+            stats->mergeInto(&merged);
+        }
+    }
+
+    dprintf(fd, "Binder transaction latencies (%s, buckets are upper bounds in us):\n",
+            isEnabled() ? "enabled" : "disabled");
+    for (const auto& [key, histogram] : merged) {
+        if (key.incoming) {
+            dprintf(fd, "  incoming %s code %" PRIu32 ":", String8(key.descriptor).c_str(),
+                    key.code);
+        } else {
+            dprintf(fd, "  outgoing handle %" PRId32 " code %" PRIu32 ":", key.handle, key.code);
+        }
+        dprintf(fd, " count=%" PRIu64 " avg=%" PRIu64 "us max=%" PRIu64 "us\n   ", histogram.count,
+                histogram.count == 0 ? 0 : histogram.totalUs / histogram.count, histogram.maxUs);
+        for (size_t i = 0; i < LatencyHistogram::kNumBuckets; i++) {
+            if (histogram.counts[i] == 0) continue;
+            if (i + 1 == LatencyHistogram::kNumBuckets) {
+                dprintf(fd, " inf:%" PRIu64, histogram.counts[i]);
+            } else {
+                dprintf(fd, " %" PRIu64 ":%" PRIu64, uint64_t(1) << (i + 1), histogram.counts[i]);
+            }
+        }
+        dprintf(fd, "\n");
+    }
+}
+
+} // namespace android
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <utils/String16.h>
+
+namespace android {
+
+// Transaction latencies, bucketed by powers of two of microseconds.
+struct LatencyHistogram {
+    // bucket i counts latencies in [2^i, 2^(i+1)) us, bucket 0 also counts
+    // anything below 1us, and the last bucket everything above.
+    static constexpr size_t kNumBuckets = 24;
+
+    std::array<uint64_t, kNumBuckets> counts{};
+    uint64_t count = 0;
+    uint64_t totalUs = 0;
+    uint64_t maxUs = 0;
+
+    void record(uint64_t us);
+    void merge(const LatencyHistogram& other);
+};
+
+// Per-thread transaction latency histograms, keyed by interface and code.
+// Recording only takes the (uncontended) lock of the thread's own instance,
+// and instances are merged when dumped.
+class TransactionLatencyStats {
+public:
+    TransactionLatencyStats();
+    ~TransactionLatencyStats();
+
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+
+    // Writes the histograms of all threads in this process, including threads
+    // which have exited, to 'fd'.
+    static void dump(int fd);
+
+    // an incoming transaction on a local binder
+    void recordIncoming(const String16& descriptor, uint32_t code, uint64_t us);
+    // an outgoing transaction to a remote binder
+    void recordOutgoing(int32_t handle, uint32_t code, uint64_t us);
+
+    struct Key {
+        bool incoming;
+        // empty for outgoing transactions, which are identified by handle
+        String16 descriptor;
+        int32_t handle;
+        uint32_t code;
+
+        bool operator<(const Key& o) const;
+    };
+
+private:
+    void record(Key&& key, uint64_t us);
+    void mergeInto(std::map<Key, LatencyHistogram>* out) const;
+
+    mutable std::mutex mLock;
+    std::map<Key, LatencyHistogram> mHistograms;
+};
+
+} // namespace android
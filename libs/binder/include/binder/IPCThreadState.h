@@ -21,6 +21,8 @@
 #include <binder/ProcessState.h>
 #include <utils/Vector.h>
 
+#include <memory>
+
 #if defined(_WIN32)
 typedef  int  uid_t;
 #endif
@@ -28,6 +30,9 @@ typedef  int  uid_t;
 // ---------------------------------------------------------------------------
 namespace android {
 
+class TransactionLatencyStats;
+struct OnewayTransaction;
+
 /**
  * Kernel binder thread state. All operations here refer to kernel binder. This
  * object is allocated per-thread.
@@ -199,6 +204,8 @@ public:
             // side.
             static const int32_t kUnsetWorkSource = -1;
 private:
+    friend class OnewayDispatcher;
+
                                 IPCThreadState();
                                 ~IPCThreadState();
 
@@ -214,10 +221,12 @@ private:
                                                      status_t* statusBuffer);
             status_t            getAndExecuteCommand();
             status_t            executeCommand(int32_t command);
+            void                executeOnewayTransaction(OnewayTransaction& transaction);
             void                processPendingDerefs();
             void                processPostWriteDerefs();
 
             void                clearCaller();
+            TransactionLatencyStats* latencyStats();
 
     static  void                threadDestructor(void *st);
     static void freeBuffer(const uint8_t* data, size_t dataSize, const binder_size_t* objects,
@@ -244,6 +253,11 @@ private:
             bool                mPropagateWorkSource;
             bool                mIsLooper;
             bool mIsFlushing;
+            // Allocated on the first transaction while latency tracking is enabled
+            std::unique_ptr<TransactionLatencyStats> mLatencyStats;
+            // Reply Parcel reused by executeCommand across incoming transactions
+            Parcel mCachedReply;
+            bool mCachedReplyInUse;
             bool mHasExplicitIdentity;
             int32_t             mStrictModePolicy;
             int32_t             mLastTransactionBinderFlags;
@@ -147,6 +147,14 @@ public:
         int pid;
     };
     virtual std::vector<ServiceDebugInfo> getServiceDebugInfo() = 0;
+
+    /**
+     * Same as checkService for each of the names, in as few calls to servicemanager as
+     * possible. The result has one entry per name, nullptr for services which are not found.
+     *
+     * The default implementation calls checkService for each name.
+     */
+    virtual Vector<sp<IBinder>> checkServices(const Vector<String16>& names) const;
 };
 
 sp<IServiceManager> defaultServiceManager();
@@ -257,6 +257,25 @@ public:
         return writeData(val);
     }
 
+    // Write a trivially copyable struct without padding as a single block of
+    // memory, rather than field by field. There is no wire format beyond the
+    // in-memory layout, so the reader must use the same definition of T.
+    template <typename T>
+    status_t writeFixedBlock(const T& val) {
+        static_assert(is_parcel_block_type_v<T>, "T must be trivially copyable without padding");
+        return write(&val, sizeof(T));
+    }
+    // Same as writeFixedBlock, for all elements at once. The size is written
+    // first, like for the other vector types.
+    template <typename T>
+    status_t writeFixedBlockVector(const std::vector<T>& val) {
+        static_assert(is_parcel_block_type_v<T>, "T must be trivially copyable without padding");
+        if (val.size() > std::numeric_limits<int32_t>::max() / sizeof(T)) return BAD_VALUE;
+        status_t status = writeInt32(static_cast<int32_t>(val.size()));
+        if (status != OK) return status;
+        return write(val.data(), val.size() * sizeof(T));
+    }
+
     // Write an Enum vector with underlying type int8_t.
     // Does not use padding; each byte is contiguous.
     template<typename T, std::enable_if_t<std::is_enum_v<T> && std::is_same_v<typename std::underlying_type_t<T>,int8_t>, bool> = 0>
@@ -529,6 +548,30 @@ public:
         return readData(val);
     }
 
+    // See writeFixedBlock and writeFixedBlockVector.
+    template <typename T>
+    status_t readFixedBlock(T* val) const {
+        static_assert(is_parcel_block_type_v<T>, "T must be trivially copyable without padding");
+        return read(val, sizeof(T));
+    }
+    template <typename T>
+    status_t readFixedBlockVector(std::vector<T>* val) const {
+        static_assert(is_parcel_block_type_v<T>, "T must be trivially copyable without padding");
+        int32_t size;
+        status_t status = readInt32(&size);
+        if (status != OK) return status;
+        if (size < 0) return UNEXPECTED_NULL;
+        size_t dataLen;
+        if (__builtin_mul_overflow(size, sizeof(T), &dataLen)) return -EOVERFLOW;
+        // checks the size against the available data before allocating
+        const void* data = readInplace(dataLen);
+        if (data == nullptr) return BAD_VALUE;
+        // Parcel data is only 4-byte aligned, so copy rather than reading T in place.
+        val->resize(size);
+        memcpy(val->data(), data, dataLen);
+        return OK;
+    }
+
     template<typename T>
     status_t            read(Flattenable<T>& val) const;
 
@@ -634,6 +677,10 @@ private:
     uintptr_t           readPointer() const;
     void                freeDataNoInit();
     void                initState();
+    // Empty the Parcel so that it can be reused for another transaction,
+    // keeping the data and objects buffers if this Parcel allocated them and
+    // the data capacity is at most `maxCapacity`. Otherwise, same as freeData.
+    void                recycle(size_t maxCapacity);
     void                scanForFds() const;
     status_t            validateReadData(size_t len) const;
 
@@ -861,6 +908,15 @@ private:
             || std::is_same_v<T, double>
             || (std::is_enum_v<T> && (sizeof(T) == 1 || sizeof(T) == 4)); // size check not type
 
+    // structs sent as blocks of memory by writeFixedBlock/readFixedBlock. Types
+    // with padding are rejected, since the padding could leak uninitialized
+    // memory. This also excludes float members, which the trait can't tell
+    // apart from padding.
+    template <typename T>
+    static inline constexpr bool is_parcel_block_type_v =
+            std::is_class_v<T> && std::is_trivially_copyable_v<T> &&
+            std::has_unique_object_representations_v<T>;
+
     // allowed "nullable" types
     // These are nonintrusive containers std::optional, std::unique_ptr, std::shared_ptr.
     template <typename T>
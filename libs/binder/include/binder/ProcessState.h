@@ -24,10 +24,13 @@
 
 #include <pthread.h>
 
+#include <atomic>
+
 // ---------------------------------------------------------------------------
 namespace android {
 
 class IPCThreadState;
+class OnewayDispatcher;
 
 /**
  * Kernel binder process state. All operations here refer to kernel binder. This
@@ -65,8 +68,22 @@ public:
 
     // For main functions - dangerous for libraries to use
     status_t setThreadPoolMaxThreadCount(size_t maxThreads);
+    // Executes oneway transactions for local binders on a separate pool of up
+    // to maxThreads threads, so that a burst of them doesn't occupy the binder
+    // threads which are needed for twoway transactions. Oneway transactions to
+    // the same binder are still executed one at a time, in order. The default,
+    // 0, executes them on binder threads. Cannot be lowered once set.
+    status_t setOnewayThreadPoolMaxThreadCount(size_t maxThreads);
     status_t enableOnewaySpamDetection(bool enable);
 
+    // Enables or disables collection of transaction latency histograms, per
+    // interface and code, for incoming transactions executed on binder threads
+    // and outgoing transactions of this process. Disabled by default.
+    void setTransactionLatencyTrackingEnabled(bool enabled);
+    // Writes the latency histograms collected so far to 'fd'. Services can
+    // call this from their dump method to make them available in dumpsys.
+    void dumpTransactionLatencies(int fd);
+
     // Set the name of the current thread to look like a threadpool
     // thread. Typically this is called before joinThreadPool.
     //
@@ -170,6 +187,10 @@ private:
     volatile int32_t mThreadPoolSeq;
 
     CallRestriction mCallRestriction;
+
+    // set once by setOnewayThreadPoolMaxThreadCount, and never destroyed,
+    // since its threads may outlive ProcessState
+    std::atomic<OnewayDispatcher*> mOnewayDispatcher;
 };
 
 } // namespace android
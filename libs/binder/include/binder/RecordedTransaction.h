@@ -18,7 +18,14 @@
 
 #include <android-base/unique_fd.h>
 #include <binder/Parcel.h>
+#include <utils/RefBase.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 namespace android {
 
@@ -40,6 +47,8 @@ public:
     RecordedTransaction(RecordedTransaction&& t) noexcept;
 
     [[nodiscard]] status_t dumpToFile(const android::base::unique_fd& fd) const;
+    // Appends the transaction, in the format dumpToFile writes, to buffer.
+    [[nodiscard]] status_t serialize(std::vector<std::byte>* buffer) const;
 
     const std::string& getInterfaceName() const;
     uint32_t getCode() const;
@@ -53,7 +62,7 @@ public:
 private:
     RecordedTransaction() = default;
 
-    android::status_t writeChunk(const android::base::borrowed_fd, uint32_t chunkType,
+    android::status_t writeChunk(std::vector<std::byte>* buffer, uint32_t chunkType,
                                  size_t byteCount, const uint8_t* data) const;
 
 #pragma clang diagnostic push
@@ -80,6 +89,37 @@ private:
     Parcel mReply;
 };
 
+// Writes serialized transactions to a file descriptor from its own thread, in the order they were
+// recorded, so that the recording thread doesn't wait on the file. Once kMaxQueuedBytes are waiting
+// to be written, further transactions are dropped rather than queued.
+class TransactionRecorder : public RefBase {
+public:
+    static constexpr size_t kMaxQueuedBytes = 16 * 1024 * 1024;
+
+    explicit TransactionRecorder(android::base::unique_fd fd);
+
+    // Queues the output of RecordedTransaction::serialize to be written.
+    void record(std::vector<std::byte>&& transaction);
+    // Writes all queued transactions and stops the thread. No more transactions may be recorded.
+    void stop();
+
+protected:
+    ~TransactionRecorder() override;
+
+private:
+    void writeLoop();
+
+    std::mutex mLock;
+    std::condition_variable mCondition;
+    std::deque<std::vector<std::byte>> mQueue;
+    size_t mQueuedBytes = 0;
+    size_t mDroppedTransactions = 0;
+    bool mStopping = false;
+
+    android::base::unique_fd mFd;
+    std::thread mThread;
+};
+
 } // namespace binder::debug
 
 } // namespace android
@@ -23,6 +23,7 @@
 #include <utils/Errors.h>
 #include <utils/RefBase.h>
 
+#include <chrono>
 #include <map>
 #include <optional>
 #include <vector>
@@ -115,6 +116,33 @@ public:
     void setFileDescriptorTransportMode(FileDescriptorTransportMode mode);
     FileDescriptorTransportMode getFileDescriptorTransportMode();
 
+    /**
+     * Opt in to batching of oneway transactions. When enabled, oneway
+     * transactions which don't carry file descriptors are queued on the
+     * connection they would have been sent on, and each connection's queue is
+     * written with a single write once 'maxBytes' would be exceeded, or once
+     * the oldest queued transaction is 'window' old. All queues are written
+     * before this session sends a synchronous transaction or a reply, and
+     * before an orderly shutdownAndWait(true). Transactions still queued when
+     * the session shuts down because of an error are dropped.
+     *
+     * The order of oneway transactions to the same binder is kept, since the
+     * receiving side orders them by their asyncNumber.
+     *
+     * By default, maxBytes is 0 (batching disabled). This must be called
+     * before setting up this connection as a client.
+     */
+    void setOnewayBatching(size_t maxBytes, std::chrono::microseconds window);
+    size_t getMaxOnewayBatchBytes();
+    std::chrono::microseconds getOnewayBatchWindow();
+
+    /**
+     * Write out all oneway transactions queued because of setOnewayBatching.
+     * Queues on connections which are in use by other threads are written as
+     * soon as those threads are done with them.
+     */
+    [[nodiscard]] status_t flushOnewayBatch();
+
     /**
      * This should be called once per thread, matching 'join' in the remote
      * process.
@@ -233,6 +261,19 @@ private:
     // for 'target', see RpcState::sendDecStrongToTarget
     [[nodiscard]] status_t sendDecStrongToTarget(uint64_t address, size_t target);
 
+    // Writes out the oneway batches of the outgoing connections which no thread
+    // is using. Connections in use are flagged, and their batch is written when
+    // they are released. If 'expiredOnly', batches which haven't reached their
+    // deadline are left alone, and the earliest such deadline is rescheduled.
+    [[nodiscard]] status_t flushOnewayBatches(bool expiredOnly);
+    // Makes sure flushOnewayBatches(true) runs once 'deadline' has passed.
+    void scheduleOnewayBatchFlush(std::chrono::steady_clock::time_point deadline);
+    // Drops the batches which could not be written before shutting down.
+    void dropOnewayBatches();
+
+    // Waits out oneway batch deadlines, see scheduleOnewayBatchFlush.
+    class OnewayBatchFlusher;
+
     class EventListener : public virtual RefBase {
     public:
         virtual void onSessionAllIncomingThreadsEnded(const sp<RpcSession>& session) = 0;
@@ -259,6 +300,16 @@ private:
         std::optional<uint64_t> exclusiveTid;
 
         bool allowNested = false;
+
+        // Oneway transactions queued by setOnewayBatching, as complete wire
+        // frames. Anyone may look at these, but only the thread holding this
+        // connection (see exclusiveTid) may write them to rpcTransport.
+        RpcMutex onewayBatchMutex;
+        std::vector<uint8_t> onewayBatch;
+        std::chrono::steady_clock::time_point onewayBatchDeadline;
+        // set when the batch should be written as soon as the connection is
+        // released
+        bool onewayBatchFlushRequested = false;
     };
 
     [[nodiscard]] status_t readId();
@@ -378,6 +429,11 @@ private:
     size_t mMaxOutgoingConnections = kDefaultMaxOutgoingConnections;
     std::optional<uint32_t> mProtocolVersion;
     FileDescriptorTransportMode mFileDescriptorTransportMode = FileDescriptorTransportMode::NONE;
+    // these don't change once setup has started, so they may be read without
+    // mMutex
+    size_t mMaxOnewayBatchBytes = 0;
+    std::chrono::microseconds mOnewayBatchWindow{0};
+    sp<OnewayBatchFlusher> mOnewayBatchFlusher;
 
     RpcConditionVariable mAvailableConnectionCv; // for mWaitingThreads
 
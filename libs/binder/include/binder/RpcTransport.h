@@ -59,7 +59,10 @@ public:
      * Read (or write), but allow to be interrupted by a trigger.
      *
      * iovs - array of iovecs to perform the operation on. The elements
-     * of the array may be modified by this method.
+     * of the array may be modified by this method. When writing, the iovecs
+     * may point directly into Parcel memory, so implementations should hand
+     * them to the underlying transport as-is (e.g. sendmsg) rather than
+     * coalescing them into an intermediate buffer.
      *
      * altPoll - function to be called instead of polling, when needing to wait
      * to read/write data. If this returns an error, that error is returned from
@@ -15,9 +15,12 @@
  */
 
 #include <android-base/logging.h>
+#include <android-base/scopeguard.h>
 #include <binder/Binder.h>
+#include <binder/IPCThreadState.h>
 #include <binder/IServiceManager.h>
 #include <binder/Parcel.h>
+#include <binder/ProcessState.h>
 #include <binder/RpcServer.h>
 #include <binder/RpcSession.h>
 #include <cutils/trace.h>
@@ -25,6 +28,10 @@
 #include <utils/CallStack.h>
 
 #include <malloc.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include <functional>
 #include <vector>
 
@@ -133,9 +140,11 @@ DestructionAction ScopeDisallowMalloc() {
 using android::BBinder;
 using android::defaultServiceManager;
 using android::IBinder;
+using android::IPCThreadState;
 using android::IServiceManager;
 using android::OK;
 using android::Parcel;
+using android::ProcessState;
 using android::RpcServer;
 using android::RpcSession;
 using android::sp;
@@ -209,6 +218,86 @@ TEST(BinderAllocation, SmallTransaction) {
     EXPECT_EQ(mallocs, 1);
 }
 
+// Replies to incoming transactions are built in a Parcel which the binder
+// thread keeps, so once it has served one transaction, serving another with
+// a small reply shouldn't allocate. This runs in a separate process with a
+// single binder thread, started by ReplyOnBinderThread, so that only
+// allocations on that thread are counted.
+static const char* kReplyServiceArg = "--reply-allocation-service";
+static const String16 kReplyServiceName("binderAllocationLimits.reply");
+static const char* gSelfPath = nullptr;
+
+enum ReplyServiceCode : uint32_t {
+    WARM_UP = IBinder::FIRST_CALL_TRANSACTION,
+    START_COUNTING,
+    STOP_COUNTING,
+};
+
+static bool gCountingMallocs = false;
+static int32_t gMallocs = 0;
+
+class ReplyAllocationService : public BBinder {
+    status_t onTransact(uint32_t code, const Parcel& data, Parcel* reply,
+                        uint32_t flags) override {
+        switch (code) {
+            case WARM_UP:
+                return reply->writeInt32(0);
+            case START_COUNTING:
+                gMallocs = 0;
+                gCountingMallocs = true;
+                // with a new Parcel per transaction, this would allocate
+                return reply->writeInt32(0);
+            case STOP_COUNTING:
+                gCountingMallocs = false;
+                return reply->writeInt32(gMallocs);
+            default:
+                return BBinder::onTransact(code, data, reply, flags);
+        }
+    }
+};
+
+static int runReplyAllocationService() {
+    (void)ATRACE_INIT();
+    (void)ATRACE_GET_ENABLED_TAGS();
+
+    const auto on_malloc = OnMalloc([](size_t) {
+        if (gCountingMallocs) gMallocs++;
+    });
+
+    sp<ReplyAllocationService> service = sp<ReplyAllocationService>::make();
+    CHECK_EQ(OK, defaultServiceManager()->addService(kReplyServiceName, service));
+    ProcessState::self()->setThreadPoolMaxThreadCount(0);
+    IPCThreadState::self()->joinThreadPool(true);
+    return 1;
+}
+
+TEST(BinderAllocation, ReplyOnBinderThread) {
+    pid_t pid = fork();
+    ASSERT_NE(-1, pid);
+    if (pid == 0) {
+        execl(gSelfPath, gSelfPath, kReplyServiceArg, nullptr);
+        _exit(1);
+    }
+    auto cleanup = android::base::make_scope_guard([pid] {
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+    });
+
+    sp<IBinder> service = defaultServiceManager()->waitForService(kReplyServiceName);
+    ASSERT_NE(nullptr, service);
+
+    Parcel data, reply;
+    ASSERT_EQ(OK, service->transact(WARM_UP, data, &reply));
+    // counts everything the service's binder thread allocates from building
+    // the START_COUNTING reply until STOP_COUNTING is handled
+    ASSERT_EQ(OK, service->transact(START_COUNTING, data, &reply));
+    ASSERT_EQ(OK, service->transact(STOP_COUNTING, data, &reply));
+
+    int32_t mallocs;
+    ASSERT_EQ(OK, reply.readInt32(&mallocs));
+    EXPECT_EQ(0, mallocs);
+}
+
 TEST(RpcBinderAllocation, SetupRpcServer) {
     std::string tmp = getenv("TMPDIR") ?: "/tmp";
     std::string addr = tmp + "/binderRpcBenchmark";
@@ -245,6 +334,10 @@ int main(int argc, char** argv) {
         execv(argv[0], argv);
         return 1;
     }
+    if (argc == 2 && strcmp(argv[1], kReplyServiceArg) == 0) {
+        return runReplyAllocationService();
+    }
+    gSelfPath = argv[0];
     ::testing::InitGoogleTest(&argc, argv);
 
     // if tracing is enabled, take in one-time cost
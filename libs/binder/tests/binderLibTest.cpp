@@ -21,16 +21,19 @@
 #include <stdlib.h>
 
 #include <chrono>
+#include <condition_variable>
 #include <fstream>
 #include <thread>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <android-base/file.h>
 #include <android-base/properties.h>
 #include <android-base/result-gmock.h>
 #include <android-base/result.h>
 #include <android-base/scopeguard.h>
+#include <android-base/stringprintf.h>
 #include <android-base/strings.h>
 #include <android-base/unique_fd.h>
 #include <binder/Binder.h>
@@ -124,7 +127,10 @@ enum BinderLibTestTranscationCode {
     BINDER_LIB_TEST_LOCK_UNLOCK,
     BINDER_LIB_TEST_PROCESS_LOCK,
     BINDER_LIB_TEST_UNLOCK_AFTER_MS,
-    BINDER_LIB_TEST_PROCESS_TEMPORARY_LOCK
+    BINDER_LIB_TEST_PROCESS_TEMPORARY_LOCK,
+    BINDER_LIB_TEST_SET_ONEWAY_THREADPOOL_MAX_THREAD_COUNT,
+    BINDER_LIB_TEST_RECORD_ONEWAY,
+    BINDER_LIB_TEST_GET_ONEWAY_RECORD
 };
 
 pid_t start_server_process(int arg2, bool usePoll = false)
@@ -456,6 +462,62 @@ TEST_F(BinderLibTest, AddManagerToManager) {
     EXPECT_EQ(NO_ERROR, sm->addService(String16("binderLibTest-manager"), binder));
 }
 
+TEST_F(BinderLibTest, CheckServiceSeesReplacedService) {
+    sp<IServiceManager> sm = defaultServiceManager();
+    String16 name("binderLibTest-replaced-");
+    name += String16(binderserversuffix);
+
+    sp<IBinder> first = sp<BBinder>::make();
+    ASSERT_EQ(NO_ERROR, sm->addService(name, first));
+    EXPECT_EQ(first, sm->checkService(name));
+    EXPECT_EQ(first, sm->checkService(name));
+
+    // the cached entry is updated asynchronously when the name is added again
+    sp<IBinder> second = sp<BBinder>::make();
+    ASSERT_EQ(NO_ERROR, sm->addService(name, second));
+    sp<IBinder> found;
+    for (int i = 0; i < 100 && found != second; i++) {
+        found = sm->checkService(name);
+        if (found != second) usleep(10000);
+    }
+    EXPECT_EQ(second, found);
+}
+
+TEST_F(BinderLibTest, CheckServiceDropsRestartedService) {
+    sp<IServiceManager> sm = defaultServiceManager();
+    String16 name("binderLibTest-restarted-");
+    name += String16(binderserversuffix);
+
+    sp<IBinder> first = addServer();
+    ASSERT_NE(nullptr, first);
+    ASSERT_EQ(NO_ERROR, sm->addService(name, first));
+    EXPECT_EQ(first, sm->checkService(name));
+    EXPECT_EQ(first, sm->checkService(name));
+
+    // the cached entry is dropped when the service process dies
+    sp<TestDeathRecipient> testDeathRecipient = sp<TestDeathRecipient>::make();
+    ASSERT_THAT(first->linkToDeath(testDeathRecipient), StatusEq(NO_ERROR));
+    {
+        Parcel data, reply;
+        EXPECT_THAT(first->transact(BINDER_LIB_TEST_EXIT_TRANSACTION, data, &reply, TF_ONE_WAY),
+                    StatusEq(OK));
+    }
+    IPCThreadState::self()->flushCommands();
+    ASSERT_THAT(testDeathRecipient->waitEvent(5), StatusEq(NO_ERROR));
+    EXPECT_NE(first, sm->checkService(name));
+
+    // and the restarted service is found again
+    sp<IBinder> second = addServer();
+    ASSERT_NE(nullptr, second);
+    ASSERT_EQ(NO_ERROR, sm->addService(name, second));
+    sp<IBinder> found;
+    for (int i = 0; i < 100 && found != second; i++) {
+        found = sm->checkService(name);
+        if (found != second) usleep(10000);
+    }
+    EXPECT_EQ(second, found);
+}
+
 TEST_F(BinderLibTest, WasParceled) {
     auto binder = sp<BBinder>::make();
     EXPECT_FALSE(binder->wasParceled());
@@ -663,6 +725,66 @@ TEST_F(BinderLibTest, CallBack)
     EXPECT_THAT(callBack->getResult(), StatusEq(NO_ERROR));
 }
 
+static std::string dumpTransactionLatencies() {
+    TemporaryFile tf;
+    ProcessState::self()->dumpTransactionLatencies(tf.fd);
+    std::string out;
+    EXPECT_TRUE(android::base::ReadFileToString(tf.path, &out));
+    return out;
+}
+
+TEST_F(BinderLibTest, TransactionLatencyTracking) {
+    ProcessState::self()->setTransactionLatencyTrackingEnabled(true);
+    auto disable = android::base::make_scope_guard(
+            [] { ProcessState::self()->setTransactionLatencyTrackingEnabled(false); });
+
+    Parcel data, reply;
+    EXPECT_THAT(m_server->transact(BINDER_LIB_TEST_NOP_TRANSACTION, data, &reply),
+                StatusEq(NO_ERROR));
+
+    // the server calls back into this process, which is recorded as incoming
+    sp<BinderLibTestCallBack> callBack = new BinderLibTestCallBack();
+    data.writeStrongBinder(callBack);
+    EXPECT_THAT(m_server->transact(BINDER_LIB_TEST_NOP_CALL_BACK, data, &reply, TF_ONE_WAY),
+                StatusEq(NO_ERROR));
+    EXPECT_THAT(callBack->waitEvent(5), StatusEq(NO_ERROR));
+
+    std::optional<int32_t> handle = m_server->remoteBinder()->getDebugBinderHandle();
+    ASSERT_TRUE(handle.has_value());
+    const std::string outgoing =
+            android::base::StringPrintf("outgoing handle %d code %u: count=", *handle,
+                                        BINDER_LIB_TEST_NOP_TRANSACTION);
+    // BBinder has an empty interface descriptor
+    const std::string incoming =
+            android::base::StringPrintf("incoming  code %u: count=", BINDER_LIB_TEST_CALL_BACK);
+
+    // incoming transactions are recorded once onTransact has returned, which
+    // may be just after the callback woke us up
+    std::string dump;
+    for (int i = 0; i < 100; i++) {
+        dump = dumpTransactionLatencies();
+        if (dump.find(incoming) != std::string::npos) break;
+        usleep(10000);
+    }
+    EXPECT_THAT(dump, testing::HasSubstr("(enabled,"));
+    EXPECT_THAT(dump, testing::HasSubstr(outgoing));
+    EXPECT_THAT(dump, testing::HasSubstr(incoming));
+}
+
+TEST_F(BinderLibTest, TransactionLatencyNotRecordedWhenDisabled) {
+    Parcel data, reply;
+    EXPECT_THAT(m_server->transact(BINDER_LIB_TEST_GETPID, data, &reply), StatusEq(NO_ERROR));
+
+    std::optional<int32_t> handle = m_server->remoteBinder()->getDebugBinderHandle();
+    ASSERT_TRUE(handle.has_value());
+    const std::string dump = dumpTransactionLatencies();
+    EXPECT_THAT(dump, testing::HasSubstr("(disabled,"));
+    EXPECT_THAT(dump,
+                testing::Not(testing::HasSubstr(
+                        android::base::StringPrintf("outgoing handle %d code %u:", *handle,
+                                                    BINDER_LIB_TEST_GETPID))));
+}
+
 TEST_F(BinderLibTest, BinderCallContextGuard) {
     sp<IBinder> binder = addServer();
     Parcel data, reply;
@@ -1434,6 +1556,80 @@ TEST_F(BinderLibTest, HangingServices) {
     EXPECT_GE(epochMsAfter, epochMsBefore + delay);
 }
 
+TEST_F(BinderLibTest, OnewayThreadPoolKeepsPerNodeOrder) {
+    sp<IBinder> server = addServer();
+    ASSERT_TRUE(server != nullptr);
+    {
+        Parcel data, reply;
+        data.writeInt32(4);
+        EXPECT_THAT(server->transact(BINDER_LIB_TEST_SET_ONEWAY_THREADPOOL_MAX_THREAD_COUNT, data,
+                                     &reply),
+                    StatusEq(NO_ERROR));
+    }
+
+    // The uneven delays would let calls overtake each other if the pool ran
+    // more than one call for the same binder at a time.
+    constexpr int32_t kCalls = 100;
+    for (int32_t i = 0; i < kCalls; i++) {
+        Parcel data;
+        data.writeInt32(i);
+        data.writeInt32((i % 3) * 1000);
+        EXPECT_THAT(server->transact(BINDER_LIB_TEST_RECORD_ONEWAY, data, nullptr, TF_ONE_WAY),
+                    StatusEq(NO_ERROR));
+    }
+
+    Parcel data, reply;
+    data.writeInt32(kCalls);
+    ASSERT_THAT(server->transact(BINDER_LIB_TEST_GET_ONEWAY_RECORD, data, &reply),
+                StatusEq(NO_ERROR));
+    std::vector<int32_t> record;
+    ASSERT_THAT(reply.readInt32Vector(&record), StatusEq(NO_ERROR));
+    ASSERT_EQ(static_cast<size_t>(kCalls), record.size());
+    for (int32_t i = 0; i < kCalls; i++) {
+        EXPECT_EQ(i, record[i]);
+    }
+}
+
+TEST_F(BinderLibTest, OnewayThreadPoolShutdownWithQueuedCalls) {
+    sp<TestDeathRecipient> testDeathRecipient = new TestDeathRecipient();
+    sp<IBinder> server = addServer();
+    ASSERT_TRUE(server != nullptr);
+    EXPECT_THAT(server->linkToDeath(testDeathRecipient), StatusEq(NO_ERROR));
+    {
+        Parcel data, reply;
+        data.writeInt32(2);
+        EXPECT_THAT(server->transact(BINDER_LIB_TEST_SET_ONEWAY_THREADPOOL_MAX_THREAD_COUNT, data,
+                                     &reply),
+                    StatusEq(NO_ERROR));
+    }
+
+    for (int32_t i = 0; i < 10; i++) {
+        Parcel data;
+        data.writeInt32(i);
+        data.writeInt32(100000);
+        EXPECT_THAT(server->transact(BINDER_LIB_TEST_RECORD_ONEWAY, data, nullptr, TF_ONE_WAY),
+                    StatusEq(NO_ERROR));
+    }
+    {
+        // Once the first call has run, the rest are still queued behind it.
+        Parcel data, reply;
+        data.writeInt32(1);
+        EXPECT_THAT(server->transact(BINDER_LIB_TEST_GET_ONEWAY_RECORD, data, &reply),
+                    StatusEq(NO_ERROR));
+    }
+
+    // A twoway call isn't queued behind the oneway calls, so the server exits
+    // while the pool still has calls in flight. It must go away promptly
+    // rather than hang on them.
+    Parcel data, reply;
+    EXPECT_THAT(server->transact(BINDER_LIB_TEST_EXIT_TRANSACTION, data, &reply),
+                StatusEq(DEAD_OBJECT));
+    EXPECT_THAT(testDeathRecipient->waitEvent(5), StatusEq(NO_ERROR));
+    EXPECT_THAT(server->transact(BINDER_LIB_TEST_RECORD_ONEWAY, data, nullptr, TF_ONE_WAY),
+                StatusEq(DEAD_OBJECT));
+    EXPECT_THAT(server->unlinkToDeath(testDeathRecipient), StatusEq(DEAD_OBJECT));
+}
+
 class BinderLibRpcTestBase : public BinderLibTest {
 public:
     void SetUp() override {
@@ -1891,6 +2087,26 @@ public:
                 t.detach();
                 return NO_ERROR;
             }
+            case BINDER_LIB_TEST_SET_ONEWAY_THREADPOOL_MAX_THREAD_COUNT: {
+                int32_t maxThreads = data.readInt32();
+                return ProcessState::self()->setOnewayThreadPoolMaxThreadCount(maxThreads);
+            }
+            case BINDER_LIB_TEST_RECORD_ONEWAY: {
+                int32_t value = data.readInt32();
+                int32_t delayUs = data.readInt32();
+                usleep(delayUs);
+                std::lock_guard<std::mutex> lock(m_onewayRecordMutex);
+                m_onewayRecord.push_back(value);
+                m_onewayRecordCond.notify_all();
+                return NO_ERROR;
+            }
+            case BINDER_LIB_TEST_GET_ONEWAY_RECORD: {
+                size_t count = data.readInt32();
+                std::unique_lock<std::mutex> lock(m_onewayRecordMutex);
+                m_onewayRecordCond.wait_for(lock, 5s,
+                                            [&] { return m_onewayRecord.size() >= count; });
+                return reply->writeInt32Vector(m_onewayRecord);
+            }
             default:
                 return UNKNOWN_TRANSACTION;
         };
@@ -1913,6 +2129,9 @@ private:
     sp<IBinder> m_callback;
     bool m_exitOnDestroy;
     std::mutex m_blockMutex;
+    std::mutex m_onewayRecordMutex;
+    std::condition_variable m_onewayRecordCond;
+    std::vector<int32_t> m_onewayRecord;
 };
 
 int run_server(int index, int readypipefd, bool usePoll)
@@ -169,4 +169,77 @@ BENCHMARK(BM_CharVector)->Apply(VectorArgs);
 BENCHMARK(BM_Int32Vector)->Apply(VectorArgs);
 BENCHMARK(BM_Int64Vector)->Apply(VectorArgs);
 
+// A struct of the kind which is usually parceled field by field, and which
+// can be sent with writeFixedBlock instead because it doesn't have padding.
+struct FixedStruct {
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+    int64_t timestamp;
+    int64_t id;
+};
+
+/*
+  Parcel a vector of structs, either field by field or with
+  writeFixedBlockVector/readFixedBlockVector.
+*/
+
+static void BM_StructVectorFieldByField(benchmark::State& state) {
+    const size_t elements = state.range(0);
+
+    std::vector<FixedStruct> v1(elements);
+    std::vector<FixedStruct> v2(elements);
+    android::Parcel p;
+    while (state.KeepRunning()) {
+        p.setDataPosition(0);
+        p.writeInt32(static_cast<int32_t>(v1.size()));
+        for (const FixedStruct& s : v1) {
+            p.writeInt32(s.x);
+            p.writeInt32(s.y);
+            p.writeInt32(s.width);
+            p.writeInt32(s.height);
+            p.writeInt64(s.timestamp);
+            p.writeInt64(s.id);
+        }
+
+        p.setDataPosition(0);
+        v2.resize(p.readInt32());
+        for (FixedStruct& s : v2) {
+            p.readInt32(&s.x);
+            p.readInt32(&s.y);
+            p.readInt32(&s.width);
+            p.readInt32(&s.height);
+            p.readInt64(&s.timestamp);
+            p.readInt64(&s.id);
+        }
+
+        benchmark::DoNotOptimize(v2[0]);
+        benchmark::ClobberMemory();
+    }
+    state.SetComplexityN(elements);
+}
+
+static void BM_StructVectorFixedBlock(benchmark::State& state) {
+    const size_t elements = state.range(0);
+
+    std::vector<FixedStruct> v1(elements);
+    std::vector<FixedStruct> v2(elements);
+    android::Parcel p;
+    while (state.KeepRunning()) {
+        p.setDataPosition(0);
+        p.writeFixedBlockVector(v1);
+
+        p.setDataPosition(0);
+        p.readFixedBlockVector(&v2);
+
+        benchmark::DoNotOptimize(v2[0]);
+        benchmark::ClobberMemory();
+    }
+    state.SetComplexityN(elements);
+}
+
+BENCHMARK(BM_StructVectorFieldByField)->Apply(VectorArgs);
+BENCHMARK(BM_StructVectorFixedBlock)->Apply(VectorArgs);
+
 BENCHMARK_MAIN();
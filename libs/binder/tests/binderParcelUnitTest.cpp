@@ -200,6 +200,33 @@ TEST_READ_WRITE_INVERSE(int8_t, Byte, {-1, 0, 1});
 TEST_READ_WRITE_INVERSE(String8, String8, {String8(), String8("a"), String8("asdf")});
 TEST_READ_WRITE_INVERSE(String16, String16, {String16(), String16("a"), String16("asdf")});
 
+struct FixedBlock {
+    int32_t a;
+    uint32_t b;
+    int64_t c;
+    bool operator==(const FixedBlock& o) const { return a == o.a && b == o.b && c == o.c; }
+};
+
+TEST(Parcel, InverseFixedBlock) {
+    readWriteInverse<FixedBlock>({{}, {-1, 2, INT64_MAX}}, &Parcel::readFixedBlock<FixedBlock>,
+                                 &Parcel::writeFixedBlock<FixedBlock>);
+}
+
+TEST(Parcel, InverseFixedBlockVector) {
+    readWriteInverse<std::vector<FixedBlock>>({{}, {{1, 2, 3}, {-4, 5, -6}}},
+                                              &Parcel::readFixedBlockVector<FixedBlock>,
+                                              &Parcel::writeFixedBlockVector<FixedBlock>);
+}
+
+TEST(Parcel, FixedBlockVectorTooLarge) {
+    Parcel p;
+    p.writeInt32(INT32_MAX);
+    p.setDataPosition(0);
+    std::vector<FixedBlock> out;
+    EXPECT_NE(OK, p.readFixedBlockVector(&out));
+    EXPECT_TRUE(out.empty());
+}
+
 TEST(Parcel, GetOpenAshmemSize) {
     constexpr size_t kSize = 1024;
     constexpr size_t kCount = 3;
@@ -22,6 +22,7 @@ using android::Parcel;
 using android::status_t;
 using android::base::unique_fd;
 using android::binder::debug::RecordedTransaction;
+using android::binder::debug::TransactionRecorder;
 
 TEST(BinderRecordedTransaction, RoundTripEncoding) {
     android::String16 interfaceName("SampleInterface");
@@ -138,3 +139,32 @@ TEST(BinderRecordedTransaction, PayloadsExceedPageBoundaries) {
         EXPECT_EQ(retrievedTransaction->getReplyParcel().readInt32(), 99);
     }
 }
+
+TEST(BinderRecordedTransaction, RecorderWritesInOrder) {
+    android::String16 interfaceName("SampleInterface");
+    Parcel d;
+    d.writeInt32(12);
+    Parcel r;
+    timespec ts = {1232456, 567890};
+
+    auto file = std::tmpfile();
+    auto recorder = android::sp<TransactionRecorder>::make(
+            unique_fd(fcntl(fileno(file), F_DUPFD, 1)));
+    for (uint32_t code = 1; code <= 2; code++) {
+        auto transaction = RecordedTransaction::fromDetails(interfaceName, code, 0, ts, d, r, 0);
+        ASSERT_TRUE(transaction.has_value());
+        std::vector<std::byte> serialized;
+        ASSERT_EQ(android::NO_ERROR, transaction->serialize(&serialized));
+        recorder->record(std::move(serialized));
+    }
+    recorder->stop();
+
+    std::rewind(file);
+    auto fd = unique_fd(fcntl(fileno(file), F_DUPFD, 1));
+    auto first = RecordedTransaction::fromFile(fd);
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(first->getCode(), 1);
+    auto second = RecordedTransaction::fromFile(fd);
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(second->getCode(), 2);
+}
@@ -82,6 +82,10 @@ enum Transport {
     RPC_TLS,
 };
 
+// maximum number of client threads used by multi-threaded benchmarks, and
+// the number of threads each server is started with
+constexpr size_t kMaxBenchmarkThreads = 16;
+
 static const std::initializer_list<int64_t> kTransportList = {
 #ifdef __BIONIC__
         Transport::KERNEL,
@@ -204,9 +208,37 @@ void BM_repeatBinder(benchmark::State& state) {
 }
 BENCHMARK(BM_repeatBinder)->ArgsProduct({kTransportList});
 
+// Same as BM_repeatBinder, but from many client threads at once, in order to
+// measure contention on the binder node table of the session.
+void BM_repeatBinderMultiThreaded(benchmark::State& state) {
+    sp<IBinder> binder = getBinderForOptions(state);
+    CHECK(binder != nullptr);
+    sp<IBinderRpcBenchmark> iface = interface_cast<IBinderRpcBenchmark>(binder);
+    CHECK(iface != nullptr);
+
+    // a binder which is already known to the session, so that each call also
+    // has to look up an existing node
+    sp<IBinder> known = sp<BBinder>::make();
+
+    while (state.KeepRunning()) {
+        sp<IBinder> out;
+        Status ret = iface->repeatBinder(known, &out);
+        CHECK(ret.isOk()) << ret;
+
+        // force creation of a new address
+        ret = iface->repeatBinder(sp<BBinder>::make(), &out);
+        CHECK(ret.isOk()) << ret;
+    }
+}
+BENCHMARK(BM_repeatBinderMultiThreaded)
+        ->ArgsProduct({kTransportList})
+        ->ThreadRange(1, kMaxBenchmarkThreads)
+        ->UseRealTime();
+
 void forkRpcServer(const char* addr, const sp<RpcServer>& server) {
     if (0 == fork()) {
         prctl(PR_SET_PDEATHSIG, SIGHUP); // racey, okay
+        server->setMaxThreads(kMaxBenchmarkThreads);
         server->setRootObject(sp<MyBinderRpcBenchmark>::make());
         CHECK_EQ(OK, server->setupUnixDomainServer(addr));
         server->join();
@@ -215,6 +247,7 @@ void forkRpcServer(const char* addr, const sp<RpcServer>& server) {
 }
 
 void setupClient(const sp<RpcSession>& session, const char* addr) {
+    session->setMaxOutgoingConnections(kMaxBenchmarkThreads);
     status_t status;
     for (size_t tries = 0; tries < 5; tries++) {
         usleep(10000);
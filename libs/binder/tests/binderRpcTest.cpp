@@ -357,6 +357,7 @@ std::unique_ptr<ProcessSession> BinderRpc::createRpcTestSocketServerProcessEtc(
         session->setMaxIncomingThreads(numIncoming);
         session->setMaxOutgoingConnections(options.numOutgoingConnections);
         session->setFileDescriptorTransportMode(options.clientFileDescriptorTransportMode);
+        session->setOnewayBatching(options.onewayBatchBytes, std::chrono::milliseconds(100));
 
         switch (socketType) {
             case SocketType::PRECONNECTED:
@@ -619,6 +620,105 @@ TEST_P(BinderRpc, OnewayCallQueueing) {
     saturateThreadPool(1 + kNumExtraServerThreads, proc.rootIface);
 }
 
+TEST_P(BinderRpc, OnewayCallBatching) {
+    if (clientOrServerSingleThreaded()) {
+        GTEST_SKIP() << "This test requires multiple threads";
+    }
+
+    constexpr size_t kNumQueued = 10;
+
+    auto proc = createRpcTestSocketServerProcess({.numThreads = 2, .onewayBatchBytes = 4096});
+
+    // these are held back on the client until the batch is flushed, and then
+    // they should still be processed in order.
+    for (size_t i = 0; i < kNumQueued; i++) {
+        EXPECT_OK(proc.rootIface->blockingSendIntOneway(i));
+    }
+    EXPECT_EQ(OK, proc.proc->sessions.at(0).session->flushOnewayBatch());
+
+    for (size_t i = 0; i < kNumQueued; i++) {
+        int n;
+        EXPECT_OK(proc.rootIface->blockingRecvInt(&n));
+        EXPECT_EQ(n, i);
+    }
+
+    saturateThreadPool(2, proc.rootIface);
+}
+
+TEST_P(BinderRpc, OnewayCallBatchingKeepsOrderAcrossConnections) {
+    if (clientOrServerSingleThreaded()) {
+        GTEST_SKIP() << "This test requires multiple threads";
+    }
+
+    constexpr size_t kNumQueued = 30;
+
+    // Oneway calls rotate through the outgoing connections, so each
+    // connection gets its own batch. A small budget also makes some batches
+    // fill up and be written while others are still queued.
+    auto proc = createRpcTestSocketServerProcess({.numThreads = 3, .onewayBatchBytes = 512});
+
+    for (size_t i = 0; i < kNumQueued; i++) {
+        EXPECT_OK(proc.rootIface->blockingSendIntOneway(i));
+    }
+
+    // no explicit flush: the synchronous calls write out every batch first
+    for (size_t i = 0; i < kNumQueued; i++) {
+        int n;
+        EXPECT_OK(proc.rootIface->blockingRecvInt(&n));
+        EXPECT_EQ(n, i);
+    }
+
+    saturateThreadPool(3, proc.rootIface);
+}
+
+TEST_P(BinderRpc, OnewayCallBatchingDeliversAfterWindow) {
+    if (clientOrServerSingleThreaded()) {
+        GTEST_SKIP() << "This test requires multiple threads";
+    }
+
+    const static std::string kTestString = "good afternoon!";
+
+    auto proc = createRpcTestSocketServerProcess({.numThreads = 1,
+                                                  .numSessions = 1,
+                                                  .numIncomingConnectionsBySession = {1},
+                                                  .onewayBatchBytes = 4096});
+    auto cb = sp<MyBinderRpcCallback>::make();
+
+    // Nothing else is sent on the session, so only the batch deadline can
+    // get this call to the server, which then calls back.
+    EXPECT_OK(proc.rootIface->doCallbackAsync(cb, false /*oneway*/, false /*delayed*/,
+                                              kTestString));
+    {
+        RpcMutexUniqueLock _l(cb->mMutex);
+        EXPECT_TRUE(cb->mValues.empty()) << "Oneway call was not batched";
+        cb->mCv.wait_for(_l, 1s, [&] { return !cb->mValues.empty(); });
+        ASSERT_EQ(cb->mValues.size(), 1UL);
+        EXPECT_EQ(cb->mValues.at(0), kTestString);
+    }
+
+    proc.forceShutdown();
+}
+
+TEST_P(BinderRpc, OnewayCallBatchingFailsCleanlyAfterShutdown) {
+    if (clientOrServerSingleThreaded()) {
+        GTEST_SKIP() << "This test requires multiple threads";
+    }
+
+    auto proc = createRpcTestSocketServerProcess({.numThreads = 1, .onewayBatchBytes = 4096});
+    auto session = proc.proc->sessions.at(0).session;
+
+    // queued calls are written out by the orderly shutdown
+    for (size_t i = 0; i < 5; i++) {
+        EXPECT_OK(proc.rootIface->sendString("queued"));
+    }
+    EXPECT_TRUE(session->shutdownAndWait(true));
+
+    EXPECT_EQ(DEAD_OBJECT, proc.rootIface->sendString("late").transactionError());
+    EXPECT_EQ(OK, session->flushOnewayBatch());
+
+    proc.expectAlreadyShutdown = true;
+}
+
 TEST_P(BinderRpc, OnewayCallExhaustion) {
     if (clientOrServerSingleThreaded()) {
         GTEST_SKIP() << "This test requires multiple threads";
@@ -1238,6 +1338,22 @@ INSTANTIATE_TEST_CASE_P(PerSocket, BinderRpc,
                                            ::testing::Values(false, true)),
                         BinderRpc::PrintParamInfo);
 
+// The shared memory transport passes its rings as ancillary data, so it only
+// runs over Unix domain sockets.
+static std::vector<SocketType> shmSocketTypes() {
+    return {SocketType::PRECONNECTED, SocketType::UNIX, SocketType::UNIX_BOOTSTRAP,
+            SocketType::UNIX_RAW};
+}
+
+INSTANTIATE_TEST_CASE_P(PerSocketShm, BinderRpc,
+                        ::testing::Combine(::testing::ValuesIn(shmSocketTypes()),
+                                           ::testing::Values(RpcSecurity::SHM),
+                                           ::testing::ValuesIn(testVersions()),
+                                           ::testing::ValuesIn(testVersions()),
+                                           ::testing::Values(false, true),
+                                           ::testing::Values(false, true)),
+                        BinderRpc::PrintParamInfo);
+
 class BinderRpcServerRootObject
       : public ::testing::TestWithParam<std::tuple<bool, bool, RpcSecurity>> {};
 
@@ -1397,6 +1513,49 @@ INSTANTIATE_TEST_CASE_P(BinderRpc, BinderRpcServerOnly,
                                            ::testing::ValuesIn(testVersions())),
                         BinderRpcServerOnly::PrintTestParam);
 
+class EchoBinder : public BBinder {
+    status_t onTransact(uint32_t, const Parcel& data, Parcel* reply, uint32_t) override {
+        return reply->write(data.data(), data.dataSize());
+    }
+};
+
+TEST(BinderRpcShm, EchoWrapsAroundRing) {
+    auto addr = allocateSocketAddress();
+    auto server = RpcServer::make(RpcTransportCtxFactoryShm::make());
+    server->setRootObject(sp<EchoBinder>::make());
+    ASSERT_EQ(OK, server->setupUnixDomainServer(addr.c_str()));
+    auto joinEnds = std::make_shared<OneOffSignal>();
+    std::thread([server, joinEnds] {
+        server->join();
+        joinEnds->notify();
+    }).detach();
+
+    auto session = RpcSession::make(RpcTransportCtxFactoryShm::make());
+    ASSERT_EQ(OK, session->setupUnixDomainClient(addr.c_str()));
+    auto binder = session->getRootObject();
+    ASSERT_NE(nullptr, binder);
+    EXPECT_EQ(OK, binder->pingBinder());
+
+    // under the RPC per-transaction allocation limit, but repeated enough to
+    // wrap around the rings several times
+    std::vector<uint8_t> bytes(90 * 1000);
+    for (size_t i = 0; i < bytes.size(); i++) bytes[i] = i % 251;
+
+    for (size_t i = 0; i < 10; i++) {
+        Parcel data;
+        data.markForBinder(binder);
+        ASSERT_EQ(OK, data.write(bytes.data(), bytes.size()));
+        Parcel reply;
+        ASSERT_EQ(OK, binder->transact(IBinder::FIRST_CALL_TRANSACTION, data, &reply));
+        ASSERT_EQ(bytes.size(), reply.dataSize());
+        EXPECT_EQ(0, memcmp(bytes.data(), reply.data(), bytes.size()));
+    }
+
+    EXPECT_TRUE(session->shutdownAndWait(true));
+    EXPECT_TRUE(server->shutdown());
+    EXPECT_TRUE(joinEnds->wait(2s));
+}
+
 class RpcTransportTestUtils {
 public:
     // Only parameterized only server version because `RpcSession` is bypassed
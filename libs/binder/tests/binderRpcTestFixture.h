@@ -125,7 +125,9 @@ public:
             // Trusty does not support file descriptors yet
             return false;
         }
+        // Neither TLS nor the shared memory rings carry ancillary data.
         return clientVersion() >= 1 && serverVersion() >= 1 && rpcSecurity() != RpcSecurity::TLS &&
+                rpcSecurity() != RpcSecurity::SHM &&
                 (socketType() == SocketType::PRECONNECTED || socketType() == SocketType::UNIX ||
                  socketType() == SocketType::UNIX_BOOTSTRAP ||
                  socketType() == SocketType::UNIX_RAW);
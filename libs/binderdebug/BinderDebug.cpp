@@ -20,7 +20,6 @@
 #include <binder/Binder.h>
 #include <sys/types.h>
 #include <fstream>
-#include <regex>
 
 #include <binderdebug/BinderDebug.h>
 
@@ -67,10 +66,8 @@ static status_t scanBinderContext(pid_t pid, const std::string& contextName,
 // Examples of what we are looking at:
 // node 66730: u00007590061890e0 c0000759036130950 pri 0:120 hs 1 hw 1 ls 0 lw 0 is 2 iw 2 tr 1 proc 2300 1790
 // thread 2999: l 00 need_return 1 tr 0
+// pending transaction 3126: 0000000000000000 from 4150:4150 to 2300:0 code 1 flags 10 pri 0:120 r1
 status_t getBinderPidInfo(BinderDebugContext context, pid_t pid, BinderPidInfo* pidInfo) {
-    std::smatch match;
-    static const std::regex kReferencePrefix("^\\s*node \\d+:\\s+u([0-9a-f]+)\\s+c([0-9a-f]+)\\s+");
-    static const std::regex kThreadPrefix("^\\s*thread \\d+:\\s+l\\s+(\\d)(\\d)");
     std::string contextStr = contextToString(context);
     status_t ret = scanBinderContext(pid, contextStr, [&](const std::string& line) {
         if (base::StartsWith(line, "  node")) {
@@ -122,6 +119,10 @@ status_t getBinderPidInfo(BinderDebugContext context, pid_t pid, BinderPidInfo*
 
                 pidInfo->threadCount++;
             }
+        } else if (base::StartsWith(line, "  pending transaction")) {
+            // Transactions queued on the process rather than on one of its
+            // threads are waiting for a binder thread to become available.
+            pidInfo->pendingTransactions++;
         }
     });
     return ret;
@@ -132,8 +133,6 @@ status_t getBinderPidInfo(BinderDebugContext context, pid_t pid, BinderPidInfo*
 // node 29413: u00007803fc982e80 c000078042c982210 pri 0:139 hs 1 hw 1 ls 0 lw 0 is 2 iw 2 tr 1 proc 488 683
 status_t getBinderClientPids(BinderDebugContext context, pid_t pid, pid_t servicePid,
                              int32_t handle, std::vector<pid_t>* pids) {
-    std::smatch match;
-    static const std::regex kNodeNumber("^\\s+ref \\d+:\\s+desc\\s+(\\d+)\\s+node\\s+(\\d+).*");
     std::string contextStr = contextToString(context);
     int32_t node;
     status_t ret = scanBinderContext(pid, contextStr, [&](const std::string& line) {
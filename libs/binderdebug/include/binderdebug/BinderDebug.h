@@ -24,8 +24,9 @@ namespace android {
 
 struct BinderPidInfo {
     std::map<uint64_t, std::vector<pid_t>> refPids; // cookie -> processes which hold binder
-    uint32_t threadUsage;                           // number of threads in use
-    uint32_t threadCount;                           // number of threads total
+    uint32_t threadUsage = 0;                       // number of threads in use
+    uint32_t threadCount = 0;                       // number of threads total
+    uint32_t pendingTransactions = 0;               // number of transactions waiting for a thread
 };
 
 enum class BinderDebugContext {
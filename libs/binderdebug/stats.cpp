@@ -29,7 +29,7 @@ extern "C" int main() {
 
     // we should use a csv library here for escaping, because
     // the name is coming from another process
-    printf("name,binder_threads_in_use,binder_threads_started,client_count\n");
+    printf("name,binder_threads_in_use,binder_threads_started,pending_transactions,client_count\n");
 
     for (const String16& name : defaultServiceManager()->listServices()) {
         sp<IBinder> binder = defaultServiceManager()->checkService(name);
@@ -53,8 +53,8 @@ extern "C" int main() {
                  getBinderClientPids(BinderDebugContext::BINDER, getpid(), pid, *handle,
                                      &clientPids));
 
-        printf("%s,%" PRIu32 ",%" PRIu32 ",%zu\n", String8(name).c_str(), info.threadUsage,
-               info.threadCount, clientPids.size());
+        printf("%s,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%zu\n", String8(name).c_str(),
+               info.threadUsage, info.threadCount, info.pendingTransactions, clientPids.size());
     }
     return 0;
 }
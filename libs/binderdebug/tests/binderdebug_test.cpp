@@ -58,6 +58,8 @@ TEST(BinderDebugTests, BinderThreads) {
     EXPECT_TRUE(pidInfo.threadUsage <= pidInfo.threadCount);
     // The second looper thread can sometimes take longer to spawn.
     EXPECT_GE(pidInfo.threadCount, 1);
+    // Nothing is calling into this process, so no transaction is waiting for a thread.
+    EXPECT_EQ(pidInfo.pendingTransactions, 0u);
 }
 
 extern "C" {
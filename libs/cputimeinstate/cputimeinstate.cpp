@@ -22,14 +22,20 @@
 #include <dirent.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <linux/bpf.h>
+#include <sys/syscall.h>
 #include <sys/sysinfo.h>
+#include <unistd.h>
 
+#include <atomic>
+#include <functional>
 #include <mutex>
 #include <numeric>
 #include <optional>
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <android-base/file.h>
@@ -62,6 +68,7 @@ static unique_fd gTisMapFd;
 static unique_fd gConcurrentMapFd;
 static unique_fd gUidLastUpdateMapFd;
 static unique_fd gPidTisMapFd;
+static std::atomic<bool> gBatchLookupUnsupported = false;
 
 static std::optional<std::vector<uint32_t>> readNumbersFromFile(const std::string &path) {
     std::string data;
@@ -337,16 +344,83 @@ std::optional<std::vector<std::vector<uint64_t>>> getUidCpuFreqTimes(uint32_t ui
     return out;
 }
 
-static std::optional<bool> uidUpdatedSince(uint32_t uid, uint64_t lastUpdate,
-                                           uint64_t *newLastUpdate) {
-    uint64_t uidLastUpdate;
-    if (findMapEntry(gUidLastUpdateMapFd, &uid, &uidLastUpdate)) return {};
-    // Updates that occurred during the previous read may have been missed. To mitigate
-    // this, don't ignore entries updated up to 1s before *lastUpdate
-    constexpr uint64_t NSEC_PER_SEC = 1000000000;
-    if (uidLastUpdate + NSEC_PER_SEC < lastUpdate) return false;
-    if (uidLastUpdate > *newLastUpdate) *newLastUpdate = uidLastUpdate;
-    return true;
+// Number of entries read by each BPF_MAP_LOOKUP_BATCH call.
+constexpr uint32_t LOOKUP_BATCH_SIZE = 256;
+
+static int lookupMapBatch(const unique_fd &mapFd, const uint32_t *inBatch, uint32_t *outBatch,
+                          void *keys, void *values, uint32_t *count) {
+    union bpf_attr attr = {};
+    attr.batch.in_batch = reinterpret_cast<uintptr_t>(inBatch);
+    attr.batch.out_batch = reinterpret_cast<uintptr_t>(outBatch);
+    attr.batch.keys = reinterpret_cast<uintptr_t>(keys);
+    attr.batch.values = reinterpret_cast<uintptr_t>(values);
+    attr.batch.count = *count;
+    attr.batch.map_fd = mapFd.get();
+    int ret = syscall(__NR_bpf, BPF_MAP_LOOKUP_BATCH, &attr, sizeof(attr));
+    *count = attr.batch.count;
+    return ret;
+}
+
+// Calls fn on every entry of a hash map whose values are arrays of valuesPerEntry Values, as
+// per-CPU maps have. Reads LOOKUP_BATCH_SIZE entries per syscall where the kernel supports
+// BPF_MAP_LOOKUP_BATCH, and walks the keys one at a time otherwise. Returns false on error or if
+// fn returns false.
+template <typename Key, typename Value>
+static bool forEachMapEntry(const unique_fd &mapFd, uint32_t valuesPerEntry,
+                            const std::function<bool(const Key &, const Value *)> &fn) {
+    if (!gBatchLookupUnsupported) {
+        std::vector<Key> keys(LOOKUP_BATCH_SIZE);
+        std::vector<Value> values(LOOKUP_BATCH_SIZE * valuesPerEntry);
+        uint32_t inBatch = 0, outBatch = 0;
+        for (bool first = true;; first = false) {
+            uint32_t count = LOOKUP_BATCH_SIZE;
+            int ret = lookupMapBatch(mapFd, first ? nullptr : &inBatch, &outBatch, keys.data(),
+                                     values.data(), &count);
+            if (ret && errno != ENOENT) {
+                // 524 is the kernel-internal ENOTSUPP, which the bpf syscall can leak for maps
+                // without batch support.
+                if (!first || (errno != EINVAL && errno != EOPNOTSUPP && errno != 524)) {
+                    return false;
+                }
+                gBatchLookupUnsupported = true;
+                break;
+            }
+            for (uint32_t i = 0; i < count; ++i) {
+                if (!fn(keys[i], &values[i * valuesPerEntry])) return false;
+            }
+            // ENOENT means the last batch was returned.
+            if (ret) return true;
+            inBatch = outBatch;
+        }
+    }
+
+    Key key, prevKey;
+    std::vector<Value> values(valuesPerEntry);
+    if (getFirstMapKey(mapFd, &key)) return errno == ENOENT;
+    do {
+        if (findMapEntry(mapFd, &key, values.data())) return false;
+        if (!fn(key, values.data())) return false;
+    } while (prevKey = key, !getNextMapKey(mapFd, &prevKey, &key));
+    return errno == ENOENT;
+}
+
+// Return contains no value on error, otherwise it contains the set of uids updated since
+// lastUpdate, and newLastUpdate is raised to the latest update among them.
+static std::optional<std::unordered_set<uint32_t>> getUidsUpdatedSince(uint64_t lastUpdate,
+                                                                      uint64_t *newLastUpdate) {
+    std::unordered_set<uint32_t> uids;
+    bool ok = forEachMapEntry<uint32_t, uint64_t>(
+            gUidLastUpdateMapFd, 1, [&](const uint32_t &uid, const uint64_t *uidLastUpdate) {
+                // Updates that occurred during the previous read may have been missed. To
+                // mitigate this, don't ignore entries updated up to 1s before lastUpdate
+                constexpr uint64_t NSEC_PER_SEC = 1000000000;
+                if (*uidLastUpdate + NSEC_PER_SEC < lastUpdate) return true;
+                if (*uidLastUpdate > *newLastUpdate) *newLastUpdate = *uidLastUpdate;
+                uids.insert(uid);
+                return true;
+            });
+    if (!ok) return {};
+    return uids;
 }
 
 // Retrieve the times in ns that each uid spent running at each CPU freq.
@@ -366,42 +440,39 @@ getUidsCpuFreqTimes() {
 std::optional<std::unordered_map<uint32_t, std::vector<std::vector<uint64_t>>>>
 getUidsUpdatedCpuFreqTimes(uint64_t *lastUpdate) {
     if (!gInitialized && !initGlobals()) return {};
-    time_key_t key, prevKey;
     std::unordered_map<uint32_t, std::vector<std::vector<uint64_t>>> map;
-    if (getFirstMapKey(gTisMapFd, &key)) {
-        if (errno == ENOENT) return map;
-        return std::nullopt;
+
+    uint64_t newLastUpdate = lastUpdate ? *lastUpdate : 0;
+    std::optional<std::unordered_set<uint32_t>> updatedUids;
+    if (lastUpdate) {
+        updatedUids = getUidsUpdatedSince(*lastUpdate, &newLastUpdate);
+        if (!updatedUids.has_value()) return {};
+        if (updatedUids->empty()) return map;
     }
 
     std::vector<std::vector<uint64_t>> mapFormat;
     for (const auto &freqList : gPolicyFreqs) mapFormat.emplace_back(freqList.size(), 0);
 
-    uint64_t newLastUpdate = lastUpdate ? *lastUpdate : 0;
-    std::vector<tis_val_t> vals(gNCpus);
-    do {
-        if (lastUpdate) {
-            auto uidUpdated = uidUpdatedSince(key.uid, *lastUpdate, &newLastUpdate);
-            if (!uidUpdated.has_value()) return {};
-            if (!*uidUpdated) continue;
-        }
-        if (findMapEntry(gTisMapFd, &key, vals.data())) return {};
-        if (map.find(key.uid) == map.end()) map.emplace(key.uid, mapFormat);
-
-        auto offset = key.bucket * FREQS_PER_ENTRY;
-        auto nextOffset = (key.bucket + 1) * FREQS_PER_ENTRY;
-        for (uint32_t i = 0; i < gNPolicies; ++i) {
-            if (offset >= gPolicyFreqs[i].size()) continue;
-            auto begin = map[key.uid][i].begin() + offset;
-            auto end = nextOffset < gPolicyFreqs[i].size() ? begin + FREQS_PER_ENTRY :
-                map[key.uid][i].end();
-            for (const auto &cpu : gPolicyCpus[i]) {
-                std::transform(begin, end, std::begin(vals[gCpuIndexMap[cpu]].ar), begin,
-                               std::plus<uint64_t>());
-            }
-        }
-        prevKey = key;
-    } while (prevKey = key, !getNextMapKey(gTisMapFd, &prevKey, &key));
-    if (errno != ENOENT) return {};
+    bool ok = forEachMapEntry<time_key_t, tis_val_t>(
+            gTisMapFd, gNCpus, [&](const time_key_t &key, const tis_val_t *vals) {
+                if (updatedUids && !updatedUids->count(key.uid)) return true;
+                auto &times = map.try_emplace(key.uid, mapFormat).first->second;
+
+                auto offset = key.bucket * FREQS_PER_ENTRY;
+                auto nextOffset = (key.bucket + 1) * FREQS_PER_ENTRY;
+                for (uint32_t i = 0; i < gNPolicies; ++i) {
+                    if (offset >= gPolicyFreqs[i].size()) continue;
+                    auto begin = times[i].begin() + offset;
+                    auto end = nextOffset < gPolicyFreqs[i].size() ? begin + FREQS_PER_ENTRY
+                                                                   : times[i].end();
+                    for (const auto &cpu : gPolicyCpus[i]) {
+                        std::transform(begin, end, std::begin(vals[gCpuIndexMap[cpu]].ar), begin,
+                                       std::plus<uint64_t>());
+                    }
+                }
+                return true;
+            });
+    if (!ok) return {};
     if (lastUpdate && newLastUpdate > *lastUpdate) *lastUpdate = newLastUpdate;
     return map;
 }
@@ -478,54 +549,53 @@ std::optional<std::unordered_map<uint32_t, concurrent_time_t>> getUidsConcurrent
 std::optional<std::unordered_map<uint32_t, concurrent_time_t>> getUidsUpdatedConcurrentTimes(
         uint64_t *lastUpdate) {
     if (!gInitialized && !initGlobals()) return {};
-    time_key_t key, prevKey;
     std::unordered_map<uint32_t, concurrent_time_t> ret;
-    if (getFirstMapKey(gConcurrentMapFd, &key)) {
-        if (errno == ENOENT) return ret;
-        return {};
+
+    uint64_t newLastUpdate = lastUpdate ? *lastUpdate : 0;
+    std::optional<std::unordered_set<uint32_t>> updatedUids;
+    if (lastUpdate) {
+        updatedUids = getUidsUpdatedSince(*lastUpdate, &newLastUpdate);
+        if (!updatedUids.has_value()) return {};
+        if (updatedUids->empty()) return ret;
     }
 
     concurrent_time_t retFormat = {.active = std::vector<uint64_t>(gNCpus, 0)};
     for (const auto &cpuList : gPolicyCpus) retFormat.policy.emplace_back(cpuList.size(), 0);
 
-    std::vector<concurrent_val_t> vals(gNCpus);
-    std::vector<uint64_t>::iterator activeBegin, activeEnd, policyBegin, policyEnd;
-
-    uint64_t newLastUpdate = lastUpdate ? *lastUpdate : 0;
-    do {
-        if (key.bucket > (gNCpus - 1) / CPUS_PER_ENTRY) return {};
-        if (lastUpdate) {
-            auto uidUpdated = uidUpdatedSince(key.uid, *lastUpdate, &newLastUpdate);
-            if (!uidUpdated.has_value()) return {};
-            if (!*uidUpdated) continue;
-        }
-        if (findMapEntry(gConcurrentMapFd, &key, vals.data())) return {};
-        if (ret.find(key.uid) == ret.end()) ret.emplace(key.uid, retFormat);
+    bool ok = forEachMapEntry<time_key_t, concurrent_val_t>(
+            gConcurrentMapFd, gNCpus, [&](const time_key_t &key, const concurrent_val_t *vals) {
+                if (key.bucket > (gNCpus - 1) / CPUS_PER_ENTRY) return false;
+                if (updatedUids && !updatedUids->count(key.uid)) return true;
+                auto &times = ret.try_emplace(key.uid, retFormat).first->second;
 
-        auto offset = key.bucket * CPUS_PER_ENTRY;
-        auto nextOffset = (key.bucket + 1) * CPUS_PER_ENTRY;
+                auto offset = key.bucket * CPUS_PER_ENTRY;
+                auto nextOffset = (key.bucket + 1) * CPUS_PER_ENTRY;
 
-        activeBegin = ret[key.uid].active.begin();
-        activeEnd = nextOffset < gNCpus ? activeBegin + CPUS_PER_ENTRY : ret[key.uid].active.end();
+                auto activeBegin = times.active.begin();
+                auto activeEnd =
+                        nextOffset < gNCpus ? activeBegin + CPUS_PER_ENTRY : times.active.end();
 
-        for (uint32_t cpu = 0; cpu < gNCpus; ++cpu) {
-            std::transform(activeBegin, activeEnd, std::begin(vals[cpu].active), activeBegin,
-                           std::plus<uint64_t>());
-        }
-
-        for (uint32_t policy = 0; policy < gNPolicies; ++policy) {
-            if (offset >= gPolicyCpus[policy].size()) continue;
-            policyBegin = ret[key.uid].policy[policy].begin() + offset;
-            policyEnd = nextOffset < gPolicyCpus[policy].size() ? policyBegin + CPUS_PER_ENTRY
-                                                                : ret[key.uid].policy[policy].end();
+                for (uint32_t cpu = 0; cpu < gNCpus; ++cpu) {
+                    std::transform(activeBegin, activeEnd, std::begin(vals[cpu].active),
+                                   activeBegin, std::plus<uint64_t>());
+                }
 
-            for (const auto &cpu : gPolicyCpus[policy]) {
-                std::transform(policyBegin, policyEnd, std::begin(vals[gCpuIndexMap[cpu]].policy),
-                               policyBegin, std::plus<uint64_t>());
-            }
-        }
-    } while (prevKey = key, !getNextMapKey(gConcurrentMapFd, &prevKey, &key));
-    if (errno != ENOENT) return {};
+                for (uint32_t policy = 0; policy < gNPolicies; ++policy) {
+                    if (offset >= gPolicyCpus[policy].size()) continue;
+                    auto policyBegin = times.policy[policy].begin() + offset;
+                    auto policyEnd = nextOffset < gPolicyCpus[policy].size()
+                            ? policyBegin + CPUS_PER_ENTRY
+                            : times.policy[policy].end();
+
+                    for (const auto &cpu : gPolicyCpus[policy]) {
+                        std::transform(policyBegin, policyEnd,
+                                       std::begin(vals[gCpuIndexMap[cpu]].policy), policyBegin,
+                                       std::plus<uint64_t>());
+                    }
+                }
+                return true;
+            });
+    if (!ok) return {};
     for (const auto &[key, value] : ret) {
         if (!verifyConcurrentTimes(value)) {
             auto val = getUidConcurrentTimes(key, false);
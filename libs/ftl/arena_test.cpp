@@ -0,0 +1,118 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ftl/arena.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace android::test {
+
+using ftl::Arena;
+using ftl::ArenaAllocator;
+using ftl::ArenaVector;
+
+// Keep in sync with example usage in header file.
+TEST(Arena, Example) {
+  ftl::Arena arena;
+
+  for (int frame = 0; frame < 3; ++frame) {
+    {
+      ftl::ArenaVector<int> layers(arena);
+      layers.push_back(frame);
+      EXPECT_GT(arena.bytes_used(), 0u);
+    }
+    arena.reset();
+    EXPECT_EQ(arena.bytes_used(), 0u);
+  }
+}
+
+TEST(Arena, Alignment) {
+  Arena arena;
+
+  EXPECT_NE(arena.allocate(1, 1), nullptr);
+
+  for (std::size_t alignment : {2u, 8u, 64u, 256u}) {
+    const auto address = reinterpret_cast<std::uintptr_t>(arena.allocate(3, alignment));
+    EXPECT_EQ(address % alignment, 0u) << alignment;
+  }
+}
+
+TEST(Arena, Chunks) {
+  Arena arena(64);
+  EXPECT_EQ(arena.bytes_reserved(), 0u);
+
+  // Allocations that do not fit in the current chunk move on to a new one.
+  void* const first = arena.allocate(48, 1);
+  void* const second = arena.allocate(48, 1);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(arena.bytes_reserved(), 128u);
+  EXPECT_EQ(arena.bytes_used(), 96u);
+
+  // Allocations larger than the chunk size get a chunk of their own.
+  EXPECT_NE(arena.allocate(1000, 1), nullptr);
+  EXPECT_EQ(arena.bytes_reserved(), 1128u);
+}
+
+TEST(Arena, ResetReusesChunks) {
+  Arena arena(64);
+
+  const auto allocate = [&arena] {
+    std::vector<void*> pointers;
+    for (int i = 0; i < 10; ++i) {
+      pointers.push_back(arena.allocate(40, 8));
+    }
+    pointers.push_back(arena.allocate(200, 8));
+    return pointers;
+  };
+
+  const auto pointers = allocate();
+  const auto reserved = arena.bytes_reserved();
+
+  arena.reset();
+  EXPECT_EQ(arena.bytes_used(), 0u);
+
+  // The same sequence of allocations is served from the same memory.
+  EXPECT_EQ(allocate(), pointers);
+  EXPECT_EQ(arena.bytes_reserved(), reserved);
+}
+
+TEST(Arena, Containers) {
+  Arena arena;
+
+  ArenaVector<std::string> strings(arena);
+  for (int i = 0; i < 100; ++i) {
+    strings.push_back(std::to_string(i));
+  }
+  EXPECT_EQ(strings[42], "42");
+
+  using Map = std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                                 ArenaAllocator<std::pair<const int, int>>>;
+  Map map(0, std::hash<int>(), std::equal_to<int>(), arena);
+  for (int i = 0; i < 100; ++i) {
+    map.emplace(i, i * i);
+  }
+  EXPECT_EQ(map.at(9), 81);
+
+  EXPECT_EQ(strings.get_allocator(), ArenaAllocator<std::string>(arena));
+
+  Arena other;
+  EXPECT_NE(strings.get_allocator(), ArenaAllocator<std::string>(other));
+}
+
+}  // namespace android::test
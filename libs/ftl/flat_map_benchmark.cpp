@@ -0,0 +1,99 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <ftl/flat_map.h>
+#include <ftl/small_map.h>
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace android {
+namespace {
+
+// Keys resemble layer IDs: mostly increasing, with gaps left by destroyed layers.
+std::vector<std::uint32_t> makeKeys(std::size_t count) {
+  std::vector<std::uint32_t> keys;
+  keys.reserve(count);
+  for (std::uint32_t id = 1; keys.size() < count; id += 1 + id % 3) {
+    keys.push_back(id);
+  }
+  return keys;
+}
+
+template <typename Map>
+bool contains(const Map& map, std::uint32_t key) {
+  return map.find(key) != map.end();
+}
+
+template <typename Map>
+void BM_lookup(benchmark::State& state) {
+  const auto keys = makeKeys(static_cast<std::size_t>(state.range(0)));
+  Map map;
+  for (const auto key : keys) {
+    map.try_emplace(key, key);
+  }
+
+  std::size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(contains(map, keys[i]));
+    // Also look up a key that is absent, as often happens on invalidated IDs.
+    benchmark::DoNotOptimize(contains(map, keys[i] + 1));
+    if (++i == keys.size()) i = 0;
+  }
+}
+
+template <typename Map>
+void BM_churn(benchmark::State& state) {
+  const auto keys = makeKeys(static_cast<std::size_t>(state.range(0)) * 2);
+  const std::size_t half = keys.size() / 2;
+  Map map;
+  for (std::size_t i = 0; i < half; ++i) {
+    map.try_emplace(keys[i], keys[i]);
+  }
+
+  // Replace one mapping per iteration, like a layer being destroyed while another is created.
+  std::size_t i = 0;
+  for (auto _ : state) {
+    map.erase(keys[i]);
+    map.try_emplace(keys[i + half], keys[i + half]);
+    map.erase(keys[i + half]);
+    map.try_emplace(keys[i], keys[i]);
+    if (++i == half) i = 0;
+  }
+}
+
+using StdMap = std::map<std::uint32_t, std::uint32_t>;
+using StdUnorderedMap = std::unordered_map<std::uint32_t, std::uint32_t>;
+using FlatMap = ftl::FlatMap<std::uint32_t, std::uint32_t>;
+using SmallMap = ftl::SmallMap<std::uint32_t, std::uint32_t, 16>;
+
+BENCHMARK_TEMPLATE(BM_lookup, StdMap)->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK_TEMPLATE(BM_lookup, StdUnorderedMap)->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK_TEMPLATE(BM_lookup, FlatMap)->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK_TEMPLATE(BM_lookup, SmallMap)->RangeMultiplier(4)->Range(4, 64);
+
+BENCHMARK_TEMPLATE(BM_churn, StdMap)->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK_TEMPLATE(BM_churn, StdUnorderedMap)->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK_TEMPLATE(BM_churn, FlatMap)->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK_TEMPLATE(BM_churn, SmallMap)->RangeMultiplier(4)->Range(4, 64);
+
+}  // namespace
+}  // namespace android
+
+BENCHMARK_MAIN();
@@ -0,0 +1,255 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ftl/flat_map.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace android::test {
+
+using ftl::FlatMap;
+
+// Keep in sync with example usage in header file.
+TEST(FlatMap, Example) {
+  ftl::FlatMap<int, std::string> map;
+  EXPECT_TRUE(map.empty());
+
+  map.try_emplace(123, "abc");
+  map.try_emplace(-1);
+  map.try_emplace(42, 3u, '?');
+  EXPECT_EQ(map.size(), 3u);
+
+  EXPECT_TRUE(map.contains(123));
+
+  EXPECT_EQ(map.get(42).transform([](const std::string& s) { return s.size(); }), 3u);
+
+  const auto opt = map.get(-1);
+  ASSERT_TRUE(opt);
+
+  std::string& ref = *opt;
+  EXPECT_TRUE(ref.empty());
+  ref = "xyz";
+
+  map.emplace_or_replace(0, "vanilla", 2u, 3u);
+  EXPECT_EQ(map.get(0)->get(), "nil");
+
+  EXPECT_TRUE(map.erase(123));
+  EXPECT_FALSE(map.contains(123));
+}
+
+TEST(FlatMap, Construct) {
+  {
+    // Default constructor does not allocate.
+    FlatMap<int, std::string> map;
+
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.capacity(), 0u);
+    EXPECT_EQ(map.begin(), map.end());
+  }
+  {
+    // Copy constructor.
+    FlatMap<int, std::string> map;
+    map.try_emplace(1, "one");
+    map.try_emplace(2, "two");
+
+    const FlatMap<int, std::string> copy = map;
+    EXPECT_EQ(copy, map);
+
+    map.try_replace(1, "uno");
+    EXPECT_NE(copy, map);
+    EXPECT_EQ(copy.get(1)->get(), "one");
+  }
+  {
+    // Move constructor.
+    FlatMap<int, std::unique_ptr<int>> map;
+    map.try_emplace(1, std::make_unique<int>(1));
+
+    const FlatMap<int, std::unique_ptr<int>> other = std::move(map);
+    EXPECT_EQ(other.size(), 1u);
+    EXPECT_EQ(*other.get(1)->get(), 1);
+  }
+}
+
+TEST(FlatMap, Reserve) {
+  FlatMap<int, int> map;
+  map.reserve(100);
+
+  const auto capacity = map.capacity();
+  EXPECT_GE(capacity * 3, 100u * 4);
+
+  for (int i = 0; i < 100; ++i) {
+    map.try_emplace(i, i);
+  }
+  EXPECT_EQ(map.capacity(), capacity);
+}
+
+TEST(FlatMap, Find) {
+  FlatMap<char, int> map;
+  map.try_emplace('a', 1);
+  map.try_emplace('b', 2);
+
+  const auto it = map.find('b');
+  ASSERT_NE(it, map.end());
+  EXPECT_EQ(it->first, 'b');
+  EXPECT_EQ(it->second, 2);
+
+  EXPECT_EQ(map.find('c'), map.end());
+  EXPECT_EQ(std::as_const(map).find('c'), map.cend());
+}
+
+TEST(FlatMap, TryEmplace) {
+  FlatMap<int, std::string> map;
+
+  {
+    const auto [it, ok] = map.try_emplace(1, "a");
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(it->second, "a");
+  }
+  {
+    const auto [it, ok] = map.try_emplace(1, "b");
+    EXPECT_FALSE(ok);
+    EXPECT_EQ(it->second, "a");
+  }
+}
+
+TEST(FlatMap, TryReplace) {
+  FlatMap<int, std::string> map;
+  map.try_emplace(1, "a");
+
+  EXPECT_EQ(map.try_replace(2, "b"), map.end());
+
+  const auto it = map.try_replace(1, "b");
+  ASSERT_NE(it, map.end());
+  EXPECT_EQ(it->second, "b");
+
+  // The replacement may refer to the replaced value.
+  map.try_replace(1, map.get(1)->get() + 'c');
+  EXPECT_EQ(map.get(1)->get(), "bc");
+}
+
+TEST(FlatMap, EmplaceOrReplace) {
+  FlatMap<int, std::string> map;
+
+  EXPECT_TRUE(map.emplace_or_replace(1, "a").second);
+  EXPECT_FALSE(map.emplace_or_replace(1, "b").second);
+  EXPECT_EQ(map.get(1)->get(), "b");
+}
+
+TEST(FlatMap, Erase) {
+  FlatMap<int, int> map;
+  EXPECT_FALSE(map.erase(0));
+
+  for (int i = 0; i < 10; ++i) {
+    map.try_emplace(i, i);
+  }
+
+  EXPECT_TRUE(map.erase(3));
+  EXPECT_FALSE(map.erase(3));
+  EXPECT_EQ(map.size(), 9u);
+
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(map.contains(i), i != 3) << i;
+  }
+}
+
+TEST(FlatMap, Clear) {
+  FlatMap<int, std::shared_ptr<int>> map;
+  const auto value = std::make_shared<int>(0);
+
+  map.try_emplace(1, value);
+  map.try_emplace(2, value);
+  EXPECT_EQ(value.use_count(), 3);
+
+  const auto capacity = map.capacity();
+  map.clear();
+
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.capacity(), capacity);
+  EXPECT_EQ(map.begin(), map.end());
+  EXPECT_EQ(value.use_count(), 1);
+}
+
+// Keys that hash to the same home slot form a single probe sequence, which exercises the shifting
+// of mappings on erase.
+TEST(FlatMap, Collisions) {
+  struct Collide {
+    std::size_t operator()(int) const { return 0; }
+  };
+
+  FlatMap<int, int, Collide> map;
+  for (int i = 0; i < 5; ++i) {
+    map.try_emplace(i, i * 10);
+  }
+
+  EXPECT_TRUE(map.erase(0));
+  EXPECT_TRUE(map.erase(3));
+
+  EXPECT_EQ(map.size(), 3u);
+  for (int i : {1, 2, 4}) {
+    EXPECT_EQ(map.get(i), i * 10);
+  }
+  EXPECT_FALSE(map.contains(0));
+  EXPECT_FALSE(map.contains(3));
+}
+
+// Compares against std::unordered_map over a long sequence of mixed operations, with keys drawn
+// from a small range so that emplace and erase churn the same probe sequences.
+TEST(FlatMap, MatchesUnorderedMap) {
+  FlatMap<unsigned, unsigned> map;
+  std::unordered_map<unsigned, unsigned> reference;
+
+  unsigned state = 1;
+  const auto next = [&state] {
+    state = state * 1103515245u + 12345u;
+    return (state >> 16) % 256;
+  };
+
+  for (int i = 0; i < 10000; ++i) {
+    const unsigned key = next();
+    switch (next() % 3) {
+      case 0:
+        EXPECT_EQ(map.try_emplace(key, i).second, reference.try_emplace(key, i).second);
+        break;
+      case 1:
+        EXPECT_EQ(map.emplace_or_replace(key, i).second,
+                  reference.insert_or_assign(key, i).second);
+        break;
+      case 2:
+        EXPECT_EQ(map.erase(key), reference.erase(key) == 1);
+        break;
+    }
+  }
+
+  ASSERT_EQ(map.size(), reference.size());
+  for (const auto& [key, value] : reference) {
+    EXPECT_EQ(map.get(key), value);
+  }
+
+  std::vector<unsigned> keys;
+  for (const auto& [key, value] : map) {
+    keys.push_back(key);
+  }
+  std::sort(keys.begin(), keys.end());
+  EXPECT_EQ(std::adjacent_find(keys.begin(), keys.end()), keys.end());
+  EXPECT_EQ(keys.size(), reference.size());
+}
+
+}  // namespace android::test
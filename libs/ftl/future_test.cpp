@@ -102,4 +102,19 @@ TEST(Future, Chain) {
   decrement_thread.join();
 }
 
+TEST(Future, WaitFor) {
+  using namespace std::chrono_literals;
+
+  EXPECT_EQ(ftl::yield(42).wait_for(0ms), std::future_status::ready);
+  EXPECT_EQ(ftl::yield(42).share().wait_for(0ms), std::future_status::ready);
+
+  std::promise<int> promise;
+  ftl::SharedFuture<int> future = ftl::Future(promise.get_future()).share();
+  EXPECT_EQ(future.wait_for(0ms), std::future_status::timeout);
+
+  promise.set_value(123);
+  EXPECT_EQ(future.wait_for(0ms), std::future_status::ready);
+  EXPECT_EQ(future.get(), 123);
+}
+
 }  // namespace android::test
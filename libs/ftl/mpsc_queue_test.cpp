@@ -0,0 +1,120 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ftl/mpsc_queue.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace android::test {
+
+using ftl::MpscQueue;
+
+// Keep in sync with example usage in header file.
+TEST(MpscQueue, Example) {
+  ftl::MpscQueue<std::string> queue;
+  EXPECT_TRUE(queue.empty());
+
+  std::thread producer([&queue] {
+    queue.push("abc");
+    queue.emplace(3u, '?');
+  });
+  producer.join();
+
+  EXPECT_EQ(queue.pop(), "abc");
+  EXPECT_EQ(queue.pop(), "???");
+  EXPECT_FALSE(queue.pop());
+}
+
+TEST(MpscQueue, Fifo) {
+  MpscQueue<int> queue;
+
+  queue.push(1);
+  queue.push(2);
+  EXPECT_EQ(queue.pop(), 1);
+
+  // Interleave pushes with pops from the list already taken by the consumer.
+  queue.push(3);
+  EXPECT_FALSE(queue.empty());
+  EXPECT_EQ(queue.pop(), 2);
+  EXPECT_EQ(queue.pop(), 3);
+
+  EXPECT_TRUE(queue.empty());
+  EXPECT_FALSE(queue.pop());
+}
+
+TEST(MpscQueue, MoveOnly) {
+  MpscQueue<std::unique_ptr<int>> queue;
+  queue.push(std::make_unique<int>(42));
+
+  const auto value = queue.pop();
+  ASSERT_TRUE(value);
+  EXPECT_EQ(**value, 42);
+}
+
+TEST(MpscQueue, DestroysRemainingElements) {
+  const auto value = std::make_shared<int>(0);
+  {
+    MpscQueue<std::shared_ptr<int>> queue;
+    queue.push(value);
+    queue.push(value);
+    queue.push(value);
+
+    // Leave elements both in the consumer's list and on the producers' stack.
+    EXPECT_TRUE(queue.pop());
+    queue.push(value);
+    EXPECT_EQ(value.use_count(), 4);
+  }
+  EXPECT_EQ(value.use_count(), 1);
+}
+
+TEST(MpscQueue, MultipleProducers) {
+  constexpr int kProducers = 4;
+  constexpr int kValuesPerProducer = 10000;
+
+  MpscQueue<std::pair<int, int>> queue;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&queue, p] {
+      for (int i = 0; i < kValuesPerProducer; ++i) {
+        queue.emplace(p, i);
+      }
+    });
+  }
+
+  // Values from each producer must be popped in order.
+  std::vector<int> next(kProducers, 0);
+  int popped = 0;
+  while (popped < kProducers * kValuesPerProducer) {
+    if (const auto value = queue.pop()) {
+      const auto [p, i] = *value;
+      ASSERT_EQ(next[p], i);
+      ++next[p];
+      ++popped;
+    }
+  }
+
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+}  // namespace android::test
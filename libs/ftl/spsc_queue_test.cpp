@@ -0,0 +1,92 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ftl/spsc_queue.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace android::test {
+
+using ftl::SpscQueue;
+
+// Keep in sync with example usage in header file.
+TEST(SpscQueue, Example) {
+  ftl::SpscQueue<int, 2> queue;
+
+  std::thread producer([&queue] {
+    EXPECT_TRUE(queue.try_push(1));
+    EXPECT_TRUE(queue.try_emplace(2));
+    EXPECT_FALSE(queue.try_push(3));
+  });
+  producer.join();
+
+  EXPECT_EQ(queue.pop(), 1);
+  EXPECT_EQ(queue.pop(), 2);
+  EXPECT_FALSE(queue.pop());
+}
+
+TEST(SpscQueue, WrapAround) {
+  SpscQueue<std::string, 4> queue;
+  EXPECT_EQ(queue.capacity(), 4u);
+
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(queue.try_emplace(3u, static_cast<char>('a' + i)));
+    EXPECT_TRUE(queue.try_push(std::to_string(i)));
+    EXPECT_EQ(queue.size(), 2u);
+
+    EXPECT_EQ(queue.pop(), std::string(3u, static_cast<char>('a' + i)));
+    EXPECT_EQ(queue.pop(), std::to_string(i));
+    EXPECT_TRUE(queue.empty());
+  }
+}
+
+TEST(SpscQueue, DestroysRemainingElements) {
+  const auto value = std::make_shared<int>(0);
+  {
+    SpscQueue<std::shared_ptr<int>, 4> queue;
+    EXPECT_TRUE(queue.try_push(value));
+    EXPECT_TRUE(queue.try_push(value));
+    EXPECT_EQ(value.use_count(), 3);
+  }
+  EXPECT_EQ(value.use_count(), 1);
+}
+
+TEST(SpscQueue, Concurrent) {
+  constexpr int kValues = 10000;
+
+  SpscQueue<std::unique_ptr<int>, 16> queue;
+
+  std::thread producer([&queue] {
+    for (int i = 0; i < kValues;) {
+      if (queue.try_emplace(std::make_unique<int>(i))) ++i;
+    }
+  });
+
+  for (int i = 0; i < kValues;) {
+    if (const auto value = queue.pop()) {
+      ASSERT_EQ(**value, i);
+      ++i;
+    }
+  }
+
+  producer.join();
+  EXPECT_TRUE(queue.empty());
+}
+
+}  // namespace android::test
@@ -491,6 +491,35 @@ void GraphicsEnv::sendGpuStatsLocked(GpuStatsInfo::Api api, bool isDriverLoaded,
     }
 }
 
+void GraphicsEnv::setPipelineCachePath(const std::string& path) {
+    mPipelineCachePath = path;
+}
+
+const std::string& GraphicsEnv::getPipelineCachePath() {
+    return mPipelineCachePath;
+}
+
+void GraphicsEnv::setSharedShaderCacheEntry(const std::vector<uint8_t>& key,
+                                            const std::vector<uint8_t>& value) {
+    ATRACE_CALL();
+
+    const sp<IGpuService> gpuService = getGpuService();
+    if (gpuService) {
+        gpuService->setSharedShaderCacheEntry(key, value);
+    }
+}
+
+std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>>
+GraphicsEnv::getSharedShaderCacheEntries(const std::vector<uint8_t>& after) {
+    ATRACE_CALL();
+
+    const sp<IGpuService> gpuService = getGpuService();
+    if (!gpuService) {
+        return {};
+    }
+    return gpuService->getSharedShaderCacheEntries(after);
+}
+
 bool GraphicsEnv::setInjectLayersPrSetDumpable() {
     if (prctl(PR_SET_DUMPABLE, 1, 0, 0, 0) == -1) {
         return false;
@@ -98,6 +98,53 @@ public:
         }
         return driverPath;
     }
+
+    void setSharedShaderCacheEntry(const std::vector<uint8_t>& key,
+                                   const std::vector<uint8_t>& value) override {
+        Parcel data, reply;
+        data.writeInterfaceToken(IGpuService::getInterfaceDescriptor());
+        data.writeByteVector(key);
+        data.writeByteVector(value);
+
+        remote()->transact(BnGpuService::SET_SHARED_SHADER_CACHE_ENTRY, data, &reply,
+                           IBinder::FLAG_ONEWAY);
+    }
+
+    std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>> getSharedShaderCacheEntries(
+            const std::vector<uint8_t>& after) override {
+        Parcel data, reply;
+        data.writeInterfaceToken(IGpuService::getInterfaceDescriptor());
+        data.writeByteVector(after);
+
+        std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>> entries;
+        status_t error =
+                remote()->transact(BnGpuService::GET_SHARED_SHADER_CACHE_ENTRIES, data, &reply);
+        int32_t count = 0;
+        if (error != OK || reply.readInt32(&count) != OK || count < 0) {
+            return entries;
+        }
+        for (int32_t i = 0; i < count; i++) {
+            std::vector<uint8_t> key, value;
+            if (reply.readByteVector(&key) != OK || reply.readByteVector(&value) != OK) {
+                return {};
+            }
+            entries.emplace_back(std::move(key), std::move(value));
+        }
+        return entries;
+    }
+
+    uint64_t getProcessGpuMemTotal(int32_t pid) override {
+        Parcel data, reply;
+        data.writeInterfaceToken(IGpuService::getInterfaceDescriptor());
+        data.writeInt32(pid);
+
+        status_t error = remote()->transact(BnGpuService::GET_PROCESS_GPU_MEM_TOTAL, data, &reply);
+        uint64_t total = 0;
+        if (error == OK) {
+            error = reply.readUint64(&total);
+        }
+        return total;
+    }
 };
 
 IMPLEMENT_META_INTERFACE(GpuService, "android.graphicsenv.IGpuService");
@@ -207,6 +254,42 @@ status_t BnGpuService::onTransact(uint32_t code, const Parcel& data, Parcel* rep
             toggleAngleAsSystemDriver(enableAngleAsSystemDriver);
             return OK;
         }
+        case SET_SHARED_SHADER_CACHE_ENTRY: {
+            CHECK_INTERFACE(IGpuService, data, reply);
+
+            std::vector<uint8_t> key;
+            if ((status = data.readByteVector(&key)) != OK) return status;
+
+            std::vector<uint8_t> value;
+            if ((status = data.readByteVector(&value)) != OK) return status;
+
+            setSharedShaderCacheEntry(key, value);
+            return OK;
+        }
+        case GET_SHARED_SHADER_CACHE_ENTRIES: {
+            CHECK_INTERFACE(IGpuService, data, reply);
+
+            std::vector<uint8_t> after;
+            if ((status = data.readByteVector(&after)) != OK) return status;
+
+            const auto entries = getSharedShaderCacheEntries(after);
+            if ((status = reply->writeInt32(static_cast<int32_t>(entries.size()))) != OK) {
+                return status;
+            }
+            for (const auto& [key, value] : entries) {
+                if ((status = reply->writeByteVector(key)) != OK) return status;
+                if ((status = reply->writeByteVector(value)) != OK) return status;
+            }
+            return OK;
+        }
+        case GET_PROCESS_GPU_MEM_TOTAL: {
+            CHECK_INTERFACE(IGpuService, data, reply);
+
+            int32_t pid;
+            if ((status = data.readInt32(&pid)) != OK) return status;
+
+            return reply->writeUint64(getProcessGpuMemTotal(pid));
+        }
         default:
             return BBinder::onTransact(code, data, reply, flags);
     }
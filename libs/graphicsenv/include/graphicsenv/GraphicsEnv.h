@@ -21,6 +21,7 @@
 
 #include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 struct android_namespace_t;
@@ -90,6 +91,26 @@ public:
     void setVulkanDeviceExtensions(uint32_t enabledExtensionCount,
                                    const char* const* ppEnabledExtensionNames);
 
+    /*
+     * Apis for the Vulkan implicit pipeline cache
+     */
+    // Set the base path under which libvulkan persists the pipeline caches of this app.
+    void setPipelineCachePath(const std::string& path);
+    // Get the pipeline cache path, empty if the implicit pipeline cache is disabled.
+    const std::string& getPipelineCachePath();
+
+    /*
+     * Apis for the shared shader cache
+     */
+    // Submit a blob cache entry produced by the system driver. GpuService drops entries that
+    // don't come from a trusted producer.
+    void setSharedShaderCacheEntry(const std::vector<uint8_t>& key,
+                                   const std::vector<uint8_t>& value);
+    // Get the shared entries whose key sorts after |after|, returns an empty vector once there
+    // are no more entries.
+    std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>> getSharedShaderCacheEntries(
+            const std::vector<uint8_t>& after);
+
     /*
      * Api for Vk/GL layer injection.  Presently, drivers enable certain
      * profiling features when prctl(PR_GET_DUMPABLE) returns true.
@@ -205,6 +226,9 @@ private:
     std::string mLayerPaths;
     // This App's namespace to open native libraries.
     NativeLoaderNamespace* mAppNamespace = nullptr;
+
+    // Base path for the Vulkan implicit pipeline cache.
+    std::string mPipelineCachePath;
 };
 
 } // namespace android
@@ -20,6 +20,7 @@
 #include <cutils/compiler.h>
 #include <graphicsenv/GpuStatsInfo.h>
 
+#include <utility>
 #include <vector>
 
 namespace android {
@@ -53,6 +54,18 @@ public:
 
     // sets ANGLE as system GLES driver if enabled==true by setting persist.graphics.egl to true.
     virtual void toggleAngleAsSystemDriver(bool enabled) = 0;
+
+    // Adds an entry to the shader cache shared between apps using the system driver. Only
+    // entries from trusted producers are accepted.
+    virtual void setSharedShaderCacheEntry(const std::vector<uint8_t>& key,
+                                           const std::vector<uint8_t>& value) = 0;
+    // Returns the shared entries whose key sorts after |after|, in key order. A reply holds a
+    // bounded number of bytes, so callers page through the cache until it returns no entries.
+    virtual std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>>
+    getSharedShaderCacheEntries(const std::vector<uint8_t>& after) = 0;
+
+    // get the GPU memory in bytes held by a process on all GPUs.
+    virtual uint64_t getProcessGpuMemTotal(int32_t pid) = 0;
 };
 
 class BnGpuService : public BnInterface<IGpuService> {
@@ -63,6 +76,9 @@ public:
         SET_UPDATABLE_DRIVER_PATH,
         GET_UPDATABLE_DRIVER_PATH,
         TOGGLE_ANGLE_AS_SYSTEM_DRIVER,
+        SET_SHARED_SHADER_CACHE_ENTRY,
+        GET_SHARED_SHADER_CACHE_ENTRIES,
+        GET_PROCESS_GPU_MEM_TOTAL,
         // Always append new enum to the end.
     };
 
@@ -42,6 +42,9 @@
 using namespace std::chrono_literals;
 
 namespace {
+// How long the default buffer geometry has to stay unchanged before the free buffers are replaced.
+constexpr auto kPreallocateDebounce = 100ms;
+
 inline const char* boolToString(bool b) {
     return b ? "true" : "false";
 }
@@ -198,6 +201,16 @@ BLASTBufferQueue::BLASTBufferQueue(const std::string& name, const sp<SurfaceCont
 }
 
 BLASTBufferQueue::~BLASTBufferQueue() {
+    std::thread preallocateThread;
+    {
+        std::lock_guard lock(mPreallocateMutex);
+        mStopPreallocating = true;
+        preallocateThread = std::move(mPreallocateThread);
+        mPreallocateCondition.notify_all();
+    }
+    if (preallocateThread.joinable()) {
+        preallocateThread.join();
+    }
     TransactionCompletedListener::getInstance()->removeQueueStallListener(this);
     if (mPendingTransactions.empty()) {
         return;
@@ -219,6 +232,8 @@ void BLASTBufferQueue::update(const sp<SurfaceControl>& surface, uint32_t width,
     LOG_ALWAYS_FATAL_IF(surface == nullptr, "BLASTBufferQueue: mSurfaceControl must not be NULL");
 
     std::lock_guard _lock{mMutex};
+    const ui::Size previousSize = mRequestedSize;
+    const PixelFormat previousFormat = mFormat;
     if (mFormat != format) {
         mFormat = format;
         mBufferItemConsumer->setDefaultBufferFormat(convertBufferFormat(format));
@@ -258,12 +273,96 @@ void BLASTBufferQueue::update(const sp<SurfaceControl>& surface, uint32_t width,
             }
         }
     }
+    if (previousSize != mRequestedSize || previousFormat != mFormat) {
+        preallocateBuffersLocked(previousSize, previousFormat);
+    }
     if (applyTransaction) {
         // All transactions on our apply token are one-way. See comment on mAppliedLastTransaction
         t.setApplyToken(mApplyToken).apply(false, true);
     }
 }
 
+void BLASTBufferQueue::preallocateBuffersLocked(const ui::Size& previousSize,
+                                                PixelFormat previousFormat) {
+    // A producer that sets its own buffer size or format won't dequeue buffers of the new default
+    // geometry, so only do this if the last buffer had the previous one.
+    if (!mLastBufferInfo.hasBuffer ||
+        mLastBufferInfo.width != static_cast<uint32_t>(previousSize.width) ||
+        mLastBufferInfo.height != static_cast<uint32_t>(previousSize.height) ||
+        mLastBufferInfo.format != convertBufferFormat(previousFormat)) {
+        return;
+    }
+
+    std::lock_guard lock(mPreallocateMutex);
+    if (!mPreallocateDeadline) {
+        mPreallocateFromSize = previousSize;
+        mPreallocateFromFormat = previousFormat;
+    }
+    mPreallocateUsage = mLastBufferInfo.usage;
+    mPreallocateDeadline = std::chrono::steady_clock::now() + kPreallocateDebounce;
+    if (!mPreallocateThread.joinable()) {
+        mPreallocateThread = std::thread(&BLASTBufferQueue::preallocateBuffersLoop, this);
+    }
+    mPreallocateCondition.notify_all();
+}
+
+void BLASTBufferQueue::preallocateBuffersLoop() {
+    std::unique_lock lock(mPreallocateMutex);
+    while (!mStopPreallocating) {
+        if (!mPreallocateDeadline) {
+            mPreallocateCondition.wait(lock);
+            continue;
+        }
+        // Each update moves the deadline, so keep waiting until the geometry settles.
+        const auto deadline = *mPreallocateDeadline;
+        if (mPreallocateCondition.wait_until(lock, deadline) != std::cv_status::timeout ||
+            mStopPreallocating || mPreallocateDeadline != deadline) {
+            continue;
+        }
+
+        mPreallocateDeadline.reset();
+        mPreallocating = true;
+        const ui::Size fromSize = mPreallocateFromSize;
+        const PixelFormat fromFormat = mPreallocateFromFormat;
+        const uint64_t usage = mPreallocateUsage;
+        lock.unlock();
+        preallocateBuffers(fromSize, fromFormat, usage);
+        lock.lock();
+        mPreallocating = false;
+        mPreallocateCondition.notify_all();
+    }
+}
+
+void BLASTBufferQueue::preallocateBuffers(const ui::Size& fromSize, PixelFormat fromFormat,
+                                          uint64_t usage) {
+    {
+        std::lock_guard _lock{mMutex};
+        // Skip if the producer has queued a buffer of another geometry in the meantime, or if the
+        // default geometry was changed back.
+        if (!mLastBufferInfo.hasBuffer ||
+            mLastBufferInfo.width != static_cast<uint32_t>(fromSize.width) ||
+            mLastBufferInfo.height != static_cast<uint32_t>(fromSize.height) ||
+            mLastBufferInfo.format != convertBufferFormat(fromFormat) ||
+            (mRequestedSize == fromSize && mFormat == fromFormat)) {
+            return;
+        }
+
+        // The free buffers have the previous geometry, dequeueBuffer would reallocate them one at
+        // a time while the producer waits. Drop them, and fill the emptied slots with buffers of
+        // the new default size and format so they're ready by the time the producer dequeues.
+        ATRACE_CALL();
+        BQA_LOGV("preallocateBuffers %dx%d format=%d", mRequestedSize.width,
+                 mRequestedSize.height, mFormat);
+        mBufferItemConsumer->discardFreeBuffers();
+    }
+    // Called without mMutex, the allocation can take a while and the producer's buffers are
+    // released through callbacks that need it.
+    mProducer->allocateBuffers(0 /* width */, 0 /* height */, 0 /* format */, usage);
+
+    std::lock_guard lock(mPreallocateMutex);
+    mNumPreallocations++;
+}
+
 static std::optional<SurfaceControlStats> findMatchingStat(
         const std::vector<SurfaceControlStats>& stats, const sp<SurfaceControl>& sc) {
     for (auto stat : stats) {
@@ -450,8 +549,21 @@ void BLASTBufferQueue::releaseBufferCallbackLocked(
 
     // Release all buffers that are beyond the ones that we need to hold
     while (mPendingRelease.size() > numPendingBuffersToHold) {
-        const auto releasedBuffer = mPendingRelease.front();
-        mPendingRelease.pop_front();
+        auto releasedIt = mPendingRelease.begin();
+        if (mPreferSignaledBuffers) {
+            // Hold on to the buffers that are still waiting on their fence instead.
+            auto signaledIt = std::find_if(mPendingRelease.begin(), mPendingRelease.end(),
+                                           [](const ReleasedBuffer& pending) {
+                                               return pending.releaseFence == nullptr ||
+                                                       pending.releaseFence->getStatus() ==
+                                                       Fence::Status::Signaled;
+                                           });
+            if (signaledIt != mPendingRelease.end()) {
+                releasedIt = signaledIt;
+            }
+        }
+        const auto releasedBuffer = *releasedIt;
+        mPendingRelease.erase(releasedIt);
         releaseBuffer(releasedBuffer.callbackId, releasedBuffer.releaseFence);
         // Don't process the transactions here if mSyncedFrameNumbers is not empty. That means
         // are still transactions that have sync buffers in them that have not been applied or
@@ -584,7 +696,9 @@ status_t BLASTBufferQueue::acquireNextBufferLocked(
     Rect crop = computeCrop(bufferItem);
     mLastBufferInfo.update(true /* hasBuffer */, bufferItem.mGraphicBuffer->getWidth(),
                            bufferItem.mGraphicBuffer->getHeight(), bufferItem.mTransform,
-                           bufferItem.mScalingMode, crop);
+                           bufferItem.mScalingMode, crop,
+                           bufferItem.mGraphicBuffer->getPixelFormat(),
+                           bufferItem.mGraphicBuffer->getUsage());
 
     auto releaseBufferCallback =
             std::bind(releaseBufferCallbackThunk, wp<BLASTBufferQueue>(this) /* callbackContext */,
@@ -1189,6 +1303,13 @@ bool BLASTBufferQueue::isSameSurfaceControl(const sp<SurfaceControl>& surfaceCon
     return SurfaceControl::isSameSurface(mSurfaceControl, surfaceControl);
 }
 
+void BLASTBufferQueue::setPreferSignaledBuffers(bool prefer) {
+    std::lock_guard _lock{mMutex};
+    mPreferSignaledBuffers = prefer;
+    // mConsumer is always the BufferQueueConsumer created in createBufferQueue.
+    static_cast<BufferQueueConsumer*>(mConsumer.get())->setPreferSignaledFreeBuffers(prefer);
+}
+
 void BLASTBufferQueue::setTransactionHangCallback(
         std::function<void(const std::string&)> callback) {
     std::lock_guard _lock{mMutex};
@@ -302,6 +302,7 @@ status_t BufferQueueConsumer::acquireBuffer(BufferItem* outBuffer,
                 static_cast<int32_t>(mCore->mQueue.size()));
 #ifndef NO_BINDER
         mCore->mOccupancyTracker.registerOccupancyChange(mCore->mQueue.size());
+        mCore->shrinkAdaptiveBufferCountLocked();
 #endif
         VALIDATE_CONSISTENCY();
     }
@@ -836,4 +837,33 @@ void BufferQueueConsumer::setAllowExtraAcquire(bool allow) {
     mCore->mAllowExtraAcquire = allow;
 }
 
+void BufferQueueConsumer::setPreferSignaledFreeBuffers(bool prefer) {
+    std::lock_guard<std::mutex> lock(mCore->mMutex);
+    mCore->mPreferSignaledFreeBuffers = prefer;
+}
+
+status_t BufferQueueConsumer::setAdaptiveBufferCount(int minBufferCount) {
+    ATRACE_FORMAT("%s(%d)", __func__, minBufferCount);
+
+    if (minBufferCount < 0 || minBufferCount > BufferQueueDefs::NUM_BUFFER_SLOTS) {
+        BQ_LOGE("setAdaptiveBufferCount: invalid count %d", minBufferCount);
+        return BAD_VALUE;
+    }
+
+    std::lock_guard<std::mutex> lock(mCore->mMutex);
+    if (mCore->mIsAbandoned) {
+        BQ_LOGE("setAdaptiveBufferCount: consumer is abandoned");
+        return NO_INIT;
+    }
+
+    mCore->mAdaptiveMinBufferCount = minBufferCount;
+    if (minBufferCount == 0) {
+        // Give back all of the slots taken out of use
+        while (mCore->growAdaptiveBufferCountLocked()) {
+        }
+        mCore->mDequeueCondition.notify_all();
+    }
+    return NO_ERROR;
+}
+
 } // namespace android
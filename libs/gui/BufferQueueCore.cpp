@@ -364,6 +364,36 @@ bool BufferQueueCore::adjustAvailableSlotsLocked(int delta) {
     return true;
 }
 
+void BufferQueueCore::shrinkAdaptiveBufferCountLocked() {
+    OccupancyTracker::Segment segment;
+    if (!mOccupancyTracker.takeNewSegment(&segment) || mAdaptiveMinBufferCount == 0) {
+        return;
+    }
+
+    // A segment ends once the queue has been idle for a while, so this is
+    // where static content is detected. If the frames before it never needed
+    // a third buffer, the third buffer is only wasting memory.
+    if (segment.usedThirdBuffer ||
+            getMaxBufferCountLocked() - mAdaptiveSlotReduction <= mAdaptiveMinBufferCount) {
+        return;
+    }
+    if (adjustAvailableSlotsLocked(-1)) {
+        mAdaptiveSlotReduction++;
+        BQ_LOGV("shrinkAdaptiveBufferCountLocked: %d slots out of use",
+                mAdaptiveSlotReduction);
+    }
+}
+
+bool BufferQueueCore::growAdaptiveBufferCountLocked() {
+    if (mAdaptiveSlotReduction == 0 || !adjustAvailableSlotsLocked(1)) {
+        return false;
+    }
+    mAdaptiveSlotReduction--;
+    BQ_LOGV("growAdaptiveBufferCountLocked: %d slots out of use",
+            mAdaptiveSlotReduction);
+    return true;
+}
+
 void BufferQueueCore::waitWhileAllocatingLocked(std::unique_lock<std::mutex>& lock) const {
     ATRACE_CALL();
     while (mIsAllocating) {
@@ -487,13 +517,16 @@ void BufferQueueCore::validateConsistencyLocked() const {
         }
     }
 
-    if (allocatedSlots != getMaxBufferCountLocked()) {
+    // Slots taken out of use by adaptive buffer counting are in
+    // mUnusedSlots, even though getMaxBufferCountLocked still counts them.
+    int expectedSlots = getMaxBufferCountLocked() - mAdaptiveSlotReduction;
+    if (allocatedSlots != expectedSlots) {
         BQ_LOGE("Number of allocated slots is incorrect. Allocated = %d, "
                 "Should be %d (%zu free slots, %zu free buffers, "
-                "%zu activeBuffers, %zu unusedSlots)", allocatedSlots,
-                getMaxBufferCountLocked(), mFreeSlots.size(),
+                "%zu activeBuffers, %zu unusedSlots, %d adaptively unused)",
+                allocatedSlots, expectedSlots, mFreeSlots.size(),
                 mFreeBuffers.size(), mActiveBuffers.size(),
-                mUnusedSlots.size());
+                mUnusedSlots.size(), mAdaptiveSlotReduction);
     }
 }
 #endif
@@ -21,6 +21,8 @@
 #include <gui/TraceUtils.h>
 #include <jni.h>
 
+#include <optional>
+
 #undef LOG_TAG
 #define LOG_TAG "AChoreographer"
 
@@ -297,16 +299,21 @@ void Choreographer::dispatchVsync(nsecs_t timestamp, PhysicalDisplayId, uint32_t
         }
     }
     mLastVsyncEventData = vsyncEventData;
+
+    // All vsync callbacks of this frame share the same frame data, which is created and registered
+    // once, when the first of them runs.
+    std::optional<ChoreographerFrameCallbackDataImpl> frameCallbackData;
     for (const auto& cb : callbacks) {
         if (cb.vsyncCallback != nullptr) {
             ATRACE_FORMAT("AChoreographer_vsyncCallback %" PRId64,
                           vsyncEventData.preferredVsyncId());
-            const ChoreographerFrameCallbackDataImpl frameCallbackData =
-                    createFrameCallbackData(timestamp);
-            registerStartTime();
+            if (!frameCallbackData) {
+                frameCallbackData = createFrameCallbackData(timestamp);
+                registerStartTime();
+            }
             mInCallback = true;
             cb.vsyncCallback(reinterpret_cast<const AChoreographerFrameCallbackData*>(
-                                     &frameCallbackData),
+                                     &*frameCallbackData),
                              cb.data);
             mInCallback = false;
         } else if (cb.callback64 != nullptr) {
@@ -368,11 +375,12 @@ ChoreographerFrameCallbackDataImpl Choreographer::createFrameCallbackData(nsecs_
 
 void Choreographer::registerStartTime() const {
     std::scoped_lock _l(gChoreographers.lock);
-    for (VsyncEventData::FrameTimeline frameTimeline : mLastVsyncEventData.frameTimelines) {
+    const nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+    for (const VsyncEventData::FrameTimeline& frameTimeline : mLastVsyncEventData.frameTimelines) {
         while (gChoreographers.startTimes.size() >= kMaxStartTimes) {
             gChoreographers.startTimes.erase(gChoreographers.startTimes.begin());
         }
-        gChoreographers.startTimes[frameTimeline.vsyncId] = systemTime(SYSTEM_TIME_MONOTONIC);
+        gChoreographers.startTimes[frameTimeline.vsyncId] = now;
     }
 }
 
@@ -35,7 +35,8 @@ CpuConsumer::CpuConsumer(const sp<IGraphicBufferConsumer>& bq,
         size_t maxLockedBuffers, bool controlledByApp) :
     ConsumerBase(bq, controlledByApp),
     mMaxLockedBuffers(maxLockedBuffers),
-    mCurrentLockedBuffers(0)
+    mCurrentLockedBuffers(0),
+    mPersistentMapping(false)
 {
     // Create tracking entries for locked buffers
     mAcquiredBuffers.insertAt(0, maxLockedBuffers);
@@ -88,7 +89,32 @@ static bool isPossiblyYUV(PixelFormat format) {
     }
 }
 
-status_t CpuConsumer::lockBufferItem(const BufferItem& item, LockedBuffer* outBuffer) const {
+bool CpuConsumer::isAcquiredLocked(const sp<GraphicBuffer>& buffer) const {
+    for (size_t i = 0; i < mMaxLockedBuffers; i++) {
+        if (mAcquiredBuffers[i].mGraphicBuffer == buffer) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Fills out the fields of the locked buffer that describe the frame rather
+// than where it is mapped.
+static void setFrameInfo(const BufferItem& item, CpuConsumer::LockedBuffer* outBuffer) {
+    outBuffer->width = item.mGraphicBuffer->getWidth();
+    outBuffer->height = item.mGraphicBuffer->getHeight();
+    outBuffer->format = item.mGraphicBuffer->getPixelFormat();
+
+    outBuffer->crop = item.mCrop;
+    outBuffer->transform = item.mTransform;
+    outBuffer->scalingMode = item.mScalingMode;
+    outBuffer->timestamp = item.mTimestamp;
+    outBuffer->dataSpace = item.mDataSpace;
+    outBuffer->frameNumber = item.mFrameNumber;
+}
+
+status_t CpuConsumer::lockBufferItem(const BufferItem& item, const Rect& region,
+        LockedBuffer* outBuffer) const {
     android_ycbcr ycbcr = android_ycbcr();
 
     PixelFormat format = item.mGraphicBuffer->getPixelFormat();
@@ -96,7 +122,7 @@ status_t CpuConsumer::lockBufferItem(const BufferItem& item, LockedBuffer* outBu
     if (isPossiblyYUV(format)) {
         int fenceFd = item.mFence.get() ? item.mFence->dup() : -1;
         status_t err = item.mGraphicBuffer->lockAsyncYCbCr(GraphicBuffer::USAGE_SW_READ_OFTEN,
-                                                           item.mCrop, &ycbcr, fenceFd);
+                                                           region, &ycbcr, fenceFd);
         if (err == OK) {
             flexFormat = HAL_PIXEL_FORMAT_YCbCr_420_888;
             if (format != HAL_PIXEL_FORMAT_YCbCr_420_888) {
@@ -120,7 +146,7 @@ status_t CpuConsumer::lockBufferItem(const BufferItem& item, LockedBuffer* outBu
         void* bufferPointer = nullptr;
         int fenceFd = item.mFence.get() ? item.mFence->dup() : -1;
         status_t err = item.mGraphicBuffer->lockAsync(GraphicBuffer::USAGE_SW_READ_OFTEN,
-                                                      item.mCrop, &bufferPointer, fenceFd);
+                                                      region, &bufferPointer, fenceFd);
         if (err != OK) {
             CC_LOGE("Unable to lock buffer for CPU reading: %s (%d)", strerror(-err), err);
             return err;
@@ -134,18 +160,41 @@ status_t CpuConsumer::lockBufferItem(const BufferItem& item, LockedBuffer* outBu
         outBuffer->chromaStep = 0;
     }
 
-    outBuffer->width = item.mGraphicBuffer->getWidth();
-    outBuffer->height = item.mGraphicBuffer->getHeight();
-    outBuffer->format = format;
     outBuffer->flexFormat = flexFormat;
+    setFrameInfo(item, outBuffer);
 
-    outBuffer->crop = item.mCrop;
-    outBuffer->transform = item.mTransform;
-    outBuffer->scalingMode = item.mScalingMode;
-    outBuffer->timestamp = item.mTimestamp;
-    outBuffer->dataSpace = item.mDataSpace;
-    outBuffer->frameNumber = item.mFrameNumber;
+    return OK;
+}
+
+status_t CpuConsumer::lockMappedBufferItemLocked(const BufferItem& item, LockedBuffer* outBuffer) {
+    MappedBuffer& mapped = mMappedBuffers[item.mSlot];
+    if (mapped.mGraphicBuffer == item.mGraphicBuffer) {
+        // Locking would have waited for the producer to be done with the
+        // buffer, so wait here instead.
+        if (item.mFence.get()) {
+            status_t err = item.mFence->waitForever("CpuConsumer::lockNextBuffer");
+            if (err != OK) {
+                CC_LOGE("Failed to wait for acquire fence: %s (%d)", strerror(-err), err);
+                return err;
+            }
+        }
+        *outBuffer = mapped.mMapping;
+        setFrameInfo(item, outBuffer);
+    } else {
+        unmapBufferLocked(item.mSlot);
+        // Map the whole buffer, since later frames may have a different crop.
+        Rect bounds(item.mGraphicBuffer->getWidth(), item.mGraphicBuffer->getHeight());
+        status_t err = lockBufferItem(item, bounds, outBuffer);
+        if (err != OK) {
+            return err;
+        }
+        mapped.mGraphicBuffer = item.mGraphicBuffer;
+        mapped.mMapping = *outBuffer;
+    }
 
+    if (mSyncForCpu) {
+        mSyncForCpu(*outBuffer);
+    }
     return OK;
 }
 
@@ -177,7 +226,11 @@ status_t CpuConsumer::lockNextBuffer(LockedBuffer *nativeBuffer) {
         b.mGraphicBuffer = mSlots[b.mSlot].mGraphicBuffer;
     }
 
-    err = lockBufferItem(b, nativeBuffer);
+    if (mPersistentMapping) {
+        err = lockMappedBufferItemLocked(b, nativeBuffer);
+    } else {
+        err = lockBufferItem(b, b.mCrop, nativeBuffer);
+    }
     if (err != OK) {
         return err;
     }
@@ -210,11 +263,15 @@ status_t CpuConsumer::unlockBuffer(const LockedBuffer &nativeBuffer) {
     AcquiredBuffer& ab = mAcquiredBuffers.editItemAt(lockedIdx);
 
     int fenceFd = -1;
-    status_t err = ab.mGraphicBuffer->unlockAsync(&fenceFd);
-    if (err != OK) {
-        CC_LOGE("%s: Unable to unlock graphic buffer %zd", __FUNCTION__,
-                lockedIdx);
-        return err;
+    // A persistently mapped buffer stays locked, unless its mapping was
+    // dropped while the user had it.
+    if (mMappedBuffers[ab.mSlot].mGraphicBuffer != ab.mGraphicBuffer) {
+        status_t err = ab.mGraphicBuffer->unlockAsync(&fenceFd);
+        if (err != OK) {
+            CC_LOGE("%s: Unable to unlock graphic buffer %zd", __FUNCTION__,
+                    lockedIdx);
+            return err;
+        }
     }
 
     sp<Fence> fence(fenceFd >= 0 ? new Fence(fenceFd) : Fence::NO_FENCE);
@@ -228,4 +285,35 @@ status_t CpuConsumer::unlockBuffer(const LockedBuffer &nativeBuffer) {
     return OK;
 }
 
+void CpuConsumer::setPersistentMapping(bool enabled,
+        std::function<void(const LockedBuffer&)> syncForCpu) {
+    Mutex::Autolock _l(mMutex);
+    mPersistentMapping = enabled;
+    mSyncForCpu = std::move(syncForCpu);
+    if (!enabled) {
+        for (int i = 0; i < BufferQueue::NUM_BUFFER_SLOTS; i++) {
+            unmapBufferLocked(i);
+        }
+    }
+}
+
+void CpuConsumer::unmapBufferLocked(int slot) {
+    MappedBuffer& mapped = mMappedBuffers[slot];
+    if (mapped.mGraphicBuffer == nullptr) {
+        return;
+    }
+    if (!isAcquiredLocked(mapped.mGraphicBuffer)) {
+        status_t err = mapped.mGraphicBuffer->unlock();
+        if (err != OK) {
+            CC_LOGE("%s: Unable to unlock graphic buffer in slot %d", __FUNCTION__, slot);
+        }
+    }
+    mapped.mGraphicBuffer.clear();
+}
+
+void CpuConsumer::freeBufferLocked(int slotIndex) {
+    unmapBufferLocked(slotIndex);
+    ConsumerBase::freeBufferLocked(slotIndex);
+}
+
 } // namespace android
@@ -21,6 +21,7 @@
 #include <utils/Errors.h>
 
 #include <gui/DisplayEventReceiver.h>
+#include <gui/SharedVsyncEventData.h>
 #include <gui/VsyncEventData.h>
 
 #include <private/gui/ComposerServiceAIDL.h>
@@ -107,6 +108,28 @@ status_t DisplayEventReceiver::getLatestVsyncEventData(
     return NO_INIT;
 }
 
+status_t DisplayEventReceiver::getSharedVsyncEventData(VsyncEventData* outVsyncEventData) {
+    if (mEventConnection == nullptr) {
+        return NO_INIT;
+    }
+
+    if (mSharedVsyncEventData == nullptr) {
+        os::ParcelFileDescriptor fd;
+        auto status = mEventConnection->getSharedVsyncEventData(&fd);
+        if (!status.isOk()) {
+            ALOGE("Failed to get shared vsync event data: %s", status.exceptionMessage().c_str());
+            return status.transactionError();
+        }
+
+        mSharedVsyncEventData = gui::SharedVsyncEventData::map(fd.release());
+        if (mSharedVsyncEventData == nullptr) {
+            return NO_MEMORY;
+        }
+    }
+
+    return mSharedVsyncEventData->read(outVsyncEventData) ? NO_ERROR : NOT_ENOUGH_DATA;
+}
+
 ssize_t DisplayEventReceiver::getEvents(DisplayEventReceiver::Event* events,
         size_t count) {
     return DisplayEventReceiver::getEvents(mDataChannel.get(), events, count);
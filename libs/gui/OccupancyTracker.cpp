@@ -89,9 +89,19 @@ std::vector<OccupancyTracker::Segment> OccupancyTracker::getSegmentHistory(
     std::vector<Segment> segments(mSegmentHistory.cbegin(),
             mSegmentHistory.cend());
     mSegmentHistory.clear();
+    mHasNewSegment = false;
     return segments;
 }
 
+bool OccupancyTracker::takeNewSegment(Segment* outSegment) {
+    if (!mHasNewSegment) {
+        return false;
+    }
+    *outSegment = mSegmentHistory.front();
+    mHasNewSegment = false;
+    return true;
+}
+
 void OccupancyTracker::recordPendingSegment() {
     // Only record longer segments to get a better measurement of actual double-
     // vs. triple-buffered time
@@ -110,6 +120,7 @@ void OccupancyTracker::recordPendingSegment() {
         if (mSegmentHistory.size() > MAX_HISTORY_SIZE) {
             mSegmentHistory.pop_back();
         }
+        mHasNewSegment = true;
     }
     mPendingSegment.clear();
 }
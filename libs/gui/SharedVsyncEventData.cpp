@@ -0,0 +1,126 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "SharedVsyncEventData"
+
+#include <gui/SharedVsyncEventData.h>
+
+#include <sys/mman.h>
+
+#include <cstring>
+
+#include <cutils/ashmem.h>
+#include <utils/Log.h>
+
+namespace android::gui {
+
+std::unique_ptr<SharedVsyncEventData> SharedVsyncEventData::create() {
+    base::unique_fd fd(ashmem_create_region("SharedVsyncEventData", sizeof(Region)));
+    if (!fd.ok()) {
+        ALOGE("%s: Failed to allocate shared memory: %s", __func__, strerror(errno));
+        return nullptr;
+    }
+
+    void* address = mmap(nullptr, sizeof(Region), PROT_READ | PROT_WRITE, MAP_SHARED, fd.get(), 0);
+    if (address == MAP_FAILED) {
+        ALOGE("%s: Failed to map shared memory: %s", __func__, strerror(errno));
+        return nullptr;
+    }
+
+    // Only allow the client to map the region read-only.
+    if (ashmem_set_prot_region(fd.get(), PROT_READ) != 0) {
+        ALOGE("%s: Failed to restrict shared memory: %s", __func__, strerror(errno));
+        munmap(address, sizeof(Region));
+        return nullptr;
+    }
+
+    // Anonymous shared memory is zero initialized, so the sequence starts at 0.
+    return std::unique_ptr<SharedVsyncEventData>(
+            new SharedVsyncEventData(std::move(fd), static_cast<Region*>(address)));
+}
+
+std::unique_ptr<SharedVsyncEventData> SharedVsyncEventData::map(base::unique_fd fd) {
+    if (!fd.ok() || !ashmem_valid(fd.get())) {
+        ALOGE("%s: Invalid shared memory", __func__);
+        return nullptr;
+    }
+
+    const int size = ashmem_get_size_region(fd.get());
+    if (size < 0 || static_cast<size_t>(size) < sizeof(Region)) {
+        ALOGE("%s: Unexpected shared memory size %d", __func__, size);
+        return nullptr;
+    }
+
+    void* address = mmap(nullptr, sizeof(Region), PROT_READ, MAP_SHARED, fd.get(), 0);
+    if (address == MAP_FAILED) {
+        ALOGE("%s: Failed to map shared memory: %s", __func__, strerror(errno));
+        return nullptr;
+    }
+
+    return std::unique_ptr<SharedVsyncEventData>(
+            new SharedVsyncEventData(std::move(fd), static_cast<Region*>(address)));
+}
+
+SharedVsyncEventData::SharedVsyncEventData(base::unique_fd fd, Region* region)
+      : mFd(std::move(fd)), mRegion(region) {}
+
+SharedVsyncEventData::~SharedVsyncEventData() {
+    munmap(mRegion, sizeof(Region));
+}
+
+void SharedVsyncEventData::publish(const VsyncEventData& vsyncEventData) {
+    std::array<uint64_t, kWordCount> words;
+    std::memcpy(words.data(), &vsyncEventData, sizeof(VsyncEventData));
+
+    const uint64_t sequence = mRegion->sequence.load(std::memory_order_relaxed);
+    mRegion->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < kWordCount; i++) {
+        mRegion->words[i].store(words[i], std::memory_order_relaxed);
+    }
+
+    mRegion->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool SharedVsyncEventData::read(VsyncEventData* outVsyncEventData) const {
+    std::array<uint64_t, kWordCount> words;
+
+    for (int attempt = 0; attempt < kMaxReadAttempts; attempt++) {
+        const uint64_t sequence = mRegion->sequence.load(std::memory_order_acquire);
+        if (sequence == 0) {
+            return false;
+        }
+        if (sequence % 2 != 0) {
+            continue;
+        }
+
+        for (size_t i = 0; i < kWordCount; i++) {
+            words[i] = mRegion->words[i].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (mRegion->sequence.load(std::memory_order_relaxed) == sequence) {
+            std::memcpy(outVsyncEventData, words.data(), sizeof(VsyncEventData));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace android::gui
@@ -33,6 +33,8 @@
 
 #include <system/window.h>
 
+#include <algorithm>
+
 namespace android {
 
 status_t StreamSplitter::createSplitter(
@@ -57,14 +59,23 @@ status_t StreamSplitter::createSplitter(
 }
 
 StreamSplitter::StreamSplitter(const sp<IGraphicBufferConsumer>& inputQueue)
-      : mIsAbandoned(false), mMutex(), mReleaseCondition(),
-        mOutstandingBuffers(0), mInput(inputQueue), mOutputs(), mBuffers() {}
+      : mIsAbandoned(false), mMutex(), mReleaseCondition(), mInput(inputQueue),
+        mOutputs(), mBuffers() {}
 
 StreamSplitter::~StreamSplitter() {
+    {
+        Mutex::Autolock lock(mMutex);
+        for (Output& output : mOutputs) {
+            if (output.heldBuffer != nullptr) {
+                releaseReferenceLocked(output.heldBuffer);
+                output.heldBuffer = nullptr;
+            }
+        }
+    }
+
     mInput->consumerDisconnect();
-    Vector<sp<IGraphicBufferProducer> >::iterator output = mOutputs.begin();
-    for (; output != mOutputs.end(); ++output) {
-        (*output)->disconnect(NATIVE_WINDOW_API_CPU);
+    for (const Output& output : mOutputs) {
+        output.producer->disconnect(NATIVE_WINDOW_API_CPU);
     }
 
     if (mBuffers.size() > 0) {
@@ -73,11 +84,16 @@ StreamSplitter::~StreamSplitter() {
 }
 
 status_t StreamSplitter::addOutput(
-        const sp<IGraphicBufferProducer>& outputQueue) {
+        const sp<IGraphicBufferProducer>& outputQueue, OutputPolicy policy,
+        int maxOutstandingBuffers) {
     if (outputQueue == nullptr) {
         ALOGE("addOutput: outputQueue must not be NULL");
         return BAD_VALUE;
     }
+    if (maxOutstandingBuffers < 1) {
+        ALOGE("addOutput: maxOutstandingBuffers must be at least 1");
+        return BAD_VALUE;
+    }
 
     Mutex::Autolock lock(mMutex);
 
@@ -91,7 +107,11 @@ status_t StreamSplitter::addOutput(
         return status;
     }
 
-    mOutputs.push_back(outputQueue);
+    Output output;
+    output.producer = outputQueue;
+    output.policy = policy;
+    output.maxOutstandingBuffers = maxOutstandingBuffers;
+    mOutputs.push_back(output);
 
     return NO_ERROR;
 }
@@ -101,18 +121,28 @@ void StreamSplitter::setName(const String8 &name) {
     mInput->setConsumerName(name);
 }
 
+bool StreamSplitter::isBlockedLocked() const {
+    for (const Output& output : mOutputs) {
+        if (output.policy == OutputPolicy::BLOCK &&
+                output.outstandingBuffers >= output.maxOutstandingBuffers) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void StreamSplitter::onFrameAvailable(const BufferItem& /* item */) {
     ATRACE_CALL();
     Mutex::Autolock lock(mMutex);
 
-    // The current policy is that if any one consumer is consuming buffers too
-    // slowly, the splitter will stall the rest of the outputs by not acquiring
-    // any more buffers from the input. This will cause back pressure on the
-    // input queue, slowing down its producer.
+    // If a BLOCK output is consuming buffers too slowly, the splitter will
+    // stall the rest of the outputs by not acquiring any more buffers from the
+    // input. This will cause back pressure on the input queue, slowing down
+    // its producer. Slow DROP and KEEP_LATEST outputs just skip buffers.
 
     // If there are too many outstanding buffers, we block until a buffer is
-    // released back to the input in onBufferReleased
-    while (mOutstandingBuffers >= MAX_OUTSTANDING_BUFFERS) {
+    // released by an output in onBufferReleasedByOutput
+    while (isBlockedLocked()) {
         mReleaseCondition.wait(mMutex);
 
         // If the splitter is abandoned while we are waiting, the release
@@ -123,7 +153,6 @@ void StreamSplitter::onFrameAvailable(const BufferItem& /* item */) {
             return;
         }
     }
-    ++mOutstandingBuffers;
 
     // Acquire and detach the buffer from the input
     BufferItem bufferItem;
@@ -138,9 +167,12 @@ void StreamSplitter::onFrameAvailable(const BufferItem& /* item */) {
     LOG_ALWAYS_FATAL_IF(status != NO_ERROR,
             "detaching buffer from input failed (%d)", status);
 
-    // Initialize our reference count for this buffer
-    mBuffers.add(bufferItem.mGraphicBuffer->getId(),
-            new BufferTracker(bufferItem.mGraphicBuffer));
+    // Initialize our reference count for this buffer. The reference held by
+    // this call keeps the buffer from being released to the input while it is
+    // being queued to the outputs.
+    sp<BufferTracker> tracker = new BufferTracker(bufferItem.mGraphicBuffer);
+    tracker->incrementReferenceCountLocked();
+    mBuffers.add(bufferItem.mGraphicBuffer->getId(), tracker);
 
     IGraphicBufferProducer::QueueBufferInput queueInput(
             bufferItem.mTimestamp, bufferItem.mIsAutoTimestamp,
@@ -148,79 +180,79 @@ void StreamSplitter::onFrameAvailable(const BufferItem& /* item */) {
             static_cast<int32_t>(bufferItem.mScalingMode),
             bufferItem.mTransform, bufferItem.mFence);
 
-    // Attach and queue the buffer to each of the outputs
-    Vector<sp<IGraphicBufferProducer> >::iterator output = mOutputs.begin();
-    for (; output != mOutputs.end(); ++output) {
-        int slot;
-        status = (*output)->attachBuffer(&slot, bufferItem.mGraphicBuffer);
-        if (status == NO_INIT) {
-            // If we just discovered that this output has been abandoned, note
-            // that, increment the release count so that we still release this
-            // buffer eventually, and move on to the next output
-            onAbandonedLocked();
-            mBuffers.editValueFor(bufferItem.mGraphicBuffer->getId())->
-                    incrementReleaseCountLocked();
-            continue;
-        } else {
-            LOG_ALWAYS_FATAL_IF(status != NO_ERROR,
-                    "attaching buffer to output failed (%d)", status);
-        }
-
-        IGraphicBufferProducer::QueueBufferOutput queueOutput;
-        status = (*output)->queueBuffer(slot, queueInput, &queueOutput);
-        if (status == NO_INIT) {
-            // If we just discovered that this output has been abandoned, note
-            // that, increment the release count so that we still release this
-            // buffer eventually, and move on to the next output
-            onAbandonedLocked();
-            mBuffers.editValueFor(bufferItem.mGraphicBuffer->getId())->
-                    incrementReleaseCountLocked();
-            continue;
+    // Attach and queue the buffer to each of the outputs that has room for it
+    for (Output& output : mOutputs) {
+        if (output.outstandingBuffers < output.maxOutstandingBuffers) {
+            queueToOutputLocked(output, tracker, queueInput);
+        } else if (output.policy == OutputPolicy::KEEP_LATEST) {
+            if (output.heldBuffer != nullptr) {
+                ALOGV("dropped held buffer %#" PRIx64 " for output %p",
+                        output.heldBuffer->getBuffer()->getId(), output.producer.get());
+                releaseReferenceLocked(output.heldBuffer);
+            }
+            tracker->incrementReferenceCountLocked();
+            output.heldBuffer = tracker;
+            output.heldQueueInput = queueInput;
         } else {
-            LOG_ALWAYS_FATAL_IF(status != NO_ERROR,
-                    "queueing buffer to output failed (%d)", status);
+            ALOGV("dropped buffer %#" PRIx64 " for output %p",
+                    bufferItem.mGraphicBuffer->getId(), output.producer.get());
         }
-
-        ALOGV("queued buffer %#" PRIx64 " to output %p",
-                bufferItem.mGraphicBuffer->getId(), output->get());
     }
+
+    releaseReferenceLocked(tracker);
 }
 
-void StreamSplitter::onBufferReleasedByOutput(
-        const sp<IGraphicBufferProducer>& from) {
-    ATRACE_CALL();
-    Mutex::Autolock lock(mMutex);
+void StreamSplitter::queueToOutputLocked(Output& output,
+        const sp<BufferTracker>& tracker,
+        const IGraphicBufferProducer::QueueBufferInput& queueInput) {
+    const sp<GraphicBuffer>& buffer = tracker->getBuffer();
 
-    sp<GraphicBuffer> buffer;
-    sp<Fence> fence;
-    status_t status = from->detachNextBuffer(&buffer, &fence);
+    int slot;
+    status_t status = output.producer->attachBuffer(&slot, buffer);
     if (status == NO_INIT) {
-        // If we just discovered that this output has been abandoned, note that,
-        // but we can't do anything else, since buffer is invalid
+        // If we just discovered that this output has been abandoned, note
+        // that, and don't count it as holding the buffer so that we still
+        // release this buffer eventually
         onAbandonedLocked();
         return;
     } else {
         LOG_ALWAYS_FATAL_IF(status != NO_ERROR,
-                "detaching buffer from output failed (%d)", status);
+                "attaching buffer to output failed (%d)", status);
     }
 
-    ALOGV("detached buffer %#" PRIx64 " from output %p",
-          buffer->getId(), from.get());
+    IGraphicBufferProducer::QueueBufferOutput queueOutput;
+    status = output.producer->queueBuffer(slot, queueInput, &queueOutput);
+    if (status == NO_INIT) {
+        // If we just discovered that this output has been abandoned, note
+        // that, and don't count it as holding the buffer so that we still
+        // release this buffer eventually
+        onAbandonedLocked();
+        return;
+    } else {
+        LOG_ALWAYS_FATAL_IF(status != NO_ERROR,
+                "queueing buffer to output failed (%d)", status);
+    }
 
-    const sp<BufferTracker>& tracker = mBuffers.editValueFor(buffer->getId());
+    tracker->incrementReferenceCountLocked();
+    ++output.outstandingBuffers;
 
-    // Merge the release fence of the incoming buffer so that the fence we send
-    // back to the input includes all of the outputs' fences
-    tracker->mergeFence(fence);
+    ALOGV("queued buffer %#" PRIx64 " to output %p", buffer->getId(),
+            output.producer.get());
+}
 
+void StreamSplitter::releaseReferenceLocked(const sp<BufferTracker>& tracker) {
     // Check to see if this is the last outstanding reference to this buffer
-    size_t releaseCount = tracker->incrementReleaseCountLocked();
-    ALOGV("buffer %#" PRIx64 " reference count %zu (of %zu)", buffer->getId(),
-            releaseCount, mOutputs.size());
-    if (releaseCount < mOutputs.size()) {
+    size_t referenceCount = tracker->decrementReferenceCountLocked();
+    const sp<GraphicBuffer>& buffer = tracker->getBuffer();
+    ALOGV("buffer %#" PRIx64 " reference count %zu", buffer->getId(),
+            referenceCount);
+    if (referenceCount > 0) {
         return;
     }
 
+    // Keep the tracker alive while it is removed from mBuffers
+    sp<BufferTracker> releasedTracker = tracker;
+
     // If we've been abandoned, we can't return the buffer to the input, so just
     // stop tracking it and move on
     if (mIsAbandoned) {
@@ -230,7 +262,7 @@ void StreamSplitter::onBufferReleasedByOutput(
 
     // Attach and release the buffer back to the input
     int consumerSlot;
-    status = mInput->attachBuffer(&consumerSlot, tracker->getBuffer());
+    status_t status = mInput->attachBuffer(&consumerSlot, buffer);
     LOG_ALWAYS_FATAL_IF(status != NO_ERROR,
             "attaching buffer to input failed (%d)", status);
 
@@ -244,10 +276,51 @@ void StreamSplitter::onBufferReleasedByOutput(
     // We no longer need to track the buffer once it has been returned to the
     // input
     mBuffers.removeItem(buffer->getId());
+}
+
+void StreamSplitter::onBufferReleasedByOutput(
+        const sp<IGraphicBufferProducer>& from) {
+    ATRACE_CALL();
+    Mutex::Autolock lock(mMutex);
+
+    sp<GraphicBuffer> buffer;
+    sp<Fence> fence;
+    status_t status = from->detachNextBuffer(&buffer, &fence);
+    if (status == NO_INIT) {
+        // If we just discovered that this output has been abandoned, note that,
+        // but we can't do anything else, since buffer is invalid
+        onAbandonedLocked();
+        return;
+    } else {
+        LOG_ALWAYS_FATAL_IF(status != NO_ERROR,
+                "detaching buffer from output failed (%d)", status);
+    }
+
+    ALOGV("detached buffer %#" PRIx64 " from output %p",
+          buffer->getId(), from.get());
+
+    auto output = std::find_if(mOutputs.begin(), mOutputs.end(),
+            [&from](const Output& o) { return o.producer == from; });
+    LOG_ALWAYS_FATAL_IF(output == mOutputs.end(), "buffer released by unknown output");
+    --output->outstandingBuffers;
+
+    sp<BufferTracker> tracker = mBuffers.valueFor(buffer->getId());
+
+    // Merge the release fence of the incoming buffer so that the fence we send
+    // back to the input includes all of the outputs' fences
+    tracker->mergeFence(fence);
+    releaseReferenceLocked(tracker);
+
+    // Queue the newest buffer that a KEEP_LATEST output didn't have room for
+    if (output->heldBuffer != nullptr && !mIsAbandoned) {
+        sp<BufferTracker> heldBuffer = output->heldBuffer;
+        output->heldBuffer = nullptr;
+        queueToOutputLocked(*output, heldBuffer, output->heldQueueInput);
+        releaseReferenceLocked(heldBuffer);
+    }
 
     // Notify any waiting onFrameAvailable calls
-    --mOutstandingBuffers;
-    mReleaseCondition.signal();
+    mReleaseCondition.broadcast();
 }
 
 void StreamSplitter::onAbandonedLocked() {
@@ -276,7 +349,7 @@ void StreamSplitter::OutputListener::binderDied(const wp<IBinder>& /* who */) {
 }
 
 StreamSplitter::BufferTracker::BufferTracker(const sp<GraphicBuffer>& buffer)
-      : mBuffer(buffer), mMergedFence(Fence::NO_FENCE), mReleaseCount(0) {}
+      : mBuffer(buffer), mMergedFence(Fence::NO_FENCE), mReferenceCount(0) {}
 
 StreamSplitter::BufferTracker::~BufferTracker() {}
 
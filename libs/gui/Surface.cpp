@@ -301,6 +301,9 @@ Surface::Surface(const sp<IGraphicBufferProducer>& bufferProducer, bool controll
     mSwapIntervalZero = false;
     mMaxBufferCount = NUM_BUFFER_SLOTS;
     mSurfaceControlHandle = surfaceControlHandle;
+    // Frame timestamp queries only need to be batched when they are IPCs.
+    mBatchFrameTimestampsQueries = bufferProducer != nullptr &&
+            IInterface::asBinder(bufferProducer)->remoteBinder() != nullptr;
 }
 
 Surface::~Surface() {
@@ -469,6 +472,21 @@ static void getFrameTimestampFence(nsecs_t *dst,
     }
 }
 
+bool Surface::shouldQueryFrameTimestampsLocked() const {
+    if (!mBatchFrameTimestampsQueries) {
+        return true;
+    }
+    // The consumer gets new timestamps once per composition, and the signal
+    // times of the fences we already have are read without asking it. So
+    // if the consumer was asked, or a queue brought back its timestamps,
+    // since the last composite deadline, there is nothing new to get yet.
+    const nsecs_t interval = mFrameEventHistory->getCompositeInterval();
+    if (interval <= 0 || mLastFrameTimestampsUpdateTime == 0) {
+        return true;
+    }
+    return now() > mFrameEventHistory->getNextCompositeDeadline(mLastFrameTimestampsUpdateTime);
+}
+
 status_t Surface::getFrameTimestamps(uint64_t frameNumber,
         nsecs_t* outRequestedPresentTime, nsecs_t* outAcquireTime,
         nsecs_t* outLatchTime, nsecs_t* outFirstRefreshStartTime,
@@ -500,10 +518,12 @@ status_t Surface::getFrameTimestamps(uint64_t frameNumber,
     if (checkConsumerForUpdates(events, mLastFrameNumber,
             outLatchTime, outFirstRefreshStartTime, outLastRefreshStartTime,
             outGpuCompositionDoneTime, outDisplayPresentTime,
-            outDequeueReadyTime, outReleaseTime)) {
+            outDequeueReadyTime, outReleaseTime) &&
+        shouldQueryFrameTimestampsLocked()) {
         FrameEventHistoryDelta delta;
         mGraphicBufferProducer->getFrameTimestamps(&delta);
         mFrameEventHistory->applyDelta(delta);
+        mLastFrameTimestampsUpdateTime = now();
         events = mFrameEventHistory->getFrame(frameNumber);
     }
 
@@ -1228,6 +1248,7 @@ void Surface::onBufferQueuedLocked(int slot, sp<Fence> fence,
 
     if (mEnableFrameTimestamps) {
         mFrameEventHistory->applyDelta(output.frameTimestamps);
+        mLastFrameTimestampsUpdateTime = now();
         // Update timestamps with the local acquire fence.
         // The consumer doesn't send it back to prevent us from having two
         // file descriptors of the same fence.
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "TransactionCoalescer"
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+
+#include <gui/Choreographer.h>
+#include <gui/TransactionCoalescer.h>
+#include <utils/Log.h>
+#include <utils/Trace.h>
+
+namespace android {
+
+TransactionCoalescer::TransactionCoalescer(Choreographer* choreographer)
+      : mChoreographer(choreographer) {}
+
+TransactionCoalescer::~TransactionCoalescer() {
+    std::lock_guard _lock{mMutex};
+    flushLocked();
+}
+
+status_t TransactionCoalescer::apply(SurfaceComposerClient::Transaction&& t) {
+    if (t.mStatus != NO_ERROR) {
+        return t.mStatus;
+    }
+
+    std::lock_guard _lock{mMutex};
+    if (mPending) {
+        // merge() keeps the apply token of the transaction merged in, and doesn't merge the
+        // present time or animation flag, so those have to match.
+        const SurfaceComposerClient::Transaction& pending = *mPending;
+        if (pending.mApplyToken != t.mApplyToken ||
+            pending.mDesiredPresentTime != t.mDesiredPresentTime ||
+            pending.mIsAutoTimestamp != t.mIsAutoTimestamp || pending.mAnimation != t.mAnimation) {
+            status_t err = flushLocked();
+            if (err != NO_ERROR) {
+                return err;
+            }
+        }
+    }
+
+    if (mPending) {
+        mPending->merge(std::move(t));
+    } else {
+        mPending.emplace(t);
+        t.clear();
+    }
+
+    if (mChoreographer != nullptr && !mFlushScheduled) {
+        mFlushScheduled = true;
+        // released in onFrame
+        incStrong(this);
+        mChoreographer->postFrameCallbackDelayed(nullptr, onFrame, nullptr, this, 0);
+    }
+    return NO_ERROR;
+}
+
+status_t TransactionCoalescer::flush() {
+    std::lock_guard _lock{mMutex};
+    return flushLocked();
+}
+
+status_t TransactionCoalescer::flushLocked() {
+    if (!mPending) {
+        return NO_ERROR;
+    }
+    ATRACE_CALL();
+    // Applied with the lock held, so that a transaction can't overtake the one flushed before it.
+    status_t err = mPending->apply();
+    mPending.reset();
+    return err;
+}
+
+void TransactionCoalescer::onFrame(int64_t /*frameTimeNanos*/, void* data) {
+    TransactionCoalescer* coalescer = static_cast<TransactionCoalescer*>(data);
+    {
+        std::lock_guard _lock{coalescer->mMutex};
+        coalescer->mFlushScheduled = false;
+        status_t err = coalescer->flushLocked();
+        ALOGE_IF(err != NO_ERROR, "Failed to apply coalesced transaction: %d", err);
+    }
+    coalescer->decStrong(coalescer);
+}
+
+} // namespace android
@@ -27,6 +27,10 @@
 #include <utils/RefBase.h>
 
 #include <system/window.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
 #include <thread>
 #include <queue>
 
@@ -122,6 +126,14 @@ public:
      */
     void setTransactionHangCallback(std::function<void(const std::string&)> callback);
 
+    /**
+     * If set, released buffers whose release fence has already signaled are handed back to the
+     * producer ahead of buffers still waiting on their fence, so dequeueBuffer doesn't block on a
+     * slow fence while another buffer is ready. Buffers are then no longer returned in release
+     * order.
+     */
+    void setPreferSignaledBuffers(bool prefer);
+
     virtual ~BLASTBufferQueue();
 
 private:
@@ -149,6 +161,12 @@ private:
     void acquireAndReleaseBuffer() REQUIRES(mMutex);
     void releaseBuffer(const ReleaseCallbackId& callbackId, const sp<Fence>& releaseFence)
             REQUIRES(mMutex);
+    // Asks mPreallocateThread to replace the free buffers with ones of the current default size
+    // and format, if the producer has been using the previous default size and format.
+    void preallocateBuffersLocked(const ui::Size& previousSize, PixelFormat previousFormat)
+            REQUIRES(mMutex);
+    void preallocateBuffersLoop();
+    void preallocateBuffers(const ui::Size& fromSize, PixelFormat fromFormat, uint64_t usage);
 
     std::string mName;
     // Represents the queued buffer count from buffer queue,
@@ -207,12 +225,16 @@ private:
         // and the buffer will scale to fit the new size.
         uint32_t scalingMode = NATIVE_WINDOW_SCALING_MODE_SCALE_TO_WINDOW;
         Rect crop;
+        PixelFormat format = PIXEL_FORMAT_UNKNOWN;
+        uint64_t usage = 0;
 
         void update(bool hasBuffer, uint32_t width, uint32_t height, uint32_t transform,
-                    uint32_t scalingMode, const Rect& crop) {
+                    uint32_t scalingMode, const Rect& crop, PixelFormat format, uint64_t usage) {
             this->hasBuffer = hasBuffer;
             this->width = width;
             this->height = height;
+            this->format = format;
+            this->usage = usage;
             this->transform = transform;
             this->scalingMode = scalingMode;
             if (!crop.isEmpty()) {
@@ -293,6 +315,28 @@ private:
     std::function<void(const std::string&)> mTransactionHangCallback;
 
     std::unordered_set<uint64_t> mSyncedFrameNumbers GUARDED_BY(mMutex);
+
+    // See setPreferSignaledBuffers.
+    bool mPreferSignaledBuffers GUARDED_BY(mMutex) = false;
+
+    // Buffers are preallocated once the default geometry has not changed for
+    // kPreallocateDebounce, so that a resize animation replaces the free buffers once rather than
+    // on every update. The thread is started by the first request and joined in the destructor,
+    // which drops a request that is still waiting.
+    std::mutex mPreallocateMutex;
+    std::condition_variable mPreallocateCondition;
+    std::thread mPreallocateThread GUARDED_BY(mPreallocateMutex);
+    bool mStopPreallocating GUARDED_BY(mPreallocateMutex) = false;
+    bool mPreallocating GUARDED_BY(mPreallocateMutex) = false;
+    std::optional<std::chrono::steady_clock::time_point> mPreallocateDeadline
+            GUARDED_BY(mPreallocateMutex);
+    // The geometry the producer was using when the pending request was made, kept across
+    // debounced updates.
+    ui::Size mPreallocateFromSize GUARDED_BY(mPreallocateMutex);
+    PixelFormat mPreallocateFromFormat GUARDED_BY(mPreallocateMutex) = 0;
+    uint64_t mPreallocateUsage GUARDED_BY(mPreallocateMutex) = 0;
+    // Number of times the free buffers have been replaced. Read by tests.
+    uint32_t mNumPreallocations GUARDED_BY(mPreallocateMutex) = 0;
 };
 
 } // namespace android
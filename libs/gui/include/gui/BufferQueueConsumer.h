@@ -178,6 +178,17 @@ public:
     // will eventually be released or acquired by the consumer.
     void setAllowExtraAcquire(bool /* allow */);
 
+    // See BufferQueueCore::mPreferSignaledFreeBuffers.
+    void setPreferSignaledFreeBuffers(bool /* prefer */);
+
+    // setAdaptiveBufferCount lets the BufferQueue free a buffer, down to
+    // minBufferCount buffers, when the occupancy tracker shows that the
+    // producer didn't need it before the content went static. The slot is
+    // made available again as soon as the producer has to wait for a free
+    // buffer. A minBufferCount of 0 disables this and restores the full
+    // buffer count.
+    status_t setAdaptiveBufferCount(int minBufferCount);
+
 private:
     sp<BufferQueueCore> mCore;
 
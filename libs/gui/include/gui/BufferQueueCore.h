@@ -20,6 +20,7 @@
 #include <gui/BufferItem.h>
 #include <gui/BufferQueueDefs.h>
 #include <gui/BufferSlot.h>
+#include <gui/BufferSlotSet.h>
 #include <gui/OccupancyTracker.h>
 
 #include <utils/NativeHandle.h>
@@ -127,6 +128,15 @@ private:
     // away slots. Returns false if the request can't be met.
     bool adjustAvailableSlotsLocked(int delta);
 
+    // Called after each occupancy change. If adaptive buffer counting is
+    // enabled, and the occupancy segment that just ended didn't use a third
+    // buffer, takes a free slot, and its buffer, out of use.
+    void shrinkAdaptiveBufferCountLocked();
+
+    // Makes a slot that shrinkAdaptiveBufferCountLocked took out of use
+    // available again. Returns false if there is none.
+    bool growAdaptiveBufferCountLocked();
+
     // waitWhileAllocatingLocked blocks until mIsAllocating is false.
     void waitWhileAllocatingLocked(std::unique_lock<std::mutex>& lock) const;
 
@@ -202,18 +212,18 @@ private:
 
     // mFreeSlots contains all of the slots which are FREE and do not currently
     // have a buffer attached.
-    std::set<int> mFreeSlots;
+    BufferSlotSet mFreeSlots;
 
     // mFreeBuffers contains all of the slots which are FREE and currently have
     // a buffer attached.
-    std::list<int> mFreeBuffers;
+    BufferSlotQueue mFreeBuffers;
 
     // mUnusedSlots contains all slots that are currently unused. They should be
     // free and not have a buffer attached.
-    std::list<int> mUnusedSlots;
+    BufferSlotQueue mUnusedSlots;
 
     // mActiveBuffers contains all slots which have a non-FREE buffer attached.
-    std::set<int> mActiveBuffers;
+    BufferSlotSet mActiveBuffers;
 
     // mDequeueCondition is a condition variable used for dequeueBuffer in
     // synchronous mode.
@@ -357,6 +367,20 @@ private:
     // This allows the consumer to acquire an additional buffer if that buffer is not droppable and
     // will eventually be released or acquired by the consumer.
     bool mAllowExtraAcquire = false;
+
+    // If true, dequeueBuffer takes the oldest free buffer whose release fence has already
+    // signaled, instead of the oldest free buffer, so the producer doesn't wait on a slow fence
+    // while another buffer is ready.
+    bool mPreferSignaledFreeBuffers = false;
+
+    // The fewest buffers that adaptive buffer counting may leave in use, or 0
+    // if it is disabled. See BufferQueueConsumer::setAdaptiveBufferCount.
+    int mAdaptiveMinBufferCount = 0;
+
+    // The number of slots that adaptive buffer counting has taken out of use.
+    // These are slots that would otherwise be available according to
+    // getMaxBufferCountLocked.
+    int mAdaptiveSlotReduction = 0;
 }; // class BufferQueueCore
 
 } // namespace android
@@ -17,7 +17,9 @@
 #ifndef ANDROID_GUI_BUFFERQUEUEPRODUCER_H
 #define ANDROID_GUI_BUFFERQUEUEPRODUCER_H
 
+#include <gui/BufferItem.h>
 #include <gui/BufferQueueDefs.h>
+#include <gui/IConsumerListener.h>
 #include <gui/IGraphicBufferProducer.h>
 
 namespace android {
@@ -119,6 +121,17 @@ public:
     virtual status_t queueBuffer(int slot,
             const QueueBufferInput& input, QueueBufferOutput* output);
 
+    // See IGraphicBufferProducer::requestBuffers. All buffers are looked up
+    // under a single hold of the BufferQueue lock.
+    status_t requestBuffers(const std::vector<int32_t>& slots,
+                            std::vector<RequestBufferOutput>* outputs) override;
+
+    // See IGraphicBufferProducer::queueBuffers. All buffers are queued under a
+    // single hold of the BufferQueue lock, and the consumer is then notified
+    // of each of them in order.
+    status_t queueBuffers(const std::vector<QueueBufferInput>& inputs,
+                          std::vector<QueueBufferOutput>* outputs) override;
+
     // cancelBuffer returns a dequeued buffer to the BufferQueue, but doesn't
     // queue it for use by the consumer.
     //
@@ -222,6 +235,37 @@ private:
     void addAndGetFrameTimestamps(const NewFrameEventsEntry* newTimestamps,
             FrameEventHistoryDelta* outDelta);
 
+    status_t requestBufferLocked(int slot, sp<GraphicBuffer>* buf);
+
+    // A buffer being queued. queueBuffer is split into three steps, so that
+    // queueBuffers can run the middle one for several buffers under one lock:
+    // - prepareQueueBuffer reads and checks the input, without the lock.
+    // - queueBufferLocked queues the buffer, with mCore->mMutex held.
+    // - finishQueueBuffer notifies the consumer, without the lock.
+    struct QueuedFrame {
+        int slot = BufferItem::INVALID_BUFFER_SLOT;
+        const QueueBufferInput* input = nullptr;
+        int64_t requestedPresentTimestamp = 0;
+        bool isAutoTimestamp = false;
+        android_dataspace dataSpace = HAL_DATASPACE_UNKNOWN;
+        Rect crop = Rect::EMPTY_RECT;
+        int scalingMode = 0;
+        uint32_t transform = 0;
+        uint32_t stickyTransform = 0;
+        sp<Fence> acquireFence;
+        bool getFrameTimestamps = false;
+        std::shared_ptr<FenceTime> acquireFenceTime;
+
+        sp<IConsumerListener> frameAvailableListener;
+        sp<IConsumerListener> frameReplacedListener;
+        int callbackTicket = 0;
+        uint64_t currentFrameNumber = 0;
+        BufferItem item;
+    };
+    status_t prepareQueueBuffer(int slot, const QueueBufferInput& input, QueuedFrame* frame);
+    status_t queueBufferLocked(QueuedFrame* frame, QueueBufferOutput* output);
+    void finishQueueBuffer(QueuedFrame* frame, QueueBufferOutput* output);
+
     // waitForFreeSlotThenRelock finds the oldest slot in the FREE state. It may
     // block if there are no available slots and we are not in non-blocking
     // mode (producer and consumer controlled by the application). If it blocks,
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_GUI_BUFFERSLOTSET_H
+#define ANDROID_GUI_BUFFERSLOTSET_H
+
+#include <ui/BufferQueueDefs.h>
+#include <utils/BitSet.h>
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+
+namespace android {
+
+// BufferSlotSet and BufferSlotQueue hold slot indices in the range
+// [0, NUM_BUFFER_SLOTS). BufferQueueCore updates them on every dequeue,
+// queue, acquire and release, so they are kept allocation-free. Their
+// interfaces are the subset of std::set<int> and std::list<int> that
+// BufferQueueCore uses.
+
+// An ordered set of slots, stored as a bitmask. Iteration is in increasing
+// slot order, and begin() is the lowest slot.
+class BufferSlotSet {
+public:
+    static_assert(BufferQueueDefs::NUM_BUFFER_SLOTS <= 64,
+                  "BufferSlotSet stores slots in a 64-bit mask");
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = int;
+
+        int operator*() const { return static_cast<int>(mRemaining.firstMarkedBit()); }
+        const_iterator& operator++() {
+            mRemaining.clearFirstMarkedBit();
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+        bool operator==(const const_iterator& other) const {
+            return mRemaining.value == other.mRemaining.value;
+        }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class BufferSlotSet;
+        explicit const_iterator(BitSet64 remaining) : mRemaining(remaining) {}
+
+        // the slots that haven't been visited yet
+        BitSet64 mRemaining;
+    };
+    using iterator = const_iterator;
+
+    void insert(int slot) { mSlots.markBit(static_cast<uint32_t>(slot)); }
+
+    size_t erase(int slot) {
+        size_t erased = count(slot);
+        mSlots.clearBit(static_cast<uint32_t>(slot));
+        return erased;
+    }
+    void erase(const_iterator it) { erase(*it); }
+
+    size_t count(int slot) const { return mSlots.hasBit(static_cast<uint32_t>(slot)) ? 1 : 0; }
+    bool empty() const { return mSlots.isEmpty(); }
+    size_t size() const { return mSlots.count(); }
+    void clear() { mSlots.clear(); }
+
+    const_iterator begin() const { return const_iterator(mSlots); }
+    const_iterator end() const { return const_iterator(BitSet64()); }
+
+private:
+    BitSet64 mSlots;
+};
+
+// A double-ended queue of slots in a fixed-size ring buffer. Each slot may
+// be held at most once, so it never holds more than NUM_BUFFER_SLOTS entries.
+class BufferSlotQueue {
+public:
+    static constexpr size_t kCapacity = BufferQueueDefs::NUM_BUFFER_SLOTS;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = const int&;
+
+        const int& operator*() const { return mQueue->at(mIndex); }
+        const_iterator& operator++() {
+            mIndex++;
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+        bool operator==(const const_iterator& other) const { return mIndex == other.mIndex; }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class BufferSlotQueue;
+        const_iterator(const BufferSlotQueue* queue, size_t index)
+              : mQueue(queue), mIndex(index) {}
+
+        const BufferSlotQueue* mQueue;
+        size_t mIndex;
+    };
+    using iterator = const_iterator;
+
+    void push_back(int slot) {
+        mSlots[(mHead + mSize) % kCapacity] = slot;
+        mSize++;
+    }
+    void push_front(int slot) {
+        mHead = (mHead + kCapacity - 1) % kCapacity;
+        mSlots[mHead] = slot;
+        mSize++;
+    }
+    void pop_front() {
+        mHead = (mHead + 1) % kCapacity;
+        mSize--;
+    }
+    void pop_back() { mSize--; }
+
+    int front() const { return at(0); }
+    int back() const { return at(mSize - 1); }
+
+    // Removes every occurrence of 'slot', keeping the order of the others.
+    void remove(int slot) {
+        size_t kept = 0;
+        for (size_t i = 0; i < mSize; i++) {
+            if (at(i) != slot) {
+                mSlots[(mHead + kept) % kCapacity] = at(i);
+                kept++;
+            }
+        }
+        mSize = kept;
+    }
+
+    bool empty() const { return mSize == 0; }
+    size_t size() const { return mSize; }
+    void clear() {
+        mHead = 0;
+        mSize = 0;
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, mSize); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+private:
+    const int& at(size_t index) const { return mSlots[(mHead + index) % kCapacity]; }
+
+    std::array<int, kCapacity> mSlots{};
+    size_t mHead = 0;
+    size_t mSize = 0;
+};
+
+} // namespace android
+
+#endif // ANDROID_GUI_BUFFERSLOTSET_H
@@ -24,6 +24,7 @@
 
 #include <utils/Vector.h>
 
+#include <functional>
 
 namespace android {
 
@@ -111,6 +112,22 @@ class CpuConsumer : public ConsumerBase
     // lockNextBuffer.
     status_t unlockBuffer(const LockedBuffer &nativeBuffer);
 
+    // Enables or disables persistent mappings. While enabled, a buffer is
+    // locked for CPU reading the first time it is acquired, and stays locked
+    // until its slot is freed or persistent mappings are disabled again.
+    // lockNextBuffer then only waits for the acquire fence of later frames in
+    // the same buffer, and unlockBuffer returns the buffer to the queue
+    // without unlocking it.
+    //
+    // The producer writes to buffers while they are mapped here, so on
+    // devices where CPU access isn't cache-coherent with the producer the
+    // caches must be invalidated before reading. syncForCpu, if set, is called
+    // for that each time lockNextBuffer returns a persistently mapped buffer.
+    // It is called with the consumer lock held and must not call back into
+    // this CpuConsumer.
+    void setPersistentMapping(bool enabled,
+            std::function<void(const LockedBuffer&)> syncForCpu = nullptr);
+
   private:
     // Maximum number of buffers that can be locked at a time
     const size_t mMaxLockedBuffers;
@@ -140,12 +157,31 @@ class CpuConsumer : public ConsumerBase
 
     size_t findAcquiredBufferLocked(uintptr_t id) const;
 
-    status_t lockBufferItem(const BufferItem& item, LockedBuffer* outBuffer) const;
+    status_t lockBufferItem(const BufferItem& item, const Rect& region,
+            LockedBuffer* outBuffer) const;
+    status_t lockMappedBufferItemLocked(const BufferItem& item, LockedBuffer* outBuffer);
+
+    // Unlocks the persistent mapping of the buffer in slot, if any. A buffer
+    // that is still locked by the user is unlocked by unlockBuffer instead.
+    void unmapBufferLocked(int slot);
+    bool isAcquiredLocked(const sp<GraphicBuffer>& buffer) const;
+
+    virtual void freeBufferLocked(int slotIndex) override;
 
     Vector<AcquiredBuffer> mAcquiredBuffers;
 
     // Count of currently locked buffers
     size_t mCurrentLockedBuffers;
+
+    // Persistent mappings, see setPersistentMapping
+    struct MappedBuffer {
+        sp<GraphicBuffer> mGraphicBuffer;
+        // Only the pointers, strides and flexFormat are used
+        LockedBuffer mMapping;
+    };
+    MappedBuffer mMappedBuffers[BufferQueue::NUM_BUFFER_SLOTS];
+    bool mPersistentMapping;
+    std::function<void(const LockedBuffer&)> mSyncForCpu;
 };
 
 } // namespace android
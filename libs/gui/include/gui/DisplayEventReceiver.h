@@ -46,6 +46,7 @@ using gui::VsyncEventData;
 
 namespace gui {
 class BitTube;
+class SharedVsyncEventData;
 } // namespace gui
 
 static inline constexpr uint32_t fourcc(char c1, char c2, char c3, char c4) {
@@ -176,9 +177,18 @@ public:
      */
     status_t getLatestVsyncEventData(ParcelableVsyncEventData* outVsyncEventData) const;
 
+    /**
+     * getSharedVsyncEventData() gets the vsync event data most recently dispatched to this
+     * receiver. Unlike getLatestVsyncEventData(), it is read from memory shared with
+     * SurfaceFlinger, so only the first call makes a binder call. Returns NOT_ENOUGH_DATA if no
+     * vsync event was dispatched yet.
+     */
+    status_t getSharedVsyncEventData(VsyncEventData* outVsyncEventData);
+
 private:
     sp<IDisplayEventConnection> mEventConnection;
     std::unique_ptr<gui::BitTube> mDataChannel;
+    std::unique_ptr<gui::SharedVsyncEventData> mSharedVsyncEventData;
     std::optional<status_t> mInitError;
 };
 
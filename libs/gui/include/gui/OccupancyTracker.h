@@ -36,7 +36,8 @@ public:
       : mPendingSegment(),
         mSegmentHistory(),
         mLastOccupancy(0),
-        mLastOccupancyChangeTime(0) {}
+        mLastOccupancyChangeTime(0),
+        mHasNewSegment(false) {}
 
     struct Segment : public Parcelable {
         Segment()
@@ -72,6 +73,10 @@ public:
     void registerOccupancyChange(size_t occupancy);
     std::vector<Segment> getSegmentHistory(bool forceFlush);
 
+    // If a segment has been recorded since the last call, and the history
+    // hasn't been read since, copies it to outSegment and returns true.
+    bool takeNewSegment(Segment* outSegment);
+
 private:
     static constexpr size_t MAX_HISTORY_SIZE = 10;
     static constexpr nsecs_t NEW_SEGMENT_DELAY = ms2ns(100);
@@ -97,6 +102,9 @@ private:
     size_t mLastOccupancy;
     nsecs_t mLastOccupancyChangeTime;
 
+    // Whether the front of mSegmentHistory hasn't been taken by takeNewSegment
+    bool mHasNewSegment;
+
 }; // class OccupancyTracker
 
 } // namespace android
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include <android-base/unique_fd.h>
+
+#include <gui/VsyncEventData.h>
+
+namespace android::gui {
+
+// Memory shared between SurfaceFlinger and a DisplayEventReceiver, into which SurfaceFlinger
+// publishes the vsync event data it dispatches to the receiver. A client that already knows when
+// its next frame starts can read the latest frame timelines without a binder call or an event.
+//
+// The region is protected by a sequence lock: there is a single writer that never blocks, and
+// readers retry if they raced with a write.
+class SharedVsyncEventData {
+public:
+    // Allocates a region that can be shared with a client, which can only map it read-only.
+    static std::unique_ptr<SharedVsyncEventData> create();
+
+    // Maps a region allocated by create() in another process, or nullptr if fd is not one.
+    static std::unique_ptr<SharedVsyncEventData> map(base::unique_fd fd);
+
+    ~SharedVsyncEventData();
+
+    int getFd() const { return mFd.get(); }
+
+    // Publishes the vsync event data to readers. Must only be called from a single writer.
+    void publish(const VsyncEventData&);
+
+    // Reads the most recently published vsync event data. Returns false if nothing was published
+    // yet, or if every attempt raced with a write.
+    bool read(VsyncEventData* outVsyncEventData) const;
+
+private:
+    static constexpr size_t kWordCount = sizeof(VsyncEventData) / sizeof(uint64_t);
+    static_assert(sizeof(VsyncEventData) % sizeof(uint64_t) == 0);
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+    // Layout of the shared memory. The data is copied word by word with atomic accesses, so that
+    // readers racing with the writer are well defined and detected through the sequence.
+    struct Region {
+        // Odd while a write is in progress, and 0 until the first write.
+        std::atomic<uint64_t> sequence;
+        std::array<std::atomic<uint64_t>, kWordCount> words;
+    };
+
+    static constexpr int kMaxReadAttempts = 3;
+
+    SharedVsyncEventData(base::unique_fd fd, Region* region);
+
+    const base::unique_fd mFd;
+    Region* const mRegion;
+};
+
+} // namespace android::gui
@@ -18,6 +18,7 @@
 #define ANDROID_GUI_STREAMSPLITTER_H
 
 #include <gui/IConsumerListener.h>
+#include <gui/IGraphicBufferProducer.h>
 #include <gui/IProducerListener.h>
 
 #include <utils/Condition.h>
@@ -25,20 +26,38 @@
 #include <utils/Mutex.h>
 #include <utils/StrongPointer.h>
 
+#include <vector>
+
 namespace android {
 
 class GraphicBuffer;
 class IGraphicBufferConsumer;
-class IGraphicBufferProducer;
 
 // StreamSplitter is an autonomous class that manages one input BufferQueue
 // and multiple output BufferQueues. By using the buffer attach and detach logic
 // in BufferQueue, it is able to present the illusion of a single split
 // BufferQueue, where each buffer queued to the input is available to be
 // acquired by each of the outputs, and is able to be dequeued by the input
-// again only once all of the outputs have released it.
+// again only once all of the outputs it was queued to have released it.
 class StreamSplitter : public BnConsumerListener {
 public:
+    // OutputPolicy determines what happens to a buffer queued to the input
+    // while an output already holds as many buffers as it is allowed to (see
+    // addOutput).
+    enum class OutputPolicy {
+        // The splitter stops acquiring buffers from the input until the output
+        // releases one, which slows down the input and every other output.
+        BLOCK,
+        // The buffer is not queued to the output.
+        DROP,
+        // The buffer is held by the splitter, replacing any buffer it already
+        // held for the output, and queued to the output as soon as the output
+        // releases one.
+        KEEP_LATEST,
+    };
+
+    static const int MAX_OUTSTANDING_BUFFERS = 2;
+
     // createSplitter creates a new splitter, outSplitter, using inputQueue as
     // the input BufferQueue. Output BufferQueues must be added using addOutput
     // before queueing any buffers to the input.
@@ -57,11 +76,19 @@ public:
     // output is abandoned by its consumer, the splitter will abandon its input
     // queue (see onAbandoned).
     //
+    // At most maxOutstandingBuffers buffers are queued to outputQueue without
+    // having been released by it; policy determines what happens to the
+    // buffers queued to the input beyond that. The buffers an output doesn't
+    // take are released to the input as soon as the other outputs release
+    // them, so a DROP or KEEP_LATEST output never slows down the others.
+    //
     // A return value other than NO_ERROR means that an error has occurred and
     // outputQueue has not been added to the splitter. BAD_VALUE is returned if
     // outputQueue is NULL. See IGraphicBufferProducer::connect for explanations
     // of other error codes.
-    status_t addOutput(const sp<IGraphicBufferProducer>& outputQueue);
+    status_t addOutput(const sp<IGraphicBufferProducer>& outputQueue,
+            OutputPolicy policy = OutputPolicy::BLOCK,
+            int maxOutstandingBuffers = MAX_OUTSTANDING_BUFFERS);
 
     // setName sets the consumer name of the input queue
     void setName(const String8& name);
@@ -70,10 +97,10 @@ private:
     // From IConsumerListener
     //
     // During this callback, we store some tracking information, detach the
-    // buffer from the input, and attach it to each of the outputs. This call
-    // can block if there are too many outstanding buffers. If it blocks, it
-    // will resume when onBufferReleasedByOutput releases a buffer back to the
-    // input.
+    // buffer from the input, and attach it to each of the outputs that can
+    // take it. This call blocks while a BLOCK output has too many outstanding
+    // buffers, and resumes when onBufferReleasedByOutput gets a buffer back
+    // from it.
     virtual void onFrameAvailable(const BufferItem& item);
 
     // From IConsumerListener
@@ -93,8 +120,9 @@ private:
     // During this callback, we detach the buffer from the output queue that
     // generated the callback, update our state tracking to see if this is the
     // last output releasing the buffer, and if so, release it to the input.
-    // If we release the buffer to the input, we allow a blocked
-    // onFrameAvailable call to proceed.
+    // If the output is a KEEP_LATEST output with a buffer held for it, that
+    // buffer is queued to it. A blocked onFrameAvailable call is then allowed
+    // to proceed.
     void onBufferReleasedByOutput(const sp<IGraphicBufferProducer>& from);
 
     // When this is called, the splitter disconnects from (i.e., abandons) its
@@ -135,9 +163,13 @@ private:
 
         void mergeFence(const sp<Fence>& with);
 
+        // Counts the outputs that the buffer is queued to or held for, and
+        // the onFrameAvailable call queueing it. The buffer is released to
+        // the input when the count drops back to zero.
         // Returns the new value
         // Only called while mMutex is held
-        size_t incrementReleaseCountLocked() { return ++mReleaseCount; }
+        size_t incrementReferenceCountLocked() { return ++mReferenceCount; }
+        size_t decrementReferenceCountLocked() { return --mReferenceCount; }
 
     private:
         // Only destroy through LightRefBase
@@ -150,17 +182,40 @@ private:
 
         sp<GraphicBuffer> mBuffer; // One instance that holds this native handle
         sp<Fence> mMergedFence;
-        size_t mReleaseCount;
+        size_t mReferenceCount;
     };
 
+    struct Output {
+        sp<IGraphicBufferProducer> producer;
+        OutputPolicy policy;
+        int maxOutstandingBuffers;
+        // The buffers queued to the output that it hasn't released yet
+        int outstandingBuffers = 0;
+        // For a KEEP_LATEST output, the newest buffer that it didn't have
+        // room for, and the input to queue it with
+        sp<BufferTracker> heldBuffer;
+        IGraphicBufferProducer::QueueBufferInput heldQueueInput;
+    };
+
+    // Attaches and queues the buffer to the output, and adds a reference to
+    // it if that succeeded.
+    void queueToOutputLocked(Output& output, const sp<BufferTracker>& tracker,
+            const IGraphicBufferProducer::QueueBufferInput& queueInput);
+
+    // Removes a reference to the buffer, and releases it to the input if that
+    // was the last one.
+    void releaseReferenceLocked(const sp<BufferTracker>& tracker);
+
+    // Returns whether onFrameAvailable has to wait for a BLOCK output to
+    // release a buffer.
+    bool isBlockedLocked() const;
+
     // Only called from createSplitter
     explicit StreamSplitter(const sp<IGraphicBufferConsumer>& inputQueue);
 
     // Must be accessed through RefBase
     virtual ~StreamSplitter();
 
-    static const int MAX_OUTSTANDING_BUFFERS = 2;
-
     // mIsAbandoned is set to true when an output dies. Once the StreamSplitter
     // has been abandoned, it will continue to detach buffers from other
     // outputs, but it will disconnect from the input and not attempt to
@@ -169,12 +224,11 @@ private:
 
     Mutex mMutex;
     Condition mReleaseCondition;
-    int mOutstandingBuffers;
     sp<IGraphicBufferConsumer> mInput;
-    Vector<sp<IGraphicBufferProducer> > mOutputs;
+    std::vector<Output> mOutputs;
 
     // Map of GraphicBuffer IDs (GraphicBuffer::getId()) to buffer tracking
-    // objects (which are mostly for counting how many outputs have released the
+    // objects (which are mostly for counting how many outputs still hold the
     // buffer, but also contain merged release fences).
     KeyedVector<uint64_t, sp<BufferTracker> > mBuffers;
 };
@@ -419,6 +419,10 @@ protected:
 
     void querySupportedTimestampsLocked() const;
 
+    // Returns whether getFrameTimestamps should ask the producer for new
+    // timestamps. See mBatchFrameTimestampsQueries.
+    bool shouldQueryFrameTimestampsLocked() const;
+
     void freeAllBuffers();
     int getSlotFromBufferLocked(android_native_buffer_t* buffer) const;
 
@@ -619,6 +623,15 @@ protected:
     bool mEnableFrameTimestamps = false;
     std::unique_ptr<ProducerFrameEventHistory> mFrameEventHistory;
 
+    // When the producer is remote, getFrameTimestamps asks it for new
+    // timestamps at most once per composite interval, instead of on each
+    // query for a timestamp that isn't known yet, so that polling every
+    // frame doesn't turn into an IPC per query.
+    bool mBatchFrameTimestampsQueries = false;
+    // The last time timestamps were received from the producer, either by
+    // asking it or along with a queued buffer.
+    nsecs_t mLastFrameTimestampsUpdateTime = 0;
+
     // Reference to the SurfaceFlinger layer that was used to create this
     // surface. This is only populated when the Surface is created from
     // a BlastBufferQueue.
@@ -59,6 +59,7 @@ class IGraphicBufferProducer;
 class ITunnelModeEnabledListener;
 class Region;
 class TransactionCompletedListener;
+class TransactionCoalescer;
 
 using gui::DisplayCaptureArgs;
 using gui::IRegionSamplingListener;
@@ -421,6 +422,8 @@ public:
 
     class Transaction : public Parcelable {
     private:
+        friend class android::TransactionCoalescer;
+
         static sp<IBinder> sApplyToken;
         void releaseBufferIfOverwriting(const layer_state_t& state);
         static void mergeFrameTimelineInfo(FrameTimelineInfo& t, const FrameTimelineInfo& other);
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <android-base/thread_annotations.h>
+#include <gui/SurfaceComposerClient.h>
+#include <utils/RefBase.h>
+
+#include <mutex>
+#include <optional>
+
+namespace android {
+
+class Choreographer;
+
+/**
+ * Coalesces the transactions applied during a frame into a single setTransactionState call.
+ *
+ * Transactions are merged in the order they are applied, with Transaction::merge, so a later
+ * change to a layer wins over an earlier one just as if each transaction had been applied on its
+ * own, and the callbacks of all of them are kept. A transaction that can't be merged into the
+ * pending one, because it uses a different apply token, desired present time or animation flag,
+ * flushes the pending one first, so transactions still reach SurfaceFlinger in order.
+ */
+class TransactionCoalescer : public virtual RefBase {
+public:
+    /**
+     * If choreographer is set, the pending transaction is flushed from its next frame callback.
+     * Otherwise, the owner is expected to call flush() once per frame.
+     */
+    explicit TransactionCoalescer(Choreographer* choreographer = nullptr);
+    ~TransactionCoalescer() override;
+
+    /**
+     * Takes the contents of t, clearing it as if it had been applied. Synchronous and one-way
+     * applies can't be deferred; for those, call flush() and then apply the transaction directly.
+     */
+    status_t apply(SurfaceComposerClient::Transaction&& t);
+
+    /**
+     * Applies the pending transaction, if there is one.
+     */
+    status_t flush();
+
+private:
+    static void onFrame(int64_t frameTimeNanos, void* data);
+
+    status_t flushLocked() REQUIRES(mMutex);
+
+    Choreographer* const mChoreographer;
+
+    std::mutex mMutex;
+    std::optional<SurfaceComposerClient::Transaction> mPending GUARDED_BY(mMutex);
+    bool mFlushScheduled GUARDED_BY(mMutex) = false;
+};
+
+} // namespace android
@@ -169,6 +169,24 @@ public:
         mBlastBufferQueueAdapter->mergeWithNextTransaction(merge, frameNumber);
     }
 
+    bool hasPendingPreallocation() {
+        std::unique_lock lock{mBlastBufferQueueAdapter->mPreallocateMutex};
+        return mBlastBufferQueueAdapter->mPreallocateDeadline.has_value();
+    }
+
+    void waitForPreallocation() {
+        std::unique_lock lock{mBlastBufferQueueAdapter->mPreallocateMutex};
+        while (mBlastBufferQueueAdapter->mPreallocateDeadline ||
+               mBlastBufferQueueAdapter->mPreallocating) {
+            mBlastBufferQueueAdapter->mPreallocateCondition.wait(lock);
+        }
+    }
+
+    uint32_t getNumPreallocations() {
+        std::unique_lock lock{mBlastBufferQueueAdapter->mPreallocateMutex};
+        return mBlastBufferQueueAdapter->mNumPreallocations;
+    }
+
 private:
     sp<TestBLASTBufferQueue> mBlastBufferQueueAdapter;
 };
@@ -812,6 +830,77 @@ TEST_F(BLASTBufferQueueTest, ScalingModeChanges) {
                                {0, 0, (int32_t)mDisplayWidth, (int32_t)mDisplayHeight / 2}));
 }
 
+TEST_F(BLASTBufferQueueTest, PreallocatesBuffersOnceAfterResizes) {
+    BLASTBufferQueueHelper adapter(mSurfaceControl, mDisplayWidth, mDisplayHeight / 4);
+    sp<IGraphicBufferProducer> igbProducer;
+    setUpProducer(adapter, igbProducer);
+    {
+        int slot;
+        sp<Fence> fence;
+        sp<GraphicBuffer> buf;
+        auto ret = igbProducer->dequeueBuffer(&slot, &fence, 0, 0, 0,
+                                              GRALLOC_USAGE_SW_WRITE_OFTEN, nullptr, nullptr);
+        ASSERT_EQ(IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION, ret);
+        ASSERT_EQ(OK, igbProducer->requestBuffer(slot, &buf));
+
+        IGraphicBufferProducer::QueueBufferOutput qbOutput;
+        IGraphicBufferProducer::QueueBufferInput input(systemTime(), true /* autotimestamp */,
+                                                       HAL_DATASPACE_UNKNOWN, {},
+                                                       NATIVE_WINDOW_SCALING_MODE_FREEZE, 0,
+                                                       Fence::NO_FENCE);
+        igbProducer->queueBuffer(slot, input, &qbOutput);
+        adapter.waitForCallbacks();
+    }
+
+    // A burst of resizes only replaces the free buffers once, after the last one.
+    adapter.update(mSurfaceControl, mDisplayWidth, mDisplayHeight / 3);
+    adapter.update(mSurfaceControl, mDisplayWidth, mDisplayHeight / 2);
+    EXPECT_TRUE(adapter.hasPendingPreallocation());
+    adapter.waitForPreallocation();
+    EXPECT_EQ(1u, adapter.getNumPreallocations());
+
+    // The producer gets a buffer of the new default size without reallocating.
+    int slot;
+    sp<Fence> fence;
+    sp<GraphicBuffer> buf;
+    auto ret = igbProducer->dequeueBuffer(&slot, &fence, 0, 0, 0, GRALLOC_USAGE_SW_WRITE_OFTEN,
+                                          nullptr, nullptr);
+    ASSERT_EQ(NO_ERROR, ret);
+    ASSERT_EQ(OK, igbProducer->requestBuffer(slot, &buf));
+    EXPECT_EQ(mDisplayWidth, buf->getWidth());
+    EXPECT_EQ(mDisplayHeight / 2, buf->getHeight());
+}
+
+TEST_F(BLASTBufferQueueTest, DestroyingCancelsPendingPreallocation) {
+    auto adapter = std::make_unique<BLASTBufferQueueHelper>(mSurfaceControl, mDisplayWidth,
+                                                            mDisplayHeight / 4);
+    sp<IGraphicBufferProducer> igbProducer;
+    setUpProducer(*adapter, igbProducer);
+    {
+        int slot;
+        sp<Fence> fence;
+        sp<GraphicBuffer> buf;
+        auto ret = igbProducer->dequeueBuffer(&slot, &fence, 0, 0, 0,
+                                              GRALLOC_USAGE_SW_WRITE_OFTEN, nullptr, nullptr);
+        ASSERT_EQ(IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION, ret);
+        ASSERT_EQ(OK, igbProducer->requestBuffer(slot, &buf));
+
+        IGraphicBufferProducer::QueueBufferOutput qbOutput;
+        IGraphicBufferProducer::QueueBufferInput input(systemTime(), true /* autotimestamp */,
+                                                       HAL_DATASPACE_UNKNOWN, {},
+                                                       NATIVE_WINDOW_SCALING_MODE_FREEZE, 0,
+                                                       Fence::NO_FENCE);
+        igbProducer->queueBuffer(slot, input, &qbOutput);
+        adapter->waitForCallbacks();
+    }
+
+    adapter->update(mSurfaceControl, mDisplayWidth, mDisplayHeight / 2);
+    ASSERT_TRUE(adapter->hasPendingPreallocation());
+    // The destructor drops the request and joins the preallocation thread.
+    igbProducer.clear();
+    adapter.reset();
+}
+
 TEST_F(BLASTBufferQueueTest, SyncThenNoSync) {
     uint8_t r = 255;
     uint8_t g = 0;
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <gui/BufferSlotSet.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace android::test {
+
+TEST(BufferSlotSetTest, IteratesInSlotOrder) {
+    BufferSlotSet set;
+    EXPECT_TRUE(set.empty());
+
+    set.insert(63);
+    set.insert(5);
+    set.insert(0);
+    set.insert(5);
+
+    EXPECT_EQ(3u, set.size());
+    EXPECT_EQ(0, *set.begin());
+    EXPECT_EQ((std::vector<int>{0, 5, 63}), std::vector<int>(set.begin(), set.end()));
+}
+
+TEST(BufferSlotSetTest, Erase) {
+    BufferSlotSet set;
+    set.insert(1);
+    set.insert(2);
+
+    EXPECT_EQ(1u, set.erase(1));
+    EXPECT_EQ(0u, set.erase(1));
+    EXPECT_EQ(0u, set.count(1));
+    EXPECT_EQ(1u, set.count(2));
+
+    set.erase(set.begin());
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.begin(), set.end());
+}
+
+TEST(BufferSlotQueueTest, PushAndPopBothEnds) {
+    BufferSlotQueue queue;
+    EXPECT_TRUE(queue.empty());
+
+    queue.push_back(1);
+    queue.push_back(2);
+    queue.push_front(0);
+
+    EXPECT_EQ(3u, queue.size());
+    EXPECT_EQ(0, queue.front());
+    EXPECT_EQ(2, queue.back());
+    EXPECT_EQ((std::vector<int>{0, 1, 2}), std::vector<int>(queue.begin(), queue.end()));
+
+    queue.pop_front();
+    queue.pop_back();
+    EXPECT_EQ((std::vector<int>{1}), std::vector<int>(queue.begin(), queue.end()));
+}
+
+TEST(BufferSlotQueueTest, WrapsAround) {
+    BufferSlotQueue queue;
+    for (int round = 0; round < 3; round++) {
+        for (size_t slot = 0; slot < BufferSlotQueue::kCapacity; slot++) {
+            queue.push_back(static_cast<int>(slot));
+        }
+        EXPECT_EQ(BufferSlotQueue::kCapacity, queue.size());
+        for (size_t slot = 0; slot < BufferSlotQueue::kCapacity; slot++) {
+            EXPECT_EQ(static_cast<int>(slot), queue.front());
+            queue.pop_front();
+        }
+        EXPECT_TRUE(queue.empty());
+        // offsets the head for the next round
+        queue.push_front(0);
+        queue.pop_front();
+    }
+}
+
+TEST(BufferSlotQueueTest, RemoveKeepsOrder) {
+    BufferSlotQueue queue;
+    queue.push_back(4);
+    queue.push_back(7);
+    queue.push_back(2);
+    queue.push_back(9);
+
+    queue.remove(7);
+    queue.remove(5);
+
+    EXPECT_EQ((std::vector<int>{4, 2, 9}), std::vector<int>(queue.begin(), queue.end()));
+    EXPECT_EQ(queue.cend(), std::find(queue.cbegin(), queue.cend(), 7));
+}
+
+} // namespace android::test
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <binder/Parcel.h>
+
+#include <gui/LayerState.h>
+
+namespace android::test {
+
+TEST(LayerStateTest, ParcellingFlaggedFields) {
+    layer_state_t state;
+    state.layerId = 7;
+    state.what = layer_state_t::ePositionChanged | layer_state_t::eAlphaChanged |
+            layer_state_t::eCornerRadiusChanged;
+    state.x = 12.f;
+    state.y = 34.f;
+    state.color.a = 0.5f;
+    state.cornerRadius = 8.f;
+
+    Parcel p;
+    ASSERT_EQ(OK, state.write(p));
+    p.setDataPosition(0);
+
+    layer_state_t state2;
+    ASSERT_EQ(OK, state2.read(p));
+    EXPECT_EQ(state.layerId, state2.layerId);
+    EXPECT_EQ(state.what, state2.what);
+    EXPECT_EQ(state.x, state2.x);
+    EXPECT_EQ(state.y, state2.y);
+    EXPECT_EQ(state.color.a, state2.color.a);
+    EXPECT_EQ(state.cornerRadius, state2.cornerRadius);
+    EXPECT_EQ(p.dataSize(), p.dataPosition());
+}
+
+TEST(LayerStateTest, ParcellingSkipsUnflaggedFields) {
+    layer_state_t state;
+    state.what = layer_state_t::ePositionChanged;
+    state.x = 1.f;
+    // not flagged in 'what', so not sent
+    state.cornerRadius = 8.f;
+    state.shadowRadius = 4.f;
+
+    Parcel p;
+    ASSERT_EQ(OK, state.write(p));
+    p.setDataPosition(0);
+
+    layer_state_t state2;
+    ASSERT_EQ(OK, state2.read(p));
+    EXPECT_EQ(1.f, state2.x);
+    EXPECT_EQ(layer_state_t().cornerRadius, state2.cornerRadius);
+    EXPECT_EQ(layer_state_t().shadowRadius, state2.shadowRadius);
+
+    layer_state_t allFlagged;
+    allFlagged.what = layer_state_t::ePositionChanged | layer_state_t::eCornerRadiusChanged |
+            layer_state_t::eShadowRadiusChanged;
+    Parcel p2;
+    ASSERT_EQ(OK, allFlagged.write(p2));
+    EXPECT_LT(p.dataSize(), p2.dataSize());
+}
+
+} // namespace android::test
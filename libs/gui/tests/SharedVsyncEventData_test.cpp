@@ -0,0 +1,78 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <gui/SharedVsyncEventData.h>
+
+namespace android {
+
+using gui::SharedVsyncEventData;
+using gui::VsyncEventData;
+using FrameTimeline = gui::VsyncEventData::FrameTimeline;
+
+namespace test {
+
+TEST(SharedVsyncEventData, readFailsBeforePublish) {
+    const auto writer = SharedVsyncEventData::create();
+    ASSERT_NE(nullptr, writer);
+
+    const auto reader = SharedVsyncEventData::map(base::unique_fd(dup(writer->getFd())));
+    ASSERT_NE(nullptr, reader);
+
+    VsyncEventData data;
+    EXPECT_FALSE(reader->read(&data));
+}
+
+TEST(SharedVsyncEventData, readsPublishedData) {
+    const auto writer = SharedVsyncEventData::create();
+    ASSERT_NE(nullptr, writer);
+
+    const auto reader = SharedVsyncEventData::map(base::unique_fd(dup(writer->getFd())));
+    ASSERT_NE(nullptr, reader);
+
+    for (int64_t i = 1; i <= 3; i++) {
+        VsyncEventData data;
+        data.frameInterval = 16'666'667 * i;
+        data.preferredFrameTimelineIndex = 1;
+        data.frameTimelinesLength = 2;
+        data.frameTimelines[0] = FrameTimeline{i, 2 * i, 3 * i};
+        data.frameTimelines[1] = FrameTimeline{4 * i, 5 * i, 6 * i};
+        writer->publish(data);
+
+        VsyncEventData data2;
+        ASSERT_TRUE(reader->read(&data2));
+        EXPECT_EQ(data.frameInterval, data2.frameInterval);
+        EXPECT_EQ(data.preferredFrameTimelineIndex, data2.preferredFrameTimelineIndex);
+        EXPECT_EQ(data.frameTimelinesLength, data2.frameTimelinesLength);
+        for (uint32_t j = 0; j < data.frameTimelinesLength; j++) {
+            EXPECT_EQ(data.frameTimelines[j].vsyncId, data2.frameTimelines[j].vsyncId);
+            EXPECT_EQ(data.frameTimelines[j].deadlineTimestamp,
+                      data2.frameTimelines[j].deadlineTimestamp);
+            EXPECT_EQ(data.frameTimelines[j].expectedPresentationTime,
+                      data2.frameTimelines[j].expectedPresentationTime);
+        }
+    }
+}
+
+TEST(SharedVsyncEventData, mapRejectsInvalidFd) {
+    EXPECT_EQ(nullptr, SharedVsyncEventData::map(base::unique_fd()));
+}
+
+} // namespace test
+} // namespace android
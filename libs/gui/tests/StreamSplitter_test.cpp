@@ -40,6 +40,44 @@ struct FakeListener : public BnConsumerListener {
 
 static const uint32_t TEST_DATA = 0x12345678u;
 
+static void queueFrame(const sp<IGraphicBufferProducer>& producer, uint32_t data) {
+    int slot;
+    sp<Fence> fence;
+    sp<GraphicBuffer> buffer;
+    status_t status = producer->dequeueBuffer(&slot, &fence, 0, 0, 0,
+            GRALLOC_USAGE_SW_WRITE_OFTEN, nullptr, nullptr);
+    ASSERT_GE(status, OK);
+    ASSERT_EQ(OK, producer->requestBuffer(slot, &buffer));
+
+    uint32_t* dataIn;
+    ASSERT_EQ(OK, buffer->lock(GraphicBuffer::USAGE_SW_WRITE_OFTEN,
+            reinterpret_cast<void**>(&dataIn)));
+    *dataIn = data;
+    ASSERT_EQ(OK, buffer->unlock());
+
+    IGraphicBufferProducer::QueueBufferInput qbInput(0, false,
+            HAL_DATASPACE_UNKNOWN, Rect(0, 0, 1, 1),
+            NATIVE_WINDOW_SCALING_MODE_FREEZE, 0, Fence::NO_FENCE);
+    IGraphicBufferProducer::QueueBufferOutput qbOutput;
+    ASSERT_EQ(OK, producer->queueBuffer(slot, qbInput, &qbOutput));
+}
+
+static void acquireFrame(const sp<IGraphicBufferConsumer>& consumer, uint32_t expectedData,
+        BufferItem* outItem) {
+    ASSERT_EQ(OK, consumer->acquireBuffer(outItem, 0));
+
+    uint32_t* dataOut;
+    ASSERT_EQ(OK, outItem->mGraphicBuffer->lock(GraphicBuffer::USAGE_SW_READ_OFTEN,
+            reinterpret_cast<void**>(&dataOut)));
+    ASSERT_EQ(expectedData, *dataOut);
+    ASSERT_EQ(OK, outItem->mGraphicBuffer->unlock());
+}
+
+static void releaseFrame(const sp<IGraphicBufferConsumer>& consumer, const BufferItem& item) {
+    ASSERT_EQ(OK, consumer->releaseBuffer(item.mSlot, item.mFrameNumber,
+            EGL_NO_DISPLAY, EGL_NO_SYNC_KHR, Fence::NO_FENCE));
+}
+
 TEST_F(StreamSplitterTest, OneInputOneOutput) {
     sp<IGraphicBufferProducer> inputProducer;
     sp<IGraphicBufferConsumer> inputConsumer;
@@ -180,6 +218,85 @@ TEST_F(StreamSplitterTest, OneInputMultipleOutputs) {
                                            nullptr, nullptr));
 }
 
+TEST_F(StreamSplitterTest, DropOutputDoesNotStallOthers) {
+    sp<IGraphicBufferProducer> inputProducer;
+    sp<IGraphicBufferConsumer> inputConsumer;
+    BufferQueue::createBufferQueue(&inputProducer, &inputConsumer);
+
+    sp<IGraphicBufferProducer> slowProducer, fastProducer;
+    sp<IGraphicBufferConsumer> slowConsumer, fastConsumer;
+    BufferQueue::createBufferQueue(&slowProducer, &slowConsumer);
+    BufferQueue::createBufferQueue(&fastProducer, &fastConsumer);
+    ASSERT_EQ(OK, slowConsumer->consumerConnect(new FakeListener, false));
+    ASSERT_EQ(OK, fastConsumer->consumerConnect(new FakeListener, false));
+
+    sp<StreamSplitter> splitter;
+    ASSERT_EQ(OK, StreamSplitter::createSplitter(inputConsumer, &splitter));
+    ASSERT_EQ(OK, splitter->addOutput(slowProducer, StreamSplitter::OutputPolicy::DROP, 1));
+    ASSERT_EQ(OK, splitter->addOutput(fastProducer));
+
+    IGraphicBufferProducer::QueueBufferOutput qbOutput;
+    ASSERT_EQ(OK,
+              inputProducer->connect(new StubProducerListener, NATIVE_WINDOW_API_CPU, false,
+                                     &qbOutput));
+
+    // The slow output holds on to the first frame
+    queueFrame(inputProducer, TEST_DATA);
+    BufferItem slowItem;
+    acquireFrame(slowConsumer, TEST_DATA, &slowItem);
+
+    // The fast output keeps getting every frame, and the slow one drops them
+    for (uint32_t frame = 0; frame < 4; ++frame) {
+        if (frame > 0) {
+            queueFrame(inputProducer, TEST_DATA + frame);
+        }
+        BufferItem fastItem;
+        acquireFrame(fastConsumer, TEST_DATA + frame, &fastItem);
+        releaseFrame(fastConsumer, fastItem);
+    }
+
+    BufferItem item;
+    ASSERT_EQ(IGraphicBufferConsumer::NO_BUFFER_AVAILABLE, slowConsumer->acquireBuffer(&item, 0));
+    releaseFrame(slowConsumer, slowItem);
+}
+
+TEST_F(StreamSplitterTest, KeepLatestOutputGetsNewestFrame) {
+    sp<IGraphicBufferProducer> inputProducer;
+    sp<IGraphicBufferConsumer> inputConsumer;
+    BufferQueue::createBufferQueue(&inputProducer, &inputConsumer);
+
+    sp<IGraphicBufferProducer> outputProducer;
+    sp<IGraphicBufferConsumer> outputConsumer;
+    BufferQueue::createBufferQueue(&outputProducer, &outputConsumer);
+    ASSERT_EQ(OK, outputConsumer->consumerConnect(new FakeListener, false));
+
+    sp<StreamSplitter> splitter;
+    ASSERT_EQ(OK, StreamSplitter::createSplitter(inputConsumer, &splitter));
+    ASSERT_EQ(OK,
+              splitter->addOutput(outputProducer, StreamSplitter::OutputPolicy::KEEP_LATEST, 1));
+
+    IGraphicBufferProducer::QueueBufferOutput qbOutput;
+    ASSERT_EQ(OK,
+              inputProducer->connect(new StubProducerListener, NATIVE_WINDOW_API_CPU, false,
+                                     &qbOutput));
+
+    queueFrame(inputProducer, TEST_DATA);
+    BufferItem item;
+    acquireFrame(outputConsumer, TEST_DATA, &item);
+
+    // Neither frame fits in the output, so the second replaces the first
+    queueFrame(inputProducer, TEST_DATA + 1);
+    queueFrame(inputProducer, TEST_DATA + 2);
+    BufferItem pendingItem;
+    ASSERT_EQ(IGraphicBufferConsumer::NO_BUFFER_AVAILABLE,
+              outputConsumer->acquireBuffer(&pendingItem, 0));
+
+    // Releasing the first frame makes room for the newest one
+    releaseFrame(outputConsumer, item);
+    acquireFrame(outputConsumer, TEST_DATA + 2, &item);
+    releaseFrame(outputConsumer, item);
+}
+
 TEST_F(StreamSplitterTest, OutputAbandonment) {
     sp<IGraphicBufferProducer> inputProducer;
     sp<IGraphicBufferConsumer> inputConsumer;
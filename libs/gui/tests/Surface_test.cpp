@@ -1101,6 +1101,10 @@ public:
         mNow = now;
     }
 
+    void setBatchFrameTimestampsQueries(bool batch) {
+        mBatchFrameTimestampsQueries = batch;
+    }
+
 public:
     sp<FakeSurfaceComposer> mFakeSurfaceComposer;
     sp<FakeSurfaceComposerAIDL> mFakeSurfaceComposerAIDL;
@@ -1474,6 +1478,29 @@ TEST_F(GetFrameTimestampsTest, EnabledSimple) {
     EXPECT_EQ(4, mFakeConsumer->mGetFrameTimestampsCount);
 }
 
+TEST_F(GetFrameTimestampsTest, BatchedQueriesOncePerCompositeInterval) {
+    const CompositorTiming compositorTiming = makeCompositorTiming();
+    mCfeh->initializeCompositorTiming(compositorTiming);
+    mSurface->setBatchFrameTimestampsQueries(true);
+    enableFrameTimestamps();
+
+    const uint64_t fId1 = getNextFrameId();
+    mSurface->setNow(compositorTiming.deadline + 1);
+    dequeueAndQueue(0);
+    const int getFrameTimestampsCount = mFakeConsumer->mGetFrameTimestampsCount;
+
+    // The queue brought back the consumer's timestamps, so there is nothing
+    // new to ask for until the next composite deadline.
+    EXPECT_EQ(NO_ERROR, getAllFrameTimestamps(fId1));
+    EXPECT_EQ(getFrameTimestampsCount, mFakeConsumer->mGetFrameTimestampsCount);
+
+    mSurface->setNow(compositorTiming.deadline + compositorTiming.interval + 1);
+    EXPECT_EQ(NO_ERROR, getAllFrameTimestamps(fId1));
+    EXPECT_EQ(getFrameTimestampsCount + 1, mFakeConsumer->mGetFrameTimestampsCount);
+    EXPECT_EQ(NO_ERROR, getAllFrameTimestamps(fId1));
+    EXPECT_EQ(getFrameTimestampsCount + 1, mFakeConsumer->mGetFrameTimestampsCount);
+}
+
 TEST_F(GetFrameTimestampsTest, QueryPresentSupported) {
     bool displayPresentSupported = true;
     mSurface->mFakeSurfaceComposer->setSupportsPresent(displayPresentSupported);
@@ -140,6 +140,30 @@ inline static float lerp(float a, float b, float alpha) {
     return a + alpha * (b - a);
 }
 
+/**
+ * Sets the X and Y axes of outCoords to the interpolation of the ones of a and b. Axis values are
+ * packed in axis order, so X and Y are the first two values whenever both are present, and are
+ * interpolated together without looking up their positions.
+ */
+inline static void lerpXY(const PointerCoords& a, const PointerCoords& b, float alpha,
+                          PointerCoords& outCoords) {
+    constexpr uint64_t xyBits =
+            (1ULL << (63 - AMOTION_EVENT_AXIS_X)) | (1ULL << (63 - AMOTION_EVENT_AXIS_Y));
+    static_assert(AMOTION_EVENT_AXIS_X == 0 && AMOTION_EVENT_AXIS_Y == 1);
+    if ((a.bits & xyBits) == xyBits && (b.bits & xyBits) == xyBits &&
+        (outCoords.bits & xyBits) == xyBits) {
+        const float* av = a.values.data();
+        const float* bv = b.values.data();
+        float* out = outCoords.values.data();
+        for (size_t i = 0; i < 2; i++) {
+            out[i] = lerp(av[i], bv[i], alpha);
+        }
+        return;
+    }
+    outCoords.setAxisValue(AMOTION_EVENT_AXIS_X, lerp(a.getX(), b.getX(), alpha));
+    outCoords.setAxisValue(AMOTION_EVENT_AXIS_Y, lerp(a.getY(), b.getY(), alpha));
+}
+
 inline static bool isPointerEvent(int32_t source) {
     return (source & AINPUT_SOURCE_CLASS_POINTER) == AINPUT_SOURCE_CLASS_POINTER;
 }
@@ -462,6 +486,75 @@ status_t InputChannel::sendMessage(const InputMessage* msg) {
     return OK;
 }
 
+status_t InputChannel::sendMessages(const InputMessage* msgs, size_t count,
+                                    size_t* outSentCount) {
+    *outSentCount = 0;
+    if (count == 1) {
+        status_t status = sendMessage(msgs);
+        if (status == OK) {
+            *outSentCount = 1;
+        }
+        return status;
+    }
+
+    std::vector<InputMessage> cleanMsgs(count);
+    std::vector<iovec> iovs(count);
+    std::vector<mmsghdr> headers(count);
+    for (size_t i = 0; i < count; i++) {
+        msgs[i].getSanitizedCopy(&cleanMsgs[i]);
+        iovs[i].iov_base = &cleanMsgs[i];
+        iovs[i].iov_len = msgs[i].size();
+        headers[i] = {};
+        headers[i].msg_hdr.msg_iov = &iovs[i];
+        headers[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    size_t sentCount = 0;
+    while (sentCount < count) {
+        int nSent = ::sendmmsg(getFd(), &headers[sentCount], count - sentCount,
+                               MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (nSent == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (nSent < 0) {
+            int error = errno;
+            ALOGD_IF(DEBUG_CHANNEL_MESSAGES, "channel '%s' ~ error sending message of type %s, %s",
+                     mName.c_str(), ftl::enum_string(msgs[sentCount].header.type).c_str(),
+                     strerror(error));
+            *outSentCount = sentCount;
+            if (error == EAGAIN || error == EWOULDBLOCK) {
+                return WOULD_BLOCK;
+            }
+            if (error == EPIPE || error == ENOTCONN || error == ECONNREFUSED ||
+                error == ECONNRESET) {
+                return DEAD_OBJECT;
+            }
+            return -error;
+        }
+
+        for (int i = 0; i < nSent; i++, sentCount++) {
+            if (headers[sentCount].msg_len != iovs[sentCount].iov_len) {
+                ALOGD_IF(DEBUG_CHANNEL_MESSAGES,
+                         "channel '%s' ~ error sending message type %s, send was incomplete",
+                         mName.c_str(), ftl::enum_string(msgs[sentCount].header.type).c_str());
+                *outSentCount = sentCount;
+                return DEAD_OBJECT;
+            }
+        }
+    }
+    *outSentCount = sentCount;
+
+    ALOGD_IF(DEBUG_CHANNEL_MESSAGES, "channel '%s' ~ sent %zu messages", mName.c_str(), count);
+
+    if (ATRACE_ENABLED()) {
+        std::string message = StringPrintf("sendMessages(inputChannel=%s, count=%zu)",
+                                           mName.c_str(), count);
+        ATRACE_NAME(message.c_str());
+    }
+    return OK;
+}
+
 status_t InputChannel::receiveMessage(InputMessage* msg) {
     ssize_t nRead;
     do {
@@ -1202,16 +1295,20 @@ void InputConsumer::resampleTouchState(nsecs_t sampleTime, MotionEvent* event,
         }
     }
 
-    // Find the data to use for resampling.
-    const History* other;
-    History future;
+    // Find the data to use for resampling. The coordinates of the other sample are referred to in
+    // place rather than copied.
+    BitSet32 otherIdBits;
+    std::array<const PointerCoords*, MAX_POINTER_ID + 1> otherCoordsById;
     float alpha;
     if (next) {
         // Interpolate between current sample and future sample.
-        // So current->eventTime <= sampleTime <= future.eventTime.
-        future.initializeFrom(*next);
-        other = &future;
-        nsecs_t delta = future.eventTime - current->eventTime;
+        // So current->eventTime <= sampleTime <= next->body.motion.eventTime.
+        for (uint32_t i = 0; i < next->body.motion.pointerCount; i++) {
+            const uint32_t id = next->body.motion.pointers[i].properties.id;
+            otherIdBits.markBit(id);
+            otherCoordsById[id] = &next->body.motion.pointers[i].coords;
+        }
+        nsecs_t delta = next->body.motion.eventTime - current->eventTime;
         if (delta < RESAMPLE_MIN_DELTA) {
             ALOGD_IF(DEBUG_RESAMPLING, "Not resampled, delta time is too small: %" PRId64 " ns.",
                      delta);
@@ -1221,7 +1318,12 @@ void InputConsumer::resampleTouchState(nsecs_t sampleTime, MotionEvent* event,
     } else if (touchState.historySize >= 2) {
         // Extrapolate future sample using current sample and past sample.
         // So other->eventTime <= current->eventTime <= sampleTime.
-        other = touchState.getHistory(1);
+        const History* other = touchState.getHistory(1);
+        for (BitSet32 idBits(other->idBits); !idBits.isEmpty();) {
+            const uint32_t id = idBits.clearFirstMarkedBit();
+            otherIdBits.markBit(id);
+            otherCoordsById[id] = &other->getPointerById(id);
+        }
         nsecs_t delta = current->eventTime - other->eventTime;
         if (delta < RESAMPLE_MIN_DELTA) {
             ALOGD_IF(DEBUG_RESAMPLING, "Not resampled, delta time is too small: %" PRId64 " ns.",
@@ -1277,12 +1379,9 @@ void InputConsumer::resampleTouchState(nsecs_t sampleTime, MotionEvent* event,
         PointerCoords& resampledCoords = touchState.lastResample.pointers[i];
         const PointerCoords& currentCoords = current->getPointerById(id);
         resampledCoords.copyFrom(currentCoords);
-        if (other->idBits.hasBit(id) && shouldResampleTool(event->getToolType(i))) {
-            const PointerCoords& otherCoords = other->getPointerById(id);
-            resampledCoords.setAxisValue(AMOTION_EVENT_AXIS_X,
-                                         lerp(currentCoords.getX(), otherCoords.getX(), alpha));
-            resampledCoords.setAxisValue(AMOTION_EVENT_AXIS_Y,
-                                         lerp(currentCoords.getY(), otherCoords.getY(), alpha));
+        if (otherIdBits.hasBit(id) && shouldResampleTool(event->getToolType(i))) {
+            const PointerCoords& otherCoords = *otherCoordsById[id];
+            lerpXY(currentCoords, otherCoords, alpha, resampledCoords);
             resampledCoords.isResampled = true;
             ALOGD_IF(DEBUG_RESAMPLING,
                      "[%d] - out (%0.3f, %0.3f), cur (%0.3f, %0.3f), "
@@ -1324,13 +1423,21 @@ status_t InputConsumer::sendFinishedSignal(uint32_t seq, bool handled) {
                  mSeqChains.erase(mSeqChains.begin() + i);
              }
         }
-        status_t status = OK;
-        while (!status && chainIndex > 0) {
-            chainIndex--;
-            status = sendUnchainedFinishedSignal(chainSeqs[chainIndex], handled);
+        // Send the signals for the chain, in reverse, and for the last message together.
+        uint32_t seqs[chainIndex + 1];
+        for (size_t i = 0; i < chainIndex; i++) {
+            seqs[i] = chainSeqs[chainIndex - 1 - i];
+        }
+        seqs[chainIndex] = seq;
+        size_t sentCount;
+        status_t status = sendUnchainedFinishedSignals(seqs, chainIndex + 1, handled, &sentCount);
+        if (status && sentCount >= chainIndex) {
+            // Only the signal for the last message was not sent.
+            return status;
         }
         if (status) {
             // An error occurred so at least one signal was not sent, reconstruct the chain.
+            chainIndex -= sentCount + 1;
             for (;;) {
                 SeqChain seqChain;
                 seqChain.seq = chainIndex != 0 ? chainSeqs[chainIndex - 1] : seq;
@@ -1341,6 +1448,7 @@ status_t InputConsumer::sendFinishedSignal(uint32_t seq, bool handled) {
             }
             return status;
         }
+        return OK;
     }
 
     // Send finished signal for the last message in the batch.
@@ -1393,6 +1501,24 @@ status_t InputConsumer::sendUnchainedFinishedSignal(uint32_t seq, bool handled)
     return result;
 }
 
+status_t InputConsumer::sendUnchainedFinishedSignals(const uint32_t* seqs, size_t count,
+                                                     bool handled, size_t* outSentCount) {
+    std::vector<InputMessage> msgs(count);
+    for (size_t i = 0; i < count; i++) {
+        msgs[i].header.type = InputMessage::Type::FINISHED;
+        msgs[i].header.seq = seqs[i];
+        msgs[i].body.finished.handled = handled;
+        msgs[i].body.finished.consumeTime = getConsumeTime(seqs[i]);
+    }
+    status_t result = mChannel->sendMessages(msgs.data(), count, outSentCount);
+    // Only remove the consume times of the messages that were sent, like
+    // sendUnchainedFinishedSignal.
+    for (size_t i = 0; i < *outSentCount; i++) {
+        popConsumeTime(seqs[i]);
+    }
+    return result;
+}
+
 bool InputConsumer::hasPendingBatch() const {
     return !mBatches.empty();
 }
@@ -34,6 +34,8 @@
 #include <utils/Timers.h>
 #include <utils/Tokenizer.h>
 
+#include "ParsedFileCache.h"
+
 // Enables debug output for the parser.
 #define DEBUG_PARSER 0
 
@@ -89,23 +91,36 @@ KeyCharacterMap::KeyCharacterMap(const std::string& filename) : mLoadFileName(fi
 
 base::Result<std::shared_ptr<KeyCharacterMap>> KeyCharacterMap::load(const std::string& filename,
                                                                      Format format) {
-    Tokenizer* tokenizer;
-    status_t status = Tokenizer::open(String8(filename.c_str()), &tokenizer);
-    if (status) {
-        return Errorf("Error {} opening key character map file {}.", status, filename.c_str());
-    }
-    std::shared_ptr<KeyCharacterMap> map =
-            std::shared_ptr<KeyCharacterMap>(new KeyCharacterMap(filename));
-    if (!map.get()) {
-        ALOGE("Error allocating key character map.");
-        return Errorf("Error allocating key character map.");
-    }
-    std::unique_ptr<Tokenizer> t(tokenizer);
-    status = map->load(t.get(), format);
-    if (status == OK) {
-        return map;
-    }
-    return Errorf("Load KeyCharacterMap failed {}.", status);
+    auto parse = [&filename, format]() -> base::Result<std::shared_ptr<KeyCharacterMap>> {
+        Tokenizer* tokenizer;
+        status_t status = Tokenizer::open(String8(filename.c_str()), &tokenizer);
+        if (status) {
+            return Errorf("Error {} opening key character map file {}.", status,
+                          filename.c_str());
+        }
+        std::shared_ptr<KeyCharacterMap> map =
+                std::shared_ptr<KeyCharacterMap>(new KeyCharacterMap(filename));
+        if (!map.get()) {
+            ALOGE("Error allocating key character map.");
+            return Errorf("Error allocating key character map.");
+        }
+        std::unique_ptr<Tokenizer> t(tokenizer);
+        status = map->load(t.get(), format);
+        if (status == OK) {
+            return map;
+        }
+        return Errorf("Load KeyCharacterMap failed {}.", status);
+    };
+
+    // The parse result depends on the format, so each format has its own cache. The cached maps
+    // are never handed out, callers get a copy because overlays and remappings modify the map.
+    static ParsedFileCache<KeyCharacterMap>* caches = new ParsedFileCache<KeyCharacterMap>[3];
+    base::Result<std::shared_ptr<KeyCharacterMap>> cached =
+            caches[static_cast<size_t>(format)].get(filename, parse);
+    if (!cached.ok()) {
+        return cached;
+    }
+    return std::make_shared<KeyCharacterMap>(**cached);
 }
 
 base::Result<std::shared_ptr<KeyCharacterMap>> KeyCharacterMap::loadContents(
@@ -31,9 +31,13 @@
 #include <vintf/VintfObject.h>
 #endif
 
+#include "ParsedFileCache.h"
+
+#include <algorithm>
 #include <cstdlib>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
 /**
  * Log debug output for the parser.
@@ -55,6 +59,9 @@ const bool DEBUG_MAPPING =
 namespace android {
 namespace {
 
+// Scan codes are Linux key codes, so they normally do not exceed KEY_MAX.
+constexpr int32_t MAX_DENSE_SCAN_CODE = 0x2ff;
+
 std::optional<int> parseInt(const char* str) {
     char* end;
     errno = 0;
@@ -136,6 +143,16 @@ base::Result<std::shared_ptr<KeyLayoutMap>> KeyLayoutMap::loadContents(const std
 
 base::Result<std::shared_ptr<KeyLayoutMap>> KeyLayoutMap::load(const std::string& filename,
                                                                const char* contents) {
+    if (contents != nullptr) {
+        return parse(filename, contents);
+    }
+    // Many devices share the same key layout, e.g. Generic.kl, and the map is immutable.
+    static ParsedFileCache<KeyLayoutMap>& cache = *new ParsedFileCache<KeyLayoutMap>();
+    return cache.get(filename, [&filename]() { return parse(filename, nullptr); });
+}
+
+base::Result<std::shared_ptr<KeyLayoutMap>> KeyLayoutMap::parse(const std::string& filename,
+                                                                const char* contents) {
     Tokenizer* tokenizer;
     status_t status;
     if (contents == nullptr) {
@@ -181,6 +198,7 @@ base::Result<std::shared_ptr<KeyLayoutMap>> KeyLayoutMap::load(Tokenizer* tokeni
               elapsedTime / 1000000.0);
 #endif
         if (!status) {
+            map->buildDenseScanCodeTable();
             return std::move(map);
         }
     }
@@ -229,6 +247,13 @@ const KeyLayoutMap::Key* KeyLayoutMap::getKey(int32_t scanCode, int32_t usageCod
         }
     }
     if (scanCode) {
+        if (!mDenseKeysByScanCode.empty()) {
+            if (scanCode > 0 && static_cast<size_t>(scanCode) < mDenseKeysByScanCode.size()) {
+                const Key& key = mDenseKeysByScanCode[scanCode];
+                return key.keyCode >= 0 ? &key : nullptr;
+            }
+            return nullptr;
+        }
         auto it = mKeysByScanCode.find(scanCode);
         if (it != mKeysByScanCode.end()) {
             return &it->second;
@@ -237,6 +262,25 @@ const KeyLayoutMap::Key* KeyLayoutMap::getKey(int32_t scanCode, int32_t usageCod
     return nullptr;
 }
 
+void KeyLayoutMap::buildDenseScanCodeTable() {
+    int32_t maxScanCode = 0;
+    for (const auto& [scanCode, _] : mKeysByScanCode) {
+        if (scanCode <= 0 || scanCode > MAX_DENSE_SCAN_CODE) {
+            // Keep using the hash map for unusual layouts.
+            mDenseKeysByScanCode.clear();
+            return;
+        }
+        maxScanCode = std::max(maxScanCode, scanCode);
+    }
+    if (maxScanCode == 0) {
+        return;
+    }
+    mDenseKeysByScanCode.assign(maxScanCode + 1, Key{-1, 0});
+    for (const auto& [scanCode, key] : mKeysByScanCode) {
+        mDenseKeysByScanCode[scanCode] = key;
+    }
+}
+
 std::vector<int32_t> KeyLayoutMap::findScanCodesForKey(int32_t keyCode) const {
     std::vector<int32_t> scanCodes;
     for (const auto& [scanCode, key] : mKeysByScanCode) {
@@ -18,6 +18,9 @@
 
 #include <input/MotionPredictor.h>
 
+#include <pthread.h>
+#include <sys/resource.h>
+
 #include <cinttypes>
 #include <cmath>
 #include <cstddef>
@@ -26,6 +29,7 @@
 #include <vector>
 
 #include <android-base/strings.h>
+#include <android-base/thread_annotations.h>
 #include <android/input.h>
 #include <log/log.h>
 
@@ -55,14 +59,31 @@ TfLiteMotionPredictorSample::Point convertPrediction(
     return {.x = axisTo.x + x_delta, .y = axisTo.y + y_delta};
 }
 
+// The priority of the inference thread, ANDROID_PRIORITY_DISPLAY. Predictions are needed for the
+// next frame.
+constexpr int INFERENCE_THREAD_PRIORITY = -4;
+
 } // namespace
 
 // --- MotionPredictor ---
 
 MotionPredictor::MotionPredictor(nsecs_t predictionTimestampOffsetNanos,
-                                 std::function<bool()> checkMotionPredictionEnabled)
+                                 std::function<bool()> checkMotionPredictionEnabled,
+                                 bool runInferenceAsynchronously)
       : mPredictionTimestampOffsetNanos(predictionTimestampOffsetNanos),
-        mCheckMotionPredictionEnabled(std::move(checkMotionPredictionEnabled)) {}
+        mCheckMotionPredictionEnabled(std::move(checkMotionPredictionEnabled)),
+        mRunInferenceAsynchronously(runInferenceAsynchronously) {}
+
+MotionPredictor::~MotionPredictor() {
+    if (mInferenceThread.joinable()) {
+        { // acquire lock
+            std::scoped_lock _l(mLock);
+            mStopInference = true;
+        } // release lock
+        mInferenceRequested.notify_one();
+        mInferenceThread.join();
+    }
+}
 
 android::base::Result<void> MotionPredictor::record(const MotionEvent& event) {
     if (mLastEvent && mLastEvent->getDeviceId() != event.getDeviceId()) {
@@ -90,10 +111,20 @@ android::base::Result<void> MotionPredictor::record(const MotionEvent& event) {
         mBuffers = std::make_unique<TfLiteMotionPredictorBuffers>(mModel->inputLength());
     }
 
+    if (mRunInferenceAsynchronously && !mInferenceThread.joinable()) {
+        mInferenceThread = std::thread(&MotionPredictor::runInferenceLoop, this);
+    }
+
     const int32_t action = event.getActionMasked();
     if (action == AMOTION_EVENT_ACTION_UP || action == AMOTION_EVENT_ACTION_CANCEL) {
         ALOGD_IF(isDebug(), "End of event stream");
-        mBuffers->reset();
+        { // acquire lock
+            std::scoped_lock _l(mLock);
+            mBuffers->reset();
+            mInputsChanged = false;
+            mInputGeneration++;
+            mInference.reset();
+        } // release lock
         mLastEvent.reset();
         return {};
     } else if (action != AMOTION_EVENT_ACTION_DOWN && action != AMOTION_EVENT_ACTION_MOVE) {
@@ -114,20 +145,27 @@ android::base::Result<void> MotionPredictor::record(const MotionEvent& event) {
         return {};
     }
 
-    for (size_t i = 0; i <= event.getHistorySize(); ++i) {
-        if (event.isResampled(0, i)) {
-            continue;
+    { // acquire lock
+        std::scoped_lock _l(mLock);
+        for (size_t i = 0; i <= event.getHistorySize(); ++i) {
+            if (event.isResampled(0, i)) {
+                continue;
+            }
+            const PointerCoords* coords = event.getHistoricalRawPointerCoords(0, i);
+            mBuffers->pushSample(event.getHistoricalEventTime(i),
+                                 {
+                                         .position.x = coords->getAxisValue(AMOTION_EVENT_AXIS_X),
+                                         .position.y = coords->getAxisValue(AMOTION_EVENT_AXIS_Y),
+                                         .pressure = event.getHistoricalPressure(0, i),
+                                         .tilt = event.getHistoricalAxisValue(
+                                                 AMOTION_EVENT_AXIS_TILT, 0, i),
+                                         .orientation = event.getHistoricalOrientation(0, i),
+                                 });
+            mInputsChanged = true;
         }
-        const PointerCoords* coords = event.getHistoricalRawPointerCoords(0, i);
-        mBuffers->pushSample(event.getHistoricalEventTime(i),
-                             {
-                                     .position.x = coords->getAxisValue(AMOTION_EVENT_AXIS_X),
-                                     .position.y = coords->getAxisValue(AMOTION_EVENT_AXIS_Y),
-                                     .pressure = event.getHistoricalPressure(0, i),
-                                     .tilt = event.getHistoricalAxisValue(AMOTION_EVENT_AXIS_TILT,
-                                                                          0, i),
-                                     .orientation = event.getHistoricalOrientation(0, i),
-                             });
+    } // release lock
+    if (mRunInferenceAsynchronously) {
+        mInferenceRequested.notify_one();
     }
 
     if (!mLastEvent) {
@@ -144,41 +182,100 @@ android::base::Result<void> MotionPredictor::record(const MotionEvent& event) {
     return {};
 }
 
-std::unique_ptr<MotionEvent> MotionPredictor::predict(nsecs_t timestamp) {
-    if (mBuffers == nullptr || !mBuffers->isReady()) {
-        return nullptr;
+void MotionPredictor::prepareInferenceLocked(Inference& inference) {
+    mBuffers->copyTo(*mModel);
+    mInputsChanged = false;
+    inference.axisFrom = mBuffers->axisFrom().position;
+    inference.axisTo = mBuffers->axisTo().position;
+    inference.lastTimestamp = mBuffers->lastTimestamp();
+
+    if (isDebug()) {
+        ALOGD("axisFrom: %f, %f", inference.axisFrom.x, inference.axisFrom.y);
+        ALOGD("axisTo: %f, %f", inference.axisTo.x, inference.axisTo.y);
+        ALOGD("mInputR: %s", base::Join(mModel->inputR(), ", ").c_str());
+        ALOGD("mInputPhi: %s", base::Join(mModel->inputPhi(), ", ").c_str());
+        ALOGD("mInputPressure: %s", base::Join(mModel->inputPressure(), ", ").c_str());
+        ALOGD("mInputTilt: %s", base::Join(mModel->inputTilt(), ", ").c_str());
+        ALOGD("mInputOrientation: %s", base::Join(mModel->inputOrientation(), ", ").c_str());
     }
+}
 
-    LOG_ALWAYS_FATAL_IF(!mModel);
-    mBuffers->copyTo(*mModel);
+void MotionPredictor::invokeModel(Inference& inference) {
     LOG_ALWAYS_FATAL_IF(!mModel->invoke());
 
     // Read out the predictions.
     const std::span<const float> predictedR = mModel->outputR();
     const std::span<const float> predictedPhi = mModel->outputPhi();
     const std::span<const float> predictedPressure = mModel->outputPressure();
-
-    TfLiteMotionPredictorSample::Point axisFrom = mBuffers->axisFrom().position;
-    TfLiteMotionPredictorSample::Point axisTo = mBuffers->axisTo().position;
+    inference.r.assign(predictedR.begin(), predictedR.end());
+    inference.phi.assign(predictedPhi.begin(), predictedPhi.end());
+    inference.pressure.assign(predictedPressure.begin(), predictedPressure.end());
 
     if (isDebug()) {
-        ALOGD("axisFrom: %f, %f", axisFrom.x, axisFrom.y);
-        ALOGD("axisTo: %f, %f", axisTo.x, axisTo.y);
-        ALOGD("mInputR: %s", base::Join(mModel->inputR(), ", ").c_str());
-        ALOGD("mInputPhi: %s", base::Join(mModel->inputPhi(), ", ").c_str());
-        ALOGD("mInputPressure: %s", base::Join(mModel->inputPressure(), ", ").c_str());
-        ALOGD("mInputTilt: %s", base::Join(mModel->inputTilt(), ", ").c_str());
-        ALOGD("mInputOrientation: %s", base::Join(mModel->inputOrientation(), ", ").c_str());
         ALOGD("predictedR: %s", base::Join(predictedR, ", ").c_str());
         ALOGD("predictedPhi: %s", base::Join(predictedPhi, ", ").c_str());
         ALOGD("predictedPressure: %s", base::Join(predictedPressure, ", ").c_str());
     }
+}
+
+void MotionPredictor::runInferenceLoop() {
+    pthread_setname_np(pthread_self(), "MotionPredictor");
+    if (setpriority(PRIO_PROCESS, /*who=*/0, INFERENCE_THREAD_PRIORITY) != 0) {
+        ALOGD_IF(isDebug(), "Could not raise the priority of the inference thread");
+    }
+
+    // The inference that is being run, swapped with mInference once done to reuse its storage.
+    Inference pending;
+    std::unique_lock lock(mLock);
+    while (true) {
+        base::ScopedLockAssertion assumeLocked(mLock);
+        mInferenceRequested.wait(lock, [this]() REQUIRES(mLock) {
+            return mStopInference || (mInputsChanged && mBuffers->isReady());
+        });
+        if (mStopInference) {
+            return;
+        }
+        prepareInferenceLocked(pending);
+        const uint64_t generation = mInputGeneration;
+
+        // Don't block record() while the model runs.
+        lock.unlock();
+        invokeModel(pending);
+        lock.lock();
+
+        if (generation == mInputGeneration) {
+            if (!mInference) {
+                mInference.emplace();
+            }
+            std::swap(*mInference, pending);
+        }
+    }
+}
+
+std::unique_ptr<MotionEvent> MotionPredictor::predict(nsecs_t timestamp) {
+    std::scoped_lock _l(mLock);
+    if (!mRunInferenceAsynchronously && mInputsChanged && mBuffers->isReady()) {
+        // Only run the model when samples were recorded since the last prediction, the result
+        // would be the same otherwise.
+        LOG_ALWAYS_FATAL_IF(!mModel);
+        Inference& inference = mInference ? *mInference : mInference.emplace();
+        prepareInferenceLocked(inference);
+        invokeModel(inference);
+    }
+    if (!mInference) {
+        return nullptr;
+    }
+    const std::span<const float> predictedR = mInference->r;
+    const std::span<const float> predictedPhi = mInference->phi;
+    const std::span<const float> predictedPressure = mInference->pressure;
+    TfLiteMotionPredictorSample::Point axisFrom = mInference->axisFrom;
+    TfLiteMotionPredictorSample::Point axisTo = mInference->axisTo;
 
     LOG_ALWAYS_FATAL_IF(!mLastEvent);
     const MotionEvent& event = *mLastEvent;
     bool hasPredictions = false;
     std::unique_ptr<MotionEvent> prediction = std::make_unique<MotionEvent>();
-    int64_t predictionTime = mBuffers->lastTimestamp();
+    int64_t predictionTime = mInference->lastTimestamp;
     const int64_t futureTime = timestamp + mPredictionTimestampOffsetNanos;
 
     for (int i = 0; i < predictedR.size() && predictionTime <= futureTime; ++i) {
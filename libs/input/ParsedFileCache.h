@@ -0,0 +1,104 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <android-base/result.h>
+#include <android-base/thread_annotations.h>
+#include <sys/stat.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace android {
+
+/**
+ * Process-wide cache of the objects parsed from configuration files, such as key layout and key
+ * character maps, so that a file used by many devices is parsed only once.
+ *
+ * Entries are keyed by path and remember the identity and modification time of the file they
+ * were parsed from, a file that changed is parsed again. Only successful parses are cached.
+ * Different files may be parsed concurrently, but a file is only parsed by one thread at a time.
+ */
+template <typename T>
+class ParsedFileCache {
+public:
+    /**
+     * Returns the cached object for the file, or calls parse() to parse it. The returned object is
+     * shared with every caller, it must not be modified.
+     */
+    template <typename Parse>
+    base::Result<std::shared_ptr<T>> get(const std::string& filename, Parse parse) {
+        struct stat st;
+        if (stat(filename.c_str(), &st) != 0) {
+            // Let the parser report the error.
+            return parse();
+        }
+        const FileStamp stamp = FileStamp::from(st);
+
+        std::shared_ptr<Entry> entry;
+        { // acquire lock
+            std::scoped_lock _l(mLock);
+            std::shared_ptr<Entry>& slot = mEntries[filename];
+            if (slot == nullptr) {
+                slot = std::make_shared<Entry>();
+            }
+            entry = slot;
+        } // release lock
+
+        std::scoped_lock _l(entry->lock);
+        if (entry->value != nullptr && entry->stamp == stamp) {
+            return entry->value;
+        }
+        base::Result<std::shared_ptr<T>> result = parse();
+        if (result.ok()) {
+            entry->stamp = stamp;
+            entry->value = *result;
+        }
+        return result;
+    }
+
+private:
+    struct FileStamp {
+        dev_t device;
+        ino_t inode;
+        off_t size;
+        timespec modificationTime;
+
+        static FileStamp from(const struct stat& st) {
+            return {st.st_dev, st.st_ino, st.st_size, st.st_mtim};
+        }
+
+        bool operator==(const FileStamp& other) const {
+            return device == other.device && inode == other.inode && size == other.size &&
+                    modificationTime.tv_sec == other.modificationTime.tv_sec &&
+                    modificationTime.tv_nsec == other.modificationTime.tv_nsec;
+        }
+    };
+
+    struct Entry {
+        std::mutex lock;
+        FileStamp stamp GUARDED_BY(lock) = {};
+        std::shared_ptr<T> value GUARDED_BY(lock);
+    };
+
+    std::mutex mLock;
+    std::unordered_map<std::string, std::shared_ptr<Entry>> mEntries GUARDED_BY(mLock);
+};
+
+} // namespace android
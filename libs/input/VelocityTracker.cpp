@@ -23,6 +23,7 @@
 #include <limits.h>
 #include <math.h>
 #include <optional>
+#include <span>
 
 #include <android-base/stringprintf.h>
 #include <input/PrintTools.h>
@@ -117,7 +118,7 @@ static std::string vectorToString(const float* a, uint32_t m) {
     return str;
 }
 
-static std::string vectorToString(const std::vector<float>& v) {
+static std::string vectorToString(std::span<const float> v) {
     return vectorToString(v.data(), v.size());
 }
 
@@ -390,21 +391,25 @@ LeastSquaresVelocityTrackerStrategy::~LeastSquaresVelocityTrackerStrategy() {
 }
 
 void LeastSquaresVelocityTrackerStrategy::clearPointer(int32_t pointerId) {
-    mIndex.erase(pointerId);
-    mMovements.erase(pointerId);
+    mPointerIdBits.clearBit(pointerId);
 }
 
 void LeastSquaresVelocityTrackerStrategy::addMovement(nsecs_t eventTime, int32_t pointerId,
                                                       float position) {
     // If data for this pointer already exists, we have a valid entry at the position of
-    // mIndex[pointerId] and mMovements[pointerId]. In that case, we need to advance the index
+    // mIndex[pointerId] in mMovements[pointerId]. In that case, we need to advance the index
     // to the next position in the circular buffer and write the new Movement there. Otherwise,
-    // if this is a first movement for this pointer, we initialize the maps mIndex and mMovements
-    // for this pointer and write to the first position.
-    auto [movementIt, inserted] = mMovements.insert({pointerId, {}});
-    auto [indexIt, _] = mIndex.insert({pointerId, 0});
-    size_t& index = indexIt->second;
-    if (!inserted && movementIt->second[index].eventTime != eventTime) {
+    // if this is a first movement for this pointer, we reset its history and write to the first
+    // position.
+    std::array<Movement, HISTORY_SIZE>& movements = mMovements[pointerId];
+    size_t& index = mIndex[pointerId];
+    const bool inserted = !mPointerIdBits.hasBit(pointerId);
+    if (inserted) {
+        mPointerIdBits.markBit(pointerId);
+        movements = {};
+        index = 0;
+    }
+    if (!inserted && movements[index].eventTime != eventTime) {
         // When ACTION_POINTER_DOWN happens, we will first receive ACTION_MOVE with the coordinates
         // of the existing pointers, and then ACTION_POINTER_DOWN with the coordinates that include
         // the new pointer. If the eventtimes for both events are identical, just update the data
@@ -417,7 +422,7 @@ void LeastSquaresVelocityTrackerStrategy::addMovement(nsecs_t eventTime, int32_t
         index = 0;
     }
 
-    Movement& movement = movementIt->second[index];
+    Movement& movement = movements[index];
     movement.eventTime = eventTime;
     movement.position = position;
 }
@@ -471,8 +476,8 @@ void LeastSquaresVelocityTrackerStrategy::addMovement(nsecs_t eventTime, int32_t
  * http://en.wikipedia.org/wiki/Numerical_methods_for_linear_least_squares
  * http://en.wikipedia.org/wiki/Gram-Schmidt
  */
-static bool solveLeastSquares(const std::vector<float>& x, const std::vector<float>& y,
-                              const std::vector<float>& w, uint32_t n,
+static bool solveLeastSquares(std::span<const float> x, std::span<const float> y,
+                              std::span<const float> w, uint32_t n,
                               std::array<float, VelocityTracker::Estimator::MAX_DEGREE + 1>& outB,
                               float* outDet) {
     const size_t m = x.size();
@@ -594,7 +599,7 @@ static bool solveLeastSquares(const std::vector<float>& x, const std::vector<flo
  * the default implementation
  */
 static std::optional<std::array<float, 3>> solveUnweightedLeastSquaresDeg2(
-        const std::vector<float>& x, const std::vector<float>& y) {
+        std::span<const float> x, std::span<const float> y) {
     const size_t count = x.size();
     LOG_ALWAYS_FATAL_IF(count != y.size(), "Mismatching array sizes");
     // Solving y = a*x^2 + b*x + c
@@ -645,19 +650,20 @@ static std::optional<std::array<float, 3>> solveUnweightedLeastSquaresDeg2(
 
 std::optional<VelocityTracker::Estimator> LeastSquaresVelocityTrackerStrategy::getEstimator(
         int32_t pointerId) const {
-    const auto movementIt = mMovements.find(pointerId);
-    if (movementIt == mMovements.end()) {
+    if (!mPointerIdBits.hasBit(pointerId)) {
         return std::nullopt; // no data
     }
+    const std::array<Movement, HISTORY_SIZE>& movements = mMovements[pointerId];
     // Iterate over movement samples in reverse time order and collect samples.
-    std::vector<float> positions;
-    std::vector<float> w;
-    std::vector<float> time;
+    float positions[HISTORY_SIZE];
+    float w[HISTORY_SIZE];
+    float time[HISTORY_SIZE];
+    size_t m = 0; // number of points that will be used for fitting
 
-    uint32_t index = mIndex.at(pointerId);
-    const Movement& newestMovement = movementIt->second[index];
+    uint32_t index = mIndex[pointerId];
+    const Movement& newestMovement = movements[index];
     do {
-        const Movement& movement = movementIt->second[index];
+        const Movement& movement = movements[index];
 
         nsecs_t age = newestMovement.eventTime - movement.eventTime;
         if (age > HORIZON) {
@@ -675,13 +681,13 @@ std::optional<VelocityTracker::Estimator> LeastSquaresVelocityTrackerStrategy::g
             // In practice, time will never be 0.
             break;
         }
-        positions.push_back(movement.position);
-        w.push_back(chooseWeight(pointerId, index));
-        time.push_back(-age * 0.000000001f);
+        positions[m] = movement.position;
+        w[m] = chooseWeight(pointerId, index);
+        time[m] = -age * 0.000000001f;
+        m++;
         index = (index == 0 ? HISTORY_SIZE : index) - 1;
-    } while (positions.size() < HISTORY_SIZE);
+    } while (m < HISTORY_SIZE);
 
-    const size_t m = positions.size();
     if (m == 0) {
         return std::nullopt; // no data
     }
@@ -695,7 +701,7 @@ std::optional<VelocityTracker::Estimator> LeastSquaresVelocityTrackerStrategy::g
     if (degree == 2 && mWeighting == Weighting::NONE) {
         // Optimize unweighted, quadratic polynomial fit
         std::optional<std::array<float, 3>> coeff =
-                solveUnweightedLeastSquaresDeg2(time, positions);
+                solveUnweightedLeastSquaresDeg2({time, m}, {positions, m});
         if (coeff) {
             VelocityTracker::Estimator estimator;
             estimator.time = newestMovement.eventTime;
@@ -711,7 +717,7 @@ std::optional<VelocityTracker::Estimator> LeastSquaresVelocityTrackerStrategy::g
         float det;
         uint32_t n = degree + 1;
         VelocityTracker::Estimator estimator;
-        if (solveLeastSquares(time, positions, w, n, estimator.coeff, &det)) {
+        if (solveLeastSquares({time, m}, {positions, m}, {w, m}, n, estimator.coeff, &det)) {
             estimator.time = newestMovement.eventTime;
             estimator.degree = degree;
             estimator.confidence = det;
@@ -734,14 +740,14 @@ std::optional<VelocityTracker::Estimator> LeastSquaresVelocityTrackerStrategy::g
 }
 
 float LeastSquaresVelocityTrackerStrategy::chooseWeight(int32_t pointerId, uint32_t index) const {
-    const std::array<Movement, HISTORY_SIZE>& movements = mMovements.at(pointerId);
+    const std::array<Movement, HISTORY_SIZE>& movements = mMovements[pointerId];
     switch (mWeighting) {
         case Weighting::DELTA: {
             // Weight points based on how much time elapsed between them and the next
             // point so that points that "cover" a shorter time span are weighed less.
             //   delta  0ms: 0.5
             //   delta 10ms: 1.0
-            if (index == mIndex.at(pointerId)) {
+            if (index == mIndex[pointerId]) {
                 return 1.0f;
             }
             uint32_t nextIndex = (index + 1) % HISTORY_SIZE;
@@ -763,7 +769,7 @@ float LeastSquaresVelocityTrackerStrategy::chooseWeight(int32_t pointerId, uint3
             //   age 50ms: 1.0
             //   age 60ms: 0.5
             float ageMillis =
-                    (movements[mIndex.at(pointerId)].eventTime - movements[index].eventTime) *
+                    (movements[mIndex[pointerId]].eventTime - movements[index].eventTime) *
                     0.000001f;
             if (ageMillis < 0) {
                 return 0.5f;
@@ -786,7 +792,7 @@ float LeastSquaresVelocityTrackerStrategy::chooseWeight(int32_t pointerId, uint3
             //   age  50ms: 1.0
             //   age 100ms: 0.5
             float ageMillis =
-                    (movements[mIndex.at(pointerId)].eventTime - movements[index].eventTime) *
+                    (movements[mIndex[pointerId]].eventTime - movements[index].eventTime) *
                     0.000001f;
             if (ageMillis < 50) {
                 return 1.0f;
@@ -902,21 +908,25 @@ LegacyVelocityTrackerStrategy::~LegacyVelocityTrackerStrategy() {
 }
 
 void LegacyVelocityTrackerStrategy::clearPointer(int32_t pointerId) {
-    mIndex.erase(pointerId);
-    mMovements.erase(pointerId);
+    mPointerIdBits.clearBit(pointerId);
 }
 
 void LegacyVelocityTrackerStrategy::addMovement(nsecs_t eventTime, int32_t pointerId,
                                                 float position) {
     // If data for this pointer already exists, we have a valid entry at the position of
-    // mIndex[pointerId] and mMovements[pointerId]. In that case, we need to advance the index
+    // mIndex[pointerId] in mMovements[pointerId]. In that case, we need to advance the index
     // to the next position in the circular buffer and write the new Movement there. Otherwise,
-    // if this is a first movement for this pointer, we initialize the maps mIndex and mMovements
-    // for this pointer and write to the first position.
-    auto [movementIt, inserted] = mMovements.insert({pointerId, {}});
-    auto [indexIt, _] = mIndex.insert({pointerId, 0});
-    size_t& index = indexIt->second;
-    if (!inserted && movementIt->second[index].eventTime != eventTime) {
+    // if this is a first movement for this pointer, we reset its history and write to the first
+    // position.
+    std::array<Movement, HISTORY_SIZE>& movements = mMovements[pointerId];
+    size_t& index = mIndex[pointerId];
+    const bool inserted = !mPointerIdBits.hasBit(pointerId);
+    if (inserted) {
+        mPointerIdBits.markBit(pointerId);
+        movements = {};
+        index = 0;
+    }
+    if (!inserted && movements[index].eventTime != eventTime) {
         // When ACTION_POINTER_DOWN happens, we will first receive ACTION_MOVE with the coordinates
         // of the existing pointers, and then ACTION_POINTER_DOWN with the coordinates that include
         // the new pointer. If the eventtimes for both events are identical, just update the data
@@ -929,26 +939,26 @@ void LegacyVelocityTrackerStrategy::addMovement(nsecs_t eventTime, int32_t point
         index = 0;
     }
 
-    Movement& movement = movementIt->second[index];
+    Movement& movement = movements[index];
     movement.eventTime = eventTime;
     movement.position = position;
 }
 
 std::optional<VelocityTracker::Estimator> LegacyVelocityTrackerStrategy::getEstimator(
         int32_t pointerId) const {
-    const auto movementIt = mMovements.find(pointerId);
-    if (movementIt == mMovements.end()) {
+    if (!mPointerIdBits.hasBit(pointerId)) {
         return std::nullopt; // no data
     }
-    const Movement& newestMovement = movementIt->second[mIndex.at(pointerId)];
+    const std::array<Movement, HISTORY_SIZE>& movements = mMovements[pointerId];
+    const Movement& newestMovement = movements[mIndex[pointerId]];
 
     // Find the oldest sample that contains the pointer and that is not older than HORIZON.
     nsecs_t minTime = newestMovement.eventTime - HORIZON;
-    uint32_t oldestIndex = mIndex.at(pointerId);
+    uint32_t oldestIndex = mIndex[pointerId];
     uint32_t numTouches = 1;
     do {
         uint32_t nextOldestIndex = (oldestIndex == 0 ? HISTORY_SIZE : oldestIndex) - 1;
-        const Movement& nextOldestMovement = mMovements.at(pointerId)[nextOldestIndex];
+        const Movement& nextOldestMovement = movements[nextOldestIndex];
         if (nextOldestMovement.eventTime < minTime) {
             break;
         }
@@ -969,7 +979,7 @@ std::optional<VelocityTracker::Estimator> LegacyVelocityTrackerStrategy::getEsti
     float accumV = 0;
     uint32_t index = oldestIndex;
     uint32_t samplesUsed = 0;
-    const Movement& oldestMovement = mMovements.at(pointerId)[oldestIndex];
+    const Movement& oldestMovement = movements[oldestIndex];
     float oldestPosition = oldestMovement.position;
     nsecs_t lastDuration = 0;
 
@@ -977,7 +987,7 @@ std::optional<VelocityTracker::Estimator> LegacyVelocityTrackerStrategy::getEsti
         if (++index == HISTORY_SIZE) {
             index = 0;
         }
-        const Movement& movement = mMovements.at(pointerId)[index];
+        const Movement& movement = movements[index];
         nsecs_t duration = movement.eventTime - oldestMovement.eventTime;
 
         // If the duration between samples is small, we may significantly overestimate
@@ -1017,21 +1027,25 @@ ImpulseVelocityTrackerStrategy::~ImpulseVelocityTrackerStrategy() {
 }
 
 void ImpulseVelocityTrackerStrategy::clearPointer(int32_t pointerId) {
-    mIndex.erase(pointerId);
-    mMovements.erase(pointerId);
+    mPointerIdBits.clearBit(pointerId);
 }
 
 void ImpulseVelocityTrackerStrategy::addMovement(nsecs_t eventTime, int32_t pointerId,
                                                  float position) {
     // If data for this pointer already exists, we have a valid entry at the position of
-    // mIndex[pointerId] and mMovements[pointerId]. In that case, we need to advance the index
+    // mIndex[pointerId] in mMovements[pointerId]. In that case, we need to advance the index
     // to the next position in the circular buffer and write the new Movement there. Otherwise,
-    // if this is a first movement for this pointer, we initialize the maps mIndex and mMovements
-    // for this pointer and write to the first position.
-    auto [movementIt, inserted] = mMovements.insert({pointerId, {}});
-    auto [indexIt, _] = mIndex.insert({pointerId, 0});
-    size_t& index = indexIt->second;
-    if (!inserted && movementIt->second[index].eventTime != eventTime) {
+    // if this is a first movement for this pointer, we reset its history and write to the first
+    // position.
+    std::array<Movement, HISTORY_SIZE>& movements = mMovements[pointerId];
+    size_t& index = mIndex[pointerId];
+    const bool inserted = !mPointerIdBits.hasBit(pointerId);
+    if (inserted) {
+        mPointerIdBits.markBit(pointerId);
+        movements = {};
+        index = 0;
+    }
+    if (!inserted && movements[index].eventTime != eventTime) {
         // When ACTION_POINTER_DOWN happens, we will first receive ACTION_MOVE with the coordinates
         // of the existing pointers, and then ACTION_POINTER_DOWN with the coordinates that include
         // the new pointer. If the eventtimes for both events are identical, just update the data
@@ -1044,7 +1058,7 @@ void ImpulseVelocityTrackerStrategy::addMovement(nsecs_t eventTime, int32_t poin
         index = 0;
     }
 
-    Movement& movement = movementIt->second[index];
+    Movement& movement = movements[index];
     movement.eventTime = eventTime;
     movement.position = position;
 }
@@ -1176,19 +1190,19 @@ static float calculateImpulseVelocity(const nsecs_t* t, const float* x, size_t c
 
 std::optional<VelocityTracker::Estimator> ImpulseVelocityTrackerStrategy::getEstimator(
         int32_t pointerId) const {
-    const auto movementIt = mMovements.find(pointerId);
-    if (movementIt == mMovements.end()) {
+    if (!mPointerIdBits.hasBit(pointerId)) {
         return std::nullopt; // no data
     }
+    const std::array<Movement, HISTORY_SIZE>& movements = mMovements[pointerId];
 
     // Iterate over movement samples in reverse time order and collect samples.
     float positions[HISTORY_SIZE];
     nsecs_t time[HISTORY_SIZE];
     size_t m = 0; // number of points that will be used for fitting
-    size_t index = mIndex.at(pointerId);
-    const Movement& newestMovement = movementIt->second[index];
+    size_t index = mIndex[pointerId];
+    const Movement& newestMovement = movements[index];
     do {
-        const Movement& movement = movementIt->second[index];
+        const Movement& movement = movements[index];
 
         nsecs_t age = newestMovement.eventTime - movement.eventTime;
         if (age > HORIZON) {
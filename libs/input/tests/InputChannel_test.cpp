@@ -195,6 +195,36 @@ TEST_F(InputChannelTest, SendAndReceive_MotionClassification) {
     }
 }
 
+TEST_F(InputChannelTest, SendMessages_SendsAllMessagesInOrder) {
+    std::unique_ptr<InputChannel> serverChannel, clientChannel;
+    status_t result = InputChannel::openInputChannelPair("channel name",
+            serverChannel, clientChannel);
+    ASSERT_EQ(OK, result)
+            << "should have successfully opened a channel pair";
+
+    std::array<InputMessage, 3> clientMsgs = {};
+    for (size_t i = 0; i < clientMsgs.size(); i++) {
+        clientMsgs[i].header.type = InputMessage::Type::FINISHED;
+        clientMsgs[i].header.seq = i + 1;
+        clientMsgs[i].body.finished.handled = true;
+    }
+
+    size_t sentCount;
+    EXPECT_EQ(OK, clientChannel->sendMessages(clientMsgs.data(), clientMsgs.size(), &sentCount))
+            << "client channel should be able to send messages to server channel";
+    EXPECT_EQ(clientMsgs.size(), sentCount);
+
+    InputMessage serverMsg;
+    for (const InputMessage& clientMsg : clientMsgs) {
+        EXPECT_EQ(OK, serverChannel->receiveMessage(&serverMsg))
+                << "server channel should be able to receive message from client channel";
+        EXPECT_EQ(clientMsg.header.type, serverMsg.header.type);
+        EXPECT_EQ(clientMsg.header.seq, serverMsg.header.seq);
+    }
+    EXPECT_EQ(WOULD_BLOCK, serverChannel->receiveMessage(&serverMsg))
+            << "server channel should not have received more messages";
+}
+
 TEST_F(InputChannelTest, InputChannelParcelAndUnparcel) {
     std::unique_ptr<InputChannel> serverChannel, clientChannel;
 
@@ -169,4 +169,80 @@ TEST(InputDeviceKeyLayoutTest, LoadsWhenRequiredKernelConfigIsPresent) {
     ASSERT_NE(nullptr, map) << "Map should be valid because CONFIG_UHID should always be present";
 }
 
+TEST(InputDeviceKeyLayoutTest, SharesTheMapOfAFileThatWasAlreadyLoaded) {
+#if !defined(__ANDROID__)
+    GTEST_SKIP() << "Can't check kernel configs on host";
+#endif
+    std::string klPath = base::GetExecutableDirectory() + "/data/kl_with_required_real_config.kl";
+    base::Result<std::shared_ptr<KeyLayoutMap>> first = KeyLayoutMap::load(klPath);
+    ASSERT_TRUE(first.ok()) << "Cannot load KeyLayout at " << klPath;
+    base::Result<std::shared_ptr<KeyLayoutMap>> second = KeyLayoutMap::load(klPath);
+    ASSERT_TRUE(second.ok()) << "Cannot load KeyLayout at " << klPath;
+    ASSERT_EQ(*first, *second);
+}
+
+TEST(InputDeviceKeyLayoutTest, MapsScanCodesAndUsages) {
+    base::Result<std::shared_ptr<KeyLayoutMap>> ret =
+            KeyLayoutMap::loadContents("test.kl",
+                                       "key 30 A\n"
+                                       "key 113 VOLUME_MUTE WAKE\n"
+                                       "key usage 0x0c0067 WINDOW\n");
+    ASSERT_TRUE(ret.ok());
+    const std::shared_ptr<KeyLayoutMap>& map = *ret;
+
+    int32_t keyCode;
+    uint32_t flags;
+    ASSERT_EQ(NO_ERROR, map->mapKey(30, 0, &keyCode, &flags));
+    EXPECT_EQ(AKEYCODE_A, keyCode);
+    EXPECT_EQ(0u, flags);
+    ASSERT_EQ(NO_ERROR, map->mapKey(113, 0, &keyCode, &flags));
+    EXPECT_EQ(AKEYCODE_VOLUME_MUTE, keyCode);
+    EXPECT_EQ(static_cast<uint32_t>(POLICY_FLAG_WAKE), flags);
+    // A usage mapping takes precedence over the scan code.
+    ASSERT_EQ(NO_ERROR, map->mapKey(30, 0x0c0067, &keyCode, &flags));
+    EXPECT_EQ(AKEYCODE_WINDOW, keyCode);
+
+    EXPECT_EQ(NAME_NOT_FOUND, map->mapKey(31, 0, &keyCode, &flags));
+    EXPECT_EQ(AKEYCODE_UNKNOWN, keyCode);
+    EXPECT_EQ(NAME_NOT_FOUND, map->mapKey(114, 0, &keyCode, &flags));
+    EXPECT_EQ(NAME_NOT_FOUND, map->mapKey(-1, 0, &keyCode, &flags));
+}
+
+TEST(InputDeviceKeyLayoutTest, MapsScanCodesBeyondKeyMax) {
+    base::Result<std::shared_ptr<KeyLayoutMap>> ret =
+            KeyLayoutMap::loadContents("test.kl",
+                                       "key 30 A\n"
+                                       "key 100000 B\n");
+    ASSERT_TRUE(ret.ok());
+    const std::shared_ptr<KeyLayoutMap>& map = *ret;
+
+    int32_t keyCode;
+    uint32_t flags;
+    ASSERT_EQ(NO_ERROR, map->mapKey(30, 0, &keyCode, &flags));
+    EXPECT_EQ(AKEYCODE_A, keyCode);
+    ASSERT_EQ(NO_ERROR, map->mapKey(100000, 0, &keyCode, &flags));
+    EXPECT_EQ(AKEYCODE_B, keyCode);
+    EXPECT_EQ(NAME_NOT_FOUND, map->mapKey(31, 0, &keyCode, &flags));
+}
+
+TEST(InputDeviceKeyCharacterMapTest, LoadingAFileAgainReturnsAnUnmodifiedCopy) {
+    std::string frenchPath = base::GetExecutableDirectory() + "/data/french.kcm";
+    std::string germanPath = base::GetExecutableDirectory() + "/data/german.kcm";
+    base::Result<std::shared_ptr<KeyCharacterMap>> first =
+            KeyCharacterMap::load(frenchPath, KeyCharacterMap::Format::OVERLAY);
+    ASSERT_TRUE(first.ok()) << "Cannot load KeyCharacterMap at " << frenchPath;
+    base::Result<std::shared_ptr<KeyCharacterMap>> german =
+            KeyCharacterMap::load(germanPath, KeyCharacterMap::Format::OVERLAY);
+    ASSERT_TRUE(german.ok()) << "Cannot load KeyCharacterMap at " << germanPath;
+    const KeyCharacterMap original = **first;
+
+    // Modifying a loaded map must not affect the maps loaded later.
+    (*first)->combine(**german);
+    base::Result<std::shared_ptr<KeyCharacterMap>> second =
+            KeyCharacterMap::load(frenchPath, KeyCharacterMap::Format::OVERLAY);
+    ASSERT_TRUE(second.ok()) << "Cannot load KeyCharacterMap at " << frenchPath;
+    ASSERT_NE(*first, *second);
+    ASSERT_EQ(original, **second);
+}
+
 } // namespace android
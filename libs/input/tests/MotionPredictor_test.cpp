@@ -15,6 +15,7 @@
  */
 
 #include <chrono>
+#include <thread>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -108,6 +109,27 @@ TEST(MotionPredictorTest, FollowsGesture) {
     EXPECT_EQ(nullptr, predictor.predict(20 * NSEC_PER_MSEC));
 }
 
+TEST(MotionPredictorTest, AsynchronousInferenceFollowsGesture) {
+    MotionPredictor predictor(/*predictionTimestampOffsetNanos=*/0,
+                              []() { return true /*enable prediction*/; },
+                              /*runInferenceAsynchronously=*/true);
+
+    predictor.record(getMotionEvent(DOWN, 2, 5, 20ms));
+    predictor.record(getMotionEvent(MOVE, 2, 7, 30ms));
+    predictor.record(getMotionEvent(MOVE, 3, 9, 40ms));
+    // The prediction becomes available once the inference thread has run the model.
+    std::unique_ptr<MotionEvent> predicted;
+    const auto deadline = std::chrono::steady_clock::now() + 1s;
+    while (predicted == nullptr && std::chrono::steady_clock::now() < deadline) {
+        predicted = predictor.predict(50 * NSEC_PER_MSEC);
+        std::this_thread::sleep_for(1ms);
+    }
+    EXPECT_NE(nullptr, predicted);
+
+    predictor.record(getMotionEvent(UP, 4, 11, 50ms));
+    EXPECT_EQ(nullptr, predictor.predict(20 * NSEC_PER_MSEC));
+}
+
 TEST(MotionPredictorTest, MultipleDevicesNotSupported) {
     MotionPredictor predictor(/*predictionTimestampOffsetNanos=*/0,
                               []() { return true /*enable prediction*/; });
@@ -23,6 +23,7 @@
 
 #include <android-base/stringprintf.h>
 #include <attestation/HmacKeyManager.h>
+#include <ftl/enum.h>
 #include <gtest/gtest.h>
 #include <gui/constants.h>
 #include <input/VelocityTracker.h>
@@ -481,6 +482,27 @@ TEST_F(VelocityTrackerTest, TestApiInteractionsWithNoMotionEvents) {
     vt.clear();
 }
 
+TEST_F(VelocityTrackerTest, ClearedPointerStartsWithAnEmptyHistory) {
+    for (VelocityTracker::Strategy strategy :
+         {VelocityTracker::Strategy::LSQ2, VelocityTracker::Strategy::IMPULSE,
+          VelocityTracker::Strategy::LEGACY}) {
+        VelocityTracker vt(strategy);
+        vt.addMovement(0, DEFAULT_POINTER_ID, AMOTION_EVENT_AXIS_X, 0);
+        vt.addMovement(10'000'000, DEFAULT_POINTER_ID, AMOTION_EVENT_AXIS_X, 100);
+        vt.addMovement(20'000'000, DEFAULT_POINTER_ID, AMOTION_EVENT_AXIS_X, 200);
+        vt.clearPointer(DEFAULT_POINTER_ID);
+
+        // The movements from before the pointer was cleared are within the horizon, but must not
+        // contribute to the velocity.
+        vt.addMovement(30'000'000, DEFAULT_POINTER_ID, AMOTION_EVENT_AXIS_X, 500);
+        vt.addMovement(40'000'000, DEFAULT_POINTER_ID, AMOTION_EVENT_AXIS_X, 500);
+        vt.addMovement(50'000'000, DEFAULT_POINTER_ID, AMOTION_EVENT_AXIS_X, 500);
+        std::optional<float> velocity = vt.getVelocity(AMOTION_EVENT_AXIS_X, DEFAULT_POINTER_ID);
+        ASSERT_TRUE(velocity) << ftl::enum_string(strategy);
+        EXPECT_NEAR(0, *velocity, 0.01) << ftl::enum_string(strategy);
+    }
+}
+
 TEST_F(VelocityTrackerTest, ThreePointsPositiveVelocityTest) {
     // Same coordinate is reported 2 times in a row
     // It is difficult to determine the correct answer here, but at least the direction
@@ -530,6 +530,27 @@ CONSTEXPR typename TMat44<T>::col_type PURE operator *(const TMat44<T>& lhs, con
     return result;
 }
 
+#if defined(__clang__) || defined(__GNUC__)
+// float mat44 * vec4, the inner loop of every float mat44 * mat44 product. The result is a linear
+// combination of the columns, which maps directly onto 4-wide NEON or SSE multiply-adds through the
+// compiler's vector extensions.
+inline TVec4<float> PURE operator *(const TMat44<float>& lhs, const TVec4<float>& rhs) {
+    typedef float float4 __attribute__((vector_size(16)));
+    static_assert(sizeof(TVec4<float>) == sizeof(float4), "TVec4<float> must be 4 packed floats");
+
+    float4 columns[TMat44<float>::NUM_COLS];
+    __builtin_memcpy(columns, &lhs[0], sizeof(columns));
+    const float4 x = {rhs.x, rhs.x, rhs.x, rhs.x};
+    const float4 y = {rhs.y, rhs.y, rhs.y, rhs.y};
+    const float4 z = {rhs.z, rhs.z, rhs.z, rhs.z};
+    const float4 w = {rhs.w, rhs.w, rhs.w, rhs.w};
+    // Accumulate from zero in the same order as the generic implementation, so that results are
+    // bit-identical, including the sign of zero.
+    const float4 sum = float4{} + columns[0] * x + columns[1] * y + columns[2] * z + columns[3] * w;
+    return TVec4<float>(sum[0], sum[1], sum[2], sum[3]);
+}
+#endif
+
 // mat44 * vec3, result is vec3( mat44 * {vec3, 1} )
 template <typename T, typename U>
 CONSTEXPR typename TMat44<T>::col_type PURE operator *(const TMat44<T>& lhs, const TVec3<U>& rhs) {
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <math/mat4.h>
+
+#include <vector>
+
+namespace android {
+namespace {
+
+// A color transform followed by a projection, as composed per layer by RenderEngine.
+const mat4 kColorTransform(vec4(0.9f, 0.1f, 0.0f, 0.0f), vec4(0.05f, 0.9f, 0.05f, 0.0f),
+                           vec4(0.0f, 0.1f, 0.9f, 0.0f), vec4(0.01f, 0.02f, 0.03f, 1.0f));
+const mat4 kProjection = mat4::ortho(0.0f, 1080.0f, 2340.0f, 0.0f, -1.0f, 1.0f);
+
+template <typename T>
+void BM_mat4_times_vec4(benchmark::State& state) {
+    const details::TMat44<T> m(kColorTransform);
+    const std::vector<details::TVec4<T>> in(256, details::TVec4<T>(0.25f, 0.5f, 0.75f, 1.0f));
+    std::vector<details::TVec4<T>> out(in.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m);
+        for (size_t i = 0; i < in.size(); ++i) {
+            out[i] = m * in[i];
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * in.size());
+}
+BENCHMARK_TEMPLATE(BM_mat4_times_vec4, float);
+BENCHMARK_TEMPLATE(BM_mat4_times_vec4, double);
+
+template <typename T>
+void BM_mat4_times_mat4(benchmark::State& state) {
+    const details::TMat44<T> lhs(kProjection);
+    details::TMat44<T> rhs(kColorTransform);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs);
+        benchmark::DoNotOptimize(rhs = lhs * rhs);
+    }
+}
+BENCHMARK_TEMPLATE(BM_mat4_times_mat4, float);
+BENCHMARK_TEMPLATE(BM_mat4_times_mat4, double);
+
+} // namespace
+} // namespace android
+
+BENCHMARK_MAIN();
@@ -163,6 +163,41 @@ TEST_F(MatTest, ElementAccess) {
     EXPECT_FLOAT_EQ(m(3, 2), 100);
 }
 
+TEST_F(MatTest, Multiply) {
+    // float mat4 * vec4 is specialized, so compare against the generic double implementation.
+    std::default_random_engine generator(171717);
+    std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+    auto random = std::bind(distribution, generator);
+
+    for (size_t i = 0; i < 100; ++i) {
+        mat4 m0, m1;
+        vec4 v;
+        for (size_t c = 0; c < 4; ++c) {
+            v[c] = random();
+            for (size_t r = 0; r < 4; ++r) {
+                m0[c][r] = random();
+                m1[c][r] = random();
+            }
+        }
+
+        const vec4 mv = m0 * v;
+        const double4 mvd = mat4d(m0) * double4(v);
+        const mat4 mm = m0 * m1;
+        const mat4d mmd = mat4d(m0) * mat4d(m1);
+        for (size_t c = 0; c < 4; ++c) {
+            EXPECT_NEAR(mvd[c], mv[c], 1e-3);
+            for (size_t r = 0; r < 4; ++r) {
+                EXPECT_NEAR(mmd[c][r], mm[c][r], 1e-3);
+            }
+        }
+    }
+
+    const mat4 m(vec4(1, 2, 3, 4), vec4(5, 6, 7, 8), vec4(9, 10, 11, 12), vec4(13, 14, 15, 16));
+    EXPECT_EQ(vec4(90, 100, 110, 120), m * vec4(1, 2, 3, 4));
+    EXPECT_EQ(m, mat4() * m);
+    EXPECT_EQ(m, m * mat4());
+}
+
 //------------------------------------------------------------------------------
 // MAT 3
 //------------------------------------------------------------------------------
@@ -216,9 +216,20 @@ void EGLConsumer::onAcquireBufferLocked(BufferItem* item, SurfaceTexture& st) {
     // before, so any prior EglImage created is using a stale buffer. This
     // replaces any old EglImage with a new one (using the new buffer).
     int slot = item->mSlot;
-    if (item->mGraphicBuffer != nullptr || mEglSlots[slot].mEglImage.get() == nullptr) {
-        mEglSlots[slot].mEglImage = new EglImage(st.mSlots[slot].mGraphicBuffer);
+    sp<EglImage>& image = mEglSlots[slot].mEglImage;
+    if (item->mGraphicBuffer == nullptr && image.get() != nullptr) {
+        return;
     }
+
+    // The BufferQueue may re-send the buffer this slot already holds an
+    // EglImage for, in which case reuse it. Images of freed slots are never
+    // kept, since they would keep their buffers' memory alive.
+    const sp<GraphicBuffer>& buffer = st.mSlots[slot].mGraphicBuffer;
+    if (image != nullptr && image->graphicBuffer() != nullptr && buffer != nullptr &&
+        image->graphicBuffer()->getId() == buffer->getId()) {
+        return;
+    }
+    image = new EglImage(buffer);
 }
 
 void EGLConsumer::onReleaseBufferLocked(int buf) {
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "EGLConsumerTest"
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <gtest/gtest.h>
+#include <gui/BufferQueue.h>
+#include <gui/Surface.h>
+#include <surfacetexture/SurfaceTexture.h>
+#include <system/window.h>
+#include <ui/GraphicBuffer.h>
+
+namespace android {
+
+class EGLConsumerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        mDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        ASSERT_NE(EGL_NO_DISPLAY, mDisplay);
+        ASSERT_TRUE(eglInitialize(mDisplay, nullptr, nullptr));
+
+        const EGLint configAttribs[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE,
+                                        EGL_OPENGL_ES2_BIT, EGL_NONE};
+        EGLConfig config;
+        EGLint numConfigs = 0;
+        ASSERT_TRUE(eglChooseConfig(mDisplay, configAttribs, &config, 1, &numConfigs));
+        ASSERT_EQ(1, numConfigs);
+
+        const EGLint pbufferAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        mSurface = eglCreatePbufferSurface(mDisplay, config, pbufferAttribs);
+        ASSERT_NE(EGL_NO_SURFACE, mSurface);
+        const EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE};
+        mContext = eglCreateContext(mDisplay, config, EGL_NO_CONTEXT, contextAttribs);
+        ASSERT_NE(EGL_NO_CONTEXT, mContext);
+        ASSERT_TRUE(eglMakeCurrent(mDisplay, mSurface, mSurface, mContext));
+
+        glGenTextures(1, &mTexture);
+
+        sp<IGraphicBufferProducer> producer;
+        sp<IGraphicBufferConsumer> consumer;
+        BufferQueue::createBufferQueue(&producer, &consumer);
+        mSurfaceTexture = sp<SurfaceTexture>::make(consumer, mTexture, GL_TEXTURE_EXTERNAL_OES,
+                                                   true, false);
+        mWindow = sp<Surface>::make(producer);
+        ASSERT_EQ(NO_ERROR, native_window_api_connect(mWindow.get(), NATIVE_WINDOW_API_CPU));
+        ASSERT_EQ(NO_ERROR, native_window_set_buffers_dimensions(mWindow.get(), 16, 16));
+        ASSERT_EQ(NO_ERROR,
+                  native_window_set_buffers_format(mWindow.get(), HAL_PIXEL_FORMAT_RGBA_8888));
+        ASSERT_EQ(NO_ERROR,
+                  native_window_set_usage(mWindow.get(), GRALLOC_USAGE_SW_WRITE_OFTEN));
+    }
+
+    void TearDown() override {
+        mWindow.clear();
+        if (mSurfaceTexture) mSurfaceTexture->abandon();
+        mSurfaceTexture.clear();
+        if (mTexture) glDeleteTextures(1, &mTexture);
+        eglMakeCurrent(mDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (mContext != EGL_NO_CONTEXT) eglDestroyContext(mDisplay, mContext);
+        if (mSurface != EGL_NO_SURFACE) eglDestroySurface(mDisplay, mSurface);
+    }
+
+    // Queues a buffer and latches it, returning a weak reference to it.
+    wp<GraphicBuffer> queueAndLatchBuffer() {
+        ANativeWindowBuffer* buffer = nullptr;
+        EXPECT_EQ(NO_ERROR, native_window_dequeue_buffer_and_wait(mWindow.get(), &buffer));
+        if (!buffer) return nullptr;
+        wp<GraphicBuffer> weakBuffer = GraphicBuffer::from(buffer);
+        EXPECT_EQ(NO_ERROR, mWindow->queueBuffer(mWindow.get(), buffer, -1));
+        EXPECT_EQ(NO_ERROR, mSurfaceTexture->updateTexImage());
+        return weakBuffer;
+    }
+
+    EGLDisplay mDisplay = EGL_NO_DISPLAY;
+    EGLSurface mSurface = EGL_NO_SURFACE;
+    EGLContext mContext = EGL_NO_CONTEXT;
+    GLuint mTexture = 0;
+    sp<SurfaceTexture> mSurfaceTexture;
+    sp<Surface> mWindow;
+};
+
+TEST_F(EGLConsumerTest, FreedBuffersAreReleased) {
+    const wp<GraphicBuffer> first = queueAndLatchBuffer();
+    // Latching a second buffer releases the first back to the BufferQueue.
+    const wp<GraphicBuffer> second = queueAndLatchBuffer();
+    ASSERT_NE(nullptr, first.promote());
+
+    // Disconnecting frees every slot, after which nothing may keep the released buffer alive,
+    // including its EGLImage.
+    ASSERT_EQ(NO_ERROR, native_window_api_disconnect(mWindow.get(), NATIVE_WINDOW_API_CPU));
+    EXPECT_EQ(nullptr, first.promote());
+}
+
+} // namespace android
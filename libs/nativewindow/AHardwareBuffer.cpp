@@ -28,6 +28,7 @@
 #include <cutils/native_handle.h>
 #include <log/log.h>
 #include <utils/StrongPointer.h>
+#include <ui/Fence.h>
 #include <ui/GraphicBuffer.h>
 #include <system/graphics.h>
 
@@ -475,6 +476,27 @@ int AHardwareBuffer_createFromHandle(const AHardwareBuffer_Desc* desc,
     return NO_ERROR;
 }
 
+int AHardwareBuffer_flushLocked(AHardwareBuffer* buffer, int32_t* outFence) {
+    if (!buffer) return BAD_VALUE;
+    const GraphicBuffer* gbuffer = AHardwareBuffer_to_GraphicBuffer(buffer);
+
+    int fenceFd = -1;
+    status_t err = GraphicBufferMapper::get().flushLockedBuffer(gbuffer->handle, &fenceFd);
+    if (err != NO_ERROR) return err;
+
+    if (outFence) {
+        *outFence = fenceFd;
+        return NO_ERROR;
+    }
+    return sp<Fence>::make(fenceFd)->waitForever("AHardwareBuffer_flushLocked");
+}
+
+int AHardwareBuffer_rereadLocked(AHardwareBuffer* buffer) {
+    if (!buffer) return BAD_VALUE;
+    const GraphicBuffer* gbuffer = AHardwareBuffer_to_GraphicBuffer(buffer);
+    return GraphicBufferMapper::get().rereadLockedBuffer(gbuffer->handle);
+}
+
 // ----------------------------------------------------------------------------
 // Helpers implementation
 // ----------------------------------------------------------------------------
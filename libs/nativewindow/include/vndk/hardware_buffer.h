@@ -59,6 +59,31 @@ int AHardwareBuffer_createFromHandle(const AHardwareBuffer_Desc* _Nonnull desc,
                                      const native_handle_t* _Nonnull handle, int32_t method,
                                      AHardwareBuffer* _Nullable* _Nonnull outBuffer);
 
+/**
+ * Make CPU writes to a locked AHardwareBuffer visible to other devices, without unlocking it.
+ *
+ * This allows a buffer that is written by the CPU every frame to stay mapped, rather than paying
+ * for a lock and unlock each frame. The whole buffer is flushed.
+ *
+ * If \a outFence is not NULL, it is set to a sync fence file descriptor that signals once the
+ * flush has completed, or -1 if the flush has already completed. The caller owns the fence.
+ *
+ * \return 0 on success, -EINVAL if \a buffer is NULL, -ENOSYS if the gralloc implementation does
+ * not support flushing locked buffers, or an error number if the operation fails for any reason.
+ */
+int AHardwareBuffer_flushLocked(AHardwareBuffer* _Nonnull buffer, int32_t* _Nullable outFence);
+
+/**
+ * Make writes by other devices visible to the CPU mapping of a locked AHardwareBuffer, without
+ * unlocking and relocking it.
+ *
+ * Any fence covering the writes by other devices must have signaled before this is called.
+ *
+ * \return 0 on success, -EINVAL if \a buffer is NULL, -ENOSYS if the gralloc implementation does
+ * not support rereading locked buffers, or an error number if the operation fails for any reason.
+ */
+int AHardwareBuffer_rereadLocked(AHardwareBuffer* _Nonnull buffer);
+
 /**
  * Buffer pixel formats.
  */
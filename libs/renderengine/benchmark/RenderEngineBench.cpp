@@ -24,6 +24,7 @@
 #include <renderengine/RenderEngine.h>
 #include <renderengine/impl/ExternalTexture.h>
 
+#include <chrono>
 #include <mutex>
 
 using namespace android;
@@ -274,3 +275,71 @@ void BM_blur(benchmark::State& benchState) {
 }
 
 BENCHMARK(BM_blur)->Apply(RunSkiaGLThreaded);
+
+/**
+ * Measures the latency of a composition draw queued right behind a screen capture of the same
+ * size, as happens when a screenshot is requested just before a frame. With priorities and tiled
+ * captures, the composition draw runs between the capture's tiles instead of after all of them.
+ */
+void BM_compositionLatencyWithQueuedCapture(benchmark::State& benchState) {
+    auto re = createRenderEngine(static_cast<RenderEngine::RenderEngineType>(benchState.range()));
+
+    auto [width, height] = getDisplaySize();
+    auto compositionBuffer = allocateBuffer(*re, width, height, 0, "composition");
+    auto captureBuffer = allocateBuffer(*re, width, height, 0, "capture");
+
+    const Rect displayRect(0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height));
+    DisplaySettings composition{
+            .physicalDisplay = displayRect,
+            .clip = displayRect,
+            .maxLuminance = 500,
+    };
+    DisplaySettings capture = composition;
+    capture.renderTileSize = 512;
+    capture.priority = DisplaySettings::Priority::SCREEN_CAPTURE;
+
+    const FloatRect layerRect(0, 0, width, height);
+    LayerSettings background{
+            .geometry =
+                    Geometry{
+                            .boundaries = layerRect,
+                    },
+            .source =
+                    PixelSource{
+                            .solidColor = half3(0.2f, 0.4f, 0.6f),
+                    },
+            .alpha = half(1.0f),
+    };
+    LayerSettings roundedLayer{
+            .geometry =
+                    Geometry{
+                            .boundaries = layerRect,
+                            .roundedCornersRadius = {50.f, 50.f},
+                            .roundedCornersCrop = layerRect,
+                    },
+            .source =
+                    PixelSource{
+                            .solidColor = half3(0.8f, 0.2f, 0.2f),
+                    },
+            .alpha = half(0.5f),
+    };
+    auto layers = std::vector<LayerSettings>{background, roundedLayer};
+
+    for (auto _ : benchState) {
+        auto captureFuture =
+                re->drawLayers(capture, layers, captureBuffer, kUseFrameBufferCache, {});
+
+        const auto start = std::chrono::steady_clock::now();
+        sp<Fence> compositionFence =
+                re->drawLayers(composition, layers, compositionBuffer, kUseFrameBufferCache, {})
+                        .get()
+                        .value();
+        compositionFence->waitForever(LOG_TAG);
+        benchState.SetIterationTime(
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        captureFuture.get().value()->waitForever(LOG_TAG);
+    }
+}
+
+BENCHMARK(BM_compositionLatencyWithQueuedCapture)->Apply(RunSkiaGLThreaded)->UseManualTime();
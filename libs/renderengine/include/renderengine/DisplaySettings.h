@@ -89,6 +89,29 @@ struct DisplaySettings {
             aidl::android::hardware::graphics::composer3::RenderIntent::TONE_MAP_COLORIMETRIC;
 
     std::vector<renderengine::BorderRenderInfo> borderInfoList;
+
+    // If non-zero, the threaded RenderEngine renders the output in square tiles of this size,
+    // each as a separate job, so that other work such as composition can run between tiles.
+    // Draws with blurred layers are never tiled, since blurs sample across tile edges.
+    uint32_t renderTileSize = 0;
+
+    // Rectangle of the output buffer to render into, used for drawing a single tile. Pixels
+    // outside of it are left untouched. If invalid, the whole output is rendered.
+    Rect renderTile = Rect::INVALID_RECT;
+
+    // Importance of the draw. The threaded RenderEngine runs queued work in priority order, so
+    // that a frame is not delayed by less urgent draws queued ahead of it.
+    enum class Priority {
+        // Client composition of a frame. Work other than draws also runs at this priority.
+        COMPOSITION = 0,
+        // Rendering of a cached set by the layer caching planner.
+        CACHED_SET = 1,
+        // Screenshots and region sampling.
+        SCREEN_CAPTURE = 2,
+        // Shader cache priming.
+        PREWARM = 3,
+    };
+    Priority priority = Priority::COMPOSITION;
 };
 
 static inline bool operator==(const DisplaySettings& lhs, const DisplaySettings& rhs) {
@@ -101,7 +124,8 @@ static inline bool operator==(const DisplaySettings& lhs, const DisplaySettings&
             lhs.orientation == rhs.orientation &&
             lhs.targetLuminanceNits == rhs.targetLuminanceNits &&
             lhs.dimmingStage == rhs.dimmingStage && lhs.renderIntent == rhs.renderIntent &&
-            lhs.borderInfoList == rhs.borderInfoList;
+            lhs.borderInfoList == rhs.borderInfoList && lhs.renderTileSize == rhs.renderTileSize &&
+            lhs.renderTile == rhs.renderTile && lhs.priority == rhs.priority;
 }
 
 static const char* orientation_to_string(uint32_t orientation) {
@@ -146,6 +170,10 @@ static inline void PrintTo(const DisplaySettings& settings, ::std::ostream* os)
         << aidl::android::hardware::graphics::composer3::toString(settings.dimmingStage).c_str();
     *os << "\n    .renderIntent = "
         << aidl::android::hardware::graphics::composer3::toString(settings.renderIntent).c_str();
+    *os << "\n    .renderTileSize = " << settings.renderTileSize;
+    *os << "\n    .renderTile = ";
+    PrintTo(settings.renderTile, os);
+    *os << "\n    .priority = " << static_cast<int>(settings.priority);
     *os << "\n}";
 }
 
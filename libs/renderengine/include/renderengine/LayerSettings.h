@@ -179,6 +179,10 @@ struct LayerSettings {
     // If white point nits are unknown, then this layer is assumed to have the
     // same luminance as the brightest layer in the scene.
     float whitePointNits = -1.f;
+
+    // Currently latched frame number, 0 if invalid. A buffer may be drawn again with new content,
+    // so this tells whether the content changed between draws.
+    uint64_t frameNumber = 0;
 };
 
 // Keep in sync with custom comparison function in
@@ -337,6 +341,7 @@ static inline void PrintTo(const LayerSettings& settings, ::std::ostream* os) {
         PrintTo(settings.stretchEffect, os);
     }
     *os << "\n    .whitePointNits = " << settings.whitePointNits;
+    *os << "\n    .frameNumber = " << settings.frameNumber;
     *os << "\n}";
 }
 
@@ -33,12 +33,20 @@
 
 #include <future>
 #include <memory>
+#include <string>
 
 /**
  * Allows to set RenderEngine backend to GLES (default) or SkiaGL (NOT yet supported).
  */
 #define PROPERTY_DEBUG_RENDERENGINE_BACKEND "debug.renderengine.backend"
 
+/**
+ * File in which SurfaceFlinger's RenderEngine records draws that compile shaders after
+ * primeCache, to replay them on the next boot. Recording is off if unset. The directory must be
+ * writable by SurfaceFlinger, e.g. next to its EGL blob cache.
+ */
+#define PROPERTY_RENDERENGINE_RECORDED_DRAWS_PATH "persist.renderengine.recorded_draws_path"
+
 /**
  * Turns on recording of skia commands in SkiaGL version of the RE. This property
  * defines number of milliseconds for the recording to take place. A non zero value
@@ -266,6 +274,9 @@ struct RenderEngineCreationArgs {
     bool supportsBackgroundBlur;
     RenderEngine::ContextPriority contextPriority;
     RenderEngine::RenderEngineType renderEngineType;
+    // File in which draws that compile shaders missing from primeCache are recorded, so that the
+    // next primeCache replays them. Empty to disable recording.
+    std::string recordedDrawsPath;
 
     struct Builder;
 
@@ -275,7 +286,8 @@ private:
                              bool _enableProtectedContext, bool _precacheToneMapperShaderOnly,
                              bool _supportsBackgroundBlur,
                              RenderEngine::ContextPriority _contextPriority,
-                             RenderEngine::RenderEngineType _renderEngineType)
+                             RenderEngine::RenderEngineType _renderEngineType,
+                             std::string _recordedDrawsPath)
           : pixelFormat(_pixelFormat),
             imageCacheSize(_imageCacheSize),
             useColorManagement(_useColorManagement),
@@ -283,7 +295,8 @@ private:
             precacheToneMapperShaderOnly(_precacheToneMapperShaderOnly),
             supportsBackgroundBlur(_supportsBackgroundBlur),
             contextPriority(_contextPriority),
-            renderEngineType(_renderEngineType) {}
+            renderEngineType(_renderEngineType),
+            recordedDrawsPath(std::move(_recordedDrawsPath)) {}
     RenderEngineCreationArgs() = delete;
 };
 
@@ -322,10 +335,15 @@ struct RenderEngineCreationArgs::Builder {
         this->renderEngineType = renderEngineType;
         return *this;
     }
+    Builder& setRecordedDrawsPath(std::string recordedDrawsPath) {
+        this->recordedDrawsPath = std::move(recordedDrawsPath);
+        return *this;
+    }
     RenderEngineCreationArgs build() const {
         return RenderEngineCreationArgs(pixelFormat, imageCacheSize, useColorManagement,
                                         enableProtectedContext, precacheToneMapperShaderOnly,
-                                        supportsBackgroundBlur, contextPriority, renderEngineType);
+                                        supportsBackgroundBlur, contextPriority, renderEngineType,
+                                        recordedDrawsPath);
     }
 
 private:
@@ -339,6 +357,7 @@ private:
     RenderEngine::ContextPriority contextPriority = RenderEngine::ContextPriority::MEDIUM;
     RenderEngine::RenderEngineType renderEngineType =
             RenderEngine::RenderEngineType::SKIA_GL_THREADED;
+    std::string recordedDrawsPath;
 };
 
 } // namespace renderengine
@@ -51,6 +51,9 @@ const auto kFlip = mat4(1.1f, -0.1f,  0.f, 0.f,
 // a color correction effect is added to the shader.
 constexpr auto kDestDataSpace = ui::Dataspace::SRGB;
 constexpr auto kOtherDataSpace = ui::Dataspace::DISPLAY_P3;
+// HDR source dataspaces, which need a tone mapping LinearEffect when drawn to an SDR destination.
+constexpr ui::Dataspace kHdrDataSpaces[] = {ui::Dataspace::BT2020_ITU_PQ,
+                                           ui::Dataspace::BT2020_ITU_HLG};
 } // namespace
 
 static void drawShadowLayers(SkiaRenderEngine* renderengine, const DisplaySettings& display,
@@ -295,6 +298,39 @@ static void drawPIPImageLayer(SkiaRenderEngine* renderengine, const DisplaySetti
     renderengine->drawLayers(display, layers, dstTexture, kUseFrameBufferCache, base::unique_fd());
 }
 
+// Builds and draws the tone mapping LinearEffect variants of common HDR content, so that the first
+// HDR layer on screen does not compile SkSL on the render thread.
+static void drawHdrImageLayers(SkiaRenderEngine* renderengine, const DisplaySettings& display,
+                               const std::shared_ptr<ExternalTexture>& dstTexture,
+                               const std::shared_ptr<ExternalTexture>& srcTexture) {
+    const Rect& displayRect = display.physicalDisplay;
+    FloatRect rect(0, 0, displayRect.width(), displayRect.height());
+    LayerSettings layer{
+            .geometry =
+                    Geometry{
+                            .boundaries = rect,
+                    },
+            .source = PixelSource{.buffer =
+                                          Buffer{
+                                                  .buffer = srcTexture,
+                                                  .usePremultipliedAlpha = true,
+                                                  .maxLuminanceNits = 1000.f,
+                                          }},
+            .alpha = 1,
+    };
+
+    for (auto dataspace : kHdrDataSpaces) {
+        layer.sourceDataspace = dataspace;
+        // Translucent buffers need the variant that undoes premultiplied alpha.
+        for (bool isOpaque : {true, false}) {
+            layer.source.buffer.isOpaque = isOpaque;
+            auto layers = std::vector<LayerSettings>{layer};
+            renderengine->drawLayers(display, layers, dstTexture, kUseFrameBufferCache,
+                                     base::unique_fd());
+        }
+    }
+}
+
 static void drawHolePunchLayer(SkiaRenderEngine* renderengine, const DisplaySettings& display,
                             const std::shared_ptr<ExternalTexture>& dstTexture) {
     const Rect& displayRect = display.physicalDisplay;
@@ -324,6 +360,81 @@ static void drawHolePunchLayer(SkiaRenderEngine* renderengine, const DisplaySett
     renderengine->drawLayers(display, layers, dstTexture, kUseFrameBufferCache, base::unique_fd());
 }
 
+// Draws the configurations that compiled shaders after primeCache on a previous boot. See
+// SkiaRenderEngine::recordUnprimedDraw. Buffer layers all sample |srcTexture|, so draws that
+// depended on a particular buffer format may still compile shaders on first use.
+static void drawRecordedLayers(SkiaRenderEngine* renderengine, const Rect& displayRect,
+                               const std::shared_ptr<ExternalTexture>& dstTexture,
+                               const std::shared_ptr<ExternalTexture>& srcTexture,
+                               const std::vector<RecordedDraw>& recordedDraws) {
+    FloatRect rect(0, 0, displayRect.width(), displayRect.height());
+    DisplaySettings display{
+            .physicalDisplay = displayRect,
+            .clip = displayRect,
+            .maxLuminance = 500,
+            .targetLuminanceNits = 500,
+    };
+
+    for (const auto& draw : recordedDraws) {
+        display.outputDataspace = static_cast<ui::Dataspace>(draw.outputDataspace);
+        std::vector<LayerSettings> layers;
+        layers.reserve(draw.layers.size());
+        for (const auto& recorded : draw.layers) {
+            LayerSettings layer{
+                    .geometry =
+                            Geometry{
+                                    .boundaries = rect,
+                                    .roundedCornersCrop = rect,
+                            },
+                    .alpha = recorded.alpha ? 0.5f : 1.f,
+            };
+            if (recorded.buffer) {
+                layer.source.buffer = Buffer{
+                        .buffer = srcTexture,
+                        .usePremultipliedAlpha = recorded.premultipliedAlpha,
+                        .isOpaque = recorded.opaque,
+                        .maxLuminanceNits = 1000.f,
+                };
+                layer.sourceDataspace = static_cast<ui::Dataspace>(recorded.sourceDataspace);
+            } else {
+                layer.source.solidColor = half3(0.1f, 0.2f, 0.3f);
+            }
+            if (recorded.roundedCorners) {
+                layer.geometry.roundedCornersRadius = {50.f, 50.f};
+            }
+            if (recorded.blur && renderengine->supportsBackgroundBlur()) {
+                layer.backgroundBlurRadius = 60;
+            }
+            if (recorded.shadow) {
+                layer.shadow = ShadowSettings{
+                        .boundaries = rect,
+                        .ambientColor = vec4(0, 0, 0, 0.00935997f),
+                        .spotColor = vec4(0, 0, 0, 0.0455841f),
+                        .lightPos = vec3(500.f, -1500.f, 1500.f),
+                        .lightRadius = 2500.0f,
+                        .length = 15.f,
+                };
+            }
+            if (recorded.stretch) {
+                layer.stretchEffect.width = rect.getWidth();
+                layer.stretchEffect.height = rect.getHeight();
+                layer.stretchEffect.vectorY = 0.5f;
+                layer.stretchEffect.maxAmountY = 0.5f;
+                layer.stretchEffect.mappedChildBounds = rect;
+            }
+            if (recorded.colorTransform) {
+                layer.colorTransform = kScaleAsymmetric;
+            }
+            if (recorded.dimmed) {
+                layer.whitePointNits = display.targetLuminanceNits / 2;
+            }
+            layers.push_back(std::move(layer));
+        }
+        renderengine->drawLayers(display, layers, dstTexture, kUseFrameBufferCache,
+                                 base::unique_fd());
+    }
+}
+
 //
 // The collection of shaders cached here were found by using perfetto to record shader compiles
 // during actions that involve RenderEngine, logging the layer settings, and the shader code
@@ -335,7 +446,8 @@ static void drawHolePunchLayer(SkiaRenderEngine* renderengine, const DisplaySett
 //    kFlushAfterEveryLayer = true
 // in external/skia/src/gpu/gl/builders/GrGLShaderStringBuilder.cpp
 //    gPrintSKSL = true
-void Cache::primeShaderCache(SkiaRenderEngine* renderengine) {
+void Cache::primeShaderCache(SkiaRenderEngine* renderengine,
+                             const std::vector<RecordedDraw>& recordedDraws) {
     const int previousCount = renderengine->reportShadersCompiled();
     if (previousCount) {
         ALOGD("%d Shaders already compiled before Cache::primeShaderCache ran\n", previousCount);
@@ -430,6 +542,11 @@ void Cache::primeShaderCache(SkiaRenderEngine* renderengine) {
 
         drawPIPImageLayer(renderengine, display, dstTexture, externalTexture);
 
+        drawHdrImageLayers(renderengine, display, dstTexture, externalTexture);
+        drawHdrImageLayers(renderengine, p3Display, dstTexture, externalTexture);
+
+        drawRecordedLayers(renderengine, displayRect, dstTexture, externalTexture, recordedDraws);
+
         // draw one final layer synchronously to force GL submit
         LayerSettings layer{
                 .source = PixelSource{.solidColor = half3(0.f, 0.f, 0.f)},
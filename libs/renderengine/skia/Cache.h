@@ -16,13 +16,18 @@
 
 #pragma once
 
+#include <vector>
+
+#include "RecordedDraw.h"
+
 namespace android::renderengine::skia {
 
 class SkiaRenderEngine;
 
 class Cache {
 public:
-    static void primeShaderCache(SkiaRenderEngine*);
+    // Primes the shaders of common draws, followed by the draws recorded on previous boots.
+    static void primeShaderCache(SkiaRenderEngine*, const std::vector<RecordedDraw>& recordedDraws);
 
 private:
     Cache() = default;
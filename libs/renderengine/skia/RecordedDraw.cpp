@@ -0,0 +1,198 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "RenderEngine"
+
+#include "RecordedDraw.h"
+
+#include <android-base/file.h>
+#include <android-base/parseint.h>
+#include <android-base/strings.h>
+#include <log/log.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <tuple>
+
+namespace android::renderengine::skia {
+
+namespace {
+
+// First line of the file. Bump the version whenever the line format changes, so that draws saved
+// by an older build are dropped rather than misread.
+constexpr std::string_view kHeader = "renderengine-recorded-draws 1";
+
+auto asTuple(const RecordedDraw::Layer& layer) {
+    return std::make_tuple(layer.buffer, layer.sourceDataspace, layer.opaque,
+                           layer.premultipliedAlpha, layer.alpha, layer.roundedCorners,
+                           layer.blur, layer.shadow, layer.stretch, layer.colorTransform,
+                           layer.dimmed);
+}
+
+// One character per flag, in the order they are written.
+struct Flag {
+    char symbol;
+    bool RecordedDraw::Layer::*member;
+    bool valueWhenSet;
+};
+
+constexpr Flag kFlags[] = {
+        {'o', &RecordedDraw::Layer::opaque, true},
+        {'u', &RecordedDraw::Layer::premultipliedAlpha, false},
+        {'a', &RecordedDraw::Layer::alpha, true},
+        {'r', &RecordedDraw::Layer::roundedCorners, true},
+        {'B', &RecordedDraw::Layer::blur, true},
+        {'s', &RecordedDraw::Layer::shadow, true},
+        {'S', &RecordedDraw::Layer::stretch, true},
+        {'t', &RecordedDraw::Layer::colorTransform, true},
+        {'d', &RecordedDraw::Layer::dimmed, true},
+};
+
+} // namespace
+
+bool RecordedDraw::Layer::operator==(const Layer& other) const {
+    return asTuple(*this) == asTuple(other);
+}
+
+bool RecordedDraw::Layer::operator<(const Layer& other) const {
+    return asTuple(*this) < asTuple(other);
+}
+
+bool RecordedDraw::operator<(const RecordedDraw& other) const {
+    return std::tie(outputDataspace, layers) < std::tie(other.outputDataspace, other.layers);
+}
+
+RecordedDraw RecordedDraw::from(const DisplaySettings& display,
+                                const std::vector<LayerSettings>& layers) {
+    RecordedDraw draw{.outputDataspace = static_cast<int32_t>(display.outputDataspace)};
+    draw.layers.reserve(layers.size());
+    for (const auto& layer : layers) {
+        const bool buffer = layer.source.buffer.buffer != nullptr;
+        draw.layers.push_back({
+                .buffer = buffer,
+                .sourceDataspace = buffer ? static_cast<int32_t>(layer.sourceDataspace) : 0,
+                .opaque = buffer && layer.source.buffer.isOpaque,
+                .premultipliedAlpha = !buffer || layer.source.buffer.usePremultipliedAlpha,
+                .alpha = layer.alpha < 1.f,
+                .roundedCorners = layer.geometry.roundedCornersRadius.x > 0.f,
+                .blur = layer.backgroundBlurRadius > 0 || !layer.blurRegions.empty(),
+                .shadow = layer.shadow.length > 0.f,
+                .stretch = layer.stretchEffect.hasEffect(),
+                .colorTransform = layer.colorTransform != mat4(),
+                .dimmed = layer.whitePointNits >= 0.f &&
+                        layer.whitePointNits < display.targetLuminanceNits,
+        });
+    }
+    return draw;
+}
+
+std::string RecordedDraw::toString() const {
+    std::string line = std::to_string(outputDataspace);
+    for (const auto& layer : layers) {
+        line += layer.buffer ? " b" + std::to_string(layer.sourceDataspace) : " c";
+        line += ':';
+        for (const auto& flag : kFlags) {
+            if (layer.*flag.member == flag.valueWhenSet) line += flag.symbol;
+        }
+    }
+    return line;
+}
+
+std::optional<RecordedDraw> RecordedDraw::parse(std::string_view line) {
+    const auto tokens = base::Split(std::string(line), " ");
+    RecordedDraw draw;
+    if (tokens.size() < 2 || !base::ParseInt(tokens[0], &draw.outputDataspace)) {
+        return std::nullopt;
+    }
+
+    for (size_t i = 1; i < tokens.size(); i++) {
+        const std::string& token = tokens[i];
+        const size_t colon = token.find(':');
+        if (colon == std::string::npos || colon == 0) return std::nullopt;
+
+        Layer layer;
+        if (token[0] == 'b') {
+            layer.buffer = true;
+            if (!base::ParseInt(token.substr(1, colon - 1), &layer.sourceDataspace)) {
+                return std::nullopt;
+            }
+        } else if (token[0] != 'c' || colon != 1) {
+            return std::nullopt;
+        }
+
+        for (const char symbol : token.substr(colon + 1)) {
+            const Flag* match = nullptr;
+            for (const auto& flag : kFlags) {
+                if (flag.symbol == symbol) match = &flag;
+            }
+            if (!match) return std::nullopt;
+            layer.*match->member = match->valueWhenSet;
+        }
+        draw.layers.push_back(layer);
+    }
+    return draw;
+}
+
+std::vector<RecordedDraw> loadRecordedDraws(const std::string& path) {
+    std::vector<RecordedDraw> draws;
+    std::string contents;
+    if (!base::ReadFileToString(path, &contents)) {
+        return draws;
+    }
+
+    const auto lines = base::Split(contents, "\n");
+    if (lines.empty() || lines[0] != kHeader) {
+        ALOGW("Ignoring recorded draws in %s with an unknown format", path.c_str());
+        return draws;
+    }
+    for (size_t i = 1; i < lines.size(); i++) {
+        if (lines[i].empty()) continue;
+        if (auto draw = RecordedDraw::parse(lines[i])) {
+            draws.push_back(std::move(*draw));
+        } else {
+            ALOGW("Ignoring malformed recorded draw in %s: %s", path.c_str(), lines[i].c_str());
+        }
+    }
+    return draws;
+}
+
+bool saveRecordedDraws(const std::string& path, const std::vector<RecordedDraw>& draws) {
+    std::string contents(kHeader);
+    contents += '\n';
+    for (const auto& draw : draws) {
+        contents += draw.toString();
+        contents += '\n';
+    }
+
+    // Write a temporary file and rename it over the old one, so that a crash midway never leaves
+    // a truncated file behind.
+    const std::string tmpPath = path + ".tmp";
+    if (!base::WriteStringToFile(contents, tmpPath)) {
+        ALOGW("Failed to write recorded draws to %s: %s", tmpPath.c_str(), strerror(errno));
+        return false;
+    }
+    if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+        ALOGW("Failed to rename %s to %s: %s", tmpPath.c_str(), path.c_str(), strerror(errno));
+        unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace android::renderengine::skia
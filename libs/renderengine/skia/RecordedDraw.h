@@ -0,0 +1,76 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <renderengine/DisplaySettings.h>
+#include <renderengine/LayerSettings.h>
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace android::renderengine::skia {
+
+// A compact description of a drawLayers call, keeping only the settings that select which shaders
+// Skia compiles. Draws that compiled shaders after primeCache are recorded in this form, saved to
+// disk, and replayed by Cache::primeShaderCache on the next boot.
+struct RecordedDraw {
+    struct Layer {
+        bool buffer = false;
+        // Only meaningful for buffer layers.
+        int32_t sourceDataspace = 0;
+        bool opaque = false;
+        bool premultipliedAlpha = true;
+
+        bool alpha = false;
+        bool roundedCorners = false;
+        bool blur = false;
+        bool shadow = false;
+        bool stretch = false;
+        bool colorTransform = false;
+        bool dimmed = false;
+
+        bool operator==(const Layer&) const;
+        bool operator<(const Layer&) const;
+    };
+
+    int32_t outputDataspace = 0;
+    std::vector<Layer> layers;
+
+    static RecordedDraw from(const DisplaySettings& display,
+                             const std::vector<LayerSettings>& layers);
+
+    // A single line, e.g. "142671872 b142671872:or c:a". Returns std::nullopt from parse if the
+    // line is malformed.
+    std::string toString() const;
+    static std::optional<RecordedDraw> parse(std::string_view line);
+
+    bool operator==(const RecordedDraw& other) const {
+        return outputDataspace == other.outputDataspace && layers == other.layers;
+    }
+    bool operator<(const RecordedDraw&) const;
+};
+
+// Reads the draws saved by saveRecordedDraws, skipping malformed lines. Returns an empty list if
+// the file does not exist or was written in another format version.
+std::vector<RecordedDraw> loadRecordedDraws(const std::string& path);
+
+// Replaces the file at |path| with the given draws. Returns false on failure.
+bool saveRecordedDraws(const std::string& path, const std::vector<RecordedDraw>& draws);
+
+} // namespace android::renderengine::skia
@@ -63,11 +63,13 @@
 #include <ui/HdrRenderTypeUtils.h>
 #include <utils/Trace.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <deque>
 #include <memory>
 #include <numeric>
+#include <unordered_set>
 
 #include "Cache.h"
 #include "ColorSpaces.h"
@@ -242,7 +244,14 @@ namespace skia {
 using base::StringAppendF;
 
 std::future<void> SkiaRenderEngine::primeCache() {
-    Cache::primeShaderCache(this);
+    std::vector<RecordedDraw> recordedDraws;
+    if (!mRecordedDrawsPath.empty()) {
+        recordedDraws = loadRecordedDraws(mRecordedDrawsPath);
+    }
+    Cache::primeShaderCache(this, recordedDraws);
+    std::lock_guard<std::mutex> lock(mRenderingMutex);
+    mShaderCachePrimed = true;
+    mReplayedDraws = std::move(recordedDraws);
     return {};
 }
 
@@ -268,10 +277,12 @@ void SkiaRenderEngine::setEnableTracing(bool tracingEnabled) {
 }
 
 SkiaRenderEngine::SkiaRenderEngine(RenderEngineType type, PixelFormat pixelFormat,
-                                   bool useColorManagement, bool supportsBackgroundBlur)
+                                   bool useColorManagement, bool supportsBackgroundBlur,
+                                   std::string recordedDrawsPath)
       : RenderEngine(type),
         mDefaultPixelFormat(pixelFormat),
-        mUseColorManagement(useColorManagement) {
+        mUseColorManagement(useColorManagement),
+        mRecordedDrawsPath(std::move(recordedDrawsPath)) {
     if (supportsBackgroundBlur) {
         ALOGD("Background Blurs Enabled");
         mBlurFilter = new KawaseBlurFilter();
@@ -653,6 +664,7 @@ void SkiaRenderEngine::drawLayersInternal(
     ATRACE_FORMAT("%s for %s", __func__, display.namePlusId.c_str());
 
     std::lock_guard<std::mutex> lock(mRenderingMutex);
+    mFrameArena.reset();
 
     if (buffer == nullptr) {
         ALOGE("No output buffer provided. Aborting GPU composition.");
@@ -669,6 +681,9 @@ void SkiaRenderEngine::drawLayersInternal(
     // any AutoBackendTexture deletions will now be deferred until cleanupPostRender is called
     DeferTextureCleanup dtc(mTextureCleanupMgr);
 
+    collectGpuDrawDurations();
+    const int shadersCompiledBeforeDraw = mSkSLCacheMonitor.totalShadersCompiled();
+
     auto surfaceTextureRef = getOrCreateBackendTexture(buffer->getBuffer(), true);
 
     // wait on the buffer to be ready to use prior to using it
@@ -739,7 +754,11 @@ void SkiaRenderEngine::drawLayersInternal(
     }
 
     AutoSaveRestore surfaceAutoSaveRestore(canvas);
-    // Clear the entire canvas with a transparent black to prevent ghost images.
+    if (display.renderTile.isValid()) {
+        // Only this tile is rendered here, the rest of the output is drawn by other calls.
+        canvas->clipRect(getSkRect(display.renderTile));
+    }
+    // Clear the entire canvas (or tile) with a transparent black to prevent ghost images.
     canvas->clear(SK_ColorTRANSPARENT);
     initCanvas(canvas, display);
 
@@ -809,7 +828,25 @@ void SkiaRenderEngine::drawLayersInternal(
                                  layer.geometry.roundedCornersRadius);
         // TODO (b/270314344): Enable blurs in protected context.
         if (mBlurFilter && layerHasBlur(layer, ctModifiesAlpha) && !mInProtectedContext) {
-            std::unordered_map<uint32_t, sk_sp<SkImage>> cachedBlurs;
+            std::unordered_map<uint32_t, sk_sp<SkImage>, std::hash<uint32_t>,
+                               std::equal_to<uint32_t>,
+                               ftl::ArenaAllocator<std::pair<const uint32_t, sk_sp<SkImage>>>>
+                    cachedBlurs(mFrameArena);
+            const auto blurContent = getBlurContent(layers, layer);
+
+            // When the layer blurs its content with several radii, downscale the input once and
+            // share it, rather than reading the full resolution input for each radius.
+            std::unordered_set<uint32_t, std::hash<uint32_t>, std::equal_to<uint32_t>,
+                               ftl::ArenaAllocator<uint32_t>>
+                    blurRadii(mFrameArena);
+            if (layer.backgroundBlurRadius > 0) {
+                blurRadii.insert(layer.backgroundBlurRadius);
+            }
+            for (const auto& region : layer.blurRegions) {
+                blurRadii.insert(region.blurRadius);
+            }
+            sk_sp<SkImage> downscaledBlurInput;
+            sk_sp<SkImage>* sharedBlurInput = blurRadii.size() > 1 ? &downscaledBlurInput : nullptr;
 
             // if multiple layers have blur, then we need to take a snapshot now because
             // only the lowest layer will have blurImage populated earlier
@@ -842,8 +879,9 @@ void SkiaRenderEngine::drawLayersInternal(
             if (blurRect.width() > 0 && blurRect.height() > 0) {
                 if (layer.backgroundBlurRadius > 0) {
                     ATRACE_NAME("BackgroundBlur");
-                    auto blurredImage = mBlurFilter->generate(grContext, layer.backgroundBlurRadius,
-                                                              blurInput, blurRect);
+                    auto blurredImage = generateBlur(grContext, display, blurContent,
+                                                     layer.backgroundBlurRadius, blurInput,
+                                                     blurRect, sharedBlurInput);
 
                     cachedBlurs[layer.backgroundBlurRadius] = blurredImage;
 
@@ -856,8 +894,8 @@ void SkiaRenderEngine::drawLayersInternal(
                     if (cachedBlurs[region.blurRadius] == nullptr) {
                         ATRACE_NAME("BlurRegion");
                         cachedBlurs[region.blurRadius] =
-                                mBlurFilter->generate(grContext, region.blurRadius, blurInput,
-                                                      blurRect);
+                                generateBlur(grContext, display, blurContent, region.blurRadius,
+                                             blurInput, blurRect, sharedBlurInput);
                     }
 
                     mBlurFilter->drawBlurRegion(canvas, getBlurRRect(region), region.blurRadius,
@@ -1161,6 +1199,17 @@ void SkiaRenderEngine::drawLayersInternal(
     }
 
     auto drawFence = sp<Fence>::make(flushAndSubmit(grContext));
+    mPendingGpuDraws.push_back({.fence = drawFence,
+                                .submitTime = systemTime(),
+                                .effects = getGpuDrawEffects(display, layers, ctModifiesAlpha)});
+    if (mPendingGpuDraws.size() > kMaxPendingGpuDraws) {
+        mPendingGpuDraws.pop_front();
+    }
+
+    if (mShaderCachePrimed &&
+        mSkSLCacheMonitor.totalShadersCompiled() > shadersCompiledBeforeDraw) {
+        recordUnprimedDraw(display, layers);
+    }
 
     if (ATRACE_ENABLED()) {
         static gui::FenceMonitor sMonitor("RE Completion");
@@ -1169,6 +1218,145 @@ void SkiaRenderEngine::drawLayersInternal(
     resultPromise->set_value(std::move(drawFence));
 }
 
+void SkiaRenderEngine::recordUnprimedDraw(const DisplaySettings& display,
+                                          const std::vector<LayerSettings>& layers) {
+    RecordedDraw draw = RecordedDraw::from(display, layers);
+    if (const auto it = mUnprimedDraws.find(draw); it != mUnprimedDraws.end()) {
+        it->second++;
+        return;
+    }
+    if (mUnprimedDraws.size() >= kMaxUnprimedDraws) {
+        return;
+    }
+    mUnprimedDraws.emplace(std::move(draw), 1);
+
+    // Only new configurations rewrite the file, which happens a bounded number of times per boot.
+    // The draws seen since boot take precedence over the replayed ones when the file is full.
+    if (mRecordedDrawsPath.empty()) {
+        return;
+    }
+    std::vector<RecordedDraw> draws;
+    draws.reserve(kMaxUnprimedDraws);
+    for (const auto& [unprimedDraw, count] : mUnprimedDraws) {
+        draws.push_back(unprimedDraw);
+    }
+    for (const auto& replayedDraw : mReplayedDraws) {
+        if (draws.size() >= kMaxUnprimedDraws) break;
+        if (mUnprimedDraws.count(replayedDraw) == 0) draws.push_back(replayedDraw);
+    }
+    saveRecordedDraws(mRecordedDrawsPath, draws);
+}
+
+std::optional<std::vector<SkiaRenderEngine::BlurContentLayer>> SkiaRenderEngine::getBlurContent(
+        const std::vector<LayerSettings>& layers, const LayerSettings& blurLayer) {
+    std::vector<BlurContentLayer> content;
+    for (const auto& layer : layers) {
+        if (&layer == &blurLayer) {
+            return content;
+        }
+        const auto& buffer = layer.source.buffer;
+        if (buffer.buffer && layer.frameNumber == 0) {
+            return std::nullopt;
+        }
+        BlurContentLayer& contentLayer = content.emplace_back(
+                BlurContentLayer{.bufferId = buffer.buffer ? buffer.buffer->getId() : 0,
+                                 .settings = layer});
+        contentLayer.settings.source.buffer.buffer = nullptr;
+        contentLayer.settings.source.buffer.fence = nullptr;
+    }
+    return std::nullopt;
+}
+
+sk_sp<SkImage> SkiaRenderEngine::generateBlur(
+        GrRecordingContext* context, const DisplaySettings& display,
+        const std::optional<std::vector<BlurContentLayer>>& content, uint32_t radius,
+        const sk_sp<SkImage>& blurInput, const SkRect& blurRect, sk_sp<SkImage>* downscaledInput) {
+    const auto generate = [&] {
+        if (!downscaledInput) {
+            return mBlurFilter->generate(context, radius, blurInput, blurRect);
+        }
+        if (!*downscaledInput) {
+            *downscaledInput = BlurFilter::downscale(context, blurInput, blurRect);
+        }
+        return mBlurFilter->generateFromDownscaled(context, radius, *downscaledInput);
+    };
+
+    if (!content) {
+        return generate();
+    }
+
+    const auto it = std::find_if(mCachedBlurs.begin(), mCachedBlurs.end(), [&](const auto& blur) {
+        return blur.radius == radius && blur.blurRect == blurRect && blur.display == display &&
+                blur.content == *content;
+    });
+    if (it != mCachedBlurs.end()) {
+        ATRACE_NAME("CachedBlur");
+        return it->blurredImage;
+    }
+
+    auto blurredImage = generate();
+    mCachedBlurs.push_front({.display = display,
+                             .content = *content,
+                             .radius = radius,
+                             .blurRect = blurRect,
+                             .blurredImage = blurredImage});
+    if (mCachedBlurs.size() > kMaxCachedBlurs) {
+        mCachedBlurs.pop_back();
+    }
+    return blurredImage;
+}
+
+uint32_t SkiaRenderEngine::getGpuDrawEffects(const DisplaySettings& display,
+                                             const std::vector<LayerSettings>& layers,
+                                             bool ctModifiesAlpha) const {
+    uint32_t effects = 0;
+    for (const auto& layer : layers) {
+        if (mBlurFilter && !mInProtectedContext && layerHasBlur(layer, ctModifiesAlpha)) {
+            effects |= GpuDrawEffect::BLUR;
+        }
+        if (layer.shadow.length > 0.f) {
+            effects |= GpuDrawEffect::SHADOW;
+        }
+        if (needsToneMapping(layer.sourceDataspace, display.outputDataspace)) {
+            effects |= GpuDrawEffect::TONE_MAPPING;
+        }
+    }
+    return effects;
+}
+
+void SkiaRenderEngine::collectGpuDrawDurations() {
+    const auto record = [](GpuDrawStats& stats, nsecs_t duration) {
+        const nsecs_t durationMs = ns2ms(duration);
+        const auto bucket = std::upper_bound(stats.kBucketLimitsMs.begin(),
+                                             stats.kBucketLimitsMs.end(), durationMs) -
+                stats.kBucketLimitsMs.begin();
+        stats.buckets[static_cast<size_t>(bucket)]++;
+        stats.count++;
+        stats.totalDuration += duration;
+    };
+
+    // Fences of draws signal in submission order, so stop at the first pending one.
+    while (!mPendingGpuDraws.empty()) {
+        const PendingGpuDraw& draw = mPendingGpuDraws.front();
+        const nsecs_t signalTime = draw.fence->getSignalTime();
+        if (signalTime == Fence::SIGNAL_TIME_PENDING) {
+            break;
+        }
+        if (signalTime != Fence::SIGNAL_TIME_INVALID) {
+            const nsecs_t duration = std::max<nsecs_t>(signalTime - draw.submitTime, 0);
+            if (draw.effects == 0) {
+                record(mGpuDrawStats[0], duration);
+            }
+            for (size_t i = 1; i < kGpuDrawStatsCount; i++) {
+                if (draw.effects & (1u << (i - 1))) {
+                    record(mGpuDrawStats[i], duration);
+                }
+            }
+        }
+        mPendingGpuDraws.pop_front();
+    }
+}
+
 size_t SkiaRenderEngine::getMaxTextureSize() const {
     return mGrContext->maxTextureSize();
 }
@@ -1293,6 +1481,40 @@ void SkiaRenderEngine::dump(std::string& result) {
             StringAppendF(&result, "undoPremultipliedAlpha: %s\n",
                           linearEffect.undoPremultipliedAlpha ? "true" : "false");
         }
+
+        StringAppendF(&result, "\n");
+        StringAppendF(&result, "RenderEngine cached blurs: %zu\n", mCachedBlurs.size());
+
+        StringAppendF(&result, "\n");
+        collectGpuDrawDurations();
+        static constexpr std::array<const char*, kGpuDrawStatsCount> kGpuDrawStatsNames = {
+                "no effects", "blur", "shadow", "tone mapping"};
+        StringAppendF(&result, "RenderEngine draw GPU completion times (ms):\n");
+        for (size_t i = 0; i < kGpuDrawStatsCount; i++) {
+            const GpuDrawStats& stats = mGpuDrawStats[i];
+            const double meanMs =
+                    stats.count ? static_cast<double>(stats.totalDuration) / 1e6 / stats.count : 0;
+            StringAppendF(&result, "- %s: %d draws, mean %.2f, histogram", kGpuDrawStatsNames[i],
+                          stats.count, meanMs);
+            for (size_t bucket = 0; bucket < stats.buckets.size(); bucket++) {
+                if (bucket < stats.kBucketLimitsMs.size()) {
+                    StringAppendF(&result, " <%" PRId64 ":%d", stats.kBucketLimitsMs[bucket],
+                                  stats.buckets[bucket]);
+                } else {
+                    StringAppendF(&result, " >=%" PRId64 ":%d", stats.kBucketLimitsMs.back(),
+                                  stats.buckets[bucket]);
+                }
+            }
+            StringAppendF(&result, "\n");
+        }
+
+        StringAppendF(&result, "\n");
+        StringAppendF(&result, "RenderEngine draws that compiled shaders after primeCache: %zu\n",
+                      mUnprimedDraws.size());
+        for (const auto& [draw, count] : mUnprimedDraws) {
+            StringAppendF(&result, "- %d times: %s\n", count, draw.toString().c_str());
+        }
+        StringAppendF(&result, "Draws replayed by primeCache: %zu\n", mReplayedDraws.size());
     }
     StringAppendF(&result, "\n");
 }
@@ -24,15 +24,21 @@
 #include <GrDirectContext.h>
 #include <SkSurface.h>
 #include <android-base/thread_annotations.h>
+#include <ftl/arena.h>
 #include <renderengine/ExternalTexture.h>
 #include <renderengine/RenderEngine.h>
 #include <sys/types.h>
 
+#include <array>
+#include <deque>
+#include <map>
 #include <mutex>
+#include <optional>
 #include <unordered_map>
 
 #include "AutoBackendTexture.h"
 #include "GrContextOptions.h"
+#include "RecordedDraw.h"
 #include "SkImageInfo.h"
 #include "SkiaRenderEngine.h"
 #include "android-base/macros.h"
@@ -62,7 +68,8 @@ public:
     SkiaRenderEngine(RenderEngineType type,
                      PixelFormat pixelFormat,
                      bool useColorManagement,
-                     bool supportsBackgroundBlur);
+                     bool supportsBackgroundBlur,
+                     std::string recordedDrawsPath = "");
     ~SkiaRenderEngine() override;
 
     std::future<void> primeCache() override final;
@@ -147,6 +154,47 @@ private:
 
     void dump(std::string& result) override final;
 
+    // Records a draw that compiled new shaders after primeCache ran, and saves the recorded draws
+    // so that the next primeCache replays them.
+    void recordUnprimedDraw(const DisplaySettings& display,
+                            const std::vector<LayerSettings>& layers) REQUIRES(mRenderingMutex);
+
+    // Layer drawn below a blur, with the buffer reduced to its id so that cached blurs do not keep
+    // buffers alive.
+    struct BlurContentLayer {
+        uint64_t bufferId;
+        LayerSettings settings;
+
+        bool operator==(const BlurContentLayer& other) const {
+            return bufferId == other.bufferId && settings == other.settings &&
+                    settings.frameNumber == other.settings.frameNumber;
+        }
+    };
+    // Returns the layers drawn below blurLayer, which determine the content it blurs, or nullopt
+    // if the content may change without the layers changing, e.g. a buffer without frame number.
+    static std::optional<std::vector<BlurContentLayer>> getBlurContent(
+            const std::vector<LayerSettings>& layers, const LayerSettings& blurLayer);
+    // Blurs blurInput, reusing the blur from an earlier draw of the same content if possible.
+    // If downscaledInput is not null, the blur is generated from the downscaled input it points
+    // to, which is created on first use and shared by all the radii blurring the same content.
+    sk_sp<SkImage> generateBlur(GrRecordingContext* context, const DisplaySettings& display,
+                                const std::optional<std::vector<BlurContentLayer>>& content,
+                                uint32_t radius, const sk_sp<SkImage>& blurInput,
+                                const SkRect& blurRect, sk_sp<SkImage>* downscaledInput)
+            REQUIRES(mRenderingMutex);
+
+    // Effects that a draw may use, for attributing GPU time.
+    enum GpuDrawEffect : uint32_t {
+        BLUR = 1 << 0,
+        SHADOW = 1 << 1,
+        TONE_MAPPING = 1 << 2,
+    };
+    uint32_t getGpuDrawEffects(const DisplaySettings& display,
+                               const std::vector<LayerSettings>& layers,
+                               bool ctModifiesAlpha) const;
+    // Folds the durations of submitted draws whose fences have signaled into mGpuDrawStats.
+    void collectGpuDrawDurations() REQUIRES(mRenderingMutex);
+
     // If requiresLinearEffect is true or the layer has a stretchEffect a new shader is returned.
     // Otherwise it returns the input shader.
     struct RuntimeEffectShaderParameters {
@@ -193,6 +241,57 @@ private:
     mutable std::mutex mRenderingMutex;
     SkSLCacheMonitor mSkSLCacheMonitor;
 
+    // Scratch memory for the temporaries of a single drawLayersInternal call, reset at the start of
+    // each call.
+    ftl::Arena mFrameArena GUARDED_BY(mRenderingMutex);
+
+    // Set once primeCache has run. Shaders compiled after that point come from draw
+    // configurations that Cache.cpp does not prime.
+    bool mShaderCachePrimed GUARDED_BY(mRenderingMutex) = false;
+    // Maximum number of distinct unprimed draw configurations tracked and saved.
+    static constexpr size_t kMaxUnprimedDraws = 32;
+    // Unprimed draw configurations seen since boot, with the number of times each compiled new
+    // shaders.
+    std::map<RecordedDraw, int> mUnprimedDraws GUARDED_BY(mRenderingMutex);
+    // Where unprimed draws are saved, or empty if they are not.
+    const std::string mRecordedDrawsPath;
+    // The draws replayed by primeCache, which are kept when the file is rewritten.
+    std::vector<RecordedDraw> mReplayedDraws GUARDED_BY(mRenderingMutex);
+
+    // Blurs generated by recent draws. Content that is blurred again, e.g. a static wallpaper
+    // behind the notification shade, reuses the blur instead of generating it each frame.
+    struct CachedBlur {
+        DisplaySettings display;
+        std::vector<BlurContentLayer> content;
+        uint32_t radius;
+        SkRect blurRect;
+        sk_sp<SkImage> blurredImage;
+    };
+    static constexpr size_t kMaxCachedBlurs = 4;
+    // Most recently generated first.
+    std::deque<CachedBlur> mCachedBlurs GUARDED_BY(mRenderingMutex);
+
+    // Histogram of the time from submitting a draw until its fence signals. This is an upper
+    // bound of the GPU time of the draw, as it includes GPU work queued ahead of it.
+    struct GpuDrawStats {
+        static constexpr std::array<nsecs_t, 5> kBucketLimitsMs = {1, 2, 4, 8, 16};
+        // The last bucket counts draws that took at least the last limit.
+        std::array<int, kBucketLimitsMs.size() + 1> buckets{};
+        int count = 0;
+        nsecs_t totalDuration = 0;
+    };
+    struct PendingGpuDraw {
+        sp<Fence> fence;
+        nsecs_t submitTime;
+        uint32_t effects;
+    };
+    // Draws whose fences have not signaled yet are dropped beyond this many.
+    static constexpr size_t kMaxPendingGpuDraws = 8;
+    std::deque<PendingGpuDraw> mPendingGpuDraws GUARDED_BY(mRenderingMutex);
+    // Stats of draws without any GpuDrawEffect, followed by the stats of each effect.
+    static constexpr size_t kGpuDrawStatsCount = 4;
+    std::array<GpuDrawStats, kGpuDrawStatsCount> mGpuDrawStats GUARDED_BY(mRenderingMutex);
+
     // Graphics context used for creating surfaces and submitting commands
     sk_sp<GrDirectContext> mGrContext;
     // Same as above, but for protected content (eg. DRM)
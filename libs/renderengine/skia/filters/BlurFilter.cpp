@@ -69,6 +69,26 @@ BlurFilter::BlurFilter(const float maxCrossFadeRadius)
       : mMaxCrossFadeRadius(maxCrossFadeRadius),
         mMixEffect(maxCrossFadeRadius > 0 ? createMixEffect() : nullptr) {}
 
+sk_sp<SkImage> BlurFilter::downscale(GrRecordingContext* context, const sk_sp<SkImage> input,
+                                     const SkRect& blurRect) {
+    ATRACE_CALL();
+    // Create the downscaled surface with the bit depth and colorspace of the original surface
+    SkImageInfo scaledInfo = input->imageInfo().makeWH(std::ceil(blurRect.width() * kInputScale),
+                                                       std::ceil(blurRect.height() * kInputScale));
+    sk_sp<SkSurface> surface =
+            SkSurface::MakeRenderTarget(context, skgpu::Budgeted::kNo, scaledInfo);
+
+    SkPaint paint;
+    paint.setBlendMode(SkBlendMode::kSrc);
+    surface->getCanvas()->drawImageRect(input, blurRect,
+                                        SkRect::MakeWH(scaledInfo.width(), scaledInfo.height()),
+                                        SkSamplingOptions{SkFilterMode::kLinear,
+                                                          SkMipmapMode::kNone},
+                                        &paint,
+                                        SkCanvas::SrcRectConstraint::kFast_SrcRectConstraint);
+    return surface->makeImageSnapshot();
+}
+
 float BlurFilter::getMaxCrossFadeRadius() const {
     return mMaxCrossFadeRadius;
 }
@@ -41,6 +41,17 @@ public:
     virtual sk_sp<SkImage> generate(GrRecordingContext* context, const uint32_t radius,
                             const sk_sp<SkImage> blurInput, const SkRect& blurRect) const = 0;
 
+    // Execute blur on input that was already downscaled with downscale(), saving it to a
+    // texture. This lets several radii blurring the same content share one read of the full
+    // resolution input.
+    virtual sk_sp<SkImage> generateFromDownscaled(GrRecordingContext* context,
+                                                  const uint32_t radius,
+                                                  const sk_sp<SkImage> downscaledInput) const = 0;
+
+    // Downscales the blurRect area of input by kInputScale, for generateFromDownscaled.
+    static sk_sp<SkImage> downscale(GrRecordingContext* context, const sk_sp<SkImage> input,
+                                    const SkRect& blurRect);
+
     /**
      * Draw the blurred content (from the generate method) into the canvas.
      * @param canvas is the destination/output for the blur
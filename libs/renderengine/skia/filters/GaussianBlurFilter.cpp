@@ -65,6 +65,25 @@ sk_sp<SkImage> GaussianBlurFilter::generate(GrRecordingContext* context, const u
     return surface->makeImageSnapshot();
 }
 
+sk_sp<SkImage> GaussianBlurFilter::generateFromDownscaled(GrRecordingContext* context,
+                                                          const uint32_t blurRadius,
+                                                          const sk_sp<SkImage> input) const {
+    sk_sp<SkSurface> surface =
+            SkSurface::MakeRenderTarget(context, skgpu::Budgeted::kNo, input->imageInfo());
+
+    SkPaint paint;
+    paint.setBlendMode(SkBlendMode::kSrc);
+    paint.setImageFilter(SkImageFilters::Blur(
+                blurRadius * kInputScale * BLUR_SIGMA_SCALE,
+                blurRadius * kInputScale * BLUR_SIGMA_SCALE,
+                SkTileMode::kClamp, nullptr));
+
+    surface->getCanvas()->drawImage(input, 0, 0,
+                                    SkSamplingOptions{SkFilterMode::kLinear, SkMipmapMode::kNone},
+                                    &paint);
+    return surface->makeImageSnapshot();
+}
+
 } // namespace skia
 } // namespace renderengine
 } // namespace android
@@ -39,6 +39,8 @@ public:
     // Execute blur, saving it to a texture
     sk_sp<SkImage> generate(GrRecordingContext* context, const uint32_t radius,
                             const sk_sp<SkImage> blurInput, const SkRect& blurRect) const override;
+    sk_sp<SkImage> generateFromDownscaled(GrRecordingContext* context, const uint32_t radius,
+                                          const sk_sp<SkImage> downscaledInput) const override;
 
 };
 
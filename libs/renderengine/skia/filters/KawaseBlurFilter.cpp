@@ -56,13 +56,6 @@ KawaseBlurFilter::KawaseBlurFilter(): BlurFilter() {
 sk_sp<SkImage> KawaseBlurFilter::generate(GrRecordingContext* context, const uint32_t blurRadius,
                                           const sk_sp<SkImage> input, const SkRect& blurRect)
     const {
-    // Kawase is an approximation of Gaussian, but it behaves differently from it.
-    // A radius transformation is required for approximating them, and also to introduce
-    // non-integer steps, necessary to smoothly interpolate large radii.
-    float tmpRadius = (float)blurRadius / 2.0f;
-    float numberOfPasses = std::min(kMaxPasses, (uint32_t)ceil(tmpRadius));
-    float radiusByPasses = tmpRadius / (float)numberOfPasses;
-
     // create blur surface with the bit depth and colorspace of the original surface
     SkImageInfo scaledInfo = input->imageInfo().makeWH(std::ceil(blurRect.width() * kInputScale),
                                                        std::ceil(blurRect.height() * kInputScale));
@@ -74,10 +67,30 @@ sk_sp<SkImage> KawaseBlurFilter::generate(GrRecordingContext* context, const uin
     blurMatrix.postScale(kInputScale, kInputScale);
 
     // start by downscaling and doing the first blur pass
+    return blur(context, blurRadius, input, blurMatrix, scaledInfo);
+}
+
+sk_sp<SkImage> KawaseBlurFilter::generateFromDownscaled(GrRecordingContext* context,
+                                                        const uint32_t blurRadius,
+                                                        const sk_sp<SkImage> input) const {
+    // The input is already downscaled, so the first pass samples it as is.
+    return blur(context, blurRadius, input, SkMatrix::I(), input->imageInfo());
+}
+
+sk_sp<SkImage> KawaseBlurFilter::blur(GrRecordingContext* context, const uint32_t blurRadius,
+                                      const sk_sp<SkImage> input, const SkMatrix& inputMatrix,
+                                      const SkImageInfo& scaledInfo) const {
+    // Kawase is an approximation of Gaussian, but it behaves differently from it.
+    // A radius transformation is required for approximating them, and also to introduce
+    // non-integer steps, necessary to smoothly interpolate large radii.
+    float tmpRadius = (float)blurRadius / 2.0f;
+    float numberOfPasses = std::min(kMaxPasses, (uint32_t)ceil(tmpRadius));
+    float radiusByPasses = tmpRadius / (float)numberOfPasses;
+
     SkSamplingOptions linear(SkFilterMode::kLinear, SkMipmapMode::kNone);
     SkRuntimeShaderBuilder blurBuilder(mBlurEffect);
     blurBuilder.child("child") =
-            input->makeShader(SkTileMode::kClamp, SkTileMode::kClamp, linear, blurMatrix);
+            input->makeShader(SkTileMode::kClamp, SkTileMode::kClamp, linear, inputMatrix);
     blurBuilder.uniform("in_blurOffset") = radiusByPasses * kInputScale;
 
     sk_sp<SkImage> tmpBlur(blurBuilder.makeImage(context, nullptr, scaledInfo, false));
@@ -44,8 +44,16 @@ public:
     // Execute blur, saving it to a texture
     sk_sp<SkImage> generate(GrRecordingContext* context, const uint32_t radius,
                             const sk_sp<SkImage> blurInput, const SkRect& blurRect) const override;
+    sk_sp<SkImage> generateFromDownscaled(GrRecordingContext* context, const uint32_t radius,
+                                          const sk_sp<SkImage> downscaledInput) const override;
 
 private:
+    // Runs the blur passes. The first pass samples input through inputMatrix, into an image
+    // described by scaledInfo.
+    sk_sp<SkImage> blur(GrRecordingContext* context, const uint32_t radius,
+                        const sk_sp<SkImage> input, const SkMatrix& inputMatrix,
+                        const SkImageInfo& scaledInfo) const;
+
     sk_sp<SkRuntimeEffect> mBlurEffect;
 };
 
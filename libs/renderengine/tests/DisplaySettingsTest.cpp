@@ -66,4 +66,31 @@ TEST(DisplaySettingsTest, renderIntent) {
 
     ASSERT_FALSE(a == b);
 }
+
+TEST(DisplaySettingsTest, renderTileSize) {
+    DisplaySettings a, b;
+    ASSERT_EQ(a, b);
+
+    a.renderTileSize = 1024;
+
+    ASSERT_FALSE(a == b);
+}
+
+TEST(DisplaySettingsTest, renderTile) {
+    DisplaySettings a, b;
+    ASSERT_EQ(a, b);
+
+    a.renderTile = Rect(0, 0, 1024, 1024);
+
+    ASSERT_FALSE(a == b);
+}
+
+TEST(DisplaySettingsTest, priority) {
+    DisplaySettings a, b;
+    ASSERT_EQ(a, b);
+
+    a.priority = DisplaySettings::Priority::SCREEN_CAPTURE;
+
+    ASSERT_FALSE(a == b);
+}
 } // namespace android::renderengine
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "RecordedDrawTest"
+
+#include <android-base/file.h>
+#include <gtest/gtest.h>
+
+#include "../skia/RecordedDraw.h"
+
+namespace android::renderengine::skia {
+
+namespace {
+
+RecordedDraw makeDraw() {
+    DisplaySettings display{
+            .outputDataspace = ui::Dataspace::DISPLAY_P3,
+            .targetLuminanceNits = 500.f,
+    };
+    LayerSettings color{
+            .geometry = Geometry{.roundedCornersRadius = {20.f, 20.f}},
+            .source = PixelSource{.solidColor = half3(0.f, 0.f, 0.f)},
+            .alpha = 0.5f,
+    };
+    LayerSettings shadow{
+            .alpha = 1.f,
+            .shadow = ShadowSettings{.length = 15.f},
+    };
+    LayerSettings dimmed{
+            .alpha = 1.f,
+            .colorTransform = mat4::scale(vec4(0.5f, 0.5f, 0.5f, 1.f)),
+            .whitePointNits = 200.f,
+    };
+    return RecordedDraw::from(display, {color, shadow, dimmed});
+}
+
+} // namespace
+
+TEST(RecordedDrawTest, fromKeepsShaderSelectingSettings) {
+    const RecordedDraw draw = makeDraw();
+    EXPECT_EQ(static_cast<int32_t>(ui::Dataspace::DISPLAY_P3), draw.outputDataspace);
+    ASSERT_EQ(3u, draw.layers.size());
+
+    EXPECT_FALSE(draw.layers[0].buffer);
+    EXPECT_TRUE(draw.layers[0].alpha);
+    EXPECT_TRUE(draw.layers[0].roundedCorners);
+    EXPECT_FALSE(draw.layers[0].shadow);
+
+    EXPECT_TRUE(draw.layers[1].shadow);
+    EXPECT_FALSE(draw.layers[1].alpha);
+
+    EXPECT_TRUE(draw.layers[2].dimmed);
+    EXPECT_TRUE(draw.layers[2].colorTransform);
+}
+
+TEST(RecordedDrawTest, stringRoundTrip) {
+    RecordedDraw draw = makeDraw();
+    draw.layers.push_back({
+            .buffer = true,
+            .sourceDataspace = static_cast<int32_t>(ui::Dataspace::BT2020_ITU_PQ),
+            .opaque = true,
+            .premultipliedAlpha = false,
+            .blur = true,
+            .stretch = true,
+    });
+
+    const auto parsed = RecordedDraw::parse(draw.toString());
+    ASSERT_TRUE(parsed.has_value());
+    EXPECT_EQ(draw, *parsed);
+}
+
+TEST(RecordedDrawTest, parseRejectsMalformedLines) {
+    EXPECT_FALSE(RecordedDraw::parse("").has_value());
+    EXPECT_FALSE(RecordedDraw::parse("142671872").has_value());
+    EXPECT_FALSE(RecordedDraw::parse("x c:a").has_value());
+    EXPECT_FALSE(RecordedDraw::parse("142671872 c:z").has_value());
+    EXPECT_FALSE(RecordedDraw::parse("142671872 c1:a").has_value());
+    EXPECT_FALSE(RecordedDraw::parse("142671872 bx:o").has_value());
+}
+
+TEST(RecordedDrawTest, saveAndLoad) {
+    TemporaryDir dir;
+    const std::string path = std::string(dir.path) + "/recorded_draws";
+    EXPECT_TRUE(loadRecordedDraws(path).empty());
+
+    const std::vector<RecordedDraw> draws = {makeDraw(), RecordedDraw::parse("0 c:").value()};
+    ASSERT_TRUE(saveRecordedDraws(path, draws));
+    EXPECT_EQ(draws, loadRecordedDraws(path));
+}
+
+TEST(RecordedDrawTest, loadSkipsMalformedLinesAndUnknownVersions) {
+    TemporaryDir dir;
+    const std::string path = std::string(dir.path) + "/recorded_draws";
+
+    ASSERT_TRUE(base::WriteStringToFile("renderengine-recorded-draws 1\n0 c:a\nbogus\n", path));
+    const auto draws = loadRecordedDraws(path);
+    ASSERT_EQ(1u, draws.size());
+    EXPECT_TRUE(draws[0].layers[0].alpha);
+
+    ASSERT_TRUE(base::WriteStringToFile("renderengine-recorded-draws 0\n0 c:a\n", path));
+    EXPECT_TRUE(loadRecordedDraws(path).empty());
+}
+
+} // namespace android::renderengine::skia
@@ -3251,6 +3251,71 @@ TEST_P(RenderEngineTest, r8_respects_color_transform_when_device_handles) {
     expectBufferColor(Rect(0, 0, 1, 1), 0,  70, 0, 255);
 }
 
+TEST_P(RenderEngineTest, drawLayers_reusesBlurUntilBufferFrameNumberChanges) {
+    if (!GetParam()->typeSupported()) {
+        GTEST_SKIP();
+    }
+    initializeRenderEngine();
+    if (!mRE->supportsBackgroundBlur()) {
+        GTEST_SKIP();
+    }
+
+    const auto buf = allocateSourceBuffer(1, 1);
+    const auto fillSource = [&](ubyte4 color) {
+        uint8_t* pixels;
+        buf->getBuffer()->lock(GRALLOC_USAGE_SW_READ_OFTEN | GRALLOC_USAGE_SW_WRITE_OFTEN,
+                               reinterpret_cast<void**>(&pixels));
+        pixels[0] = color.r;
+        pixels[1] = color.g;
+        pixels[2] = color.b;
+        pixels[3] = color.a;
+        buf->getBuffer()->unlock();
+    };
+
+    renderengine::DisplaySettings settings;
+    settings.outputDataspace = ui::Dataspace::V0_SRGB_LINEAR;
+    settings.physicalDisplay = fullscreenRect();
+    settings.clip = fullscreenRect();
+
+    renderengine::LayerSettings backgroundLayer;
+    backgroundLayer.sourceDataspace = ui::Dataspace::V0_SRGB_LINEAR;
+    backgroundLayer.geometry.boundaries = fullscreenRect().toFloatRect();
+    backgroundLayer.source.buffer.buffer = buf;
+    backgroundLayer.source.buffer.isOpaque = true;
+    backgroundLayer.alpha = 1.0f;
+    backgroundLayer.frameNumber = 1;
+
+    renderengine::LayerSettings blurLayer;
+    blurLayer.sourceDataspace = ui::Dataspace::V0_SRGB_LINEAR;
+    blurLayer.geometry.boundaries = fullscreenRect().toFloatRect();
+    blurLayer.backgroundBlurRadius = 50;
+    blurLayer.alpha = 0;
+
+    const Rect center(DEFAULT_DISPLAY_WIDTH / 2 - 1, DEFAULT_DISPLAY_HEIGHT / 2 - 1,
+                      DEFAULT_DISPLAY_WIDTH / 2 + 1, DEFAULT_DISPLAY_HEIGHT / 2 + 1);
+
+    fillSource(ubyte4(255, 0, 0, 255));
+    invokeDraw(settings, {backgroundLayer, blurLayer});
+    expectBufferColor(center, 255, 0, 0, 255, 1 /* tolerance */);
+
+    // The layers and frame number are unchanged, so the blur of the first draw is reused even
+    // though the buffer now holds other content.
+    fillSource(ubyte4(0, 255, 0, 255));
+    invokeDraw(settings, {backgroundLayer, blurLayer});
+    expectBufferColor(center, 255, 0, 0, 255, 1 /* tolerance */);
+
+    // A new frame number means new content, which is blurred again.
+    backgroundLayer.frameNumber = 2;
+    invokeDraw(settings, {backgroundLayer, blurLayer});
+    expectBufferColor(center, 0, 255, 0, 255, 1 /* tolerance */);
+
+    // Without a frame number the content is unknown, so the blur is never cached.
+    backgroundLayer.frameNumber = 0;
+    fillSource(ubyte4(0, 0, 255, 255));
+    invokeDraw(settings, {backgroundLayer, blurLayer});
+    expectBufferColor(center, 0, 0, 255, 255, 1 /* tolerance */);
+}
+
 TEST_P(RenderEngineTest, primeShaderCache) {
     if (!GetParam()->typeSupported()) {
         GTEST_SKIP();
@@ -226,4 +226,133 @@ TEST_F(RenderEngineThreadedTest, drawLayers_protectedOutputBuffer) {
     ASSERT_TRUE(result.ok());
 }
 
+TEST_F(RenderEngineThreadedTest, drawLayers_runsCompositionBeforeQueuedScreenCapture) {
+    std::vector<renderengine::LayerSettings> layers;
+    std::shared_ptr<renderengine::ExternalTexture> buffer = std::make_shared<
+            renderengine::impl::
+                    ExternalTexture>(sp<GraphicBuffer>::make(), *mRenderEngine,
+                                     renderengine::impl::ExternalTexture::Usage::READABLE |
+                                             renderengine::impl::ExternalTexture::Usage::WRITEABLE);
+
+    std::promise<void> firstDrawStarted;
+    std::promise<void> releaseFirstDraw;
+    std::shared_future<void> firstDrawReleased = releaseFirstDraw.get_future().share();
+    std::vector<std::string> drawOrder;
+
+    EXPECT_CALL(*mRenderEngine, useProtectedContext(false)).Times(3);
+    EXPECT_CALL(*mRenderEngine, drawLayersInternal)
+            .Times(3)
+            .WillRepeatedly([&](const std::shared_ptr<std::promise<FenceResult>>&& resultPromise,
+                                const renderengine::DisplaySettings& display,
+                                const std::vector<renderengine::LayerSettings>&,
+                                const std::shared_ptr<renderengine::ExternalTexture>&, const bool,
+                                base::unique_fd&&) {
+                if (drawOrder.empty()) {
+                    firstDrawStarted.set_value();
+                    firstDrawReleased.wait();
+                }
+                drawOrder.push_back(display.namePlusId);
+                resultPromise->set_value(Fence::NO_FENCE);
+            });
+
+    renderengine::DisplaySettings blocking{.namePlusId = "blocking"};
+    auto blockingFuture = mThreadedRE->drawLayers(blocking, layers, buffer, false, {});
+    firstDrawStarted.get_future().wait();
+
+    renderengine::DisplaySettings capture{.namePlusId = "capture"};
+    capture.priority = renderengine::DisplaySettings::Priority::SCREEN_CAPTURE;
+    auto captureFuture = mThreadedRE->drawLayers(capture, layers, buffer, false, {});
+    renderengine::DisplaySettings composition{.namePlusId = "composition"};
+    auto compositionFuture = mThreadedRE->drawLayers(composition, layers, buffer, false, {});
+    releaseFirstDraw.set_value();
+
+    ASSERT_TRUE(blockingFuture.get().ok());
+    ASSERT_TRUE(compositionFuture.get().ok());
+    ASSERT_TRUE(captureFuture.get().ok());
+    const std::vector<std::string> expectedOrder = {"blocking", "composition", "capture"};
+    EXPECT_EQ(expectedOrder, drawOrder);
+}
+
+TEST_F(RenderEngineThreadedTest, drawLayers_rendersLargeOutputInTiles) {
+    auto* skiaRenderEngine = new renderengine::mock::RenderEngine();
+    auto threadedSkiaRE = renderengine::threaded::RenderEngineThreaded::create(
+            [skiaRenderEngine]() {
+                return std::unique_ptr<renderengine::RenderEngine>(skiaRenderEngine);
+            },
+            renderengine::RenderEngine::RenderEngineType::SKIA_GL_THREADED);
+
+    renderengine::DisplaySettings settings;
+    settings.physicalDisplay = Rect(0, 0, 2048, 1024);
+    settings.renderTileSize = 1024;
+    std::vector<renderengine::LayerSettings> layers;
+    std::shared_ptr<renderengine::ExternalTexture> buffer = std::make_shared<
+            renderengine::impl::
+                    ExternalTexture>(sp<GraphicBuffer>::make(), *skiaRenderEngine,
+                                     renderengine::impl::ExternalTexture::Usage::READABLE |
+                                             renderengine::impl::ExternalTexture::Usage::WRITEABLE);
+
+    base::unique_fd bufferFence;
+
+    std::vector<Rect> renderedTiles;
+    EXPECT_CALL(*skiaRenderEngine, useProtectedContext(false)).Times(2);
+    EXPECT_CALL(*skiaRenderEngine, drawLayersInternal)
+            .Times(2)
+            .WillRepeatedly([&](const std::shared_ptr<std::promise<FenceResult>>&& resultPromise,
+                                const renderengine::DisplaySettings& display,
+                                const std::vector<renderengine::LayerSettings>&,
+                                const std::shared_ptr<renderengine::ExternalTexture>&, const bool,
+                                base::unique_fd&&) {
+                renderedTiles.push_back(display.renderTile);
+                resultPromise->set_value(Fence::NO_FENCE);
+            });
+
+    ftl::Future<FenceResult> future =
+            threadedSkiaRE->drawLayers(settings, layers, buffer, false, std::move(bufferFence));
+    ASSERT_TRUE(future.valid());
+    auto result = future.get();
+    ASSERT_TRUE(result.ok());
+    const std::vector<Rect> expectedTiles = {Rect(0, 0, 1024, 1024), Rect(1024, 0, 2048, 1024)};
+    EXPECT_EQ(expectedTiles, renderedTiles);
+}
+
+TEST_F(RenderEngineThreadedTest, drawLayers_doesNotTileBlurredLayers) {
+    auto* skiaRenderEngine = new renderengine::mock::RenderEngine();
+    auto threadedSkiaRE = renderengine::threaded::RenderEngineThreaded::create(
+            [skiaRenderEngine]() {
+                return std::unique_ptr<renderengine::RenderEngine>(skiaRenderEngine);
+            },
+            renderengine::RenderEngine::RenderEngineType::SKIA_GL_THREADED);
+
+    renderengine::DisplaySettings settings;
+    settings.physicalDisplay = Rect(0, 0, 2048, 1024);
+    settings.renderTileSize = 1024;
+    renderengine::LayerSettings layer;
+    layer.backgroundBlurRadius = 10;
+    std::vector<renderengine::LayerSettings> layers = {std::move(layer)};
+    std::shared_ptr<renderengine::ExternalTexture> buffer = std::make_shared<
+            renderengine::impl::
+                    ExternalTexture>(sp<GraphicBuffer>::make(), *skiaRenderEngine,
+                                     renderengine::impl::ExternalTexture::Usage::READABLE |
+                                             renderengine::impl::ExternalTexture::Usage::WRITEABLE);
+
+    base::unique_fd bufferFence;
+
+    EXPECT_CALL(*skiaRenderEngine, useProtectedContext(false));
+    EXPECT_CALL(*skiaRenderEngine, drawLayersInternal)
+            .WillOnce([&](const std::shared_ptr<std::promise<FenceResult>>&& resultPromise,
+                          const renderengine::DisplaySettings& display,
+                          const std::vector<renderengine::LayerSettings>&,
+                          const std::shared_ptr<renderengine::ExternalTexture>&, const bool,
+                          base::unique_fd&&) {
+                EXPECT_FALSE(display.renderTile.isValid());
+                resultPromise->set_value(Fence::NO_FENCE);
+            });
+
+    ftl::Future<FenceResult> future =
+            threadedSkiaRE->drawLayers(settings, layers, buffer, false, std::move(bufferFence));
+    ASSERT_TRUE(future.valid());
+    auto result = future.get();
+    ASSERT_TRUE(result.ok());
+}
+
 } // namespace android
@@ -19,8 +19,10 @@
 #include "RenderEngineThreaded.h"
 
 #include <sched.h>
+#include <algorithm>
 #include <chrono>
 #include <future>
+#include <utility>
 
 #include <android-base/stringprintf.h>
 #include <private/gui/SyncFeatures.h>
@@ -103,8 +105,7 @@ void RenderEngineThreaded::threadMain(CreateInstanceFactory factory) NO_THREAD_S
         const auto getNextTask = [this]() -> std::optional<Work> {
             std::scoped_lock lock(mThreadMutex);
             if (!mFunctionCalls.empty()) {
-                Work task = mFunctionCalls.front();
-                mFunctionCalls.pop();
+                Work task = mFunctionCalls.pop();
                 return std::make_optional<Work>(task);
             }
             return std::nullopt;
@@ -139,19 +140,21 @@ std::future<void> RenderEngineThreaded::primeCache() {
     // for the futures.
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([resultPromise](renderengine::RenderEngine& instance) {
-            ATRACE_NAME("REThreaded::primeCache");
-            if (setSchedFifo(false) != NO_ERROR) {
-                ALOGW("Couldn't set SCHED_OTHER for primeCache");
-            }
-
-            instance.primeCache();
-            resultPromise->set_value();
-
-            if (setSchedFifo(true) != NO_ERROR) {
-                ALOGW("Couldn't set SCHED_FIFO for primeCache");
-            }
-        });
+        mFunctionCalls.push(
+                [resultPromise](renderengine::RenderEngine& instance) {
+                    ATRACE_NAME("REThreaded::primeCache");
+                    if (setSchedFifo(false) != NO_ERROR) {
+                        ALOGW("Couldn't set SCHED_OTHER for primeCache");
+                    }
+
+                    instance.primeCache();
+                    resultPromise->set_value();
+
+                    if (setSchedFifo(true) != NO_ERROR) {
+                        ALOGW("Couldn't set SCHED_FIFO for primeCache");
+                    }
+                },
+                Priority::PREWARM);
     }
     mCondition.notify_one();
 
@@ -291,20 +294,120 @@ ftl::Future<FenceResult> RenderEngineThreaded::drawLayers(
     const auto resultPromise = std::make_shared<std::promise<FenceResult>>();
     std::future<FenceResult> resultFuture = resultPromise->get_future();
     int fd = bufferFence.release();
+    if (auto tiles = getRenderTiles(display, layers); !tiles.empty()) {
+        {
+            std::lock_guard lock(mThreadMutex);
+            queueRenderTileLocked(std::make_shared<TiledDraw>(
+                    TiledDraw{.resultPromise = resultPromise,
+                              .display = display,
+                              .layers = layers,
+                              .buffer = buffer,
+                              .useFramebufferCache = useFramebufferCache,
+                              .bufferFence = fd,
+                              .tiles = std::move(tiles)}));
+        }
+        mCondition.notify_one();
+        return resultFuture;
+    }
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([resultPromise, display, layers, buffer, useFramebufferCache,
-                             fd](renderengine::RenderEngine& instance) {
-            ATRACE_NAME("REThreaded::drawLayers");
-            instance.updateProtectedContext(layers, buffer);
-            instance.drawLayersInternal(std::move(resultPromise), display, layers, buffer,
-                                        useFramebufferCache, base::unique_fd(fd));
-        });
+        mFunctionCalls.push(
+                [resultPromise, display, layers, buffer, useFramebufferCache,
+                 fd](renderengine::RenderEngine& instance) {
+                    ATRACE_NAME("REThreaded::drawLayers");
+                    instance.updateProtectedContext(layers, buffer);
+                    instance.drawLayersInternal(std::move(resultPromise), display, layers, buffer,
+                                                useFramebufferCache, base::unique_fd(fd));
+                },
+                display.priority);
     }
     mCondition.notify_one();
     return resultFuture;
 }
 
+std::vector<Rect> RenderEngineThreaded::getRenderTiles(
+        const DisplaySettings& display, const std::vector<LayerSettings>& layers) const {
+    // GLESRenderEngine does not support rendering a single tile.
+    if (display.renderTileSize == 0 || getRenderEngineType() == RenderEngineType::THREADED) {
+        return {};
+    }
+
+    const int32_t tileSize = static_cast<int32_t>(display.renderTileSize);
+    const Rect& bounds = display.physicalDisplay;
+    if (!bounds.isValid() || (bounds.getWidth() <= tileSize && bounds.getHeight() <= tileSize)) {
+        return {};
+    }
+
+    const bool hasBlur = std::any_of(layers.begin(), layers.end(), [](const auto& layer) {
+        return layer.backgroundBlurRadius > 0 || !layer.blurRegions.empty();
+    });
+    if (hasBlur) {
+        return {};
+    }
+
+    std::vector<Rect> tiles;
+    for (int32_t top = bounds.top; top < bounds.bottom; top += tileSize) {
+        for (int32_t left = bounds.left; left < bounds.right; left += tileSize) {
+            tiles.emplace_back(left, top, std::min(left + tileSize, bounds.right),
+                               std::min(top + tileSize, bounds.bottom));
+        }
+    }
+    return tiles;
+}
+
+void RenderEngineThreaded::queueRenderTileLocked(std::shared_ptr<TiledDraw> draw) {
+    const auto renderTile = [this, draw](renderengine::RenderEngine& instance) {
+        ATRACE_FORMAT("REThreaded::drawLayers tile %zu/%zu", draw->nextTile + 1,
+                      draw->tiles.size());
+        instance.updateProtectedContext(draw->layers, draw->buffer);
+
+        DisplaySettings tileDisplay = draw->display;
+        tileDisplay.renderTile = draw->tiles[draw->nextTile++];
+        const bool isLastTile = draw->nextTile == draw->tiles.size();
+
+        // All tiles are submitted to the same context, so the fence of the last tile also covers
+        // the earlier ones.
+        if (isLastTile) {
+            instance.drawLayersInternal(std::move(draw->resultPromise), tileDisplay, draw->layers,
+                                        draw->buffer, draw->useFramebufferCache,
+                                        base::unique_fd(std::exchange(draw->bufferFence, -1)));
+            return;
+        }
+
+        auto tilePromise = std::make_shared<std::promise<FenceResult>>();
+        auto tileFuture = tilePromise->get_future();
+        instance.drawLayersInternal(std::move(tilePromise), tileDisplay, draw->layers,
+                                    draw->buffer, draw->useFramebufferCache,
+                                    base::unique_fd(std::exchange(draw->bufferFence, -1)));
+        if (auto result = tileFuture.get(); !result.ok()) {
+            draw->resultPromise->set_value(std::move(result));
+            return;
+        }
+
+        std::lock_guard lock(mThreadMutex);
+        queueRenderTileLocked(draw);
+    };
+    mFunctionCalls.push(renderTile, draw->display.priority);
+}
+
+void RenderEngineThreaded::WorkQueue::push(Work work, Priority priority) {
+    mQueues[static_cast<size_t>(priority)].push(std::move(work));
+}
+
+bool RenderEngineThreaded::WorkQueue::empty() const {
+    return std::all_of(mQueues.begin(), mQueues.end(),
+                       [](const auto& queue) { return queue.empty(); });
+}
+
+RenderEngineThreaded::Work RenderEngineThreaded::WorkQueue::pop() {
+    const auto it = std::find_if(mQueues.begin(), mQueues.end(),
+                                 [](const auto& queue) { return !queue.empty(); });
+    LOG_ALWAYS_FATAL_IF(it == mQueues.end(), "%s called on an empty queue", __func__);
+    Work work = std::move(it->front());
+    it->pop();
+    return work;
+}
+
 void RenderEngineThreaded::cleanFramebufferCache() {
     ATRACE_CALL();
     // This function is designed so it can run asynchronously, so we do not need to wait
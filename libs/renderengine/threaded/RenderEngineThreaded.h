@@ -17,6 +17,7 @@
 #pragma once
 
 #include <android-base/thread_annotations.h>
+#include <array>
 #include <condition_variable>
 #include <mutex>
 #include <queue>
@@ -33,7 +34,7 @@ using CreateInstanceFactory = std::function<std::unique_ptr<renderengine::Render
 /**
  * This class extends a basic RenderEngine class. It contains a thread. Each time a function of
  * this class is called, we create a lambda function that is put on a queue. The main thread then
- * executes the functions in order.
+ * executes the functions in order of their priority, see DisplaySettings::Priority.
  */
 class RenderEngineThreaded : public RenderEngine {
 public:
@@ -82,6 +83,26 @@ private:
     void waitUntilInitialized() const;
     static status_t setSchedFifo(bool enabled);
 
+    // State shared by the jobs rendering the tiles of a single tiled drawLayers call.
+    struct TiledDraw {
+        std::shared_ptr<std::promise<FenceResult>> resultPromise;
+        DisplaySettings display;
+        std::vector<LayerSettings> layers;
+        std::shared_ptr<ExternalTexture> buffer;
+        bool useFramebufferCache;
+        // Only the first tile waits for the buffer fence.
+        int bufferFence;
+        std::vector<Rect> tiles;
+        size_t nextTile = 0;
+    };
+
+    // Returns the tiles to render the draw in, or an empty list to render it in one job.
+    std::vector<Rect> getRenderTiles(const DisplaySettings& display,
+                                     const std::vector<LayerSettings>& layers) const;
+    // Queues the job for the next tile of the draw. Each job queues the one for the following
+    // tile when it completes, so other work queued meanwhile runs in between.
+    void queueRenderTileLocked(std::shared_ptr<TiledDraw> draw) REQUIRES(mThreadMutex);
+
     // No-op. This method is only called on leaf implementations of RenderEngine.
     void useProtectedContext(bool) override {}
 
@@ -95,7 +116,22 @@ private:
     std::atomic<bool> mRunning = true;
 
     using Work = std::function<void(renderengine::RenderEngine&)>;
-    mutable std::queue<Work> mFunctionCalls GUARDED_BY(mThreadMutex);
+    using Priority = DisplaySettings::Priority;
+
+    // Queue of work for the RenderEngine thread. Work runs in priority order, and in FIFO order
+    // within a priority.
+    class WorkQueue {
+    public:
+        void push(Work work, Priority priority = Priority::COMPOSITION);
+        bool empty() const;
+        // Removes and returns the next work to run. Must not be called on an empty queue.
+        Work pop();
+
+    private:
+        static constexpr size_t kPriorityCount = static_cast<size_t>(Priority::PREWARM) + 1;
+        std::array<std::queue<Work>, kPriorityCount> mQueues;
+    };
+    mutable WorkQueue mFunctionCalls GUARDED_BY(mThreadMutex);
     mutable std::condition_variable mCondition;
 
     // Used to allow select thread safe methods to be accessed without requiring the
@@ -64,6 +64,11 @@ ssize_t SensorEventQueue::write(const sp<BitTube>& tube,
 }
 
 ssize_t SensorEventQueue::read(ASensorEvent* events, size_t numEvents) {
+    if (mAvailable == 0 && numEvents >= MAX_RECEIVE_BUFFER_EVENT_COUNT) {
+        // The caller's buffer holds as many events as the service ever sends in one packet, so
+        // receive into it directly rather than copying through mRecBuffer.
+        return BitTube::recvObjects(mSensorChannel, events, numEvents);
+    }
     if (mAvailable == 0) {
         ssize_t err = BitTube::recvObjects(mSensorChannel,
                 mRecBuffer, MAX_RECEIVE_BUFFER_EVENT_COUNT);
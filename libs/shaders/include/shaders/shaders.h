@@ -17,6 +17,7 @@
 #pragma once
 
 #include <math/mat4.h>
+#include <math/vec2.h>
 #include <tonemap/tonemap.h>
 #include <ui/GraphicTypes.h>
 #include <cstddef>
@@ -103,4 +104,21 @@ std::vector<tonemap::ShaderUniform> buildLinearEffectUniforms(
         aidl::android::hardware::graphics::composer3::RenderIntent renderIntent =
                 aidl::android::hardware::graphics::composer3::RenderIntent::TONE_MAP_COLORIMETRIC);
 
+// Generates a shader string that applies an Ultra HDR gain map to an SDR image, the GPU
+// counterpart of JpegR::applyGainMap in libultrahdr. The shader has two children:
+// 1. "image", the SDR base image, which must be evaluated in a linear working color space.
+// 2. "gainmap", the single channel gain map, which must not be color managed (a raw image
+// shader), and is expected to be sampled with linear filtering.
+// The recovered color is left in extended range: SDR white stays at 1.0, and highlights are
+// boosted up to the display boost.
+std::string buildGainmapSkSL();
+
+// Generates a list of uniforms to set on the gain map shader above. The content boosts are the
+// linear ratios from the gain map metadata. displayBoost is the HDR/SDR ratio available on the
+// display, it is clamped to [1, maxContentBoost]. gainmapScale maps image coordinates to gain map
+// coordinates, that is the gain map size over the image size.
+std::vector<tonemap::ShaderUniform> buildGainmapUniforms(float minContentBoost,
+                                                         float maxContentBoost, float displayBoost,
+                                                         vec2 gainmapScale);
+
 } // namespace android::shaders
@@ -18,6 +18,7 @@
 
 #include <tonemap/tonemap.h>
 
+#include <algorithm>
 #include <cmath>
 #include <optional>
 
@@ -316,4 +317,40 @@ std::vector<tonemap::ShaderUniform> buildLinearEffectUniforms(
     return uniforms;
 }
 
+std::string buildGainmapSkSL() {
+    return R"(
+        uniform shader image;
+        uniform shader gainmap;
+        uniform float2 in_gainmapScale;
+        uniform float in_logMinBoost;
+        uniform float in_logMaxBoost;
+        uniform float in_boostWeight;
+
+        vec4 main(vec2 xy) {
+            vec4 color = image.eval(xy);
+            float gain = gainmap.eval(xy * in_gainmapScale).r;
+            float logBoost = mix(in_logMinBoost, in_logMaxBoost, gain);
+            color.rgb *= exp2(logBoost * in_boostWeight);
+            return color;
+        }
+    )";
+}
+
+std::vector<tonemap::ShaderUniform> buildGainmapUniforms(float minContentBoost,
+                                                         float maxContentBoost, float displayBoost,
+                                                         vec2 gainmapScale) {
+    std::vector<tonemap::ShaderUniform> uniforms;
+    // Same weighting of the log boost as GainLUT in libultrahdr, so that both paths agree.
+    const float clampedDisplayBoost =
+            std::clamp(displayBoost, 1.f, std::max(1.f, maxContentBoost));
+    uniforms.push_back({.name = "in_gainmapScale", .value = buildUniformValue<vec2>(gainmapScale)});
+    uniforms.push_back(
+            {.name = "in_logMinBoost", .value = buildUniformValue<float>(log2(minContentBoost))});
+    uniforms.push_back(
+            {.name = "in_logMaxBoost", .value = buildUniformValue<float>(log2(maxContentBoost))});
+    uniforms.push_back({.name = "in_boostWeight",
+                        .value = buildUniformValue<float>(clampedDisplayBoost / maxContentBoost)});
+    return uniforms;
+}
+
 } // namespace android::shaders
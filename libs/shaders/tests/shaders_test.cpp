@@ -93,4 +93,28 @@ TEST_F(ShadersTest, buildLinearEffectUniforms_selectsGamutTransformMatrices) {
     EXPECT_THAT(uniforms, Contains(UniformNameEq("in_colorTransform")));
 }
 
+TEST_F(ShadersTest, buildGainmapSkSL_declaresUniforms) {
+    const std::string shader = shaders::buildGainmapSkSL();
+    for (const auto& uniform : shaders::buildGainmapUniforms(0.5f, 4.f, 2.f, vec2(0.25f))) {
+        EXPECT_THAT(shader, HasSubstr(uniform.name));
+    }
+    EXPECT_THAT(shader, HasSubstr("uniform shader image"));
+    EXPECT_THAT(shader, HasSubstr("uniform shader gainmap"));
+}
+
+TEST_F(ShadersTest, buildGainmapUniforms_clampsDisplayBoost) {
+    auto uniforms = shaders::buildGainmapUniforms(0.5f, 4.f, 8.f, vec2(0.25f));
+    EXPECT_THAT(uniforms,
+                Contains(UniformEq("in_gainmapScale", buildUniformValue<vec2>(vec2(0.25f)))));
+    EXPECT_THAT(uniforms, Contains(UniformEq("in_logMinBoost", buildUniformValue<float>(-1.f))));
+    EXPECT_THAT(uniforms, Contains(UniformEq("in_logMaxBoost", buildUniformValue<float>(2.f))));
+    EXPECT_THAT(uniforms, Contains(UniformEq("in_boostWeight", buildUniformValue<float>(1.f))));
+
+    uniforms = shaders::buildGainmapUniforms(0.5f, 4.f, 2.f, vec2(0.25f));
+    EXPECT_THAT(uniforms, Contains(UniformEq("in_boostWeight", buildUniformValue<float>(0.5f))));
+
+    uniforms = shaders::buildGainmapUniforms(0.5f, 4.f, 0.5f, vec2(0.25f));
+    EXPECT_THAT(uniforms, Contains(UniformEq("in_boostWeight", buildUniformValue<float>(0.25f))));
+}
+
 } // namespace android
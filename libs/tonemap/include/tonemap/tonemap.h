@@ -21,7 +21,14 @@
 #include <android/hardware_buffer.h>
 #include <math/vec3.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <tuple>
 #include <vector>
 
 namespace android::tonemap {
@@ -83,6 +90,33 @@ struct Color {
     vec3 xyz;
 };
 
+// A precomputed sampling of a tonemapping gain curve, so that callers can look up or sample the gain
+// as a texture instead of evaluating the curve for every pixel.
+//
+// The tonemapping gain depends on a color only through a single luminance-like value, returned by
+// ToneMapper::gainLutInput(). The table samples that value at sqrt-spaced intervals over
+// [0, maxInputNits], which spends more of the entries on darker values, where the curves bend the
+// most relative to their input.
+struct TonemapGainLut {
+    // The largest input covered by the table, in nits. Larger inputs are clamped to this value.
+    float maxInputNits = 0.f;
+
+    // gains[i] is the gain for an input of maxInputNits * (i / (gains.size() - 1))^2.
+    std::vector<float> gains;
+
+    // Returns the linearly interpolated gain for an input in nits.
+    float lookup(float nits) const {
+        if (gains.size() < 2 || !(nits > 0.f)) {
+            return gains.empty() ? 1.f : gains.front();
+        }
+        const float position = std::sqrt(std::min(nits / maxInputNits, 1.f)) *
+                static_cast<float>(gains.size() - 1);
+        const size_t index = std::min(static_cast<size_t>(position), gains.size() - 2);
+        const float weight = position - static_cast<float>(index);
+        return gains[index] + (gains[index + 1] - gains[index]) * weight;
+    }
+};
+
 class ToneMapper {
 public:
     virtual ~ToneMapper() {}
@@ -148,6 +182,32 @@ public:
             aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
             aidl::android::hardware::graphics::common::Dataspace destinationDataspace,
             const std::vector<Color>& colors, const Metadata& metadata) = 0;
+
+    // Returns the value that the tonemapping gain of a color is a function of, e.g. the maximum of
+    // its RGB components, in nits. This is the input to TonemapGainLut::lookup().
+    virtual float gainLutInput(const Color& color) const = 0;
+
+    // Returns the gain curve from sourceDataspace to destinationDataspace for the given metadata,
+    // sampled by lookupTonemapGain() into a table of kGainLutSize entries.
+    //
+    // Tables are cached per transfer functions and luminance metadata, so that a caller which
+    // tonemaps every frame only pays for the curve evaluation when the display brightness or the
+    // dataspaces change. This may be called from any thread.
+    static constexpr size_t kGainLutSize = 1024;
+    std::shared_ptr<const TonemapGainLut> getTonemapGainLut(
+            aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
+            aidl::android::hardware::graphics::common::Dataspace destinationDataspace,
+            const Metadata& metadata);
+
+private:
+    // Source transfer, destination transfer, and the luminances from Metadata.
+    using GainLutKey = std::tuple<int32_t, int32_t, float, float, float>;
+
+    // Bounds the cache for callers whose display brightness changes continuously.
+    static constexpr size_t kMaxCachedGainLuts = 8;
+
+    std::mutex mGainLutMutex;
+    std::map<GainLutKey, std::shared_ptr<const TonemapGainLut>> mGainLuts;
 };
 
 // Retrieves a tonemapper instance.
@@ -85,4 +85,54 @@ TEST_F(TonemapTest, generateTonemapGainShaderSkSL_containsEntryPointForHLG) {
     EXPECT_THAT(shader, HasSubstr("float libtonemap_LookupTonemapGain(vec3 linearRGB, vec3 xyz)"));
 }
 
+TEST_F(TonemapTest, getTonemapGainLut_isCachedPerMetadata) {
+    tonemap::Metadata metadata{.displayMaxLuminance = 500.f,
+                               .contentMaxLuminance = 4000.f,
+                               .currentDisplayLuminance = 200.f};
+    auto* toneMapper = tonemap::getToneMapper();
+    const auto lut = toneMapper->getTonemapGainLut(aidl::android::hardware::graphics::common::
+                                                           Dataspace::BT2020_ITU_PQ,
+                                                   aidl::android::hardware::graphics::common::
+                                                           Dataspace::DISPLAY_P3,
+                                                   metadata);
+    ASSERT_NE(nullptr, lut);
+    EXPECT_EQ(tonemap::ToneMapper::kGainLutSize, lut->gains.size());
+    EXPECT_EQ(lut,
+              toneMapper->getTonemapGainLut(aidl::android::hardware::graphics::common::Dataspace::
+                                                    BT2020_ITU_PQ,
+                                            aidl::android::hardware::graphics::common::Dataspace::
+                                                    DISPLAY_P3,
+                                            metadata));
+
+    metadata.currentDisplayLuminance = 300.f;
+    EXPECT_NE(lut,
+              toneMapper->getTonemapGainLut(aidl::android::hardware::graphics::common::Dataspace::
+                                                    BT2020_ITU_PQ,
+                                            aidl::android::hardware::graphics::common::Dataspace::
+                                                    DISPLAY_P3,
+                                            metadata));
+}
+
+TEST_F(TonemapTest, getTonemapGainLut_matchesLookupTonemapGain) {
+    const tonemap::Metadata metadata{.displayMaxLuminance = 500.f,
+                                     .contentMaxLuminance = 4000.f,
+                                     .currentDisplayLuminance = 200.f};
+    auto* toneMapper = tonemap::getToneMapper();
+
+    for (const auto source : {aidl::android::hardware::graphics::common::Dataspace::BT2020_ITU_PQ,
+                              aidl::android::hardware::graphics::common::Dataspace::
+                                      BT2020_ITU_HLG}) {
+        const auto destination = aidl::android::hardware::graphics::common::Dataspace::DISPLAY_P3;
+        const auto lut = toneMapper->getTonemapGainLut(source, destination, metadata);
+
+        for (float nits = 0.5f; nits < lut->maxInputNits; nits *= 1.5f) {
+            const tonemap::Color color{.linearRGB = vec3(nits, nits * 0.5f, nits * 0.2f),
+                                       .xyz = vec3(nits * 0.7f, nits * 0.8f, nits * 0.3f)};
+            const auto gain = toneMapper->lookupTonemapGain(source, destination, {color}, metadata);
+            EXPECT_NEAR(gain[0], lut->lookup(toneMapper->gainLutInput(color)), gain[0] * 0.005)
+                    << "at " << nits << " nits";
+        }
+    }
+}
+
 } // namespace android
@@ -432,6 +432,8 @@ public:
         }
         return gains;
     }
+
+    float gainLutInput(const Color& color) const override { return color.xyz.y; }
 };
 
 class ToneMapper13 : public ToneMapper {
@@ -726,10 +728,54 @@ public:
         }
         return gains;
     }
+
+    float gainLutInput(const Color& color) const override {
+        return std::max({color.linearRGB.r, color.linearRGB.g, color.linearRGB.b});
+    }
 };
 
 } // namespace
 
+std::shared_ptr<const TonemapGainLut> ToneMapper::getTonemapGainLut(
+        aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
+        aidl::android::hardware::graphics::common::Dataspace destinationDataspace,
+        const Metadata& metadata) {
+    const int32_t sourceTransfer = static_cast<int32_t>(sourceDataspace) & kTransferMask;
+    const int32_t destinationTransfer = static_cast<int32_t>(destinationDataspace) & kTransferMask;
+    const GainLutKey key{sourceTransfer, destinationTransfer, metadata.displayMaxLuminance,
+                         metadata.contentMaxLuminance, metadata.currentDisplayLuminance};
+
+    {
+        std::lock_guard lock(mGainLutMutex);
+        if (const auto it = mGainLuts.find(key); it != mGainLuts.end()) {
+            return it->second;
+        }
+    }
+
+    // Sample the curve with greys, for which the RGB maximum and the luminance coincide, off the
+    // lock. Racing callers may compute the same table, but only the first one is cached.
+    auto lut = std::make_shared<TonemapGainLut>();
+    lut->maxInputNits = sourceTransfer == kTransferHLG ? 1000.f : 10000.f;
+
+    std::vector<Color> greys;
+    greys.reserve(kGainLutSize);
+    for (size_t i = 0; i < kGainLutSize; i++) {
+        const float t = static_cast<float>(i) / static_cast<float>(kGainLutSize - 1);
+        const float nits = lut->maxInputNits * t * t;
+        // Scale by the D65 white point, so that the luminance of the grey is its RGB value.
+        greys.push_back({.linearRGB = vec3(nits), .xyz = vec3(0.9505f, 1.f, 1.0891f) * nits});
+    }
+
+    const auto gains = lookupTonemapGain(sourceDataspace, destinationDataspace, greys, metadata);
+    lut->gains.assign(gains.begin(), gains.end());
+
+    std::lock_guard lock(mGainLutMutex);
+    if (mGainLuts.size() >= kMaxCachedGainLuts) {
+        mGainLuts.clear();
+    }
+    return mGainLuts.try_emplace(key, std::move(lut)).first->second;
+}
+
 ToneMapper* getToneMapper() {
     static std::once_flag sOnce;
     static std::unique_ptr<ToneMapper> sToneMapper;
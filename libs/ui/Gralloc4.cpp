@@ -216,10 +216,23 @@ status_t Gralloc4Mapper::importBuffer(const native_handle_t* rawHandle,
         *outBufferHandle = static_cast<buffer_handle_t>(tmpBuffer);
     });
 
+    if (ret.isOk() && error == Error::NONE) {
+        // Only handles imported here are cached, since freeBuffer() is then guaranteed to see
+        // them before their address can be handed out again.
+        std::lock_guard<std::mutex> lock(mImmutableMetadataMutex);
+        mImmutableMetadata[*outBufferHandle] = {.importId = ++mLastImportId};
+    }
+
     return static_cast<status_t>((ret.isOk()) ? error : kTransactionError);
 }
 
 void Gralloc4Mapper::freeBuffer(buffer_handle_t bufferHandle) const {
+    {
+        // The handle may be reused by a later import, so its metadata must not outlive it.
+        std::lock_guard<std::mutex> lock(mImmutableMetadataMutex);
+        mImmutableMetadata.erase(bufferHandle);
+    }
+
     auto buffer = const_cast<native_handle_t*>(bufferHandle);
     auto ret = mMapper->freeBuffer(buffer);
 
@@ -471,6 +484,54 @@ int Gralloc4Mapper::unlock(buffer_handle_t bufferHandle) const {
     return releaseFence;
 }
 
+status_t Gralloc4Mapper::flushLockedBuffer(buffer_handle_t bufferHandle,
+                                           int* outReleaseFence) const {
+    auto buffer = const_cast<native_handle_t*>(bufferHandle);
+
+    *outReleaseFence = -1;
+    Error error;
+    auto ret = mMapper->flushLockedBuffer(buffer,
+                                          [&](const auto& tmpError, const auto& tmpReleaseFence) {
+                                              error = tmpError;
+                                              if (error != Error::NONE) {
+                                                  return;
+                                              }
+
+                                              auto fenceHandle = tmpReleaseFence.getNativeHandle();
+                                              if (fenceHandle && fenceHandle->numFds == 1) {
+                                                  int fd = dup(fenceHandle->data[0]);
+                                                  if (fd >= 0) {
+                                                      *outReleaseFence = fd;
+                                                  } else {
+                                                      ALOGW("failed to dup flush release fence");
+                                                      sync_wait(fenceHandle->data[0], -1);
+                                                  }
+                                              }
+                                          });
+
+    if (!ret.isOk()) {
+        error = kTransactionError;
+    }
+
+    if (error != Error::NONE) {
+        ALOGE("flushLockedBuffer(%p) failed with %d", buffer, error);
+    }
+
+    return static_cast<status_t>(error);
+}
+
+status_t Gralloc4Mapper::rereadLockedBuffer(buffer_handle_t bufferHandle) const {
+    auto buffer = const_cast<native_handle_t*>(bufferHandle);
+    auto ret = mMapper->rereadLockedBuffer(buffer);
+
+    const Error error = ret.withDefault(kTransactionError);
+    if (error != Error::NONE) {
+        ALOGE("rereadLockedBuffer(%p) failed with %d", buffer, error);
+    }
+
+    return static_cast<status_t>(error);
+}
+
 status_t Gralloc4Mapper::isSupported(uint32_t width, uint32_t height, PixelFormat format,
                                      uint32_t layerCount, uint64_t usage,
                                      bool* outSupported) const {
@@ -534,6 +595,42 @@ status_t Gralloc4Mapper::get(buffer_handle_t bufferHandle, const MetadataType& m
     return decodeFunction(vec, outMetadata);
 }
 
+template <class T>
+status_t Gralloc4Mapper::getImmutable(buffer_handle_t bufferHandle,
+                                      std::optional<T> ImmutableMetadata::*field,
+                                      const MetadataType& metadataType,
+                                      DecodeFunction<T> decodeFunction, T* outMetadata) const {
+    if (!outMetadata) {
+        return BAD_VALUE;
+    }
+
+    uint64_t importId = 0;
+    {
+        std::lock_guard<std::mutex> lock(mImmutableMetadataMutex);
+        const auto it = mImmutableMetadata.find(bufferHandle);
+        // Handles this mapper did not import are not cached, since nothing would evict them when
+        // the buffer goes away.
+        if (it != mImmutableMetadata.end()) {
+            importId = it->second.importId;
+        }
+        if (importId != 0 && it->second.*field) {
+            *outMetadata = *(it->second.*field);
+            return NO_ERROR;
+        }
+    }
+
+    const status_t error = get(bufferHandle, metadataType, decodeFunction, outMetadata);
+    if (importId != 0 && error == NO_ERROR) {
+        // The buffer may have been freed, and the handle imported again, during the query.
+        std::lock_guard<std::mutex> lock(mImmutableMetadataMutex);
+        if (const auto it = mImmutableMetadata.find(bufferHandle);
+            it != mImmutableMetadata.end() && it->second.importId == importId) {
+            it->second.*field = *outMetadata;
+        }
+    }
+    return error;
+}
+
 template <class T>
 status_t Gralloc4Mapper::set(buffer_handle_t bufferHandle, const MetadataType& metadataType,
                              const T& metadata, EncodeFunction<T> encodeFunction) const {
@@ -566,66 +663,77 @@ status_t Gralloc4Mapper::set(buffer_handle_t bufferHandle, const MetadataType& m
 }
 
 status_t Gralloc4Mapper::getBufferId(buffer_handle_t bufferHandle, uint64_t* outBufferId) const {
-    return get(bufferHandle, gralloc4::MetadataType_BufferId, gralloc4::decodeBufferId,
-               outBufferId);
+    return getImmutable(bufferHandle, &ImmutableMetadata::bufferId, gralloc4::MetadataType_BufferId,
+                        gralloc4::decodeBufferId, outBufferId);
 }
 
 status_t Gralloc4Mapper::getName(buffer_handle_t bufferHandle, std::string* outName) const {
-    return get(bufferHandle, gralloc4::MetadataType_Name, gralloc4::decodeName, outName);
+    return getImmutable(bufferHandle, &ImmutableMetadata::name, gralloc4::MetadataType_Name,
+                        gralloc4::decodeName, outName);
 }
 
 status_t Gralloc4Mapper::getWidth(buffer_handle_t bufferHandle, uint64_t* outWidth) const {
-    return get(bufferHandle, gralloc4::MetadataType_Width, gralloc4::decodeWidth, outWidth);
+    return getImmutable(bufferHandle, &ImmutableMetadata::width, gralloc4::MetadataType_Width,
+                        gralloc4::decodeWidth, outWidth);
 }
 
 status_t Gralloc4Mapper::getHeight(buffer_handle_t bufferHandle, uint64_t* outHeight) const {
-    return get(bufferHandle, gralloc4::MetadataType_Height, gralloc4::decodeHeight, outHeight);
+    return getImmutable(bufferHandle, &ImmutableMetadata::height, gralloc4::MetadataType_Height,
+                        gralloc4::decodeHeight, outHeight);
 }
 
 status_t Gralloc4Mapper::getLayerCount(buffer_handle_t bufferHandle,
                                        uint64_t* outLayerCount) const {
-    return get(bufferHandle, gralloc4::MetadataType_LayerCount, gralloc4::decodeLayerCount,
-               outLayerCount);
+    return getImmutable(bufferHandle, &ImmutableMetadata::layerCount,
+                        gralloc4::MetadataType_LayerCount, gralloc4::decodeLayerCount,
+                        outLayerCount);
 }
 
 status_t Gralloc4Mapper::getPixelFormatRequested(buffer_handle_t bufferHandle,
                                                  ui::PixelFormat* outPixelFormatRequested) const {
-    return get(bufferHandle, gralloc4::MetadataType_PixelFormatRequested,
-               gralloc4::decodePixelFormatRequested, outPixelFormatRequested);
+    return getImmutable(bufferHandle, &ImmutableMetadata::pixelFormatRequested,
+                        gralloc4::MetadataType_PixelFormatRequested,
+                        gralloc4::decodePixelFormatRequested, outPixelFormatRequested);
 }
 
 status_t Gralloc4Mapper::getPixelFormatFourCC(buffer_handle_t bufferHandle,
                                               uint32_t* outPixelFormatFourCC) const {
-    return get(bufferHandle, gralloc4::MetadataType_PixelFormatFourCC,
-               gralloc4::decodePixelFormatFourCC, outPixelFormatFourCC);
+    return getImmutable(bufferHandle, &ImmutableMetadata::pixelFormatFourCC,
+                        gralloc4::MetadataType_PixelFormatFourCC, gralloc4::decodePixelFormatFourCC,
+                        outPixelFormatFourCC);
 }
 
 status_t Gralloc4Mapper::getPixelFormatModifier(buffer_handle_t bufferHandle,
                                                 uint64_t* outPixelFormatModifier) const {
-    return get(bufferHandle, gralloc4::MetadataType_PixelFormatModifier,
-               gralloc4::decodePixelFormatModifier, outPixelFormatModifier);
+    return getImmutable(bufferHandle, &ImmutableMetadata::pixelFormatModifier,
+                        gralloc4::MetadataType_PixelFormatModifier,
+                        gralloc4::decodePixelFormatModifier, outPixelFormatModifier);
 }
 
 status_t Gralloc4Mapper::getUsage(buffer_handle_t bufferHandle, uint64_t* outUsage) const {
-    return get(bufferHandle, gralloc4::MetadataType_Usage, gralloc4::decodeUsage, outUsage);
+    return getImmutable(bufferHandle, &ImmutableMetadata::usage, gralloc4::MetadataType_Usage,
+                        gralloc4::decodeUsage, outUsage);
 }
 
 status_t Gralloc4Mapper::getAllocationSize(buffer_handle_t bufferHandle,
                                            uint64_t* outAllocationSize) const {
-    return get(bufferHandle, gralloc4::MetadataType_AllocationSize, gralloc4::decodeAllocationSize,
-               outAllocationSize);
+    return getImmutable(bufferHandle, &ImmutableMetadata::allocationSize,
+                        gralloc4::MetadataType_AllocationSize, gralloc4::decodeAllocationSize,
+                        outAllocationSize);
 }
 
 status_t Gralloc4Mapper::getProtectedContent(buffer_handle_t bufferHandle,
                                              uint64_t* outProtectedContent) const {
-    return get(bufferHandle, gralloc4::MetadataType_ProtectedContent,
-               gralloc4::decodeProtectedContent, outProtectedContent);
+    return getImmutable(bufferHandle, &ImmutableMetadata::protectedContent,
+                        gralloc4::MetadataType_ProtectedContent, gralloc4::decodeProtectedContent,
+                        outProtectedContent);
 }
 
 status_t Gralloc4Mapper::getCompression(buffer_handle_t bufferHandle,
                                         ExtendableType* outCompression) const {
-    return get(bufferHandle, gralloc4::MetadataType_Compression, gralloc4::decodeCompression,
-               outCompression);
+    return getImmutable(bufferHandle, &ImmutableMetadata::compression,
+                        gralloc4::MetadataType_Compression, gralloc4::decodeCompression,
+                        outCompression);
 }
 
 status_t Gralloc4Mapper::getCompression(buffer_handle_t bufferHandle,
@@ -647,8 +755,9 @@ status_t Gralloc4Mapper::getCompression(buffer_handle_t bufferHandle,
 
 status_t Gralloc4Mapper::getInterlaced(buffer_handle_t bufferHandle,
                                        ExtendableType* outInterlaced) const {
-    return get(bufferHandle, gralloc4::MetadataType_Interlaced, gralloc4::decodeInterlaced,
-               outInterlaced);
+    return getImmutable(bufferHandle, &ImmutableMetadata::interlaced,
+                        gralloc4::MetadataType_Interlaced, gralloc4::decodeInterlaced,
+                        outInterlaced);
 }
 
 status_t Gralloc4Mapper::getInterlaced(buffer_handle_t bufferHandle,
@@ -670,8 +779,9 @@ status_t Gralloc4Mapper::getInterlaced(buffer_handle_t bufferHandle,
 
 status_t Gralloc4Mapper::getChromaSiting(buffer_handle_t bufferHandle,
                                          ExtendableType* outChromaSiting) const {
-    return get(bufferHandle, gralloc4::MetadataType_ChromaSiting, gralloc4::decodeChromaSiting,
-               outChromaSiting);
+    return getImmutable(bufferHandle, &ImmutableMetadata::chromaSiting,
+                        gralloc4::MetadataType_ChromaSiting, gralloc4::decodeChromaSiting,
+                        outChromaSiting);
 }
 
 status_t Gralloc4Mapper::getChromaSiting(buffer_handle_t bufferHandle,
@@ -693,8 +803,9 @@ status_t Gralloc4Mapper::getChromaSiting(buffer_handle_t bufferHandle,
 
 status_t Gralloc4Mapper::getPlaneLayouts(buffer_handle_t bufferHandle,
                                          std::vector<ui::PlaneLayout>* outPlaneLayouts) const {
-    return get(bufferHandle, gralloc4::MetadataType_PlaneLayouts, gralloc4::decodePlaneLayouts,
-               outPlaneLayouts);
+    return getImmutable(bufferHandle, &ImmutableMetadata::planeLayouts,
+                        gralloc4::MetadataType_PlaneLayouts, gralloc4::decodePlaneLayouts,
+                        outPlaneLayouts);
 }
 
 status_t Gralloc4Mapper::getDataspace(buffer_handle_t bufferHandle,
@@ -530,6 +530,22 @@ int Gralloc5Mapper::unlock(buffer_handle_t bufferHandle) const {
     return fence;
 }
 
+status_t Gralloc5Mapper::flushLockedBuffer(buffer_handle_t bufferHandle,
+                                           int *outReleaseFence) const {
+    // Gralloc5 flushes synchronously, so there is never a release fence.
+    *outReleaseFence = -1;
+    AIMapper_Error error = mMapper->v5.flushLockedBuffer(bufferHandle);
+    ALOGW_IF(error != AIMAPPER_ERROR_NONE, "flushLockedBuffer(%p) failed: %d", bufferHandle, error);
+    return static_cast<status_t>(error);
+}
+
+status_t Gralloc5Mapper::rereadLockedBuffer(buffer_handle_t bufferHandle) const {
+    AIMapper_Error error = mMapper->v5.rereadLockedBuffer(bufferHandle);
+    ALOGW_IF(error != AIMAPPER_ERROR_NONE, "rereadLockedBuffer(%p) failed: %d", bufferHandle,
+             error);
+    return static_cast<status_t>(error);
+}
+
 status_t Gralloc5Mapper::isSupported(uint32_t width, uint32_t height, PixelFormat format,
                                      uint32_t layerCount, uint64_t usage,
                                      bool *outSupported) const {
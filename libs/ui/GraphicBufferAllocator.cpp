@@ -21,6 +21,7 @@
 #include <ui/GraphicBufferAllocator.h>
 
 #include <limits.h>
+#include <pthread.h>
 #include <stdio.h>
 
 #include <grallocusage/GrallocUsageConversion.h>
@@ -72,7 +73,16 @@ GraphicBufferAllocator::GraphicBufferAllocator() : mMapper(GraphicBufferMapper::
                         mMapper.getMapperVersion());
 }
 
-GraphicBufferAllocator::~GraphicBufferAllocator() {}
+GraphicBufferAllocator::~GraphicBufferAllocator() {
+    {
+        std::lock_guard<std::mutex> lock(mAsyncLock);
+        mAsyncStop = true;
+    }
+    mAsyncCondition.notify_one();
+    if (mAsyncThread.joinable()) {
+        mAsyncThread.join();
+    }
+}
 
 uint64_t GraphicBufferAllocator::getTotalSize() const {
     Mutex::Autolock _l(sLock);
@@ -115,8 +125,9 @@ void GraphicBufferAllocator::dumpToSystemLog(bool less) {
 
 status_t GraphicBufferAllocator::allocateHelper(uint32_t width, uint32_t height, PixelFormat format,
                                                 uint32_t layerCount, uint64_t usage,
-                                                buffer_handle_t* handle, uint32_t* stride,
-                                                std::string requestorName, bool importBuffer) {
+                                                uint32_t bufferCount, buffer_handle_t* handles,
+                                                uint32_t* stride, std::string requestorName,
+                                                bool importBuffer) {
     ATRACE_CALL();
 
     // make sure to not allocate a N x 0 or 0 x N buffer, since this is
@@ -141,11 +152,11 @@ status_t GraphicBufferAllocator::allocateHelper(uint32_t width, uint32_t height,
     usage &= ~static_cast<uint64_t>((1 << 10) | (1 << 13));
 
     status_t error = mAllocator->allocate(requestorName, width, height, format, layerCount, usage,
-                                          1, stride, handle, importBuffer);
+                                          bufferCount, stride, handles, importBuffer);
     if (error != NO_ERROR) {
-        ALOGE("Failed to allocate (%u x %u) layerCount %u format %d "
+        ALOGE("Failed to allocate %u x (%u x %u) layerCount %u format %d "
               "usage %" PRIx64 ": %d",
-              width, height, layerCount, format, usage, error);
+              bufferCount, width, height, layerCount, format, usage, error);
         return error;
     }
 
@@ -174,7 +185,9 @@ status_t GraphicBufferAllocator::allocateHelper(uint32_t width, uint32_t height,
     rec.usage = usage;
     rec.size = bufSize;
     rec.requestorName = std::move(requestorName);
-    list.add(*handle, rec);
+    for (uint32_t i = 0; i < bufferCount; i++) {
+        list.add(handles[i], rec);
+    }
 
     return NO_ERROR;
 }
@@ -182,16 +195,16 @@ status_t GraphicBufferAllocator::allocate(uint32_t width, uint32_t height, Pixel
                                           uint32_t layerCount, uint64_t usage,
                                           buffer_handle_t* handle, uint32_t* stride,
                                           std::string requestorName) {
-    return allocateHelper(width, height, format, layerCount, usage, handle, stride, requestorName,
-                          true);
+    return allocateHelper(width, height, format, layerCount, usage, 1, handle, stride,
+                          std::move(requestorName), true);
 }
 
 status_t GraphicBufferAllocator::allocateRawHandle(uint32_t width, uint32_t height,
                                                    PixelFormat format, uint32_t layerCount,
                                                    uint64_t usage, buffer_handle_t* handle,
                                                    uint32_t* stride, std::string requestorName) {
-    return allocateHelper(width, height, format, layerCount, usage, handle, stride, requestorName,
-                          false);
+    return allocateHelper(width, height, format, layerCount, usage, 1, handle, stride,
+                          std::move(requestorName), false);
 }
 
 // DEPRECATED
@@ -199,8 +212,67 @@ status_t GraphicBufferAllocator::allocate(uint32_t width, uint32_t height, Pixel
                                           uint32_t layerCount, uint64_t usage,
                                           buffer_handle_t* handle, uint32_t* stride,
                                           uint64_t /*graphicBufferId*/, std::string requestorName) {
-    return allocateHelper(width, height, format, layerCount, usage, handle, stride, requestorName,
-                          true);
+    return allocateHelper(width, height, format, layerCount, usage, 1, handle, stride,
+                          std::move(requestorName), true);
+}
+
+status_t GraphicBufferAllocator::allocateBatch(uint32_t width, uint32_t height, PixelFormat format,
+                                               uint32_t layerCount, uint64_t usage,
+                                               uint32_t bufferCount, buffer_handle_t* handles,
+                                               uint32_t* stride, std::string requestorName) {
+    if (bufferCount == 0) {
+        return BAD_VALUE;
+    }
+    return allocateHelper(width, height, format, layerCount, usage, bufferCount, handles, stride,
+                          std::move(requestorName), true);
+}
+
+void GraphicBufferAllocator::allocateBatchAsync(uint32_t width, uint32_t height,
+                                                PixelFormat format, uint32_t layerCount,
+                                                uint64_t usage, uint32_t bufferCount,
+                                                std::string requestorName,
+                                                AllocateCallback callback) {
+    auto request = [this, width, height, format, layerCount, usage, bufferCount,
+                    requestorName = std::move(requestorName),
+                    callback = std::move(callback)]() mutable {
+        std::vector<buffer_handle_t> handles(bufferCount);
+        uint32_t stride = 0;
+        const status_t error = allocateBatch(width, height, format, layerCount, usage,
+                                             bufferCount, handles.data(), &stride,
+                                             std::move(requestorName));
+        if (error != NO_ERROR) {
+            handles.clear();
+        }
+        callback(error, std::move(handles), stride);
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mAsyncLock);
+        if (!mAsyncThread.joinable()) {
+            mAsyncThread = std::thread(&GraphicBufferAllocator::asyncThreadMain, this);
+        }
+        mAsyncRequests.push_back(std::move(request));
+    }
+    mAsyncCondition.notify_one();
+}
+
+void GraphicBufferAllocator::asyncThreadMain() {
+    pthread_setname_np(pthread_self(), "GBAllocAsync");
+
+    std::unique_lock<std::mutex> lock(mAsyncLock);
+    while (true) {
+        mAsyncCondition.wait(lock, [this] { return mAsyncStop || !mAsyncRequests.empty(); });
+        if (mAsyncRequests.empty()) {
+            return;
+        }
+
+        auto request = std::move(mAsyncRequests.front());
+        mAsyncRequests.pop_front();
+
+        lock.unlock();
+        request();
+        lock.lock();
+    }
 }
 
 status_t GraphicBufferAllocator::free(buffer_handle_t handle)
@@ -194,6 +194,18 @@ status_t GraphicBufferMapper::unlockAsync(buffer_handle_t handle, int *fenceFd)
     return NO_ERROR;
 }
 
+status_t GraphicBufferMapper::flushLockedBuffer(buffer_handle_t handle, int* outFenceFd) {
+    ATRACE_CALL();
+
+    return mMapper->flushLockedBuffer(handle, outFenceFd);
+}
+
+status_t GraphicBufferMapper::rereadLockedBuffer(buffer_handle_t handle) {
+    ATRACE_CALL();
+
+    return mMapper->rereadLockedBuffer(handle);
+}
+
 status_t GraphicBufferMapper::isSupported(uint32_t width, uint32_t height,
                                           android::PixelFormat format, uint32_t layerCount,
                                           uint64_t usage, bool* outSupported) {
@@ -19,6 +19,8 @@
 #include <inttypes.h>
 #include <limits.h>
 
+#include <algorithm>
+
 #include <android-base/stringprintf.h>
 
 #include <utils/Log.h>
@@ -101,7 +103,8 @@ Region::~Region()
  * final, correctly ordered region buffer. Each rectangle will be compared with the span directly
  * above it, and subdivided to resolve any remaining T-junctions.
  */
-static void reverseRectsResolvingJunctions(const Rect* begin, const Rect* end, FatVector<Rect>& dst,
+template <typename RectVector>
+static void reverseRectsResolvingJunctions(const Rect* begin, const Rect* end, RectVector& dst,
                                            int spanDirection) {
     dst.clear();
 
@@ -202,7 +205,7 @@ Region Region::createTJunctionFreeRegion(const Region& r) {
     if (r.isEmpty()) return r;
     if (r.isRect()) return r;
 
-    FatVector<Rect> reversed;
+    Storage reversed;
     reverseRectsResolvingJunctions(r.begin(), r.end(), reversed, direction_RTL);
 
     Region outputRegion;
@@ -329,6 +332,9 @@ Region& Region::subtractSelf(const Rect& r) {
     return operationSelf(r, op_nand);
 }
 Region& Region::operationSelf(const Rect& r, uint32_t op) {
+    if (isRect() && rect_boolean_operation(op, *this, getBounds(), r)) {
+        return *this;
+    }
     Region lhs(*this);
     boolean_operation(op, *this, lhs, r);
     return *this;
@@ -353,6 +359,10 @@ Region& Region::subtractSelf(const Region& rhs) {
     return operationSelf(rhs, op_nand);
 }
 Region& Region::operationSelf(const Region& rhs, uint32_t op) {
+    if (isRect() && rhs.isRect() &&
+            rect_boolean_operation(op, *this, getBounds(), rhs.getBounds())) {
+        return *this;
+    }
     Region lhs(*this);
     boolean_operation(op, *this, lhs, rhs);
     return *this;
@@ -470,7 +480,7 @@ const Region Region::operation(const Region& rhs, int dx, int dy, uint32_t op) c
 class Region::rasterizer : public region_operator<Rect>::region_rasterizer
 {
     Rect bounds;
-    FatVector<Rect>& storage;
+    Storage& storage;
     Rect* head;
     Rect* tail;
     FatVector<Rect> span;
@@ -643,6 +653,69 @@ bool Region::validate(const Region& reg, const char* name, bool silent)
     return result;
 }
 
+bool Region::rect_boolean_operation(uint32_t op, Region& dst, Rect lhs, Rect rhs)
+{
+    // Empty and invalid rects are left to the general algorithm.
+    if (lhs.isEmpty() || rhs.isEmpty()) {
+        return false;
+    }
+
+    Rect overlap;
+    const bool overlaps = lhs.intersect(rhs, &overlap);
+    switch (op) {
+        case op_and:
+            dst.set(overlaps ? overlap : Rect(0, 0));
+            return true;
+        case op_or:
+            if (overlaps && overlap == rhs) {
+                dst.set(lhs);
+                return true;
+            }
+            if (overlaps && overlap == lhs) {
+                dst.set(rhs);
+                return true;
+            }
+            return false;
+        case op_nand: {
+            if (!overlaps) {
+                dst.set(lhs);
+                return true;
+            }
+            if (overlap == lhs) {
+                dst.clear();
+                return true;
+            }
+            // What's left of lhs is at most a band above the overlap, a left
+            // and a right part beside it, and a band below it. None of them
+            // can be merged, so this is what the rasterizer produces too.
+            Storage& storage = dst.mStorage;
+            storage.clear();
+            if (overlap.top > lhs.top) {
+                storage.push_back(Rect(lhs.left, lhs.top, lhs.right, overlap.top));
+            }
+            if (overlap.left > lhs.left) {
+                storage.push_back(Rect(lhs.left, overlap.top, overlap.left, overlap.bottom));
+            }
+            if (overlap.right < lhs.right) {
+                storage.push_back(Rect(overlap.right, overlap.top, lhs.right, overlap.bottom));
+            }
+            if (overlap.bottom < lhs.bottom) {
+                storage.push_back(Rect(lhs.left, overlap.bottom, lhs.right, lhs.bottom));
+            }
+            if (storage.size() > 1) {
+                Rect bounds(INT_MAX, storage.front().top, INT_MIN, storage.back().bottom);
+                for (const Rect& rect : storage) {
+                    bounds.left = std::min(bounds.left, rect.left);
+                    bounds.right = std::max(bounds.right, rect.right);
+                }
+                storage.push_back(bounds);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
 void Region::boolean_operation(uint32_t op, Region& dst,
         const Region& lhs,
         const Region& rhs, int dx, int dy)
@@ -653,6 +726,13 @@ void Region::boolean_operation(uint32_t op, Region& dst,
     validate(dst, "boolean_operation (before): dst");
 #endif
 
+#if !VALIDATE_WITH_CORECG
+    if (lhs.isRect() && rhs.isRect() &&
+            rect_boolean_operation(op, dst, lhs.getBounds(), rhs.getBounds().offsetBy(dx, dy))) {
+        return;
+    }
+#endif
+
     size_t lhs_count;
     Rect const * const lhs_rects = lhs.getArray(&lhs_count);
 
@@ -767,6 +847,11 @@ void Region::boolean_operation(uint32_t op, Region& dst,
 #if VALIDATE_WITH_CORECG || defined(VALIDATE_REGIONS)
     boolean_operation(op, dst, lhs, Region(rhs), dx, dy);
 #else
+    if (lhs.isRect() && rect_boolean_operation(op, dst, lhs.getBounds(),
+                                               Rect(rhs).offsetBy(dx, dy))) {
+        return;
+    }
+
     size_t lhs_count;
     Rect const * const lhs_rects = lhs.getArray(&lhs_count);
 
@@ -67,10 +67,28 @@ Transform Transform::operator*(const Transform& rhs) const {
     if (rhs.mType == IDENTITY)
         return r;
 
-    // TODO: we could use mType to optimize the matrix multiply
     const mat33& A(mMatrix);
     const mat33& B(rhs.mMatrix);
           mat33& D(r.mMatrix);
+
+    // Layer geometry is dominated by translations and axis-aligned scales, which compose without a
+    // full matrix multiply. type() ignores the last row, so these paths also require it to be affine.
+    const uint32_t types = type() | rhs.type();
+    if ((types & 0xFF) <= TRANSLATE && isAffine() && rhs.isAffine()) {
+        D[2][0] = A[2][0] + B[2][0];
+        D[2][1] = A[2][1] + B[2][1];
+        r.mType = isZero(D[2][0]) && isZero(D[2][1]) ? IDENTITY : TRANSLATE;
+        return r;
+    }
+    if (!(types & (ROTATE | UNKNOWN)) && isAffine() && rhs.isAffine()) {
+        D[0][0] = A[0][0] * B[0][0];
+        D[1][1] = A[1][1] * B[1][1];
+        D[2][0] = A[0][0] * B[2][0] + A[2][0];
+        D[2][1] = A[1][1] * B[2][1] + A[2][1];
+        r.mType = UNKNOWN_TYPE;
+        return r;
+    }
+
     for (size_t i = 0; i < 3; i++) {
         const float v0 = A[0][i];
         const float v1 = A[1][i];
@@ -252,50 +270,76 @@ Rect Transform::makeBounds(int w, int h) const {
 }
 
 Rect Transform::transform(const Rect& bounds, bool roundOutwards) const {
+    const FloatRect f = transformBounds(FloatRect(bounds.left, bounds.top, bounds.right,
+                                                  bounds.bottom),
+                                        type());
     Rect r;
-    vec2 lt( bounds.left,  bounds.top    );
-    vec2 rt( bounds.right, bounds.top    );
-    vec2 lb( bounds.left,  bounds.bottom );
-    vec2 rb( bounds.right, bounds.bottom );
-
-    lt = transform(lt);
-    rt = transform(rt);
-    lb = transform(lb);
-    rb = transform(rb);
-
     if (roundOutwards) {
-        r.left   = static_cast<int32_t>(floorf(std::min({lt[0], rt[0], lb[0], rb[0]})));
-        r.top    = static_cast<int32_t>(floorf(std::min({lt[1], rt[1], lb[1], rb[1]})));
-        r.right  = static_cast<int32_t>(ceilf(std::max({lt[0], rt[0], lb[0], rb[0]})));
-        r.bottom = static_cast<int32_t>(ceilf(std::max({lt[1], rt[1], lb[1], rb[1]})));
+        r.left   = static_cast<int32_t>(floorf(f.left));
+        r.top    = static_cast<int32_t>(floorf(f.top));
+        r.right  = static_cast<int32_t>(ceilf(f.right));
+        r.bottom = static_cast<int32_t>(ceilf(f.bottom));
     } else {
-        r.left   = static_cast<int32_t>(floorf(std::min({lt[0], rt[0], lb[0], rb[0]}) + 0.5f));
-        r.top    = static_cast<int32_t>(floorf(std::min({lt[1], rt[1], lb[1], rb[1]}) + 0.5f));
-        r.right  = static_cast<int32_t>(floorf(std::max({lt[0], rt[0], lb[0], rb[0]}) + 0.5f));
-        r.bottom = static_cast<int32_t>(floorf(std::max({lt[1], rt[1], lb[1], rb[1]}) + 0.5f));
+        r.left   = static_cast<int32_t>(floorf(f.left + 0.5f));
+        r.top    = static_cast<int32_t>(floorf(f.top + 0.5f));
+        r.right  = static_cast<int32_t>(floorf(f.right + 0.5f));
+        r.bottom = static_cast<int32_t>(floorf(f.bottom + 0.5f));
     }
 
     return r;
 }
 
 FloatRect Transform::transform(const FloatRect& bounds) const {
-    vec2 lt(bounds.left, bounds.top);
-    vec2 rt(bounds.right, bounds.top);
-    vec2 lb(bounds.left, bounds.bottom);
-    vec2 rb(bounds.right, bounds.bottom);
-
-    lt = transform(lt);
-    rt = transform(rt);
-    lb = transform(lb);
-    rb = transform(rb);
-
-    FloatRect r;
-    r.left = std::min({lt[0], rt[0], lb[0], rb[0]});
-    r.top = std::min({lt[1], rt[1], lb[1], rb[1]});
-    r.right = std::max({lt[0], rt[0], lb[0], rb[0]});
-    r.bottom = std::max({lt[1], rt[1], lb[1], rb[1]});
+    return transformBounds(bounds, type());
+}
 
-    return r;
+void Transform::transform(const vec2* points, vec2* out, size_t count) const {
+    if ((type() & 0xFF) <= TRANSLATE) {
+        const vec2 t(tx(), ty());
+        for (size_t i = 0; i < count; i++) {
+            out[i] = points[i] + t;
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = transform(points[i]);
+        }
+    }
+}
+
+void Transform::transform(const FloatRect* rects, FloatRect* out, size_t count) const {
+    const uint32_t t = type();
+    for (size_t i = 0; i < count; i++) {
+        out[i] = transformBounds(rects[i], t);
+    }
+}
+
+FloatRect Transform::transformBounds(const FloatRect& bounds, uint32_t type) const {
+    if ((type & 0xFF) <= TRANSLATE) {
+        const float x = tx();
+        const float y = ty();
+        return FloatRect(std::min(bounds.left, bounds.right) + x,
+                         std::min(bounds.top, bounds.bottom) + y,
+                         std::max(bounds.left, bounds.right) + x,
+                         std::max(bounds.top, bounds.bottom) + y);
+    }
+
+    const vec2 lt = transform(vec2(bounds.left, bounds.top));
+    const vec2 rb = transform(vec2(bounds.right, bounds.bottom));
+    if (!((type >> 8) & ROT_INVALID)) {
+        // Axes map onto axes, so opposite corners map onto opposite corners of the bounds.
+        return FloatRect(std::min(lt[0], rb[0]), std::min(lt[1], rb[1]),
+                         std::max(lt[0], rb[0]), std::max(lt[1], rb[1]));
+    }
+
+    const vec2 rt = transform(vec2(bounds.right, bounds.top));
+    const vec2 lb = transform(vec2(bounds.left, bounds.bottom));
+    return FloatRect(std::min({lt[0], rt[0], lb[0], rb[0]}), std::min({lt[1], rt[1], lb[1], rb[1]}),
+                     std::max({lt[0], rt[0], lb[0], rb[0]}), std::max({lt[1], rt[1], lb[1], rb[1]}));
+}
+
+bool Transform::isAffine() const {
+    const mat33& M(mMatrix);
+    return isZero(M[0][2]) && isZero(M[1][2]) && M[2][2] == 1.0f;
 }
 
 Region Transform::transform(const Region& reg) const {
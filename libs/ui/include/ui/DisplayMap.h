@@ -29,6 +29,9 @@ using DisplayMap = ftl::SmallMap<Key, Value, 5>;
 template <typename Key, typename Value>
 using PhysicalDisplayMap = ftl::SmallMap<Key, Value, 3>;
 
+template <typename T>
+using DisplayVector = ftl::SmallVector<T, 5>;
+
 template <typename T>
 using PhysicalDisplayVector = ftl::SmallVector<T, 3>;
 
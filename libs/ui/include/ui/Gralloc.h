@@ -71,6 +71,20 @@ public:
     // owned by the caller
     virtual int unlock(buffer_handle_t bufferHandle) const = 0;
 
+    // flushLockedBuffer makes CPU writes to a buffer that remains locked visible to other devices.
+    // *outReleaseFence is set to a fence sync object (or -1) owned by the caller, which signals
+    // once the flush has completed.
+    virtual status_t flushLockedBuffer(buffer_handle_t /*bufferHandle*/,
+                                       int* /*outReleaseFence*/) const {
+        return INVALID_OPERATION;
+    }
+
+    // rereadLockedBuffer makes writes by other devices visible to the CPU mapping of a buffer that
+    // remains locked.
+    virtual status_t rereadLockedBuffer(buffer_handle_t /*bufferHandle*/) const {
+        return INVALID_OPERATION;
+    }
+
     // isSupported queries whether or not a buffer with the given width, height,
     // format, layer count, and usage can be allocated on the device.  If
     // *outSupported is set to true, a buffer with the given specifications may be successfully
@@ -27,7 +27,11 @@
 #include <ui/Rect.h>
 #include <utils/StrongPointer.h>
 
+#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace android {
 
@@ -65,6 +69,10 @@ public:
 
     int unlock(buffer_handle_t bufferHandle) const override;
 
+    status_t flushLockedBuffer(buffer_handle_t bufferHandle, int* outReleaseFence) const override;
+
+    status_t rereadLockedBuffer(buffer_handle_t bufferHandle) const override;
+
     status_t isSupported(uint32_t width, uint32_t height, PixelFormat format, uint32_t layerCount,
                          uint64_t usage, bool* outSupported) const override;
 
@@ -138,6 +146,36 @@ private:
             const android::hardware::graphics::mapper::V4_0::IMapper::MetadataType& metadataType,
             DecodeFunction<T> decodeFunction, T* outMetadata) const;
 
+    // Metadata that cannot change over the lifetime of a buffer, cached per imported handle to
+    // avoid a mapper HAL call and decode on every query. Mutable metadata like the dataspace and
+    // HDR metadata is always queried. Entries are created by importBuffer() and evicted by
+    // freeBuffer(); handles this mapper did not import are never cached.
+    struct ImmutableMetadata {
+        // Distinguishes successive imports that were given the same handle.
+        uint64_t importId = 0;
+        std::optional<uint64_t> bufferId;
+        std::optional<std::string> name;
+        std::optional<uint64_t> width;
+        std::optional<uint64_t> height;
+        std::optional<uint64_t> layerCount;
+        std::optional<ui::PixelFormat> pixelFormatRequested;
+        std::optional<uint32_t> pixelFormatFourCC;
+        std::optional<uint64_t> pixelFormatModifier;
+        std::optional<uint64_t> usage;
+        std::optional<uint64_t> allocationSize;
+        std::optional<uint64_t> protectedContent;
+        std::optional<aidl::android::hardware::graphics::common::ExtendableType> compression;
+        std::optional<aidl::android::hardware::graphics::common::ExtendableType> interlaced;
+        std::optional<aidl::android::hardware::graphics::common::ExtendableType> chromaSiting;
+        std::optional<std::vector<ui::PlaneLayout>> planeLayouts;
+    };
+
+    template <class T>
+    status_t getImmutable(
+            buffer_handle_t bufferHandle, std::optional<T> ImmutableMetadata::*field,
+            const android::hardware::graphics::mapper::V4_0::IMapper::MetadataType& metadataType,
+            DecodeFunction<T> decodeFunction, T* outMetadata) const;
+
     template <class T>
     status_t set(
             buffer_handle_t bufferHandle,
@@ -161,6 +199,11 @@ private:
             std::ostringstream* outDump, uint64_t* outAllocationSize, bool less) const;
 
     sp<hardware::graphics::mapper::V4_0::IMapper> mMapper;
+
+    // Guarded by mImmutableMetadataMutex.
+    mutable std::mutex mImmutableMetadataMutex;
+    mutable std::unordered_map<buffer_handle_t, ImmutableMetadata> mImmutableMetadata;
+    mutable uint64_t mLastImportId = 0;
 };
 
 class Gralloc4Allocator : public GrallocAllocator {
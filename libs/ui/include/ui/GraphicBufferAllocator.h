@@ -20,8 +20,14 @@
 
 #include <stdint.h>
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <cutils/native_handle.h>
 
@@ -70,6 +76,29 @@ public:
             buffer_handle_t* handle, uint32_t* stride, uint64_t graphicBufferId,
             std::string requestorName);
 
+    /**
+     * Allocates and imports bufferCount gralloc buffers of the same description with a single
+     * allocator call. handles must have room for bufferCount handles, all of which share the
+     * returned stride. On error, no buffers are allocated.
+     *
+     * Each handle must be freed with GraphicBufferAllocator::free() when no longer needed.
+     */
+    status_t allocateBatch(uint32_t w, uint32_t h, PixelFormat format, uint32_t layerCount,
+                           uint64_t usage, uint32_t bufferCount, buffer_handle_t* handles,
+                           uint32_t* stride, std::string requestorName);
+
+    using AllocateCallback =
+            std::function<void(status_t, std::vector<buffer_handle_t> handles, uint32_t stride)>;
+
+    /**
+     * Like allocateBatch(), but returns immediately. The callback is invoked on an internal thread
+     * once the buffers are allocated, or allocation has failed, in which case handles is empty.
+     * Requests complete in the order they were made.
+     */
+    void allocateBatchAsync(uint32_t w, uint32_t h, PixelFormat format, uint32_t layerCount,
+                            uint64_t usage, uint32_t bufferCount, std::string requestorName,
+                            AllocateCallback callback);
+
     status_t free(buffer_handle_t handle);
 
     uint64_t getTotalSize() const;
@@ -90,8 +119,10 @@ protected:
     };
 
     status_t allocateHelper(uint32_t w, uint32_t h, PixelFormat format, uint32_t layerCount,
-                            uint64_t usage, buffer_handle_t* handle, uint32_t* stride,
-                            std::string requestorName, bool importBuffer);
+                            uint64_t usage, uint32_t bufferCount, buffer_handle_t* handles,
+                            uint32_t* stride, std::string requestorName, bool importBuffer);
+
+    void asyncThreadMain();
 
     static Mutex sLock;
     static KeyedVector<buffer_handle_t, alloc_rec_t> sAllocList;
@@ -102,6 +133,13 @@ protected:
 
     GraphicBufferMapper& mMapper;
     std::unique_ptr<const GrallocAllocator> mAllocator;
+
+    // Started on the first allocateBatchAsync() call.
+    std::mutex mAsyncLock;
+    std::condition_variable mAsyncCondition;
+    std::deque<std::function<void()>> mAsyncRequests;
+    bool mAsyncStop = false;
+    std::thread mAsyncThread;
 };
 
 // ---------------------------------------------------------------------------
@@ -88,6 +88,17 @@ public:
 
     status_t unlockAsync(buffer_handle_t handle, int *fenceFd);
 
+    /**
+     * Synchronizes the CPU mapping of a locked buffer with other devices, without unlocking it.
+     * flushLockedBuffer publishes CPU writes and returns a fence that signals once they are
+     * visible, and rereadLockedBuffer picks up writes made by other devices since the buffer was
+     * locked. Together they allow a buffer to stay mapped across frames.
+     *
+     * These functions are supported by gralloc 4.0+.
+     */
+    status_t flushLockedBuffer(buffer_handle_t handle, int* outFenceFd);
+    status_t rereadLockedBuffer(buffer_handle_t handle);
+
     status_t isSupported(uint32_t width, uint32_t height, android::PixelFormat format,
                          uint32_t layerCount, uint64_t usage, bool* outSupported);
 
@@ -171,6 +171,10 @@ private:
     static void boolean_operation(uint32_t op, Region& dst,
             const Region& lhs, const Rect& rhs);
 
+    // Computes the common operations on two non-empty rects without going
+    // through the rasterizer. Returns false if the general algorithm is needed.
+    static bool rect_boolean_operation(uint32_t op, Region& dst, Rect lhs, Rect rhs);
+
     static void translate(Region& reg, int dx, int dy);
     static void translate(Region& dst, const Region& reg, int dx, int dy);
 
@@ -181,7 +185,11 @@ private:
     // with an extra Rect as the last element which is set to the
     // bounds of the region. However, if the region is
     // a simple Rect then mStorage contains only that rect.
-    FatVector<Rect> mStorage;
+    // Up to kInlineRects entries are kept inline, which covers a rect with
+    // a hole in it (four rects and the bounds) without a heap allocation.
+    static constexpr size_t kInlineRects = 8;
+    using Storage = FatVector<Rect, kInlineRects>;
+    Storage mStorage;
 };
 
 
@@ -96,6 +96,9 @@ public:
     Rect    transform(const Rect& bounds,
                       bool roundOutwards = false) const;
     FloatRect transform(const FloatRect& bounds) const;
+    // Transforms |count| points or rects into |out|, classifying the transform once per batch.
+    void transform(const vec2* points, vec2* out, size_t count) const;
+    void transform(const FloatRect* rects, FloatRect* out, size_t count) const;
     Transform& operator = (const Transform& other);
     Transform operator * (const Transform& rhs) const;
     Transform operator * (float value) const;
@@ -125,6 +128,8 @@ private:
     enum { UNKNOWN_TYPE = 0x80000000 };
 
     uint32_t type() const;
+    FloatRect transformBounds(const FloatRect& bounds, uint32_t type) const;
+    bool isAffine() const;
     static bool absIsOne(float f);
     static bool isZero(float f);
 
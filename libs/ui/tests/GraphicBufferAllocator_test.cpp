@@ -25,6 +25,7 @@
 #include "mock/MockGrallocAllocator.h"
 
 #include <algorithm>
+#include <future>
 #include <limits>
 
 namespace android {
@@ -38,7 +39,9 @@ constexpr uint64_t kTestUsage = GraphicBuffer::USAGE_SW_WRITE_OFTEN;
 
 } // namespace
 
+using ::testing::_;
 using ::testing::DoAll;
+using ::testing::Invoke;
 using ::testing::Return;
 using ::testing::SetArgPointee;
 
@@ -53,6 +56,22 @@ public:
                     allocate)
                 .WillOnce(DoAll(SetArgPointee<7>(stride), Return(err)));
     }
+    void setUpBatchAllocateExpectations(uint32_t bufferCount, status_t err, uint32_t stride) {
+        EXPECT_CALL(*(reinterpret_cast<const mock::MockGrallocAllocator*>(mAllocator.get())),
+                    allocate(_, _, _, _, _, _, bufferCount, _, _, true))
+                .WillOnce(Invoke([=](std::string, uint32_t, uint32_t, PixelFormat, uint32_t,
+                                     uint64_t, uint32_t count, uint32_t* outStride,
+                                     buffer_handle_t* outBufferHandles, bool) {
+                    if (err != NO_ERROR) return err;
+                    // Fake handles, which are only used as keys by the allocator.
+                    for (uint32_t i = 0; i < count; i++) {
+                        outBufferHandles[i] = reinterpret_cast<buffer_handle_t>(
+                                static_cast<uintptr_t>(0x1000 + i));
+                    }
+                    *outStride = stride;
+                    return err;
+                }));
+    }
     std::unique_ptr<const GrallocAllocator>& getAllocator() { return mAllocator; }
 };
 
@@ -113,4 +132,63 @@ TEST_F(GraphicBufferAllocatorTest, AllocateLargeStride) {
     ASSERT_EQ(NO_ERROR, err);
     ASSERT_EQ(expectedStride, stride);
 }
+
+TEST_F(GraphicBufferAllocatorTest, AllocateBatch) {
+    constexpr uint32_t kBufferCount = 3;
+    mAllocator.setUpBatchAllocateExpectations(kBufferCount, NO_ERROR, kTestWidth);
+
+    uint32_t stride = 0;
+    buffer_handle_t handles[kBufferCount] = {};
+    status_t err = mAllocator.allocateBatch(kTestWidth, kTestHeight, PIXEL_FORMAT_RGBA_8888,
+                                            kTestLayerCount, kTestUsage, kBufferCount, handles,
+                                            &stride, "GraphicBufferAllocatorTest");
+    ASSERT_EQ(NO_ERROR, err);
+    ASSERT_EQ(kTestWidth, stride);
+    for (buffer_handle_t handle : handles) {
+        EXPECT_NE(nullptr, handle);
+    }
+}
+
+TEST_F(GraphicBufferAllocatorTest, AllocateBatchEmpty) {
+    uint32_t stride = 0;
+    status_t err = mAllocator.allocateBatch(kTestWidth, kTestHeight, PIXEL_FORMAT_RGBA_8888,
+                                            kTestLayerCount, kTestUsage, 0, nullptr, &stride,
+                                            "GraphicBufferAllocatorTest");
+    ASSERT_EQ(BAD_VALUE, err);
+}
+
+TEST_F(GraphicBufferAllocatorTest, AllocateBatchAsync) {
+    constexpr uint32_t kBufferCount = 2;
+    mAllocator.setUpBatchAllocateExpectations(kBufferCount, NO_ERROR, kTestWidth);
+
+    std::promise<std::pair<status_t, size_t>> result;
+    mAllocator.allocateBatchAsync(kTestWidth, kTestHeight, PIXEL_FORMAT_RGBA_8888,
+                                  kTestLayerCount, kTestUsage, kBufferCount,
+                                  "GraphicBufferAllocatorTest",
+                                  [&](status_t err, std::vector<buffer_handle_t> handles,
+                                      uint32_t stride) {
+                                      EXPECT_EQ(kTestWidth, stride);
+                                      result.set_value({err, handles.size()});
+                                  });
+
+    const auto [err, count] = result.get_future().get();
+    ASSERT_EQ(NO_ERROR, err);
+    ASSERT_EQ(kBufferCount, count);
+}
+
+TEST_F(GraphicBufferAllocatorTest, AllocateBatchAsyncError) {
+    constexpr uint32_t kBufferCount = 2;
+    mAllocator.setUpBatchAllocateExpectations(kBufferCount, NO_MEMORY, 0);
+
+    std::promise<std::pair<status_t, size_t>> result;
+    mAllocator.allocateBatchAsync(kTestWidth, kTestHeight, PIXEL_FORMAT_RGBA_8888,
+                                  kTestLayerCount, kTestUsage, kBufferCount,
+                                  "GraphicBufferAllocatorTest",
+                                  [&](status_t err, std::vector<buffer_handle_t> handles,
+                                      uint32_t) { result.set_value({err, handles.size()}); });
+
+    const auto [err, count] = result.get_future().get();
+    ASSERT_EQ(NO_MEMORY, err);
+    ASSERT_EQ(0u, count);
+}
 } // namespace android
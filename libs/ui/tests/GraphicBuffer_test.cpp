@@ -17,9 +17,12 @@
 #define LOG_TAG "GraphicBufferTest"
 
 #include <ui/GraphicBuffer.h>
+#include <ui/GraphicBufferMapper.h>
 
 #include <gtest/gtest.h>
 
+#include <set>
+
 namespace android {
 
 namespace {
@@ -66,4 +69,31 @@ TEST_F(GraphicBufferTest, AllocateBadDimensions) {
     ASSERT_EQ(BAD_VALUE, gb2->initCheck());
 }
 
+TEST_F(GraphicBufferTest, ImmutableMetadataIsNotReusedAfterFree) {
+    GraphicBufferMapper& mapper = GraphicBufferMapper::get();
+    if (mapper.getMapperVersion() != GraphicBufferMapper::GRALLOC_4) {
+        GTEST_SKIP() << "Immutable metadata is only cached by the gralloc 4 mapper";
+    }
+
+    // Freed handles are likely to be reused by the next allocation, which must not be given the
+    // metadata of the buffer that previously had the same handle.
+    std::set<uint64_t> bufferIds;
+    for (uint32_t i = 0; i < 16; i++) {
+        const uint32_t width = kTestWidth + i;
+        sp<GraphicBuffer> gb(new GraphicBuffer(width, kTestHeight, PIXEL_FORMAT_RGBA_8888,
+                                               kTestLayerCount, kTestUsage, std::string("test")));
+        ASSERT_EQ(NO_ERROR, gb->initCheck());
+
+        for (int query = 0; query < 2; query++) {
+            uint64_t outWidth = 0;
+            ASSERT_EQ(NO_ERROR, mapper.getWidth(gb->getNativeBuffer()->handle, &outWidth));
+            EXPECT_EQ(width, outWidth);
+        }
+
+        uint64_t bufferId = 0;
+        ASSERT_EQ(NO_ERROR, mapper.getBufferId(gb->getNativeBuffer()->handle, &bufferId));
+        EXPECT_TRUE(bufferIds.insert(bufferId).second) << "Buffer id " << bufferId << " reused";
+    }
+}
+
 } // namespace android
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <ui/Rect.h>
+#include <ui/Region.h>
+
+namespace android {
+namespace {
+
+// Roughly the shapes SurfaceFlinger sees when computing visible regions: a
+// full screen layer, a status bar, and a floating window.
+const Rect kScreen(0, 0, 1080, 2400);
+const Rect kStatusBar(0, 0, 1080, 120);
+const Rect kWindow(100, 600, 980, 1800);
+
+// A region with many bands, like the accumulated coverage of a stack of
+// windows.
+Region makeStaircase(int steps) {
+    Region region;
+    for (int i = 0; i < steps; i++) {
+        region.orSelf(Rect(i * 20, i * 40, 600 + i * 20, 200 + i * 40));
+    }
+    return region;
+}
+
+void BM_rectIntersect(benchmark::State& state) {
+    const Region screen(kScreen);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(screen.intersect(kWindow));
+    }
+}
+BENCHMARK(BM_rectIntersect);
+
+void BM_rectSubtract(benchmark::State& state) {
+    const Region screen(kScreen);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(screen.subtract(kWindow));
+    }
+}
+BENCHMARK(BM_rectSubtract);
+
+void BM_rectSubtractSelf(benchmark::State& state) {
+    for (auto _ : state) {
+        Region region(kScreen);
+        region.subtractSelf(kStatusBar);
+        benchmark::DoNotOptimize(region);
+    }
+}
+BENCHMARK(BM_rectSubtractSelf);
+
+void BM_rectMergeContained(benchmark::State& state) {
+    const Region screen(kScreen);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(screen.merge(kWindow));
+    }
+}
+BENCHMARK(BM_rectMergeContained);
+
+void BM_rectMergeDisjoint(benchmark::State& state) {
+    const Region statusBar(kStatusBar);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(statusBar.merge(kWindow));
+    }
+}
+BENCHMARK(BM_rectMergeDisjoint);
+
+void BM_regionIntersect(benchmark::State& state) {
+    const Region staircase = makeStaircase(state.range(0));
+    const Region window(kWindow);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(staircase.intersect(window));
+    }
+}
+BENCHMARK(BM_regionIntersect)->Arg(4)->Arg(16)->Arg(64);
+
+void BM_regionSubtract(benchmark::State& state) {
+    const Region screen(kScreen);
+    const Region staircase = makeStaircase(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(screen.subtract(staircase));
+    }
+}
+BENCHMARK(BM_regionSubtract)->Arg(4)->Arg(16)->Arg(64);
+
+void BM_regionMerge(benchmark::State& state) {
+    const Region staircase = makeStaircase(state.range(0));
+    const Region window(kWindow);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(staircase.merge(window));
+    }
+}
+BENCHMARK(BM_regionMerge)->Arg(4)->Arg(16)->Arg(64);
+
+} // namespace
+} // namespace android
+
+BENCHMARK_MAIN();
@@ -179,5 +179,50 @@ TEST_F(RegionTest, RegionHash) {
     EXPECT_NE(std::hash<Region>{}(region1), std::hash<Region>{}(region2));
 }
 
+// Rect-vs-rect operations take a fast path; they must match what the general
+// algorithm computes when the same operation is done on a multi-rect region.
+TEST_F(RegionTest, RectOperationsMatchGeneralAlgorithm) {
+    const Rect farRect(1000, 1000, 1010, 1010);
+    const Rect lhs(10, 10, 50, 50);
+    const int edges[] = {0, 10, 20, 50, 60};
+
+    for (int left : edges) {
+        for (int top : edges) {
+            for (int right : edges) {
+                for (int bottom : edges) {
+                    const Rect rhs(left, top, right, bottom);
+                    if (rhs.isEmpty()) {
+                        continue;
+                    }
+                    SCOPED_TRACE(testing::Message() << "rhs=[" << left << "," << top << ","
+                                                    << right << "," << bottom << "]");
+
+                    const Region multiRect = Region(lhs).merge(farRect);
+
+                    const Region intersected = Region(lhs).intersect(rhs);
+                    const Region expectedIntersected = multiRect.intersect(rhs);
+                    EXPECT_TRUE(intersected.hasSameRects(expectedIntersected));
+                    EXPECT_EQ(expectedIntersected.getBounds(), intersected.getBounds());
+
+                    const Region subtracted = Region(lhs).subtract(Region(rhs));
+                    const Region expectedSubtracted = multiRect.subtract(rhs).subtract(farRect);
+                    EXPECT_TRUE(subtracted.hasSameRects(expectedSubtracted));
+                    EXPECT_EQ(expectedSubtracted.getBounds(), subtracted.getBounds());
+                    checkTJunctionFreeFromRegion(subtracted);
+
+                    const Region merged = Region(lhs).merge(rhs);
+                    const Region expectedMerged = multiRect.merge(rhs).subtract(farRect);
+                    EXPECT_TRUE(merged.hasSameRects(expectedMerged));
+                    EXPECT_EQ(expectedMerged.getBounds(), merged.getBounds());
+
+                    Region subtractedSelf(lhs);
+                    subtractedSelf.subtractSelf(rhs);
+                    EXPECT_TRUE(subtractedSelf.hasSameRects(expectedSubtracted));
+                }
+            }
+        }
+    }
+}
+
 }; // namespace android
 
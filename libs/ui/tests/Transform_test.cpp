@@ -46,4 +46,75 @@ TEST(TransformTest, inverseRotation_hasCorrectType) {
     testRotationFlagsForInverse(Transform::FLIP_V, Transform::FLIP_V, false);
 }
 
+TEST(TransformTest, compose_matchesMatrixProduct) {
+    Transform translate;
+    translate.set(10.f, -20.f);
+    Transform scale;
+    scale.set(2.f, 0.f, 0.f, 0.5f);
+    scale.set(3.f, 4.f);
+    const Transform flip(Transform::FLIP_H, 100, 50);
+    const Transform rotate(Transform::ROT_90, 100, 50);
+
+    for (const auto& lhs : {translate, scale, flip, rotate}) {
+        for (const auto& rhs : {translate, scale, flip, rotate}) {
+            const Transform product = lhs * rhs;
+            EXPECT_EQ(lhs.asMatrix4() * rhs.asMatrix4(), product.asMatrix4());
+
+            Transform expected;
+            expected.set({product[0][0], product[1][0], product[2][0], product[0][1],
+                          product[1][1], product[2][1], product[0][2], product[1][2],
+                          product[2][2]});
+            EXPECT_EQ(expected.getType(), product.getType());
+            EXPECT_EQ(expected.getOrientation(), product.getOrientation());
+        }
+    }
+
+    Transform inverse;
+    inverse.set(-10.f, 20.f);
+    EXPECT_EQ(Transform::IDENTITY, (translate * inverse).getType());
+}
+
+TEST(TransformTest, transformRect) {
+    const Rect rect(10, 20, 30, 60);
+
+    Transform translate;
+    translate.set(5.f, -5.f);
+    EXPECT_EQ(Rect(15, 15, 35, 55), translate.transform(rect));
+    EXPECT_EQ(FloatRect(15.f, 15.f, 35.f, 55.f), translate.transform(rect.toFloatRect()));
+
+    const Transform rotate(Transform::ROT_90, 100, 200);
+    EXPECT_EQ(Rect(40, 10, 80, 30), rotate.transform(rect));
+
+    Transform skew;
+    skew.set(1.f, 1.f, 0.f, 1.f);
+    EXPECT_EQ(Rect(30, 20, 90, 60), skew.transform(rect));
+
+    Transform scale;
+    scale.set(0.25f, 0.f, 0.f, 0.25f);
+    EXPECT_EQ(Rect(2, 5, 8, 15), scale.transform(rect, true));
+}
+
+TEST(TransformTest, transformBatch) {
+    Transform translate;
+    translate.set(5.f, -5.f);
+    const Transform rotate(Transform::ROT_270, 100, 200);
+
+    const vec2 points[] = {{0.f, 0.f}, {1.5f, -2.f}, {100.f, 50.f}};
+    const FloatRect rects[] = {{0.f, 0.f, 10.f, 10.f}, {-5.f, 2.5f, 7.f, 30.f}};
+
+    for (const auto& t : {Transform(), translate, rotate}) {
+        vec2 transformedPoints[std::size(points)];
+        t.transform(points, transformedPoints, std::size(points));
+        for (size_t i = 0; i < std::size(points); i++) {
+            EXPECT_EQ(t.transform(points[i]), transformedPoints[i]);
+        }
+
+        FloatRect transformedRects[std::size(rects)];
+        t.transform(rects, transformedRects, std::size(rects));
+        for (size_t i = 0; i < std::size(rects); i++) {
+            EXPECT_EQ(t.transform(rects[i]), transformedRects[i]);
+        }
+    }
+}
+
 } // namespace android::ui
@@ -65,6 +65,26 @@ static const std::vector<float> kSrgbInvOETF = [] {
     return result;
 }();
 
+// Values of the 8-bit luma and chroma codes of a YUV420 image, so that reading a pixel doesn't need
+// any division. The values are computed exactly as getYuv420Pixel used to for each pixel.
+static const std::vector<float> kYuv420LumaValues = [] {
+    std::vector<float> result;
+    for (int code = 0; code < 256; code++) {
+      result.push_back(static_cast<float>(code) / 255.0f);
+    }
+    return result;
+}();
+
+static const std::vector<float> kYuv420ChromaValues = [] {
+    std::vector<float> result;
+    for (int code = 0; code < 256; code++) {
+      // 128 bias for UV given we are using jpeglib; see:
+      // https://github.com/kornelski/libjpeg/blob/master/structure.doc
+      result.push_back((static_cast<float>(code) - 128.0f) / 255.0f);
+    }
+    return result;
+}();
+
 // Use Shepard's method for inverse distance weighting. For more information:
 // en.wikipedia.org/wiki/Inverse_distance_weighting#Shepard's_method
 
@@ -607,11 +627,9 @@ Color getYuv420Pixel(jr_uncompressed_ptr image, size_t x, size_t y) {
   uint8_t u_uint = reinterpret_cast<uint8_t*>(image->data)[pixel_count + pixel_uv_idx];
   uint8_t v_uint = reinterpret_cast<uint8_t*>(image->data)[pixel_count * 5 / 4 + pixel_uv_idx];
 
-  // 128 bias for UV given we are using jpeglib; see:
-  // https://github.com/kornelski/libjpeg/blob/master/structure.doc
-  return {{{ static_cast<float>(y_uint) / 255.0f,
-             (static_cast<float>(u_uint) - 128.0f) / 255.0f,
-             (static_cast<float>(v_uint) - 128.0f) / 255.0f }}};
+  return {{{ kYuv420LumaValues[y_uint],
+             kYuv420ChromaValues[u_uint],
+             kYuv420ChromaValues[v_uint] }}};
 }
 
 Color getP010Pixel(jr_uncompressed_ptr image, size_t x, size_t y) {
@@ -764,6 +782,42 @@ float sampleMap(jr_uncompressed_ptr map, size_t map_scale_factor, size_t x, size
   return e1 * weights[0] + e2 * weights[1] + e3 * weights[2] + e4 * weights[3];
 }
 
+void sampleMapRow(jr_uncompressed_ptr map, size_t map_scale_factor, size_t y,
+                  ShepardsIDW& weightTables, float* gains, size_t count) {
+  int y_lower = y / map_scale_factor;
+  int y_upper = y_lower + 1;
+  y_lower = std::min(y_lower, map->height - 1);
+  y_upper = std::min(y_upper, map->height - 1);
+  const uint8_t* lower_row = reinterpret_cast<uint8_t*>(map->data) + y_lower * map->width;
+  const uint8_t* upper_row = reinterpret_cast<uint8_t*>(map->data) + y_upper * map->width;
+  const size_t offset_y = y % map_scale_factor;
+
+  // The four map values, and so the weights that apply to each offset, are the same for every
+  // pixel of a map column: fetch them once per column.
+  for (size_t x_start = 0; x_start < count; x_start += map_scale_factor) {
+    int x_lower = x_start / map_scale_factor;
+    int x_upper = x_lower + 1;
+    x_lower = std::min(x_lower, map->width - 1);
+    x_upper = std::min(x_upper, map->width - 1);
+
+    const float e1 = mapUintToFloat(lower_row[x_lower]);
+    const float e2 = mapUintToFloat(upper_row[x_lower]);
+    const float e3 = mapUintToFloat(lower_row[x_upper]);
+    const float e4 = mapUintToFloat(upper_row[x_upper]);
+
+    const float* weights = weightTables.mWeights;
+    if (x_lower == x_upper && y_lower == y_upper) weights = weightTables.mWeightsC;
+    else if (x_lower == x_upper) weights = weightTables.mWeightsNR;
+    else if (y_lower == y_upper) weights = weightTables.mWeightsNB;
+    weights += offset_y * map_scale_factor * 4;
+
+    const size_t x_end = std::min(x_start + map_scale_factor, count);
+    for (size_t x = x_start; x < x_end; ++x, weights += 4) {
+      gains[x] = e1 * weights[0] + e2 * weights[1] + e3 * weights[2] + e4 * weights[3];
+    }
+  }
+}
+
 uint32_t colorToRgba1010102(Color e_gamma) {
   return (0x3ff & static_cast<uint32_t>(e_gamma.r * 1023.0f))
        | ((0x3ff & static_cast<uint32_t>(e_gamma.g * 1023.0f)) << 10)
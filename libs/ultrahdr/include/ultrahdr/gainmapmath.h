@@ -141,13 +141,15 @@ struct GainLUT {
     }
   }
 
-  GainLUT(ultrahdr_metadata_ptr metadata, float displayBoost) {
+  // Every gain factor is also multiplied by scale, so that a constant scaling of the recovered
+  // color, such as the normalization by the display boost, comes for free with the lookup.
+  GainLUT(ultrahdr_metadata_ptr metadata, float displayBoost, float scale = 1.0f) {
     float boostFactor = displayBoost > 0 ? displayBoost / metadata->maxContentBoost : 1.0f;
     for (int idx = 0; idx < kGainFactorNumEntries; idx++) {
       float value = static_cast<float>(idx) / static_cast<float>(kGainFactorNumEntries - 1);
       float logBoost = log2(metadata->minContentBoost) * (1.0f - value)
                      + log2(metadata->maxContentBoost) * value;
-      mGainTable[idx] = exp2(logBoost * boostFactor);
+      mGainTable[idx] = exp2(logBoost * boostFactor) * scale;
     }
   }
 
@@ -469,6 +471,13 @@ float sampleMap(jr_uncompressed_ptr map, float map_scale_factor, size_t x, size_
 float sampleMap(jr_uncompressed_ptr map, size_t map_scale_factor, size_t x, size_t y,
                 ShepardsIDW& weightTables);
 
+/*
+ * Sample the gain values for the first count pixels of row y, like sampleMap with weightTables does
+ * for each of them, but reading the map only once per map pixel.
+ */
+void sampleMapRow(jr_uncompressed_ptr map, size_t map_scale_factor, size_t y,
+                  ShepardsIDW& weightTables, float* gains, size_t count);
+
 /*
  * Convert from Color to RGBA1010102.
  *
@@ -24,6 +24,7 @@ extern "C" {
 #include <jpeglib.h>
 }
 #include <utils/Errors.h>
+#include <functional>
 #include <vector>
 
 static const int kMaxWidth = 8192;
@@ -36,6 +37,15 @@ namespace android::ultrahdr {
  */
 class JpegDecoderHelper {
 public:
+    /*
+     * Receives the strips of decompressImageInStrips(). The strip holds the decompressed rows
+     * [firstRow, firstRow + rowCount) of the image at its top, in YUV420 planer format. Its planes
+     * are laid out for min(stripHeight, image height) rows, so that the U plane starts after
+     * width * min(stripHeight, image height) bytes. Returns false to stop decompressing.
+     */
+    typedef std::function<bool(const uint8_t* strip, size_t firstRow, size_t rowCount)>
+            StripCallback;
+
     JpegDecoderHelper();
     ~JpegDecoderHelper();
     /*
@@ -44,6 +54,16 @@ public:
      * Returns false if decompressing the image fails.
      */
     bool decompressImage(const void* image, int length, bool decodeToRGBA = false);
+    /*
+     * Decompresses a JPEG image with 4:2:0 subsampling to YUV420planer format, stripHeight rows
+     * at a time, so that only one strip of the image is held in memory. onStrip is called with
+     * every strip, from the top of the image down, before the next one is decompressed. The XMP,
+     * EXIF and ICC data and the image resolution are already available from the first call.
+     * stripHeight must be a multiple of 16.
+     * Returns false if decompressing the image fails, or if onStrip returns false.
+     */
+    bool decompressImageInStrips(const void* image, int length, size_t stripHeight,
+                                 const StripCallback& onStrip);
     /*
      * Returns the decompressed raw image buffer pointer. This method must be called only after
      * calling decompressImage().
@@ -100,10 +120,14 @@ public:
                                       std::vector<uint8_t>* exifData);
 
 private:
-    bool decode(const void* image, int length, bool decodeToRGBA);
+    // If onStrip is not null, the image is decoded to YUV in strips of stripHeight rows.
+    bool decode(const void* image, int length, bool decodeToRGBA, size_t stripHeight = 0,
+                const StripCallback* onStrip = nullptr);
     // Returns false if errors occur.
     bool decompress(jpeg_decompress_struct* cinfo, const uint8_t* dest, bool isSingleChannel);
-    bool decompressYUV(jpeg_decompress_struct* cinfo, const uint8_t* dest);
+    // Decodes stripHeight rows into dest at a time, passing each strip to onStrip if not null.
+    bool decompressYUV(jpeg_decompress_struct* cinfo, const uint8_t* dest, size_t stripHeight,
+                       const StripCallback* onStrip);
     bool decompressRGBA(jpeg_decompress_struct* cinfo, const uint8_t* dest);
     bool decompressSingleChannel(jpeg_decompress_struct* cinfo, const uint8_t* dest);
     // Process 16 lines of Y and 16 lines of U/V each time.
@@ -27,6 +27,9 @@
 
 namespace android::ultrahdr {
 
+struct GainLUT;
+struct ShepardsIDW;
+
 struct jpegr_info_struct {
     size_t width;
     size_t height;
@@ -86,10 +89,25 @@ struct jpegr_exif_struct {
     int length;
 };
 
+/*
+ * Holds a rectangular region of an image.
+ */
+struct jpegr_region_struct {
+    // Left edge of the region in pixels.
+    int left;
+    // Top edge of the region in pixels.
+    int top;
+    // Width of the region in pixels.
+    int width;
+    // Height of the region in pixels.
+    int height;
+};
+
 typedef struct jpegr_uncompressed_struct* jr_uncompressed_ptr;
 typedef struct jpegr_compressed_struct* jr_compressed_ptr;
 typedef struct jpegr_exif_struct* jr_exif_ptr;
 typedef struct jpegr_info_struct* jr_info_ptr;
+typedef struct jpegr_region_struct* jr_region_ptr;
 
 class JpegR {
 public:
@@ -256,6 +274,11 @@ public:
                        decoder will do nothing about it. If configured not NULL the decoder will
                        write metadata into this structure. the format of metadata is defined in
                        {@code ultrahdr_metadata_struct}.
+     * @param region region of the image to decode. The default value is NULL where the decoder
+                     decodes the whole image. If configured not NULL, dest only holds the pixels
+                     of the region, and its width and height are set to those of the region. The
+                     gain map is only applied to the region, but is still returned whole. The
+                     region must be inside the image.
      * @return NO_ERROR if decoding succeeds, error code if error occurs.
      */
     status_t decodeJPEGR(jr_compressed_ptr compressed_jpegr_image,
@@ -264,7 +287,8 @@ public:
                          jr_exif_ptr exif = nullptr,
                          ultrahdr_output_format output_format = ULTRAHDR_OUTPUT_HDR_LINEAR,
                          jr_uncompressed_ptr gain_map = nullptr,
-                         ultrahdr_metadata_ptr metadata = nullptr);
+                         ultrahdr_metadata_ptr metadata = nullptr,
+                         jr_region_ptr region = nullptr);
 
     /*
     * Gets Info from JPEGR file without decoding it.
@@ -327,6 +351,54 @@ protected:
                           jr_uncompressed_ptr dest);
 
 private:
+    /*
+     * This method will check that the gain map and its metadata can be applied to a primary
+     * image of the given dimensions.
+     *
+     * @param image_width width of the primary image
+     * @param image_height height of the primary image
+     * @param uncompressed_gain_map uncompressed gain map
+     * @param metadata JPEG/R metadata extracted from XMP.
+     * @return NO_ERROR if the gain map can be applied, error code if not.
+     */
+    status_t areGainMapArgumentsValid(size_t image_width,
+                                      size_t image_height,
+                                      jr_uncompressed_ptr uncompressed_gain_map,
+                                      ultrahdr_metadata_ptr metadata);
+
+    /*
+     * This method is the row range version of applyGainMap(). It takes a strip of the SDR image
+     * holding rows [first_row, first_row + row_count) of the image at its top, and writes the
+     * recovered pixels of those rows that are in the region to dest, which holds the whole
+     * region. This lets the decoding pipeline apply the gain map while the primary image is
+     * being decoded. The arguments must have been checked with areGainMapArgumentsValid(). The
+     * tables are built once by the caller and shared by all the strips of an image.
+     *
+     * @param uncompressed_yuv_420_strip strip of the SDR image in YUV_420 color format
+     * @param first_row row of the image at the top of the strip, a multiple of the map scale
+     * @param row_count number of rows of the strip to recover
+     * @param uncompressed_gain_map uncompressed gain map
+     * @param metadata JPEG/R metadata extracted from XMP.
+     * @param output_format flag for setting output color format
+     * @param display_boost the boost applied to the image, at most the max content boost
+     * @param idw_table interpolation weights for the map scale factor
+     * @param gain_lut gain factors for the metadata and display_boost, divided by display_boost
+     * @param region region of the image held by dest
+     * @param dest reconstructed HDR image
+     * @return NO_ERROR if calculation succeeds, error code if error occurs.
+     */
+    status_t applyGainMapToRows(jr_uncompressed_ptr uncompressed_yuv_420_strip,
+                                size_t first_row,
+                                size_t row_count,
+                                jr_uncompressed_ptr uncompressed_gain_map,
+                                ultrahdr_metadata_ptr metadata,
+                                ultrahdr_output_format output_format,
+                                float display_boost,
+                                ShepardsIDW& idw_table,
+                                GainLUT& gain_lut,
+                                jr_region_ptr region,
+                                jr_uncompressed_ptr dest);
+
     /*
      * This method is called in the encoding pipeline. It will encode the gain map.
      *
@@ -337,6 +409,28 @@ private:
     status_t compressGainMap(jr_uncompressed_ptr uncompressed_gain_map,
                              JpegEncoderHelper* jpeg_encoder);
 
+    /*
+     * This method is called in the encoding pipeline. It will convert the SDR image to Bt.601
+     * YUV encoding in-place and encode it, and encode the gain map at the same time on another
+     * thread, since the two are independent.
+     *
+     * @param uncompressed_yuv_420_image uncompressed SDR image in YUV_420 color format
+     * @param quality target quality of the JPEG encoding, must be in range of 0-100 where 100 is
+     *                the highest quality
+     * @param icc ICC package to write into the primary image
+     * @param icc_size length in bytes of ICC package
+     * @param uncompressed_gain_map uncompressed gain map
+     * @param jpeg_encoder resource to compress the SDR image
+     * @param jpeg_encoder_gainmap resource to compress the gain map
+     * @return NO_ERROR if encoding succeeds, error code if error occurs.
+     */
+    status_t compressImageAndGainMap(jr_uncompressed_ptr uncompressed_yuv_420_image,
+                                     int quality,
+                                     void* icc, size_t icc_size,
+                                     jr_uncompressed_ptr uncompressed_gain_map,
+                                     JpegEncoderHelper* jpeg_encoder,
+                                     JpegEncoderHelper* jpeg_encoder_gainmap);
+
     /*
      * This methoud is called to separate primary image and gain map image from JPEGR
      *
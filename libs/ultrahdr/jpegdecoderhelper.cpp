@@ -20,6 +20,7 @@
 
 #include <errno.h>
 #include <setjmp.h>
+#include <algorithm>
 #include <string>
 
 using namespace std;
@@ -113,6 +114,29 @@ bool JpegDecoderHelper::decompressImage(const void* image, int length, bool deco
     return true;
 }
 
+bool JpegDecoderHelper::decompressImageInStrips(const void* image, int length,
+                                                size_t stripHeight, const StripCallback& onStrip) {
+    if (image == nullptr || length <= 0) {
+        ALOGE("Image size can not be handled: %d", length);
+        return false;
+    }
+    if (stripHeight == 0 || stripHeight % kCompressBatchSize != 0) {
+        ALOGE("Strip height must be a multiple of %d: %zu", kCompressBatchSize, stripHeight);
+        return false;
+    }
+
+    mResultBuffer.clear();
+    mXMPBuffer.clear();
+    if (!decode(image, length, false /* decodeToRGBA */, stripHeight, &onStrip)) {
+        return false;
+    }
+    // The buffer only held the last strip.
+    mResultBuffer.clear();
+    mResultBuffer.shrink_to_fit();
+
+    return true;
+}
+
 void* JpegDecoderHelper::getDecompressedImagePtr() {
     return mResultBuffer.data();
 }
@@ -153,7 +177,8 @@ size_t JpegDecoderHelper::getDecompressedImageHeight() {
     return mHeight;
 }
 
-bool JpegDecoderHelper::decode(const void* image, int length, bool decodeToRGBA) {
+bool JpegDecoderHelper::decode(const void* image, int length, bool decodeToRGBA,
+                               size_t stripHeight, const StripCallback* onStrip) {
     jpeg_decompress_struct cinfo;
     jpegr_source_mgr mgr(static_cast<const uint8_t*>(image), length);
     jpegrerror_mgr myerr;
@@ -226,6 +251,10 @@ bool JpegDecoderHelper::decode(const void* image, int length, bool decodeToRGBA)
     mWidth = cinfo.image_width;
     mHeight = cinfo.image_height;
 
+    if (onStrip == nullptr || stripHeight > cinfo.image_height) {
+        stripHeight = cinfo.image_height;
+    }
+
     if (decodeToRGBA) {
         if (cinfo.jpeg_color_space == JCS_GRAYSCALE) {
             // We don't intend to support decoding grayscale to RGBA
@@ -237,6 +266,11 @@ bool JpegDecoderHelper::decode(const void* image, int length, bool decodeToRGBA)
         mResultBuffer.resize(cinfo.image_width * cinfo.image_height * 4);
         cinfo.out_color_space = JCS_EXT_RGBA;
     } else {
+        if (onStrip != nullptr && cinfo.jpeg_color_space != JCS_YCbCr) {
+            status = false;
+            ALOGE("%s: decoding in strips only supports YUV images", __func__);
+            goto CleanUp;
+        }
         if (cinfo.jpeg_color_space == JCS_YCbCr) {
             if (cinfo.comp_info[0].h_samp_factor != 2 ||
                 cinfo.comp_info[1].h_samp_factor != 1 ||
@@ -248,7 +282,7 @@ bool JpegDecoderHelper::decode(const void* image, int length, bool decodeToRGBA)
                 ALOGE("%s: decoding to YUV only supports 4:2:0 subsampling", __func__);
                 goto CleanUp;
             }
-            mResultBuffer.resize(cinfo.image_width * cinfo.image_height * 3 / 2, 0);
+            mResultBuffer.resize(cinfo.image_width * stripHeight * 3 / 2, 0);
         } else if (cinfo.jpeg_color_space == JCS_GRAYSCALE) {
             mResultBuffer.resize(cinfo.image_width * cinfo.image_height, 0);
         }
@@ -260,7 +294,13 @@ bool JpegDecoderHelper::decode(const void* image, int length, bool decodeToRGBA)
 
     jpeg_start_decompress(&cinfo);
 
-    if (!decompress(&cinfo, static_cast<const uint8_t*>(mResultBuffer.data()),
+    if (onStrip != nullptr) {
+        if (!decompressYUV(&cinfo, static_cast<const uint8_t*>(mResultBuffer.data()),
+                           stripHeight, onStrip)) {
+            status = false;
+            goto CleanUp;
+        }
+    } else if (!decompress(&cinfo, static_cast<const uint8_t*>(mResultBuffer.data()),
             cinfo.jpeg_color_space == JCS_GRAYSCALE)) {
         status = false;
         goto CleanUp;
@@ -281,7 +321,7 @@ bool JpegDecoderHelper::decompress(jpeg_decompress_struct* cinfo, const uint8_t*
     if (cinfo->out_color_space == JCS_EXT_RGBA)
         return decompressRGBA(cinfo, dest);
     else
-        return decompressYUV(cinfo, dest);
+        return decompressYUV(cinfo, dest, cinfo->image_height, nullptr);
 }
 
 bool JpegDecoderHelper::getCompressedImageParameters(const void* image, int length,
@@ -368,13 +408,16 @@ bool JpegDecoderHelper::decompressRGBA(jpeg_decompress_struct* cinfo, const uint
     return lines == cinfo->image_height;
 }
 
-bool JpegDecoderHelper::decompressYUV(jpeg_decompress_struct* cinfo, const uint8_t* dest) {
+bool JpegDecoderHelper::decompressYUV(jpeg_decompress_struct* cinfo, const uint8_t* dest,
+                                      size_t stripHeight, const StripCallback* onStrip) {
     JSAMPROW y[kCompressBatchSize];
     JSAMPROW cb[kCompressBatchSize / 2];
     JSAMPROW cr[kCompressBatchSize / 2];
     JSAMPARRAY planes[3] {y, cb, cr};
 
-    size_t y_plane_size = cinfo->image_width * cinfo->image_height;
+    // dest holds stripHeight rows, starting at row stripStart of the image.
+    size_t stripStart = 0;
+    size_t y_plane_size = cinfo->image_width * stripHeight;
     size_t uv_plane_size = y_plane_size / 4;
     uint8_t* y_plane = const_cast<uint8_t*>(dest);
     uint8_t* u_plane = const_cast<uint8_t*>(dest + y_plane_size);
@@ -412,7 +455,7 @@ bool JpegDecoderHelper::decompressYUV(jpeg_decompress_struct* cinfo, const uint8
         for (int i = 0; i < kCompressBatchSize; ++i) {
             size_t scanline = cinfo->output_scanline + i;
             if (scanline < cinfo->image_height) {
-                y[i] = y_plane + scanline * cinfo->image_width;
+                y[i] = y_plane + (scanline - stripStart) * cinfo->image_width;
             } else {
                 y[i] = empty.get();
             }
@@ -421,7 +464,7 @@ bool JpegDecoderHelper::decompressYUV(jpeg_decompress_struct* cinfo, const uint8
         for (int i = 0; i < kCompressBatchSize / 2; ++i) {
             size_t scanline = cinfo->output_scanline / 2 + i;
             if (scanline < cinfo->image_height / 2) {
-                int offset = scanline * (cinfo->image_width / 2);
+                int offset = (scanline - stripStart / 2) * (cinfo->image_width / 2);
                 cb[i] = u_plane + offset;
                 cr[i] = v_plane + offset;
             } else {
@@ -444,6 +487,15 @@ bool JpegDecoderHelper::decompressYUV(jpeg_decompress_struct* cinfo, const uint8
                 memcpy(cr[i], cr_intrm[i], cinfo->image_width / 2);
             }
         }
+        if (onStrip != nullptr && (cinfo->output_scanline - stripStart >= stripHeight ||
+                                   cinfo->output_scanline >= cinfo->image_height)) {
+            size_t rowCount = std::min<size_t>(cinfo->output_scanline, cinfo->image_height) -
+                    stripStart;
+            if (!(*onStrip)(dest, stripStart, rowCount)) {
+                return false;
+            }
+            stripStart += rowCount;
+        }
     }
     return true;
 }
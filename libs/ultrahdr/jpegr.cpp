@@ -82,6 +82,10 @@ static const size_t kJpegBlock = JpegEncoderHelper::kCompressBatchSize;
 // JPEG compress quality (0 ~ 100) for gain map
 static const int kMapCompressQuality = 85;
 
+// Number of rows of the primary image decoded at a time when applying the gain map. It must be a
+// multiple of the JPEG MCU height, and of the map scale factor.
+static const size_t kDecodeStripHeight = 16 * kJpegBlock;
+
 #define CONFIG_MULTITHREAD 1
 int GetCPUCoreCount() {
   int cpuCoreCount = 1;
@@ -247,28 +251,20 @@ status_t JpegR::encodeJPEGR(jr_uncompressed_ptr uncompressed_p010_image,
   std::unique_ptr<uint8_t[]> map_data;
   map_data.reset(reinterpret_cast<uint8_t*>(map.data));
 
+  sp<DataStruct> icc = IccHelper::writeIccProfile(ULTRAHDR_TF_SRGB,
+                                                  uncompressed_yuv_420_image.colorGamut);
+
+  JpegEncoderHelper jpeg_encoder;
   JpegEncoderHelper jpeg_encoder_gainmap;
-  JPEGR_CHECK(compressGainMap(&map, &jpeg_encoder_gainmap));
+  JPEGR_CHECK(compressImageAndGainMap(&uncompressed_yuv_420_image, quality, icc->getData(),
+                                      icc->getLength(), &map, &jpeg_encoder,
+                                      &jpeg_encoder_gainmap));
   jpegr_compressed_struct compressed_map;
   compressed_map.maxLength = jpeg_encoder_gainmap.getCompressedImageSize();
   compressed_map.length = compressed_map.maxLength;
   compressed_map.data = jpeg_encoder_gainmap.getCompressedImagePtr();
   compressed_map.colorGamut = ULTRAHDR_COLORGAMUT_UNSPECIFIED;
 
-  sp<DataStruct> icc = IccHelper::writeIccProfile(ULTRAHDR_TF_SRGB,
-                                                  uncompressed_yuv_420_image.colorGamut);
-
-  // Convert to Bt601 YUV encoding for JPEG encode
-  JPEGR_CHECK(convertYuv(&uncompressed_yuv_420_image, uncompressed_yuv_420_image.colorGamut,
-                         ULTRAHDR_COLORGAMUT_P3));
-
-  JpegEncoderHelper jpeg_encoder;
-  if (!jpeg_encoder.compressImage(uncompressed_yuv_420_image.data,
-                                  uncompressed_yuv_420_image.width,
-                                  uncompressed_yuv_420_image.height, quality,
-                                  icc->getData(), icc->getLength())) {
-    return ERROR_JPEGR_ENCODE_ERROR;
-  }
   jpegr_compressed_struct jpeg;
   jpeg.data = jpeg_encoder.getCompressedImagePtr();
   jpeg.length = jpeg_encoder.getCompressedImageSize();
@@ -312,14 +308,6 @@ status_t JpegR::encodeJPEGR(jr_uncompressed_ptr uncompressed_p010_image,
   std::unique_ptr<uint8_t[]> map_data;
   map_data.reset(reinterpret_cast<uint8_t*>(map.data));
 
-  JpegEncoderHelper jpeg_encoder_gainmap;
-  JPEGR_CHECK(compressGainMap(&map, &jpeg_encoder_gainmap));
-  jpegr_compressed_struct compressed_map;
-  compressed_map.maxLength = jpeg_encoder_gainmap.getCompressedImageSize();
-  compressed_map.length = compressed_map.maxLength;
-  compressed_map.data = jpeg_encoder_gainmap.getCompressedImagePtr();
-  compressed_map.colorGamut = ULTRAHDR_COLORGAMUT_UNSPECIFIED;
-
   sp<DataStruct> icc = IccHelper::writeIccProfile(ULTRAHDR_TF_SRGB,
                                                   uncompressed_yuv_420_image->colorGamut);
 
@@ -332,16 +320,18 @@ status_t JpegR::encodeJPEGR(jr_uncompressed_ptr uncompressed_p010_image,
   jpegr_uncompressed_struct yuv_420_bt601_image = {
     yuv_420_bt601_data.get(), uncompressed_yuv_420_image->width, uncompressed_yuv_420_image->height,
     uncompressed_yuv_420_image->colorGamut };
-  JPEGR_CHECK(convertYuv(&yuv_420_bt601_image, yuv_420_bt601_image.colorGamut,
-                         ULTRAHDR_COLORGAMUT_P3));
 
   JpegEncoderHelper jpeg_encoder;
-  if (!jpeg_encoder.compressImage(yuv_420_bt601_image.data,
-                                  yuv_420_bt601_image.width,
-                                  yuv_420_bt601_image.height, quality,
-                                  icc->getData(), icc->getLength())) {
-    return ERROR_JPEGR_ENCODE_ERROR;
-  }
+  JpegEncoderHelper jpeg_encoder_gainmap;
+  JPEGR_CHECK(compressImageAndGainMap(&yuv_420_bt601_image, quality, icc->getData(),
+                                      icc->getLength(), &map, &jpeg_encoder,
+                                      &jpeg_encoder_gainmap));
+  jpegr_compressed_struct compressed_map;
+  compressed_map.maxLength = jpeg_encoder_gainmap.getCompressedImageSize();
+  compressed_map.length = compressed_map.maxLength;
+  compressed_map.data = jpeg_encoder_gainmap.getCompressedImagePtr();
+  compressed_map.colorGamut = ULTRAHDR_COLORGAMUT_UNSPECIFIED;
+
   jpegr_compressed_struct jpeg;
   jpeg.data = jpeg_encoder.getCompressedImagePtr();
   jpeg.length = jpeg_encoder.getCompressedImageSize();
@@ -563,7 +553,8 @@ status_t JpegR::decodeJPEGR(jr_compressed_ptr compressed_jpegr_image,
                             jr_exif_ptr exif,
                             ultrahdr_output_format output_format,
                             jr_uncompressed_ptr gain_map,
-                            ultrahdr_metadata_ptr metadata) {
+                            ultrahdr_metadata_ptr metadata,
+                            jr_region_ptr region) {
   if (compressed_jpegr_image == nullptr || compressed_jpegr_image->data == nullptr) {
     ALOGE("received nullptr for compressed jpegr image");
     return ERROR_JPEGR_INVALID_NULL_PTR;
@@ -599,44 +590,74 @@ status_t JpegR::decodeJPEGR(jr_compressed_ptr compressed_jpegr_image,
     }
   }
 
-  JpegDecoderHelper jpeg_decoder;
-  if (!jpeg_decoder.decompressImage(primary_image.data, primary_image.length,
-                                    (output_format == ULTRAHDR_OUTPUT_SDR))) {
-    return ERROR_JPEGR_DECODE_ERROR;
-  }
+  auto copyExif = [exif](JpegDecoderHelper& decoder) -> status_t {
+    if (exif != nullptr) {
+      if (exif->data == nullptr) {
+        return ERROR_JPEGR_INVALID_NULL_PTR;
+      }
+      if (exif->length < decoder.getEXIFSize()) {
+        return ERROR_JPEGR_BUFFER_TOO_SMALL;
+      }
+      memcpy(exif->data, decoder.getEXIFPtr(), decoder.getEXIFSize());
+      exif->length = decoder.getEXIFSize();
+    }
+    return NO_ERROR;
+  };
+
+  // The region defaults to the whole image, once its dimensions are known.
+  jpegr_region_struct decoded_region;
+  auto setDecodedRegion = [region, &decoded_region](int image_width,
+                                                   int image_height) -> status_t {
+    if (region == nullptr) {
+      decoded_region = {0, 0, image_width, image_height};
+      return NO_ERROR;
+    }
+    if (region->left < 0 || region->top < 0 || region->width <= 0 || region->height <= 0
+     || region->width > image_width - region->left
+     || region->height > image_height - region->top) {
+      ALOGE("received bad region %d, %d, %dx%d for a %dx%d image", region->left, region->top,
+            region->width, region->height, image_width, image_height);
+      return ERROR_JPEGR_INVALID_INPUT_TYPE;
+    }
+    decoded_region = *region;
+    return NO_ERROR;
+  };
 
+  JpegDecoderHelper jpeg_decoder;
   if (output_format == ULTRAHDR_OUTPUT_SDR) {
-    if ((jpeg_decoder.getDecompressedImageWidth() *
-         jpeg_decoder.getDecompressedImageHeight() * 4) >
-        jpeg_decoder.getDecompressedImageSize()) {
-      return ERROR_JPEGR_CALCULATION_ERROR;
+    if (!jpeg_decoder.decompressImage(primary_image.data, primary_image.length,
+                                      true /* decodeToRGBA */)) {
+      return ERROR_JPEGR_DECODE_ERROR;
     }
-  } else {
     if ((jpeg_decoder.getDecompressedImageWidth() *
-         jpeg_decoder.getDecompressedImageHeight() * 3 / 2) >
+         jpeg_decoder.getDecompressedImageHeight() * 4) >
         jpeg_decoder.getDecompressedImageSize()) {
       return ERROR_JPEGR_CALCULATION_ERROR;
     }
-  }
-
-  if (exif != nullptr) {
-    if (exif->data == nullptr) {
-      return ERROR_JPEGR_INVALID_NULL_PTR;
-    }
-    if (exif->length < jpeg_decoder.getEXIFSize()) {
-      return ERROR_JPEGR_BUFFER_TOO_SMALL;
+    JPEGR_CHECK(setDecodedRegion(jpeg_decoder.getDecompressedImageWidth(),
+                                 jpeg_decoder.getDecompressedImageHeight()));
+    JPEGR_CHECK(copyExif(jpeg_decoder));
+
+    const size_t image_stride = jpeg_decoder.getDecompressedImageWidth() * 4;
+    const size_t region_stride = decoded_region.width * 4;
+    const uint8_t* src = static_cast<const uint8_t*>(jpeg_decoder.getDecompressedImagePtr()) +
+            decoded_region.top * image_stride + decoded_region.left * 4;
+    dest->width = decoded_region.width;
+    dest->height = decoded_region.height;
+    if (region_stride == image_stride) {
+      memcpy(dest->data, src, region_stride * dest->height);
+    } else {
+      for (int row = 0; row < dest->height; row++) {
+        memcpy(static_cast<uint8_t*>(dest->data) + row * region_stride, src + row * image_stride,
+               region_stride);
+      }
     }
-    memcpy(exif->data, jpeg_decoder.getEXIFPtr(), jpeg_decoder.getEXIFSize());
-    exif->length = jpeg_decoder.getEXIFSize();
-  }
-
-  if (output_format == ULTRAHDR_OUTPUT_SDR) {
-    dest->width = jpeg_decoder.getDecompressedImageWidth();
-    dest->height = jpeg_decoder.getDecompressedImageHeight();
-    memcpy(dest->data, jpeg_decoder.getDecompressedImagePtr(), dest->width * dest->height * 4);
     return NO_ERROR;
   }
 
+  // The gain map is decoded first, so that it can be applied to the primary image while the
+  // primary image is decoded, a strip at a time. Only one strip of the YUV primary image is then
+  // in memory, instead of the whole image.
   JpegDecoderHelper gain_map_decoder;
   if (!gain_map_decoder.decompressImage(gainmap_image.data, gainmap_image.length)) {
     return ERROR_JPEGR_DECODE_ERROR;
@@ -677,15 +698,44 @@ status_t JpegR::decodeJPEGR(jr_compressed_ptr compressed_jpegr_image,
     metadata->hdrCapacityMax = uhdr_metadata.hdrCapacityMax;
   }
 
-  jpegr_uncompressed_struct uncompressed_yuv_420_image;
-  uncompressed_yuv_420_image.data = jpeg_decoder.getDecompressedImagePtr();
-  uncompressed_yuv_420_image.width = jpeg_decoder.getDecompressedImageWidth();
-  uncompressed_yuv_420_image.height = jpeg_decoder.getDecompressedImageHeight();
-  uncompressed_yuv_420_image.colorGamut = IccHelper::readIccColorGamut(
-      jpeg_decoder.getICCPtr(), jpeg_decoder.getICCSize());
+  ShepardsIDW idwTable(kMapDimensionScaleFactor);
+  float display_boost = std::min(max_display_boost, uhdr_metadata.maxContentBoost);
+  GainLUT gainLUT(&uhdr_metadata, display_boost, 1.0f / display_boost);
+  ultrahdr_color_gamut primary_color_gamut = ULTRAHDR_COLORGAMUT_UNSPECIFIED;
+  auto applyGainMapToStrip = [&](const uint8_t* strip, size_t first_row,
+                                 size_t row_count) -> bool {
+    const size_t image_width = jpeg_decoder.getDecompressedImageWidth();
+    const size_t image_height = jpeg_decoder.getDecompressedImageHeight();
+    if (first_row == 0) {
+      status = areGainMapArgumentsValid(image_width, image_height, &map, &uhdr_metadata);
+      if (status == NO_ERROR) {
+        status = setDecodedRegion(image_width, image_height);
+      }
+      if (status != NO_ERROR) {
+        return false;
+      }
+      dest->width = decoded_region.width;
+      dest->height = decoded_region.height;
+      primary_color_gamut = IccHelper::readIccColorGamut(jpeg_decoder.getICCPtr(),
+                                                         jpeg_decoder.getICCSize());
+    }
+
+    jpegr_uncompressed_struct uncompressed_yuv_420_strip;
+    uncompressed_yuv_420_strip.data = const_cast<uint8_t*>(strip);
+    uncompressed_yuv_420_strip.width = image_width;
+    uncompressed_yuv_420_strip.height = std::min(kDecodeStripHeight, image_height);
+    uncompressed_yuv_420_strip.colorGamut = primary_color_gamut;
+    status = applyGainMapToRows(&uncompressed_yuv_420_strip, first_row, row_count, &map,
+                                &uhdr_metadata, output_format, display_boost, idwTable,
+                                gainLUT, &decoded_region, dest);
+    return status == NO_ERROR;
+  };
+  if (!jpeg_decoder.decompressImageInStrips(primary_image.data, primary_image.length,
+                                            kDecodeStripHeight, applyGainMapToStrip)) {
+    return status != NO_ERROR ? status : ERROR_JPEGR_DECODE_ERROR;
+  }
 
-  JPEGR_CHECK(applyGainMap(&uncompressed_yuv_420_image, &map, &uhdr_metadata, output_format,
-                           max_display_boost, dest));
+  JPEGR_CHECK(copyExif(jpeg_decoder));
   return NO_ERROR;
 }
 
@@ -709,6 +759,48 @@ status_t JpegR::compressGainMap(jr_uncompressed_ptr uncompressed_gain_map,
   return NO_ERROR;
 }
 
+status_t JpegR::compressImageAndGainMap(jr_uncompressed_ptr uncompressed_yuv_420_image,
+                                        int quality,
+                                        void* icc, size_t icc_size,
+                                        jr_uncompressed_ptr uncompressed_gain_map,
+                                        JpegEncoderHelper* jpeg_encoder,
+                                        JpegEncoderHelper* jpeg_encoder_gainmap) {
+  if (uncompressed_yuv_420_image == nullptr
+   || uncompressed_gain_map == nullptr
+   || jpeg_encoder == nullptr
+   || jpeg_encoder_gainmap == nullptr) {
+    return ERROR_JPEGR_INVALID_NULL_PTR;
+  }
+
+  status_t gain_map_status = NO_ERROR;
+  auto compressMap = [this, uncompressed_gain_map, jpeg_encoder_gainmap,
+                      &gain_map_status]() -> void {
+    gain_map_status = compressGainMap(uncompressed_gain_map, jpeg_encoder_gainmap);
+  };
+  std::thread gain_map_worker;
+  if (GetCPUCoreCount() > 1) {
+    gain_map_worker = std::thread(compressMap);
+  } else {
+    compressMap();
+  }
+
+  // Convert to Bt601 YUV encoding for JPEG encode
+  status_t status = convertYuv(uncompressed_yuv_420_image, uncompressed_yuv_420_image->colorGamut,
+                               ULTRAHDR_COLORGAMUT_P3);
+  if (status == NO_ERROR
+   && !jpeg_encoder->compressImage(uncompressed_yuv_420_image->data,
+                                   uncompressed_yuv_420_image->width,
+                                   uncompressed_yuv_420_image->height, quality,
+                                   icc, icc_size)) {
+    status = ERROR_JPEGR_ENCODE_ERROR;
+  }
+
+  if (gain_map_worker.joinable()) {
+    gain_map_worker.join();
+  }
+  return status != NO_ERROR ? status : gain_map_status;
+}
+
 const int kJobSzInRows = 16;
 static_assert(kJobSzInRows > 0 && kJobSzInRows % kMapDimensionScaleFactor == 0,
               "align job size to kMapDimensionScaleFactor");
@@ -945,19 +1037,10 @@ status_t JpegR::generateGainMap(jr_uncompressed_ptr uncompressed_yuv_420_image,
   return NO_ERROR;
 }
 
-status_t JpegR::applyGainMap(jr_uncompressed_ptr uncompressed_yuv_420_image,
-                             jr_uncompressed_ptr uncompressed_gain_map,
-                             ultrahdr_metadata_ptr metadata,
-                             ultrahdr_output_format output_format,
-                             float max_display_boost,
-                             jr_uncompressed_ptr dest) {
-  if (uncompressed_yuv_420_image == nullptr
-   || uncompressed_gain_map == nullptr
-   || metadata == nullptr
-   || dest == nullptr) {
-    return ERROR_JPEGR_INVALID_NULL_PTR;
-  }
-
+status_t JpegR::areGainMapArgumentsValid(size_t image_width,
+                                         size_t image_height,
+                                         jr_uncompressed_ptr uncompressed_gain_map,
+                                         ultrahdr_metadata_ptr metadata) {
   if (metadata->version.compare("1.0")) {
       ALOGE("Unsupported metadata version: %s", metadata->version.c_str());
       return ERROR_JPEGR_UNSUPPORTED_METADATA;
@@ -979,8 +1062,6 @@ status_t JpegR::applyGainMap(jr_uncompressed_ptr uncompressed_yuv_420_image,
   }
 
   // TODO: remove once map scaling factor is computed based on actual map dims
-  size_t image_width = uncompressed_yuv_420_image->width;
-  size_t image_height = uncompressed_yuv_420_image->height;
   size_t map_width = image_width / kMapDimensionScaleFactor;
   size_t map_height = image_height / kMapDimensionScaleFactor;
   map_width = static_cast<size_t>(
@@ -992,24 +1073,81 @@ status_t JpegR::applyGainMap(jr_uncompressed_ptr uncompressed_yuv_420_image,
     return ERROR_JPEGR_INVALID_INPUT_TYPE;
   }
 
+  return NO_ERROR;
+}
+
+status_t JpegR::applyGainMap(jr_uncompressed_ptr uncompressed_yuv_420_image,
+                             jr_uncompressed_ptr uncompressed_gain_map,
+                             ultrahdr_metadata_ptr metadata,
+                             ultrahdr_output_format output_format,
+                             float max_display_boost,
+                             jr_uncompressed_ptr dest) {
+  if (uncompressed_yuv_420_image == nullptr
+   || uncompressed_gain_map == nullptr
+   || metadata == nullptr
+   || dest == nullptr) {
+    return ERROR_JPEGR_INVALID_NULL_PTR;
+  }
+
+  JPEGR_CHECK(areGainMapArgumentsValid(uncompressed_yuv_420_image->width,
+                                       uncompressed_yuv_420_image->height,
+                                       uncompressed_gain_map, metadata));
+
   dest->width = uncompressed_yuv_420_image->width;
   dest->height = uncompressed_yuv_420_image->height;
+  jpegr_region_struct region = {0, 0, dest->width, dest->height};
   ShepardsIDW idwTable(kMapDimensionScaleFactor);
   float display_boost = std::min(max_display_boost, metadata->maxContentBoost);
-  GainLUT gainLUT(metadata, display_boost);
+  GainLUT gainLUT(metadata, display_boost, 1.0f / display_boost);
+  return applyGainMapToRows(uncompressed_yuv_420_image, 0, uncompressed_yuv_420_image->height,
+                            uncompressed_gain_map, metadata, output_format, display_boost,
+                            idwTable, gainLUT, &region, dest);
+}
+
+status_t JpegR::applyGainMapToRows(jr_uncompressed_ptr uncompressed_yuv_420_strip,
+                                   size_t first_row,
+                                   size_t row_count,
+                                   jr_uncompressed_ptr uncompressed_gain_map,
+                                   ultrahdr_metadata_ptr metadata,
+                                   ultrahdr_output_format output_format,
+                                   float display_boost,
+                                   ShepardsIDW& idwTable,
+                                   GainLUT& gainLUT,
+                                   jr_region_ptr region,
+                                   jr_uncompressed_ptr dest) {
+  // Rows of the strip that are in the region.
+  const size_t region_top = region->top;
+  const size_t region_bottom = region_top + region->height;
+  const size_t row_start = std::max(first_row, region_top);
+  const size_t row_end = std::min(first_row + row_count, region_bottom);
+  if (row_start >= row_end) {
+    return NO_ERROR;
+  }
 
   JobQueue jobQueue;
-  std::function<void()> applyRecMap = [uncompressed_yuv_420_image, uncompressed_gain_map,
-                                       metadata, dest, &jobQueue, &idwTable, output_format,
-                                       &gainLUT, display_boost]() -> void {
-    size_t width = uncompressed_yuv_420_image->width;
-    size_t height = uncompressed_yuv_420_image->height;
+  std::function<void()> applyRecMap = [uncompressed_yuv_420_strip, first_row,
+                                       uncompressed_gain_map, metadata, region, dest, &jobQueue,
+                                       &idwTable, output_format, &gainLUT,
+                                       display_boost]() -> void {
+    const size_t region_left = region->left;
+    const size_t region_right = region_left + region->width;
+    // TODO: determine map scaling factor based on actual map dims
+    size_t map_scale_factor = kMapDimensionScaleFactor;
+    // TODO: If map_scale_factor is guaranteed to be an integer, then remove the following.
+    // Currently map_scale_factor is of type size_t, but it could be changed to a float
+    // later.
+    const bool sampleMapByRow = map_scale_factor == floorf(map_scale_factor);
+    std::vector<float> rowGains(sampleMapByRow ? region_right : 0);
 
     size_t rowStart, rowEnd;
     while (jobQueue.dequeueJob(rowStart, rowEnd)) {
       for (size_t y = rowStart; y < rowEnd; ++y) {
-        for (size_t x = 0; x < width; ++x) {
-          Color yuv_gamma_sdr = getYuv420Pixel(uncompressed_yuv_420_image, x, y);
+        if (sampleMapByRow) {
+          sampleMapRow(uncompressed_gain_map, map_scale_factor, y, idwTable, rowGains.data(),
+                       region_right);
+        }
+        for (size_t x = region_left; x < region_right; ++x) {
+          Color yuv_gamma_sdr = getYuv420Pixel(uncompressed_yuv_420_strip, x, y - first_row);
           // Assuming the sdr image is a decoded JPEG, we should always use Rec.601 YUV coefficients
           Color rgb_gamma_sdr = p3YuvToRgb(yuv_gamma_sdr);
           // We are assuming the SDR base image is always sRGB transfer.
@@ -1019,24 +1157,20 @@ status_t JpegR::applyGainMap(jr_uncompressed_ptr uncompressed_yuv_420_image,
           Color rgb_sdr = srgbInvOetf(rgb_gamma_sdr);
 #endif
           float gain;
-          // TODO: determine map scaling factor based on actual map dims
-          size_t map_scale_factor = kMapDimensionScaleFactor;
-          // TODO: If map_scale_factor is guaranteed to be an integer, then remove the following.
-          // Currently map_scale_factor is of type size_t, but it could be changed to a float
-          // later.
-          if (map_scale_factor != floorf(map_scale_factor)) {
-            gain = sampleMap(uncompressed_gain_map, map_scale_factor, x, y);
+          if (sampleMapByRow) {
+            gain = rowGains[x];
           } else {
-            gain = sampleMap(uncompressed_gain_map, map_scale_factor, x, y, idwTable);
+            gain = sampleMap(uncompressed_gain_map, map_scale_factor, x, y);
           }
 
 #if USE_APPLY_GAIN_LUT
+          // The gain LUT also divides by the display boost.
           Color rgb_hdr = applyGainLUT(rgb_sdr, gain, gainLUT);
 #else
           Color rgb_hdr = applyGain(rgb_sdr, gain, metadata, display_boost);
-#endif
           rgb_hdr = rgb_hdr / display_boost;
-          size_t pixel_idx = x + y * width;
+#endif
+          size_t pixel_idx = (x - region_left) + (y - region->top) * region->width;
 
           switch (output_format) {
             case ULTRAHDR_OUTPUT_HDR_LINEAR:
@@ -1083,9 +1217,9 @@ status_t JpegR::applyGainMap(jr_uncompressed_ptr uncompressed_yuv_420_image,
   for (int th = 0; th < threads - 1; th++) {
     workers.push_back(std::thread(applyRecMap));
   }
-  const int rowStep = threads == 1 ? uncompressed_yuv_420_image->height : kJobSzInRows;
-  for (int rowStart = 0; rowStart < uncompressed_yuv_420_image->height;) {
-    int rowEnd = std::min(rowStart + rowStep, uncompressed_yuv_420_image->height);
+  const size_t rowStep = threads == 1 ? row_end - row_start : kJobSzInRows;
+  for (size_t rowStart = row_start; rowStart < row_end;) {
+    size_t rowEnd = std::min(rowStart + rowStep, row_end);
     jobQueue.enqueueJob(rowStart, rowEnd);
     rowStart = rowEnd;
   }
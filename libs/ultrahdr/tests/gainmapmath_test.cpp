@@ -15,6 +15,7 @@
  */
 
 #include <cmath>
+#include <vector>
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <ultrahdr/gainmapmath.h>
@@ -864,6 +865,24 @@ TEST_F(GainMapMathTest, applyGainLUT) {
   }
 }
 
+TEST_F(GainMapMathTest, applyGainLUTWithScale) {
+  for (int boost = 1; boost <= 10; boost++) {
+    ultrahdr_metadata_struct metadata = { .maxContentBoost = static_cast<float>(boost),
+                                       .minContentBoost = 1.0f / static_cast<float>(boost) };
+    float displayBoost = static_cast<float>(boost) / 2.0f;
+    GainLUT gainLUTWithBoost(&metadata, displayBoost);
+    GainLUT gainLUTWithScale(&metadata, displayBoost, 1.0f / displayBoost);
+    for (int idx = 0; idx < kGainFactorNumEntries; idx++) {
+      float value = static_cast<float>(idx) / static_cast<float>(kGainFactorNumEntries - 1);
+      EXPECT_RGB_NEAR(applyGainLUT(RgbWhite(), value, gainLUTWithBoost) / displayBoost,
+                      applyGainLUT(RgbWhite(), value, gainLUTWithScale));
+      EXPECT_RGB_NEAR(applyGainLUT(RgbRed(), value, gainLUTWithBoost) / displayBoost,
+                      applyGainLUT(RgbRed(), value, gainLUTWithScale));
+      EXPECT_RGB_EQ(RgbBlack(), applyGainLUT(RgbBlack(), value, gainLUTWithScale));
+    }
+  }
+}
+
 TEST_F(GainMapMathTest, PqTransferFunctionRoundtrip) {
   EXPECT_FLOAT_EQ(pqInvOetf(pqOetf(0.0f)), 0.0f);
   EXPECT_NEAR(pqInvOetf(pqOetf(0.01f)), 0.01f, ComparisonEpsilon());
@@ -1156,6 +1175,24 @@ TEST_F(GainMapMathTest, SampleMap) {
   }
 }
 
+TEST_F(GainMapMathTest, SampleMapRow) {
+  jpegr_uncompressed_struct image = MapImage();
+
+  for (size_t mapScaleFactor : {size_t(2), size_t(4)}) {
+    ShepardsIDW idwTable(mapScaleFactor);
+    // Include a partial map column at the end of the row.
+    const size_t width = 4 * mapScaleFactor - 1;
+    std::vector<float> gains(width);
+    for (size_t y = 0; y < 4 * mapScaleFactor; ++y) {
+      sampleMapRow(&image, mapScaleFactor, y, idwTable, gains.data(), width);
+      for (size_t x = 0; x < width; ++x) {
+        EXPECT_FLOAT_EQ(gains[x], sampleMap(&image, mapScaleFactor, x, y, idwTable))
+            << "x=" << x << " y=" << y << " scale=" << mapScaleFactor;
+      }
+    }
+  }
+}
+
 TEST_F(GainMapMathTest, ColorToRgba1010102) {
   EXPECT_EQ(colorToRgba1010102(RgbBlack()), 0x3 << 30);
   EXPECT_EQ(colorToRgba1010102(RgbWhite()), 0xFFFFFFFF);
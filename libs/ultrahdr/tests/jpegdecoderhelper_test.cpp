@@ -122,6 +122,48 @@ TEST_F(JpegDecoderHelperTest, decodeGreyImage) {
     ASSERT_GT(decoder.getDecompressedImageSize(), static_cast<uint32_t>(0));
 }
 
+TEST_F(JpegDecoderHelperTest, decodeYuvImageInStrips) {
+    const size_t stripHeight = 64;
+    JpegDecoderHelper decoder;
+    ASSERT_TRUE(decoder.decompressImage(mYuvImage.buffer.get(), mYuvImage.size));
+    const uint8_t* image = static_cast<const uint8_t*>(decoder.getDecompressedImagePtr());
+    const size_t ySize = IMAGE_WIDTH * IMAGE_HEIGHT;
+
+    JpegDecoderHelper stripDecoder;
+    size_t nextRow = 0;
+    EXPECT_TRUE(stripDecoder.decompressImageInStrips(
+            mYuvImage.buffer.get(), mYuvImage.size, stripHeight,
+            [&](const uint8_t* strip, size_t firstRow, size_t rowCount) {
+                EXPECT_EQ(firstRow, nextRow);
+                EXPECT_LE(rowCount, stripHeight);
+                const size_t stripYSize = IMAGE_WIDTH * stripHeight;
+                for (size_t row = 0; row < rowCount; row++) {
+                    EXPECT_EQ(0, memcmp(strip + row * IMAGE_WIDTH,
+                                        image + (firstRow + row) * IMAGE_WIDTH, IMAGE_WIDTH));
+                }
+                for (size_t row = 0; row < rowCount / 2; row++) {
+                    const size_t stripOffset = row * IMAGE_WIDTH / 2;
+                    const size_t imageOffset = (firstRow / 2 + row) * IMAGE_WIDTH / 2;
+                    EXPECT_EQ(0, memcmp(strip + stripYSize + stripOffset,
+                                        image + ySize + imageOffset, IMAGE_WIDTH / 2));
+                    EXPECT_EQ(0, memcmp(strip + stripYSize * 5 / 4 + stripOffset,
+                                        image + ySize * 5 / 4 + imageOffset, IMAGE_WIDTH / 2));
+                }
+                nextRow += rowCount;
+                return true;
+            }));
+    EXPECT_EQ(nextRow, IMAGE_HEIGHT);
+    EXPECT_EQ(stripDecoder.getDecompressedImageWidth(), IMAGE_WIDTH);
+    EXPECT_EQ(stripDecoder.getDecompressedImageHeight(), IMAGE_HEIGHT);
+}
+
+TEST_F(JpegDecoderHelperTest, decodeGreyImageInStripsFails) {
+    JpegDecoderHelper decoder;
+    EXPECT_FALSE(decoder.decompressImageInStrips(
+            mGreyImage.buffer.get(), mGreyImage.size, 64,
+            [](const uint8_t*, size_t, size_t) { return true; }));
+}
+
 TEST_F(JpegDecoderHelperTest, getCompressedImageParameters) {
     size_t width = 0, height = 0;
     std::vector<uint8_t> icc, exif;
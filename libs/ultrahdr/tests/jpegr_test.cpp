@@ -1069,6 +1069,65 @@ TEST_F(JpegRTest, encodeFromP010ThenDecode) {
   free(decodedJpegR.data);
 }
 
+/* Test Encode API-0 and decode a region */
+TEST_F(JpegRTest, encodeFromP010ThenDecodeRegion) {
+  int ret;
+
+  // Load input files.
+  if (!loadFile(RAW_P010_IMAGE, mRawP010Image.data, nullptr)) {
+    FAIL() << "Load file " << RAW_P010_IMAGE << " failed";
+  }
+  mRawP010Image.width = TEST_IMAGE_WIDTH;
+  mRawP010Image.height = TEST_IMAGE_HEIGHT;
+  mRawP010Image.colorGamut = ultrahdr_color_gamut::ULTRAHDR_COLORGAMUT_BT2100;
+
+  JpegR jpegRCodec;
+
+  jpegr_compressed_struct jpegR;
+  jpegR.maxLength = TEST_IMAGE_WIDTH * TEST_IMAGE_HEIGHT * sizeof(uint8_t);
+  jpegR.data = malloc(jpegR.maxLength);
+  ret = jpegRCodec.encodeJPEGR(
+      &mRawP010Image, ultrahdr_transfer_function::ULTRAHDR_TF_HLG, &jpegR, DEFAULT_JPEG_QUALITY,
+      nullptr);
+  if (ret != OK) {
+    FAIL() << "Error code is " << ret;
+  }
+
+  jpegr_uncompressed_struct decodedJpegR;
+  decodedJpegR.data = malloc(TEST_IMAGE_WIDTH * TEST_IMAGE_HEIGHT * 8);
+  ret = jpegRCodec.decodeJPEGR(&jpegR, &decodedJpegR);
+  if (ret != OK) {
+    FAIL() << "Error code is " << ret;
+  }
+
+  jpegr_region_struct region = {TEST_IMAGE_WIDTH / 4 + 1, TEST_IMAGE_HEIGHT / 2 + 1,
+                                TEST_IMAGE_WIDTH / 2, TEST_IMAGE_HEIGHT / 3};
+  jpegr_uncompressed_struct decodedRegion;
+  decodedRegion.data = malloc(region.width * region.height * 8);
+  ret = jpegRCodec.decodeJPEGR(&jpegR, &decodedRegion, FLT_MAX, nullptr,
+                               ULTRAHDR_OUTPUT_HDR_LINEAR, nullptr, nullptr, &region);
+  if (ret != OK) {
+    FAIL() << "Error code is " << ret;
+  }
+  EXPECT_EQ(region.width, decodedRegion.width);
+  EXPECT_EQ(region.height, decodedRegion.height);
+  for (int row = 0; row < region.height; row++) {
+    const uint64_t* expected = static_cast<uint64_t*>(decodedJpegR.data)
+        + (region.top + row) * TEST_IMAGE_WIDTH + region.left;
+    const uint64_t* actual = static_cast<uint64_t*>(decodedRegion.data) + row * region.width;
+    EXPECT_EQ(0, memcmp(expected, actual, region.width * sizeof(uint64_t))) << "row " << row;
+  }
+
+  jpegr_region_struct outside = {TEST_IMAGE_WIDTH / 2, 0, TEST_IMAGE_WIDTH, 1};
+  EXPECT_NE(OK, jpegRCodec.decodeJPEGR(&jpegR, &decodedRegion, FLT_MAX, nullptr,
+                                       ULTRAHDR_OUTPUT_HDR_LINEAR, nullptr, nullptr, &outside))
+      << "fail, API allows a region outside of the image";
+
+  free(jpegR.data);
+  free(decodedJpegR.data);
+  free(decodedRegion.data);
+}
+
 /* Test Encode API-0 (with stride) and decode */
 TEST_F(JpegRTest, encodeFromP010WithStrideThenDecode) {
   int ret;
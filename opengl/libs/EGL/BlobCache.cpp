@@ -56,6 +56,11 @@ BlobCache::BlobCache(size_t maxKeySize, size_t maxValueSize, size_t maxTotalSize
 
 BlobCache::InsertResult BlobCache::set(const void* key, size_t keySize, const void* value,
                                        size_t valueSize) {
+    return insert(key, keySize, value, valueSize, /*copyData*/ true);
+}
+
+BlobCache::InsertResult BlobCache::insert(const void* key, size_t keySize, const void* value,
+                                          size_t valueSize, bool copyData) {
     if (mMaxKeySize < keySize) {
         ALOGV("set: not caching because the key is too large: %zu (limit: %zu)", keySize,
               mMaxKeySize);
@@ -89,8 +94,8 @@ BlobCache::InsertResult BlobCache::set(const void* key, size_t keySize, const vo
         auto index = std::lower_bound(mCacheEntries.begin(), mCacheEntries.end(), cacheEntry);
         if (index == mCacheEntries.end() || cacheEntry < *index) {
             // Create a new cache entry.
-            std::shared_ptr<Blob> keyBlob(new Blob(key, keySize, true));
-            std::shared_ptr<Blob> valueBlob(new Blob(value, valueSize, true));
+            std::shared_ptr<Blob> keyBlob(new Blob(key, keySize, copyData));
+            std::shared_ptr<Blob> valueBlob(new Blob(value, valueSize, copyData));
             size_t newTotalSize = mTotalSize + keySize + valueSize;
             if (mMaxTotalSize < newTotalSize) {
                 if (isCleanable()) {
@@ -112,7 +117,7 @@ BlobCache::InsertResult BlobCache::set(const void* key, size_t keySize, const vo
                   valueSize);
         } else {
             // Update the existing cache entry.
-            std::shared_ptr<Blob> valueBlob(new Blob(value, valueSize, true));
+            std::shared_ptr<Blob> valueBlob(new Blob(value, valueSize, copyData));
             std::shared_ptr<Blob> oldValueBlob(index->getValue());
             size_t newTotalSize = mTotalSize + valueSize - oldValueBlob->getSize();
             if (mMaxTotalSize < newTotalSize) {
@@ -231,7 +236,7 @@ int BlobCache::flatten(void* buffer, size_t size) const {
     return 0;
 }
 
-int BlobCache::unflatten(void const* buffer, size_t size) {
+int BlobCache::unflatten(void const* buffer, size_t size, bool copyData) {
     ATRACE_NAME("BlobCache::unflatten");
 
     // All errors should result in the BlobCache being in an empty state.
@@ -280,7 +285,7 @@ int BlobCache::unflatten(void const* buffer, size_t size) {
         }
 
         const uint8_t* data = eheader->mData;
-        set(data, keySize, data + keySize, valueSize);
+        insert(data, keySize, data + keySize, valueSize, copyData);
 
         byteOffset += totalSize;
     }
@@ -113,7 +113,11 @@ public:
     // unflattening the serialized cache contents then the BlobCache will be
     // left in an empty state.
     //
-    int unflatten(void const* buffer, size_t size);
+    // If copyData is false, the cache entries reference the serialized keys
+    // and values in 'buffer' instead of copying them, so 'buffer' must stay
+    // valid and unmodified for as long as those entries remain in the cache.
+    // Entries inserted or updated later with set are always copied.
+    int unflatten(void const* buffer, size_t size, bool copyData = true);
 
     // clear flushes out all contents of the cache then the BlobCache, leaving
     // it in an empty state.
@@ -135,6 +139,11 @@ private:
     BlobCache(const BlobCache&);
     void operator=(const BlobCache&);
 
+    // insert implements set. If copyData is false, the new entry references
+    // the key and value memory instead of copying it.
+    InsertResult insert(const void* key, size_t keySize, const void* value, size_t valueSize,
+                        bool copyData);
+
     // A random function helper to get around MinGW not having nrand48()
     long int blob_random();
 
@@ -21,6 +21,7 @@
 #include <stdio.h>
 
 #include <memory>
+#include <vector>
 
 namespace android {
 
@@ -336,6 +337,27 @@ TEST_F(BlobCacheFlattenTest, FlattenOneValue) {
     ASSERT_EQ('h', buf[3]);
 }
 
+TEST_F(BlobCacheFlattenTest, UnflattenWithoutCopyReferencesBuffer) {
+    unsigned char buf[4] = {0xee, 0xee, 0xee, 0xee};
+    mBC->set("abcd", 4, "efgh", 4);
+
+    size_t size = mBC->getFlattenedSize();
+    std::vector<uint8_t> flat(size);
+    ASSERT_EQ(OK, mBC->flatten(flat.data(), size));
+    ASSERT_EQ(OK, mBC2->unflatten(flat.data(), size, /*copyData*/ false));
+    ASSERT_EQ(size_t(4), mBC2->get("abcd", 4, buf, 4));
+    ASSERT_EQ('e', buf[0]);
+    ASSERT_EQ('h', buf[3]);
+
+    // Entries held in the buffer can still be updated.
+    mBC2->set("abcd", 4, "ijkl", 4);
+    mBC2->set("mnop", 4, "qrst", 4);
+    ASSERT_EQ(size_t(4), mBC2->get("abcd", 4, buf, 4));
+    ASSERT_EQ('i', buf[0]);
+    ASSERT_EQ(size_t(4), mBC2->get("mnop", 4, buf, 4));
+    ASSERT_EQ('q', buf[0]);
+}
+
 TEST_F(BlobCacheFlattenTest, FlattenFullCache) {
     // Fill up the entire cache with 1 char key/value pairs.
     const int maxEntries = MAX_TOTAL_SIZE / 2;
@@ -93,31 +93,41 @@ FileBlobCache::FileBlobCache(size_t maxKeySize, size_t maxValueSize, size_t maxT
             return;
         }
 
+        // The mapping outlives the file descriptor.
+        close(fd);
+
         // Check the file magic and CRC
         size_t cacheSize = fileSize - headerSize;
         if (memcmp(buf, cacheFileMagic, 4) != 0) {
             ALOGE("cache file has bad mojo");
-            close(fd);
+            munmap(buf, fileSize);
             return;
         }
         uint32_t* crc = reinterpret_cast<uint32_t*>(buf + 4);
         if (crc32c(buf + headerSize, cacheSize) != *crc) {
             ALOGE("cache file failed CRC check");
-            close(fd);
+            munmap(buf, fileSize);
             return;
         }
 
-        int err = unflatten(buf + headerSize, cacheSize);
+        int err = unflatten(buf + headerSize, cacheSize, /*copyData*/ false);
         if (err < 0) {
             ALOGE("error reading cache contents: %s (%d)", strerror(-err),
                     -err);
             munmap(buf, fileSize);
-            close(fd);
             return;
         }
 
-        munmap(buf, fileSize);
-        close(fd);
+        mMappedFile = buf;
+        mMappedFileSize = fileSize;
+    }
+}
+
+FileBlobCache::~FileBlobCache() {
+    // Drop the entries that reference the mapping before unmapping it.
+    clear();
+    if (mMappedFile != nullptr) {
+        munmap(mMappedFile, mMappedFileSize);
     }
 }
 
@@ -28,8 +28,12 @@ class FileBlobCache : public BlobCache {
 public:
     // FileBlobCache attempts to load the saved cache contents from disk into
     // BlobCache.
+    // The file stays mapped for the lifetime of the FileBlobCache, and the
+    // loaded entries are served straight from the mapping, so their pages are
+    // shared through the page cache instead of being copied to the heap.
     FileBlobCache(size_t maxKeySize, size_t maxValueSize, size_t maxTotalSize,
             const std::string& filename);
+    ~FileBlobCache();
 
     // writeToFile attempts to save the current contents of BlobCache to
     // disk.
@@ -41,6 +45,13 @@ public:
 private:
     // mFilename is the name of the file for storing cache contents.
     std::string mFilename;
+
+    // mMappedFile is the read-only mapping of the cache file that the loaded
+    // entries reference, or nullptr if nothing was loaded. The file is only
+    // ever replaced by unlinking it, so the mapping stays valid after
+    // writeToFile.
+    uint8_t* mMappedFile = nullptr;
+    size_t mMappedFileSize = 0;
 };
 
 } // namespace android
@@ -427,6 +427,28 @@ void Loader::init_api(void* dso,
     }
 }
 
+// Fills |curr| for the subset |api| of |ref_api|, exactly as init_api() would,
+// but takes each entry point from |resolved|, a table that init_api() already
+// filled for |ref_api| from the same library. This saves a second round of
+// dlsym()/eglGetProcAddress() lookups when a single library provides both the
+// GLESv1_CM and GLESv2 entry points.
+static void copy_api(char const* const* api, char const* const* ref_api,
+                     __eglMustCastToProperFunctionPointerType* curr,
+                     const __eglMustCastToProperFunctionPointerType* resolved) {
+    ATRACE_CALL();
+
+    while (*api) {
+        if (std::strcmp(*api, *ref_api) != 0) {
+            *curr++ = nullptr;
+        } else {
+            *curr++ = *resolved;
+            api++;
+        }
+        ref_api++;
+        resolved++;
+    }
+}
+
 static void* load_system_driver(const char* kind, const char* suffix, const bool exact) {
     ATRACE_CALL();
     class MatchFile {
@@ -691,19 +713,29 @@ void Loader::initialize_api(void* dso, egl_connection_t* cnx, uint32_t mask) {
         }
     }
 
-    if (mask & GLESv1_CM) {
-        init_api(dso, gl_names_1, gl_names,
-            (__eglMustCastToProperFunctionPointerType*)
-                &cnx->hooks[egl_connection_t::GLESv1_INDEX]->gl,
-            getProcAddress);
-    }
-
     if (mask & GLESv2) {
         init_api(dso, gl_names, nullptr,
             (__eglMustCastToProperFunctionPointerType*)
                 &cnx->hooks[egl_connection_t::GLESv2_INDEX]->gl,
             getProcAddress);
     }
+
+    if (mask & GLESv1_CM) {
+        if (mask & GLESv2) {
+            // GLESv1_CM is a subset of GLESv2 and both come from |dso|, so reuse
+            // the entry points that were just resolved.
+            copy_api(gl_names_1, gl_names,
+                (__eglMustCastToProperFunctionPointerType*)
+                    &cnx->hooks[egl_connection_t::GLESv1_INDEX]->gl,
+                (__eglMustCastToProperFunctionPointerType*)
+                    &cnx->hooks[egl_connection_t::GLESv2_INDEX]->gl);
+        } else {
+            init_api(dso, gl_names_1, gl_names,
+                (__eglMustCastToProperFunctionPointerType*)
+                    &cnx->hooks[egl_connection_t::GLESv1_INDEX]->gl,
+                getProcAddress);
+        }
+    }
 }
 
 } // namespace android
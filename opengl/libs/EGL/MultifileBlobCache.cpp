@@ -42,6 +42,11 @@ using namespace std::literals;
 constexpr uint32_t kMultifileMagic = 'MFB$';
 constexpr uint32_t kCrcPlaceholder = 0;
 
+// Magic of the file listing entries in the order they were first used
+constexpr uint32_t kAccessOrderMagic = 'MFA$';
+// Bounds the size of the access order file, and how much the next run prefetches
+constexpr size_t kMaxAccessOrderEntries = 2048;
+
 namespace {
 
 // Helper function to close entries or free them
@@ -70,6 +75,7 @@ MultifileBlobCache::MultifileBlobCache(size_t maxKeySize, size_t maxValueSize, s
         mTotalCacheSize(0),
         mHotCacheLimit(0),
         mHotCacheSize(0),
+        mPrefetchCancelled(false),
         mWorkerThreadIdle(true) {
     if (baseDir.empty()) {
         ALOGV("INIT: no baseDir provided in MultifileBlobCache constructor, returning early.");
@@ -78,6 +84,7 @@ MultifileBlobCache::MultifileBlobCache(size_t maxKeySize, size_t maxValueSize, s
 
     // Establish the name of our multifile directory
     mMultifileDirName = baseDir + ".multifile";
+    mAccessOrderFileName = mMultifileDirName + ".access";
 
     // Set the hotcache limit to be large enough to contain one max entry
     // This ensure the hot cache is always large enough for single entry
@@ -230,6 +237,19 @@ MultifileBlobCache::MultifileBlobCache(size_t maxKeySize, size_t maxValueSize, s
     }
 
     mInitialized = true;
+
+    // Prefetch the entries the previous run used that aren't preloaded, in the order it used them
+    std::vector<std::string> prefetchPaths;
+    for (uint32_t entryHash : readAccessOrder()) {
+        if (contains(entryHash) && mHotCache.find(entryHash) == mHotCache.end()) {
+            prefetchPaths.push_back(mMultifileDirName + "/" + std::to_string(entryHash));
+        }
+    }
+    if (!prefetchPaths.empty()) {
+        ALOGV("INIT: Prefetching %zu entries", prefetchPaths.size());
+        mPrefetchThread =
+                std::thread(&MultifileBlobCache::prefetchEntries, this, std::move(prefetchPaths));
+    }
 }
 
 MultifileBlobCache::~MultifileBlobCache() {
@@ -237,6 +257,12 @@ MultifileBlobCache::~MultifileBlobCache() {
         return;
     }
 
+    // Stop prefetching, the remaining entries won't be needed
+    mPrefetchCancelled = true;
+    if (mPrefetchThread.joinable()) {
+        mPrefetchThread.join();
+    }
+
     // Inform the worker thread we're done
     ALOGV("DESCTRUCTOR: Shutting down worker thread");
     DeferredTask task(TaskCommand::Exit);
@@ -293,6 +319,7 @@ void MultifileBlobCache::set(const void* key, EGLsizeiANDROID keySize, const voi
 
     // Track the size and access time for quick recall
     trackEntry(entryHash, valueSize, fileSize, time(0));
+    recordAccess(entryHash);
 
     // Update the overall cache size
     increaseTotalCacheSize(fileSize);
@@ -444,6 +471,7 @@ EGLsizeiANDROID MultifileBlobCache::get(const void* key, EGLsizeiANDROID keySize
     // Remaining entry following the key is the value
     uint8_t* cachedValue = cacheEntry + (keySize + sizeof(MultifileHeader));
     memcpy(value, cachedValue, cachedValueSize);
+    recordAccess(entryHash);
 
     return cachedValueSize;
 }
@@ -457,6 +485,8 @@ void MultifileBlobCache::finish() {
     ALOGV("FINISH: Waiting for work to complete.");
     waitForWorkComplete();
 
+    writeAccessOrder();
+
     // Close all entries in the hot cache
     for (auto hotCacheIter = mHotCache.begin(); hotCacheIter != mHotCache.end();) {
         uint32_t entryHash = hotCacheIter->first;
@@ -601,6 +631,86 @@ bool MultifileBlobCache::applyLRU(size_t cacheLimit) {
     return false;
 }
 
+void MultifileBlobCache::recordAccess(uint32_t entryHash) {
+    if (mAccessOrder.size() >= kMaxAccessOrderEntries) {
+        return;
+    }
+    if (mAccessedEntries.insert(entryHash).second) {
+        mAccessOrder.push_back(entryHash);
+    }
+}
+
+void MultifileBlobCache::writeAccessOrder() {
+    if (mAccessOrder.empty()) {
+        return;
+    }
+
+    // Write to a temporary file first, so a reader never sees a partial list
+    std::string tempPath = mAccessOrderFileName + ".tmp";
+    int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+        ALOGE("FINISH: Failed to open %s: %s", tempPath.c_str(), std::strerror(errno));
+        return;
+    }
+
+    const uint32_t header[2] = {kAccessOrderMagic, static_cast<uint32_t>(mAccessOrder.size())};
+    size_t orderSize = mAccessOrder.size() * sizeof(uint32_t);
+    bool written = write(fd, header, sizeof(header)) == sizeof(header) &&
+            write(fd, mAccessOrder.data(), orderSize) == static_cast<ssize_t>(orderSize);
+    close(fd);
+
+    if (!written || rename(tempPath.c_str(), mAccessOrderFileName.c_str()) != 0) {
+        ALOGE("FINISH: Failed to write %s: %s", mAccessOrderFileName.c_str(),
+              std::strerror(errno));
+        remove(tempPath.c_str());
+    }
+}
+
+std::vector<uint32_t> MultifileBlobCache::readAccessOrder() {
+    std::vector<uint32_t> accessOrder;
+
+    int fd = open(mAccessOrderFileName.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return accessOrder;
+    }
+
+    uint32_t header[2];
+    if (read(fd, header, sizeof(header)) != sizeof(header) || header[0] != kAccessOrderMagic ||
+        header[1] > kMaxAccessOrderEntries) {
+        ALOGE("INIT: Ignoring invalid access order file %s", mAccessOrderFileName.c_str());
+        close(fd);
+        return accessOrder;
+    }
+
+    accessOrder.resize(header[1]);
+    size_t orderSize = accessOrder.size() * sizeof(uint32_t);
+    if (read(fd, accessOrder.data(), orderSize) != static_cast<ssize_t>(orderSize)) {
+        ALOGE("INIT: Truncated access order file %s", mAccessOrderFileName.c_str());
+        accessOrder.clear();
+    }
+    close(fd);
+    return accessOrder;
+}
+
+void MultifileBlobCache::prefetchEntries(std::vector<std::string> entryPaths) {
+    for (const std::string& entryPath : entryPaths) {
+        if (mPrefetchCancelled) {
+            ALOGV("PREFETCH: Cancelled");
+            return;
+        }
+
+        // The entry may have been removed by a trim since the list was built
+        int fd = open(entryPath.c_str(), O_RDONLY);
+        if (fd == -1) {
+            continue;
+        }
+
+        ALOGV("PREFETCH: Reading ahead %s", entryPath.c_str());
+        posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+        close(fd);
+    }
+}
+
 // When removing files, what fraction of the overall limit should be reached when removing files
 // A divisor of two will decrease the cache to 50%, four to 25% and so on
 constexpr uint32_t kCacheLimitDivisor = 2;
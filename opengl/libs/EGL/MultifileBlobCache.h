@@ -21,6 +21,7 @@
 #include <EGL/eglext.h>
 
 #include <android-base/thread_annotations.h>
+#include <atomic>
 #include <future>
 #include <map>
 #include <queue>
@@ -28,6 +29,7 @@
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "FileBlobCache.h"
 
@@ -123,6 +125,16 @@ private:
     void trimCache();
     bool applyLRU(size_t cacheLimit);
 
+    // Entries are recorded in the order they are first used, and the order is saved by finish()
+    // so that the next run can prefetch them in the same order.
+    void recordAccess(uint32_t entryHash);
+    void writeAccessOrder();
+    std::vector<uint32_t> readAccessOrder();
+
+    // Runs on mPrefetchThread, asking the kernel to read the given entry files into the page
+    // cache so that later hot cache misses don't block on storage.
+    void prefetchEntries(std::vector<std::string> entryPaths);
+
     bool mInitialized;
     std::string mMultifileDirName;
 
@@ -138,6 +150,13 @@ private:
     size_t mHotCacheEntryLimit;
     size_t mHotCacheSize;
 
+    std::string mAccessOrderFileName;
+    std::vector<uint32_t> mAccessOrder;
+    std::unordered_set<uint32_t> mAccessedEntries;
+
+    std::thread mPrefetchThread;
+    std::atomic<bool> mPrefetchCancelled;
+
     // Below are the components used for deferred writes
 
     // Track whether we have pending writes for an entry
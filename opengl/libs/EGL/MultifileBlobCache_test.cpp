@@ -20,8 +20,11 @@
 #include <fcntl.h>
 #include <gtest/gtest.h>
 #include <stdio.h>
+#include <unistd.h>
+#include <utils/JenkinsHash.h>
 
 #include <memory>
+#include <string>
 
 namespace android {
 
@@ -270,4 +273,36 @@ TEST_F(MultifileBlobCacheTest, EnsureFileDescriptorsClosed) {
     ASSERT_LT(getFileDescriptorCount(), kLargeNumberOfEntries / 2);
 }
 
+TEST_F(MultifileBlobCacheTest, FinishRecordsAccessOrder) {
+    unsigned char buf[2] = {0xee, 0xee};
+    mMBC->set("ab", 2, "cd", 2);
+    mMBC->set("ef", 2, "gh", 2);
+    ASSERT_EQ(size_t(2), mMBC->get("ef", 2, buf, 2));
+    ASSERT_EQ(size_t(2), mMBC->get("ab", 2, buf, 2));
+
+    mMBC->finish();
+    mMBC.reset();
+
+    // Entries are listed once, in the order they were first used
+    std::string accessOrderPath = std::string(&mTempFile->path[0]) + ".multifile.access";
+    int fd = open(accessOrderPath.c_str(), O_RDONLY);
+    ASSERT_NE(-1, fd);
+    uint32_t accessOrder[4];
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(accessOrder)),
+              read(fd, accessOrder, sizeof(accessOrder)));
+    close(fd);
+    ASSERT_EQ(uint32_t(2), accessOrder[1]);
+    ASSERT_EQ(android::JenkinsHashMixBytes(0, reinterpret_cast<const uint8_t*>("ab"), 2),
+              accessOrder[2]);
+    ASSERT_EQ(android::JenkinsHashMixBytes(0, reinterpret_cast<const uint8_t*>("ef"), 2),
+              accessOrder[3]);
+
+    // The next run prefetches the entries and still serves them
+    mMBC.reset(
+            new MultifileBlobCache(kMaxKeySize, kMaxValueSize, kMaxTotalSize, &mTempFile->path[0]));
+    ASSERT_EQ(size_t(2), mMBC->get("ef", 2, buf, 2));
+    ASSERT_EQ('g', buf[0]);
+    ASSERT_EQ('h', buf[1]);
+}
+
 } // namespace android
@@ -19,9 +19,11 @@
 #include "egl_cache.h"
 
 #include <android-base/properties.h>
+#include <graphicsenv/GraphicsEnv.h>
 #include <inttypes.h>
 #include <log/log.h>
 #include <private/EGL/cache.h>
+#include <private/android_filesystem_config.h>
 #include <unistd.h>
 
 #include <thread>
@@ -68,7 +70,12 @@ static EGLsizeiANDROID getBlob(const void* key, EGLsizeiANDROID keySize, void* v
 // egl_cache_t definition
 //
 egl_cache_t::egl_cache_t()
-      : mInitialized(false), mMultifileMode(false), mCacheByteLimit(kMaxMonolithicTotalSize) {}
+      : mInitialized(false),
+        mMultifileMode(false),
+        mCacheByteLimit(kMaxMonolithicTotalSize),
+        mSharedMode(false),
+        mSharedProducer(false),
+        mSharedPrefetchStarted(false) {}
 
 egl_cache_t::~egl_cache_t() {}
 
@@ -108,6 +115,17 @@ void egl_cache_t::initialize(egl_display_t* display) {
                       "%#x",
                       err);
             }
+
+            // Shared entries come from the system driver, so apps using an updatable driver or
+            // ANGLE must not load them.
+            GraphicsEnv& graphicsEnv = GraphicsEnv::getInstance();
+            mSharedMode = base::GetBoolProperty("ro.egl.blobcache.shared", false) &&
+                    !graphicsEnv.getDriverNamespace() && !graphicsEnv.shouldUseAngle();
+            if (mSharedMode) {
+                const uid_t uid = getuid();
+                mSharedProducer = uid == AID_SYSTEM || uid == AID_GRAPHICS;
+                startSharedPrefetchLocked();
+            }
         }
     }
 
@@ -129,61 +147,44 @@ void egl_cache_t::terminate() {
 
 void egl_cache_t::setBlob(const void* key, EGLsizeiANDROID keySize, const void* value,
                           EGLsizeiANDROID valueSize) {
-    std::lock_guard<std::mutex> lock(mMutex);
-
     if (keySize < 0 || valueSize < 0) {
         ALOGW("EGL_ANDROID_blob_cache set: negative sizes are not allowed");
         return;
     }
 
-    updateMode();
-
-    if (mInitialized) {
-        if (mMultifileMode) {
-            MultifileBlobCache* mbc = getMultifileBlobCacheLocked();
-            mbc->set(key, keySize, value, valueSize);
-        } else {
-            BlobCache* bc = getBlobCacheLocked();
-            bc->set(key, keySize, value, valueSize);
-
-            if (!mSavePending) {
-                mSavePending = true;
-                std::thread deferredSaveThread([this]() {
-                    sleep(kDeferredMonolithicSaveDelay);
-                    std::lock_guard<std::mutex> lock(mMutex);
-                    if (mInitialized && mBlobCache) {
-                        mBlobCache->writeToFile();
-                    }
-                    mSavePending = false;
-                });
-                deferredSaveThread.detach();
-            }
+    bool submitShared;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        updateMode();
+        if (!mInitialized) {
+            return;
         }
+        setLocalBlobLocked(key, keySize, value, valueSize);
+        submitShared = mSharedMode && mSharedProducer;
+    }
+
+    // Submit the entry outside of mMutex so other threads aren't blocked on the binder call.
+    if (submitShared) {
+        const uint8_t* keyBytes = static_cast<const uint8_t*>(key);
+        const uint8_t* valueBytes = static_cast<const uint8_t*>(value);
+        GraphicsEnv::getInstance().setSharedShaderCacheEntry({keyBytes, keyBytes + keySize},
+                                                             {valueBytes, valueBytes + valueSize});
     }
 }
 
 EGLsizeiANDROID egl_cache_t::getBlob(const void* key, EGLsizeiANDROID keySize, void* value,
                                      EGLsizeiANDROID valueSize) {
-    std::lock_guard<std::mutex> lock(mMutex);
-
     if (keySize < 0 || valueSize < 0) {
         ALOGW("EGL_ANDROID_blob_cache get: negative sizes are not allowed");
         return 0;
     }
 
+    std::lock_guard<std::mutex> lock(mMutex);
     updateMode();
-
-    if (mInitialized) {
-        if (mMultifileMode) {
-            MultifileBlobCache* mbc = getMultifileBlobCacheLocked();
-            return mbc->get(key, keySize, value, valueSize);
-        } else {
-            BlobCache* bc = getBlobCacheLocked();
-            return bc->get(key, keySize, value, valueSize);
-        }
+    if (!mInitialized) {
+        return 0;
     }
-
-    return 0;
+    return getLocalBlobLocked(key, keySize, value, valueSize);
 }
 
 void egl_cache_t::setCacheMode(EGLCacheMode cacheMode) {
@@ -282,4 +283,74 @@ MultifileBlobCache* egl_cache_t::getMultifileBlobCacheLocked() {
     return mMultifileBlobCache.get();
 }
 
+EGLsizeiANDROID egl_cache_t::getLocalBlobLocked(const void* key, EGLsizeiANDROID keySize,
+                                                void* value, EGLsizeiANDROID valueSize) {
+    if (mMultifileMode) {
+        MultifileBlobCache* mbc = getMultifileBlobCacheLocked();
+        return mbc->get(key, keySize, value, valueSize);
+    } else {
+        BlobCache* bc = getBlobCacheLocked();
+        return bc->get(key, keySize, value, valueSize);
+    }
+}
+
+void egl_cache_t::setLocalBlobLocked(const void* key, EGLsizeiANDROID keySize, const void* value,
+                                     EGLsizeiANDROID valueSize) {
+    if (mMultifileMode) {
+        MultifileBlobCache* mbc = getMultifileBlobCacheLocked();
+        mbc->set(key, keySize, value, valueSize);
+    } else {
+        BlobCache* bc = getBlobCacheLocked();
+        bc->set(key, keySize, value, valueSize);
+
+        if (!mSavePending) {
+            mSavePending = true;
+            std::thread deferredSaveThread([this]() {
+                sleep(kDeferredMonolithicSaveDelay);
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (mInitialized && mBlobCache) {
+                    mBlobCache->writeToFile();
+                }
+                mSavePending = false;
+            });
+            deferredSaveThread.detach();
+        }
+    }
+}
+
+void egl_cache_t::startSharedPrefetchLocked() {
+    if (mSharedPrefetchStarted) {
+        return;
+    }
+    mSharedPrefetchStarted = true;
+
+    // Copy the shared entries into the local cache once, in the background, so that cache misses
+    // on the GL thread never wait for GpuService.
+    std::thread prefetchThread([this]() {
+        std::vector<uint8_t> after;
+        while (true) {
+            const auto entries = GraphicsEnv::getInstance().getSharedShaderCacheEntries(after);
+            if (entries.empty()) {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            updateMode();
+            if (!mInitialized) {
+                return;
+            }
+            for (const auto& [key, value] : entries) {
+                const EGLsizeiANDROID keySize = static_cast<EGLsizeiANDROID>(key.size());
+                // Keep entries the app compiled itself.
+                if (getLocalBlobLocked(key.data(), keySize, nullptr, 0) == 0) {
+                    setLocalBlobLocked(key.data(), keySize, value.data(),
+                                       static_cast<EGLsizeiANDROID>(value.size()));
+                }
+            }
+            after = entries.back().first;
+        }
+    });
+    prefetchThread.detach();
+}
+
 }; // namespace android
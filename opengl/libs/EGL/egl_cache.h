@@ -100,6 +100,17 @@ private:
     // Get or create the multifile blobcache
     MultifileBlobCache* getMultifileBlobCacheLocked();
 
+    // Retrieve an entry from the local cache, returning its size or 0 if there is none.
+    EGLsizeiANDROID getLocalBlobLocked(const void* key, EGLsizeiANDROID keySize, void* value,
+                                       EGLsizeiANDROID valueSize);
+
+    // Insert an entry into the local cache, scheduling a deferred save if needed.
+    void setLocalBlobLocked(const void* key, EGLsizeiANDROID keySize, const void* value,
+                            EGLsizeiANDROID valueSize);
+
+    // Copy the entries shared through GpuService into the local cache on a background thread.
+    void startSharedPrefetchLocked();
+
     // mInitialized indicates whether the egl_cache_t is in the initialized
     // state.  It is initialized to false at construction time, and gets set to
     // true when initialize is called.  It is set back to false when terminate
@@ -142,6 +153,17 @@ private:
 
     // Cache limit
     size_t mCacheByteLimit;
+
+    // Whether entries are also shared with other apps through GpuService, see
+    // ro.egl.blobcache.shared. Only apps using the system driver take part.
+    bool mSharedMode;
+
+    // Whether this process may submit shared entries. GpuService drops entries from any other
+    // process, so they aren't sent at all.
+    bool mSharedProducer;
+
+    // Whether the shared entries were already copied into the local cache.
+    bool mSharedPrefetchStarted;
 };
 
 }; // namespace android
@@ -76,11 +76,14 @@ int egl_get_init_count(EGLDisplay dpy) {
 
 std::map<EGLDisplay, std::unique_ptr<egl_display_t>> egl_display_t::displayMap;
 std::mutex egl_display_t::displayMapLock;
+egl_display_t::DisplayCacheEntry egl_display_t::sDisplayCache[kDisplayCacheCapacity];
+std::atomic_size_t egl_display_t::sDisplayCacheSize = 0;
 
 egl_display_t::egl_display_t()
       : magic('_dpy'),
         finishOnSwap(false),
         traceGpuCompletion(false),
+        traceSwapStats(false),
         refs(0),
         eglIsInitialized(false) {}
 
@@ -94,6 +97,14 @@ egl_display_t* egl_display_t::get(EGLDisplay dpy) {
         return nullptr;
     }
 
+    const size_t cacheSize = sDisplayCacheSize.load(std::memory_order_acquire);
+    for (size_t i = 0; i < cacheSize; i++) {
+        if (sDisplayCache[i].dpy == dpy) {
+            egl_display_t* const display = sDisplayCache[i].display;
+            return display->isValid() ? display : nullptr;
+        }
+    }
+
     const std::lock_guard<std::mutex> lock(displayMapLock);
     auto search = displayMap.find(dpy);
     if (search == displayMap.end() || !search->second->isValid()) {
@@ -103,17 +114,17 @@ egl_display_t* egl_display_t::get(EGLDisplay dpy) {
 }
 
 void egl_display_t::addObject(egl_object_t* object) {
-    std::lock_guard<std::mutex> _l(lock);
+    std::unique_lock<std::shared_mutex> _l(objectsLock);
     objects.insert(object);
 }
 
 void egl_display_t::removeObject(egl_object_t* object) {
-    std::lock_guard<std::mutex> _l(lock);
+    std::unique_lock<std::shared_mutex> _l(objectsLock);
     objects.erase(object);
 }
 
 bool egl_display_t::getObject(egl_object_t* object) const {
-    std::lock_guard<std::mutex> _l(lock);
+    std::shared_lock<std::shared_mutex> _l(objectsLock);
     if (objects.find(object) != objects.end()) {
         if (object->getDisplay() == this) {
             object->incRef();
@@ -224,6 +235,13 @@ EGLDisplay egl_display_t::getPlatformDisplay(EGLNativeDisplayType display,
             if (displayMap.find(dpy) == displayMap.end()) {
                 auto d = std::make_unique<egl_display_t>();
                 d->disp.dpy = dpy;
+
+                const size_t cacheSize = sDisplayCacheSize.load(std::memory_order_relaxed);
+                if (cacheSize < kDisplayCacheCapacity) {
+                    sDisplayCache[cacheSize] = {dpy, d.get()};
+                    sDisplayCacheSize.store(cacheSize + 1, std::memory_order_release);
+                }
+
                 displayMap[dpy] = std::move(d);
             }
             return dpy;
@@ -386,6 +404,7 @@ EGLBoolean egl_display_t::initialize(EGLint* major, EGLint* minor) {
 
         finishOnSwap = base::GetBoolProperty("debug.egl.finish", false);
         traceGpuCompletion = base::GetBoolProperty("debug.egl.traceGpuCompletion", false);
+        traceSwapStats = base::GetBoolProperty("debug.egl.traceSwapStats", false);
 
         // TODO: If device doesn't provide 1.4 or 1.5 then we'll be
         // changing the behavior from the past where we always advertise
@@ -451,6 +470,7 @@ EGLBoolean egl_display_t::terminate() {
         // Mark all objects remaining in the list as terminated, unless
         // there are no reference to them, it which case, we're free to
         // delete them.
+        std::unique_lock<std::shared_mutex> _ol(objectsLock);
         size_t count = objects.size();
         ALOGW_IF(count, "eglTerminate() called w/ %zu objects remaining", count);
         for (auto o : objects) {
@@ -22,10 +22,12 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <atomic>
 #include <condition_variable>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <unordered_set>
 
@@ -44,6 +46,18 @@ bool needsAndroidPEglMitigation();
 class EGLAPI egl_display_t { // marked as EGLAPI for testing purposes
     static std::map<EGLDisplay, std::unique_ptr<egl_display_t>> displayMap;
     static std::mutex displayMapLock;
+
+    // Displays are never removed from displayMap, so the first few are also published here for
+    // get() to find without taking displayMapLock. Entries are written once under displayMapLock,
+    // before sDisplayCacheSize is incremented to publish them.
+    static constexpr size_t kDisplayCacheCapacity = 4;
+    struct DisplayCacheEntry {
+        EGLDisplay dpy;
+        egl_display_t* display;
+    };
+    static DisplayCacheEntry sDisplayCache[kDisplayCacheCapacity];
+    static std::atomic_size_t sDisplayCacheSize;
+
     EGLDisplay getDisplay(EGLNativeDisplayType display);
     static EGLDisplay getPlatformDisplay(EGLNativeDisplayType display,
                                          const EGLAttrib* attrib_list);
@@ -111,6 +125,7 @@ public:
     DisplayImpl disp;
     bool finishOnSwap;       // property: debug.egl.finish
     bool traceGpuCompletion; // property: debug.egl.traceGpuCompletion
+    bool traceSwapStats;     // property: debug.egl.traceSwapStats
     bool hasColorSpaceSupport;
 
 private:
@@ -119,6 +134,9 @@ private:
     mutable std::mutex lock;
     mutable std::mutex refLock;
     mutable std::condition_variable refCond;
+    // Guards objects. Validating a handle only reads the set, so concurrent EGL calls from
+    // different threads share the lock, and only object creation and destruction are exclusive.
+    mutable std::shared_mutex objectsLock;
     std::unordered_set<egl_object_t*> objects;
     std::string mVendorString;
     std::string mVersionString;
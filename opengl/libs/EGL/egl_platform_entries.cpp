@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <mutex>
@@ -1324,6 +1325,57 @@ private:
     std::mutex mMutex;
 };
 
+static EGLBoolean swapBuffersWithDamage(const egl_display_t* dp, egl_surface_t* s, EGLint* rects,
+                                        EGLint n_rects) {
+    if (n_rects == 0) {
+        return s->cnx->egl.eglSwapBuffers(dp->disp.dpy, s->surface);
+    }
+
+    std::vector<android_native_rect_t> androidRects((size_t)n_rects);
+    for (int r = 0; r < n_rects; ++r) {
+        int offset = r * 4;
+        int x = rects[offset];
+        int y = rects[offset + 1];
+        int width = rects[offset + 2];
+        int height = rects[offset + 3];
+        android_native_rect_t androidRect;
+        androidRect.left = x;
+        androidRect.top = y + height;
+        androidRect.right = x + width;
+        androidRect.bottom = y;
+        androidRects.push_back(androidRect);
+    }
+    if (!s->cnx->angleLoaded) {
+        native_window_set_surface_damage(s->getNativeWindow(), androidRects.data(),
+                                         androidRects.size());
+    }
+
+    if (s->cnx->egl.eglSwapBuffersWithDamageKHR) {
+        return s->cnx->egl.eglSwapBuffersWithDamageKHR(dp->disp.dpy, s->surface, rects, n_rects);
+    }
+
+    return s->cnx->egl.eglSwapBuffers(dp->disp.dpy, s->surface);
+}
+
+// Emits counters for how long a swap blocked the calling thread, and how much of that was spent
+// dequeueing and queueing buffers, so that stalls can be told apart from driver work in a trace.
+static void traceSwapStats(egl_surface_t* s, std::chrono::nanoseconds swapDuration) {
+    ATRACE_INT64("EGL swap duration", swapDuration.count());
+
+    ANativeWindow* const window = s->getNativeWindow();
+    if (!window || s->cnx->angleLoaded) {
+        return;
+    }
+
+    int64_t duration = 0;
+    if (window->perform(window, NATIVE_WINDOW_GET_LAST_DEQUEUE_DURATION, &duration) == 0) {
+        ATRACE_INT64("EGL dequeue duration", duration);
+    }
+    if (window->perform(window, NATIVE_WINDOW_GET_LAST_QUEUE_DURATION, &duration) == 0) {
+        ATRACE_INT64("EGL queue duration", duration);
+    }
+}
+
 EGLBoolean eglSwapBuffersWithDamageKHRImpl(EGLDisplay dpy, EGLSurface draw, EGLint* rects,
                                            EGLint n_rects) {
     const egl_display_t* dp = validate_display(dpy);
@@ -1361,34 +1413,14 @@ EGLBoolean eglSwapBuffersWithDamageKHRImpl(EGLDisplay dpy, EGLSurface draw, EGLi
         }
     }
 
-    if (n_rects == 0) {
-        return s->cnx->egl.eglSwapBuffers(dp->disp.dpy, s->surface);
-    }
-
-    std::vector<android_native_rect_t> androidRects((size_t)n_rects);
-    for (int r = 0; r < n_rects; ++r) {
-        int offset = r * 4;
-        int x = rects[offset];
-        int y = rects[offset + 1];
-        int width = rects[offset + 2];
-        int height = rects[offset + 3];
-        android_native_rect_t androidRect;
-        androidRect.left = x;
-        androidRect.top = y + height;
-        androidRect.right = x + width;
-        androidRect.bottom = y;
-        androidRects.push_back(androidRect);
-    }
-    if (!s->cnx->angleLoaded) {
-        native_window_set_surface_damage(s->getNativeWindow(), androidRects.data(),
-                                         androidRects.size());
-    }
-
-    if (s->cnx->egl.eglSwapBuffersWithDamageKHR) {
-        return s->cnx->egl.eglSwapBuffersWithDamageKHR(dp->disp.dpy, s->surface, rects, n_rects);
+    if (CC_UNLIKELY(dp->traceSwapStats)) {
+        const auto start = std::chrono::steady_clock::now();
+        const EGLBoolean result = swapBuffersWithDamage(dp, s, rects, n_rects);
+        traceSwapStats(s, std::chrono::steady_clock::now() - start);
+        return result;
     }
 
-    return s->cnx->egl.eglSwapBuffers(dp->disp.dpy, s->surface);
+    return swapBuffersWithDamage(dp, s, rects, n_rects);
 }
 
 EGLBoolean eglSwapBuffersImpl(EGLDisplay dpy, EGLSurface surface) {
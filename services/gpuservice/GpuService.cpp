@@ -29,6 +29,7 @@
 #include <gpuwork/GpuWork.h>
 #include <gpustats/GpuStats.h>
 #include <private/android_filesystem_config.h>
+#include <shadercache/SharedShaderCache.h>
 #include <tracing/GpuMemTracer.h>
 #include <utils/String8.h>
 #include <utils/Trace.h>
@@ -57,7 +58,8 @@ GpuService::GpuService()
       : mGpuMem(std::make_shared<GpuMem>()),
         mGpuWork(std::make_shared<gpuwork::GpuWork>()),
         mGpuStats(std::make_unique<GpuStats>()),
-        mGpuMemTracer(std::make_unique<GpuMemTracer>()) {
+        mGpuMemTracer(std::make_unique<GpuMemTracer>()),
+        mSharedShaderCache(std::make_unique<SharedShaderCache>()) {
 
     mGpuMemAsyncInitThread = std::make_unique<std::thread>([this] (){
         mGpuMem->initialize();
@@ -139,6 +141,43 @@ std::string GpuService::getUpdatableDriverPath() {
     return mDeveloperDriverPath;
 }
 
+void GpuService::setSharedShaderCacheEntry(const std::vector<uint8_t>& key,
+                                           const std::vector<uint8_t>& value) {
+    IPCThreadState* ipc = IPCThreadState::self();
+    const int pid = ipc->getCallingPid();
+    const int uid = ipc->getCallingUid();
+
+    // Shared entries are loaded into every app's driver, so only system processes and holders of
+    // the ACCESS_GPU_SERVICE permission may add them.
+    if (uid != AID_SYSTEM && uid != AID_GRAPHICS &&
+        !PermissionCache::checkPermission(sAccessGpuServicePermission, pid, uid)) {
+        ALOGV("Dropping shared shader cache entry from untrusted pid=%d, uid=%d", pid, uid);
+        return;
+    }
+
+    mSharedShaderCache->set(key, value);
+}
+
+std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>>
+GpuService::getSharedShaderCacheEntries(const std::vector<uint8_t>& after) {
+    // Keep replies well below the binder buffer size, clients page through the rest.
+    static constexpr size_t kMaxReplyBytes = 256 * 1024;
+    return mSharedShaderCache->getEntriesAfter(after, kMaxReplyBytes);
+}
+
+uint64_t GpuService::getProcessGpuMemTotal(int32_t pid) {
+    const int uid = IPCThreadState::self()->getCallingUid();
+
+    // Memory usage of other processes is only for the system and the low memory killer.
+    if (uid != AID_ROOT && uid != AID_SYSTEM && uid != AID_LMKD) {
+        ALOGE("Permission Denial: can't get the GPU memory of pid=%d from uid=%d\n", pid, uid);
+        return 0;
+    }
+
+    if (pid <= 0) return 0;
+    return mGpuMem->getProcessGpuMemTotal(static_cast<uint32_t>(pid));
+}
+
 status_t GpuService::shellCommand(int /*in*/, int out, int err, std::vector<String16>& args) {
     ATRACE_CALL();
 
@@ -170,6 +209,7 @@ status_t GpuService::doDump(int fd, const Vector<String16>& args, bool /*asProto
         bool dumpMem = false;
         bool dumpStats = false;
         bool dumpWork = false;
+        bool dumpShaderCache = false;
         size_t numArgs = args.size();
 
         if (numArgs) {
@@ -182,9 +222,11 @@ status_t GpuService::doDump(int fd, const Vector<String16>& args, bool /*asProto
                     dumpMem = true;
                 } else if (args[index] == String16("--gpuwork")) {
                     dumpWork = true;
+                } else if (args[index] == String16("--shadercache")) {
+                    dumpShaderCache = true;
                 }
             }
-            dumpAll = !(dumpDriverInfo || dumpMem || dumpStats || dumpWork);
+            dumpAll = !(dumpDriverInfo || dumpMem || dumpStats || dumpWork || dumpShaderCache);
         }
 
         if (dumpAll || dumpDriverInfo) {
@@ -203,6 +245,10 @@ status_t GpuService::doDump(int fd, const Vector<String16>& args, bool /*asProto
             mGpuWork->dump(args, &result);
             result.append("\n");
         }
+        if (dumpAll || dumpShaderCache) {
+            mSharedShaderCache->dump(&result);
+            result.append("\n");
+        }
     }
 
     write(fd, result.c_str(), result.size());
@@ -28,6 +28,7 @@
 #include <utils/Timers.h>
 #include <utils/Trace.h>
 
+#include <set>
 #include <unordered_map>
 #include <vector>
 
@@ -154,4 +155,26 @@ void GpuMem::traverseGpuMemTotals(const std::function<void(int64_t ts, uint32_t
     }
 }
 
+uint64_t GpuMem::getProcessGpuMemTotal(uint32_t pid) {
+    ATRACE_CALL();
+
+    if (!mInitialized.load() || !mGpuMemTotalMap.isValid()) return 0;
+
+    std::lock_guard<std::mutex> lock(mGpuIdsLock);
+    if (mGpuIds.empty()) {
+        std::set<uint32_t> gpuIds;
+        traverseGpuMemTotals([&gpuIds](int64_t, uint32_t gpuId, uint32_t, uint64_t) {
+            gpuIds.insert(gpuId);
+        });
+        mGpuIds.assign(gpuIds.begin(), gpuIds.end());
+    }
+
+    uint64_t total = 0;
+    for (uint32_t gpuId : mGpuIds) {
+        auto res = mGpuMemTotalMap.readValue(((uint64_t)gpuId << 32) | pid);
+        if (res.ok()) total += res.value();
+    }
+    return total;
+}
+
 } // namespace android
@@ -21,6 +21,8 @@
 #include <utils/Vector.h>
 
 #include <functional>
+#include <mutex>
+#include <vector>
 
 namespace android {
 
@@ -39,6 +41,10 @@ public:
     void traverseGpuMemTotals(const std::function<void(int64_t ts, uint32_t gpuId, uint32_t pid,
                                                        uint64_t size)>& callback);
 
+    // Returns the GPU memory total in bytes of a process, summed over all GPUs. Looks up one
+    // map entry per GPU rather than traversing the whole map.
+    uint64_t getProcessGpuMemTotal(uint32_t pid);
+
 private:
     // Friend class for testing.
     friend class TestableGpuMem;
@@ -50,6 +56,10 @@ private:
     std::atomic<bool> mInitialized = false;
     // bpf map for GPU memory total data
     android::bpf::BpfMap<uint64_t, uint64_t> mGpuMemTotalMap;
+    // GPU ids found in the map, for per-process lookups. GPU ids are fixed once the drivers
+    // have loaded, so they are only collected again while none have been found.
+    std::mutex mGpuIdsLock;
+    std::vector<uint32_t> mGpuIds;
 
     // gpu memory tracepoint event category
     static constexpr char kGpuMemTraceGroup[] = "gpu_mem";
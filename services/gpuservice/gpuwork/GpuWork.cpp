@@ -204,23 +204,36 @@ void GpuWork::dump(const Vector<String16>& /* args */, std::string* result) {
     // E.g.
     // GPU work information.
     // gpu_id uid total_active_duration_ns total_inactive_duration_ns
-    // 0 1000 0 0
-    // 0 1003 1234 123
-    // [errors:3]0 1006 4567 456
+    // active_duration_histogram
+    // 0 1000 0 0 0,0,0,0,0,0,0,0,0,0
+    // 0 1003 1234 123 2,0,0,0,0,0,0,0,0,0
+    // [errors:3]0 1006 4567 456 5,1,0,0,0,0,0,0,0,0
 
     // Header.
     result->append("GPU work information.\ngpu_id uid total_active_duration_ns "
-                   "total_inactive_duration_ns\n");
+                   "total_inactive_duration_ns active_duration_histogram\n");
 
     for (const auto& idToUidInfo : dumpMap) {
         if (idToUidInfo.second.error_count) {
             StringAppendF(result, "[errors:%" PRIu32 "]", idToUidInfo.second.error_count);
         }
-        StringAppendF(result, "%" PRIu32 " %" PRIu32 " %" PRIu64 " %" PRIu64 "\n",
+        StringAppendF(result, "%" PRIu32 " %" PRIu32 " %" PRIu64 " %" PRIu64 " ",
                       idToUidInfo.first.gpu_id, idToUidInfo.first.uid,
                       idToUidInfo.second.total_active_duration_ns,
                       idToUidInfo.second.total_inactive_duration_ns);
+        for (size_t i = 0; i < kNumActiveDurationBuckets; ++i) {
+            StringAppendF(result, i == 0 ? "%" PRIu32 : ",%" PRIu32,
+                          idToUidInfo.second.active_duration_histogram[i]);
+        }
+        result->append("\n");
+    }
+
+    // Histogram bucket boundaries, so the output above can be interpreted.
+    result->append("active_duration_histogram buckets (ms): <1");
+    for (size_t i = 1; i < kNumActiveDurationBuckets - 1; ++i) {
+        StringAppendF(result, ",[%d-%d)", 1 << (i - 1), 1 << i);
     }
+    StringAppendF(result, ",>=%d\n", 1 << (kNumActiveDurationBuckets - 2));
 }
 
 bool GpuWork::attachTracepoint(const char* programPath, const char* tracepointGroup,
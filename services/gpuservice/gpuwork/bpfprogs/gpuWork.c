@@ -27,6 +27,7 @@
 #endif
 
 #define S_IN_NS (1000000000)
+#define MS_IN_NS (1000000)
 #define SMALL_TIME_GAP_LIMIT_NS (S_IN_NS)
 
 // A map from GpuIdUid (GPU ID and application UID) to |UidTrackingInfo|.
@@ -178,6 +179,20 @@ _Static_assert(offsetof(GpuWorkPeriodEvent, gpu_id) == 8 &&
                "must match the tracepoint field offsets found via adb shell cat "
                "/sys/kernel/tracing/events/power/gpu_work_period/format");
 
+// Returns the |UidTrackingInfo.active_duration_histogram| bucket for a period
+// with |active_duration_ns| of GPU work.
+static inline uint32_t active_duration_bucket(const uint64_t active_duration_ns) {
+    const uint64_t active_duration_ms = active_duration_ns / MS_IN_NS;
+    uint32_t bucket = 0;
+#pragma unroll
+    for (uint32_t i = 1; i < kNumActiveDurationBuckets; ++i) {
+        if (active_duration_ms >= (1ULL << (i - 1))) {
+            bucket = i;
+        }
+    }
+    return bucket;
+}
+
 DEFINE_BPF_PROG("tracepoint/power/gpu_work_period", AID_ROOT, AID_GRAPHICS, tp_gpu_work_period)
 (GpuWorkPeriodEvent* const period) {
     // Note: In eBPF programs, |__sync_fetch_and_add| is translated to an atomic
@@ -236,6 +251,11 @@ DEFINE_BPF_PROG("tracepoint/power/gpu_work_period", AID_ROOT, AID_GRAPHICS, tp_g
     __sync_fetch_and_add(&uid_tracking_info->total_active_duration_ns,
                          period->total_active_duration_ns);
 
+    // Update |uid_tracking_info->active_duration_histogram|.
+    __sync_fetch_and_add(&uid_tracking_info->active_duration_histogram[active_duration_bucket(
+                                 period->total_active_duration_ns)],
+                         1);
+
     // |small_gap_time_ns| is the time gap between the current and previous
     // active period, which could be 0. If the gap is more than
     // |SMALL_TIME_GAP_LIMIT_NS| then |small_gap_time_ns| will be set to 0
@@ -25,6 +25,12 @@ namespace android {
 namespace gpuwork {
 #endif
 
+// The number of buckets in |UidTrackingInfo.active_duration_histogram|.
+// Bucket 0 counts periods with less than 1 ms of active time. Bucket i, for
+// 0 < i < kNumActiveDurationBuckets - 1, counts periods with an active time in
+// [2^(i-1) ms, 2^i ms). The last bucket counts all longer periods (>= 256 ms).
+enum { kNumActiveDurationBuckets = 10 };
+
 typedef struct  {
     uint32_t gpu_id;
     uint32_t uid;
@@ -49,6 +55,12 @@ typedef struct {
     // negative duration.
     uint32_t error_count;
 
+    // A histogram of the active time of each |GpuWorkPeriodEvent| period for
+    // the UID. See |kNumActiveDurationBuckets| for the bucket boundaries. Long,
+    // dense periods of GPU work are what typically push the GPU to higher
+    // frequencies, so this shows which UIDs are responsible for them.
+    uint32_t active_duration_histogram[kNumActiveDurationBuckets];
+
     // Needed to make 32-bit arch struct size match 64-bit BPF arch struct size.
     uint32_t padding0;
 } UidTrackingInfo;
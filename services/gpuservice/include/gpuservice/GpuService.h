@@ -36,6 +36,7 @@ class GpuWork;
 class GpuMem;
 class GpuStats;
 class GpuMemTracer;
+class SharedShaderCache;
 
 class GpuService : public BnGpuService, public PriorityDumper {
 public:
@@ -64,6 +65,11 @@ private:
     void setUpdatableDriverPath(const std::string& driverPath) override;
     std::string getUpdatableDriverPath() override;
     void toggleAngleAsSystemDriver(bool enabled) override;
+    void setSharedShaderCacheEntry(const std::vector<uint8_t>& key,
+                                   const std::vector<uint8_t>& value) override;
+    std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>> getSharedShaderCacheEntries(
+            const std::vector<uint8_t>& after) override;
+    uint64_t getProcessGpuMemTotal(int32_t pid) override;
 
     /*
      * IBinder interface
@@ -90,6 +96,7 @@ private:
     std::shared_ptr<gpuwork::GpuWork> mGpuWork;
     std::unique_ptr<GpuStats> mGpuStats;
     std::unique_ptr<GpuMemTracer> mGpuMemTracer;
+    std::unique_ptr<SharedShaderCache> mSharedShaderCache;
     std::mutex mLock;
     std::string mDeveloperDriverPath;
     std::unique_ptr<std::thread> mGpuMemAsyncInitThread;
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#undef LOG_TAG
+#define LOG_TAG "SharedShaderCache"
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+
+#include "shadercache/SharedShaderCache.h"
+
+#include <android-base/stringprintf.h>
+#include <log/log.h>
+#include <utils/Trace.h>
+
+namespace android {
+
+using base::StringAppendF;
+
+SharedShaderCache::SharedShaderCache(size_t maxKeySize, size_t maxValueSize, size_t maxTotalSize)
+      : mMaxKeySize(maxKeySize), mMaxValueSize(maxValueSize), mMaxTotalSize(maxTotalSize) {}
+
+void SharedShaderCache::set(const Blob& key, const Blob& value) {
+    ATRACE_CALL();
+
+    if (key.empty() || value.empty() || key.size() > mMaxKeySize || value.size() > mMaxValueSize) {
+        ALOGV("set: ignoring entry with key size %zu and value size %zu", key.size(),
+              value.size());
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    const auto entry = mEntries.find(key);
+    if (entry != mEntries.end()) {
+        mTotalSize -= key.size() + entry->second.size();
+        mEntries.erase(entry);
+    }
+
+    const size_t entrySize = key.size() + value.size();
+    while (mTotalSize + entrySize > mMaxTotalSize && !mEntries.empty()) {
+        const auto& [evictedKey, evictedValue] = *mEntries.begin();
+        mTotalSize -= evictedKey.size() + evictedValue.size();
+        mEntries.erase(mEntries.begin());
+    }
+    if (mTotalSize + entrySize > mMaxTotalSize) {
+        ALOGW("Not enough room for a shared shader cache entry of %zu bytes", entrySize);
+        return;
+    }
+
+    mEntries.emplace(key, value);
+    mTotalSize += entrySize;
+}
+
+std::vector<SharedShaderCache::Entry> SharedShaderCache::getEntriesAfter(const Blob& after,
+                                                                         size_t maxBytes) {
+    ATRACE_CALL();
+
+    std::vector<Entry> result;
+    size_t resultBytes = 0;
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto entry = mEntries.upper_bound(after); entry != mEntries.end(); entry++) {
+        const size_t entrySize = entry->first.size() + entry->second.size();
+        if (!result.empty() && resultBytes + entrySize > maxBytes) {
+            break;
+        }
+        result.emplace_back(*entry);
+        resultBytes += entrySize;
+    }
+    mEntriesServed += result.size();
+    return result;
+}
+
+void SharedShaderCache::dump(std::string* result) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    result->append("Shared shader cache:\n");
+    StringAppendF(result, "totalSize = %zu bytes (limit %zu)\n", mTotalSize, mMaxTotalSize);
+    StringAppendF(result, "entries = %zu, served = %zu\n", mEntries.size(), mEntriesServed);
+}
+
+} // namespace android
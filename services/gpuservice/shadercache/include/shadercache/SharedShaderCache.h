@@ -0,0 +1,71 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <android-base/thread_annotations.h>
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace android {
+
+// A shader cache shared by all apps using the system driver, so that a driver compiling identical
+// shaders for different apps (e.g. from a shared UI toolkit) only needs to compile them once.
+//
+// Entries are keyed by the blob cache key from the driver. GpuService only accepts entries from
+// trusted producers, and clients prefetch the entries once instead of looking up each key.
+// Entries are kept in memory only, so they never outlive the driver build that produced them.
+class SharedShaderCache {
+public:
+    using Blob = std::vector<uint8_t>;
+    using Entry = std::pair<Blob, Blob>;
+
+    SharedShaderCache(size_t maxKeySize = kDefaultMaxKeySize,
+                      size_t maxValueSize = kDefaultMaxValueSize,
+                      size_t maxTotalSize = kDefaultMaxTotalSize);
+
+    // Adds the value that a trusted producer's driver produced for key.
+    void set(const Blob& key, const Blob& value);
+
+    // Returns the entries whose key sorts after |after|, in key order. Stops before exceeding
+    // maxBytes, but always returns at least one entry if there is one.
+    std::vector<Entry> getEntriesAfter(const Blob& after, size_t maxBytes);
+
+    // dumpsys interface
+    void dump(std::string* result);
+
+    static constexpr size_t kDefaultMaxKeySize = 12 * 1024;
+    static constexpr size_t kDefaultMaxValueSize = 64 * 1024;
+    static constexpr size_t kDefaultMaxTotalSize = 2 * 1024 * 1024;
+
+private:
+    const size_t mMaxKeySize;
+    const size_t mMaxValueSize;
+    const size_t mMaxTotalSize;
+
+    std::mutex mMutex;
+    std::map<Blob, Blob> mEntries GUARDED_BY(mMutex);
+    // The combined size of the keys and values of all entries.
+    size_t mTotalSize GUARDED_BY(mMutex) = 0;
+    size_t mEntriesServed GUARDED_BY(mMutex) = 0;
+};
+
+} // namespace android
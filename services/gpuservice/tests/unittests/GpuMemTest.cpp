@@ -168,5 +168,19 @@ TEST_F(GpuMemTest, traverseGpuMemTotals) {
     EXPECT_EQ(sCount, TEST_KEY_COUNT);
 }
 
+TEST_F(GpuMemTest, processGpuMemTotal) {
+    constexpr uint64_t TEST_PROC_KEY_3 = 4294967297; // (1 << 32) + 1
+    constexpr uint64_t TEST_PROC_VAL_3 = 456;
+    ASSERT_RESULT_OK(mTestMap.writeValue(TEST_GLOBAL_KEY, TEST_GLOBAL_VAL, BPF_ANY));
+    ASSERT_RESULT_OK(mTestMap.writeValue(TEST_PROC_KEY_1, TEST_PROC_VAL_1, BPF_ANY));
+    ASSERT_RESULT_OK(mTestMap.writeValue(TEST_PROC_KEY_2, TEST_PROC_VAL_2, BPF_ANY));
+    ASSERT_RESULT_OK(mTestMap.writeValue(TEST_PROC_KEY_3, TEST_PROC_VAL_3, BPF_ANY));
+    mTestableGpuMem.setGpuMemTotalMap(mTestMap);
+
+    EXPECT_EQ(mGpuMem->getProcessGpuMemTotal(1), TEST_PROC_VAL_1 + TEST_PROC_VAL_3);
+    EXPECT_EQ(mGpuMem->getProcessGpuMemTotal(2), TEST_PROC_VAL_2);
+    EXPECT_EQ(mGpuMem->getProcessGpuMemTotal(3), 0u);
+}
+
 } // namespace
 } // namespace android
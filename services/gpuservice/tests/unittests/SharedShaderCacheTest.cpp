@@ -0,0 +1,100 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "gpuservice_unittest"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <shadercache/SharedShaderCache.h>
+
+namespace android {
+namespace {
+
+using testing::HasSubstr;
+using Blob = SharedShaderCache::Blob;
+
+using Entry = SharedShaderCache::Entry;
+
+const Blob kKey = {'k', 'e', 'y'};
+const Blob kOtherKey = {'o', 't', 'h', 'e', 'r'};
+const Blob kValue = {'v', 'a', 'l', 'u', 'e'};
+const Blob kOtherValue = {'o', 't', 'h', 'e', 'r'};
+
+class SharedShaderCacheTest : public testing::Test {
+protected:
+    SharedShaderCache mCache;
+};
+
+TEST_F(SharedShaderCacheTest, emptyCacheHasNoEntries) {
+    EXPECT_TRUE(mCache.getEntriesAfter({}, SIZE_MAX).empty());
+}
+
+TEST_F(SharedShaderCacheTest, entriesAreReturnedInKeyOrder) {
+    mCache.set(kOtherKey, kOtherValue);
+    mCache.set(kKey, kValue);
+    EXPECT_EQ((std::vector<Entry>{{kKey, kValue}, {kOtherKey, kOtherValue}}),
+              mCache.getEntriesAfter({}, SIZE_MAX));
+}
+
+TEST_F(SharedShaderCacheTest, setReplacesValue) {
+    mCache.set(kKey, kValue);
+    mCache.set(kKey, kOtherValue);
+    EXPECT_EQ((std::vector<Entry>{{kKey, kOtherValue}}), mCache.getEntriesAfter({}, SIZE_MAX));
+}
+
+TEST_F(SharedShaderCacheTest, entriesArePagedByKey) {
+    mCache.set(kKey, kValue);
+    mCache.set(kOtherKey, kOtherValue);
+
+    // A page always holds at least one entry, even if it exceeds maxBytes.
+    const auto firstPage = mCache.getEntriesAfter({}, 1);
+    ASSERT_EQ(1u, firstPage.size());
+    EXPECT_EQ(kKey, firstPage[0].first);
+
+    const auto secondPage = mCache.getEntriesAfter(firstPage.back().first, 1);
+    ASSERT_EQ(1u, secondPage.size());
+    EXPECT_EQ(kOtherKey, secondPage[0].first);
+
+    EXPECT_TRUE(mCache.getEntriesAfter(secondPage.back().first, 1).empty());
+}
+
+TEST_F(SharedShaderCacheTest, oversizedEntriesAreIgnored) {
+    SharedShaderCache cache(/*maxKeySize*/ 2, /*maxValueSize*/ 16, /*maxTotalSize*/ 64);
+    cache.set(kKey, kValue);
+    EXPECT_TRUE(cache.getEntriesAfter({}, SIZE_MAX).empty());
+}
+
+TEST_F(SharedShaderCacheTest, fullCacheEvictsEntries) {
+    SharedShaderCache cache(/*maxKeySize*/ 8, /*maxValueSize*/ 8,
+                            /*maxTotalSize*/ kKey.size() + kValue.size());
+    const Blob newKey = {'n', 'e', 'w'};
+    cache.set(kKey, kValue);
+    cache.set(newKey, kValue);
+    EXPECT_EQ((std::vector<Entry>{{newKey, kValue}}), cache.getEntriesAfter({}, SIZE_MAX));
+}
+
+TEST_F(SharedShaderCacheTest, dumpReportsEntries) {
+    mCache.set(kKey, kValue);
+    mCache.getEntriesAfter({}, SIZE_MAX);
+
+    std::string result;
+    mCache.dump(&result);
+    EXPECT_THAT(result, HasSubstr("entries = 1, served = 1"));
+}
+
+} // namespace
+} // namespace android
@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include <algorithm>
 #include <condition_variable>
+#include <functional>
 #include <list>
 #include <mutex>
 #include <optional>
@@ -87,6 +89,29 @@ public:
         return true;
     };
 
+    /**
+     * Add a new object to the queue. If the queue is full, make room by removing the oldest
+     * object that matches the given predicate.
+     * Does not block.
+     * Return true if an element was successfully added.
+     * Return false if the queue is full and no element matches the predicate.
+     */
+    bool pushEvictingOldest(T&& t, const std::function<bool(const T&)>& canEvict) {
+        { // acquire lock
+            std::scoped_lock lock(mLock);
+            if (mCapacity && mQueue.size() == mCapacity) {
+                auto it = std::find_if(mQueue.begin(), mQueue.end(), canEvict);
+                if (it == mQueue.end()) {
+                    return false;
+                }
+                mQueue.erase(it);
+            }
+            mQueue.push_back(std::move(t));
+        } // release lock
+        mHasElements.notify_one();
+        return true;
+    };
+
     /**
      * Construct a new object into the queue.
      * Does not block.
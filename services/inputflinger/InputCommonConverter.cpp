@@ -269,8 +269,7 @@ static common::VideoFrame getHalVideoFrame(const TouchVideoFrame& frame) {
     common::VideoFrame out;
     out.width = frame.getWidth();
     out.height = frame.getHeight();
-    std::vector<char16_t> unsignedData(frame.getData().begin(), frame.getData().end());
-    out.data = unsignedData;
+    out.data.assign(frame.getData().begin(), frame.getData().end());
     struct timeval timestamp = frame.getTimestamp();
     out.timestamp = seconds_to_nanoseconds(timestamp.tv_sec) +
             microseconds_to_nanoseconds(timestamp.tv_usec);
@@ -280,6 +279,7 @@ static common::VideoFrame getHalVideoFrame(const TouchVideoFrame& frame) {
 static std::vector<common::VideoFrame> convertVideoFrames(
         const std::vector<TouchVideoFrame>& frames) {
     std::vector<common::VideoFrame> out;
+    out.reserve(frames.size());
     for (const TouchVideoFrame& frame : frames) {
         out.push_back(getHalVideoFrame(frame));
     }
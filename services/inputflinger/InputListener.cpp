@@ -91,6 +91,11 @@ void QueuedInputListener::notifyMotion(const NotifyMotionArgs& args) {
     mArgsQueue.emplace_back(args);
 }
 
+void QueuedInputListener::notifyMotion(NotifyMotionArgs&& args) {
+    traceEvent(__func__, args.id);
+    mArgsQueue.emplace_back(std::move(args));
+}
+
 void QueuedInputListener::notifySwitch(const NotifySwitchArgs& args) {
     traceEvent(__func__, args.id);
     mArgsQueue.emplace_back(args);
@@ -247,9 +247,18 @@ void MotionClassifier::processEvents() {
 }
 
 void MotionClassifier::enqueueEvent(ClassifierEvent&& event) {
-    bool eventAdded = mEvents.push(std::move(event));
+    // When the HAL falls behind, skipping an intermediate MOVE sample is harmless to the gesture
+    // it is tracking, so drop the oldest one rather than resetting the HAL.
+    const auto isMove = [](const ClassifierEvent& queued) {
+        if (queued.type != ClassifierEventType::MOTION) {
+            return false;
+        }
+        const NotifyMotionArgs& motionArgs = std::get<NotifyMotionArgs>(*queued.args);
+        return (motionArgs.action & AMOTION_EVENT_ACTION_MASK) == AMOTION_EVENT_ACTION_MOVE;
+    };
+    const bool eventAdded = mEvents.pushEvictingOldest(std::move(event), isMove);
     if (!eventAdded) {
-        // If the queue is full, suspect the HAL is slow in processing the events.
+        // If the queue is full of events that can't be skipped, suspect the HAL is stuck.
         ALOGE("Could not add the event to the queue. Resetting");
         reset();
     }
@@ -447,7 +456,7 @@ void InputProcessor::notifyMotion(const NotifyMotionArgs& args) {
                                 motionClassificationToString(newClassification),
                                 motionClassificationToString(args.classification));
             newArgs.classification = newClassification;
-            mQueuedListener.notifyMotion(newArgs);
+            mQueuedListener.notifyMotion(std::move(newArgs));
         }
     } // release lock
     mQueuedListener.flush();
@@ -23,6 +23,7 @@
 #include <android-base/stringprintf.h>
 #include <android/log.h>
 #include <math.h>
+#include <utility>
 #include <utils/Trace.h>
 
 using android::base::StringPrintf;
@@ -69,7 +70,7 @@ NotifyMotionArgs::NotifyMotionArgs(
         int32_t edgeFlags, uint32_t pointerCount, const PointerProperties* pointerProperties,
         const PointerCoords* pointerCoords, float xPrecision, float yPrecision,
         float xCursorPosition, float yCursorPosition, nsecs_t downTime,
-        const std::vector<TouchVideoFrame>& videoFrames)
+        std::vector<TouchVideoFrame> videoFrames)
       : id(id),
         eventTime(eventTime),
         deviceId(deviceId),
@@ -89,7 +90,7 @@ NotifyMotionArgs::NotifyMotionArgs(
         yCursorPosition(yCursorPosition),
         downTime(downTime),
         readTime(readTime),
-        videoFrames(videoFrames) {
+        videoFrames(std::move(videoFrames)) {
     for (uint32_t i = 0; i < pointerCount; i++) {
         this->pointerProperties.push_back(pointerProperties[i]);
         this->pointerCoords.push_back(pointerCoords[i]);
@@ -344,10 +344,11 @@ void UnwantedInteractionBlocker::notifyMotion(const NotifyMotionArgs& args) {
     ALOGD_IF(DEBUG_INBOUND_MOTION, "%s: %s", __func__, args.dump().c_str());
     { // acquire lock
         std::scoped_lock lock(mLock);
-        const std::vector<NotifyMotionArgs> processedArgs =
+        // The blockers return their own args, which are moved along instead of being copied.
+        std::vector<NotifyMotionArgs> processedArgs =
                 mPreferStylusOverTouchBlocker.processMotion(args);
-        for (const NotifyMotionArgs& loopArgs : processedArgs) {
-            notifyMotionLocked(loopArgs);
+        for (NotifyMotionArgs& loopArgs : processedArgs) {
+            notifyMotionLocked(std::move(loopArgs));
         }
     } // release lock
 
@@ -355,22 +356,22 @@ void UnwantedInteractionBlocker::notifyMotion(const NotifyMotionArgs& args) {
     mQueuedListener.flush();
 }
 
-void UnwantedInteractionBlocker::enqueueOutboundMotionLocked(const NotifyMotionArgs& args) {
+void UnwantedInteractionBlocker::enqueueOutboundMotionLocked(NotifyMotionArgs&& args) {
     ALOGD_IF(DEBUG_OUTBOUND_MOTION, "%s: %s", __func__, args.dump().c_str());
-    mQueuedListener.notifyMotion(args);
+    mQueuedListener.notifyMotion(std::move(args));
 }
 
-void UnwantedInteractionBlocker::notifyMotionLocked(const NotifyMotionArgs& args) {
+void UnwantedInteractionBlocker::notifyMotionLocked(NotifyMotionArgs&& args) {
     auto it = mPalmRejectors.find(args.deviceId);
     const bool sendToPalmRejector = it != mPalmRejectors.end() && isFromTouchscreen(args.source);
     if (!sendToPalmRejector) {
-        enqueueOutboundMotionLocked(args);
+        enqueueOutboundMotionLocked(std::move(args));
         return;
     }
 
     std::vector<NotifyMotionArgs> processedArgs = it->second.processMotion(args);
-    for (const NotifyMotionArgs& loopArgs : processedArgs) {
-        enqueueOutboundMotionLocked(loopArgs);
+    for (NotifyMotionArgs& loopArgs : processedArgs) {
+        enqueueOutboundMotionLocked(std::move(loopArgs));
     }
 }
 
@@ -119,10 +119,10 @@ private:
     // Use a separate palm rejector for every touch device.
     std::map<int32_t /*deviceId*/, PalmRejector> mPalmRejectors GUARDED_BY(mLock);
     // TODO(b/210159205): delete this when simultaneous stylus and touch is supported
-    void notifyMotionLocked(const NotifyMotionArgs& args) REQUIRES(mLock);
+    void notifyMotionLocked(NotifyMotionArgs&& args) REQUIRES(mLock);
 
     // Call this function for outbound events so that they can be logged when logging is enabled.
-    void enqueueOutboundMotionLocked(const NotifyMotionArgs& args) REQUIRES(mLock);
+    void enqueueOutboundMotionLocked(NotifyMotionArgs&& args) REQUIRES(mLock);
 
     void onInputDevicesChanged(const std::vector<InputDeviceInfo>& inputDevices);
 };
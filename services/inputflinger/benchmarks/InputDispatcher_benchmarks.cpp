@@ -19,6 +19,8 @@
 #include <android/os/IInputConstants.h>
 #include <binder/Binder.h>
 #include <gui/constants.h>
+#include "../InputProcessor.h"
+#include "../UnwantedInteractionBlocker.h"
 #include "../dispatcher/InputDispatcher.h"
 
 using android::base::Result;
@@ -199,6 +201,8 @@ public:
         mInfo.displayId = ADISPLAY_ID_DEFAULT;
     }
 
+    void setDisplayId(int32_t displayId) { mInfo.displayId = displayId; }
+
 protected:
     Rect mFrame;
 };
@@ -293,6 +297,92 @@ static void benchmarkNotifyMotion(benchmark::State& state) {
     dispatcher.stop();
 }
 
+static void benchmarkNotifyMotionToMultipleConnections(benchmark::State& state) {
+    // Create dispatcher
+    FakeInputDispatcherPolicy fakePolicy;
+    InputDispatcher dispatcher(fakePolicy);
+    dispatcher.setInputDispatchMode(/*enabled*/ true, /*frozen*/ false);
+    dispatcher.start();
+
+    // Create a window on each display, so that every connection has a gesture in flight and the
+    // finished signals of one connection are processed while events are enqueued for the others.
+    const int32_t connectionCount = state.range(0);
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+    std::vector<sp<FakeWindowHandle>> windows;
+    std::unordered_map<int32_t, std::vector<sp<WindowInfoHandle>>> handlesPerDisplay;
+    for (int32_t displayId = 0; displayId < connectionCount; displayId++) {
+        sp<FakeWindowHandle> window =
+                sp<FakeWindowHandle>::make(application, dispatcher, "Fake Window");
+        window->setDisplayId(displayId);
+        windows.push_back(window);
+        handlesPerDisplay[displayId] = {window};
+    }
+    dispatcher.setInputWindows(handlesPerDisplay);
+
+    NotifyMotionArgs motionArgs = generateMotionArgs();
+
+    for (auto _ : state) {
+        for (int32_t displayId = 0; displayId < connectionCount; displayId++) {
+            // Send ACTION_DOWN
+            motionArgs.displayId = displayId;
+            motionArgs.action = AMOTION_EVENT_ACTION_DOWN;
+            motionArgs.downTime = now();
+            motionArgs.eventTime = motionArgs.downTime;
+            dispatcher.notifyMotion(motionArgs);
+
+            // Send ACTION_UP
+            motionArgs.action = AMOTION_EVENT_ACTION_UP;
+            motionArgs.eventTime = now();
+            dispatcher.notifyMotion(motionArgs);
+        }
+
+        for (const sp<FakeWindowHandle>& window : windows) {
+            window->consumeEvent();
+            window->consumeEvent();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * connectionCount * 2);
+
+    dispatcher.stop();
+}
+
+static void benchmarkNotifyMotionThroughListenerStages(benchmark::State& state) {
+    // Create dispatcher, behind the same stages the reader sends its events through
+    FakeInputDispatcherPolicy fakePolicy;
+    InputDispatcher dispatcher(fakePolicy);
+    InputProcessor processor(dispatcher);
+    UnwantedInteractionBlocker blocker(processor);
+    dispatcher.setInputDispatchMode(/*enabled*/ true, /*frozen*/ false);
+    dispatcher.start();
+
+    // Create a window that will receive motion events
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+    sp<FakeWindowHandle> window =
+            sp<FakeWindowHandle>::make(application, dispatcher, "Fake Window");
+
+    dispatcher.setInputWindows({{ADISPLAY_ID_DEFAULT, {window}}});
+
+    NotifyMotionArgs motionArgs = generateMotionArgs();
+
+    for (auto _ : state) {
+        // Send ACTION_DOWN
+        motionArgs.action = AMOTION_EVENT_ACTION_DOWN;
+        motionArgs.downTime = now();
+        motionArgs.eventTime = motionArgs.downTime;
+        blocker.notifyMotion(motionArgs);
+
+        // Send ACTION_UP
+        motionArgs.action = AMOTION_EVENT_ACTION_UP;
+        motionArgs.eventTime = now();
+        blocker.notifyMotion(motionArgs);
+
+        window->consumeEvent();
+        window->consumeEvent();
+    }
+
+    dispatcher.stop();
+}
+
 static void benchmarkInjectMotion(benchmark::State& state) {
     // Create dispatcher
     FakeInputDispatcherPolicy fakePolicy;
@@ -356,6 +446,8 @@ static void benchmarkOnWindowInfosChanged(benchmark::State& state) {
 } // namespace
 
 BENCHMARK(benchmarkNotifyMotion);
+BENCHMARK(benchmarkNotifyMotionToMultipleConnections)->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK(benchmarkNotifyMotionThroughListenerStages);
 BENCHMARK(benchmarkInjectMotion);
 BENCHMARK(benchmarkOnWindowInfosChanged);
 
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <linux/input.h>
+
+#include "../InputProcessor.h"
+#include "../UnwantedInteractionBlocker.h"
+#include "../tests/FakeEventHub.h"
+#include "../tests/FakeInputReaderPolicy.h"
+#include "../tests/InstrumentedInputReader.h"
+
+namespace android {
+
+namespace {
+
+constexpr int32_t EVENTHUB_ID = 1;
+constexpr int32_t DISPLAY_WIDTH = 1080;
+constexpr int32_t DISPLAY_HEIGHT = 2400;
+
+// Number of MOVE reports in a swipe, about a quarter of a second on a 120Hz touchscreen.
+constexpr int32_t SWIPE_MOVE_COUNT = 30;
+
+static nsecs_t now() {
+    return systemTime(SYSTEM_TIME_MONOTONIC);
+}
+
+// Drops all the args it receives, so that only the stages in front of it are measured.
+class NullInputListener : public InputListenerInterface {
+public:
+    void notifyInputDevicesChanged(const NotifyInputDevicesChangedArgs&) override {}
+    void notifyConfigurationChanged(const NotifyConfigurationChangedArgs&) override {}
+    void notifyKey(const NotifyKeyArgs&) override {}
+    void notifyMotion(const NotifyMotionArgs&) override {}
+    void notifySwitch(const NotifySwitchArgs&) override {}
+    void notifySensor(const NotifySensorArgs&) override {}
+    void notifyVibratorState(const NotifyVibratorStateArgs&) override {}
+    void notifyDeviceReset(const NotifyDeviceResetArgs&) override {}
+    void notifyPointerCaptureChanged(const NotifyPointerCaptureChangedArgs&) override {}
+};
+
+// An InputReader with a single multi-touch screen, whose evdev stream is fed from a FakeEventHub.
+class TouchscreenReader {
+public:
+    explicit TouchscreenReader(InputListenerInterface& listener)
+          : mFakeEventHub(std::make_shared<FakeEventHub>()),
+            mFakePolicy(sp<FakeInputReaderPolicy>::make()),
+            mReader(mFakeEventHub, mFakePolicy, listener) {
+        mFakePolicy->addDisplayViewport(ADISPLAY_ID_DEFAULT, DISPLAY_WIDTH, DISPLAY_HEIGHT,
+                                        ui::ROTATION_0, /*isActive=*/true, "local:0",
+                                        /*physicalPort=*/std::nullopt, ViewportType::INTERNAL);
+
+        mFakeEventHub->addDevice(EVENTHUB_ID, "Fake Touchscreen",
+                                 InputDeviceClass::TOUCH | InputDeviceClass::TOUCH_MT, BUS_USB);
+        mFakeEventHub->addConfigurationProperty(EVENTHUB_ID, "touch.deviceType", "touchScreen");
+        mFakeEventHub->addAbsoluteAxis(EVENTHUB_ID, ABS_MT_SLOT, 0, 9, 0, 0);
+        mFakeEventHub->addAbsoluteAxis(EVENTHUB_ID, ABS_MT_TRACKING_ID, 0, 0xffff, 0, 0);
+        mFakeEventHub->addAbsoluteAxis(EVENTHUB_ID, ABS_MT_POSITION_X, 0, DISPLAY_WIDTH - 1, 0, 0);
+        mFakeEventHub->addAbsoluteAxis(EVENTHUB_ID, ABS_MT_POSITION_Y, 0, DISPLAY_HEIGHT - 1, 0,
+                                       0);
+        mFakeEventHub->addAbsoluteAxis(EVENTHUB_ID, ABS_MT_TOUCH_MAJOR, 0, 255, 0, 0);
+        mFakeEventHub->addAbsoluteAxis(EVENTHUB_ID, ABS_MT_PRESSURE, 0, 255, 0, 0);
+        mFakeEventHub->addKey(EVENTHUB_ID, BTN_TOUCH, 0, AKEYCODE_UNKNOWN, 0);
+        mFakeEventHub->finishDeviceScan();
+        mReader.loopOnce();
+
+        mReader.requestRefreshConfiguration(InputReaderConfiguration::Change::DISPLAY_INFO);
+        mReader.loopOnce();
+    }
+
+    // Reads the evdev stream of a vertical one-finger swipe, as a touchscreen driver reports it.
+    void swipe() {
+        nsecs_t when = now();
+        int32_t y = DISPLAY_HEIGHT * 3 / 4;
+        enqueue(when, EV_ABS, ABS_MT_SLOT, 0);
+        enqueue(when, EV_ABS, ABS_MT_TRACKING_ID, mNextTrackingId++ & 0xffff);
+        enqueue(when, EV_ABS, ABS_MT_POSITION_X, DISPLAY_WIDTH / 2);
+        enqueue(when, EV_ABS, ABS_MT_POSITION_Y, y);
+        enqueue(when, EV_ABS, ABS_MT_TOUCH_MAJOR, 10);
+        enqueue(when, EV_ABS, ABS_MT_PRESSURE, 60);
+        enqueue(when, EV_KEY, BTN_TOUCH, 1);
+        enqueue(when, EV_SYN, SYN_REPORT, 0);
+
+        for (int32_t i = 0; i < SWIPE_MOVE_COUNT; i++) {
+            when += ms2ns(8);
+            y -= 20;
+            enqueue(when, EV_ABS, ABS_MT_POSITION_Y, y);
+            enqueue(when, EV_ABS, ABS_MT_PRESSURE, 60 + (i % 4));
+            enqueue(when, EV_SYN, SYN_REPORT, 0);
+        }
+
+        when += ms2ns(8);
+        enqueue(when, EV_ABS, ABS_MT_TRACKING_ID, -1);
+        enqueue(when, EV_KEY, BTN_TOUCH, 0);
+        enqueue(when, EV_SYN, SYN_REPORT, 0);
+
+        mReader.loopOnce();
+    }
+
+private:
+    void enqueue(nsecs_t when, int32_t type, int32_t code, int32_t value) {
+        mFakeEventHub->enqueueEvent(when, when, EVENTHUB_ID, type, code, value);
+    }
+
+    std::shared_ptr<FakeEventHub> mFakeEventHub;
+    sp<FakeInputReaderPolicy> mFakePolicy;
+    InstrumentedInputReader mReader;
+    int32_t mNextTrackingId = 0;
+};
+
+// Measures the reader alone: EventHub events in, NotifyMotionArgs out.
+static void benchmarkReadSwipe(benchmark::State& state) {
+    NullInputListener listener;
+    TouchscreenReader reader(listener);
+
+    for (auto _ : state) {
+        reader.swipe();
+    }
+    state.SetItemsProcessed(state.iterations() * (SWIPE_MOVE_COUNT + 2));
+}
+
+// Measures the reader followed by the listener stages that run on the reader thread, up to where
+// the dispatcher would take over. See benchmarkNotifyMotionThroughListenerStages for the rest.
+static void benchmarkReadSwipeThroughListenerStages(benchmark::State& state) {
+    NullInputListener listener;
+    InputProcessor processor(listener);
+    UnwantedInteractionBlocker blocker(processor);
+    TouchscreenReader reader(blocker);
+
+    for (auto _ : state) {
+        reader.swipe();
+    }
+    state.SetItemsProcessed(state.iterations() * (SWIPE_MOVE_COUNT + 2));
+}
+
+} // namespace
+
+BENCHMARK(benchmarkReadSwipe);
+BENCHMARK(benchmarkReadSwipeThroughListenerStages);
+
+} // namespace android
@@ -20,6 +20,7 @@
 
 #include "Connection.h"
 #include "DebugConfig.h"
+#include "EntryPool.h"
 
 #include <android-base/stringprintf.h>
 #include <cutils/atomic.h>
@@ -29,6 +30,15 @@ using android::base::StringPrintf;
 
 namespace android::inputdispatcher {
 
+namespace {
+
+// Enough for the events in flight to a few connections, a MotionEntry is a few KB.
+using KeyEntryPool = EntryPool<KeyEntry, 16>;
+using MotionEntryPool = EntryPool<MotionEntry, 32>;
+using DispatchEntryPool = EntryPool<DispatchEntry, 64>;
+
+} // namespace
+
 VerifiedKeyEvent verifiedKeyEventFromKeyEntry(const KeyEntry& entry) {
     return {{VerifiedInputEvent::Type::KEY, entry.deviceId, entry.eventTime, entry.source,
              entry.displayId},
@@ -172,6 +182,14 @@ KeyEntry::KeyEntry(int32_t id, nsecs_t eventTime, int32_t deviceId, uint32_t sou
 
 KeyEntry::~KeyEntry() {}
 
+void* KeyEntry::operator new(size_t size) {
+    return KeyEntryPool::allocate(size);
+}
+
+void KeyEntry::operator delete(void* ptr, size_t size) {
+    KeyEntryPool::release(ptr, size);
+}
+
 std::string KeyEntry::getDescription() const {
     if (!IS_DEBUGGABLE_BUILD) {
         return "KeyEvent";
@@ -242,6 +260,14 @@ MotionEntry::MotionEntry(int32_t id, nsecs_t eventTime, int32_t deviceId, uint32
 
 MotionEntry::~MotionEntry() {}
 
+void* MotionEntry::operator new(size_t size) {
+    return MotionEntryPool::allocate(size);
+}
+
+void MotionEntry::operator delete(void* ptr, size_t size) {
+    MotionEntryPool::release(ptr, size);
+}
+
 std::string MotionEntry::getDescription() const {
     if (!IS_DEBUGGABLE_BUILD) {
         return "MotionEvent";
@@ -323,6 +349,14 @@ DispatchEntry::DispatchEntry(std::shared_ptr<EventEntry> eventEntry,
         resolvedAction(0),
         resolvedFlags(0) {}
 
+void* DispatchEntry::operator new(size_t size) {
+    return DispatchEntryPool::allocate(size);
+}
+
+void DispatchEntry::operator delete(void* ptr, size_t size) {
+    DispatchEntryPool::release(ptr, size);
+}
+
 uint32_t DispatchEntry::nextSeq() {
     // Sequence number 0 is reserved and will never be returned.
     uint32_t seq;
@@ -156,6 +156,9 @@ struct KeyEntry : EventEntry {
     void recycle();
 
     ~KeyEntry() override;
+
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr, size_t size);
 };
 
 struct MotionEntry : EventEntry {
@@ -187,6 +190,10 @@ struct MotionEntry : EventEntry {
     std::string getDescription() const override;
 
     ~MotionEntry() override;
+
+    // Motion entries are recycled, since they are created for every sample of a gesture.
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr, size_t size);
 };
 
 struct SensorEntry : EventEntry {
@@ -248,6 +255,9 @@ struct DispatchEntry {
 
     inline bool isSplit() const { return targetFlags.test(InputTarget::Flags::SPLIT); }
 
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr, size_t size);
+
 private:
     static volatile int32_t sNextSeqAtomic;
 
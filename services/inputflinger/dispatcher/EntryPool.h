@@ -0,0 +1,76 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace android::inputdispatcher {
+
+/**
+ * Recycles the memory of the objects the dispatcher creates for every event, so that dispatching
+ * a steady stream of events doesn't allocate. Types use it from their class-specific operator new
+ * and operator delete. Up to MaxFreeCount released blocks are kept for reuse, the rest are freed.
+ *
+ * Entries can be released from any thread, so the free list is protected by its own lock.
+ */
+template <typename T, size_t MaxFreeCount>
+class EntryPool {
+public:
+    static void* allocate(size_t size) {
+        if (size == sizeof(T)) {
+            FreeList& freeList = getFreeList();
+            std::scoped_lock _l(freeList.lock);
+            if (!freeList.blocks.empty()) {
+                void* block = freeList.blocks.back();
+                freeList.blocks.pop_back();
+                return block;
+            }
+        }
+        return ::operator new(size);
+    }
+
+    static void release(void* block, size_t size) {
+        if (size == sizeof(T)) {
+            FreeList& freeList = getFreeList();
+            std::scoped_lock _l(freeList.lock);
+            if (freeList.blocks.size() < MaxFreeCount) {
+                freeList.blocks.push_back(block);
+                return;
+            }
+        }
+        ::operator delete(block);
+    }
+
+private:
+    struct FreeList {
+        FreeList() { blocks.reserve(MaxFreeCount); }
+
+        std::mutex lock;
+        std::vector<void*> blocks;
+    };
+
+    static FreeList& getFreeList() {
+        // Never destroyed, entries may still be released while the process exits.
+        static FreeList* freeList = new FreeList();
+        return *freeList;
+    }
+};
+
+} // namespace android::inputdispatcher
@@ -517,9 +517,10 @@ bool isUserActivityEvent(const EventEntry& eventEntry) {
     }
 }
 
-// Returns true if the given window can accept pointer events at the given display location.
+// Returns true if the given window can accept pointer events at the given display location. The
+// window is the one at the given position of the display's hit index.
 bool windowAcceptsTouchAt(const WindowInfo& windowInfo, int32_t displayId, float x, float y,
-                          bool isStylus, const ui::Transform& displayTransform) {
+                          bool isStylus, const WindowHitIndex& hitIndex, uint32_t position) {
     const auto inputConfig = windowInfo.inputConfig;
     if (windowInfo.displayId != displayId ||
         inputConfig.test(WindowInfo::InputConfig::NOT_VISIBLE)) {
@@ -537,12 +538,8 @@ bool windowAcceptsTouchAt(const WindowInfo& windowInfo, int32_t displayId, float
     // "bottom" of the window will be different in the display (un-rotated) space compared to in the
     // logical display in which WM determined the bounds. Perform the hit test in the logical
     // display space to ensure these edges are considered correctly in all orientations.
-    const auto touchableRegion = displayTransform.transform(windowInfo.touchableRegion);
-    const auto p = displayTransform.transform(x, y);
-    if (!touchableRegion.contains(std::floor(p.x), std::floor(p.y))) {
-        return false;
-    }
-    return true;
+    // The hit index holds the touchable regions already transformed to that space.
+    return hitIndex.touchableRegionContains(position, x, y);
 }
 
 bool isPointerFromStylus(const MotionEntry& entry, int32_t pointerIndex) {
@@ -739,7 +736,8 @@ InputDispatcher::InputDispatcher(InputDispatcherPolicyInterface& policy,
         mWindowTokenWithPointerCapture(nullptr),
         mStaleEventTimeout(staleEventTimeout),
         mLatencyAggregator(),
-        mLatencyTracker(&mLatencyAggregator) {
+        mLatencyHistograms(),
+        mLatencyTracker({&mLatencyAggregator, &mLatencyHistograms}) {
     mLooper = sp<Looper>::make(false);
     mReporter = createInputReporter();
 
@@ -1244,38 +1242,52 @@ void InputDispatcher::addRecentEventLocked(std::shared_ptr<EventEntry> entry) {
 std::pair<sp<WindowInfoHandle>, std::vector<InputTarget>>
 InputDispatcher::findTouchedWindowAtLocked(int32_t displayId, float x, float y, bool isStylus,
                                            bool ignoreDragWindow) const {
-    // Traverse windows from front to back to find touched window.
-    std::vector<InputTarget> outsideTargets;
+    // Traverse the windows that may contain the point from front to back to find touched window.
     const auto& windowHandles = getWindowHandlesLocked(displayId);
-    for (const sp<WindowInfoHandle>& windowHandle : windowHandles) {
+    const WindowHitIndex& hitIndex = getWindowHitIndexLocked(displayId);
+    for (uint32_t position : hitIndex.getTouchCandidates(x, y)) {
+        const sp<WindowInfoHandle>& windowHandle = windowHandles[position];
         if (ignoreDragWindow && haveSameToken(windowHandle, mDragState->dragWindow)) {
             continue;
         }
 
         const WindowInfo& info = *windowHandle->getInfo();
-        if (!info.isSpy() &&
-            windowAcceptsTouchAt(info, displayId, x, y, isStylus, getTransformLocked(displayId))) {
-            return {windowHandle, outsideTargets};
+        if (info.isSpy() ||
+            !windowAcceptsTouchAt(info, displayId, x, y, isStylus, hitIndex, position)) {
+            continue;
         }
 
-        if (info.inputConfig.test(WindowInfo::InputConfig::WATCH_OUTSIDE_TOUCH)) {
-            addWindowTargetLocked(windowHandle, InputTarget::Flags::DISPATCH_AS_OUTSIDE,
+        // The windows above the touched window that watch outside touches receive it as such.
+        std::vector<InputTarget> outsideTargets;
+        for (uint32_t outsidePosition : hitIndex.getWatchOutsideTouchWindows()) {
+            if (outsidePosition >= position) {
+                break;
+            }
+            const sp<WindowInfoHandle>& outsideHandle = windowHandles[outsidePosition];
+            if (ignoreDragWindow && haveSameToken(outsideHandle, mDragState->dragWindow)) {
+                continue;
+            }
+            addWindowTargetLocked(outsideHandle, InputTarget::Flags::DISPATCH_AS_OUTSIDE,
                                   /*pointerIds=*/{}, /*firstDownTimeInTarget=*/std::nullopt,
                                   outsideTargets);
         }
+        return {windowHandle, outsideTargets};
     }
     return {nullptr, {}};
 }
 
 std::vector<sp<WindowInfoHandle>> InputDispatcher::findTouchedSpyWindowsAtLocked(
         int32_t displayId, float x, float y, bool isStylus) const {
-    // Traverse windows from front to back and gather the touched spy windows.
+    // Traverse the windows that may contain the point from front to back and gather the touched
+    // spy windows.
     std::vector<sp<WindowInfoHandle>> spyWindows;
     const auto& windowHandles = getWindowHandlesLocked(displayId);
-    for (const sp<WindowInfoHandle>& windowHandle : windowHandles) {
+    const WindowHitIndex& hitIndex = getWindowHitIndexLocked(displayId);
+    for (uint32_t position : hitIndex.getTouchCandidates(x, y)) {
+        const sp<WindowInfoHandle>& windowHandle = windowHandles[position];
         const WindowInfo& info = *windowHandle->getInfo();
 
-        if (!windowAcceptsTouchAt(info, displayId, x, y, isStylus, getTransformLocked(displayId))) {
+        if (!windowAcceptsTouchAt(info, displayId, x, y, isStylus, hitIndex, position)) {
             continue;
         }
         if (!info.isSpy()) {
@@ -2989,10 +3001,13 @@ InputDispatcher::TouchOcclusionInfo InputDispatcher::computeTouchOcclusionInfoLo
     info.obscuringOpacity = 0;
     info.obscuringUid = gui::Uid::INVALID;
     std::map<gui::Uid, float> opacityByUid;
-    for (const sp<WindowInfoHandle>& otherHandle : windowHandles) {
-        if (windowHandle == otherHandle) {
+    const WindowHitIndex& hitIndex = getWindowHitIndexLocked(displayId);
+    const uint32_t windowPosition = hitIndex.getPosition(windowHandle);
+    for (uint32_t position : hitIndex.getFrameCandidates(x, y)) {
+        if (position >= windowPosition) {
             break; // All future windows are below us. Exit early.
         }
+        const sp<WindowInfoHandle>& otherHandle = windowHandles[position];
         const WindowInfo* otherInfo = otherHandle->getInfo();
         if (canBeObscuredBy(windowHandle, otherHandle) && otherInfo->frameContainsPoint(x, y) &&
             !haveSameApplicationToken(windowInfo, otherInfo)) {
@@ -3068,10 +3083,13 @@ bool InputDispatcher::isWindowObscuredAtPointLocked(const sp<WindowInfoHandle>&
                                                     int32_t x, int32_t y) const {
     int32_t displayId = windowHandle->getInfo()->displayId;
     const std::vector<sp<WindowInfoHandle>>& windowHandles = getWindowHandlesLocked(displayId);
-    for (const sp<WindowInfoHandle>& otherHandle : windowHandles) {
-        if (windowHandle == otherHandle) {
+    const WindowHitIndex& hitIndex = getWindowHitIndexLocked(displayId);
+    const uint32_t windowPosition = hitIndex.getPosition(windowHandle);
+    for (uint32_t position : hitIndex.getFrameCandidates(x, y)) {
+        if (position >= windowPosition) {
             break; // All future windows are below us. Exit early.
         }
+        const sp<WindowInfoHandle>& otherHandle = windowHandles[position];
         const WindowInfo* otherInfo = otherHandle->getInfo();
         if (canBeObscuredBy(windowHandle, otherHandle) &&
             otherInfo->frameContainsPoint(x, y)) {
@@ -3840,14 +3858,42 @@ void InputDispatcher::releaseDispatchEntry(DispatchEntry* dispatchEntry) {
 }
 
 int InputDispatcher::handleReceiveCallback(int events, sp<IBinder> connectionToken) {
-    std::scoped_lock _l(mLock);
-    std::shared_ptr<Connection> connection = getConnectionLocked(connectionToken);
+    std::shared_ptr<Connection> connection;
+    { // acquire lock
+        std::scoped_lock _l(mLock);
+        connection = getConnectionLocked(connectionToken);
+    } // release lock
     if (connection == nullptr) {
         ALOGW("Received looper callback for unknown input channel token %p.  events=0x%x",
               connectionToken.get(), events);
         return 0; // remove the callback
     }
 
+    // Read the consumer responses before acquiring the lock, so that draining the socket doesn't
+    // hold up the events being enqueued by other threads. The publisher is only used by the
+    // dispatcher thread, which is also the thread running this callback.
+    const nsecs_t currentTime = now();
+    std::vector<InputPublisher::ConsumerResponse> responses;
+    status_t status = OK;
+    if (!(events & (ALOOPER_EVENT_ERROR | ALOOPER_EVENT_HANGUP)) &&
+        (events & ALOOPER_EVENT_INPUT)) {
+        for (;;) {
+            Result<InputPublisher::ConsumerResponse> result =
+                    connection->inputPublisher.receiveConsumerResponse();
+            if (!result.ok()) {
+                status = result.error().code();
+                break;
+            }
+            responses.push_back(std::move(*result));
+        }
+    }
+
+    std::scoped_lock _l(mLock);
+    if (getConnectionLocked(connectionToken) != connection) {
+        // The channel was removed while the responses were being read.
+        return 0; // remove the callback
+    }
+
     bool notify;
     if (!(events & (ALOOPER_EVENT_ERROR | ALOOPER_EVENT_HANGUP))) {
         if (!(events & ALOOPER_EVENT_INPUT)) {
@@ -3857,26 +3903,17 @@ int InputDispatcher::handleReceiveCallback(int events, sp<IBinder> connectionTok
             return 1;
         }
 
-        nsecs_t currentTime = now();
         bool gotOne = false;
-        status_t status = OK;
-        for (;;) {
-            Result<InputPublisher::ConsumerResponse> result =
-                    connection->inputPublisher.receiveConsumerResponse();
-            if (!result.ok()) {
-                status = result.error().code();
-                break;
-            }
-
-            if (std::holds_alternative<InputPublisher::Finished>(*result)) {
+        for (InputPublisher::ConsumerResponse& response : responses) {
+            if (std::holds_alternative<InputPublisher::Finished>(response)) {
                 const InputPublisher::Finished& finish =
-                        std::get<InputPublisher::Finished>(*result);
+                        std::get<InputPublisher::Finished>(response);
                 finishDispatchCycleLocked(currentTime, connection, finish.seq, finish.handled,
                                           finish.consumeTime);
-            } else if (std::holds_alternative<InputPublisher::Timeline>(*result)) {
+            } else if (std::holds_alternative<InputPublisher::Timeline>(response)) {
                 if (shouldReportMetricsForConnection(*connection)) {
-                    const InputPublisher::Timeline& timeline =
-                            std::get<InputPublisher::Timeline>(*result);
+                    InputPublisher::Timeline& timeline =
+                            std::get<InputPublisher::Timeline>(response);
                     mLatencyTracker
                             .trackGraphicsLatency(timeline.inputEventId,
                                                   connection->inputChannel->getConnectionToken(),
@@ -4414,6 +4451,18 @@ void InputDispatcher::notifyMotion(const NotifyMotionArgs& args) {
               std::to_string(t.duration().count()).c_str());
     }
 
+    // Copy the pointers into the entry before acquiring the lock, the dispatcher thread doesn't
+    // need to wait for it. The policy flags are finalized under the lock.
+    std::unique_ptr<MotionEntry> newEntry =
+            std::make_unique<MotionEntry>(args.id, args.eventTime, args.deviceId, args.source,
+                                          args.displayId, policyFlags, args.action,
+                                          args.actionButton, args.flags, args.metaState,
+                                          args.buttonState, args.classification, args.edgeFlags,
+                                          args.xPrecision, args.yPrecision, args.xCursorPosition,
+                                          args.yCursorPosition, args.downTime,
+                                          args.getPointerCount(), args.pointerProperties.data(),
+                                          args.pointerCoords.data());
+
     bool needWake = false;
     { // acquire lock
         mLock.lock();
@@ -4454,23 +4503,15 @@ void InputDispatcher::notifyMotion(const NotifyMotionArgs& args) {
             mLock.lock();
         }
 
-        // Just enqueue a new motion event.
-        std::unique_ptr<MotionEntry> newEntry =
-                std::make_unique<MotionEntry>(args.id, args.eventTime, args.deviceId, args.source,
-                                              args.displayId, policyFlags, args.action,
-                                              args.actionButton, args.flags, args.metaState,
-                                              args.buttonState, args.classification, args.edgeFlags,
-                                              args.xPrecision, args.yPrecision,
-                                              args.xCursorPosition, args.yCursorPosition,
-                                              args.downTime, args.getPointerCount(),
-                                              args.pointerProperties.data(),
-                                              args.pointerCoords.data());
+        // Just enqueue the new motion event.
+        newEntry->policyFlags = policyFlags;
 
         if (args.id != android::os::IInputConstants::INVALID_INPUT_EVENT_ID &&
             IdGenerator::getSource(args.id) == IdGenerator::Source::INPUT_READER &&
             !mInputFilterEnabled) {
             const bool isDown = args.action == AMOTION_EVENT_ACTION_DOWN;
-            mLatencyTracker.trackListener(args.id, isDown, args.eventTime, args.readTime);
+            mLatencyTracker.trackListener(args.id, isDown, args.eventTime, args.readTime,
+                                          args.deviceId);
         }
 
         needWake = enqueueInboundEventLocked(std::move(newEntry));
@@ -4925,6 +4966,12 @@ const std::vector<sp<WindowInfoHandle>>& InputDispatcher::getWindowHandlesLocked
     return it != mWindowHandlesByDisplay.end() ? it->second : EMPTY_WINDOW_HANDLES;
 }
 
+const WindowHitIndex& InputDispatcher::getWindowHitIndexLocked(int32_t displayId) const {
+    static const WindowHitIndex EMPTY_WINDOW_HIT_INDEX;
+    auto it = mWindowHitIndexByDisplay.find(displayId);
+    return it != mWindowHitIndexByDisplay.end() ? it->second : EMPTY_WINDOW_HIT_INDEX;
+}
+
 sp<WindowInfoHandle> InputDispatcher::getWindowHandleLocked(
         const sp<IBinder>& windowHandleToken) const {
     if (windowHandleToken == nullptr) {
@@ -5056,6 +5103,7 @@ void InputDispatcher::updateWindowHandlesForDisplayLocked(
     if (windowInfoHandles.empty()) {
         // Remove all handles on a display if there are no windows left.
         mWindowHandlesByDisplay.erase(displayId);
+        mWindowHitIndexByDisplay.erase(displayId);
         return;
     }
 
@@ -5101,6 +5149,9 @@ void InputDispatcher::updateWindowHandlesForDisplayLocked(
 
     // Insert or replace
     mWindowHandlesByDisplay[displayId] = newHandles;
+    mWindowHitIndexByDisplay.insert_or_assign(displayId,
+                                              WindowHitIndex(newHandles,
+                                                             getTransformLocked(displayId)));
 }
 
 void InputDispatcher::setInputWindows(
@@ -5868,6 +5919,10 @@ void InputDispatcher::dumpDispatchStateLocked(std::string& dump) const {
                          ns2ms(mConfig.keyRepeatTimeout));
     dump += mLatencyTracker.dump(INDENT2);
     dump += mLatencyAggregator.dump(INDENT2);
+    dump += mLatencyHistograms.dump(INDENT2,
+                                    [this](const sp<IBinder>& connectionToken) REQUIRES(mLock) {
+                                        return getConnectionNameLocked(connectionToken);
+                                    });
 }
 
 void InputDispatcher::dumpMonitors(std::string& dump, const std::vector<Monitor>& monitors) const {
@@ -5993,6 +6048,7 @@ status_t InputDispatcher::removeInputChannelLocked(const sp<IBinder>& connection
     }
 
     removeConnectionLocked(connection);
+    mLatencyHistograms.removeConnection(connectionToken);
 
     if (connection->monitor) {
         removeMonitorChannelLocked(connectionToken);
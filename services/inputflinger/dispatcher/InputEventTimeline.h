@@ -51,6 +51,8 @@ struct ConnectionTimeline {
      * True if all contained timestamps are valid, false otherwise.
      */
     bool isComplete() const;
+    bool hasDispatchTimeline() const { return mHasDispatchTimeline; }
+    bool hasGraphicsTimeline() const { return mHasGraphicsTimeline; }
     /**
      * Set the dispatching-related times. Return true if the operation succeeded, false if the
      * dispatching times have already been set. If this function returns false, it likely indicates
@@ -73,10 +75,11 @@ private:
 };
 
 struct InputEventTimeline {
-    InputEventTimeline(bool isDown, nsecs_t eventTime, nsecs_t readTime);
+    InputEventTimeline(bool isDown, nsecs_t eventTime, nsecs_t readTime, int32_t deviceId);
     const bool isDown; // True if this is an ACTION_DOWN event
     const nsecs_t eventTime;
     const nsecs_t readTime;
+    const int32_t deviceId;
 
     struct IBinderHash {
         std::size_t operator()(const sp<IBinder>& b) const {
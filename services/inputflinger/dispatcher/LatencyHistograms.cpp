@@ -0,0 +1,199 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "LatencyHistograms"
+#define ATRACE_TAG ATRACE_TAG_INPUT
+
+#include "LatencyHistograms.h"
+
+#include <android-base/stringprintf.h>
+#include <utils/Trace.h>
+
+#include <bit>
+#include <cinttypes>
+#include <cmath>
+
+using android::base::StringPrintf;
+
+namespace android::inputdispatcher {
+
+namespace {
+
+constexpr nsecs_t BUCKET_UNIT = 1'000'000; // 1 ms
+
+// Bucket i ends at 2^i ms. The last bucket is unbounded, and starts where the previous one ends.
+constexpr nsecs_t bucketUpperBound(size_t bucket) {
+    return BUCKET_UNIT << bucket;
+}
+
+const char* getCounterName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::READ_TO_DISPATCH:
+            return "inputLatencyReadToDispatchUs";
+        case LatencyStage::DISPATCH_TO_CONSUME:
+            return "inputLatencyDispatchToConsumeUs";
+        case LatencyStage::CONSUME_TO_PRESENT:
+            return "inputLatencyConsumeToPresentUs";
+    }
+}
+
+std::string dumpStages(const char* prefix, const LatencyHistograms::StageHistograms& histograms) {
+    std::string dump;
+    for (LatencyStage stage : ftl::enum_range<LatencyStage>()) {
+        const LatencyHistogram& histogram = histograms[static_cast<size_t>(stage)];
+        dump += StringPrintf("%s%s: %s\n", prefix, ftl::enum_string(stage).c_str(),
+                             histogram.dump().c_str());
+    }
+    return dump;
+}
+
+} // namespace
+
+// --- LatencyHistogram ---
+
+void LatencyHistogram::record(nsecs_t latency) {
+    if (latency < 0) {
+        // The consume and present times come from the app, and can't be trusted.
+        return;
+    }
+    const size_t bucket =
+            std::min<size_t>(std::bit_width(static_cast<uint64_t>(latency / BUCKET_UNIT)),
+                             BUCKET_COUNT - 1);
+    mBuckets[bucket]++;
+    mCount++;
+}
+
+nsecs_t LatencyHistogram::getPercentileUpperBound(float fraction) const {
+    if (mCount == 0) {
+        return -1;
+    }
+    const uint64_t target = std::max<uint64_t>(1, std::ceil(fraction * mCount));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKET_COUNT - 1; bucket++) {
+        seen += mBuckets[bucket];
+        if (seen >= target) {
+            return bucketUpperBound(bucket);
+        }
+    }
+    return bucketUpperBound(BUCKET_COUNT - 2);
+}
+
+std::string LatencyHistogram::dump() const {
+    if (mCount == 0) {
+        return "<none>";
+    }
+    std::string dump = StringPrintf("count=%" PRIu64 " p50<=%" PRId64 "ms p90<=%" PRId64
+                                    "ms p99<=%" PRId64 "ms buckets=[",
+                                    mCount, ns2ms(getPercentileUpperBound(0.5f)),
+                                    ns2ms(getPercentileUpperBound(0.9f)),
+                                    ns2ms(getPercentileUpperBound(0.99f)));
+    for (size_t bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+        dump += StringPrintf("%s%" PRIu64, bucket == 0 ? "" : ", ", mBuckets[bucket]);
+    }
+    return dump + "]";
+}
+
+// --- LatencyHistograms ---
+
+void LatencyHistograms::processTimeline(const InputEventTimeline& timeline) {
+    StageHistograms* device = nullptr;
+    auto deviceIt = mByDevice.find(timeline.deviceId);
+    if (deviceIt != mByDevice.end()) {
+        device = &deviceIt->second;
+    } else if (mByDevice.size() < MAX_TRACKED_DEVICES) {
+        device = &mByDevice[timeline.deviceId];
+    }
+
+    for (const auto& [connectionToken, connectionTimeline] : timeline.connectionTimelines) {
+        StageHistograms* connection = nullptr;
+        auto connectionIt = mByConnection.find(connectionToken);
+        if (connectionIt != mByConnection.end()) {
+            connection = &connectionIt->second;
+        } else if (mByConnection.size() < MAX_TRACKED_CONNECTIONS) {
+            connection = &mByConnection[connectionToken];
+        }
+
+        if (connectionTimeline.hasDispatchTimeline()) {
+            record(LatencyStage::READ_TO_DISPATCH,
+                   connectionTimeline.deliveryTime - timeline.readTime, device, connection);
+            record(LatencyStage::DISPATCH_TO_CONSUME,
+                   connectionTimeline.consumeTime - connectionTimeline.deliveryTime, device,
+                   connection);
+            if (connectionTimeline.hasGraphicsTimeline()) {
+                record(LatencyStage::CONSUME_TO_PRESENT,
+                       connectionTimeline.graphicsTimeline[GraphicsTimeline::PRESENT_TIME] -
+                               connectionTimeline.consumeTime,
+                       device, connection);
+            }
+        }
+    }
+}
+
+void LatencyHistograms::record(LatencyStage stage, nsecs_t latency, StageHistograms* device,
+                               StageHistograms* connection) {
+    const size_t index = static_cast<size_t>(stage);
+    mTotal[index].record(latency);
+    if (device != nullptr) {
+        (*device)[index].record(latency);
+    }
+    if (connection != nullptr) {
+        (*connection)[index].record(latency);
+    }
+    if (ATRACE_ENABLED()) {
+        ATRACE_INT64(getCounterName(stage), ns2us(latency));
+    }
+}
+
+void LatencyHistograms::removeConnection(const sp<IBinder>& connectionToken) {
+    mByConnection.erase(connectionToken);
+}
+
+const LatencyHistograms::StageHistograms* LatencyHistograms::getForDevice(int32_t deviceId) const {
+    auto it = mByDevice.find(deviceId);
+    return it != mByDevice.end() ? &it->second : nullptr;
+}
+
+const LatencyHistograms::StageHistograms* LatencyHistograms::getForConnection(
+        const sp<IBinder>& connectionToken) const {
+    auto it = mByConnection.find(connectionToken);
+    return it != mByConnection.end() ? &it->second : nullptr;
+}
+
+std::string LatencyHistograms::dump(
+        const char* prefix,
+        const std::function<std::string(const sp<IBinder>&)>& getConnectionName) const {
+    std::string dump = StringPrintf("%sLatencyHistograms (bucket upper bounds in ms:", prefix);
+    for (size_t bucket = 0; bucket < LatencyHistogram::BUCKET_COUNT - 1; bucket++) {
+        dump += StringPrintf(" %" PRId64, ns2ms(bucketUpperBound(bucket)));
+    }
+    dump += " +inf):\n";
+
+    const std::string indent = std::string(prefix) + "    ";
+    dump += StringPrintf("%s  Total:\n", prefix);
+    dump += dumpStages(indent.c_str(), mTotal);
+    for (const auto& [deviceId, histograms] : mByDevice) {
+        dump += StringPrintf("%s  Device %" PRId32 ":\n", prefix, deviceId);
+        dump += dumpStages(indent.c_str(), histograms);
+    }
+    for (const auto& [connectionToken, histograms] : mByConnection) {
+        dump += StringPrintf("%s  Connection '%s':\n", prefix,
+                             getConnectionName(connectionToken).c_str());
+        dump += dumpStages(indent.c_str(), histograms);
+    }
+    return dump;
+}
+
+} // namespace android::inputdispatcher
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include <binder/IBinder.h>
+#include <ftl/enum.h>
+#include <utils/Timers.h>
+
+#include "InputEventTimeline.h"
+
+namespace android::inputdispatcher {
+
+enum class LatencyStage : size_t {
+    READ_TO_DISPATCH = 0,    // readTime -> deliveryTime
+    DISPATCH_TO_CONSUME = 1, // deliveryTime -> consumeTime
+    CONSUME_TO_PRESENT = 2,  // consumeTime -> GraphicsTimeline::PRESENT_TIME
+
+    ftl_last = CONSUME_TO_PRESENT
+};
+
+/**
+ * Histogram of latencies with power-of-two millisecond buckets: [0, 1ms), [1ms, 2ms), [2ms, 4ms),
+ * and so on, with the last bucket holding everything slower than the previous one. Recording a
+ * latency is constant time and never allocates.
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t BUCKET_COUNT = 12;
+
+    void record(nsecs_t latency);
+    uint64_t getCount() const { return mCount; }
+    uint64_t getBucketCount(size_t bucket) const { return mBuckets[bucket]; }
+    /**
+     * Upper bound of the bucket that contains the given fraction of the recorded latencies, or
+     * -1 if nothing was recorded. The last bucket is unbounded and reports its lower bound.
+     */
+    nsecs_t getPercentileUpperBound(float fraction) const;
+
+    std::string dump() const;
+
+private:
+    std::array<uint64_t, BUCKET_COUNT> mBuckets{};
+    uint64_t mCount = 0;
+};
+
+/**
+ * Always-on latency histograms of each dispatch stage, kept in total, per input device and per
+ * connection. The histograms are filled from the timelines reported by LatencyTracker, which are
+ * only complete once they are mature, so the data lags the live events by the ANR timeout.
+ *
+ * When tracing is enabled, the latencies of every reported timeline are also emitted as counter
+ * tracks, one per stage.
+ *
+ * The number of devices and connections that get their own histograms is bounded, events from
+ * the others are only counted in the totals.
+ */
+class LatencyHistograms final : public InputEventTimelineProcessor {
+public:
+    static constexpr size_t MAX_TRACKED_DEVICES = 32;
+    static constexpr size_t MAX_TRACKED_CONNECTIONS = 64;
+
+    using StageHistograms = std::array<LatencyHistogram, ftl::enum_size_v<LatencyStage>>;
+
+    void processTimeline(const InputEventTimeline& timeline) override;
+
+    /**
+     * Forget the histograms of a connection that was removed.
+     */
+    void removeConnection(const sp<IBinder>& connectionToken);
+
+    const StageHistograms& getTotal() const { return mTotal; }
+    const StageHistograms* getForDevice(int32_t deviceId) const;
+    const StageHistograms* getForConnection(const sp<IBinder>& connectionToken) const;
+
+    /**
+     * Dump all histograms. The connections are described with 'getConnectionName'.
+     */
+    std::string dump(const char* prefix,
+                     const std::function<std::string(const sp<IBinder>&)>& getConnectionName) const;
+
+private:
+    StageHistograms mTotal;
+    std::map<int32_t /*deviceId*/, StageHistograms> mByDevice;
+    std::unordered_map<sp<IBinder>, StageHistograms, InputEventTimeline::IBinderHash> mByConnection;
+
+    void record(LatencyStage stage, nsecs_t latency, StageHistograms* device,
+                StageHistograms* connection);
+};
+
+} // namespace android::inputdispatcher
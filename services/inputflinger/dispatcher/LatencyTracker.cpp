@@ -61,12 +61,17 @@ static void eraseByValue(std::multimap<K, V>& map, const V& value) {
 }
 
 LatencyTracker::LatencyTracker(InputEventTimelineProcessor* processor)
-      : mTimelineProcessor(processor) {
-    LOG_ALWAYS_FATAL_IF(processor == nullptr);
+      : LatencyTracker(std::vector<InputEventTimelineProcessor*>{processor}) {}
+
+LatencyTracker::LatencyTracker(std::vector<InputEventTimelineProcessor*> processors)
+      : mTimelineProcessors(std::move(processors)) {
+    for (const InputEventTimelineProcessor* processor : mTimelineProcessors) {
+        LOG_ALWAYS_FATAL_IF(processor == nullptr);
+    }
 }
 
 void LatencyTracker::trackListener(int32_t inputEventId, bool isDown, nsecs_t eventTime,
-                                   nsecs_t readTime) {
+                                   nsecs_t readTime, int32_t deviceId) {
     reportAndPruneMatureRecords(eventTime);
     const auto it = mTimelines.find(inputEventId);
     if (it != mTimelines.end()) {
@@ -78,7 +83,7 @@ void LatencyTracker::trackListener(int32_t inputEventId, bool isDown, nsecs_t ev
         eraseByValue(mEventTimes, inputEventId);
         return;
     }
-    mTimelines.emplace(inputEventId, InputEventTimeline(isDown, eventTime, readTime));
+    mTimelines.emplace(inputEventId, InputEventTimeline(isDown, eventTime, readTime, deviceId));
     mEventTimes.emplace(eventTime, inputEventId);
 }
 
@@ -155,7 +160,9 @@ void LatencyTracker::reportAndPruneMatureRecords(nsecs_t newEventTime) {
                                 "Event %" PRId32 " is in mEventTimes, but not in mTimelines",
                                 oldestInputEventId);
             const InputEventTimeline& timeline = it->second;
-            mTimelineProcessor->processTimeline(timeline);
+            for (InputEventTimelineProcessor* processor : mTimelineProcessors) {
+                processor->processTimeline(timeline);
+            }
             mTimelines.erase(it);
             mEventTimes.erase(mEventTimes.begin());
         } else {
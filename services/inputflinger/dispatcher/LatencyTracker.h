@@ -18,6 +18,7 @@
 
 #include <map>
 #include <unordered_map>
+#include <vector>
 
 #include <binder/IBinder.h>
 #include <input/Input.h>
@@ -40,6 +41,11 @@ public:
      * param reportingFunction: the function that will be called in order to report full latency.
      */
     LatencyTracker(InputEventTimelineProcessor* processor);
+    /**
+     * Create a LatencyTracker that reports every mature timeline to each of the processors, in
+     * order.
+     */
+    explicit LatencyTracker(std::vector<InputEventTimelineProcessor*> processors);
     /**
      * Start keeping track of an event identified by inputEventId. This must be called first.
      * If duplicate events are encountered (events that have the same eventId), none of them will be
@@ -49,7 +55,8 @@ public:
      * duplicate events that happen to have the same eventTime and inputEventId. Therefore, we
      * must drop all duplicate data.
      */
-    void trackListener(int32_t inputEventId, bool isDown, nsecs_t eventTime, nsecs_t readTime);
+    void trackListener(int32_t inputEventId, bool isDown, nsecs_t eventTime, nsecs_t readTime,
+                       int32_t deviceId);
     void trackFinishedEvent(int32_t inputEventId, const sp<IBinder>& connectionToken,
                             nsecs_t deliveryTime, nsecs_t consumeTime, nsecs_t finishTime);
     void trackGraphicsLatency(int32_t inputEventId, const sp<IBinder>& connectionToken,
@@ -75,7 +82,7 @@ private:
      */
     std::multimap<nsecs_t /*eventTime*/, int32_t /*inputEventId*/> mEventTimes;
 
-    InputEventTimelineProcessor* mTimelineProcessor;
+    std::vector<InputEventTimelineProcessor*> mTimelineProcessors;
     void reportAndPruneMatureRecords(nsecs_t newEventTime);
 };
 
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "WindowHitIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace android::inputdispatcher {
+
+using gui::WindowInfo;
+using gui::WindowInfoHandle;
+
+namespace {
+
+// Keeps far away points representable, they are outside of every grid extent.
+constexpr float kMaxQueryCoordinate = 1 << 30;
+
+int32_t toQueryCoordinate(float value) {
+    return static_cast<int32_t>(
+            std::clamp(std::floor(value), -kMaxQueryCoordinate, kMaxQueryCoordinate));
+}
+
+} // namespace
+
+WindowHitIndex::WindowHitIndex(const std::vector<sp<WindowInfoHandle>>& windowHandles,
+                               const ui::Transform& displayTransform)
+      : mDisplayTransform(displayTransform) {
+    std::vector<Rect> touchBounds;
+    std::vector<Rect> frameBounds;
+    touchBounds.reserve(windowHandles.size());
+    frameBounds.reserve(windowHandles.size());
+    mTouchableRegions.reserve(windowHandles.size());
+    for (uint32_t i = 0; i < windowHandles.size(); i++) {
+        const WindowInfo& info = *windowHandles[i]->getInfo();
+
+        // Transforming the region is the expensive part of the hit test, do it once per update
+        // rather than for every touch.
+        Region touchableRegion = displayTransform.transform(info.touchableRegion);
+        const Rect touchableBounds = touchableRegion.getBounds();
+        touchBounds.push_back(touchableBounds);
+        mTouchableRegions.push_back({touchableBounds, std::move(touchableRegion)});
+        frameBounds.emplace_back(info.frameLeft, info.frameTop, info.frameRight, info.frameBottom);
+
+        if (info.inputConfig.test(WindowInfo::InputConfig::WATCH_OUTSIDE_TOUCH)) {
+            mWatchOutsideTouchWindows.push_back(i);
+        }
+        mPositions.emplace(windowHandles[i].get(), i);
+    }
+    mTouchGrid.build(touchBounds);
+    mFrameGrid.build(frameBounds);
+}
+
+std::span<const uint32_t> WindowHitIndex::getTouchCandidates(float x, float y) const {
+    const vec2 p = mDisplayTransform.transform(x, y);
+    return mTouchGrid.getCandidates(toQueryCoordinate(p.x), toQueryCoordinate(p.y));
+}
+
+bool WindowHitIndex::touchableRegionContains(uint32_t position, float x, float y) const {
+    const TouchableRegion& touchableRegion = mTouchableRegions[position];
+    const vec2 p = mDisplayTransform.transform(x, y);
+    const int32_t px = toQueryCoordinate(p.x);
+    const int32_t py = toQueryCoordinate(p.y);
+    const Rect& b = touchableRegion.bounds;
+    if (px < b.left || px >= b.right || py < b.top || py >= b.bottom) {
+        return false;
+    }
+    return touchableRegion.region.isRect() || touchableRegion.region.contains(px, py);
+}
+
+uint32_t WindowHitIndex::getPosition(const sp<WindowInfoHandle>& windowHandle) const {
+    auto it = mPositions.find(windowHandle.get());
+    return it != mPositions.end() ? it->second : static_cast<uint32_t>(mPositions.size());
+}
+
+void WindowHitIndex::Grid::build(const std::vector<Rect>& bounds) {
+    // Clamp the bounds and compute the extent covered by the windows.
+    std::vector<Rect> clampedBounds;
+    clampedBounds.reserve(bounds.size());
+    for (uint32_t i = 0; i < bounds.size(); i++) {
+        const Rect& b = bounds[i];
+        if (b.isEmpty()) {
+            clampedBounds.push_back(Rect::EMPTY_RECT);
+            continue;
+        }
+        const Rect clamped(std::max(b.left, -kMaxCoordinate), std::max(b.top, -kMaxCoordinate),
+                           std::min(b.right, kMaxCoordinate), std::min(b.bottom, kMaxCoordinate));
+        if (clamped != b) {
+            mUnbounded.push_back(i);
+        }
+        if (mExtent.isEmpty()) {
+            mExtent = clamped;
+        } else {
+            mExtent = Rect(std::min(mExtent.left, clamped.left), std::min(mExtent.top, clamped.top),
+                           std::max(mExtent.right, clamped.right),
+                           std::max(mExtent.bottom, clamped.bottom));
+        }
+        clampedBounds.push_back(clamped);
+    }
+    if (mExtent.isEmpty()) {
+        return;
+    }
+    mCellWidth = (mExtent.getWidth() + kCellsPerAxis - 1) / kCellsPerAxis;
+    mCellHeight = (mExtent.getHeight() + kCellsPerAxis - 1) / kCellsPerAxis;
+
+    // Returns the range of cells covered by the bounds, inclusive.
+    auto getCellRange = [this](const Rect& b) {
+        return Rect((b.left - mExtent.left) / mCellWidth, (b.top - mExtent.top) / mCellHeight,
+                    (b.right - 1 - mExtent.left) / mCellWidth,
+                    (b.bottom - 1 - mExtent.top) / mCellHeight);
+    };
+
+    // Count the candidates of each cell, then fill them in window order so that every cell lists
+    // its candidates front to back.
+    mCellOffsets.assign(kCellsPerAxis * kCellsPerAxis + 1, 0);
+    for (const Rect& b : clampedBounds) {
+        if (b.isEmpty()) continue;
+        const Rect cells = getCellRange(b);
+        for (int32_t row = cells.top; row <= cells.bottom; row++) {
+            for (int32_t column = cells.left; column <= cells.right; column++) {
+                mCellOffsets[row * kCellsPerAxis + column + 1]++;
+            }
+        }
+    }
+    for (size_t cell = 1; cell < mCellOffsets.size(); cell++) {
+        mCellOffsets[cell] += mCellOffsets[cell - 1];
+    }
+    mCandidates.resize(mCellOffsets.back());
+    std::vector<uint32_t> fill(mCellOffsets.begin(), mCellOffsets.end() - 1);
+    for (uint32_t i = 0; i < clampedBounds.size(); i++) {
+        const Rect& b = clampedBounds[i];
+        if (b.isEmpty()) continue;
+        const Rect cells = getCellRange(b);
+        for (int32_t row = cells.top; row <= cells.bottom; row++) {
+            for (int32_t column = cells.left; column <= cells.right; column++) {
+                mCandidates[fill[row * kCellsPerAxis + column]++] = i;
+            }
+        }
+    }
+}
+
+std::span<const uint32_t> WindowHitIndex::Grid::getCandidates(int32_t x, int32_t y) const {
+    if (x < mExtent.left || x >= mExtent.right || y < mExtent.top || y >= mExtent.bottom) {
+        return mUnbounded;
+    }
+    const int32_t column = (x - mExtent.left) / mCellWidth;
+    const int32_t row = (y - mExtent.top) / mCellHeight;
+    const size_t cell = row * kCellsPerAxis + column;
+    return std::span<const uint32_t>(mCandidates)
+            .subspan(mCellOffsets[cell], mCellOffsets[cell + 1] - mCellOffsets[cell]);
+}
+
+} // namespace android::inputdispatcher
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <gui/WindowInfo.h>
+#include <ui/Rect.h>
+#include <ui/Region.h>
+#include <ui/Transform.h>
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace android::inputdispatcher {
+
+// A uniform grid over the windows of a display, used to find the windows that may contain a point
+// without scanning all of them.
+//
+// Windows are referred to by their position in the z-ordered (front to back) list the index was
+// built from, and candidates are always returned in that order. Candidates are conservative: the
+// caller still has to perform the exact hit test, but windows that are not candidates cannot
+// contain the point.
+class WindowHitIndex {
+public:
+    WindowHitIndex() = default;
+    WindowHitIndex(const std::vector<sp<gui::WindowInfoHandle>>& windowHandles,
+                   const ui::Transform& displayTransform);
+
+    // Windows whose touchable region may contain the point, in display space. Like the touch hit
+    // test, this is evaluated in the logical display space of the display transform.
+    std::span<const uint32_t> getTouchCandidates(float x, float y) const;
+
+    // Whether the touchable region of the window at the position contains the point, in display
+    // space. The region was transformed into the logical display space when the index was built.
+    bool touchableRegionContains(uint32_t position, float x, float y) const;
+
+    // Windows whose frame may contain the point, in display space.
+    std::span<const uint32_t> getFrameCandidates(int32_t x, int32_t y) const {
+        return mFrameGrid.getCandidates(x, y);
+    }
+
+    // Windows with WATCH_OUTSIDE_TOUCH, which receive touches outside of their bounds.
+    const std::vector<uint32_t>& getWatchOutsideTouchWindows() const {
+        return mWatchOutsideTouchWindows;
+    }
+
+    // Returns the position of the window, or the number of windows if it isn't indexed.
+    uint32_t getPosition(const sp<gui::WindowInfoHandle>& windowHandle) const;
+
+private:
+    class Grid {
+    public:
+        void build(const std::vector<Rect>& bounds);
+        std::span<const uint32_t> getCandidates(int32_t x, int32_t y) const;
+
+    private:
+        static constexpr int32_t kCellsPerAxis = 16;
+        // Bounds beyond this are clamped, so that huge touchable regions don't make the cells
+        // useless. Windows reaching past it are candidates everywhere.
+        static constexpr int32_t kMaxCoordinate = 1 << 16;
+
+        Rect mExtent{0, 0, 0, 0};
+        int32_t mCellWidth = 1;
+        int32_t mCellHeight = 1;
+        // The candidates of cell i are mCandidates[mCellOffsets[i]..mCellOffsets[i + 1]).
+        std::vector<uint32_t> mCellOffsets;
+        std::vector<uint32_t> mCandidates;
+        // Windows whose bounds reach past kMaxCoordinate, the candidates outside of mExtent.
+        std::vector<uint32_t> mUnbounded;
+    };
+
+    // Touchable region of a window in the logical display space, with its bounds kept separately
+    // to reject most points without walking the region.
+    struct TouchableRegion {
+        Rect bounds;
+        Region region;
+    };
+
+    ui::Transform mDisplayTransform;
+    std::vector<TouchableRegion> mTouchableRegions;
+    Grid mTouchGrid;
+    Grid mFrameGrid;
+    std::vector<uint32_t> mWatchOutsideTouchWindows;
+    std::unordered_map<const gui::WindowInfoHandle*, uint32_t> mPositions;
+};
+
+} // namespace android::inputdispatcher
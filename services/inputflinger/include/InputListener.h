@@ -69,6 +69,9 @@ public:
     void notifyVibratorState(const NotifyVibratorStateArgs& args) override;
     void notifyPointerCaptureChanged(const NotifyPointerCaptureChangedArgs& args) override;
 
+    // Queues the motion without copying it, for stages that produce their own args.
+    void notifyMotion(NotifyMotionArgs&& args);
+
     void flush();
 
 private:
@@ -51,9 +51,12 @@
 #include <utils/Log.h>
 #include <utils/Timers.h>
 
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <optional>
 #include <regex>
+#include <thread>
 #include <utility>
 
 #include "EventHub.h"
@@ -81,6 +84,9 @@ static constexpr int32_t FF_WEAK_MAGNITUDE_CHANNEL_IDX = 1;
 
 static constexpr size_t EVENT_BUFFER_SIZE = 256;
 
+// The maximum number of threads used to probe the devices found by a scan.
+static constexpr unsigned int MAX_DEVICE_PROBE_THREADS = 4;
+
 // Mapping for input battery class node IDs lookup.
 // https://www.kernel.org/doc/Documentation/power/power_supply_class.txt
 static const std::unordered_map<std::string, InputBatteryClass> BATTERY_CLASSES =
@@ -1759,6 +1765,8 @@ std::vector<RawEvent> EventHub::getEvents(int timeoutMillis) {
     std::array<input_event, EVENT_BUFFER_SIZE> readBuffer;
 
     std::vector<RawEvent> events;
+    // A full read of a device can push past the limit, but most calls stay within it.
+    events.reserve(EVENT_BUFFER_SIZE);
     bool awoken = false;
     for (;;) {
         nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
@@ -1918,13 +1926,15 @@ std::vector<RawEvent> EventHub::getEvents(int timeoutMillis) {
                     ALOGE("could not get event (wrong size: %d)", readSize);
                 } else {
                     const int32_t deviceId = device->id == mBuiltInKeyboardId ? 0 : device->id;
+                    // All the events of a read were read at the same time.
+                    const nsecs_t readTime = systemTime(SYSTEM_TIME_MONOTONIC);
 
                     const size_t count = size_t(readSize) / sizeof(struct input_event);
                     for (size_t i = 0; i < count; i++) {
                         struct input_event& iev = readBuffer[i];
                         events.push_back({
                                 .when = processEventTimestamp(iev),
-                                .readTime = systemTime(SYSTEM_TIME_MONOTONIC),
+                                .readTime = readTime,
                                 .deviceId = deviceId,
                                 .type = iev.type,
                                 .code = iev.code,
@@ -2150,13 +2160,22 @@ void EventHub::reportDeviceAddedForStatisticsLocked(const InputDeviceIdentifier&
 }
 
 void EventHub::openDeviceLocked(const std::string& devicePath) {
+    std::unique_ptr<Device> device = createDeviceLocked(devicePath);
+    if (device == nullptr) {
+        return;
+    }
+    const status_t keyMapStatus = device->probeLocked();
+    addProbedDeviceLocked(std::move(device), keyMapStatus);
+}
+
+std::unique_ptr<EventHub::Device> EventHub::createDeviceLocked(const std::string& devicePath) {
     // If an input device happens to register around the time when EventHub's constructor runs, it
     // is possible that the same input event node (for example, /dev/input/event3) will be noticed
     // in both 'inotify' callback and also in the 'scanDirLocked' pass. To prevent duplicate devices
     // from getting registered, ensure that this path is not already covered by an existing device.
     for (const auto& [deviceId, device] : mDevices) {
         if (device->path == devicePath) {
-            return; // device was already registered
+            return nullptr; // device was already registered
         }
     }
 
@@ -2167,7 +2186,7 @@ void EventHub::openDeviceLocked(const std::string& devicePath) {
     int fd = open(devicePath.c_str(), O_RDWR | O_CLOEXEC | O_NONBLOCK);
     if (fd < 0) {
         ALOGE("could not open %s, %s\n", devicePath.c_str(), strerror(errno));
-        return;
+        return nullptr;
     }
 
     InputDeviceIdentifier identifier;
@@ -2186,7 +2205,7 @@ void EventHub::openDeviceLocked(const std::string& devicePath) {
         if (identifier.name == item) {
             ALOGI("ignoring event id %s driver %s\n", devicePath.c_str(), item.c_str());
             close(fd);
-            return;
+            return nullptr;
         }
     }
 
@@ -2195,7 +2214,7 @@ void EventHub::openDeviceLocked(const std::string& devicePath) {
     if (ioctl(fd, EVIOCGVERSION, &driverVersion)) {
         ALOGE("could not get driver version for %s, %s\n", devicePath.c_str(), strerror(errno));
         close(fd);
-        return;
+        return nullptr;
     }
 
     // Get device identifier.
@@ -2203,7 +2222,7 @@ void EventHub::openDeviceLocked(const std::string& devicePath) {
     if (ioctl(fd, EVIOCGID, &inputId)) {
         ALOGE("could not get device input id for %s, %s\n", devicePath.c_str(), strerror(errno));
         close(fd);
-        return;
+        return nullptr;
     }
     identifier.bus = inputId.bustype;
     identifier.product = inputId.product;
@@ -2237,9 +2256,6 @@ void EventHub::openDeviceLocked(const std::string& devicePath) {
         }
     }
 
-    // Fill in the descriptor.
-    assignDescriptorLocked(identifier);
-
     // Allocate device.  (The device object takes ownership of the fd at this point.)
     int32_t deviceId = mNextDeviceId++;
     std::unique_ptr<Device> device =
@@ -2255,113 +2271,112 @@ void EventHub::openDeviceLocked(const std::string& devicePath) {
     ALOGV("  name:       \"%s\"\n", identifier.name.c_str());
     ALOGV("  location:   \"%s\"\n", identifier.location.c_str());
     ALOGV("  unique id:  \"%s\"\n", identifier.uniqueId.c_str());
-    ALOGV("  descriptor: \"%s\"\n", identifier.descriptor.c_str());
     ALOGV("  driver:     v%d.%d.%d\n", driverVersion >> 16, (driverVersion >> 8) & 0xff,
           driverVersion & 0xff);
+    return device;
+}
 
+status_t EventHub::Device::probeLocked() {
     // Load the configuration file for the device.
-    device->loadConfigurationLocked();
+    loadConfigurationLocked();
 
     // Figure out the kinds of events the device reports.
-    device->readDeviceBitMask(EVIOCGBIT(EV_KEY, 0), device->keyBitmask);
-    device->readDeviceBitMask(EVIOCGBIT(EV_ABS, 0), device->absBitmask);
-    device->readDeviceBitMask(EVIOCGBIT(EV_REL, 0), device->relBitmask);
-    device->readDeviceBitMask(EVIOCGBIT(EV_SW, 0), device->swBitmask);
-    device->readDeviceBitMask(EVIOCGBIT(EV_LED, 0), device->ledBitmask);
-    device->readDeviceBitMask(EVIOCGBIT(EV_FF, 0), device->ffBitmask);
-    device->readDeviceBitMask(EVIOCGBIT(EV_MSC, 0), device->mscBitmask);
-    device->readDeviceBitMask(EVIOCGPROP(0), device->propBitmask);
+    readDeviceBitMask(EVIOCGBIT(EV_KEY, 0), keyBitmask);
+    readDeviceBitMask(EVIOCGBIT(EV_ABS, 0), absBitmask);
+    readDeviceBitMask(EVIOCGBIT(EV_REL, 0), relBitmask);
+    readDeviceBitMask(EVIOCGBIT(EV_SW, 0), swBitmask);
+    readDeviceBitMask(EVIOCGBIT(EV_LED, 0), ledBitmask);
+    readDeviceBitMask(EVIOCGBIT(EV_FF, 0), ffBitmask);
+    readDeviceBitMask(EVIOCGBIT(EV_MSC, 0), mscBitmask);
+    readDeviceBitMask(EVIOCGPROP(0), propBitmask);
 
     // See if this is a device with keys. This could be full keyboard, or other devices like
     // gamepads, joysticks, and styluses with buttons that should generate key presses.
-    bool haveKeyboardKeys =
-            device->keyBitmask.any(0, BTN_MISC) || device->keyBitmask.any(BTN_WHEEL, KEY_MAX + 1);
-    bool haveGamepadButtons = device->keyBitmask.any(BTN_MISC, BTN_MOUSE) ||
-            device->keyBitmask.any(BTN_JOYSTICK, BTN_DIGI);
-    bool haveStylusButtons = device->keyBitmask.test(BTN_STYLUS) ||
-            device->keyBitmask.test(BTN_STYLUS2) || device->keyBitmask.test(BTN_STYLUS3);
+    bool haveKeyboardKeys = keyBitmask.any(0, BTN_MISC) || keyBitmask.any(BTN_WHEEL, KEY_MAX + 1);
+    bool haveGamepadButtons =
+            keyBitmask.any(BTN_MISC, BTN_MOUSE) || keyBitmask.any(BTN_JOYSTICK, BTN_DIGI);
+    bool haveStylusButtons = keyBitmask.test(BTN_STYLUS) || keyBitmask.test(BTN_STYLUS2) ||
+            keyBitmask.test(BTN_STYLUS3);
     if (haveKeyboardKeys || haveGamepadButtons || haveStylusButtons) {
-        device->classes |= InputDeviceClass::KEYBOARD;
+        classes |= InputDeviceClass::KEYBOARD;
     }
 
     // See if this is a cursor device such as a trackball or mouse.
-    if (device->keyBitmask.test(BTN_MOUSE) && device->relBitmask.test(REL_X) &&
-        device->relBitmask.test(REL_Y)) {
-        device->classes |= InputDeviceClass::CURSOR;
+    if (keyBitmask.test(BTN_MOUSE) && relBitmask.test(REL_X) && relBitmask.test(REL_Y)) {
+        classes |= InputDeviceClass::CURSOR;
     }
 
     // See if the device is specially configured to be of a certain type.
-    if (device->configuration) {
-        std::string deviceType = device->configuration->getString("device.type").value_or("");
+    if (configuration) {
+        std::string deviceType = configuration->getString("device.type").value_or("");
         if (deviceType == "rotaryEncoder") {
-            device->classes |= InputDeviceClass::ROTARY_ENCODER;
+            classes |= InputDeviceClass::ROTARY_ENCODER;
         } else if (deviceType == "externalStylus") {
-            device->classes |= InputDeviceClass::EXTERNAL_STYLUS;
+            classes |= InputDeviceClass::EXTERNAL_STYLUS;
         }
     }
 
     // See if this is a touch pad.
     // Is this a new modern multi-touch driver?
-    if (device->absBitmask.test(ABS_MT_POSITION_X) && device->absBitmask.test(ABS_MT_POSITION_Y)) {
+    if (absBitmask.test(ABS_MT_POSITION_X) && absBitmask.test(ABS_MT_POSITION_Y)) {
         // Some joysticks such as the PS3 controller report axes that conflict
         // with the ABS_MT range.  Try to confirm that the device really is
         // a touch screen.
-        if (device->keyBitmask.test(BTN_TOUCH) || !haveGamepadButtons) {
-            device->classes |= (InputDeviceClass::TOUCH | InputDeviceClass::TOUCH_MT);
-            if (device->propBitmask.test(INPUT_PROP_POINTER) &&
-                !device->keyBitmask.any(BTN_TOOL_PEN, BTN_TOOL_FINGER) && !haveStylusButtons) {
-                device->classes |= InputDeviceClass::TOUCHPAD;
+        if (keyBitmask.test(BTN_TOUCH) || !haveGamepadButtons) {
+            classes |= (InputDeviceClass::TOUCH | InputDeviceClass::TOUCH_MT);
+            if (propBitmask.test(INPUT_PROP_POINTER) &&
+                !keyBitmask.any(BTN_TOOL_PEN, BTN_TOOL_FINGER) && !haveStylusButtons) {
+                classes |= InputDeviceClass::TOUCHPAD;
             }
         }
         // Is this an old style single-touch driver?
-    } else if (device->keyBitmask.test(BTN_TOUCH) && device->absBitmask.test(ABS_X) &&
-               device->absBitmask.test(ABS_Y)) {
-        device->classes |= InputDeviceClass::TOUCH;
+    } else if (keyBitmask.test(BTN_TOUCH) && absBitmask.test(ABS_X) && absBitmask.test(ABS_Y)) {
+        classes |= InputDeviceClass::TOUCH;
         // Is this a stylus that reports contact/pressure independently of touch coordinates?
-    } else if ((device->absBitmask.test(ABS_PRESSURE) || device->keyBitmask.test(BTN_TOUCH)) &&
-               !device->absBitmask.test(ABS_X) && !device->absBitmask.test(ABS_Y)) {
-        device->classes |= InputDeviceClass::EXTERNAL_STYLUS;
+    } else if ((absBitmask.test(ABS_PRESSURE) || keyBitmask.test(BTN_TOUCH)) &&
+               !absBitmask.test(ABS_X) && !absBitmask.test(ABS_Y)) {
+        classes |= InputDeviceClass::EXTERNAL_STYLUS;
     }
 
     // See if this device is a joystick.
     // Assumes that joysticks always have gamepad buttons in order to distinguish them
     // from other devices such as accelerometers that also have absolute axes.
     if (haveGamepadButtons) {
-        auto assumedClasses = device->classes | InputDeviceClass::JOYSTICK;
+        auto assumedClasses = classes | InputDeviceClass::JOYSTICK;
         for (int i = 0; i <= ABS_MAX; i++) {
-            if (device->absBitmask.test(i) &&
+            if (absBitmask.test(i) &&
                 (getAbsAxisUsage(i, assumedClasses).test(InputDeviceClass::JOYSTICK))) {
-                device->classes = assumedClasses;
+                classes = assumedClasses;
                 break;
             }
         }
     }
 
     // Check whether this device is an accelerometer.
-    if (device->propBitmask.test(INPUT_PROP_ACCELEROMETER)) {
-        device->classes |= InputDeviceClass::SENSOR;
+    if (propBitmask.test(INPUT_PROP_ACCELEROMETER)) {
+        classes |= InputDeviceClass::SENSOR;
     }
 
     // Check whether this device has switches.
     for (int i = 0; i <= SW_MAX; i++) {
-        if (device->swBitmask.test(i)) {
-            device->classes |= InputDeviceClass::SWITCH;
+        if (swBitmask.test(i)) {
+            classes |= InputDeviceClass::SWITCH;
             break;
         }
     }
 
     // Check whether this device supports the vibrator.
-    if (device->ffBitmask.test(FF_RUMBLE)) {
-        device->classes |= InputDeviceClass::VIBRATOR;
+    if (ffBitmask.test(FF_RUMBLE)) {
+        classes |= InputDeviceClass::VIBRATOR;
     }
 
     // Configure virtual keys.
-    if ((device->classes.test(InputDeviceClass::TOUCH))) {
+    if ((classes.test(InputDeviceClass::TOUCH))) {
         // Load the virtual keys for the touch screen, if any.
         // We do this now so that we can make sure to load the keymap if necessary.
-        bool success = device->loadVirtualKeyMapLocked();
+        bool success = loadVirtualKeyMapLocked();
         if (success) {
-            device->classes |= InputDeviceClass::KEYBOARD;
+            classes |= InputDeviceClass::KEYBOARD;
         }
     }
 
@@ -2369,50 +2384,60 @@ void EventHub::openDeviceLocked(const std::string& devicePath) {
     // We need to do this for joysticks too because the key layout may specify axes, and for
     // sensor as well because the key layout may specify the axes to sensor data mapping.
     status_t keyMapStatus = NAME_NOT_FOUND;
-    if (device->classes.any(InputDeviceClass::KEYBOARD | InputDeviceClass::JOYSTICK |
-                            InputDeviceClass::SENSOR)) {
+    if (classes.any(InputDeviceClass::KEYBOARD | InputDeviceClass::JOYSTICK |
+                    InputDeviceClass::SENSOR)) {
         // Load the keymap for the device.
-        keyMapStatus = device->loadKeyMapLocked();
+        keyMapStatus = loadKeyMapLocked();
     }
 
     // Configure the keyboard, gamepad or virtual keyboard.
-    if (device->classes.test(InputDeviceClass::KEYBOARD)) {
-        // Register the keyboard as a built-in keyboard if it is eligible.
-        if (!keyMapStatus && mBuiltInKeyboardId == NO_BUILT_IN_KEYBOARD &&
-            isEligibleBuiltInKeyboard(device->identifier, device->configuration.get(),
-                                      &device->keyMap)) {
-            mBuiltInKeyboardId = device->id;
-        }
-
+    if (classes.test(InputDeviceClass::KEYBOARD)) {
         // 'Q' key support = cheap test of whether this is an alpha-capable kbd
-        if (device->hasKeycodeLocked(AKEYCODE_Q)) {
-            device->classes |= InputDeviceClass::ALPHAKEY;
+        if (hasKeycodeLocked(AKEYCODE_Q)) {
+            classes |= InputDeviceClass::ALPHAKEY;
         }
 
         // See if this device has a D-pad.
         if (std::all_of(DPAD_REQUIRED_KEYCODES.begin(), DPAD_REQUIRED_KEYCODES.end(),
-                        [&](int32_t keycode) { return device->hasKeycodeLocked(keycode); })) {
-            device->classes |= InputDeviceClass::DPAD;
+                        [this](int32_t keycode) { return hasKeycodeLocked(keycode); })) {
+            classes |= InputDeviceClass::DPAD;
         }
 
         // See if this device has a gamepad.
         if (std::any_of(GAMEPAD_KEYCODES.begin(), GAMEPAD_KEYCODES.end(),
-                        [&](int32_t keycode) { return device->hasKeycodeLocked(keycode); })) {
-            device->classes |= InputDeviceClass::GAMEPAD;
+                        [this](int32_t keycode) { return hasKeycodeLocked(keycode); })) {
+            classes |= InputDeviceClass::GAMEPAD;
         }
 
         // See if this device has any stylus buttons that we would want to fuse with touch data.
-        if (!device->classes.any(InputDeviceClass::TOUCH | InputDeviceClass::TOUCH_MT) &&
-            !device->classes.any(InputDeviceClass::ALPHAKEY) &&
+        if (!classes.any(InputDeviceClass::TOUCH | InputDeviceClass::TOUCH_MT) &&
+            !classes.any(InputDeviceClass::ALPHAKEY) &&
             std::any_of(STYLUS_BUTTON_KEYCODES.begin(), STYLUS_BUTTON_KEYCODES.end(),
-                        [&](int32_t keycode) { return device->hasKeycodeLocked(keycode); })) {
-            device->classes |= InputDeviceClass::EXTERNAL_STYLUS;
+                        [this](int32_t keycode) { return hasKeycodeLocked(keycode); })) {
+            classes |= InputDeviceClass::EXTERNAL_STYLUS;
         }
     }
 
+    return keyMapStatus;
+}
+
+void EventHub::addProbedDeviceLocked(std::unique_ptr<Device> device, status_t keyMapStatus) {
+    // Fill in the descriptor. It has to be unique among the devices added so far, so it is only
+    // assigned once the devices before this one have been added.
+    assignDescriptorLocked(device->identifier);
+    ALOGV("  descriptor: \"%s\"\n", device->identifier.descriptor.c_str());
+
+    // Register the keyboard as a built-in keyboard if it is eligible.
+    if (device->classes.test(InputDeviceClass::KEYBOARD) && !keyMapStatus &&
+        mBuiltInKeyboardId == NO_BUILT_IN_KEYBOARD &&
+        isEligibleBuiltInKeyboard(device->identifier, device->configuration.get(),
+                                  &device->keyMap)) {
+        mBuiltInKeyboardId = device->id;
+    }
+
     // If the device isn't recognized as something we handle, don't monitor it.
     if (device->classes == ftl::Flags<InputDeviceClass>(0)) {
-        ALOGV("Dropping device: id=%d, path='%s', name='%s'", deviceId, devicePath.c_str(),
+        ALOGV("Dropping device: id=%d, path='%s', name='%s'", device->id, device->path.c_str(),
               device->identifier.name.c_str());
         return;
     }
@@ -2454,10 +2479,10 @@ void EventHub::openDeviceLocked(const std::string& devicePath) {
 
     ALOGI("New device: id=%d, fd=%d, path='%s', name='%s', classes=%s, "
           "configuration='%s', keyLayout='%s', keyCharacterMap='%s', builtinKeyboard=%s, ",
-          deviceId, fd, devicePath.c_str(), device->identifier.name.c_str(),
+          device->id, device->fd, device->path.c_str(), device->identifier.name.c_str(),
           device->classes.string().c_str(), device->configurationFile.c_str(),
           device->keyMap.keyLayoutFile.c_str(), device->keyMap.keyCharacterMapFile.c_str(),
-          toString(mBuiltInKeyboardId == deviceId));
+          toString(mBuiltInKeyboardId == device->id));
 
     addDeviceLocked(std::move(device));
 }
@@ -2728,8 +2753,42 @@ void EventHub::handleNotifyEventLocked(const inotify_event& event) {
 }
 
 status_t EventHub::scanDirLocked(const std::string& dirname) {
+    // Create the devices in directory order, which assigns their ids as opening them one at a time
+    // would.
+    std::vector<std::unique_ptr<Device>> devices;
     for (const auto& entry : std::filesystem::directory_iterator(dirname)) {
-        openDeviceLocked(entry.path());
+        std::unique_ptr<Device> device = createDeviceLocked(entry.path());
+        if (device != nullptr) {
+            devices.push_back(std::move(device));
+        }
+    }
+
+    // Probing loads the configuration, key layout and key character map files of a device and
+    // only touches that device, so the devices are probed on a few threads.
+    std::vector<status_t> keyMapStatuses(devices.size());
+    const size_t threadCount =
+            std::min<size_t>(devices.size(),
+                             std::clamp(std::thread::hardware_concurrency(), 1u,
+                                        MAX_DEVICE_PROBE_THREADS));
+    std::atomic<size_t> nextDevice = 0;
+    auto probeDevices = [&]() {
+        for (size_t i = nextDevice++; i < devices.size(); i = nextDevice++) {
+            keyMapStatuses[i] = devices[i]->probeLocked();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; i++) {
+        threads.emplace_back(probeDevices);
+    }
+    probeDevices();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // Add the devices in directory order, so that descriptors, the built-in keyboard and
+    // controller numbers are assigned as if they had been opened one at a time.
+    for (size_t i = 0; i < devices.size(); i++) {
+        addProbedDeviceLocked(std::move(devices[i]), keyMapStatuses[i]);
     }
     return 0;
 }
@@ -202,9 +202,8 @@ std::optional<TouchVideoFrame> TouchVideoDevice::readFrame() {
               static_cast<long long>(buf.timestamp.tv_sec),
               static_cast<long long>(buf.timestamp.tv_usec));
     }
-    std::vector<int16_t> data(mHeight * mWidth);
     const int16_t* readFrom = mReadLocations[buf.index];
-    std::copy(readFrom, readFrom + mHeight * mWidth, data.begin());
+    std::vector<int16_t> data(readFrom, readFrom + mHeight * mWidth);
     TouchVideoFrame frame(mHeight, mWidth, std::move(data), buf.timestamp);
 
     result = ioctl(mFd.get(), VIDIOC_QBUF, &buf);
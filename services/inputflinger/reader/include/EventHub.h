@@ -653,12 +653,21 @@ private:
         void setLedForControllerLocked();
         status_t mapLed(int32_t led, int32_t* outScanCode) const;
         void setLedStateLocked(int32_t led, bool on);
+        // Loads the configuration files of the device and determines its classes. Only the
+        // device itself is accessed, so devices can be probed concurrently. Returns the status
+        // of loading the key map.
+        status_t probeLocked();
     };
 
     /**
      * Create a new device for the provided path.
      */
     void openDeviceLocked(const std::string& devicePath) REQUIRES(mLock);
+    // Opening a device is split into creating, probing and adding it, so that the devices found
+    // by a scan can be probed in parallel.
+    std::unique_ptr<Device> createDeviceLocked(const std::string& devicePath) REQUIRES(mLock);
+    void addProbedDeviceLocked(std::unique_ptr<Device> device, status_t keyMapStatus)
+            REQUIRES(mLock);
     void openVideoDeviceLocked(const std::string& devicePath) REQUIRES(mLock);
     /**
      * Try to associate a video device with an input device. If the association succeeds,
@@ -1013,6 +1013,7 @@ void TouchInputMapper::configureInputDevice(nsecs_t when, bool* outResetNeeded)
             mRawToDisplay.set(-mRawPointerAxes.x.minValue, -mRawPointerAxes.y.minValue);
             mRawToRotatedDisplay = mRawToDisplay;
         }
+        updateCalibratedRawToDisplay();
     }
 
     // If moving between pointer modes, need to reset some state.
@@ -1373,6 +1374,15 @@ void TouchInputMapper::dumpAffineTransformation(std::string& dump) {
 void TouchInputMapper::updateAffineTransformation() {
     mAffineTransform = getPolicy()->getTouchAffineTransformation(getDeviceContext().getDescriptor(),
                                                                  mInputDeviceOrientation);
+    updateCalibratedRawToDisplay();
+}
+
+void TouchInputMapper::updateCalibratedRawToDisplay() {
+    ui::Transform affineTransform;
+    affineTransform.set({mAffineTransform.x_scale, mAffineTransform.x_ymix,
+                         mAffineTransform.x_offset, mAffineTransform.y_xmix,
+                         mAffineTransform.y_scale, mAffineTransform.y_offset, 0, 0, 1});
+    mCalibratedRawToDisplay = mRawToDisplay * affineTransform;
 }
 
 std::list<NotifyArgs> TouchInputMapper::reset(nsecs_t when) {
@@ -2290,6 +2300,11 @@ void TouchInputMapper::cookPointerData() {
         mCurrentCookedState.buttonState = mCurrentRawState.buttonState;
     }
 
+    // Summed sizes are divided between the touching pointers of the sync.
+    const uint32_t touchingCount = mCurrentRawState.rawPointerData.touchingIdBits.count();
+    const bool divideSummedSize =
+            mCalibration.sizeIsSummed && *mCalibration.sizeIsSummed && touchingCount > 1;
+
     // Walk through the the active pointers and map device coordinates onto
     // display coordinates and adjust for display orientation.
     for (uint32_t i = 0; i < currentPointerCount; i++) {
@@ -2332,15 +2347,12 @@ void TouchInputMapper::cookPointerData() {
                     size = 0;
                 }
 
-                if (mCalibration.sizeIsSummed && *mCalibration.sizeIsSummed) {
-                    uint32_t touchingCount = mCurrentRawState.rawPointerData.touchingIdBits.count();
-                    if (touchingCount > 1) {
-                        touchMajor /= touchingCount;
-                        touchMinor /= touchingCount;
-                        toolMajor /= touchingCount;
-                        toolMinor /= touchingCount;
-                        size /= touchingCount;
-                    }
+                if (divideSummedSize) {
+                    touchMajor /= touchingCount;
+                    touchMinor /= touchingCount;
+                    toolMajor /= touchingCount;
+                    toolMinor /= touchingCount;
+                    size /= touchingCount;
                 }
 
                 if (mCalibration.sizeCalibration == Calibration::SizeCalibration::GEOMETRIC) {
@@ -2435,11 +2447,10 @@ void TouchInputMapper::cookPointerData() {
         }
 
         // Adjust X,Y coords for device calibration and convert to the natural display coordinates.
-        vec2 transformed = {in.x, in.y};
-        mAffineTransform.applyTo(transformed.x /*byRef*/, transformed.y /*byRef*/);
-        transformed = mRawToDisplay.transform(transformed);
+        const vec2 transformed = mCalibratedRawToDisplay.transform(vec2{in.x, in.y});
 
-        // Write output coords.
+        // Write output coords. The axes are set in increasing order, so that each one is
+        // appended to the coords without moving the values already set.
         PointerCoords& out = mCurrentCookedState.cookedPointerData.pointerCoords[i];
         out.clear();
         out.setAxisValue(AMOTION_EVENT_AXIS_X, transformed.x);
@@ -2448,11 +2459,11 @@ void TouchInputMapper::cookPointerData() {
         out.setAxisValue(AMOTION_EVENT_AXIS_SIZE, size);
         out.setAxisValue(AMOTION_EVENT_AXIS_TOUCH_MAJOR, touchMajor);
         out.setAxisValue(AMOTION_EVENT_AXIS_TOUCH_MINOR, touchMinor);
-        out.setAxisValue(AMOTION_EVENT_AXIS_ORIENTATION, orientation);
-        out.setAxisValue(AMOTION_EVENT_AXIS_TILT, tilt);
-        out.setAxisValue(AMOTION_EVENT_AXIS_DISTANCE, distance);
         out.setAxisValue(AMOTION_EVENT_AXIS_TOOL_MAJOR, toolMajor);
         out.setAxisValue(AMOTION_EVENT_AXIS_TOOL_MINOR, toolMinor);
+        out.setAxisValue(AMOTION_EVENT_AXIS_ORIENTATION, orientation);
+        out.setAxisValue(AMOTION_EVENT_AXIS_DISTANCE, distance);
+        out.setAxisValue(AMOTION_EVENT_AXIS_TILT, tilt);
 
         // Write output relative fields if applicable.
         uint32_t id = in.id;
@@ -391,6 +391,7 @@ protected:
     virtual void resolveCalibration();
     virtual void dumpCalibration(std::string& dump);
     virtual void updateAffineTransformation();
+    void updateCalibratedRawToDisplay();
     virtual void dumpAffineTransformation(std::string& dump);
     virtual void resolveExternalStylusPresence();
     virtual bool hasStylus() const = 0;
@@ -421,6 +422,10 @@ private:
     // coordinate space. InputReader generates events in the un-rotated display's coordinate space.
     ui::Transform mRawToDisplay;
 
+    // mRawToDisplay applied after the location calibration of mAffineTransform. Raw pointer
+    // locations are mapped with this single transform, it is recomputed when either changes.
+    ui::Transform mCalibratedRawToDisplay;
+
     // The transform that maps the input device's raw coordinate space to the rotated display's
     // coordinate space. This used to perform hit-testing of raw events with the physical frame in
     // the rotated coordinate space. See mPhysicalFrameInRotatedDisplay.
@@ -22,6 +22,7 @@
 #include <limits>
 #include <map>
 #include <optional>
+#include <utility>
 
 #include <android-base/stringprintf.h>
 #include <android/input.h>
@@ -445,7 +446,9 @@ std::list<NotifyArgs> TouchpadInputMapper::process(const RawEvent* rawEvent) {
     std::optional<SelfContainedHardwareState> state = mStateConverter.processRawEvent(rawEvent);
     if (state) {
         updatePalmDetectionMetrics();
-        return sendHardwareState(rawEvent->when, rawEvent->readTime, *state);
+        std::list<NotifyArgs> out = sendHardwareState(rawEvent->when, rawEvent->readTime, *state);
+        mStateConverter.recycle(std::move(*state));
+        return out;
     } else {
         return {};
     }
@@ -474,11 +477,11 @@ void TouchpadInputMapper::updatePalmDetectionMetrics() {
             MetricsAccumulator::getInstance().recordFinger(mMetricsId);
         }
     }
-    mLastFrameTrackingIds = currentTrackingIds;
+    mLastFrameTrackingIds = std::move(currentTrackingIds);
 }
 
 std::list<NotifyArgs> TouchpadInputMapper::sendHardwareState(nsecs_t when, nsecs_t readTime,
-                                                             SelfContainedHardwareState schs) {
+                                                             SelfContainedHardwareState& schs) {
     ALOGD_IF(DEBUG_TOUCHPAD_GESTURES, "New hardware state: %s", schs.state.String().c_str());
     mProcessing = true;
     mGestureInterpreter->PushHardwareState(&schs.state);
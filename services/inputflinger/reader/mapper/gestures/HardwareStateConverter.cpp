@@ -20,6 +20,7 @@
 #include "gestures/HardwareStateConverter.h"
 
 #include <chrono>
+#include <utility>
 #include <vector>
 
 #include <linux/input-event-codes.h>
@@ -75,10 +76,11 @@ SelfContainedHardwareState HardwareStateConverter::produceHardwareState(nsecs_t
         schs.state.buttons_down |= GESTURES_BUTTON_FORWARD;
     }
 
+    schs.fingers = std::move(mSpareFingers);
     schs.fingers.clear();
     size_t numPalms = 0;
     for (size_t i = 0; i < mMotionAccumulator.getSlotCount(); i++) {
-        MultiTouchMotionAccumulator::Slot slot = mMotionAccumulator.getSlot(i);
+        const MultiTouchMotionAccumulator::Slot& slot = mMotionAccumulator.getSlot(i);
         if (!slot.isInUse()) {
             continue;
         }
@@ -107,6 +109,10 @@ SelfContainedHardwareState HardwareStateConverter::produceHardwareState(nsecs_t
     return schs;
 }
 
+void HardwareStateConverter::recycle(SelfContainedHardwareState&& schs) {
+    mSpareFingers = std::move(schs.fingers);
+}
+
 void HardwareStateConverter::reset() {
     mCursorButtonAccumulator.reset(mDeviceContext);
     mTouchButtonAccumulator.reset();
@@ -18,6 +18,7 @@
 
 #include <optional>
 #include <set>
+#include <vector>
 
 #include <utils/Timers.h>
 
@@ -47,6 +48,10 @@ public:
     std::optional<SelfContainedHardwareState> processRawEvent(const RawEvent* event);
     void reset();
 
+    // Hands back a state returned by processRawEvent once it is no longer needed, so that its
+    // finger storage can be reused for the next state instead of being reallocated.
+    void recycle(SelfContainedHardwareState&& schs);
+
 private:
     SelfContainedHardwareState produceHardwareState(nsecs_t when);
 
@@ -55,6 +60,7 @@ private:
     MultiTouchMotionAccumulator& mMotionAccumulator;
     TouchButtonAccumulator mTouchButtonAccumulator;
     int32_t mMscTimestamp = 0;
+    std::vector<FingerState> mSpareFingers;
 };
 
 } // namespace android
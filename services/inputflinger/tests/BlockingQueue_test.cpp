@@ -59,6 +59,35 @@ TEST(BlockingQueueTest, Queue_ReachesCapacity) {
     ASSERT_FALSE(queue.push(4)) << "Queue should reach capacity at size " << capacity;
 }
 
+/**
+ * When full, pushEvictingOldest makes room by removing the oldest matching element.
+ */
+TEST(BlockingQueueTest, Queue_EvictsOldestMatchingElementWhenFull) {
+    constexpr size_t capacity = 4;
+    BlockingQueue<int> queue(capacity);
+    const auto isEven = [](const int& value) { return value % 2 == 0; };
+
+    ASSERT_TRUE(queue.pushEvictingOldest(1, isEven));
+    ASSERT_TRUE(queue.pushEvictingOldest(2, isEven));
+    ASSERT_TRUE(queue.pushEvictingOldest(3, isEven));
+    ASSERT_TRUE(queue.pushEvictingOldest(4, isEven));
+    ASSERT_EQ(capacity, queue.size());
+
+    // Evicts 2, then 4.
+    ASSERT_TRUE(queue.pushEvictingOldest(5, isEven));
+    ASSERT_TRUE(queue.pushEvictingOldest(7, isEven));
+    ASSERT_EQ(capacity, queue.size());
+
+    // Nothing left to evict.
+    ASSERT_FALSE(queue.pushEvictingOldest(9, isEven));
+
+    ASSERT_EQ(1, queue.pop());
+    ASSERT_EQ(3, queue.pop());
+    ASSERT_EQ(5, queue.pop());
+    ASSERT_EQ(7, queue.pop());
+    ASSERT_EQ(0u, queue.size());
+}
+
 /**
  * Make sure the queue maintains FIFO order.
  * Add elements and remove them, and check the order.
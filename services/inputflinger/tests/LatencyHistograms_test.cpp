@@ -0,0 +1,131 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../dispatcher/LatencyHistograms.h"
+
+#include <binder/Binder.h>
+#include <gtest/gtest.h>
+
+namespace android::inputdispatcher {
+
+namespace {
+
+constexpr int32_t DEVICE_ID = 3;
+
+constexpr size_t index(LatencyStage stage) {
+    return static_cast<size_t>(stage);
+}
+
+InputEventTimeline createTimeline(const sp<IBinder>& connectionToken, nsecs_t readTime,
+                                  nsecs_t deliveryTime, nsecs_t consumeTime, nsecs_t presentTime) {
+    InputEventTimeline timeline(/*isDown=*/false, /*eventTime=*/readTime, readTime, DEVICE_ID);
+    ConnectionTimeline connectionTimeline(deliveryTime, consumeTime, /*finishTime=*/consumeTime);
+    std::array<nsecs_t, GraphicsTimeline::SIZE> graphicsTimeline;
+    graphicsTimeline[GraphicsTimeline::GPU_COMPLETED_TIME] = presentTime;
+    graphicsTimeline[GraphicsTimeline::PRESENT_TIME] = presentTime;
+    connectionTimeline.setGraphicsTimeline(std::move(graphicsTimeline));
+    timeline.connectionTimelines.emplace(connectionToken, std::move(connectionTimeline));
+    return timeline;
+}
+
+} // namespace
+
+TEST(LatencyHistogramTest, RecordsIntoPowerOfTwoMillisecondBuckets) {
+    LatencyHistogram histogram;
+    histogram.record(ms2ns(0));
+    histogram.record(us2ns(999));
+    histogram.record(ms2ns(1));
+    histogram.record(ms2ns(3));
+    histogram.record(ms2ns(5000));
+    // Negative latencies come from bad app data, and are dropped.
+    histogram.record(-1);
+
+    ASSERT_EQ(5u, histogram.getCount());
+    ASSERT_EQ(2u, histogram.getBucketCount(0));
+    ASSERT_EQ(1u, histogram.getBucketCount(1));
+    ASSERT_EQ(1u, histogram.getBucketCount(2));
+    ASSERT_EQ(1u, histogram.getBucketCount(LatencyHistogram::BUCKET_COUNT - 1));
+
+    ASSERT_EQ(ms2ns(1), histogram.getPercentileUpperBound(0.3f));
+    ASSERT_EQ(ms2ns(4), histogram.getPercentileUpperBound(0.7f));
+    ASSERT_EQ(ms2ns(1024), histogram.getPercentileUpperBound(1.0f));
+}
+
+TEST(LatencyHistogramTest, EmptyHistogramHasNoPercentiles) {
+    LatencyHistogram histogram;
+    ASSERT_EQ(-1, histogram.getPercentileUpperBound(0.5f));
+}
+
+TEST(LatencyHistogramsTest, RecordsEachStagePerDeviceAndConnection) {
+    LatencyHistograms histograms;
+    const sp<IBinder> connection = sp<BBinder>::make();
+    histograms.processTimeline(createTimeline(connection, /*readTime=*/ms2ns(10),
+                                              /*deliveryTime=*/ms2ns(11),
+                                              /*consumeTime=*/ms2ns(14),
+                                              /*presentTime=*/ms2ns(30)));
+
+    for (const LatencyHistograms::StageHistograms* stages :
+         {&histograms.getTotal(), histograms.getForDevice(DEVICE_ID),
+          histograms.getForConnection(connection)}) {
+        ASSERT_NE(nullptr, stages);
+        // 1ms, 3ms and 16ms
+        ASSERT_EQ(1u, (*stages)[index(LatencyStage::READ_TO_DISPATCH)].getBucketCount(1));
+        ASSERT_EQ(1u, (*stages)[index(LatencyStage::DISPATCH_TO_CONSUME)].getBucketCount(2));
+        ASSERT_EQ(1u, (*stages)[index(LatencyStage::CONSUME_TO_PRESENT)].getBucketCount(5));
+    }
+}
+
+TEST(LatencyHistogramsTest, IncompleteTimelineSkipsMissingStages) {
+    LatencyHistograms histograms;
+    InputEventTimeline timeline(/*isDown=*/true, /*eventTime=*/1, /*readTime=*/2, DEVICE_ID);
+    timeline.connectionTimelines.emplace(sp<BBinder>::make(),
+                                         ConnectionTimeline(/*deliveryTime=*/3, /*consumeTime=*/4,
+                                                            /*finishTime=*/5));
+    histograms.processTimeline(timeline);
+
+    const LatencyHistograms::StageHistograms& total = histograms.getTotal();
+    ASSERT_EQ(1u, total[index(LatencyStage::READ_TO_DISPATCH)].getCount());
+    ASSERT_EQ(1u, total[index(LatencyStage::DISPATCH_TO_CONSUME)].getCount());
+    ASSERT_EQ(0u, total[index(LatencyStage::CONSUME_TO_PRESENT)].getCount());
+}
+
+TEST(LatencyHistogramsTest, RemovedConnectionIsForgotten) {
+    LatencyHistograms histograms;
+    const sp<IBinder> connection = sp<BBinder>::make();
+    histograms.processTimeline(createTimeline(connection, /*readTime=*/1, /*deliveryTime=*/2,
+                                              /*consumeTime=*/3, /*presentTime=*/4));
+    ASSERT_NE(nullptr, histograms.getForConnection(connection));
+
+    histograms.removeConnection(connection);
+    ASSERT_EQ(nullptr, histograms.getForConnection(connection));
+    ASSERT_EQ(1u, histograms.getTotal()[index(LatencyStage::READ_TO_DISPATCH)].getCount());
+}
+
+TEST(LatencyHistogramsTest, TrackedConnectionsAreBounded) {
+    LatencyHistograms histograms;
+    std::vector<sp<IBinder>> connections;
+    for (size_t i = 0; i <= LatencyHistograms::MAX_TRACKED_CONNECTIONS; i++) {
+        connections.push_back(sp<BBinder>::make());
+        histograms.processTimeline(createTimeline(connections.back(), /*readTime=*/1,
+                                                  /*deliveryTime=*/2, /*consumeTime=*/3,
+                                                  /*presentTime=*/4));
+    }
+    ASSERT_EQ(nullptr, histograms.getForConnection(connections.back()));
+    ASSERT_EQ(LatencyHistograms::MAX_TRACKED_CONNECTIONS + 1,
+              histograms.getTotal()[index(LatencyStage::READ_TO_DISPATCH)].getCount());
+}
+
+} // namespace android::inputdispatcher
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "../dispatcher/WindowHitIndex.h"
+
+// atest inputflinger_tests:WindowHitIndexTest
+
+using android::gui::WindowInfo;
+using android::gui::WindowInfoHandle;
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+namespace android::inputdispatcher {
+
+namespace {
+
+class FakeWindowHandle : public WindowInfoHandle {
+public:
+    FakeWindowHandle(const std::string& name, const Rect& frame) {
+        mInfo.name = name;
+        mInfo.frameLeft = frame.left;
+        mInfo.frameTop = frame.top;
+        mInfo.frameRight = frame.right;
+        mInfo.frameBottom = frame.bottom;
+        mInfo.touchableRegion = Region(frame);
+    }
+
+    void setTouchableRegion(const Region& region) { mInfo.touchableRegion = region; }
+
+    void setWatchOutsideTouch(bool watchOutsideTouch) {
+        mInfo.setInputConfig(WindowInfo::InputConfig::WATCH_OUTSIDE_TOUCH, watchOutsideTouch);
+    }
+};
+
+std::vector<uint32_t> toVector(std::span<const uint32_t> candidates) {
+    return std::vector<uint32_t>(candidates.begin(), candidates.end());
+}
+
+} // namespace
+
+TEST(WindowHitIndexTest, CandidatesAreNearThePoint) {
+    std::vector<sp<WindowInfoHandle>> windows;
+    windows.push_back(sp<FakeWindowHandle>::make("TopLeft", Rect(0, 0, 100, 100)));
+    windows.push_back(sp<FakeWindowHandle>::make("BottomRight", Rect(900, 1900, 1000, 2000)));
+    WindowHitIndex index(windows, ui::Transform());
+
+    EXPECT_THAT(toVector(index.getFrameCandidates(50, 50)), ElementsAre(0u));
+    EXPECT_THAT(toVector(index.getFrameCandidates(950, 1950)), ElementsAre(1u));
+    EXPECT_THAT(toVector(index.getFrameCandidates(500, 1000)), IsEmpty());
+    EXPECT_THAT(toVector(index.getTouchCandidates(50, 50)), ElementsAre(0u));
+    EXPECT_THAT(toVector(index.getTouchCandidates(950, 1950)), ElementsAre(1u));
+}
+
+TEST(WindowHitIndexTest, CandidatesAreInZOrder) {
+    std::vector<sp<WindowInfoHandle>> windows;
+    windows.push_back(sp<FakeWindowHandle>::make("Dialog", Rect(200, 200, 800, 800)));
+    windows.push_back(sp<FakeWindowHandle>::make("App", Rect(0, 0, 1000, 1000)));
+    windows.push_back(sp<FakeWindowHandle>::make("Wallpaper", Rect(0, 0, 1000, 1000)));
+    WindowHitIndex index(windows, ui::Transform());
+
+    EXPECT_THAT(toVector(index.getFrameCandidates(500, 500)), ElementsAre(0u, 1u, 2u));
+    EXPECT_THAT(toVector(index.getTouchCandidates(500, 500)), ElementsAre(0u, 1u, 2u));
+    EXPECT_EQ(1u, index.getPosition(windows[1]));
+    EXPECT_EQ(3u, index.getPosition(sp<FakeWindowHandle>::make("Other", Rect(0, 0, 1, 1))));
+}
+
+TEST(WindowHitIndexTest, HugeWindowsAreCandidatesEverywhere) {
+    std::vector<sp<WindowInfoHandle>> windows;
+    windows.push_back(sp<FakeWindowHandle>::make("Small", Rect(0, 0, 100, 100)));
+    windows.push_back(sp<FakeWindowHandle>::make("Huge", Rect(-1000000, -1000000, 1000000,
+                                                              1000000)));
+    WindowHitIndex index(windows, ui::Transform());
+
+    EXPECT_THAT(toVector(index.getFrameCandidates(50, 50)), ElementsAre(0u, 1u));
+    EXPECT_THAT(toVector(index.getFrameCandidates(500000, -500000)), ElementsAre(1u));
+    EXPECT_THAT(toVector(index.getTouchCandidates(500000, -500000)), ElementsAre(1u));
+}
+
+TEST(WindowHitIndexTest, TouchCandidatesUseTheDisplayTransform) {
+    std::vector<sp<WindowInfoHandle>> windows;
+    windows.push_back(sp<FakeWindowHandle>::make("Window", Rect(0, 0, 100, 100)));
+    ui::Transform transform;
+    transform.set(1000, 0);
+    WindowHitIndex index(windows, transform);
+
+    EXPECT_THAT(toVector(index.getTouchCandidates(50, 50)), ElementsAre(0u));
+    EXPECT_THAT(toVector(index.getTouchCandidates(500, 50)), IsEmpty());
+}
+
+TEST(WindowHitIndexTest, TouchableRegionContainsUsesTheTransformedRegion) {
+    std::vector<sp<WindowInfoHandle>> windows;
+    sp<FakeWindowHandle> window = sp<FakeWindowHandle>::make("Window", Rect(0, 0, 100, 100));
+    // An L-shaped region, its bounds contain points that the region doesn't.
+    Region region(Rect(0, 0, 100, 10));
+    region.orSelf(Rect(0, 0, 10, 100));
+    window->setTouchableRegion(region);
+    windows.push_back(window);
+    ui::Transform transform;
+    transform.set(1000, 0);
+    WindowHitIndex index(windows, transform);
+
+    EXPECT_TRUE(index.touchableRegionContains(0, 50, 5));
+    EXPECT_TRUE(index.touchableRegionContains(0, 5, 50));
+    EXPECT_TRUE(index.touchableRegionContains(0, 9.9f, 99.9f));
+    EXPECT_FALSE(index.touchableRegionContains(0, 50, 50));
+    EXPECT_FALSE(index.touchableRegionContains(0, 100, 5));
+    EXPECT_FALSE(index.touchableRegionContains(0, -0.5f, 5));
+}
+
+TEST(WindowHitIndexTest, ListsWatchOutsideTouchWindows) {
+    std::vector<sp<WindowInfoHandle>> windows;
+    sp<FakeWindowHandle> watcher = sp<FakeWindowHandle>::make("Watcher", Rect(0, 0, 10, 10));
+    watcher->setWatchOutsideTouch(true);
+    windows.push_back(sp<FakeWindowHandle>::make("Window", Rect(0, 0, 100, 100)));
+    windows.push_back(watcher);
+    WindowHitIndex index(windows, ui::Transform());
+
+    EXPECT_THAT(index.getWatchOutsideTouchWindows(), ElementsAre(1u));
+}
+
+TEST(WindowHitIndexTest, EmptyIndexHasNoCandidates) {
+    WindowHitIndex index;
+
+    EXPECT_THAT(toVector(index.getFrameCandidates(0, 0)), IsEmpty());
+    EXPECT_THAT(toVector(index.getTouchCandidates(0, 0)), IsEmpty());
+    EXPECT_THAT(index.getWatchOutsideTouchWindows(), IsEmpty());
+}
+
+} // namespace android::inputdispatcher
@@ -65,7 +65,8 @@ extern "C" int LLVMFuzzerTestOneInput(uint8_t* data, size_t size) {
                     int32_t isDown = fdp.ConsumeBool();
                     nsecs_t eventTime = fdp.ConsumeIntegral<nsecs_t>();
                     nsecs_t readTime = fdp.ConsumeIntegral<nsecs_t>();
-                    tracker.trackListener(inputEventId, isDown, eventTime, readTime);
+                    int32_t deviceId = fdp.ConsumeIntegral<int32_t>();
+                    tracker.trackListener(inputEventId, isDown, eventTime, readTime, deviceId);
                 },
                 [&]() -> void {
                     int32_t inputEventId = fdp.ConsumeIntegral<int32_t>();
@@ -67,6 +67,7 @@ void PowerHalController::init() {
 std::shared_ptr<HalWrapper> PowerHalController::initHal() {
     std::lock_guard<std::mutex> lock(mConnectedHalMutex);
     if (mConnectedHal == nullptr) {
+        clearLastRequests();
         mConnectedHal = mHalConnector->connect();
         if (mConnectedHal == nullptr) {
             // Unable to connect to Power HAL service. Fallback to default.
@@ -86,19 +87,68 @@ HalResult<T> PowerHalController::processHalResult(HalResult<T> result, const cha
         // Drop Power HAL handle. This will force future api calls to reconnect.
         mConnectedHal = nullptr;
         mHalConnector->reset();
+        clearLastRequests();
     }
     return result;
 }
 
+void PowerHalController::clearLastRequests() {
+    mRequestsGeneration++;
+}
+
 HalResult<void> PowerHalController::setBoost(Boost boost, int32_t durationMs) {
+    if (durationMs <= 0) {
+        std::shared_ptr<HalWrapper> handle = initHal();
+        auto result = handle->setBoost(boost, durationMs);
+        return processHalResult(result, "setBoost");
+    }
+
+    BoostRequest* last;
+    {
+        std::lock_guard<std::mutex> lock(mRequestsMutex);
+        last = &mLastBoosts[boost];
+    }
+    std::lock_guard<std::mutex> lock(last->mutex);
+    const auto now = std::chrono::steady_clock::now();
+    // Skipping the boost may end it earlier than requested, so only do so while most of the
+    // previous boost is still ahead.
+    if (last->generation == mRequestsGeneration && last->durationMs == durationMs &&
+        now - last->sentTime < std::chrono::milliseconds(durationMs) / 2) {
+        ALOGV("Skipped setBoost %s because it is already active", toString(boost).c_str());
+        return HalResult<void>::ok();
+    }
+
     std::shared_ptr<HalWrapper> handle = initHal();
+    const uint64_t generation = mRequestsGeneration;
     auto result = handle->setBoost(boost, durationMs);
+    if (result.isOk()) {
+        last->durationMs = durationMs;
+        last->sentTime = now;
+        last->generation = generation;
+    }
     return processHalResult(result, "setBoost");
 }
 
 HalResult<void> PowerHalController::setMode(Mode mode, bool enabled) {
+    ModeRequest* last;
+    {
+        std::lock_guard<std::mutex> lock(mRequestsMutex);
+        last = &mLastModes[mode];
+    }
+    std::lock_guard<std::mutex> lock(last->mutex);
+    if (last->generation == mRequestsGeneration && last->enabled == enabled) {
+        ALOGV("Skipped setMode %s because it is already %s", toString(mode).c_str(),
+              enabled ? "enabled" : "disabled");
+        return HalResult<void>::ok();
+    }
+
     std::shared_ptr<HalWrapper> handle = initHal();
+    const uint64_t generation = mRequestsGeneration;
     auto result = handle->setMode(mode, enabled);
+    if (result.isOk()) {
+        last->enabled = enabled;
+        last->generation = generation;
+    }
     return processHalResult(result, "setMode");
 }
 
@@ -103,14 +103,37 @@ static void BM_PowerHalControllerBenchmarks_setMode(benchmark::State& state) {
     runBenchmark(state, &PowerHalController::setMode, mode, false);
 }
 
+// Repeats the same request, so this measures the caller-side cost of a skipped redundant call.
 static void BM_PowerHalControllerBenchmarks_setModeCached(benchmark::State& state) {
     Mode mode = static_cast<Mode>(state.range(0));
     runCachedBenchmark(state, &PowerHalController::setMode, mode, false);
 }
 
+// Alternates the requested state, so that every call reaches the HAL.
+static void BM_PowerHalControllerBenchmarks_setModeToggled(benchmark::State& state) {
+    Mode mode = static_cast<Mode>(state.range(0));
+    PowerHalController controller;
+    // First call out of test, to cache HAL service and isSupported result.
+    controller.setMode(mode, false);
+
+    bool enabled = true;
+    while (state.KeepRunning()) {
+        HalResult<void> ret = controller.setMode(mode, enabled);
+        state.PauseTiming();
+        if (ret.isFailed()) {
+            state.SkipWithError("Power HAL request failed");
+        }
+        enabled = !enabled;
+        testDelaySpin(
+                std::chrono::duration_cast<std::chrono::duration<float>>(ONEWAY_API_DELAY).count());
+        state.ResumeTiming();
+    }
+}
+
 BENCHMARK(BM_PowerHalControllerBenchmarks_init);
 BENCHMARK(BM_PowerHalControllerBenchmarks_initCached);
 BENCHMARK(BM_PowerHalControllerBenchmarks_setBoost)->DenseRange(FIRST_BOOST, LAST_BOOST, 1);
 BENCHMARK(BM_PowerHalControllerBenchmarks_setBoostCached)->DenseRange(FIRST_BOOST, LAST_BOOST, 1);
 BENCHMARK(BM_PowerHalControllerBenchmarks_setMode)->DenseRange(FIRST_MODE, LAST_MODE, 1);
 BENCHMARK(BM_PowerHalControllerBenchmarks_setModeCached)->DenseRange(FIRST_MODE, LAST_MODE, 1);
+BENCHMARK(BM_PowerHalControllerBenchmarks_setModeToggled)->DenseRange(FIRST_MODE, LAST_MODE, 1);
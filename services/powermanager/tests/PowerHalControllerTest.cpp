@@ -219,7 +219,8 @@ TEST_F(PowerHalControllerTest, TestMultiThreadConnectsOnlyOnce) {
     int powerHalConnectCount = mHalConnector->getConnectCount();
     EXPECT_EQ(powerHalConnectCount, 0);
 
-    EXPECT_CALL(*mMockHal.get(), powerHint(_, _)).Times(Exactly(10));
+    // Callers of the same boost are serialized, so only the first one reaches the HAL.
+    EXPECT_CALL(*mMockHal.get(), powerHint(_, _)).Times(Exactly(1));
 
     std::vector<std::thread> threads;
     for (int i = 0; i < 10; i++) {
@@ -242,17 +243,19 @@ TEST_F(PowerHalControllerTest, TestMultiThreadWithFailureReconnectIsThreadSafe)
     int powerHalConnectCount = mHalConnector->getConnectCount();
     EXPECT_EQ(powerHalConnectCount, 0);
 
-    ON_CALL(*mMockHal.get(), powerHint(Eq(PowerHint::LAUNCH), _))
+    ON_CALL(*mMockHal.get(), powerHint(Ne(PowerHint::INTERACTION), _))
             .WillByDefault([](PowerHint, int32_t) {
                 return hardware::Return<void>(hardware::Status::fromExceptionCode(-1));
             });
 
+    // Failed modes are never recorded and boosts without a duration are never skipped, so every
+    // call reaches the HAL.
     EXPECT_CALL(*mMockHal.get(), powerHint(_, _)).Times(Exactly(40));
 
     std::vector<std::thread> threads;
     for (int i = 0; i < 10; i++) {
         threads.push_back(std::thread([&]() {
-            auto result = mHalController->setBoost(Boost::INTERACTION, 1000);
+            auto result = mHalController->setBoost(Boost::INTERACTION, 0);
             ASSERT_TRUE(result.isOk());
         }));
         threads.push_back(std::thread([&]() {
@@ -261,20 +264,60 @@ TEST_F(PowerHalControllerTest, TestMultiThreadWithFailureReconnectIsThreadSafe)
         }));
         threads.push_back(std::thread([&]() {
             auto result = mHalController->setMode(Mode::LOW_POWER, false);
-            ASSERT_TRUE(result.isOk());
+            ASSERT_TRUE(result.isFailed());
         }));
         threads.push_back(std::thread([&]() {
             auto result = mHalController->setMode(Mode::VR, true);
-            ASSERT_TRUE(result.isOk());
+            ASSERT_TRUE(result.isFailed());
         }));
     }
     std::for_each(threads.begin(), threads.end(), [](std::thread& t) { t.join(); });
 
     // PowerHalConnector was called at least once by the first thread.
-    // Reset and reconnect calls were made at most 10 times, once after each
+    // Reset and reconnect calls were made at most 30 times, once after each
     // failure.
     powerHalConnectCount = mHalConnector->getConnectCount();
-    EXPECT_THAT(powerHalConnectCount, AllOf(Ge(1), Le(11)));
+    EXPECT_THAT(powerHalConnectCount, AllOf(Ge(1), Le(31)));
     int powerHalResetCount = mHalConnector->getResetCount();
-    EXPECT_THAT(powerHalResetCount, Le(10));
+    EXPECT_THAT(powerHalResetCount, Le(30));
+}
+
+TEST_F(PowerHalControllerTest, TestRedundantRequestsAreSkipped) {
+    {
+        InSequence seg;
+        EXPECT_CALL(*mMockHal.get(), powerHint(Eq(PowerHint::INTERACTION), Eq(1000)))
+                .Times(Exactly(1));
+        EXPECT_CALL(*mMockHal.get(), powerHint(Eq(PowerHint::LAUNCH), Eq(1))).Times(Exactly(1));
+        EXPECT_CALL(*mMockHal.get(), powerHint(Eq(PowerHint::LAUNCH), Eq(0))).Times(Exactly(1));
+    }
+
+    ASSERT_TRUE(mHalController->setBoost(Boost::INTERACTION, 1000).isOk());
+    ASSERT_TRUE(mHalController->setBoost(Boost::INTERACTION, 1000).isOk());
+    ASSERT_TRUE(mHalController->setMode(Mode::LAUNCH, true).isOk());
+    ASSERT_TRUE(mHalController->setMode(Mode::LAUNCH, true).isOk());
+    ASSERT_TRUE(mHalController->setMode(Mode::LAUNCH, false).isOk());
+    ASSERT_TRUE(mHalController->setMode(Mode::LAUNCH, false).isOk());
+}
+
+TEST_F(PowerHalControllerTest, TestBoostsWithoutDurationAreNotSkipped) {
+    EXPECT_CALL(*mMockHal.get(), powerHint(Eq(PowerHint::INTERACTION), Eq(0))).Times(Exactly(2));
+
+    ASSERT_TRUE(mHalController->setBoost(Boost::INTERACTION, 0).isOk());
+    ASSERT_TRUE(mHalController->setBoost(Boost::INTERACTION, 0).isOk());
+}
+
+TEST_F(PowerHalControllerTest, TestRequestsAreResentAfterReconnecting) {
+    ON_CALL(*mMockHal.get(), powerHint(Eq(PowerHint::SUSTAINED_PERFORMANCE), _))
+            .WillByDefault([](PowerHint, int32_t) {
+                return hardware::Return<void>(hardware::Status::fromExceptionCode(-1));
+            });
+
+    EXPECT_CALL(*mMockHal.get(), powerHint(Eq(PowerHint::LAUNCH), Eq(1))).Times(Exactly(2));
+    EXPECT_CALL(*mMockHal.get(), powerHint(Eq(PowerHint::SUSTAINED_PERFORMANCE), _))
+            .Times(Exactly(1));
+
+    ASSERT_TRUE(mHalController->setMode(Mode::LAUNCH, true).isOk());
+    ASSERT_TRUE(mHalController->setMode(Mode::SUSTAINED_PERFORMANCE, true).isFailed());
+    // The failure dropped the HAL handle, so the new one has not seen this mode yet.
+    ASSERT_TRUE(mHalController->setMode(Mode::LAUNCH, true).isOk());
 }
@@ -22,6 +22,8 @@
 #include <utils/Timers.h>
 
 #include <inttypes.h>
+#include <stdio.h>
+#include <time.h>
 
 namespace android {
 namespace SensorServiceUtil {
@@ -40,42 +42,72 @@ RecentEventLogger::RecentEventLogger(int sensorType) :
 }
 
 void RecentEventLogger::addEvent(const sensors_event_t& event) {
+    // Read the clock before taking the lock, so that dump() contends with as little as possible.
+    timespec wallTime;
+    clock_gettime(CLOCK_REALTIME, &wallTime);
+
     std::lock_guard<std::mutex> lk(mLock);
-    mRecentEvents.emplace(event);
+    mRecentEvents.emplace(event, wallTime);
     mIsLastEventCurrent = true;
 }
 
 bool RecentEventLogger::isEmpty() const {
+    std::lock_guard<std::mutex> lk(mLock);
     return mRecentEvents.size() == 0;
 }
 
+std::vector<RecentEventLogger::SensorEventLog> RecentEventLogger::snapshotLatestFirst() const {
+    std::lock_guard<std::mutex> lk(mLock);
+
+    std::vector<SensorEventLog> events;
+    events.reserve(mRecentEvents.size());
+    for (int i = mRecentEvents.size() - 1; i >= 0; --i) {
+        events.push_back(mRecentEvents[i]);
+    }
+    return events;
+}
+
 void RecentEventLogger::setLastEventStale() {
     std::lock_guard<std::mutex> lk(mLock);
     mIsLastEventCurrent = false;
 }
 
 std::string RecentEventLogger::dump() const {
-    std::lock_guard<std::mutex> lk(mLock);
+    // Format from a copy of the log, so that the sensor thread is never blocked behind the
+    // formatting of up to LOG_SIZE_LARGE events.
+    const std::vector<SensorEventLog> events = snapshotLatestFirst();
+
+    std::string buffer;
+    buffer.reserve(64 + events.size() * (48 + (mMaskData ? 16 : mEventSize * 10)));
 
-    //TODO: replace String8 with std::string completely in this function
-    String8 buffer;
+    char line[128];
+    snprintf(line, sizeof(line), "last %zu events\n", events.size());
+    buffer.append(line);
 
-    buffer.appendFormat("last %zu events\n", mRecentEvents.size());
+    // Events usually arrive many times per second, so only convert to local time when the second
+    // changes.
+    time_t lastSec = -1;
+    struct tm timeinfo = {};
     int j = 0;
-    for (int i = mRecentEvents.size() - 1; i >= 0; --i) {
-        const auto& ev = mRecentEvents[i];
-        struct tm * timeinfo = localtime(&(ev.mWallTime.tv_sec));
-        buffer.appendFormat("\t%2d (ts=%.9f, wall=%02d:%02d:%02d.%03d) ",
-                ++j, ev.mEvent.timestamp/1e9, timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec,
+    for (const auto& ev : events) {
+        if (ev.mWallTime.tv_sec != lastSec) {
+            lastSec = ev.mWallTime.tv_sec;
+            localtime_r(&lastSec, &timeinfo);
+        }
+        snprintf(line, sizeof(line), "\t%2d (ts=%.9f, wall=%02d:%02d:%02d.%03d) ",
+                ++j, ev.mEvent.timestamp/1e9, timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec,
                 (int) ns2ms(ev.mWallTime.tv_nsec));
+        buffer.append(line);
 
         // data
         if (!mMaskData) {
             if (mSensorType == SENSOR_TYPE_STEP_COUNTER) {
-                buffer.appendFormat("%" PRIu64 ", ", ev.mEvent.u64.step_counter);
+                snprintf(line, sizeof(line), "%" PRIu64 ", ", ev.mEvent.u64.step_counter);
+                buffer.append(line);
             } else {
                 for (size_t k = 0; k < mEventSize; ++k) {
-                    buffer.appendFormat("%.2f, ", ev.mEvent.data[k]);
+                    snprintf(line, sizeof(line), "%.2f, ", ev.mEvent.data[k]);
+                    buffer.append(line);
                 }
             }
         } else {
@@ -83,7 +115,7 @@ std::string RecentEventLogger::dump() const {
         }
         buffer.append("\n");
     }
-    return std::string(buffer.string());
+    return buffer;
 }
 
 /**
@@ -95,11 +127,10 @@ std::string RecentEventLogger::dump() const {
  */
 void RecentEventLogger::dump(util::ProtoOutputStream* proto) const {
     using namespace service::SensorEventsProto;
-    std::lock_guard<std::mutex> lk(mLock);
+    const std::vector<SensorEventLog> events = snapshotLatestFirst();
 
-    proto->write(RecentEventsLog::RECENT_EVENTS_COUNT, int(mRecentEvents.size()));
-    for (int i = mRecentEvents.size() - 1; i >= 0; --i) {
-        const auto& ev = mRecentEvents[i];
+    proto->write(RecentEventsLog::RECENT_EVENTS_COUNT, int(events.size()));
+    for (const auto& ev : events) {
         const uint64_t token = proto->start(RecentEventsLog::EVENTS);
         proto->write(Event::TIMESTAMP_SEC, float(ev.mEvent.timestamp) / 1e9f);
         proto->write(Event::WALL_TIMESTAMP_MS, ev.mWallTime.tv_sec * 1000LL
@@ -154,9 +185,9 @@ size_t RecentEventLogger::logSizeBySensorType(int sensorType) {
     return LOG_SIZE;
 }
 
-RecentEventLogger::SensorEventLog::SensorEventLog(const sensors_event_t& e) : mEvent(e) {
-    clock_gettime(CLOCK_REALTIME, &mWallTime);
-}
+RecentEventLogger::SensorEventLog::SensorEventLog(const sensors_event_t& e,
+                                                  const timespec& wallTime)
+      : mWallTime(wallTime), mEvent(e) {}
 
 } // namespace SensorServiceUtil
 } // namespace android
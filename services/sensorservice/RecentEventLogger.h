@@ -24,6 +24,7 @@
 #include <utils/String8.h>
 
 #include <mutex>
+#include <vector>
 
 namespace android {
 namespace SensorServiceUtil {
@@ -53,7 +54,7 @@ public:
 
 protected:
     struct SensorEventLog {
-        explicit SensorEventLog(const sensors_event_t& e);
+        SensorEventLog(const sensors_event_t& e, const timespec& wallTime);
         timespec mWallTime;
         sensors_event_t mEvent;
     };
@@ -68,6 +69,9 @@ protected:
     bool mIsLastEventCurrent;
 
 private:
+    // Returns a copy of the recorded events, latest first, for formatting outside of mLock.
+    std::vector<SensorEventLog> snapshotLatestFirst() const;
+
     static size_t logSizeBySensorType(int sensorType);
 };
 
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <log/log.h>
 #include <sys/socket.h>
 #include <utils/threads.h>
@@ -295,9 +296,30 @@ status_t SensorService::SensorEventConnection::sendEvents(
 
     std::unique_ptr<sensors_event_t[]> sanitizedBuffer;
 
+    // The events to send. When the events of this connection are a contiguous run of the buffer,
+    // which is the common case of a batch from a single sensor, they are sent straight from the
+    // buffer, and only copied to the scratch buffer when they need to be modified.
+    sensors_event_t const* events = nullptr;
+    size_t firstEvent = 0;
     int count = 0;
     Mutex::Autolock _l(mConnectionLock);
     if (scratch) {
+        bool contiguous = true;
+        auto selectEvent = [&](size_t index) {
+            if (contiguous) {
+                if (count == 0) {
+                    firstEvent = index;
+                }
+                if (index == firstEvent + count) {
+                    count++;
+                    return;
+                }
+                std::copy(buffer + firstEvent, buffer + firstEvent + count, scratch);
+                contiguous = false;
+            }
+            scratch[count++] = buffer[index];
+        };
+
         size_t i=0;
         while (i<numEvents) {
             int32_t sensor_handle = buffer[i].sensor;
@@ -342,13 +364,13 @@ status_t SensorService::SensorEventConnection::sendEvents(
                 // corresponding flush_complete_event.
                 if (buffer[i].type == SENSOR_TYPE_META_DATA) {
                     if (mapFlushEventsToConnections[i] == this) {
-                        scratch[count++] = buffer[i];
+                        selectEvent(i);
                     }
                 } else {
                     // Regular sensor event, just copy it to the scratch buffer after checking
                     // the AppOp.
                     if (hasSensorAccess() && noteOpIfRequired(buffer[i])) {
-                        scratch[count++] = buffer[i];
+                        selectEvent(i);
                     }
                 }
                 i++;
@@ -357,6 +379,7 @@ status_t SensorService::SensorEventConnection::sendEvents(
                                        (buffer[i].type == SENSOR_TYPE_META_DATA  &&
                                         buffer[i].meta_data.sensor == sensor_handle)));
         }
+        events = contiguous ? buffer + firstEvent : scratch;
     } else {
         if (hasSensorAccess()) {
             scratch = const_cast<sensors_event_t *>(buffer);
@@ -370,6 +393,7 @@ status_t SensorService::SensorEventConnection::sendEvents(
                 }
             }
         }
+        events = scratch;
     }
 
     sendPendingFlushEventsLocked();
@@ -384,14 +408,19 @@ status_t SensorService::SensorEventConnection::sendEvents(
     if (mCacheSize != 0) {
         // There are some events in the cache which need to be sent first. Copy this buffer to
         // the end of cache.
-        appendEventsToCacheLocked(scratch, count);
+        appendEventsToCacheLocked(events, count);
         return status_t(NO_ERROR);
     }
 
     int index_wake_up_event = -1;
     if (hasSensorAccess()) {
-        index_wake_up_event = findWakeUpSensorEventLocked(scratch, count);
+        index_wake_up_event = findWakeUpSensorEventLocked(events, count);
         if (index_wake_up_event >= 0) {
+            if (events != scratch) {
+                // The wake up event needs to be flagged, which the shared buffer must not be.
+                std::copy(events, events + count, scratch);
+                events = scratch;
+            }
             BatteryService::noteWakeupSensorEvent(scratch[index_wake_up_event].timestamp,
                                                   mUid, scratch[index_wake_up_event].sensor);
             scratch[index_wake_up_event].flags |= WAKE_UP_SENSOR_EVENT_NEEDS_ACK;
@@ -404,7 +433,7 @@ status_t SensorService::SensorEventConnection::sendEvents(
 
     // NOTE: ASensorEvent and sensors_event_t are the same type.
     ssize_t size = SensorEventQueue::write(mChannel,
-                                    reinterpret_cast<ASensorEvent const*>(scratch), count);
+                                    reinterpret_cast<ASensorEvent const*>(events), count);
     if (size < 0) {
         // Write error, copy events to local cache.
         if (index_wake_up_event >= 0) {
@@ -423,7 +452,7 @@ status_t SensorService::SensorEventConnection::sendEvents(
             mCacheSize = 0;
         }
         // Save the events so that they can be written later
-        appendEventsToCacheLocked(scratch, count);
+        appendEventsToCacheLocked(events, count);
 
         // Add this file descriptor to the looper to get a callback when this fd is available for
         // writing.
@@ -636,6 +636,21 @@ status_t SensorService::dump(int fd, const Vector<String16>& args) {
                                 mSocketBufferSize/sizeof(sensors_event_t));
             result.appendFormat("WakeLock Status: %s \n", mWakeLockAcquired ? "acquired" :
                     "not held");
+            {
+                nsecs_t wakeLockHeldNs = mWakeUpStats.wakeLockHeldNs;
+                if (mWakeLockAcquired) {
+                    wakeLockHeldNs += elapsedRealtimeNano() - mWakeUpStats.wakeLockAcquiredTime;
+                }
+                const uint64_t acquisitions = mWakeUpStats.wakeLockAcquisitions;
+                result.appendFormat("Wake up cost: %" PRIu64 " events, %" PRIu64
+                                    " wake lock acquisitions (%.1f events per acquisition), "
+                                    "held for %" PRId64 " ms\n",
+                                    mWakeUpStats.events, acquisitions,
+                                    acquisitions > 0
+                                            ? double(mWakeUpStats.events) / acquisitions
+                                            : 0.0,
+                                    wakeLockHeldNs / 1000000);
+            }
             result.appendFormat("Mode :");
             switch(mCurrentOperatingMode) {
                case NORMAL:
@@ -1086,6 +1101,7 @@ bool SensorService::threadLoop() {
         }
 
         if (wakeEvents > 0) {
+            mWakeUpStats.events += wakeEvents;
             if (!mWakeLockAcquired) {
                 setWakeLockAcquiredLocked(true);
             }
@@ -1275,12 +1291,16 @@ void SensorService::setWakeLockAcquiredLocked(bool acquire) {
         if (!mWakeLockAcquired) {
             acquire_wake_lock(PARTIAL_WAKE_LOCK, WAKE_LOCK_NAME);
             mWakeLockAcquired = true;
+            mWakeUpStats.wakeLockAcquisitions++;
+            mWakeUpStats.wakeLockAcquiredTime = elapsedRealtimeNano();
         }
         mLooper->wake();
     } else {
         if (mWakeLockAcquired) {
             release_wake_lock(WAKE_LOCK_NAME);
             mWakeLockAcquired = false;
+            mWakeUpStats.wakeLockHeldNs +=
+                    elapsedRealtimeNano() - mWakeUpStats.wakeLockAcquiredTime;
         }
     }
 }
@@ -519,6 +519,14 @@ private:
     std::unordered_set<int> mActiveVirtualSensors;
     SensorConnectionHolder mConnectionHolder;
     bool mWakeLockAcquired;
+    // What the wake up sensors cost: how many wake up events were received, how many times the
+    // wake lock was acquired to deliver them, and how long it was held.
+    struct WakeUpStats {
+        uint64_t events = 0;
+        uint64_t wakeLockAcquisitions = 0;
+        nsecs_t wakeLockHeldNs = 0;
+        nsecs_t wakeLockAcquiredTime = 0; // when the wake lock currently held was acquired
+    } mWakeUpStats;
     sensors_event_t *mSensorEventBuffer, *mSensorEventScratch;
     // WARNING: these SensorEventConnection instances must not be promoted to sp, except via
     // modification to add support for them in ConnectionSafeAutolock
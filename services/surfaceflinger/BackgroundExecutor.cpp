@@ -36,7 +36,10 @@ BackgroundExecutor::BackgroundExecutor() : Singleton<BackgroundExecutor>() {
     mThread = std::thread([&]() {
         while (!mDone) {
             LOG_ALWAYS_FATAL_IF(sem_wait(&mSemaphore), "sem_wait failed (%d)", errno);
-            auto callbacks = mCallbacksQueue.pop();
+            auto callbacks = mHighPriorityCallbacksQueue.pop();
+            if (!callbacks) {
+                callbacks = mCallbacksQueue.pop();
+            }
             if (!callbacks) {
                 continue;
             }
@@ -56,8 +59,14 @@ BackgroundExecutor::~BackgroundExecutor() {
     }
 }
 
-void BackgroundExecutor::sendCallbacks(Callbacks&& tasks) {
-    mCallbacksQueue.push(std::move(tasks));
+BackgroundExecutor& BackgroundExecutor::getLowPriorityInstance() {
+    static BackgroundExecutor sLowPriorityInstance;
+    return sLowPriorityInstance;
+}
+
+void BackgroundExecutor::sendCallbacks(Callbacks&& tasks, Priority priority) {
+    auto& queue = priority == Priority::High ? mHighPriorityCallbacksQueue : mCallbacksQueue;
+    queue.push(std::move(tasks));
     LOG_ALWAYS_FATAL_IF(sem_post(&mSemaphore), "sem_post failed");
 }
 
@@ -16,13 +16,12 @@
 
 #pragma once
 
+#include <ftl/mpsc_queue.h>
 #include <ftl/small_vector.h>
 #include <semaphore.h>
 #include <utils/Singleton.h>
 #include <thread>
 
-#include "LocklessQueue.h"
-
 namespace android {
 
 // Executes tasks off the main thread.
@@ -31,16 +30,23 @@ public:
     BackgroundExecutor();
     ~BackgroundExecutor();
     using Callbacks = ftl::SmallVector<std::function<void()>, 10>;
+    // Callbacks of the same priority run in the order they were sent. Pending high priority
+    // callbacks run before any pending normal priority callbacks.
+    enum class Priority { Normal, High };
+    // Returns a separate executor for long-running work, such as screen capture composition, that
+    // must not delay the callbacks queued on getInstance().
+    static BackgroundExecutor& getLowPriorityInstance();
     // Queues callbacks onto a work queue to be executed by a background thread.
     // This is safe to call from multiple threads.
-    void sendCallbacks(Callbacks&& tasks);
+    void sendCallbacks(Callbacks&& tasks, Priority priority = Priority::Normal);
     void flushQueue();
 
 private:
     sem_t mSemaphore;
     std::atomic_bool mDone = false;
 
-    LocklessQueue<Callbacks> mCallbacksQueue;
+    ftl::MpscQueue<Callbacks> mCallbacksQueue;
+    ftl::MpscQueue<Callbacks> mHighPriorityCallbacksQueue;
     std::thread mThread;
 };
 
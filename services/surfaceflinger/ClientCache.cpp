@@ -34,7 +34,8 @@ ANDROID_SINGLETON_STATIC_INSTANCE(ClientCache);
 ClientCache::ClientCache() : mDeathRecipient(sp<CacheDeathRecipient>::make()) {}
 
 bool ClientCache::getBuffer(const client_cache_t& cacheId,
-                            ClientCacheBuffer** outClientCacheBuffer) {
+                            ClientCacheBuffer** outClientCacheBuffer,
+                            ProcessBuffers** outProcessBuffers) {
     auto& [processToken, id] = cacheId;
     if (processToken == nullptr) {
         ALOGE_AND_TRACE("ClientCache::getBuffer - invalid (nullptr) process token");
@@ -56,6 +57,9 @@ bool ClientCache::getBuffer(const client_cache_t& cacheId,
 
     ClientCacheBuffer& buf = bufItr->second;
     *outClientCacheBuffer = &buf;
+    if (outProcessBuffers) {
+        *outProcessBuffers = &processBuffers;
+    }
     return true;
 }
 
@@ -122,15 +126,19 @@ sp<GraphicBuffer> ClientCache::erase(const client_cache_t& cacheId) {
     sp<GraphicBuffer> buffer;
     auto& [processToken, id] = cacheId;
     std::vector<sp<ErasedRecipient>> pendingErase;
+    // Released after the lock, as dropping the last reference unmaps and frees the buffer.
+    std::shared_ptr<renderengine::ExternalTexture> erasedTexture;
     {
         std::lock_guard lock(mMutex);
         ClientCacheBuffer* buf = nullptr;
-        if (!getBuffer(cacheId, &buf)) {
+        ProcessBuffers* processBuffers = nullptr;
+        if (!getBuffer(cacheId, &buf, &processBuffers)) {
             ALOGE("failed to erase buffer, could not retrieve buffer");
             return nullptr;
         }
 
         buffer = buf->buffer->getBuffer();
+        erasedTexture = std::move(buf->buffer);
 
         for (auto& recipient : buf->recipients) {
             sp<ErasedRecipient> erasedRecipient = recipient.promote();
@@ -139,7 +147,7 @@ sp<GraphicBuffer> ClientCache::erase(const client_cache_t& cacheId) {
             }
         }
 
-        mBuffers[processToken].second.erase(id);
+        processBuffers->erase(id);
     }
 
     for (auto& recipient : pendingErase) {
@@ -188,6 +196,9 @@ void ClientCache::unregisterErasedRecipient(const client_cache_t& cacheId,
 
 void ClientCache::removeProcess(const wp<IBinder>& processToken) {
     std::vector<std::pair<sp<ErasedRecipient>, client_cache_t>> pendingErase;
+    // Released after the lock, as a dying process may leave thousands of buffers to unmap and free,
+    // which would otherwise stall every transaction that looks up the cache meanwhile.
+    ProcessBuffers erasedBuffers;
     {
         if (processToken == nullptr) {
             ALOGE("failed to remove process, invalid (nullptr) process token");
@@ -209,12 +220,16 @@ void ClientCache::removeProcess(const wp<IBinder>& processToken) {
                 }
             }
         }
+        erasedBuffers = std::move(itr->second.second);
         mBuffers.erase(itr);
     }
 
     for (auto& [recipient, cacheId] : pendingErase) {
         recipient->bufferErased(cacheId);
     }
+
+    ATRACE_FORMAT("ClientCache::removeProcess - releasing %zu buffers", erasedBuffers.size());
+    erasedBuffers.clear();
 }
 
 void ClientCache::CacheDeathRecipient::binderDied(const wp<IBinder>& who) {
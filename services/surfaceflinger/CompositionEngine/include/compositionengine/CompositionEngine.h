@@ -61,6 +61,9 @@ public:
     virtual TimeStats* getTimeStats() const = 0;
     virtual void setTimeStats(const std::shared_ptr<TimeStats>&) = 0;
 
+    // Allows outputs to present to the HWC concurrently when they all support it
+    virtual void setMultithreadedPresent(bool) = 0;
+
     virtual bool needsAnotherUpdate() const = 0;
     virtual nsecs_t getLastFrameRefreshTimestamp() const = 0;
 
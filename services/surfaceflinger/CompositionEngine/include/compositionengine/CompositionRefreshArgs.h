@@ -25,6 +25,7 @@
 #include <compositionengine/OutputColorSetting.h>
 #include <math/mat4.h>
 #include <ui/FenceTime.h>
+#include <ui/LayerStack.h>
 #include <ui/Transform.h>
 
 namespace android::compositionengine {
@@ -38,6 +39,22 @@ struct BorderRenderInfo {
     std::vector<int32_t> layerIds;
 };
 
+// The composition state that every output reads for every layer to find the layers it shows,
+// copied into arrays indexed like CompositionRefreshArgs::layers. Outputs scan these to skip the
+// layers they don't show, without reading each layer's LayerFECompositionState.
+struct LayerVisibilityArrays {
+    std::vector<ui::LayerFilter> outputFilters;
+    std::vector<bool> isVisible;
+    std::vector<uint64_t> coverageGenerations;
+
+    size_t size() const { return outputFilters.size(); }
+    void clear() {
+        outputFilters.clear();
+        isVisible.clear();
+        coverageGenerations.clear();
+    }
+};
+
 // Interface of composition engine power hint callback.
 struct ICEPowerCallback {
     virtual void notifyCpuLoadUp() = 0;
@@ -58,6 +75,10 @@ struct CompositionRefreshArgs {
     // front.
     Layers layers;
 
+    // Filled in by CompositionEngine::present from the layers' composition state. If it doesn't
+    // match layers, outputs read the composition state of each layer instead.
+    LayerVisibilityArrays layerVisibility;
+
     // All the layers that have queued updates.
     Layers layersWithQueuedFrames;
 
@@ -82,8 +103,8 @@ struct CompositionRefreshArgs {
     // If true, there was a geometry update this frame
     bool updatingGeometryThisFrame{false};
 
-    // The color matrix to use for this
-    // frame. Only set if the color transform is changing this frame.
+    // The color matrix to use for this frame, if any. Outputs only act on it when it differs from
+    // the matrix they last applied.
     std::optional<mat4> colorTransformMatrix;
 
     // If true, client composition is always used.
@@ -129,9 +129,6 @@ public:
     struct LayerSettings : renderengine::LayerSettings {
         // Currently latched buffer if, 0 if invalid.
         uint64_t bufferId = 0;
-
-        // Currently latched frame number, 0 if invalid.
-        uint64_t frameNumber = 0;
     };
 
     // Returns the LayerSettings to pass to RenderEngine::drawLayers. The state may contain shadows
@@ -204,7 +201,6 @@ static inline void PrintTo(const LayerFE::LayerSettings& settings, ::std::ostrea
     *os << "LayerFE::LayerSettings{";
     PrintTo(static_cast<const renderengine::LayerSettings&>(settings), os);
     *os << "\n    .bufferId = " << settings.bufferId;
-    *os << "\n    .frameNumber = " << settings.frameNumber;
     *os << "\n}";
 }
 
@@ -110,6 +110,11 @@ struct LayerFECompositionState {
     // If true, invalidates the entire visible region
     bool contentDirty{false};
 
+    // Changes whenever any of the state that determines the layer's visible region and dirty
+    // region may have changed, so that outputs can reuse the coverage they last computed for the
+    // layer. 0 means that changes aren't tracked and the coverage is always recomputed.
+    uint64_t coverageGeneration{0};
+
     // The alpha value for this layer
     float alpha{1.f};
 
@@ -39,6 +39,8 @@ public:
     TimeStats* getTimeStats() const override;
     void setTimeStats(const std::shared_ptr<TimeStats>&) override;
 
+    void setMultithreadedPresent(bool) override;
+
     bool needsAnotherUpdate() const override;
     nsecs_t getLastFrameRefreshTimestamp() const override;
 
@@ -57,9 +59,17 @@ public:
     void setNeedsAnotherUpdateForTest(bool);
 
 private:
+    // Fills in args.layerVisibility once for all of the outputs.
+    void updateLayerVisibility(CompositionRefreshArgs&);
+
+    // Has all but the last of the outputs present to the HWC on their own worker threads,
+    // if each one presenting to the HWC can do so.
+    void offloadOutputs(const Outputs&);
+
     std::unique_ptr<HWComposer> mHwComposer;
     renderengine::RenderEngine* mRenderEngine;
     std::shared_ptr<TimeStats> mTimeStats;
+    bool mMultithreadedPresent = false;
     bool mNeedsAnotherUpdate = false;
     nsecs_t mRefreshStartTime = 0;
 };
@@ -60,6 +60,7 @@ public:
     void applyCompositionStrategy(const std::optional<DeviceRequestedChanges>&) override;
     bool getSkipColorTransform() const override;
     compositionengine::Output::FrameFences presentAndGetFrameFences() override;
+    bool supportsOffloadPresent() const override;
     void setExpensiveRenderingExpected(bool) override;
     void finishFrame(GpuCompositionResult&&) override;
 
@@ -94,6 +95,8 @@ private:
     void setHintSessionGpuFence(std::unique_ptr<FenceTime>&& gpuFence) override;
     DisplayId mId;
     bool mIsDisconnected = false;
+    // The color transform last sent to the HWC, which only needs to hear about changes.
+    std::optional<mat4> mHwcColorTransform;
     Hwc2::PowerAdvisor* mPowerAdvisor = nullptr;
 };
 
@@ -18,6 +18,7 @@
 
 #include <cstdint>
 #include <stack>
+#include <string>
 #include <unordered_map>
 
 // TODO(b/129481165): remove the #pragma below and fix conversion issues
@@ -92,6 +93,20 @@ public:
     //
     uint32_t uncache(uint64_t graphicBufferId);
 
+    // Counters describing how well the cache avoids sending buffer handles to HWC.
+    struct Stats {
+        // Buffers that were already cached, so only their slot was sent to HWC.
+        uint64_t hits = 0;
+        // Buffers that had to be sent to HWC along with their slot.
+        uint64_t misses = 0;
+        // Cached buffers that were dropped to make room for another buffer.
+        uint64_t evictions = 0;
+    };
+
+    const Stats& getStats() const { return mStats; }
+
+    void dump(std::string& out) const;
+
 private:
     uint32_t cache(const sp<GraphicBuffer>& buffer);
     uint32_t getLeastRecentlyUsedSlot();
@@ -108,6 +123,7 @@ private:
     sp<GraphicBuffer> mLastOverrideBuffer;
     std::stack<uint32_t> mFreeSlots;
     uint64_t mLeastRecentlyUsedCounter;
+    Stats mStats;
 };
 
 } // namespace compositionengine::impl
@@ -80,7 +80,9 @@ public:
     void setReleasedLayers(ReleasedLayers&&) override;
 
     void prepare(const CompositionRefreshArgs&, LayerFESet&) override;
-    void present(const CompositionRefreshArgs&) override;
+    ftl::Future<std::monostate> present(const CompositionRefreshArgs&) override;
+    bool supportsOffloadPresent() const override { return false; }
+    void offloadPresentNextFrame() override;
 
     void uncacheBuffers(const std::vector<uint64_t>& bufferIdsToUncache) override;
     void rebuildLayerStacks(const CompositionRefreshArgs&, LayerFESet&) override;
@@ -161,7 +163,18 @@ private:
     void updateCompositionStateForBorder(const compositionengine::CompositionRefreshArgs&);
     compositionengine::OutputLayer* findLayerRequestingBackgroundComposition() const;
     void finishPrepareFrame();
+    // Creates the HwcAsyncWorker once composition strategy prediction or
+    // offloaded present needs it.
+    void updateHwcAsyncWorker();
+    // Remembers the composition strategy the HWC chose for the current output layers.
+    void cacheCompositionStrategy();
+    // Makes the cached strategy for the given output layers the one to predict, if there is one.
+    bool restoreCachedCompositionStrategy(uint64_t outputLayerHash);
+    ftl::Future<std::monostate> postFramebufferAsync();
     ui::Dataspace getBestDataspace(ui::Dataspace*, bool*) const;
+    // Resets the coverage to what it was after the first reusedCount layers, and drops the
+    // checkpoints of the layers below them.
+    void restoreCoverageCheckpoint(size_t reusedCount, compositionengine::Output::CoverageState&);
     compositionengine::Output::ColorProfile pickColorProfile(
             const compositionengine::CompositionRefreshArgs&) const;
 
@@ -176,9 +189,41 @@ private:
     std::unique_ptr<ClientCompositionRequestCache> mClientCompositionRequestCache;
     std::unique_ptr<planner::Planner> mPlanner;
     std::unique_ptr<HwcAsyncWorker> mHwComposerAsyncWorker;
+    bool mPredictCompositionStrategy = false;
+    bool mOffloadPresent = false;
+
+    // The composition strategies the HWC chose for recent output layer configurations, most
+    // recently used first. Lets the strategy be predicted when a configuration comes back,
+    // e.g. when switching between two app states.
+    struct CachedCompositionStrategy {
+        uint64_t outputLayerHash;
+        std::optional<android::HWComposer::DeviceRequestedChanges> changes;
+        bool success;
+    };
+    static constexpr size_t kCompositionStrategyCacheSize = 4;
+    std::vector<CachedCompositionStrategy> mCompositionStrategyCache;
 
     // Whether the content must be recomposed this frame.
     bool mMustRecompose = false;
+
+    // The coverage after each layer the last time the visible layers were collected, from front
+    // to back. The coverage of the layers above the first one that changed is reused.
+    struct CoverageCheckpoint {
+        // Only compared, never dereferenced
+        const LayerFE* layerFE;
+        uint64_t coverageGeneration;
+        Region aboveCoveredLayers;
+        Region aboveOpaqueLayers;
+        Region dirtyRegion;
+        std::optional<Region> aboveCoveredLayersExcludingOverlays;
+    };
+    std::vector<CoverageCheckpoint> mCoverageCheckpoints;
+    // The output state the checkpoints were computed with
+    ui::Transform mCoverageTransform;
+    Rect mCoverageDisplaySpaceBounds;
+    Rect mCoverageLayerStackSpaceContent;
+    ui::LayerFilter mCoverageLayerFilter;
+    bool mCoverageHasCoverageExcludingOverlays = false;
 };
 
 // This template factory function standardizes the implementation details of the
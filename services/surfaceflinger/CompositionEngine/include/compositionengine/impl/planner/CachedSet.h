@@ -20,9 +20,12 @@
 #include <compositionengine/ProjectionSpace.h>
 #include <compositionengine/impl/planner/LayerState.h>
 #include <compositionengine/impl/planner/TexturePool.h>
+#include <ftl/future.h>
 #include <renderengine/RenderEngine.h>
+#include <ui/FenceResult.h>
 
 #include <chrono>
+#include <optional>
 
 namespace android {
 
@@ -98,6 +101,7 @@ public:
         mTexture.reset();
         mOutputDataspace = ui::Dataspace::UNKNOWN;
         mDrawFence = nullptr;
+        mPendingRender.reset();
         mBlurLayer = nullptr;
         mHolePunchLayer = nullptr;
         mSkipCount = 0;
@@ -113,10 +117,20 @@ public:
     void incrementSkipCount() { mSkipCount++; }
     size_t getSkipCount() { return mSkipCount; }
 
-    // Renders the cached set with the supplied output composition state.
+    // Renders the cached set with the supplied output composition state. The draw is queued to
+    // RenderEngine without waiting for it to be submitted to the GPU, so the rendered buffer may
+    // only become available from a later call to collectPendingRender.
     void render(renderengine::RenderEngine& re, TexturePool& texturePool,
                 const OutputCompositionState& outputState, bool deviceHandlesColorTransform);
 
+    // True if a render was queued but its result has not been collected yet.
+    bool hasPendingRender() const { return mPendingRender.has_value(); }
+
+    // Collects the result of a pending render if RenderEngine has finished with it, without
+    // blocking. Returns false while the render is still in flight. Dropping the CachedSet, or
+    // appending to it, abandons a pending render.
+    bool collectPendingRender();
+
     void dump(std::string& result) const;
 
     // Whether this represents a single layer with a buffer and rounded corners.
@@ -169,6 +183,18 @@ private:
     // containers in the Flattener. Logically this should have unique ownership otherwise.
     std::shared_ptr<TexturePool::AutoTexture> mTexture;
     sp<Fence> mDrawFence;
+
+    // Holds the state of a render until RenderEngine reports its result, at which point it is
+    // committed to mTexture, mDrawFence and the output state below.
+    struct PendingRender {
+        ftl::SharedFuture<FenceResult> fenceResult;
+        std::shared_ptr<TexturePool::AutoTexture> texture;
+        ProjectionSpace outputSpace;
+        ui::Dataspace outputDataspace;
+        ui::Transform::RotationFlags orientation;
+    };
+    std::optional<PendingRender> mPendingRender;
+
     ProjectionSpace mOutputSpace;
     ui::Dataspace mOutputDataspace;
     ui::Transform::RotationFlags mOrientation = ui::Transform::ROT_0;
@@ -19,6 +19,7 @@
 #include <compositionengine/Output.h>
 #include <compositionengine/impl/planner/CachedSet.h>
 #include <compositionengine/impl/planner/LayerState.h>
+#include <ui/FenceTime.h>
 
 #include <chrono>
 #include <numeric>
@@ -85,6 +86,10 @@ public:
 
         // True if the hole punching feature should be enabled.
         const bool mEnableHolePunch;
+
+        // Time after which the textures held for rendering cached sets are released if no cached
+        // set has been rendered.
+        const std::chrono::milliseconds mTexturePoolIdleTimeout = TexturePool::kDefaultIdleTimeout;
     };
 
     // Constants not yet backed by a sysprop
@@ -93,6 +98,9 @@ public:
     static constexpr int kNumLayersFpsConsideration = 1;
     // Frames/Second threshold below which these CachedSets may be considered inactive.
     static constexpr float kFpsActiveThreshold = 1.f;
+    // Weight given to the newest GPU timing when updating the learned cost of rendering a cached
+    // set. Lower values smooth out one-off stalls at the expense of adapting more slowly.
+    static constexpr double kRenderCostSmoothingFactor = 0.2;
 
     Flattener(renderengine::RenderEngine& renderEngine, const Tunables& tunables);
 
@@ -116,6 +124,12 @@ public:
 
     const std::optional<CachedSet>& getNewCachedSetForTesting() const { return mNewCachedSet; }
 
+    // Feeds a GPU timing into the learned render cost as if a cached set of the given area had
+    // been rendered in the given duration.
+    void recordRenderDurationForTesting(std::chrono::nanoseconds duration, size_t pixels) {
+        recordRenderDuration(duration, pixels);
+    }
+
 private:
     size_t calculateDisplayCost(const std::vector<const LayerState*>& layers) const;
 
@@ -229,6 +243,20 @@ private:
 
     void buildCachedSets(std::chrono::steady_clock::time_point now);
 
+    // Collects the result of the new cached set's render if RenderEngine has finished with it.
+    // Returns false while the render is still in flight.
+    bool collectNewCachedSetRender();
+
+    // Returns the expected time for the GPU to render the new cached set. Until a render has been
+    // timed this is the configured cachedSetRenderDuration.
+    std::chrono::nanoseconds estimateRenderDuration() const;
+
+    // Folds the GPU timing of any previously rendered cached set whose draw fence has since
+    // signaled into the learned render cost.
+    void updateRenderCost();
+
+    void recordRenderDuration(std::chrono::nanoseconds duration, size_t pixels);
+
     renderengine::RenderEngine& mRenderEngine;
     const Tunables mTunables;
 
@@ -254,6 +282,22 @@ private:
     size_t mCachedSetCreationCount = 0;
     size_t mCachedSetCreationCost = 0;
     std::unordered_map<size_t, size_t> mInvalidatedCachedSetAges;
+
+    // A cached set render that was submitted to the GPU but whose draw fence had not yet signaled
+    // when it was last checked.
+    struct PendingRenderTiming {
+        std::shared_ptr<FenceTime> drawFence;
+        std::chrono::steady_clock::time_point renderStart;
+        size_t pixels;
+    };
+    std::optional<PendingRenderTiming> mPendingRenderTiming;
+    // When the render of the new cached set was queued, if it has not been collected yet.
+    std::optional<std::chrono::steady_clock::time_point> mRenderSubmitTime;
+
+    // Learned GPU cost of rendering a cached set, as a moving average of the measured render
+    // duration per pixel of the cached set bounds.
+    std::optional<double> mRenderCostNsPerPixel;
+    size_t mRenderTimingSampleCount = 0;
 };
 
 } // namespace compositionengine::impl::planner
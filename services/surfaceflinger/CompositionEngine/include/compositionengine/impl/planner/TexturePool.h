@@ -26,15 +26,19 @@
 #include "android-base/macros.h"
 
 namespace android::compositionengine::impl::planner {
+using namespace std::chrono_literals;
 
 // A pool of textures that only manages textures of a single size.
 // While it is possible to define a texture pool supporting variable-sized textures to save on
 // memory, it is a simpler implementation to only manage screen-sized textures. The texture pool is
 // unbounded - there are a minimum number of textures preallocated. Under heavy system load, new
 // textures may be allocated, but only a maximum number of retained once those textures are no
-// longer necessary.
+// longer necessary. Textures that sit in the pool for long enough without any being borrowed are
+// released, so that a display that has stopped flattening does not hold on to them.
 class TexturePool {
 public:
+    static const constexpr std::chrono::milliseconds kDefaultIdleTimeout = 10s;
+
     // RAII class helping with managing textures from the texture pool
     // Textures once they're no longer used should be returned to the pool instead of outright
     // deleted.
@@ -63,8 +67,9 @@ public:
         sp<Fence> mFence;
     };
 
-    TexturePool(renderengine::RenderEngine& renderEngine)
-          : mRenderEngine(renderEngine), mEnabled(false) {}
+    TexturePool(renderengine::RenderEngine& renderEngine,
+                std::chrono::milliseconds idleTimeout = kDefaultIdleTimeout)
+          : mRenderEngine(renderEngine), mIdleTimeout(idleTimeout), mEnabled(false) {}
 
     virtual ~TexturePool() = default;
 
@@ -83,6 +88,10 @@ public:
     // be held by the pool. This is useful when the active display changes.
     void setEnabled(bool enable);
 
+    // Releases the textures held by the pool if none have been borrowed for the idle timeout.
+    // Borrowed textures are unaffected, and the pool regrows on demand once they are returned.
+    void releaseIdleTextures(std::chrono::steady_clock::time_point now);
+
     void dump(std::string& out) const;
 
 protected:
@@ -104,6 +113,8 @@ private:
                        const sp<Fence>& fence);
     void allocatePool();
     renderengine::RenderEngine& mRenderEngine;
+    const std::chrono::milliseconds mIdleTimeout;
+    std::chrono::steady_clock::time_point mLastUsed = std::chrono::steady_clock::now();
     ui::Size mSize;
     bool mEnabled;
 };
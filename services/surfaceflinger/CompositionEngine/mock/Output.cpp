@@ -20,7 +20,12 @@ namespace android::compositionengine::mock {
 
 // The Google Mock documentation recommends explicit non-header instantiations
 // for better compile time performance.
-Output::Output() = default;
+Output::Output() {
+    // The future has no default value that can be waited on.
+    ON_CALL(*this, present(testing::_)).WillByDefault([](const CompositionRefreshArgs&) {
+        return ftl::yield<std::monostate>({});
+    });
+}
 Output::~Output() = default;
 
 } // namespace android::compositionengine::mock
@@ -20,8 +20,11 @@
 #include <compositionengine/OutputLayer.h>
 #include <compositionengine/impl/CompositionEngine.h>
 #include <compositionengine/impl/Display.h>
+#include <compositionengine/impl/OutputCompositionState.h>
 
+#include <ftl/future.h>
 #include <renderengine/RenderEngine.h>
+#include <ui/DisplayMap.h>
 #include <utils/Trace.h>
 
 // TODO(b/129481165): remove the #pragma below and fix conversion issues
@@ -80,6 +83,10 @@ void CompositionEngine::setTimeStats(const std::shared_ptr<TimeStats>& timeStats
     mTimeStats = timeStats;
 }
 
+void CompositionEngine::setMultithreadedPresent(bool enabled) {
+    mMultithreadedPresent = enabled;
+}
+
 bool CompositionEngine::needsAnotherUpdate() const {
     return mNeedsAnotherUpdate;
 }
@@ -93,6 +100,7 @@ void CompositionEngine::present(CompositionRefreshArgs& args) {
     ALOGV(__FUNCTION__);
 
     preComposition(args);
+    updateLayerVisibility(args);
 
     {
         // latchedLayers is used to track the set of front-end layer state that
@@ -105,8 +113,51 @@ void CompositionEngine::present(CompositionRefreshArgs& args) {
         }
     }
 
+    if (mMultithreadedPresent) {
+        offloadOutputs(args.outputs);
+    }
+
+    ui::DisplayVector<ftl::Future<std::monostate>> presentFutures;
     for (const auto& output : args.outputs) {
-        output->present(args);
+        presentFutures.push_back(output->present(args));
+    }
+
+    {
+        ATRACE_NAME("Waiting for HWC");
+        for (auto& future : presentFutures) {
+            future.get();
+        }
+    }
+}
+
+void CompositionEngine::offloadOutputs(const Outputs& outputs) {
+    if (outputs.size() < 2) {
+        return;
+    }
+
+    ui::DisplayVector<compositionengine::Output*> outputsToOffload;
+    for (const auto& output : outputs) {
+        const auto displayId = output->getDisplayId();
+        if (!output->getState().isEnabled || !displayId || !HalDisplayId::tryCast(*displayId)) {
+            // Never presented to the HWC, so there is nothing to offload.
+            continue;
+        }
+        // The composer only takes calls for different displays at the same time
+        // when all of them support it.
+        if (!output->supportsOffloadPresent()) {
+            return;
+        }
+        outputsToOffload.push_back(output.get());
+    }
+
+    if (outputsToOffload.size() < 2) {
+        return;
+    }
+
+    // The last output is presented on the main thread, concurrently with the others.
+    outputsToOffload.pop_back();
+    for (auto* output : outputsToOffload) {
+        output->offloadPresentNextFrame();
     }
 }
 
@@ -140,6 +191,22 @@ void CompositionEngine::preComposition(CompositionRefreshArgs& args) {
     mNeedsAnotherUpdate = needsAnotherUpdate;
 }
 
+void CompositionEngine::updateLayerVisibility(CompositionRefreshArgs& args) {
+    LayerVisibilityArrays& visibility = args.layerVisibility;
+    visibility.clear();
+    visibility.outputFilters.reserve(args.layers.size());
+    visibility.isVisible.reserve(args.layers.size());
+    visibility.coverageGenerations.reserve(args.layers.size());
+    for (const auto& layer : args.layers) {
+        const auto* layerFEState = layer->getCompositionState();
+        visibility.outputFilters.push_back(layerFEState ? layerFEState->outputFilter
+                                                        : ui::LayerFilter{});
+        visibility.isVisible.push_back(layerFEState && layerFEState->isVisible);
+        visibility.coverageGenerations.push_back(layerFEState ? layerFEState->coverageGeneration
+                                                              : 0);
+    }
+}
+
 FeatureFlags CompositionEngine::getFeatureFlags() const {
     return {};
 }
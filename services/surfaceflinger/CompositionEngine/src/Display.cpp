@@ -96,9 +96,11 @@ void Display::disconnect() {
 void Display::setColorTransform(const compositionengine::CompositionRefreshArgs& args) {
     Output::setColorTransform(args);
     const auto halDisplayId = HalDisplayId::tryCast(mId);
-    if (mIsDisconnected || !halDisplayId || CC_LIKELY(!args.colorTransformMatrix)) {
+    if (mIsDisconnected || !halDisplayId || CC_LIKELY(!args.colorTransformMatrix) ||
+        mHwcColorTransform == args.colorTransformMatrix) {
         return;
     }
+    mHwcColorTransform = args.colorTransformMatrix;
 
     auto& hwc = getCompositionEngine().getHwComposer();
     status_t result = hwc.setColorTransform(*halDisplayId, *args.colorTransformMatrix);
@@ -304,6 +306,21 @@ bool Display::getSkipColorTransform() const {
     return hwc.hasCapability(Capability::SKIP_CLIENT_COLOR_TRANSFORM);
 }
 
+bool Display::supportsOffloadPresent() const {
+    const auto halDisplayId = HalDisplayId::tryCast(mId);
+    if (mIsDisconnected || !halDisplayId) {
+        return false;
+    }
+
+    // The present timings reported to the PowerAdvisor are not synchronized.
+    if (mPowerAdvisor && mPowerAdvisor->usePowerHintSession()) {
+        return false;
+    }
+
+    const auto& hwc = getCompositionEngine().getHwComposer();
+    return hwc.hasDisplayCapability(*halDisplayId, DisplayCapability::MULTI_THREADED_PRESENT);
+}
+
 bool Display::allLayersRequireClientComposition() const {
     const auto layers = getOutputLayersOrderedByZ();
     return std::all_of(layers.begin(), layers.end(),
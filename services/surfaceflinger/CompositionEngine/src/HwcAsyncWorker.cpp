@@ -60,7 +60,10 @@ void HwcAsyncWorker::run() {
     std::unique_lock<std::mutex> lock(mMutex);
     android::base::ScopedLockAssertion assumeLock(mMutex);
     while (!mDone) {
-        mCv.wait(lock);
+        // A task may already have been sent before this thread started waiting.
+        if (!mTaskRequested) {
+            mCv.wait(lock);
+        }
         if (mTaskRequested && mTask.valid()) {
             mTask();
             mTaskRequested = false;
@@ -16,6 +16,8 @@
 
 #include <compositionengine/impl/HwcBufferCache.h>
 
+#include <android-base/stringprintf.h>
+#include <cinttypes>
 #include <gui/BufferQueue.h>
 #include <ui/GraphicBuffer.h>
 
@@ -32,15 +34,19 @@ HwcSlotAndBuffer HwcBufferCache::getHwcSlotAndBuffer(const sp<GraphicBuffer>& bu
         Cache& cache = i->second;
         // mark this cache slot as more recently used so it won't get evicted anytime soon
         cache.lruCounter = mLeastRecentlyUsedCounter++;
+        ++mStats.hits;
         return {cache.slot, nullptr};
     }
+    ++mStats.misses;
     return {cache(buffer), buffer};
 }
 
 HwcSlotAndBuffer HwcBufferCache::getOverrideHwcSlotAndBuffer(const sp<GraphicBuffer>& buffer) {
     if (buffer == mLastOverrideBuffer) {
+        ++mStats.hits;
         return {kOverrideBufferSlot, nullptr};
     }
+    ++mStats.misses;
     mLastOverrideBuffer = buffer;
     return {kOverrideBufferSlot, buffer};
 }
@@ -81,10 +87,22 @@ uint32_t HwcBufferCache::getLeastRecentlyUsedSlot() {
         uint32_t slot = cacheToErase->second.slot;
         mCacheByBufferId.erase(cacheToErase);
         mFreeSlots.push(slot);
+        ++mStats.evictions;
     }
     uint32_t slot = mFreeSlots.top();
     mFreeSlots.pop();
     return slot;
 }
 
+void HwcBufferCache::dump(std::string& out) const {
+    const uint64_t lookups = mStats.hits + mStats.misses;
+    base::StringAppendF(&out,
+                        "bufferCache=[hits=%" PRIu64 " misses=%" PRIu64 " evictions=%" PRIu64
+                        " hitRate=%.1f%%] ",
+                        mStats.hits, mStats.misses, mStats.evictions,
+                        lookups ? 100.0 * static_cast<double>(mStats.hits) /
+                                        static_cast<double>(lookups)
+                                : 0.0);
+}
+
 } // namespace android::compositionengine::impl
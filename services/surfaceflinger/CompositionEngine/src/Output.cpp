@@ -32,6 +32,7 @@
 #include <ftl/future.h>
 #include <gui/TraceUtils.h>
 
+#include <algorithm>
 #include <optional>
 #include <thread>
 
@@ -65,23 +66,6 @@ using CompositionStrategyPredictionState =
         OutputCompositionState::CompositionStrategyPredictionState;
 namespace {
 
-template <typename T>
-class Reversed {
-public:
-    explicit Reversed(const T& container) : mContainer(container) {}
-    auto begin() { return mContainer.rbegin(); }
-    auto end() { return mContainer.rend(); }
-
-private:
-    const T& mContainer;
-};
-
-// Helper for enumerating over a container in reverse order
-template <typename T>
-Reversed<T> reversed(const T& c) {
-    return Reversed<T>(c);
-}
-
 struct ScaleVector {
     float x;
     float y;
@@ -434,7 +418,8 @@ void Output::prepare(const compositionengine::CompositionRefreshArgs& refreshArg
     uncacheBuffers(refreshArgs.bufferIdsToUncache);
 }
 
-void Output::present(const compositionengine::CompositionRefreshArgs& refreshArgs) {
+ftl::Future<std::monostate> Output::present(
+        const compositionengine::CompositionRefreshArgs& refreshArgs) {
     ATRACE_FORMAT("%s for %s", __func__, mNamePlusId.c_str());
     ALOGV(__FUNCTION__);
 
@@ -455,8 +440,33 @@ void Output::present(const compositionengine::CompositionRefreshArgs& refreshArg
 
     devOptRepaintFlash(refreshArgs);
     finishFrame(std::move(result));
-    postFramebuffer();
+
+    ftl::Future<std::monostate> future;
+    if (mOffloadPresent) {
+        future = postFramebufferAsync();
+        // Offloading is decided again for every frame. The worker is kept, as
+        // it is still presenting and is likely to be needed again.
+        mOffloadPresent = false;
+    } else {
+        postFramebuffer();
+        future = ftl::yield<std::monostate>({});
+    }
+
     renderCachedSets(refreshArgs);
+    return future;
+}
+
+void Output::offloadPresentNextFrame() {
+    mOffloadPresent = true;
+    updateHwcAsyncWorker();
+}
+
+ftl::Future<std::monostate> Output::postFramebufferAsync() {
+    return ftl::Future<bool>(mHwComposerAsyncWorker->send([this]() {
+               postFramebuffer();
+               return true;
+           }))
+            .then([](bool) { return std::monostate{}; });
 }
 
 void Output::uncacheBuffers(std::vector<uint64_t> const& bufferIdsToUncache) {
@@ -498,22 +508,99 @@ void Output::rebuildLayerStacks(const compositionengine::CompositionRefreshArgs&
 
 void Output::collectVisibleLayers(const compositionengine::CompositionRefreshArgs& refreshArgs,
                                   compositionengine::Output::CoverageState& coverage) {
+    const LayerVisibilityArrays& visibility = refreshArgs.layerVisibility;
+    const bool hasVisibility = visibility.size() == refreshArgs.layers.size();
+
+    // The coverage of the layers above the first changed one can be reused, as
+    // long as the output is projected the same way.
+    const auto& outputState = getState();
+    const Rect displaySpaceBounds = outputState.displaySpace.getBoundsAsRect();
+    const Rect layerStackSpaceContent = outputState.layerStackSpace.getContent();
+    const bool hasCoverageExcludingOverlays =
+            coverage.aboveCoveredLayersExcludingOverlays.has_value();
+    if (!hasVisibility || mCoverageTransform != outputState.transform ||
+        mCoverageDisplaySpaceBounds != displaySpaceBounds ||
+        mCoverageLayerStackSpaceContent != layerStackSpaceContent ||
+        mCoverageLayerFilter.layerStack != outputState.layerFilter.layerStack ||
+        mCoverageLayerFilter.toInternalDisplay != outputState.layerFilter.toInternalDisplay ||
+        mCoverageHasCoverageExcludingOverlays != hasCoverageExcludingOverlays) {
+        mCoverageCheckpoints.clear();
+        mCoverageTransform = outputState.transform;
+        mCoverageDisplaySpaceBounds = displaySpaceBounds;
+        mCoverageLayerStackSpaceContent = layerStackSpaceContent;
+        mCoverageLayerFilter = outputState.layerFilter;
+        mCoverageHasCoverageExcludingOverlays = hasCoverageExcludingOverlays;
+    }
+    size_t reusedCount = 0;
+    bool reusing = !mCoverageCheckpoints.empty();
+
     // Evaluate the layers from front to back to determine what is visible. This
     // also incrementally calculates the coverage information for each layer as
     // well as the entire output.
-    for (auto layer : reversed(refreshArgs.layers)) {
+    for (size_t i = refreshArgs.layers.size(); i-- > 0;) {
+        // Skip the layers that ensureOutputLayerIfVisible would reject without
+        // reading their state.
+        if (hasVisibility &&
+            (!visibility.isVisible[i] || !includesLayer(visibility.outputFilters[i]))) {
+            continue;
+        }
+
+        sp<LayerFE> layer = refreshArgs.layers[i];
+        const uint64_t generation = hasVisibility ? visibility.coverageGenerations[i] : 0;
+        if (reusing) {
+            const CoverageCheckpoint* checkpoint = reusedCount < mCoverageCheckpoints.size()
+                    ? &mCoverageCheckpoints[reusedCount]
+                    : nullptr;
+            if (checkpoint && generation != 0 && checkpoint->layerFE == layer.get() &&
+                checkpoint->coverageGeneration == generation) {
+                // Nothing above or in this layer changed, so its output layer
+                // still holds the coverage it would compute.
+                coverage.latchedLayers.insert(layer);
+                if (auto index = findCurrentOutputLayerForLayer(layer)) {
+                    ensureOutputLayer(index, layer);
+                }
+                reusedCount++;
+                continue;
+            }
+            reusing = false;
+            restoreCoverageCheckpoint(reusedCount, coverage);
+        }
+
         // Incrementally process the coverage for each layer
         ensureOutputLayerIfVisible(layer, coverage);
+        mCoverageCheckpoints.push_back({.layerFE = layer.get(),
+                                        .coverageGeneration = generation,
+                                        .aboveCoveredLayers = coverage.aboveCoveredLayers,
+                                        .aboveOpaqueLayers = coverage.aboveOpaqueLayers,
+                                        .dirtyRegion = coverage.dirtyRegion,
+                                        .aboveCoveredLayersExcludingOverlays =
+                                                coverage.aboveCoveredLayersExcludingOverlays});
 
         // TODO(b/121291683): Stop early if the output is completely covered and
         // no more layers could even be visible underneath the ones on top.
     }
+    if (reusing) {
+        restoreCoverageCheckpoint(reusedCount, coverage);
+    }
 
     setReleasedLayers(refreshArgs);
 
     finalizePendingOutputLayers();
 }
 
+void Output::restoreCoverageCheckpoint(size_t reusedCount,
+                                       compositionengine::Output::CoverageState& coverage) {
+    if (reusedCount > 0) {
+        CoverageCheckpoint& checkpoint = mCoverageCheckpoints[reusedCount - 1];
+        coverage.aboveCoveredLayers = checkpoint.aboveCoveredLayers;
+        coverage.aboveOpaqueLayers = checkpoint.aboveOpaqueLayers;
+        coverage.dirtyRegion = checkpoint.dirtyRegion;
+        coverage.aboveCoveredLayersExcludingOverlays =
+                checkpoint.aboveCoveredLayersExcludingOverlays;
+    }
+    mCoverageCheckpoints.resize(reusedCount);
+}
+
 void Output::ensureOutputLayerIfVisible(sp<compositionengine::LayerFE>& layerFE,
                                         compositionengine::Output::CoverageState& coverage) {
     // Ensure we have a snapshot of the basic geometry layer state. Limit the
@@ -1094,6 +1181,7 @@ void Output::prepareFrame() {
     outputState.strategyPrediction = CompositionStrategyPredictionState::DISABLED;
     outputState.previousDeviceRequestedChanges = changes;
     outputState.previousDeviceRequestedSuccess = success;
+    cacheCompositionStrategy();
     if (success) {
         applyCompositionStrategy(changes);
     }
@@ -1150,9 +1238,47 @@ GpuCompositionResult Output::prepareFrameAsync() {
     }
     state.previousDeviceRequestedChanges = std::move(changes);
     state.previousDeviceRequestedSuccess = chooseCompositionSuccess;
+    cacheCompositionStrategy();
     return compositionResult;
 }
 
+void Output::cacheCompositionStrategy() {
+    const auto& state = getState();
+    if (!mPredictCompositionStrategy || !state.previousDeviceRequestedChanges) {
+        return;
+    }
+
+    const auto it = std::find_if(mCompositionStrategyCache.begin(), mCompositionStrategyCache.end(),
+                                 [&](const auto& entry) {
+                                     return entry.outputLayerHash == state.outputLayerHash;
+                                 });
+    if (it != mCompositionStrategyCache.end()) {
+        mCompositionStrategyCache.erase(it);
+    } else if (mCompositionStrategyCache.size() == kCompositionStrategyCacheSize) {
+        mCompositionStrategyCache.pop_back();
+    }
+    mCompositionStrategyCache.insert(mCompositionStrategyCache.begin(),
+                                     {state.outputLayerHash, state.previousDeviceRequestedChanges,
+                                      state.previousDeviceRequestedSuccess});
+}
+
+bool Output::restoreCachedCompositionStrategy(uint64_t outputLayerHash) {
+    auto it = std::find_if(mCompositionStrategyCache.begin(), mCompositionStrategyCache.end(),
+                           [&](const auto& entry) {
+                               return entry.outputLayerHash == outputLayerHash;
+                           });
+    if (it == mCompositionStrategyCache.end()) {
+        return false;
+    }
+
+    // Move the entry to the front, it is the most recently used now.
+    std::rotate(mCompositionStrategyCache.begin(), it, it + 1);
+    auto& state = editState();
+    state.previousDeviceRequestedChanges = mCompositionStrategyCache.front().changes;
+    state.previousDeviceRequestedSuccess = mCompositionStrategyCache.front().success;
+    return true;
+}
+
 void Output::devOptRepaintFlash(const compositionengine::CompositionRefreshArgs& refreshArgs) {
     if (CC_LIKELY(!refreshArgs.devOptFlashDirtyRegionsDelay)) {
         return;
@@ -1413,6 +1539,9 @@ renderengine::DisplaySettings Output::generateClientCompositionDisplaySettings()
 std::vector<LayerFE::LayerSettings> Output::generateClientCompositionRequests(
       bool supportsProtectedContent, ui::Dataspace outputDataspace, std::vector<LayerFE*>& outLayerFEs) {
     std::vector<LayerFE::LayerSettings> clientCompositionLayers;
+    // LayerSettings are large, so size the vector for every layer up front rather than move them
+    // on each reallocation.
+    clientCompositionLayers.reserve(getOutputLayerCount());
     ALOGV("Rendering client layers");
 
     const auto& outputState = getState();
@@ -1625,8 +1754,15 @@ compositionengine::Output::FrameFences Output::presentAndGetFrameFences() {
 }
 
 void Output::setPredictCompositionStrategy(bool predict) {
-    if (predict) {
-        mHwComposerAsyncWorker = std::make_unique<HwcAsyncWorker>();
+    mPredictCompositionStrategy = predict;
+    updateHwcAsyncWorker();
+}
+
+void Output::updateHwcAsyncWorker() {
+    if (mPredictCompositionStrategy || mOffloadPresent) {
+        if (!mHwComposerAsyncWorker) {
+            mHwComposerAsyncWorker = std::make_unique<HwcAsyncWorker>();
+        }
     } else {
         mHwComposerAsyncWorker.reset(nullptr);
     }
@@ -1641,16 +1777,11 @@ bool Output::canPredictCompositionStrategy(const CompositionRefreshArgs& refresh
     uint64_t outputLayerHash = getState().outputLayerHash;
     editState().lastOutputLayerHash = outputLayerHash;
 
-    if (!getState().isEnabled || !mHwComposerAsyncWorker) {
+    if (!getState().isEnabled || !mPredictCompositionStrategy) {
         ALOGV("canPredictCompositionStrategy disabled");
         return false;
     }
 
-    if (!getState().previousDeviceRequestedChanges) {
-        ALOGV("canPredictCompositionStrategy previous changes not available");
-        return false;
-    }
-
     if (!mRenderSurface->supportsCompositionStrategyPrediction()) {
         ALOGV("canPredictCompositionStrategy surface does not support");
         return false;
@@ -1661,11 +1792,6 @@ bool Output::canPredictCompositionStrategy(const CompositionRefreshArgs& refresh
         return false;
     }
 
-    if (lastOutputLayerHash != outputLayerHash) {
-        ALOGV("canPredictCompositionStrategy output layers changed");
-        return false;
-    }
-
     // If no layer uses clientComposition, then don't predict composition strategy
     // because we have less work to do in parallel.
     if (!anyLayersRequireClientComposition()) {
@@ -1673,6 +1799,20 @@ bool Output::canPredictCompositionStrategy(const CompositionRefreshArgs& refresh
         return false;
     }
 
+    if (lastOutputLayerHash == outputLayerHash) {
+        if (!getState().previousDeviceRequestedChanges) {
+            ALOGV("canPredictCompositionStrategy previous changes not available");
+            return false;
+        }
+        return true;
+    }
+
+    // The output layers changed, but they may be back to a configuration that was composed
+    // recently.
+    if (!restoreCachedCompositionStrategy(outputLayerHash)) {
+        ALOGV("canPredictCompositionStrategy output layers changed");
+        return false;
+    }
     return true;
 }
 
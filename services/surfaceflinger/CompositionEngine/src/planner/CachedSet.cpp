@@ -178,6 +178,7 @@ void CachedSet::render(renderengine::RenderEngine& renderEngine, TexturePool& te
             .deviceHandlesColorTransform = deviceHandlesColorTransform,
             .orientation = orientation,
             .targetLuminanceNits = outputState.displayBrightnessNits,
+            .priority = renderengine::DisplaySettings::Priority::CACHED_SET,
     };
 
     LayerFE::ClientCompositionTargetSettings
@@ -277,23 +278,48 @@ void CachedSet::render(renderengine::RenderEngine& renderEngine, TexturePool& te
 
     constexpr bool kUseFramebufferCache = false;
 
-    auto fenceResult = renderEngine
-                               .drawLayers(displaySettings, layerSettings, texture->get(),
-                                           kUseFramebufferCache, std::move(bufferFence))
-                               .get();
+    mPendingRender = PendingRender{
+            .fenceResult = renderEngine
+                                   .drawLayers(displaySettings, layerSettings, texture->get(),
+                                               kUseFramebufferCache, std::move(bufferFence))
+                                   .share(),
+            .texture = std::move(texture),
+            .outputSpace = outputState.framebufferSpace,
+            .outputDataspace = outputDataspace,
+            .orientation = orientation,
+    };
+
+    // RenderEngine may already be done, e.g. if it is not threaded.
+    collectPendingRender();
+}
+
+bool CachedSet::collectPendingRender() {
+    using namespace std::chrono_literals;
 
+    if (!mPendingRender) {
+        return true;
+    }
+
+    if (mPendingRender->fenceResult.wait_for(0ns) == std::future_status::timeout) {
+        ATRACE_NAME("CachedSet render pending");
+        return false;
+    }
+
+    const FenceResult& fenceResult = mPendingRender->fenceResult.get();
     if (fenceStatus(fenceResult) == NO_ERROR) {
-        mDrawFence = std::move(fenceResult).value_or(Fence::NO_FENCE);
-        mOutputSpace = outputState.framebufferSpace;
-        mTexture = texture;
+        mDrawFence = fenceResult.value_or(Fence::NO_FENCE);
+        mOutputSpace = mPendingRender->outputSpace;
+        mTexture = std::move(mPendingRender->texture);
         mTexture->setReadyFence(mDrawFence);
-        mOutputSpace.setOrientation(outputState.framebufferSpace.getOrientation());
-        mOutputDataspace = outputDataspace;
-        mOrientation = orientation;
+        mOutputDataspace = mPendingRender->outputDataspace;
+        mOrientation = mPendingRender->orientation;
         mSkipCount = 0;
     } else {
         mTexture.reset();
     }
+
+    mPendingRender.reset();
+    return true;
 }
 
 bool CachedSet::requiresHolePunch() const {
@@ -61,7 +61,9 @@ bool isSameStack(const std::vector<const LayerState*>& incomingLayers,
 } // namespace
 
 Flattener::Flattener(renderengine::RenderEngine& renderEngine, const Tunables& tunables)
-      : mRenderEngine(renderEngine), mTunables(tunables), mTexturePool(mRenderEngine) {}
+      : mRenderEngine(renderEngine),
+        mTunables(tunables),
+        mTexturePool(mRenderEngine, tunables.mTexturePoolIdleTimeout) {}
 
 NonBufferHash Flattener::flattenLayers(const std::vector<const LayerState*>& layers,
                                        NonBufferHash hash, time_point now) {
@@ -103,24 +105,32 @@ void Flattener::renderCachedSets(
         bool deviceHandlesColorTransform) {
     ATRACE_CALL();
 
+    mTexturePool.releaseIdleTextures(std::chrono::steady_clock::now());
+
     if (!mNewCachedSet) {
         return;
     }
 
+    // Don't queue another render while RenderEngine is still working on the previous one
+    if (!collectNewCachedSetRender()) {
+        return;
+    }
+
     // Ensure that a cached set has a valid buffer first
     if (mNewCachedSet->hasRenderedBuffer()) {
         ATRACE_NAME("mNewCachedSet->hasRenderedBuffer()");
         return;
     }
 
+    updateRenderCost();
+
     const auto now = std::chrono::steady_clock::now();
 
     // If we have a render deadline, and the flattener is configured to skip rendering if we don't
     // have enough time, then we skip rendering the cached set if we think that we'll steal too much
     // time from the next frame.
     if (renderDeadline && mTunables.mRenderScheduling) {
-        if (const auto estimatedRenderFinish =
-                    now + mTunables.mRenderScheduling->cachedSetRenderDuration;
+        if (const auto estimatedRenderFinish = now + estimateRenderDuration();
             estimatedRenderFinish > *renderDeadline) {
             mNewCachedSet->incrementSkipCount();
 
@@ -137,7 +147,77 @@ void Flattener::renderCachedSets(
         }
     }
 
+    mRenderSubmitTime = std::chrono::steady_clock::now();
     mNewCachedSet->render(mRenderEngine, mTexturePool, outputState, deviceHandlesColorTransform);
+    collectNewCachedSetRender();
+}
+
+bool Flattener::collectNewCachedSetRender() {
+    if (!mNewCachedSet->collectPendingRender()) {
+        return false;
+    }
+
+    // Only time renders that are subject to render scheduling, since that is the only consumer of
+    // the learned cost.
+    if (mRenderSubmitTime && mTunables.mRenderScheduling && mNewCachedSet->hasRenderedBuffer() &&
+        mNewCachedSet->getDrawFence()->isValid()) {
+        const Rect& bounds = mNewCachedSet->getBounds();
+        mPendingRenderTiming = {
+                .drawFence = std::make_shared<FenceTime>(mNewCachedSet->getDrawFence()),
+                .renderStart = *mRenderSubmitTime,
+                .pixels = static_cast<size_t>(bounds.getWidth() * bounds.getHeight())};
+    }
+    mRenderSubmitTime.reset();
+    return true;
+}
+
+std::chrono::nanoseconds Flattener::estimateRenderDuration() const {
+    const auto fallback = mTunables.mRenderScheduling->cachedSetRenderDuration;
+    if (!mRenderCostNsPerPixel || !mNewCachedSet) {
+        return fallback;
+    }
+
+    const Rect& bounds = mNewCachedSet->getBounds();
+    const auto pixels = static_cast<double>(bounds.getWidth() * bounds.getHeight());
+    return std::chrono::nanoseconds(static_cast<int64_t>(*mRenderCostNsPerPixel * pixels));
+}
+
+void Flattener::updateRenderCost() {
+    if (!mPendingRenderTiming) {
+        return;
+    }
+
+    const nsecs_t signalTime = mPendingRenderTiming->drawFence->getSignalTime();
+    if (signalTime == Fence::SIGNAL_TIME_PENDING) {
+        return;
+    }
+
+    if (signalTime != Fence::SIGNAL_TIME_INVALID) {
+        const nsecs_t renderStart = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                            mPendingRenderTiming->renderStart.time_since_epoch())
+                                            .count();
+        // The fence is timestamped on CLOCK_MONOTONIC, which steady_clock is backed by.
+        if (signalTime > renderStart) {
+            recordRenderDuration(std::chrono::nanoseconds(signalTime - renderStart),
+                                 mPendingRenderTiming->pixels);
+        }
+    }
+
+    mPendingRenderTiming.reset();
+}
+
+void Flattener::recordRenderDuration(std::chrono::nanoseconds duration, size_t pixels) {
+    if (pixels == 0) {
+        return;
+    }
+
+    const double nsPerPixel = static_cast<double>(duration.count()) / static_cast<double>(pixels);
+    mRenderCostNsPerPixel = mRenderCostNsPerPixel
+            ? *mRenderCostNsPerPixel +
+                    kRenderCostSmoothingFactor * (nsPerPixel - *mRenderCostNsPerPixel)
+            : nsPerPixel;
+    ++mRenderTimingSampleCount;
+    ATRACE_INT64("CachedSetRenderNs", duration.count());
 }
 
 void Flattener::dumpLayers(std::string& result) const {
@@ -189,6 +269,14 @@ void Flattener::dump(std::string& result) const {
     base::StringAppendF(&result, "    Cost: %.2f\n",
                         static_cast<float>(mCachedSetCreationCost) / displayArea);
 
+    if (mRenderCostNsPerPixel) {
+        base::StringAppendF(&result,
+                            "    Learned render cost: %.2f ns/pixel (%.2f ms/screen, %zd samples)\n",
+                            *mRenderCostNsPerPixel,
+                            *mRenderCostNsPerPixel * static_cast<double>(displayArea) / 1e6,
+                            mRenderTimingSampleCount);
+    }
+
     const auto lastUpdate =
             std::chrono::duration_cast<std::chrono::milliseconds>(now - mLastGeometryUpdate);
     base::StringAppendF(&result, "\n  Current hash %016zx, last update %sago\n\n", mCurrentGeometry,
@@ -303,7 +391,7 @@ bool Flattener::mergeWithCachedSets(const std::vector<const LayerState*>& layers
                 ALOGV("[%s] Dropping new cached set", __func__);
                 ++mInvalidatedCachedSetAges[0];
                 mNewCachedSet = std::nullopt;
-            } else if (mNewCachedSet->hasReadyBuffer()) {
+            } else if (collectNewCachedSetRender() && mNewCachedSet->hasReadyBuffer()) {
                 ALOGV("[%s] Found ready buffer", __func__);
                 size_t skipCount = mNewCachedSet->getLayerCount();
                 while (skipCount != 0) {
@@ -61,10 +61,15 @@ Flattener::Tunables buildFlattenerTuneables() {
     const auto enableHolePunch =
             base::GetBoolProperty(std::string("debug.sf.enable_hole_punch_pip"),
                                   Flattener::Tunables::kDefaultEnableHolePunch);
+    const auto texturePoolIdleTimeout = std::chrono::milliseconds(
+            base::GetIntProperty<int32_t>(std::string(
+                                                  "debug.sf.layer_caching_texture_pool_idle_timeout_ms"),
+                                          TexturePool::kDefaultIdleTimeout.count()));
     return Flattener::Tunables{
             .mActiveLayerTimeout = activeLayerTimeout,
             .mRenderScheduling = buildRenderSchedulingTunables(),
             .mEnableHolePunch = enableHolePunch,
+            .mTexturePoolIdleTimeout = texturePoolIdleTimeout,
     };
 }
 
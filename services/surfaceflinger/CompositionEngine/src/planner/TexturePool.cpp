@@ -27,6 +27,7 @@ namespace android::compositionengine::impl::planner {
 
 void TexturePool::allocatePool() {
     mPool.clear();
+    mLastUsed = std::chrono::steady_clock::now();
     if (mEnabled && mSize.isValid()) {
         mPool.resize(kMinPoolSize);
         std::generate_n(mPool.begin(), kMinPoolSize, [&]() {
@@ -44,6 +45,8 @@ void TexturePool::setDisplaySize(ui::Size size) {
 }
 
 std::shared_ptr<TexturePool::AutoTexture> TexturePool::borrowTexture() {
+    mLastUsed = std::chrono::steady_clock::now();
+
     if (mPool.empty()) {
         return std::make_shared<AutoTexture>(*this, genTexture(), nullptr);
     }
@@ -103,10 +106,23 @@ void TexturePool::setEnabled(bool enabled) {
     allocatePool();
 }
 
+void TexturePool::releaseIdleTextures(std::chrono::steady_clock::time_point now) {
+    if (mPool.empty() || now - mLastUsed < mIdleTimeout) {
+        return;
+    }
+
+    ALOGV("Deallocating %zu textures from Planner's pool - idle for %" PRId64 " ms", mPool.size(),
+          static_cast<int64_t>(
+                  std::chrono::duration_cast<std::chrono::milliseconds>(now - mLastUsed).count()));
+    mPool.clear();
+}
+
 void TexturePool::dump(std::string& out) const {
     base::StringAppendF(&out,
-                        "TexturePool (%s) has %zu buffers of size [%" PRId32 ", %" PRId32 "]\n",
-                        mEnabled ? "enabled" : "disabled", mPool.size(), mSize.width, mSize.height);
+                        "TexturePool (%s) has %zu buffers of size [%" PRId32 ", %" PRId32
+                        "], idle timeout %" PRId64 " ms\n",
+                        mEnabled ? "enabled" : "disabled", mPool.size(), mSize.width, mSize.height,
+                        static_cast<int64_t>(mIdleTimeout.count()));
 }
 
 } // namespace android::compositionengine::impl::planner
\ No newline at end of file
@@ -116,6 +116,75 @@ TEST_F(CompositionEnginePresentTest, worksAsExpected) {
     mEngine.present(mRefreshArgs);
 }
 
+TEST_F(CompositionEnginePresentTest, offloadsAllButLastOutputWhenMultithreaded) {
+    const auto kDisplayId1 = PhysicalDisplayId::fromPort(1u);
+    const auto kDisplayId2 = PhysicalDisplayId::fromPort(2u);
+    const auto kDisplayId3 = PhysicalDisplayId::fromPort(3u);
+    impl::OutputCompositionState enabledState;
+    enabledState.isEnabled = true;
+
+    EXPECT_CALL(mEngine, preComposition(Ref(mRefreshArgs)));
+    for (const auto& [output, displayId] :
+         {std::pair(mOutput1, kDisplayId1), std::pair(mOutput2, kDisplayId2),
+          std::pair(mOutput3, kDisplayId3)}) {
+        EXPECT_CALL(*output, prepare(Ref(mRefreshArgs), _));
+        EXPECT_CALL(*output, getState()).WillRepeatedly(ReturnRef(enabledState));
+        EXPECT_CALL(*output, getDisplayId()).WillRepeatedly(Return(DisplayId(displayId)));
+        EXPECT_CALL(*output, supportsOffloadPresent()).WillRepeatedly(Return(true));
+        EXPECT_CALL(*output, present(Ref(mRefreshArgs)));
+    }
+    EXPECT_CALL(*mOutput1, offloadPresentNextFrame());
+    EXPECT_CALL(*mOutput2, offloadPresentNextFrame());
+
+    mEngine.setMultithreadedPresent(true);
+    mRefreshArgs.outputs = {mOutput1, mOutput2, mOutput3};
+    mEngine.present(mRefreshArgs);
+}
+
+TEST_F(CompositionEnginePresentTest, doesNotOffloadUnlessAllOutputsSupportIt) {
+    const auto kDisplayId1 = PhysicalDisplayId::fromPort(1u);
+    const auto kDisplayId2 = PhysicalDisplayId::fromPort(2u);
+    impl::OutputCompositionState enabledState;
+    enabledState.isEnabled = true;
+
+    EXPECT_CALL(mEngine, preComposition(Ref(mRefreshArgs)));
+    EXPECT_CALL(*mOutput1, prepare(Ref(mRefreshArgs), _));
+    EXPECT_CALL(*mOutput2, prepare(Ref(mRefreshArgs), _));
+    EXPECT_CALL(*mOutput1, getState()).WillRepeatedly(ReturnRef(enabledState));
+    EXPECT_CALL(*mOutput2, getState()).WillRepeatedly(ReturnRef(enabledState));
+    EXPECT_CALL(*mOutput1, getDisplayId()).WillRepeatedly(Return(DisplayId(kDisplayId1)));
+    EXPECT_CALL(*mOutput2, getDisplayId()).WillRepeatedly(Return(DisplayId(kDisplayId2)));
+    EXPECT_CALL(*mOutput1, supportsOffloadPresent()).WillRepeatedly(Return(true));
+    EXPECT_CALL(*mOutput2, supportsOffloadPresent()).WillRepeatedly(Return(false));
+    EXPECT_CALL(*mOutput1, present(Ref(mRefreshArgs)));
+    EXPECT_CALL(*mOutput2, present(Ref(mRefreshArgs)));
+
+    mEngine.setMultithreadedPresent(true);
+    mRefreshArgs.outputs = {mOutput1, mOutput2};
+    mEngine.present(mRefreshArgs);
+}
+
+TEST_F(CompositionEnginePresentTest, fillsLayerVisibility) {
+    sp<StrictMock<mock::LayerFE>> layer1FE = sp<StrictMock<mock::LayerFE>>::make();
+    sp<StrictMock<mock::LayerFE>> layer2FE = sp<StrictMock<mock::LayerFE>>::make();
+    LayerFECompositionState layer1FEState;
+    layer1FEState.isVisible = true;
+    layer1FEState.outputFilter = {ui::LayerStack{3}, true};
+
+    EXPECT_CALL(mEngine, preComposition(Ref(mRefreshArgs)));
+    EXPECT_CALL(*layer1FE, getCompositionState()).WillOnce(Return(&layer1FEState));
+    EXPECT_CALL(*layer2FE, getCompositionState()).WillOnce(Return(nullptr));
+
+    mRefreshArgs.layers = {layer1FE, layer2FE};
+    mEngine.present(mRefreshArgs);
+
+    ASSERT_EQ(2u, mRefreshArgs.layerVisibility.size());
+    EXPECT_TRUE(mRefreshArgs.layerVisibility.isVisible[0]);
+    EXPECT_EQ(ui::LayerStack{3}, mRefreshArgs.layerVisibility.outputFilters[0].layerStack);
+    EXPECT_TRUE(mRefreshArgs.layerVisibility.outputFilters[0].toInternalDisplay);
+    EXPECT_FALSE(mRefreshArgs.layerVisibility.isVisible[1]);
+}
+
 /*
  * CompositionEngine::updateCursorAsync
  */
@@ -389,6 +389,18 @@ TEST_F(DisplaySetColorTransformTest, setsTransform) {
     mDisplay->setColorTransform(refreshArgs);
 }
 
+TEST_F(DisplaySetColorTransformTest, doesNotResendUnchangedTransform) {
+    const mat4 kNonIdentity = mat4() * 2;
+
+    EXPECT_CALL(mHwComposer, setColorTransform(HalDisplayId(DEFAULT_DISPLAY_ID), kNonIdentity))
+            .Times(1);
+
+    CompositionRefreshArgs refreshArgs;
+    refreshArgs.colorTransformMatrix = kNonIdentity;
+    mDisplay->setColorTransform(refreshArgs);
+    mDisplay->setColorTransform(refreshArgs);
+}
+
 /*
  * Display::setColorMode()
  */
@@ -711,6 +723,31 @@ TEST_F(DisplayGetSkipColorTransformTest, checksDisplayCapability) {
     EXPECT_TRUE(mDisplay->getSkipColorTransform());
 }
 
+/*
+ * Display::supportsOffloadPresent()
+ */
+
+using DisplaySupportsOffloadPresentTest = DisplayWithLayersTestCommon;
+
+TEST_F(DisplaySupportsOffloadPresentTest, checksDisplayCapability) {
+    EXPECT_CALL(mHwComposer,
+                hasDisplayCapability(HalDisplayId(DEFAULT_DISPLAY_ID),
+                                     DisplayCapability::MULTI_THREADED_PRESENT))
+            .WillOnce(Return(true));
+    EXPECT_TRUE(mDisplay->supportsOffloadPresent());
+}
+
+TEST_F(DisplaySupportsOffloadPresentTest, isFalseWithPowerHintSession) {
+    EXPECT_CALL(mPowerAdvisor, usePowerHintSession()).WillRepeatedly(Return(true));
+    EXPECT_FALSE(mDisplay->supportsOffloadPresent());
+}
+
+TEST_F(DisplaySupportsOffloadPresentTest, isFalseForGpuDisplay) {
+    auto args = getDisplayCreationArgsForGpuVirtualDisplay();
+    auto gpuDisplay{impl::createDisplay(mCompositionEngine, args)};
+    EXPECT_FALSE(gpuDisplay->supportsOffloadPresent());
+}
+
 /*
  * Display::anyLayersRequireClientComposition()
  */
@@ -19,6 +19,8 @@
 #include <gui/BufferQueue.h>
 #include <ui/GraphicBuffer.h>
 
+#include <vector>
+
 namespace android::compositionengine {
 namespace {
 
@@ -85,6 +87,27 @@ TEST_F(HwcBufferCacheTest, getHwcSlotAndBuffer_whenSlotsFull_evictsOldestCachedB
     EXPECT_EQ(cache.uncache(graphicBuffers[0]->getId()), UINT32_MAX);
 }
 
+TEST_F(HwcBufferCacheTest, getStats_countsHitsMissesAndEvictions) {
+    HwcBufferCache cache;
+
+    cache.getHwcSlotAndBuffer(mBuffer1);
+    cache.getHwcSlotAndBuffer(mBuffer1);
+    cache.getHwcSlotAndBuffer(mBuffer2);
+    EXPECT_EQ(cache.getStats().hits, 1u);
+    EXPECT_EQ(cache.getStats().misses, 2u);
+    EXPECT_EQ(cache.getStats().evictions, 0u);
+
+    // Fill every remaining slot, then one more buffer causes a single eviction.
+    std::vector<sp<GraphicBuffer>> graphicBuffers;
+    for (size_t i = 0; i < BufferQueue::NUM_BUFFER_SLOTS - 1; ++i) {
+        graphicBuffers.push_back(
+                sp<GraphicBuffer>::make(1u, 1u, HAL_PIXEL_FORMAT_RGBA_8888, 1u, 0u));
+        cache.getHwcSlotAndBuffer(graphicBuffers.back());
+    }
+    EXPECT_EQ(cache.getStats().misses, BufferQueue::NUM_BUFFER_SLOTS + 1u);
+    EXPECT_EQ(cache.getStats().evictions, 1u);
+}
+
 TEST_F(HwcBufferCacheTest, uncache_whenCached_returnsSlotNumber) {
     HwcBufferCache cache;
     sp<GraphicBuffer> outBuffer;
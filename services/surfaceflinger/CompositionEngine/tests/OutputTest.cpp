@@ -35,6 +35,7 @@
 
 #include <cmath>
 #include <cstdint>
+#include <thread>
 
 #include "CallOrderStateMachineHelper.h"
 #include "MockHWC2.h"
@@ -1164,6 +1165,80 @@ TEST_F(OutputPrepareFrameAsyncTest, predictionMiss) {
     EXPECT_TRUE(result.bufferAvailable());
 }
 
+/*
+ * Output::canPredictCompositionStrategy()
+ */
+
+struct OutputCanPredictCompositionStrategyTest : public testing::Test {
+    struct OutputPartialMock : public OutputPartialMockBase {
+        // Sets up the helper functions called by the function under test to use
+        // mock implementations.
+        MOCK_METHOD1(chooseCompositionStrategy,
+                     bool(std::optional<android::HWComposer::DeviceRequestedChanges>*));
+        MOCK_METHOD0(resetCompositionStrategy, void());
+        MOCK_CONST_METHOD0(anyLayersRequireClientComposition, bool());
+    };
+
+    OutputCanPredictCompositionStrategyTest() {
+        mOutput.setRenderSurfaceForTest(std::unique_ptr<RenderSurface>(mRenderSurface));
+        mOutput.setPredictCompositionStrategy(true);
+        mOutput.editState().isEnabled = true;
+
+        EXPECT_CALL(*mRenderSurface, supportsCompositionStrategyPrediction())
+                .WillRepeatedly(Return(true));
+        EXPECT_CALL(*mRenderSurface, prepareFrame(_, _)).WillRepeatedly(Return());
+        EXPECT_CALL(mOutput, anyLayersRequireClientComposition()).WillRepeatedly(Return(true));
+        EXPECT_CALL(mOutput, resetCompositionStrategy()).WillRepeatedly(Return());
+    }
+
+    // Runs a frame with the given output layers, for which the HWC chooses the given strategy.
+    bool composeFrame(uint64_t outputLayerHash,
+                      const android::HWComposer::DeviceRequestedChanges& changes) {
+        mOutput.editState().outputLayerHash = outputLayerHash;
+        const bool canPredict = mOutput.canPredictCompositionStrategy(mRefreshArgs);
+        EXPECT_CALL(mOutput, chooseCompositionStrategy(_))
+                .WillOnce(DoAll(SetArgPointee<0>(changes), Return(true)));
+        mOutput.prepareFrame();
+        return canPredict;
+    }
+
+    mock::RenderSurface* mRenderSurface = new StrictMock<mock::RenderSurface>();
+    StrictMock<OutputPartialMock> mOutput;
+    CompositionRefreshArgs mRefreshArgs;
+};
+
+TEST_F(OutputCanPredictCompositionStrategyTest, predictsWhenLayersAreUnchanged) {
+    const android::HWComposer::DeviceRequestedChanges changes{};
+
+    EXPECT_FALSE(composeFrame(1u, changes));
+    EXPECT_TRUE(composeFrame(1u, changes));
+}
+
+TEST_F(OutputCanPredictCompositionStrategyTest, predictsCachedStrategyOfRecentLayers) {
+    android::HWComposer::DeviceRequestedChanges changesA{};
+    changesA.displayRequests = static_cast<hal::DisplayRequest>(1);
+    const android::HWComposer::DeviceRequestedChanges changesB{};
+
+    EXPECT_FALSE(composeFrame(1u, changesA));
+    EXPECT_FALSE(composeFrame(2u, changesB));
+
+    mOutput.editState().outputLayerHash = 1u;
+    EXPECT_TRUE(mOutput.canPredictCompositionStrategy(mRefreshArgs));
+    EXPECT_EQ(changesA, mOutput.getState().previousDeviceRequestedChanges);
+}
+
+TEST_F(OutputCanPredictCompositionStrategyTest, evictsLeastRecentlyUsedStrategy) {
+    const android::HWComposer::DeviceRequestedChanges changes{};
+
+    // One more configuration than the cache holds
+    for (uint64_t hash = 1u; hash <= 5u; hash++) {
+        EXPECT_FALSE(composeFrame(hash, changes));
+    }
+
+    EXPECT_FALSE(composeFrame(1u, changes));
+    EXPECT_TRUE(composeFrame(3u, changes));
+}
+
 /*
  * Output::prepare()
  */
@@ -1422,6 +1497,58 @@ TEST_F(OutputCollectVisibleLayersTest, processesCandidateLayersReversedAndSetsOu
     mOutput.collectVisibleLayers(mRefreshArgs, mCoverageState);
 }
 
+TEST_F(OutputCollectVisibleLayersTest, skipsLayersRejectedByLayerVisibility) {
+    const ui::LayerStack layerStack{1};
+    const ui::LayerStack otherLayerStack{2};
+    mOutput.mState.layerFilter = {layerStack, false};
+    mRefreshArgs.layerVisibility.outputFilters = {{layerStack, false},
+                                                  {layerStack, false},
+                                                  {otherLayerStack, false}};
+    mRefreshArgs.layerVisibility.isVisible = {true, false, true};
+    mRefreshArgs.layerVisibility.coverageGenerations = {0, 0, 0};
+
+    EXPECT_CALL(mOutput, ensureOutputLayerIfVisible(Eq(mLayer1.layerFE), Ref(mCoverageState)));
+
+    EXPECT_CALL(mOutput, setReleasedLayers(Ref(mRefreshArgs)));
+    EXPECT_CALL(mOutput, finalizePendingOutputLayers());
+
+    mOutput.collectVisibleLayers(mRefreshArgs, mCoverageState);
+}
+
+TEST_F(OutputCollectVisibleLayersTest, reusesCoverageOfLayersAboveFirstChangedLayer) {
+    const ui::LayerStack layerStack{1};
+    mOutput.mState.layerFilter = {layerStack, false};
+    mRefreshArgs.layerVisibility.outputFilters = {{layerStack, false},
+                                                  {layerStack, false},
+                                                  {layerStack, false}};
+    mRefreshArgs.layerVisibility.isVisible = {true, true, true};
+    mRefreshArgs.layerVisibility.coverageGenerations = {5, 6, 7};
+    EXPECT_CALL(mLayer3.outputLayer, getLayerFE()).WillRepeatedly(ReturnRef(*mLayer3.layerFE));
+
+    const Region kCoveredByLayer3{Rect(0, 0, 10, 10)};
+    EXPECT_CALL(mOutput, ensureOutputLayerIfVisible(Eq(mLayer3.layerFE), _))
+            .WillOnce(Invoke([&](sp<compositionengine::LayerFE>&,
+                                 compositionengine::Output::CoverageState& coverage) {
+                coverage.aboveCoveredLayers = kCoveredByLayer3;
+            }));
+    EXPECT_CALL(mOutput, ensureOutputLayerIfVisible(Eq(mLayer2.layerFE), _)).Times(2);
+    EXPECT_CALL(mOutput, ensureOutputLayerIfVisible(Eq(mLayer1.layerFE), _)).Times(2);
+    EXPECT_CALL(mOutput, setReleasedLayers(Ref(mRefreshArgs))).Times(2);
+    EXPECT_CALL(mOutput, finalizePendingOutputLayers()).Times(2);
+
+    mOutput.collectVisibleLayers(mRefreshArgs, mCoverageState);
+
+    // Only the middle layer changed, so the top layer is carried over as is.
+    mRefreshArgs.layerVisibility.coverageGenerations = {5, 8, 7};
+    EXPECT_CALL(mOutput, ensureOutputLayer(Eq(std::optional<size_t>(2)), Eq(mLayer3.layerFE)))
+            .WillOnce(Return(&mLayer3.outputLayer));
+
+    LayerFESet latchedLayers;
+    Output::CoverageState coverage{latchedLayers};
+    mOutput.collectVisibleLayers(mRefreshArgs, coverage);
+    EXPECT_THAT(coverage.aboveCoveredLayers, RegionEq(kCoveredByLayer3));
+}
+
 /*
  * Output::ensureOutputLayerIfVisible()
  */
@@ -2071,6 +2198,37 @@ TEST_F(OutputPresentTest, predictingCompositionStrategyInvokesPrepareFrameAsync)
     mOutput.present(args);
 }
 
+TEST_F(OutputPresentTest, offloadedPresentPostsFramebufferOnWorkerForOneFrame) {
+    CompositionRefreshArgs args;
+
+    std::thread::id postFramebufferThread;
+    const auto expectPresent = [&] {
+        EXPECT_CALL(mOutput, updateColorProfile(Ref(args)));
+        EXPECT_CALL(mOutput, updateCompositionState(Ref(args)));
+        EXPECT_CALL(mOutput, planComposition());
+        EXPECT_CALL(mOutput, writeCompositionState(Ref(args)));
+        EXPECT_CALL(mOutput, setColorTransform(Ref(args)));
+        EXPECT_CALL(mOutput, beginFrame());
+        EXPECT_CALL(mOutput, canPredictCompositionStrategy(Ref(args))).WillOnce(Return(false));
+        EXPECT_CALL(mOutput, prepareFrame());
+        EXPECT_CALL(mOutput, devOptRepaintFlash(Ref(args)));
+        EXPECT_CALL(mOutput, finishFrame(_));
+        EXPECT_CALL(mOutput, postFramebuffer()).WillOnce([&] {
+            postFramebufferThread = std::this_thread::get_id();
+        });
+        EXPECT_CALL(mOutput, renderCachedSets(Ref(args)));
+    };
+
+    expectPresent();
+    mOutput.offloadPresentNextFrame();
+    mOutput.present(args).get();
+    EXPECT_NE(std::this_thread::get_id(), postFramebufferThread);
+
+    expectPresent();
+    mOutput.present(args).get();
+    EXPECT_EQ(std::this_thread::get_id(), postFramebufferThread);
+}
+
 /*
  * Output::updateColorProfile()
  */
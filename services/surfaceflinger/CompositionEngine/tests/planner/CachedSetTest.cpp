@@ -26,12 +26,14 @@
 #include <renderengine/mock/RenderEngine.h>
 #include <ui/GraphicTypes.h>
 #include <utils/Errors.h>
+#include <future>
 #include <memory>
 
 namespace android::compositionengine {
 using namespace std::chrono_literals;
 
 using testing::_;
+using testing::ByMove;
 using testing::DoAll;
 using testing::Invoke;
 using testing::Return;
@@ -362,6 +364,7 @@ TEST_F(CachedSetTest, renderUnsecureOutput) {
         EXPECT_EQ(0.5f, layers[0].alpha);
         EXPECT_EQ(0.75f, layers[1].alpha);
         EXPECT_EQ(ui::Dataspace::SRGB, displaySettings.outputDataspace);
+        EXPECT_EQ(renderengine::DisplaySettings::Priority::CACHED_SET, displaySettings.priority);
         return ftl::yield<FenceResult>(Fence::NO_FENCE);
     };
 
@@ -382,6 +385,36 @@ TEST_F(CachedSetTest, renderUnsecureOutput) {
     cachedSet.append(CachedSet(layer3));
 }
 
+TEST_F(CachedSetTest, renderDoesNotWaitForRenderEngine) {
+    CachedSet::Layer& layer1 = *mTestLayers[1]->cachedSetLayer.get();
+    sp<mock::LayerFE> layerFE1 = mTestLayers[1]->layerFE;
+    CachedSet::Layer& layer2 = *mTestLayers[2]->cachedSetLayer.get();
+    sp<mock::LayerFE> layerFE2 = mTestLayers[2]->layerFE;
+
+    CachedSet cachedSet(layer1);
+    cachedSet.append(CachedSet(layer2));
+
+    std::promise<FenceResult> drawResult;
+    EXPECT_CALL(*layerFE1, prepareClientComposition(_))
+            .WillOnce(Return(std::optional<compositionengine::LayerFE::LayerSettings>()));
+    EXPECT_CALL(*layerFE2, prepareClientComposition(_))
+            .WillOnce(Return(std::optional<compositionengine::LayerFE::LayerSettings>()));
+    EXPECT_CALL(mRenderEngine, drawLayers(_, _, _, _, _))
+            .WillOnce(Return(ByMove(ftl::Future<FenceResult>(drawResult.get_future()))));
+    cachedSet.render(mRenderEngine, mTexturePool, mOutputState, true);
+
+    // RenderEngine has not finished, so there is nothing to show for the render yet.
+    EXPECT_TRUE(cachedSet.hasPendingRender());
+    EXPECT_FALSE(cachedSet.hasRenderedBuffer());
+    EXPECT_FALSE(cachedSet.collectPendingRender());
+
+    drawResult.set_value(Fence::NO_FENCE);
+    EXPECT_TRUE(cachedSet.collectPendingRender());
+    EXPECT_FALSE(cachedSet.hasPendingRender());
+    expectReadyBuffer(cachedSet);
+    EXPECT_EQ(mOutputState.framebufferSpace, cachedSet.getOutputSpace());
+}
+
 TEST_F(CachedSetTest, renderSecureOutput) {
     // Skip the 0th layer to ensure that the bounding box of the layers is offset from (0, 0)
     CachedSet::Layer& layer1 = *mTestLayers[1]->cachedSetLayer.get();
@@ -131,6 +131,29 @@ TEST_F(TexturePoolTest, reallocatesWhenDisplaySizeChanges) {
               static_cast<int32_t>(texture->get()->getBuffer()->getHeight()));
 }
 
+TEST_F(TexturePoolTest, freesBuffersWhenIdle) {
+    const auto now = std::chrono::steady_clock::now();
+    mTexturePool.releaseIdleTextures(now);
+    EXPECT_EQ(mTexturePool.getMinPoolSize(), mTexturePool.getPoolSize());
+
+    mTexturePool.releaseIdleTextures(now + TexturePool::kDefaultIdleTimeout);
+    EXPECT_EQ(0u, mTexturePool.getPoolSize());
+
+    // The pool regrows once textures are used again.
+    mTexturePool.borrowTexture();
+    EXPECT_EQ(1u, mTexturePool.getPoolSize());
+}
+
+TEST_F(TexturePoolTest, doesNotFreeBorrowedBuffersWhenIdle) {
+    auto texture = mTexturePool.borrowTexture();
+    mTexturePool.releaseIdleTextures(std::chrono::steady_clock::now() +
+                                     TexturePool::kDefaultIdleTimeout);
+    EXPECT_EQ(0u, mTexturePool.getPoolSize());
+
+    texture.reset();
+    EXPECT_EQ(1u, mTexturePool.getPoolSize());
+}
+
 TEST_F(TexturePoolTest, freesBuffersWhenDisabled) {
     EXPECT_EQ(mTexturePool.getPoolSize(), mTexturePool.getMinPoolSize());
 
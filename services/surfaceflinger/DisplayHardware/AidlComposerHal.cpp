@@ -22,6 +22,7 @@
 
 #include <SurfaceFlingerProperties.h>
 #include <android-base/file.h>
+#include <android-base/properties.h>
 #include <android/binder_ibinder_platform.h>
 #include <android/binder_manager.h>
 #include <gui/TraceUtils.h>
@@ -1056,6 +1057,9 @@ Error AidlComposer::execute(Display display) {
     }
 
     { // scope for results
+        // Each call is one round trip to the HAL, carrying every command written since the last.
+        ATRACE_FORMAT("HwcExecuteCommands %" PRId64 " (%zu commands)", translate<int64_t>(display),
+                      commands.size());
         std::vector<CommandResultPayload> results;
         auto status = mAidlComposerClient->executeCommands(commands, &results);
         if (!status.isOk()) {
@@ -1540,8 +1544,11 @@ void AidlComposer::onHotplugDisconnect(Display display) {
 }
 
 bool AidlComposer::hasMultiThreadedPresentSupport(Display display) {
-#if 0
-    // TODO (b/259132483): Reenable
+    // Separate readers are only needed once SurfaceFlinger presents displays concurrently.
+    if (!base::GetBoolProperty("debug.sf.multithreaded_present", false)) {
+        return false;
+    }
+
     const auto displayId = translate<int64_t>(display);
     std::vector<AidlDisplayCapability> capabilities;
     const auto status = mAidlComposerClient->getDisplayCapabilities(displayId, &capabilities);
@@ -1551,10 +1558,6 @@ bool AidlComposer::hasMultiThreadedPresentSupport(Display display) {
     }
     return std::find(capabilities.begin(), capabilities.end(),
                      AidlDisplayCapability::MULTI_THREADED_PRESENT) != capabilities.end();
-#else
-    (void) display;
-    return false;
-#endif
 }
 
 void AidlComposer::addReader(Display display) {
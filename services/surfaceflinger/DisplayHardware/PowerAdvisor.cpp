@@ -22,6 +22,7 @@
 #define LOG_TAG "PowerAdvisor"
 
 #include <unistd.h>
+#include <algorithm>
 #include <cinttypes>
 #include <cstdint>
 #include <optional>
@@ -265,6 +266,13 @@ void PowerAdvisor::reportActualWorkDuration() {
                      Duration{*actualDuration - mLastTargetDurationSent}.ns());
     }
 
+    if (mHintSessionQueue.size() < mHintSessionBatchSize &&
+        *actualDuration <= mLastTargetDurationSent) {
+        ALOGV("Queued actual work duration of: %" PRId64 ", %zu durations pending",
+              actualDuration->ns(), mHintSessionQueue.size());
+        return;
+    }
+
     ALOGV("Sending actual work duration of: %" PRId64 " on reported target: %" PRId64
           " with error: %" PRId64,
           actualDuration->ns(), mLastTargetDurationSent.ns(),
@@ -385,8 +393,31 @@ void PowerAdvisor::setCommitStart(TimePoint commitStartTime) {
     mCommitStartTimes.append(commitStartTime);
 }
 
+void PowerAdvisor::setCompositeStart(TimePoint compositeStartTime) {
+    mCompositeStartTime = compositeStartTime;
+    if (!mCommitStartTimes.isFull() || !mTotalFrameTargetDuration || !mLastCompositeDuration) {
+        return;
+    }
+
+    // SurfaceFlinger's work for the frame must end by this deadline for it to present on time.
+    const TimePoint deadline = mCommitStartTimes[0] + *mTotalFrameTargetDuration;
+    const Duration remainingDuration = deadline - compositeStartTime;
+    if (sTraceHintSessionData) ATRACE_INT64("Remaining composite budget", remainingDuration.ns());
+
+    // The target duration only takes effect from the next frame, so boost the session threads
+    // (the main and RenderEngine threads) now rather than miss the deadline.
+    if (remainingDuration < *mLastCompositeDuration) {
+        ATRACE_NAME("Composite behind deadline");
+        notifyCpuLoadUp();
+    }
+}
+
 void PowerAdvisor::setCompositeEnd(TimePoint compositeEndTime) {
     mLastPostcompDuration = compositeEndTime - mLastSfPresentEndTime;
+    if (mCompositeStartTime) {
+        mLastCompositeDuration = compositeEndTime - *mCompositeStartTime;
+        mCompositeStartTime.reset();
+    }
 }
 
 void PowerAdvisor::setDisplays(std::vector<DisplayId>& displayIds) {
@@ -583,6 +614,9 @@ const Duration PowerAdvisor::sTargetSafetyMargin = std::chrono::microseconds(
 const bool PowerAdvisor::sUseReportActualDuration =
         base::GetBoolProperty(std::string("debug.adpf.use_report_actual_duration"), true);
 
+const size_t PowerAdvisor::sHintSessionBatchSize = static_cast<size_t>(
+        std::max(base::GetIntProperty<int32_t>("debug.sf.hint_batch_size", 1), 1));
+
 power::PowerHalController& PowerAdvisor::getPowerHal() {
     static std::once_flag halFlag;
     std::call_once(halFlag, [this] { mPowerHal->init(); });
@@ -88,6 +88,9 @@ public:
     virtual void setFrameDelay(Duration frameDelayDuration) = 0;
     // Reports the SurfaceFlinger commit start time this frame
     virtual void setCommitStart(TimePoint commitStartTime) = 0;
+    // Reports the SurfaceFlinger composite start time this frame, boosting the hint session if
+    // composition is unlikely to finish within the frame's remaining budget
+    virtual void setCompositeStart(TimePoint compositeStartTime) = 0;
     // Reports the SurfaceFlinger composite end time this frame
     virtual void setCompositeEnd(TimePoint compositeEndTime) = 0;
     // Reports the list of the currently active displays
@@ -131,6 +134,7 @@ public:
 
     void setFrameDelay(Duration frameDelayDuration) override;
     void setCommitStart(TimePoint commitStartTime) override;
+    void setCompositeStart(TimePoint compositeStartTime) override;
     void setCompositeEnd(TimePoint compositeEndTime) override;
     void setDisplays(std::vector<DisplayId>& displayIds) override;
     void setTotalFrameTargetWorkDuration(Duration targetDuration) override;
@@ -226,6 +230,11 @@ private:
     Duration mFrameDelayDuration{0ns};
     // Last frame's post-composition duration
     Duration mLastPostcompDuration{0ns};
+    // Current frame's composite start time
+    std::optional<TimePoint> mCompositeStartTime;
+    // Last frame's composite duration, used to tell whether this frame's composition can still
+    // finish within its budget
+    std::optional<Duration> mLastCompositeDuration;
     // Buffer of recent commit start times
     RingBuffer<TimePoint, 2> mCommitStartTimes;
     // Buffer of recent expected present times
@@ -254,6 +263,10 @@ private:
     bool mHasDisplayUpdateImminent = true;
     // Queue of actual durations saved to report
     std::vector<hardware::power::WorkDuration> mHintSessionQueue;
+    // Number of actual durations to queue before reporting them in a single call. Durations that
+    // exceed the target are reported right away along with the queue, so that the HAL can react
+    // to a missed target without delay.
+    size_t mHintSessionBatchSize = sHintSessionBatchSize;
     // The latest values we have received for target and actual
     Duration mTargetDuration = kDefaultTargetDuration;
     std::optional<Duration> mActualDuration;
@@ -274,6 +287,8 @@ private:
     // Whether we should send reportActualWorkDuration calls
     static const bool sUseReportActualDuration;
 
+    static const size_t sHintSessionBatchSize;
+
     // How long we expect hwc to run after the present call until it waits for the fence
     static constexpr const Duration kFenceWaitStartDelayValidated{150us};
     static constexpr const Duration kFenceWaitStartDelaySkippedValidate{250us};
@@ -21,9 +21,12 @@
 #include "FrameTimeline.h"
 
 #include <android-base/stringprintf.h>
+#include <android-base/thread_annotations.h>
+#include <pthread.h>
 #include <utils/Log.h>
 #include <utils/Trace.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cinttypes>
 #include <numeric>
@@ -743,25 +746,23 @@ namespace impl {
 int64_t TokenManager::generateTokenForPredictions(TimelineItem&& predictions) {
     ATRACE_CALL();
     std::scoped_lock lock(mMutex);
-    while (mPredictions.size() >= kMaxTokens) {
-        mPredictions.erase(mPredictions.begin());
-    }
     const int64_t assignedToken = mCurrentToken++;
-    mPredictions[assignedToken] = predictions;
+    mPredictions[static_cast<size_t>(assignedToken) % kMaxTokens] = predictions;
+    mPredictionCount = std::min(mPredictionCount + 1, kMaxTokens);
     return assignedToken;
 }
 
 std::optional<TimelineItem> TokenManager::getPredictionsForToken(int64_t token) const {
     std::scoped_lock lock(mMutex);
-    auto predictionsIterator = mPredictions.find(token);
-    if (predictionsIterator != mPredictions.end()) {
-        return predictionsIterator->second;
+    if (token >= mCurrentToken || token < mCurrentToken - static_cast<int64_t>(mPredictionCount)) {
+        return {};
     }
-    return {};
+    return mPredictions[static_cast<size_t>(token) % kMaxTokens];
 }
 
 FrameTimeline::FrameTimeline(std::shared_ptr<TimeStats> timeStats, pid_t surfaceFlingerPid,
-                             JankClassificationThresholds thresholds, bool useBootTimeClock)
+                             JankClassificationThresholds thresholds, bool useBootTimeClock,
+                             bool classifyOnWorkerThread)
       : mUseBootTimeClock(useBootTimeClock),
         mMaxDisplayFrames(kDefaultMaxDisplayFrames),
         mTimeStats(std::move(timeStats)),
@@ -769,6 +770,49 @@ FrameTimeline::FrameTimeline(std::shared_ptr<TimeStats> timeStats, pid_t surface
         mJankClassificationThresholds(thresholds) {
     mCurrentDisplayFrame =
             std::make_shared<DisplayFrame>(mTimeStats, thresholds, &mTraceCookieCounter);
+
+    if (classifyOnWorkerThread) {
+        mClassificationThread = std::thread(&FrameTimeline::classificationThreadMain, this);
+        pthread_setname_np(mClassificationThread.native_handle(), "FrameTimeline");
+    }
+}
+
+FrameTimeline::~FrameTimeline() {
+    if (!mClassificationThread.joinable()) {
+        return;
+    }
+
+    {
+        std::scoped_lock lock(mMutex);
+        mClassificationThreadDone = true;
+    }
+    mClassificationCv.notify_all();
+    mClassificationThread.join();
+}
+
+void FrameTimeline::classificationThreadMain() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    base::ScopedLockAssertion assumeLock(mMutex);
+    while (true) {
+        mClassificationCv.wait(lock, [this]() REQUIRES(mMutex) {
+            return mClassificationRequested || mClassificationThreadDone;
+        });
+        if (mClassificationThreadDone) {
+            break;
+        }
+
+        mClassificationRequested = false;
+        flushPendingPresentFences();
+        mClassificationCv.notify_all();
+    }
+}
+
+void FrameTimeline::waitForClassification() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    base::ScopedLockAssertion assumeLock(mMutex);
+    mClassificationCv.wait(lock, [this]() REQUIRES(mMutex) {
+        return !mClassificationRequested || mClassificationThreadDone;
+    });
 }
 
 void FrameTimeline::onBootFinished() {
@@ -839,12 +883,19 @@ void FrameTimeline::setSfPresent(nsecs_t sfPresentTime,
                                  const std::shared_ptr<FenceTime>& presentFence,
                                  const std::shared_ptr<FenceTime>& gpuFence) {
     ATRACE_CALL();
-    std::scoped_lock lock(mMutex);
-    mCurrentDisplayFrame->setActualEndTime(sfPresentTime);
-    mCurrentDisplayFrame->setGpuFence(gpuFence);
-    mPendingPresentFences.emplace_back(std::make_pair(presentFence, mCurrentDisplayFrame));
-    flushPendingPresentFences();
-    finalizeCurrentDisplayFrame();
+    {
+        std::scoped_lock lock(mMutex);
+        mCurrentDisplayFrame->setActualEndTime(sfPresentTime);
+        mCurrentDisplayFrame->setGpuFence(gpuFence);
+        mPendingPresentFences.emplace_back(std::make_pair(presentFence, mCurrentDisplayFrame));
+        if (mClassificationThread.joinable()) {
+            mClassificationRequested = true;
+        } else {
+            flushPendingPresentFences();
+        }
+        finalizeCurrentDisplayFrame();
+    }
+    mClassificationCv.notify_all();
 }
 
 void FrameTimeline::DisplayFrame::addSurfaceFrame(std::shared_ptr<SurfaceFrame> surfaceFrame) {
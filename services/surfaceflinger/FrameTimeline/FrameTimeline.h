@@ -16,13 +16,16 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <deque>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
 
 #include <gui/ISurfaceComposer.h>
 #include <gui/JankInfo.h>
@@ -341,10 +344,14 @@ private:
 
     void flushTokens(nsecs_t flushTime) REQUIRES(mMutex);
 
-    std::map<int64_t, TimelineItem> mPredictions GUARDED_BY(mMutex);
+    static constexpr size_t kMaxTokens = 500;
+
+    // Tokens are generated sequentially and only the most recent kMaxTokens predictions are kept,
+    // so they are stored in a ring indexed by token rather than in a node-based map.
+    std::array<TimelineItem, kMaxTokens> mPredictions GUARDED_BY(mMutex);
+    size_t mPredictionCount GUARDED_BY(mMutex) = 0;
     int64_t mCurrentToken GUARDED_BY(mMutex);
     mutable std::mutex mMutex;
-    static constexpr size_t kMaxTokens = 500;
 };
 
 class FrameTimeline : public android::frametimeline::FrameTimeline {
@@ -443,9 +450,12 @@ public:
         TraceCookieCounter& mTraceCookieCounter;
     };
 
+    // If classifyOnWorkerThread is set, present fences are polled and display frames classified
+    // on a dedicated thread instead of in setSfPresent.
     FrameTimeline(std::shared_ptr<TimeStats> timeStats, pid_t surfaceFlingerPid,
-                  JankClassificationThresholds thresholds = {}, bool useBootTimeClock = true);
-    ~FrameTimeline() = default;
+                  JankClassificationThresholds thresholds = {}, bool useBootTimeClock = true,
+                  bool classifyOnWorkerThread = false);
+    ~FrameTimeline();
 
     frametimeline::TokenManager* getTokenManager() override { return &mTokenManager; }
     std::shared_ptr<SurfaceFrame> createSurfaceFrameForToken(
@@ -476,6 +486,9 @@ private:
     void flushPendingPresentFences() REQUIRES(mMutex);
     std::optional<size_t> getFirstSignalFenceIndex() const REQUIRES(mMutex);
     void finalizeCurrentDisplayFrame() REQUIRES(mMutex);
+    void classificationThreadMain();
+    // Blocks until the classification thread has flushed the fences queued so far.
+    void waitForClassification() EXCLUDES(mMutex);
     void dumpAll(std::string& result);
     void dumpJank(std::string& result);
 
@@ -487,6 +500,12 @@ private:
     TokenManager mTokenManager;
     TraceCookieCounter mTraceCookieCounter;
     mutable std::mutex mMutex;
+    // Signaled when present fences are queued for the classification thread, and when it is done
+    // flushing them.
+    std::condition_variable mClassificationCv;
+    bool mClassificationRequested GUARDED_BY(mMutex) = false;
+    bool mClassificationThreadDone GUARDED_BY(mMutex) = false;
+    std::thread mClassificationThread;
     const bool mUseBootTimeClock;
     uint32_t mMaxDisplayFrames;
     std::shared_ptr<TimeStats> mTimeStats;
@@ -177,7 +177,7 @@ LayerHierarchyBuilder::LayerHierarchyBuilder(
     mLayerIdToHierarchy.reserve(layers.size());
     for (auto& layer : layers) {
         mHierarchies.emplace_back(std::make_unique<LayerHierarchy>(layer.get()));
-        mLayerIdToHierarchy[layer->id] = mHierarchies.back().get();
+        mLayerIdToHierarchy.emplace_or_replace(layer->id, mHierarchies.back().get());
     }
     for (const auto& layer : layers) {
         onLayerAdded(layer.get());
@@ -320,7 +320,7 @@ void LayerHierarchyBuilder::update(
     for (auto& layer : layers) {
         if (layer->changes.test(RequestedLayerState::Changes::Created)) {
             mHierarchies.emplace_back(std::make_unique<LayerHierarchy>(layer.get()));
-            mLayerIdToHierarchy[layer->id] = mHierarchies.back().get();
+            mLayerIdToHierarchy.emplace_or_replace(layer->id, mHierarchies.back().get());
         }
     }
 
@@ -18,6 +18,7 @@
 
 #include "FrontEnd/LayerCreationArgs.h"
 #include "RequestedLayerState.h"
+#include "ftl/flat_map.h"
 #include "ftl/small_vector.h"
 
 namespace android::surfaceflinger::frontend {
@@ -203,7 +204,7 @@ private:
     void onLayerDestroyed(RequestedLayerState* layer);
     void updateMirrorLayer(RequestedLayerState* layer);
     LayerHierarchy* getHierarchyFromId(uint32_t layerId, bool crashOnFailure = true);
-    std::unordered_map<uint32_t, LayerHierarchy*> mLayerIdToHierarchy;
+    ftl::FlatMap<uint32_t, LayerHierarchy*> mLayerIdToHierarchy;
     std::vector<std::unique_ptr<LayerHierarchy>> mHierarchies;
     LayerHierarchy mRoot{nullptr};
     LayerHierarchy mOffscreenRoot{nullptr};
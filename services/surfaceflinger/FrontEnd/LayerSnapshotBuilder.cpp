@@ -19,6 +19,7 @@
 #undef LOG_TAG
 #define LOG_TAG "SurfaceFlinger"
 
+#include <algorithm>
 #include <numeric>
 #include <optional>
 
@@ -33,6 +34,7 @@
 #include "LayerSnapshotBuilder.h"
 #include "TimeStats/TimeStats.h"
 #include "Tracing/TransactionTracing.h"
+#include "WorkerPool.h"
 
 namespace android::surfaceflinger::frontend {
 
@@ -337,6 +339,15 @@ uint32_t getPrimaryDisplayRotationFlags(
     return 0;
 }
 
+// Changes of a snapshot that the snapshots of its children inherit.
+ftl::Flags<RequestedLayerState::Changes> getInheritedChanges(const LayerSnapshot& parentSnapshot) {
+    return parentSnapshot.changes &
+            (RequestedLayerState::Changes::Hierarchy | RequestedLayerState::Changes::Geometry |
+             RequestedLayerState::Changes::Visibility | RequestedLayerState::Changes::Metadata |
+             RequestedLayerState::Changes::AffectsChildren |
+             RequestedLayerState::Changes::FrameRate | RequestedLayerState::Changes::GameMode);
+}
+
 } // namespace
 
 LayerSnapshot LayerSnapshotBuilder::getRootSnapshot() {
@@ -376,6 +387,13 @@ LayerSnapshotBuilder::LayerSnapshotBuilder(Args args) : LayerSnapshotBuilder() {
     updateSnapshots(args);
 }
 
+LayerSnapshotBuilder::~LayerSnapshotBuilder() = default;
+
+void LayerSnapshotBuilder::setParallelUpdateThreads(size_t numThreads) {
+    mParallelUpdateThreads = numThreads;
+    mWorkerPool.reset();
+}
+
 bool LayerSnapshotBuilder::tryFastUpdate(const Args& args) {
     const bool forceUpdate = args.forceUpdate != ForceUpdateFlags::NONE;
 
@@ -436,9 +454,12 @@ void LayerSnapshotBuilder::updateSnapshots(const Args& args) {
         mRootSnapshot.clientChanges |= layer_state_t::eReparent;
     }
 
-    for (auto& snapshot : mSnapshots) {
-        if (snapshot->reachablilty == LayerSnapshot::Reachablilty::Reachable) {
-            snapshot->reachablilty = LayerSnapshot::Reachablilty::Unreachable;
+    // A partial update only skips subtrees whose reachability can't have changed.
+    if (!mPartialUpdate) {
+        for (auto& snapshot : mSnapshots) {
+            if (snapshot->reachablilty == LayerSnapshot::Reachablilty::Reachable) {
+                snapshot->reachablilty = LayerSnapshot::Reachablilty::Unreachable;
+            }
         }
     }
 
@@ -449,8 +470,11 @@ void LayerSnapshotBuilder::updateSnapshots(const Args& args) {
         LayerHierarchy::ScopedAddToTraversalPath addChildToPath(root, args.root.getLayer()->id,
                                                                 LayerHierarchy::Variant::Attached);
         updateSnapshotsInHierarchy(args, args.root, root, mRootSnapshot, /*depth=*/0);
-    } else {
+    } else if (!updateSnapshotsInParallel(args)) {
         for (auto& [childHierarchy, variant] : args.root.mChildren) {
+            if (canSkipSubtree(*childHierarchy, mRootSnapshot)) {
+                continue;
+            }
             LayerHierarchy::ScopedAddToTraversalPath addChildToPath(root,
                                                                     childHierarchy->getLayer()->id,
                                                                     variant);
@@ -507,15 +531,193 @@ void LayerSnapshotBuilder::updateSnapshots(const Args& args) {
     }
 }
 
+bool LayerSnapshotBuilder::updateSnapshotsInParallel(const Args& args) {
+    const size_t numRoots = args.root.mChildren.size();
+    if (mParallelUpdateThreads == 0 || numRoots < 2 || mPartialUpdate) {
+        return false;
+    }
+    ATRACE_NAME("ParallelUpdate");
+    if (!mWorkerPool) {
+        // Created on first use, so that the threads inherit the scheduling policy of the thread
+        // updating the snapshots rather than of the one that configured the builder.
+        mWorkerPool = std::make_unique<WorkerPool>(mParallelUpdateThreads, "SnapshotBuilder");
+    }
+
+    // Snapshots are only created here, so that the update below just looks them up. Subtrees
+    // that reach the same snapshot, through relative parents, are grouped together.
+    std::vector<size_t> rootGroups(numRoots);
+    std::iota(rootGroups.begin(), rootGroups.end(), 0);
+    mSnapshotRootIndex.clear();
+    for (size_t i = 0; i < numRoots; i++) {
+        auto& [childHierarchy, variant] = args.root.mChildren[i];
+        LayerHierarchy::TraversalPath root = LayerHierarchy::TraversalPath::ROOT;
+        LayerHierarchy::ScopedAddToTraversalPath addChildToPath(root,
+                                                                childHierarchy->getLayer()->id,
+                                                                variant);
+        prepareSnapshotsInHierarchy(args, *childHierarchy, root, mRootSnapshot, i, rootGroups,
+                                    /*depth=*/0);
+    }
+
+    // Each group is updated by a single task, in z-order, so no two tasks modify the same
+    // snapshot.
+    std::vector<std::vector<size_t>> groupRoots;
+    std::vector<size_t> groupTask(numRoots, numRoots);
+    for (size_t i = 0; i < numRoots; i++) {
+        size_t group = i;
+        while (rootGroups[group] != group) {
+            group = rootGroups[group];
+        }
+        if (groupTask[group] == numRoots) {
+            groupTask[group] = groupRoots.size();
+            groupRoots.emplace_back();
+        }
+        groupRoots[groupTask[group]].push_back(i);
+    }
+    if (groupRoots.size() < 2) {
+        return false;
+    }
+
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(groupRoots.size());
+    for (const std::vector<size_t>& roots : groupRoots) {
+        tasks.emplace_back([this, &args, &roots]() {
+            for (size_t i : roots) {
+                auto& [childHierarchy, variant] = args.root.mChildren[i];
+                LayerHierarchy::TraversalPath root = LayerHierarchy::TraversalPath::ROOT;
+                LayerHierarchy::ScopedAddToTraversalPath
+                        addChildToPath(root, childHierarchy->getLayer()->id, variant);
+                updateSnapshotsInHierarchy(args, *childHierarchy, root, mRootSnapshot,
+                                           /*depth=*/0);
+            }
+        });
+    }
+    mWorkerPool->run(tasks);
+    return true;
+}
+
+void LayerSnapshotBuilder::prepareSnapshotsInHierarchy(
+        const Args& args, const LayerHierarchy& hierarchy,
+        LayerHierarchy::TraversalPath& traversalPath, const LayerSnapshot& parentSnapshot,
+        size_t rootIndex, std::vector<size_t>& rootGroups, int depth) {
+    if (depth > 50) {
+        // The update reports the cycle.
+        return;
+    }
+
+    const RequestedLayerState* layer = hierarchy.getLayer();
+    LayerSnapshot* snapshot = getSnapshot(traversalPath);
+    if (snapshot == nullptr) {
+        snapshot = createSnapshot(traversalPath, *layer, parentSnapshot);
+        snapshot->merge(*layer, /*forceUpdate=*/true, /*displayChanges=*/true, args.forceFullDamage,
+                        getPrimaryDisplayRotationFlags(args.displays));
+        snapshot->changes |= RequestedLayerState::Changes::Created;
+    }
+
+    auto [it, inserted] = mSnapshotRootIndex.try_emplace(snapshot, rootIndex);
+    if (!inserted && it->second != rootIndex) {
+        size_t a = it->second;
+        while (rootGroups[a] != a) {
+            a = rootGroups[a];
+        }
+        size_t b = rootIndex;
+        while (rootGroups[b] != b) {
+            b = rootGroups[b];
+        }
+        rootGroups[std::max(a, b)] = std::min(a, b);
+    }
+
+    for (auto& [childHierarchy, variant] : hierarchy.mChildren) {
+        LayerHierarchy::ScopedAddToTraversalPath addChildToPath(traversalPath,
+                                                                childHierarchy->getLayer()->id,
+                                                                variant);
+        prepareSnapshotsInHierarchy(args, *childHierarchy, traversalPath, *snapshot, rootIndex,
+                                    rootGroups, depth + 1);
+    }
+}
+
 void LayerSnapshotBuilder::update(const Args& args) {
     for (auto& snapshot : mSnapshots) {
         clearChanges(*snapshot);
     }
 
-    if (tryFastUpdate(args)) {
-        return;
+    if (!tryFastUpdate(args)) {
+        mPartialUpdate = updateDirtyLayers(args);
+        updateSnapshots(args);
+        mPartialUpdate = false;
     }
-    updateSnapshots(args);
+
+    // Lets CompositionEngine reuse the coverage of the snapshots that didn't change.
+    for (auto& snapshot : mSnapshots) {
+        if (snapshot->changes.any() || snapshot->clientChanges != 0) {
+            snapshot->coverageGeneration = mNextCoverageGeneration++;
+        }
+    }
+}
+
+bool LayerSnapshotBuilder::updateDirtyLayers(const Args& args) {
+    mDirtyLayerIds.clear();
+    if (args.forceUpdate != ForceUpdateFlags::NONE || args.displayChanges || mSnapshots.empty() ||
+        !args.layerLifecycleManager.getDestroyedLayers().empty()) {
+        return false;
+    }
+
+    std::vector<uint32_t> pendingLayerIds;
+    for (const RequestedLayerState* layer : args.layerLifecycleManager.getChangedLayers()) {
+        if (layer->changes.test(RequestedLayerState::Changes::Mirror)) {
+            return false;
+        }
+        if (layer->changes.any(RequestedLayerState::Changes::Parent |
+                               RequestedLayerState::Changes::RelativeParent)) {
+            // Moving a clone, or a layer that wasn't reachable through its parent, can make other
+            // snapshots unreachable, which only a full update detects.
+            auto range = mIdToSnapshots.equal_range(layer->id);
+            for (auto it = range.first; it != range.second; it++) {
+                if (it->second->path.isClone() ||
+                    it->second->reachablilty != LayerSnapshot::Reachablilty::Reachable) {
+                    return false;
+                }
+            }
+        }
+        pendingLayerIds.push_back(layer->id);
+    }
+
+    // Mark every layer the changed layers are reached through: their parents, relative parents
+    // and the mirror roots of their clones.
+    while (!pendingLayerIds.empty()) {
+        const uint32_t layerId = pendingLayerIds.back();
+        pendingLayerIds.pop_back();
+        if (!mDirtyLayerIds.insert(layerId).second) {
+            continue;
+        }
+        const RequestedLayerState* layer = args.layerLifecycleManager.getLayerFromId(layerId);
+        if (!layer) {
+            return false;
+        }
+        if (layer->parentId != UNASSIGNED_LAYER_ID) {
+            pendingLayerIds.push_back(layer->parentId);
+        } else if (!layer->canBeRoot) {
+            // The changes are offscreen, or the layer is being moved offscreen.
+            return false;
+        }
+        if (layer->hasValidRelativeParent()) {
+            pendingLayerIds.push_back(layer->relativeParentId);
+        }
+        auto range = mIdToSnapshots.equal_range(layerId);
+        for (auto it = range.first; it != range.second; it++) {
+            if (it->second->path.isClone()) {
+                pendingLayerIds.push_back(it->second->path.mirrorRootId);
+            }
+        }
+    }
+    return true;
+}
+
+bool LayerSnapshotBuilder::canSkipSubtree(const LayerHierarchy& hierarchy,
+                                          const LayerSnapshot& parentSnapshot) const {
+    return mPartialUpdate &&
+            mDirtyLayerIds.find(hierarchy.getLayer()->id) == mDirtyLayerIds.end() &&
+            !getInheritedChanges(parentSnapshot).any() &&
+            !(parentSnapshot.clientChanges & layer_state_t::AFFECTS_CHILDREN);
 }
 
 const LayerSnapshot& LayerSnapshotBuilder::updateSnapshotsInHierarchy(
@@ -551,6 +753,9 @@ const LayerSnapshot& LayerSnapshotBuilder::updateSnapshotsInHierarchy(
     }
 
     for (auto& [childHierarchy, variant] : hierarchy.mChildren) {
+        if (canSkipSubtree(*childHierarchy, *snapshot)) {
+            continue;
+        }
         LayerHierarchy::ScopedAddToTraversalPath addChildToPath(traversalPath,
                                                                 childHierarchy->getLayer()->id,
                                                                 variant);
@@ -708,12 +913,7 @@ void LayerSnapshotBuilder::updateSnapshot(LayerSnapshot& snapshot, const Args& a
                                           const LayerSnapshot& parentSnapshot,
                                           const LayerHierarchy::TraversalPath& path) {
     // Always update flags and visibility
-    ftl::Flags<RequestedLayerState::Changes> parentChanges = parentSnapshot.changes &
-            (RequestedLayerState::Changes::Hierarchy | RequestedLayerState::Changes::Geometry |
-             RequestedLayerState::Changes::Visibility | RequestedLayerState::Changes::Metadata |
-             RequestedLayerState::Changes::AffectsChildren |
-             RequestedLayerState::Changes::FrameRate | RequestedLayerState::Changes::GameMode);
-    snapshot.changes |= parentChanges;
+    snapshot.changes |= getInheritedChanges(parentSnapshot);
     if (args.displayChanges) snapshot.changes |= RequestedLayerState::Changes::Geometry;
     snapshot.reachablilty = LayerSnapshot::Reachablilty::Reachable;
     snapshot.clientChanges |= (parentSnapshot.clientChanges & layer_state_t::AFFECTS_CHILDREN);
@@ -1047,6 +1247,7 @@ void LayerSnapshotBuilder::updateInput(LayerSnapshot& snapshot,
     }
 
     if (requested.touchCropId != UNASSIGNED_LAYER_ID || path.isClone()) {
+        std::lock_guard lock(mNeedsTouchableRegionCropMutex);
         mNeedsTouchableRegionCrop.insert(path);
     }
     auto cropLayerSnapshot = getSnapshot(requested.touchCropId);
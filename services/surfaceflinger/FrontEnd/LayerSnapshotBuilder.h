@@ -16,6 +16,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <mutex>
+
 #include "FrontEnd/DisplayInfo.h"
 #include "FrontEnd/LayerLifecycleManager.h"
 #include "LayerHierarchy.h"
@@ -24,6 +27,8 @@
 
 namespace android::surfaceflinger::frontend {
 
+class WorkerPool;
+
 // Walks through the layer hierarchy to build an ordered list
 // of LayerSnapshots that can be passed on to CompositionEngine.
 // This builder does a minimum amount of work to update
@@ -59,6 +64,12 @@ public:
 
     // Rebuild the snapshots from scratch.
     LayerSnapshotBuilder(Args);
+    ~LayerSnapshotBuilder();
+
+    // Update the subtrees under the root on numThreads worker threads in addition to the calling
+    // thread. Subtrees that share snapshots through relative parents are updated together, in
+    // z-order, so that the result is the same as a sequential update. 0 disables parallel updates.
+    void setParallelUpdateThreads(size_t numThreads);
 
     // Update an existing set of snapshot using change flags in RequestedLayerState
     // and LayerLifecycleManager. This needs to be called before
@@ -94,6 +105,25 @@ private:
 
     void updateSnapshots(const Args& args);
 
+    // Collects the changed layers and every layer they are reached through, so that
+    // updateSnapshots only walks the subtrees that contain changes. Returns false if the changes
+    // can make snapshots unreachable, in which case the whole hierarchy has to be walked.
+    bool updateDirtyLayers(const Args& args);
+    // Returns true if a partial update can skip the hierarchy, because none of its layers changed
+    // and it doesn't inherit any changes from its parent.
+    bool canSkipSubtree(const LayerHierarchy& hierarchy, const LayerSnapshot& parentSnapshot) const;
+
+    // Updates the subtrees under the root in parallel. Returns false if there aren't at least two
+    // independent subtrees, in which case the caller updates them sequentially.
+    bool updateSnapshotsInParallel(const Args& args);
+    // Creates the missing snapshots of the hierarchy, in the order updateSnapshotsInHierarchy
+    // would, so that the parallel update doesn't modify the snapshot containers. Snapshots reached
+    // from more than one subtree of the root join those subtrees into one group.
+    void prepareSnapshotsInHierarchy(const Args&, const LayerHierarchy& hierarchy,
+                                     LayerHierarchy::TraversalPath& traversalPath,
+                                     const LayerSnapshot& parentSnapshot, size_t rootIndex,
+                                     std::vector<size_t>& rootGroups, int depth);
+
     const LayerSnapshot& updateSnapshotsInHierarchy(const Args&, const LayerHierarchy& hierarchy,
                                                     LayerHierarchy::TraversalPath& traversalPath,
                                                     const LayerSnapshot& parentSnapshot, int depth);
@@ -128,10 +158,26 @@ private:
     // Track snapshots that needs touchable region crop from other snapshots
     std::unordered_set<LayerHierarchy::TraversalPath, LayerHierarchy::TraversalPathHash>
             mNeedsTouchableRegionCrop;
+    // Guards mNeedsTouchableRegionCrop during parallel updates
+    std::mutex mNeedsTouchableRegionCropMutex;
     std::vector<std::unique_ptr<LayerSnapshot>> mSnapshots;
     LayerSnapshot mRootSnapshot;
-    bool mResortSnapshots = false;
+    std::atomic<bool> mResortSnapshots = false;
     int mNumInterestingSnapshots = 0;
+
+    // Assigned to the snapshots that changed in an update, see
+    // LayerFECompositionState::coverageGeneration.
+    uint64_t mNextCoverageGeneration = 1;
+
+    // Set while updateSnapshots only walks the subtrees containing mDirtyLayerIds.
+    bool mPartialUpdate = false;
+    std::unordered_set<uint32_t> mDirtyLayerIds;
+
+    size_t mParallelUpdateThreads = 0;
+    std::unique_ptr<WorkerPool> mWorkerPool;
+    // The index of the subtree of the root each snapshot was first reached from, while preparing
+    // a parallel update. Kept as a member to reuse its storage.
+    std::unordered_map<const LayerSnapshot*, size_t> mSnapshotRootIndex;
 };
 
 } // namespace android::surfaceflinger::frontend
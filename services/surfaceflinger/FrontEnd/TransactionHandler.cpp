@@ -28,19 +28,17 @@
 namespace android::surfaceflinger::frontend {
 
 void TransactionHandler::queueTransaction(TransactionState&& state) {
+    // Resolve the fences that have already signaled on the calling thread, so that flushing does
+    // not have to poll them on the main thread.
+    state.updateSignaledAcquireFences();
     mLocklessTransactionQueue.push(std::move(state));
     mPendingTransactionCount.fetch_add(1);
     ATRACE_INT("TransactionQueue", static_cast<int>(mPendingTransactionCount.load()));
 }
 
 std::vector<TransactionState> TransactionHandler::flushTransactions() {
-    while (!mLocklessTransactionQueue.isEmpty()) {
-        auto maybeTransaction = mLocklessTransactionQueue.pop();
-        if (!maybeTransaction.has_value()) {
-            break;
-        }
-        auto transaction = maybeTransaction.value();
-        mPendingTransactionQueues[transaction.applyToken].emplace(std::move(transaction));
+    while (auto maybeTransaction = mLocklessTransactionQueue.pop()) {
+        getPendingQueue(maybeTransaction->applyToken).emplace(std::move(*maybeTransaction));
     }
 
     // Collect transaction that are ready to be applied.
@@ -91,8 +89,38 @@ void TransactionHandler::applyUnsignaledBufferTransaction(
     auto& queue = it->second;
     popTransactionFromPending(transactions, flushState, queue);
     if (queue.empty()) {
-        it = mPendingTransactionQueues.erase(it);
+        erasePendingQueue(it);
+    }
+}
+
+std::queue<TransactionState>& TransactionHandler::getPendingQueue(const sp<IBinder>& applyToken) {
+    if (const auto it = mPendingTransactionQueues.find(applyToken);
+        it != mPendingTransactionQueues.end()) {
+        return it->second;
+    }
+
+    if (mRecycledQueues.empty()) {
+        return mPendingTransactionQueues[applyToken];
     }
+
+    PendingTransactionQueueNode node = std::move(mRecycledQueues.back());
+    mRecycledQueues.pop_back();
+    node.key() = applyToken;
+    return mPendingTransactionQueues.insert(std::move(node)).position->second;
+}
+
+TransactionHandler::PendingTransactionQueues::iterator TransactionHandler::erasePendingQueue(
+        PendingTransactionQueues::iterator it) {
+    if (mRecycledQueues.size() == kMaxRecycledQueues) {
+        return mPendingTransactionQueues.erase(it);
+    }
+
+    const auto next = std::next(it);
+    PendingTransactionQueueNode node = mPendingTransactionQueues.extract(it);
+    // Don't hold on to the apply token while the queue is unused.
+    node.key() = nullptr;
+    mRecycledQueues.emplace_back(std::move(node));
+    return next;
 }
 
 void TransactionHandler::popTransactionFromPending(std::vector<TransactionState>& transactions,
@@ -169,7 +197,7 @@ int TransactionHandler::flushPendingTransactionQueues(std::vector<TransactionSta
         }
 
         if (queue.empty()) {
-            it = mPendingTransactionQueues.erase(it);
+            it = erasePendingQueue(it);
         } else {
             it = std::next(it, 1);
         }
@@ -182,7 +210,7 @@ void TransactionHandler::addTransactionReadyFilter(TransactionFilter&& filter) {
 }
 
 bool TransactionHandler::hasPendingTransactions() {
-    return !mPendingTransactionQueues.empty() || !mLocklessTransactionQueue.isEmpty();
+    return !mPendingTransactionQueues.empty() || !mLocklessTransactionQueue.empty();
 }
 
 void TransactionHandler::onTransactionQueueStalled(uint64_t transactionId,
@@ -21,9 +21,9 @@
 #include <optional>
 #include <vector>
 
-#include <LocklessQueue.h>
 #include <TransactionState.h>
 #include <android-base/thread_annotations.h>
+#include <ftl/mpsc_queue.h>
 #include <ftl/small_map.h>
 #include <ftl/small_vector.h>
 
@@ -84,9 +84,24 @@ private:
     void popTransactionFromPending(std::vector<TransactionState>&, TransactionFlushState&,
                                    std::queue<TransactionState>&);
     TransactionReadiness applyFilters(TransactionFlushState&);
-    std::unordered_map<sp<IBinder>, std::queue<TransactionState>, IListenerHash>
-            mPendingTransactionQueues;
-    LocklessQueue<TransactionState> mLocklessTransactionQueue;
+
+    using PendingTransactionQueues =
+            std::unordered_map<sp<IBinder>, std::queue<TransactionState>, IListenerHash>;
+    using PendingTransactionQueueNode = PendingTransactionQueues::node_type;
+
+    // Looks up the pending queue for an apply token, reusing a recycled queue if it is new.
+    std::queue<TransactionState>& getPendingQueue(const sp<IBinder>& applyToken);
+    // Removes a drained pending queue, keeping its storage for reuse by another apply token.
+    PendingTransactionQueues::iterator erasePendingQueue(PendingTransactionQueues::iterator);
+
+    PendingTransactionQueues mPendingTransactionQueues;
+
+    // Most apply tokens come and go between frames, so drained queues are recycled here rather
+    // than freed, avoiding a map node and a deque block allocation per token per frame.
+    static constexpr size_t kMaxRecycledQueues = 8;
+    ftl::SmallVector<PendingTransactionQueueNode, kMaxRecycledQueues> mRecycledQueues;
+
+    ftl::MpscQueue<TransactionState> mLocklessTransactionQueue;
     std::atomic<size_t> mPendingTransactionCount = 0;
     ftl::SmallVector<TransactionFilter, 2> mTransactionReadyFilters;
 
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+#undef LOG_TAG
+#define LOG_TAG "SurfaceFlinger"
+
+#include "WorkerPool.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <utils/Log.h>
+#include <utils/Trace.h>
+
+namespace android::surfaceflinger::frontend {
+
+WorkerPool::WorkerPool(size_t numThreads, const char* name) {
+    int policy;
+    sched_param param;
+    const bool hasSchedParam = pthread_getschedparam(pthread_self(), &policy, &param) == 0;
+
+    mThreads.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; i++) {
+        mThreads.emplace_back([this] { threadMain(); });
+        pthread_t thread = mThreads.back().native_handle();
+        pthread_setname_np(thread, name);
+        if (hasSchedParam && pthread_setschedparam(thread, policy, &param) != 0) {
+            ALOGW("Couldn't set the scheduling policy of %s", name);
+        }
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard lock(mMutex);
+        mDone = true;
+    }
+    mCv.notify_all();
+    for (std::thread& thread : mThreads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::run(const std::vector<std::function<void()>>& tasks) {
+    std::unique_lock lock(mMutex);
+    mTasks = &tasks;
+    mNextTask = 0;
+    mBatch++;
+    mCv.notify_all();
+
+    runTasks();
+    mCv.wait(lock, [this]() REQUIRES(mMutex) { return mRunningTasks == 0; });
+    mTasks = nullptr;
+}
+
+void WorkerPool::runTasks() {
+    while (mTasks != nullptr && mNextTask < mTasks->size()) {
+        const std::function<void()>& task = (*mTasks)[mNextTask++];
+        mRunningTasks++;
+        mMutex.unlock();
+        task();
+        mMutex.lock();
+        if (--mRunningTasks == 0 && mNextTask == mTasks->size()) {
+            mCv.notify_all();
+        }
+    }
+}
+
+void WorkerPool::threadMain() {
+    std::unique_lock lock(mMutex);
+    uint64_t lastBatch = mBatch;
+    while (true) {
+        mCv.wait(lock, [&]() REQUIRES(mMutex) { return mDone || mBatch != lastBatch; });
+        if (mDone) {
+            return;
+        }
+        lastBatch = mBatch;
+        runTasks();
+    }
+}
+
+} // namespace android::surfaceflinger::frontend
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <android-base/thread_annotations.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace android::surfaceflinger::frontend {
+
+// A fixed set of threads that run batches of independent tasks for the calling
+// thread, which takes part in running them. The threads are created with the
+// scheduling policy and priority of the thread that creates the pool, so that
+// work moved off the main thread doesn't lose its priority.
+class WorkerPool final {
+public:
+    WorkerPool(size_t numThreads, const char* name);
+    ~WorkerPool();
+
+    // Runs all of the tasks and returns once they have finished. The order
+    // in which they run is unspecified.
+    void run(const std::vector<std::function<void()>>& tasks);
+
+private:
+    void threadMain();
+    // Runs tasks of the current batch until there are none left to start.
+    void runTasks() REQUIRES(mMutex);
+
+    std::mutex mMutex;
+    std::condition_variable mCv;
+    const std::vector<std::function<void()>>* mTasks GUARDED_BY(mMutex) = nullptr;
+    size_t mNextTask GUARDED_BY(mMutex) = 0;
+    size_t mRunningTasks GUARDED_BY(mMutex) = 0;
+    // Incremented for each batch, so that a woken thread can tell a new batch
+    // from a spurious wakeup.
+    uint64_t mBatch GUARDED_BY(mMutex) = 0;
+    bool mDone GUARDED_BY(mMutex) = false;
+    std::vector<std::thread> mThreads;
+};
+
+} // namespace android::surfaceflinger::frontend
@@ -20,25 +20,49 @@
 
 #include <utils/Trace.h>
 
+#include "BackgroundExecutor.h"
 #include "HdrLayerInfoReporter.h"
 
 namespace android {
 
 void HdrLayerInfoReporter::dispatchHdrLayerInfo(const HdrLayerInfo& info) {
     ATRACE_CALL();
-    std::vector<sp<gui::IHdrLayerInfoListener>> toInvoke;
+    std::scoped_lock lock(mMutex);
+    bool changed = false;
+    for (auto& [key, it] : mListeners) {
+        if (it.lastInfo != info) {
+            it.lastInfo = info;
+            it.pending = true;
+            changed = true;
+        }
+    }
+
+    if (!changed || mDispatchScheduled) {
+        return;
+    }
+    mDispatchScheduled = true;
+    BackgroundExecutor::getInstance().sendCallbacks(
+            {[reporter = sp<HdrLayerInfoReporter>::fromExisting(this)]() {
+                reporter->sendPendingHdrLayerInfo();
+            }});
+}
+
+void HdrLayerInfoReporter::sendPendingHdrLayerInfo() {
+    ATRACE_CALL();
+    std::vector<std::pair<sp<gui::IHdrLayerInfoListener>, HdrLayerInfo>> toInvoke;
     {
         std::scoped_lock lock(mMutex);
+        mDispatchScheduled = false;
         toInvoke.reserve(mListeners.size());
         for (auto& [key, it] : mListeners) {
-            if (it.lastInfo != info) {
-                it.lastInfo = info;
-                toInvoke.push_back(it.listener);
+            if (it.pending) {
+                it.pending = false;
+                toInvoke.emplace_back(it.listener, it.lastInfo);
             }
         }
     }
 
-    for (const auto& listener : toInvoke) {
+    for (const auto& [listener, info] : toInvoke) {
         ATRACE_NAME("invoking onHdrLayerInfoChanged");
         listener->onHdrLayerInfoChanged(info.numberOfHdrLayers, info.maxW, info.maxH, info.flags,
                                         info.maxDesiredHdrSdrRatio);
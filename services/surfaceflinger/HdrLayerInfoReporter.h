@@ -64,6 +64,8 @@ public:
     // Dispatches updated layer fps values for the registered listeners
     // This method promotes Layer weak pointers and performs layer stack traversals, so mStateLock
     // must be held when calling this method.
+    // Listeners are invoked on the BackgroundExecutor. Updates that arrive before a pending
+    // dispatch has run are coalesced, so listeners only see the latest info.
     void dispatchHdrLayerInfo(const HdrLayerInfo& info) EXCLUDES(mMutex);
 
     // Override for IBinder::DeathRecipient
@@ -85,9 +87,14 @@ private:
     struct TrackedListener {
         sp<gui::IHdrLayerInfoListener> listener;
         HdrLayerInfo lastInfo;
+        // Whether lastInfo has yet to be sent to the listener.
+        bool pending = false;
     };
 
+    void sendPendingHdrLayerInfo() EXCLUDES(mMutex);
+
     std::unordered_map<wp<IBinder>, TrackedListener, WpHash> mListeners GUARDED_BY(mMutex);
+    bool mDispatchScheduled GUARDED_BY(mMutex) = false;
 };
 
 } // namespace android
\ No newline at end of file
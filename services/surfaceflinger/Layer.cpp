@@ -2835,6 +2835,21 @@ void Layer::callReleaseBufferCallback(const sp<ITransactionCompletedListener>& l
                               currentMaxAcquiredBufferCount);
 }
 
+void Layer::queueReleaseBufferCallback(const sp<ITransactionCompletedListener>& listener,
+                                       const sp<GraphicBuffer>& buffer, uint64_t framenumber,
+                                       const sp<Fence>& releaseFence) {
+    if (!listener) {
+        return;
+    }
+    ATRACE_FORMAT_INSTANT("queueReleaseBufferCallback %s - %" PRIu64, getDebugName(), framenumber);
+    uint32_t currentMaxAcquiredBufferCount =
+            mFlinger->getMaxAcquiredBufferCountForCurrentRefreshRate(mOwnerUid);
+    mFlinger->getTransactionCallbackInvoker()
+            .addReleaseBufferCallback(listener, {buffer->getId(), framenumber},
+                                      releaseFence ? releaseFence : Fence::NO_FENCE,
+                                      currentMaxAcquiredBufferCount);
+}
+
 void Layer::onLayerDisplayed(ftl::SharedFuture<FenceResult> futureFenceResult,
                              ui::LayerStack layerStack) {
     // If we are displayed on multiple displays in a single composition cycle then we would
@@ -3090,9 +3105,9 @@ bool Layer::setBuffer(std::shared_ptr<renderengine::ExternalTexture>& buffer,
             // before swapping to drawing state, then the first buffer will be
             // dropped and we should decrement the pending buffer count and
             // call any release buffer callbacks if set.
-            callReleaseBufferCallback(mDrawingState.releaseBufferListener,
-                                      mDrawingState.buffer->getBuffer(), mDrawingState.frameNumber,
-                                      mDrawingState.acquireFence);
+            queueReleaseBufferCallback(mDrawingState.releaseBufferListener,
+                                       mDrawingState.buffer->getBuffer(), mDrawingState.frameNumber,
+                                       mDrawingState.acquireFence);
             decrementPendingBufferCount();
             if (mDrawingState.bufferSurfaceFrameTX != nullptr &&
                 mDrawingState.bufferSurfaceFrameTX->getPresentState() != PresentState::Presented) {
@@ -3100,9 +3115,9 @@ bool Layer::setBuffer(std::shared_ptr<renderengine::ExternalTexture>& buffer,
                 mDrawingState.bufferSurfaceFrameTX.reset();
             }
         } else if (EARLY_RELEASE_ENABLED && mLastClientCompositionFence != nullptr) {
-            callReleaseBufferCallback(mDrawingState.releaseBufferListener,
-                                      mDrawingState.buffer->getBuffer(), mDrawingState.frameNumber,
-                                      mLastClientCompositionFence);
+            queueReleaseBufferCallback(mDrawingState.releaseBufferListener,
+                                       mDrawingState.buffer->getBuffer(), mDrawingState.frameNumber,
+                                       mLastClientCompositionFence);
             mLastClientCompositionFence = nullptr;
         }
     } else if (buffer) {
@@ -3409,7 +3424,12 @@ bool Layer::fenceHasSignaled() const {
         return true;
     }
 
-    const bool fenceSignaled =
+    // FenceTime caches the signal time once observed, so a fence that was already seen to signal
+    // when the buffer was set, or on an earlier latch attempt, is not polled again. An invalid or
+    // errored fence does not count as signaled.
+    const nsecs_t cachedSignalTime = getDrawingState().acquireFenceTime->getCachedSignalTime();
+    const bool fenceSignaled = (cachedSignalTime != Fence::SIGNAL_TIME_PENDING &&
+                                cachedSignalTime != Fence::SIGNAL_TIME_INVALID) ||
             getDrawingState().acquireFence->getStatus() == Fence::Status::Signaled;
     if (!fenceSignaled) {
         mFlinger->mTimeStats->incrementLatchSkipped(getSequence(),
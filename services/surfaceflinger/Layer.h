@@ -901,6 +901,11 @@ public:
     void callReleaseBufferCallback(const sp<ITransactionCompletedListener>& listener,
                                    const sp<GraphicBuffer>& buffer, uint64_t framenumber,
                                    const sp<Fence>& releaseFence);
+    // Like callReleaseBufferCallback, but defers the callback to the next time transaction
+    // callbacks are sent, so that it is delivered along with them.
+    void queueReleaseBufferCallback(const sp<ITransactionCompletedListener>& listener,
+                                    const sp<GraphicBuffer>& buffer, uint64_t framenumber,
+                                    const sp<Fence>& releaseFence);
     bool setFrameRateForLayerTreeLegacy(FrameRate);
     bool setFrameRateForLayerTree(FrameRate, const scheduler::LayerProps&);
     void recordLayerHistoryBufferUpdate(const scheduler::LayerProps&);
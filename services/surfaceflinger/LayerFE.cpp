@@ -327,6 +327,7 @@ void LayerFE::prepareShadowClientComposition(LayerFE::LayerSettings& caster,
 
 void LayerFE::onLayerDisplayed(ftl::SharedFuture<FenceResult> futureFenceResult,
                                ui::LayerStack layerStack) {
+    std::lock_guard lock(mReleaseFencesMutex);
     mCompositionResult.releaseFences.emplace_back(std::move(futureFenceResult), layerStack);
 }
 
@@ -18,6 +18,7 @@
 
 #include <android/gui/CachingHint.h>
 #include <gui/LayerMetadata.h>
+#include <mutex>
 #include "FrontEnd/LayerSnapshot.h"
 #include "compositionengine/LayerFE.h"
 #include "compositionengine/LayerFECompositionState.h"
@@ -78,6 +79,8 @@ private:
     const sp<GraphicBuffer> getBuffer() const;
 
     CompositionResult mCompositionResult;
+    // Outputs that present on their own threads report their release fences concurrently.
+    std::mutex mReleaseFencesMutex;
     std::string mName;
 };
 
@@ -63,6 +63,10 @@ constexpr auto defaultRegionSamplingWorkDuration = 3ms;
 constexpr auto defaultRegionSamplingPeriod = 100ms;
 constexpr auto defaultRegionSamplingTimerTimeout = 100ms;
 constexpr auto maxRegionSamplingDelay = 100ms;
+// The sampled bounds are rendered at this fraction of their size in each dimension. The GPU filters
+// the layers down as it composites them, which leaves the CPU a fraction of the pixels to read back
+// and average. Luma is only used to pick a light or dark tint, so the loss of detail is harmless.
+constexpr int32_t kSampleDownscaleFactor = 4;
 // TODO: (b/127403193) duration to string conversion could probably be constexpr
 template <typename Rep, typename Per>
 inline std::string toNsString(std::chrono::duration<Rep, Per> t) {
@@ -224,8 +228,13 @@ float sampleArea(const uint32_t* data, int32_t width, int32_t height, int32_t st
     return accumulatedLuma / (255.0f * pixelCount);
 }
 
+Rect downscaleSampleArea(const Rect& area, int32_t factor) {
+    const auto roundUp = [factor](int32_t value) { return (value + factor - 1) / factor; };
+    return Rect(area.left / factor, area.top / factor, roundUp(area.right), roundUp(area.bottom));
+}
+
 std::vector<float> RegionSamplingThread::sampleBuffer(
-        const sp<GraphicBuffer>& buffer, const Point& leftTop,
+        const sp<GraphicBuffer>& buffer, const Point& leftTop, int32_t downscaleFactor,
         const std::vector<RegionSamplingThread::Descriptor>& descriptors, uint32_t orientation) {
     void* data_raw = nullptr;
     buffer->lock(GRALLOC_USAGE_SW_READ_OFTEN, &data_raw);
@@ -240,7 +249,8 @@ std::vector<float> RegionSamplingThread::sampleBuffer(
     std::transform(descriptors.begin(), descriptors.end(), lumas.begin(),
                    [&](auto const& descriptor) {
                        return sampleArea(data.get(), width, height, stride, orientation,
-                                         descriptor.area - leftTop);
+                                         downscaleSampleArea(descriptor.area - leftTop,
+                                                             downscaleFactor));
                    });
     return lumas;
 }
@@ -276,11 +286,13 @@ void RegionSamplingThread::captureSample() {
     }
 
     const Rect sampledBounds = sampleRegion.bounds();
+    const Rect sampleBufferBounds = downscaleSampleArea(sampledBounds - sampledBounds.leftTop(),
+                                                        kSampleDownscaleFactor);
     constexpr bool kUseIdentityTransform = false;
     constexpr bool kHintForSeamlessTransition = false;
 
     SurfaceFlinger::RenderAreaFuture renderAreaFuture = ftl::defer([=] {
-        return DisplayRenderArea::create(displayWeak, sampledBounds, sampledBounds.getSize(),
+        return DisplayRenderArea::create(displayWeak, sampledBounds, sampleBufferBounds.getSize(),
                                          ui::Dataspace::V0_SRGB, kUseIdentityTransform,
                                          kHintForSeamlessTransition);
     });
@@ -356,14 +368,15 @@ void RegionSamplingThread::captureSample() {
     }
 
     std::shared_ptr<renderengine::ExternalTexture> buffer = nullptr;
-    if (mCachedBuffer && mCachedBuffer->getBuffer()->getWidth() == sampledBounds.getWidth() &&
-        mCachedBuffer->getBuffer()->getHeight() == sampledBounds.getHeight()) {
+    if (mCachedBuffer && mCachedBuffer->getBuffer()->getWidth() == sampleBufferBounds.getWidth() &&
+        mCachedBuffer->getBuffer()->getHeight() == sampleBufferBounds.getHeight()) {
         buffer = mCachedBuffer;
     } else {
         const uint32_t usage =
                 GRALLOC_USAGE_SW_READ_OFTEN | GRALLOC_USAGE_HW_RENDER | GRALLOC_USAGE_HW_TEXTURE;
         sp<GraphicBuffer> graphicBuffer =
-                sp<GraphicBuffer>::make(sampledBounds.getWidth(), sampledBounds.getHeight(),
+                sp<GraphicBuffer>::make(sampleBufferBounds.getWidth(),
+                                        sampleBufferBounds.getHeight(),
                                         PIXEL_FORMAT_RGBA_8888, 1, usage, "RegionSamplingThread");
         const status_t bufferStatus = graphicBuffer->initCheck();
         LOG_ALWAYS_FATAL_IF(bufferStatus != OK, "captureSample: Buffer failed to allocate: %d",
@@ -394,7 +407,8 @@ void RegionSamplingThread::captureSample() {
 
     ALOGV("Sampling %zu descriptors", activeDescriptors.size());
     std::vector<float> lumas = sampleBuffer(buffer->getBuffer(), sampledBounds.leftTop(),
-                                            activeDescriptors, orientation);
+                                            kSampleDownscaleFactor, activeDescriptors,
+                                            orientation);
     if (lumas.size() != activeDescriptors.size()) {
         ALOGW("collected %zu median luma values for %zu descriptors", lumas.size(),
               activeDescriptors.size());
@@ -45,6 +45,10 @@ using gui::IRegionSamplingListener;
 float sampleArea(const uint32_t* data, int32_t width, int32_t height, int32_t stride,
                  uint32_t orientation, const Rect& area);
 
+// Maps an area onto a sample buffer that was rendered at 1/factor of its size in each dimension.
+// The area is rounded outwards, so that it covers at least one pixel of the sample buffer.
+Rect downscaleSampleArea(const Rect& area, int32_t factor);
+
 class RegionSamplingThread : public IBinder::DeathRecipient {
 public:
     struct TimingTunables {
@@ -92,7 +96,7 @@ private:
     };
 
     std::vector<float> sampleBuffer(
-            const sp<GraphicBuffer>& buffer, const Point& leftTop,
+            const sp<GraphicBuffer>& buffer, const Point& leftTop, int32_t downscaleFactor,
             const std::vector<RegionSamplingThread::Descriptor>& descriptors, uint32_t orientation);
 
     void doSample(std::optional<std::chrono::steady_clock::time_point> samplingDeadline);
@@ -211,6 +211,27 @@ binder::Status EventThreadConnection::getLatestVsyncEventData(
     return binder::Status::ok();
 }
 
+binder::Status EventThreadConnection::getSharedVsyncEventData(os::ParcelFileDescriptor* outFd) {
+    ATRACE_CALL();
+    std::scoped_lock lock(mLock);
+    if (!mSharedVsyncEventData) {
+        mSharedVsyncEventData = gui::SharedVsyncEventData::create();
+        if (!mSharedVsyncEventData) {
+            return binder::Status::fromStatusT(NO_MEMORY);
+        }
+    }
+
+    *outFd = os::ParcelFileDescriptor(base::unique_fd(dup(mSharedVsyncEventData->getFd())));
+    return binder::Status::ok();
+}
+
+void EventThreadConnection::publishVsyncEventData(const VsyncEventData& vsyncEventData) {
+    std::scoped_lock lock(mLock);
+    if (mSharedVsyncEventData) {
+        mSharedVsyncEventData->publish(vsyncEventData);
+    }
+}
+
 status_t EventThreadConnection::postEvent(const DisplayEventReceiver::Event& event) {
     constexpr auto toStatus = [](ssize_t size) {
         return size < 0 ? status_t(size) : status_t(NO_ERROR);
@@ -472,8 +493,25 @@ void EventThread::threadMain(std::unique_lock<std::mutex>& lock) {
         }
 
         if (!consumers.empty()) {
-            dispatchEvent(*event, consumers);
+            lock.unlock();
+            const auto failures = dispatchEvent(*event, consumers);
             consumers.clear();
+            lock.lock();
+
+            for (const auto& [consumer, error] : failures) {
+                if (error == -EAGAIN) {
+                    // TODO: Try again if pipe is full.
+                    ALOGW("Failed dispatching %s for %s", toString(*event).c_str(),
+                          toString(*consumer).c_str());
+                } else {
+                    // Treat EPIPE and other errors as fatal.
+                    removeDisplayEventConnectionLocked(consumer);
+                }
+            }
+
+            // Connections may have requested vsync, and the thread may have been asked to quit,
+            // while mMutex was released, so re-evaluate the state before waiting.
+            continue;
         }
 
         if (mVSyncState && vsyncRequested) {
@@ -651,8 +689,9 @@ void EventThread::generateFrameTimeline(VsyncEventData& outVsyncEventData, nsecs
     outVsyncEventData.frameTimelinesLength = currentIndex;
 }
 
-void EventThread::dispatchEvent(const DisplayEventReceiver::Event& event,
-                                const DisplayEventConsumers& consumers) {
+auto EventThread::dispatchEvent(const DisplayEventReceiver::Event& event,
+                                const DisplayEventConsumers& consumers) -> DispatchFailures {
+    DispatchFailures failures;
     for (const auto& consumer : consumers) {
         DisplayEventReceiver::Event copy = event;
         if (event.header.type == DisplayEventReceiver::DISPLAY_EVENT_VSYNC) {
@@ -661,22 +700,13 @@ void EventThread::dispatchEvent(const DisplayEventReceiver::Event& event,
             generateFrameTimeline(copy.vsync.vsyncData, frameInterval, copy.header.timestamp,
                                   event.vsync.vsyncData.preferredExpectedPresentationTime(),
                                   event.vsync.vsyncData.preferredDeadlineTimestamp());
+            consumer->publishVsyncEventData(copy.vsync.vsyncData);
         }
-        switch (consumer->postEvent(copy)) {
-            case NO_ERROR:
-                break;
-
-            case -EAGAIN:
-                // TODO: Try again if pipe is full.
-                ALOGW("Failed dispatching %s for %s", toString(event).c_str(),
-                      toString(*consumer).c_str());
-                break;
-
-            default:
-                // Treat EPIPE and other errors as fatal.
-                removeDisplayEventConnectionLocked(consumer);
+        if (const status_t error = consumer->postEvent(copy); error != NO_ERROR) {
+            failures.emplace_back(consumer, error);
         }
     }
+    return failures;
 }
 
 void EventThread::dump(std::string& result) const {
@@ -19,6 +19,7 @@
 #include <android-base/thread_annotations.h>
 #include <android/gui/BnDisplayEventConnection.h>
 #include <gui/DisplayEventReceiver.h>
+#include <gui/SharedVsyncEventData.h>
 #include <private/gui/BitTube.h>
 #include <sys/types.h>
 #include <utils/Errors.h>
@@ -75,10 +76,14 @@ public:
 
     virtual status_t postEvent(const DisplayEventReceiver::Event& event);
 
+    // Publishes the vsync event data to the shared memory, if the client requested it.
+    void publishVsyncEventData(const VsyncEventData&);
+
     binder::Status stealReceiveChannel(gui::BitTube* outChannel) override;
     binder::Status setVsyncRate(int rate) override;
     binder::Status requestNextVsync() override; // asynchronous
     binder::Status getLatestVsyncEventData(ParcelableVsyncEventData* outVsyncEventData) override;
+    binder::Status getSharedVsyncEventData(os::ParcelFileDescriptor* outFd) override;
 
     // Called in response to requestNextVsync.
     const ResyncCallback resyncCallback;
@@ -96,6 +101,9 @@ private:
     std::mutex mLock;
     gui::BitTube mChannel GUARDED_BY(mLock);
 
+    // Allocated on the first getSharedVsyncEventData, and then updated on every vsync event.
+    std::unique_ptr<gui::SharedVsyncEventData> mSharedVsyncEventData GUARDED_BY(mLock);
+
     std::vector<DisplayEventReceiver::Event> mPendingEvents;
 };
 
@@ -185,8 +193,14 @@ private:
 
     bool shouldConsumeEvent(const DisplayEventReceiver::Event& event,
                             const sp<EventThreadConnection>& connection) const REQUIRES(mMutex);
-    void dispatchEvent(const DisplayEventReceiver::Event& event,
-                       const DisplayEventConsumers& consumers) REQUIRES(mMutex);
+
+    // The consumers that failed to receive an event, and the error they failed with.
+    using DispatchFailures = std::vector<std::pair<sp<EventThreadConnection>, status_t>>;
+
+    // Posts the event to each consumer. Called without holding mMutex, so that connections can
+    // register or request vsync while the event fans out.
+    DispatchFailures dispatchEvent(const DisplayEventReceiver::Event& event,
+                                   const DisplayEventConsumers& consumers);
 
     void removeDisplayEventConnectionLocked(const wp<EventThreadConnection>& connection)
             REQUIRES(mMutex);
@@ -173,12 +173,12 @@ void LayerHistory::setDefaultFrameRateCompatibility(Layer* layer, bool contentDe
 
 auto LayerHistory::summarize(const RefreshRateSelector& selector, nsecs_t now) -> Summary {
     ATRACE_CALL();
-    Summary summary;
-
     std::lock_guard lock(mLock);
 
     partitionLayers(now);
 
+    bool summaryChanged = false;
+    size_t numVotes = 0;
     for (const auto& [key, value] : mActiveLayerInfos) {
         auto& info = value.second;
         const auto frameRateSelectionPriority = info->getFrameRateSelectionPriority();
@@ -190,6 +190,7 @@ auto LayerHistory::summarize(const RefreshRateSelector& selector, nsecs_t now) -
         const auto vote = info->getRefreshRateVote(selector, now);
         // Skip NoVote layer as those don't have any requirements
         if (vote.type == LayerVoteType::NoVote) {
+            summaryChanged |= info->publishRequirement(std::nullopt);
             continue;
         }
 
@@ -203,15 +204,30 @@ auto LayerHistory::summarize(const RefreshRateSelector& selector, nsecs_t now) -
         float weight = mDisplayArea ? layerArea / mDisplayArea : 0.0f;
         ATRACE_FORMAT_INSTANT("%s %s (%d%)", ftl::enum_string(vote.type).c_str(),
                               to_string(vote.fps).c_str(), weight * 100);
-        summary.push_back({info->getName(), info->getOwnerUid(), vote.type, vote.fps,
-                           vote.seamlessness, weight, layerFocused});
+        summaryChanged |= info->publishRequirement(
+                RefreshRateSelector::LayerRequirement{info->getName(), info->getOwnerUid(),
+                                                      vote.type, vote.fps, vote.seamlessness,
+                                                      weight, layerFocused});
+        numVotes++;
 
         if (CC_UNLIKELY(mTraceEnabled)) {
             trace(*info, vote.type, vote.fps.getIntValue());
         }
     }
 
-    return summary;
+    // Layers that stopped voting by becoming inactive or being unregistered publish no change, but
+    // leave the summary with a stale entry.
+    if (summaryChanged || numVotes != mSummary.size()) {
+        mSummary.clear();
+        mSummary.reserve(numVotes);
+        for (const auto& [key, value] : mActiveLayerInfos) {
+            if (const auto& requirement = value.second->getPublishedRequirement()) {
+                mSummary.push_back(*requirement);
+            }
+        }
+    }
+
+    return mSummary;
 }
 
 void LayerHistory::partitionLayers(nsecs_t now) {
@@ -74,7 +74,8 @@ public:
 
     using Summary = std::vector<RefreshRateSelector::LayerRequirement>;
 
-    // Rebuilds sets of active/inactive layers, and accumulates stats for active layers.
+    // Rebuilds sets of active/inactive layers, and accumulates stats for active layers. The summary
+    // is only rebuilt when an active layer publishes a requirement change, or stops voting.
     Summary summarize(const RefreshRateSelector&, nsecs_t now);
 
     void clear();
@@ -127,6 +128,9 @@ private:
     LayerInfos mActiveLayerInfos GUARDED_BY(mLock);
     LayerInfos mInactiveLayerInfos GUARDED_BY(mLock);
 
+    // The requirements published by the active layers as of the last summarize.
+    Summary mSummary GUARDED_BY(mLock);
+
     // Map keyed by layer ID (sequence) to choreographer connections.
     std::unordered_multimap<int32_t, wp<EventThreadConnection>> mAttachedChoreographers
             GUARDED_BY(mLock);
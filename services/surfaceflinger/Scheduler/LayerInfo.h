@@ -157,6 +157,18 @@ public:
 
     LayerVote getRefreshRateVote(const RefreshRateSelector&, nsecs_t now);
 
+    // Publishes the requirement this layer contributes to the LayerHistory summary, or nullopt if
+    // it does not vote. Returns whether it differs from the previously published requirement.
+    bool publishRequirement(std::optional<RefreshRateSelector::LayerRequirement> requirement) {
+        if (requirement == mPublishedRequirement) return false;
+        mPublishedRequirement = std::move(requirement);
+        return true;
+    }
+
+    const std::optional<RefreshRateSelector::LayerRequirement>& getPublishedRequirement() const {
+        return mPublishedRequirement;
+    }
+
     // Return the last updated time. If the present time is farther in the future than the
     // updated time, the updated time is the present time.
     nsecs_t getLastUpdatedTime() const { return mLastUpdatedTime; }
@@ -183,6 +195,7 @@ public:
         mLastRefreshRate = {};
         mRefreshRateHistory.clear();
         mIsFrequencyConclusive = true;
+        mPublishedRequirement.reset();
     }
 
     void clearHistory(nsecs_t now) {
@@ -306,6 +319,8 @@ private:
 
     RefreshRateHistory mRefreshRateHistory;
 
+    std::optional<RefreshRateSelector::LayerRequirement> mPublishedRequirement;
+
     // This will be accessed from only one thread when counting a layer is frequent or infrequent,
     // and to determine whether a layer is in small dirty updating.
     mutable int32_t mLastSmallDirtyCount = 0;
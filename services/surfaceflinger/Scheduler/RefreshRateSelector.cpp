@@ -33,6 +33,7 @@
 #include <ftl/match.h>
 #include <ftl/unit.h>
 #include <gui/TraceUtils.h>
+#include <math/HashCombine.h>
 #include <scheduler/FrameRateMode.h>
 #include <utils/Trace.h>
 
@@ -145,6 +146,21 @@ std::string toString(const RefreshRateSelector::PolicyVariant& policy) {
             [](RefreshRateSelector::NoOverridePolicy) { return "NoOverridePolicy"s; });
 }
 
+// Hashes the arguments to getRankedFrameRates. The frame rate and weight of each layer are left out
+// as LayerRequirement compares the former approximately, so equal arguments always hash the same.
+size_t hashRankedFrameRatesArguments(
+        const std::vector<RefreshRateSelector::LayerRequirement>& layers,
+        RefreshRateSelector::GlobalSignals signals) {
+    size_t hash = hashCombine(signals.touch, signals.idle, signals.powerOnImminent);
+    for (const auto& layer : layers) {
+        hashCombineSingle(hash, layer.name);
+        hashCombineSingle(hash, layer.vote);
+        hashCombineSingle(hash, layer.seamlessness);
+        hashCombineSingle(hash, layer.focused);
+    }
+    return hash;
+}
+
 } // namespace
 
 auto RefreshRateSelector::createFrameRateModes(
@@ -421,13 +437,26 @@ auto RefreshRateSelector::getRankedFrameRates(const std::vector<LayerRequirement
                                               GlobalSignals signals) const -> RankedFrameRates {
     std::lock_guard lock(mLock);
 
-    if (mGetRankedFrameRatesCache &&
-        mGetRankedFrameRatesCache->arguments == std::make_pair(layers, signals)) {
-        return mGetRankedFrameRatesCache->result;
+    const size_t hash = hashRankedFrameRatesArguments(layers, signals);
+    const auto it = std::find_if(mGetRankedFrameRatesCache.begin(), mGetRankedFrameRatesCache.end(),
+                                 [&](const GetRankedFrameRatesCache& entry) {
+                                     return entry.hash == hash && entry.arguments.first == layers &&
+                                             entry.arguments.second == signals;
+                                 });
+    if (it != mGetRankedFrameRatesCache.end()) {
+        if (it != mGetRankedFrameRatesCache.begin()) {
+            auto entry = std::move(*it);
+            mGetRankedFrameRatesCache.erase(it);
+            mGetRankedFrameRatesCache.push_front(std::move(entry));
+        }
+        return mGetRankedFrameRatesCache.front().result;
     }
 
     const auto result = getRankedFrameRatesLocked(layers, signals);
-    mGetRankedFrameRatesCache = GetRankedFrameRatesCache{{layers, signals}, result};
+    mGetRankedFrameRatesCache.push_front(GetRankedFrameRatesCache{{layers, signals}, result, hash});
+    if (mGetRankedFrameRatesCache.size() > kMaxGetRankedFrameRatesCacheSize) {
+        mGetRankedFrameRatesCache.pop_back();
+    }
     return result;
 }
 
@@ -1048,9 +1077,9 @@ const FrameRateMode& RefreshRateSelector::getActiveModeLocked() const {
 void RefreshRateSelector::setActiveMode(DisplayModeId modeId, Fps renderFrameRate) {
     std::lock_guard lock(mLock);
 
-    // Invalidate the cached invocation to getRankedFrameRates. This forces
+    // Invalidate the cached invocations to getRankedFrameRates. This forces
     // the refresh rate to be recomputed on the next call to getRankedFrameRates.
-    mGetRankedFrameRatesCache.reset();
+    mGetRankedFrameRatesCache.clear();
 
     const auto activeModeOpt = mDisplayModes.get(modeId);
     LOG_ALWAYS_FATAL_IF(!activeModeOpt);
@@ -1087,9 +1116,9 @@ void RefreshRateSelector::initializeIdleTimer() {
 void RefreshRateSelector::updateDisplayModes(DisplayModes modes, DisplayModeId activeModeId) {
     std::lock_guard lock(mLock);
 
-    // Invalidate the cached invocation to getRankedFrameRates. This forces
+    // Invalidate the cached invocations to getRankedFrameRates. This forces
     // the refresh rate to be recomputed on the next call to getRankedFrameRates.
-    mGetRankedFrameRatesCache.reset();
+    mGetRankedFrameRatesCache.clear();
 
     mDisplayModes = std::move(modes);
     const auto activeModeOpt = mDisplayModes.get(activeModeId);
@@ -1189,7 +1218,7 @@ auto RefreshRateSelector::setPolicy(const PolicyVariant& policy) -> SetPolicyRes
             return SetPolicyResult::Invalid;
         }
 
-        mGetRankedFrameRatesCache.reset();
+        mGetRankedFrameRatesCache.clear();
 
         if (*getCurrentPolicyLocked() == oldPolicy) {
             return SetPolicyResult::Unchanged;
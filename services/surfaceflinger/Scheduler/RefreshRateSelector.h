@@ -17,6 +17,7 @@
 #pragma once
 
 #include <algorithm>
+#include <deque>
 #include <numeric>
 #include <set>
 #include <type_traits>
@@ -517,8 +518,15 @@ private:
     struct GetRankedFrameRatesCache {
         std::pair<std::vector<LayerRequirement>, GlobalSignals> arguments;
         RankedFrameRates result;
+        // Hash of the arguments, to skip comparing them against entries that cannot match.
+        size_t hash = 0;
     };
-    mutable std::optional<GetRankedFrameRatesCache> mGetRankedFrameRatesCache GUARDED_BY(mLock);
+
+    // Recent invocations of getRankedFrameRates, most recently used first. A few entries let the
+    // cache hit while the layer votes alternate between a handful of states, e.g. during video
+    // playback with several layers.
+    static constexpr size_t kMaxGetRankedFrameRatesCacheSize = 4;
+    mutable std::deque<GetRankedFrameRatesCache> mGetRankedFrameRatesCache GUARDED_BY(mLock);
 
     // Declare mIdleTimer last to ensure its thread joins before the mutex/callbacks are destroyed.
     std::mutex mIdleTimerCallbacksMutex;
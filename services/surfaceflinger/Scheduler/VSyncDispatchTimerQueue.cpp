@@ -16,6 +16,8 @@
 
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 
+#include <algorithm>
+#include <cstdlib>
 #include <vector>
 
 #include <android-base/stringprintf.h>
@@ -186,6 +188,14 @@ void VSyncDispatchTimerQueueEntry::callback(nsecs_t vsyncTimestamp, nsecs_t wake
     mCv.notify_all();
 }
 
+void VSyncDispatchTimerQueueEntry::recordDispatch(nsecs_t wakeupTime, nsecs_t dispatchTime) {
+    const nsecs_t error = dispatchTime - wakeupTime;
+    mDispatchStats.count++;
+    mDispatchStats.totalAbsoluteError += std::abs(error);
+    mDispatchStats.maxEarly = std::max(mDispatchStats.maxEarly, -error);
+    mDispatchStats.maxLate = std::max(mDispatchStats.maxLate, error);
+}
+
 void VSyncDispatchTimerQueueEntry::ensureNotRunning() {
     std::unique_lock<std::mutex> lk(mRunningMutex);
     mCv.wait(lk, [this]() REQUIRES(mRunningMutex) { return !mRunning; });
@@ -216,6 +226,15 @@ void VSyncDispatchTimerQueueEntry::dump(std::string& result) const {
     } else {
         StringAppendF(&result, "\t\t\tmLastDispatchTime unknown\n");
     }
+
+    if (mDispatchStats.count) {
+        StringAppendF(&result,
+                      "\t\t\tdispatches: %zu mean error: %.2fus max early: %.2fus max late: "
+                      "%.2fus\n",
+                      mDispatchStats.count,
+                      mDispatchStats.totalAbsoluteError / 1e3f / mDispatchStats.count,
+                      mDispatchStats.maxEarly / 1e3f, mDispatchStats.maxLate / 1e3f);
+    }
 }
 
 VSyncDispatchTimerQueue::VSyncDispatchTimerQueue(std::unique_ptr<TimeKeeper> tk,
@@ -298,6 +317,7 @@ void VSyncDispatchTimerQueue::timerCallback() {
         std::lock_guard lock(mMutex);
         auto const now = mTimeKeeper->now();
         mLastTimerCallback = now;
+        mTimerWakeups++;
         for (auto it = mCallbacks.begin(); it != mCallbacks.end(); it++) {
             auto& callback = it->second;
             auto const wakeupTime = callback->wakeupTime();
@@ -310,11 +330,13 @@ void VSyncDispatchTimerQueue::timerCallback() {
             auto const lagAllowance = std::max(now - mIntendedWakeupTime, static_cast<nsecs_t>(0));
             if (*wakeupTime < mIntendedWakeupTime + mTimerSlack + lagAllowance) {
                 callback->executing();
+                callback->recordDispatch(*wakeupTime, now);
                 invocations.emplace_back(Invocation{callback, *callback->lastExecutedVsyncTarget(),
                                                     *wakeupTime, *readyTime});
             }
         }
 
+        mDispatchedCallbacks += invocations.size();
         mIntendedWakeupTime = kInvalidTime;
         rearmTimer(mTimeKeeper->now());
     }
@@ -436,6 +458,8 @@ void VSyncDispatchTimerQueue::dump(std::string& result) const {
     StringAppendF(&result, "\tmLastTimerCallback: %.2fms ago mLastTimerSchedule: %.2fms ago\n",
                   (mTimeKeeper->now() - mLastTimerCallback) / 1e6f,
                   (mTimeKeeper->now() - mLastTimerSchedule) / 1e6f);
+    StringAppendF(&result, "\ttimer wakeups: %zu callbacks dispatched: %zu\n", mTimerWakeups,
+                  mDispatchedCallbacks);
     StringAppendF(&result, "\tCallbacks:\n");
     for (const auto& [token, entry] : mCallbacks) {
         entry->dump(result);
@@ -74,6 +74,10 @@ public:
 
     // Checks if there is a pending update to the workload, returning true if so.
     bool hasPendingWorkloadUpdate() const;
+
+    // Records how far from its wakeup time the callback was dispatched. Callbacks grouped into
+    // an earlier wakeup are dispatched early, and timer lag dispatches them late.
+    void recordDispatch(nsecs_t wakeupTime, nsecs_t dispatchTime);
     // End: functions that are not threadsafe.
 
     // Invoke the callback with the two given timestamps, moving the state from running->disarmed.
@@ -100,6 +104,15 @@ private:
     std::optional<ArmingInfo> mArmedInfo;
     std::optional<nsecs_t> mLastDispatchTime;
 
+    // Accuracy of dispatches relative to the requested wakeup times.
+    struct DispatchStats {
+        size_t count = 0;
+        nsecs_t totalAbsoluteError = 0;
+        nsecs_t maxEarly = 0;
+        nsecs_t maxLate = 0;
+    };
+    DispatchStats mDispatchStats;
+
     std::optional<VSyncDispatch::ScheduleTiming> mWorkloadUpdateInfo;
 
     mutable std::mutex mRunningMutex;
@@ -117,7 +130,8 @@ public:
     // \param[in] tk                    A timekeeper.
     // \param[in] tracker               A tracker.
     // \param[in] timerSlack            The threshold at which different similarly timed callbacks
-    //                                  should be grouped into one wakeup.
+    //                                  should be grouped into one wakeup. All callbacks whose
+    //                                  wakeup times fall within it fire on the same timer expiry.
     // \param[in] minVsyncDistance      The minimum distance between two vsync estimates before the
     //                                  vsyncs are considered the same vsync event.
     VSyncDispatchTimerQueue(std::unique_ptr<TimeKeeper>, VsyncSchedule::TrackerPtr,
@@ -161,6 +175,8 @@ private:
     // For debugging purposes
     nsecs_t mLastTimerCallback GUARDED_BY(mMutex) = kInvalidTime;
     nsecs_t mLastTimerSchedule GUARDED_BY(mMutex) = kInvalidTime;
+    size_t mTimerWakeups GUARDED_BY(mMutex) = 0;
+    size_t mDispatchedCallbacks GUARDED_BY(mMutex) = 0;
 };
 
 } // namespace android::scheduler
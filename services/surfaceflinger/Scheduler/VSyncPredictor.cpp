@@ -25,6 +25,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <numeric>
 #include <sstream>
 
 #include <android-base/logging.h>
@@ -44,6 +45,17 @@ using base::StringAppendF;
 
 static auto constexpr kMaxPercent = 100u;
 
+// Samples whose residual against the robust fit exceeds this many median absolute deviations are
+// excluded from the regression.
+static auto constexpr kOutlierMedianDeviations = 5;
+
+// Returns the (upper) median of values, reordering them in the process.
+static nsecs_t median(std::vector<nsecs_t>& values) {
+    const auto middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+}
+
 VSyncPredictor::~VSyncPredictor() = default;
 
 VSyncPredictor::VSyncPredictor(PhysicalDisplayId id, nsecs_t idealPeriod, size_t historySize,
@@ -122,6 +134,15 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
         return false;
     }
 
+    if (mTimestamps.size() >= kMinimumSamplesForPrediction) {
+        const auto [slope, _] = getVSyncPredictionModelLocked();
+        const auto prediction = nextAnticipatedVSyncTimeFromLocked(timestamp - slope / 2);
+        const auto error = std::abs(timestamp - prediction);
+        mPredictionError.count++;
+        mPredictionError.totalAbsoluteError += error;
+        mPredictionError.maxAbsoluteError = std::max(mPredictionError.maxAbsoluteError, error);
+    }
+
     if (mTimestamps.size() != kHistorySize) {
         mTimestamps.push_back(timestamp);
         mLastTimestampIndex = next(mLastTimestampIndex);
@@ -134,7 +155,11 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
 
     const size_t numSamples = mTimestamps.size();
     if (numSamples < kMinimumSamplesForPrediction) {
-        mRateMap[mIdealPeriod] = {mIdealPeriod, 0};
+        // Until there are enough samples to refine it, keep the period previously learned for this
+        // rate, so that switching back to a known mode predicts with its measured period rather
+        // than the ideal one. The intercept is relative to the discarded samples, so drop it.
+        const auto [it, _] = mRateMap.try_emplace(mIdealPeriod, Model{mIdealPeriod, 0});
+        it->second.intercept = 0;
         return true;
     }
 
@@ -161,10 +186,6 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
     auto it = mRateMap.find(mIdealPeriod);
     auto const currentPeriod = it->second.slope;
 
-    // The mean of the ordinals must be precise for the intercept calculation, so scale them up for
-    // fixed-point arithmetic.
-    constexpr int64_t kScalingFactor = 1000;
-
     nsecs_t meanTS = 0;
     nsecs_t meanOrdinal = 0;
 
@@ -180,17 +201,36 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
         meanOrdinal += ordinal;
     }
 
-    meanTS /= numSamples;
-    meanOrdinal /= numSamples;
+    // A single late or early sample that still passes validate() can pull the least squares fit
+    // far enough to skew every prediction, so samples that disagree with a robust Theil-Sen fit
+    // (the median of the pairwise slopes) are dropped before the regression.
+    const auto inliers = findInliers(vsyncTS, ordinals);
+    if (inliers.size() != numSamples) {
+        meanTS = 0;
+        meanOrdinal = 0;
+        for (size_t i = 0; i < inliers.size(); i++) {
+            vsyncTS[i] = vsyncTS[inliers[i]];
+            ordinals[i] = ordinals[inliers[i]];
+            meanTS += vsyncTS[i];
+            meanOrdinal += ordinals[i];
+        }
+        vsyncTS.resize(inliers.size());
+        ordinals.resize(inliers.size());
+        traceInt64If("VSP-outliers", numSamples - inliers.size());
+    }
+    const size_t numInliers = inliers.size();
+
+    meanTS /= numInliers;
+    meanOrdinal /= numInliers;
 
-    for (size_t i = 0; i < numSamples; i++) {
+    for (size_t i = 0; i < numInliers; i++) {
         vsyncTS[i] -= meanTS;
         ordinals[i] -= meanOrdinal;
     }
 
     nsecs_t top = 0;
     nsecs_t bottom = 0;
-    for (size_t i = 0; i < numSamples; i++) {
+    for (size_t i = 0; i < numInliers; i++) {
         top += vsyncTS[i] * ordinals[i];
         bottom += ordinals[i] * ordinals[i];
     }
@@ -221,6 +261,54 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
     return true;
 }
 
+std::vector<size_t> VSyncPredictor::findInliers(const std::vector<nsecs_t>& vsyncTS,
+                                                const std::vector<nsecs_t>& ordinals) const {
+    const size_t numSamples = vsyncTS.size();
+    std::vector<size_t> inliers(numSamples);
+    std::iota(inliers.begin(), inliers.end(), 0);
+
+    std::vector<nsecs_t> slopes;
+    slopes.reserve(numSamples * (numSamples - 1) / 2);
+    for (size_t i = 0; i < numSamples; i++) {
+        for (size_t j = i + 1; j < numSamples; j++) {
+            if (ordinals[i] != ordinals[j]) {
+                slopes.push_back((vsyncTS[j] - vsyncTS[i]) * kScalingFactor /
+                                 (ordinals[j] - ordinals[i]));
+            }
+        }
+    }
+    if (slopes.empty()) {
+        return inliers;
+    }
+    const nsecs_t slope = median(slopes);
+
+    std::vector<nsecs_t> residuals(numSamples);
+    for (size_t i = 0; i < numSamples; i++) {
+        residuals[i] = vsyncTS[i] - slope * ordinals[i] / kScalingFactor;
+    }
+    auto offsets = residuals;
+    const nsecs_t intercept = median(offsets);
+    for (auto& residual : residuals) {
+        residual = std::abs(residual - intercept);
+    }
+    auto deviations = residuals;
+    const nsecs_t threshold = std::max(kOutlierMedianDeviations * median(deviations),
+                                       mIdealPeriod / static_cast<nsecs_t>(kMaxPercent));
+
+    std::vector<size_t> robustInliers;
+    for (size_t i = 0; i < numSamples; i++) {
+        if (residuals[i] <= threshold) {
+            robustInliers.push_back(i);
+        }
+    }
+
+    // Too few samples agree with each other to tell which ones are outliers.
+    if (robustInliers.size() < kMinimumSamplesForPrediction) {
+        return inliers;
+    }
+    return robustInliers;
+}
+
 auto VSyncPredictor::getVsyncSequenceLocked(nsecs_t timestamp) const -> VsyncSequence {
     const auto vsync = nextAnticipatedVSyncTimeFromLocked(timestamp);
     if (!mLastVsyncSequence) return {vsync, 0};
@@ -401,6 +489,11 @@ void VSyncPredictor::dump(std::string& result) const {
                       idealPeriod / 1e6f, periodInterceptTuple.slope / 1e6f,
                       periodInterceptTuple.intercept);
     }
+    const auto& error = mPredictionError;
+    StringAppendF(&result, "\tPrediction error: samples = %zu, mean = %.2fus, max = %.2fus\n",
+                  error.count,
+                  error.count == 0 ? 0.f : error.totalAbsoluteError / 1e3f / error.count,
+                  error.maxAbsoluteError / 1e3f);
 }
 
 } // namespace android::scheduler
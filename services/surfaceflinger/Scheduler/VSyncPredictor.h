@@ -95,6 +95,22 @@ private:
     };
     VsyncSequence getVsyncSequenceLocked(nsecs_t timestamp) const REQUIRES(mMutex);
 
+    // The mean of the ordinals must be precise for the intercept calculation, so they are scaled up
+    // for fixed-point arithmetic.
+    static constexpr int64_t kScalingFactor = 1000;
+
+    // Returns the indices of the samples that agree with a median-based fit of the vsync
+    // timestamps (relative to the oldest one) over their scaled ordinals.
+    std::vector<size_t> findInliers(const std::vector<nsecs_t>& vsyncTS,
+                                    const std::vector<nsecs_t>& ordinals) const REQUIRES(mMutex);
+
+    // How far each accepted timestamp landed from the vsync the model predicted for it.
+    struct PredictionErrorStats {
+        size_t count = 0;
+        nsecs_t totalAbsoluteError = 0;
+        nsecs_t maxAbsoluteError = 0;
+    };
+
     bool const mTraceOn;
     size_t const kHistorySize;
     size_t const kMinimumSamplesForPrediction;
@@ -113,6 +129,8 @@ private:
     std::optional<Fps> mRenderRate GUARDED_BY(mMutex);
 
     mutable std::optional<VsyncSequence> mLastVsyncSequence GUARDED_BY(mMutex);
+
+    PredictionErrorStats mPredictionError GUARDED_BY(mMutex);
 };
 
 } // namespace android::scheduler
@@ -16,6 +16,7 @@
 
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 
+#include <android-base/properties.h>
 #include <ftl/fake_guard.h>
 #include <scheduler/Fps.h>
 #include <scheduler/Timer.h>
@@ -115,11 +116,19 @@ VsyncSchedule::DispatchPtr VsyncSchedule::createDispatch(TrackerPtr tracker) {
     using namespace std::chrono_literals;
 
     // TODO(b/144707443): Tune constants.
-    constexpr std::chrono::nanoseconds kGroupDispatchWithin = 500us;
+    constexpr std::chrono::microseconds kDefaultGroupDispatchWithin = 500us;
+    constexpr std::chrono::microseconds kMaxGroupDispatchWithin = 2ms;
     constexpr std::chrono::nanoseconds kSnapToSameVsyncWithin = 3ms;
 
+    // Callbacks whose wakeups fall within this window fire on a single timer expiry.
+    const std::chrono::nanoseconds groupDispatchWithin =
+            std::chrono::microseconds(base::GetIntProperty("debug.sf.vsync_dispatch_group_us",
+                                                           kDefaultGroupDispatchWithin.count(),
+                                                           std::chrono::microseconds::rep{0},
+                                                           kMaxGroupDispatchWithin.count()));
+
     return std::make_unique<VSyncDispatchTimerQueue>(std::make_unique<Timer>(), std::move(tracker),
-                                                     kGroupDispatchWithin.count(),
+                                                     groupDispatchWithin.count(),
                                                      kSnapToSameVsyncWithin.count());
 }
 
@@ -26,6 +26,11 @@ namespace android {
 
 namespace {
 
+// Captures of at least this many pixels (4K) are rendered in tiles, so that composition is not
+// blocked behind the whole capture.
+constexpr int64_t kMinTiledCapturePixels = 3840 * 2160;
+constexpr uint32_t kCaptureRenderTileSize = 1024;
+
 ui::Size getDisplaySize(ui::Rotation orientation, const Rect& sourceCrop) {
     if (orientation == ui::Rotation::Rotation90 || orientation == ui::Rotation::Rotation270) {
         return {sourceCrop.getHeight(), sourceCrop.getWidth()};
@@ -97,6 +102,13 @@ renderengine::DisplaySettings ScreenCaptureOutput::generateClientCompositionDisp
     auto clientCompositionDisplay =
             compositionengine::impl::Output::generateClientCompositionDisplaySettings();
     clientCompositionDisplay.clip = mRenderArea.getSourceCrop();
+    clientCompositionDisplay.priority = renderengine::DisplaySettings::Priority::SCREEN_CAPTURE;
+
+    const Rect& physicalDisplay = clientCompositionDisplay.physicalDisplay;
+    if (static_cast<int64_t>(physicalDisplay.getWidth()) * physicalDisplay.getHeight() >=
+        kMinTiledCapturePixels) {
+        clientCompositionDisplay.renderTileSize = kCaptureRenderTileSize;
+    }
 
     auto renderIntent = static_cast<ui::RenderIntent>(clientCompositionDisplay.renderIntent);
     if (mDimInGammaSpaceForEnhancedScreenshots && renderIntent != ui::RenderIntent::COLORIMETRIC &&
@@ -504,6 +504,10 @@ SurfaceFlinger::SurfaceFlinger(Factory& factory) : SurfaceFlinger(factory, SkipI
             base::GetBoolProperty("persist.debug.sf.enable_layer_lifecycle_manager"s, false);
     mLegacyFrontEndEnabled = !mLayerLifecycleManagerEnabled ||
             base::GetBoolProperty("persist.debug.sf.enable_legacy_frontend"s, false);
+    mLayerSnapshotBuilder.setParallelUpdateThreads(
+            base::GetUintProperty("debug.sf.layer_snapshot_builder_threads"s, 0u));
+    mCompositionEngine->setMultithreadedPresent(
+            base::GetBoolProperty("debug.sf.multithreaded_present"s, false));
 }
 
 LatchUnsignaledConfig SurfaceFlinger::getLatchUnsignaledConfig() {
@@ -845,6 +849,8 @@ void SurfaceFlinger::init() FTL_FAKE_GUARD(kMainThreadContext) {
     if (auto type = chooseRenderEngineTypeViaSysProp()) {
         builder.setRenderEngineType(type.value());
     }
+    builder.setRecordedDrawsPath(
+            base::GetProperty(PROPERTY_RENDERENGINE_RECORDED_DRAWS_PATH, ""));
     mRenderEngine = renderengine::RenderEngine::create(builder.build());
     mCompositionEngine->setRenderEngine(mRenderEngine.get());
     mMaxRenderTargetSize =
@@ -2515,6 +2521,10 @@ CompositeResultsPerDisplay SurfaceFlinger::composite(
     const VsyncId vsyncId = pacesetterTarget.vsyncId();
     ATRACE_NAME(ftl::Concat(__func__, ' ', ftl::to_underlying(vsyncId)).c_str());
 
+    if (mPowerHintSessionEnabled) {
+        mPowerAdvisor->setCompositeStart(TimePoint::now());
+    }
+
     compositionengine::CompositionRefreshArgs refreshArgs;
     refreshArgs.powerCallback = this;
     const auto& displays = FTL_FAKE_GUARD(mStateLock, mDisplays);
@@ -2586,10 +2596,9 @@ CompositeResultsPerDisplay SurfaceFlinger::composite(
     refreshArgs.updatingGeometryThisFrame = mGeometryDirty.exchange(false) || mVisibleRegionsDirty;
     refreshArgs.internalDisplayRotationFlags = getActiveDisplayRotationFlags();
 
-    if (CC_UNLIKELY(mDrawingState.colorMatrixChanged)) {
-        refreshArgs.colorTransformMatrix = mDrawingState.colorMatrix;
-        mDrawingState.colorMatrixChanged = false;
-    }
+    // Each output compares the fused color matrix against the one it last applied, so that a
+    // display added after the last change is brought up to date as well.
+    refreshArgs.colorTransformMatrix = mDrawingState.colorMatrix;
 
     refreshArgs.devOptForceClientComposition = mDebugDisableHWC;
 
@@ -3794,7 +3803,9 @@ void SurfaceFlinger::updateInputFlinger(VsyncId vsyncId, TimePoint frameTime) {
                                                       inputFlinger = mInputFlinger, this,
                                                       visibleWindowsChanged, vsyncId, frameTime]() {
         ATRACE_NAME("BackgroundExecutor::updateInputFlinger");
-        if (updateWindowInfo) {
+        // Input info is invalidated by many layer changes that do not affect any window, e.g. a
+        // buffer update. Skip sending listeners a copy of every window when nothing changed.
+        if (updateWindowInfo && windowInfosDifferFromLastSent(windowInfos, displayInfos)) {
             mWindowInfosListenerInvoker
                     ->windowInfosChanged(gui::WindowInfosUpdate{std::move(windowInfos),
                                                                 std::move(displayInfos),
@@ -3821,6 +3832,18 @@ void SurfaceFlinger::updateInputFlinger(VsyncId vsyncId, TimePoint frameTime) {
     mInputWindowCommands.clear();
 }
 
+bool SurfaceFlinger::windowInfosDifferFromLastSent(const std::vector<WindowInfo>& windowInfos,
+                                                   const std::vector<DisplayInfo>& displayInfos) {
+    auto contents = std::make_unique<Parcel>();
+    contents->writeParcelableVector(windowInfos);
+    contents->writeParcelableVector(displayInfos);
+    if (mLastSentWindowInfos && mLastSentWindowInfos->compareData(*contents) == 0) {
+        return false;
+    }
+    mLastSentWindowInfos = std::move(contents);
+    return true;
+}
+
 void SurfaceFlinger::persistDisplayBrightness(bool needsComposite) {
     const bool supportsDisplayBrightnessCommand = getHwComposer().getComposer()->isSupported(
             Hwc2::Composer::OptionalFeature::DisplayBrightnessCommand);
@@ -4339,12 +4362,10 @@ TransactionHandler::TransactionReadiness SurfaceFlinger::transactionReadyBufferC
         const TransactionHandler::TransactionFlushState& flushState) {
     using TransactionReadiness = TransactionHandler::TransactionReadiness;
     auto ready = TransactionReadiness::Ready;
-    flushState.transaction->traverseStatesWithBuffersWhileTrue([&](const layer_state_t& s,
-                                                                   const std::shared_ptr<
-                                                                           renderengine::
-                                                                                   ExternalTexture>&
-                                                                           externalTexture)
-                                                                       -> bool {
+    flushState.transaction->traverseStatesWithBuffersWhileTrue([&](ResolvedComposerState&
+                                                                           resolvedState) -> bool {
+        const layer_state_t& s = resolvedState.state;
+        const auto& externalTexture = resolvedState.externalTexture;
         sp<Layer> layer = LayerHandle::getLayer(s.surface);
         const auto& transaction = *flushState.transaction;
         // check for barrier frames
@@ -4396,8 +4417,12 @@ TransactionHandler::TransactionReadiness SurfaceFlinger::transactionReadyBufferC
         const bool acquireFenceAvailable = s.bufferData &&
                 s.bufferData->flags.test(BufferData::BufferDataChange::fenceChanged) &&
                 s.bufferData->acquireFence;
-        const bool fenceSignaled = !checkAcquireFence || !acquireFenceAvailable ||
-                s.bufferData->acquireFence->getStatus() != Fence::Status::Unsignaled;
+        if (checkAcquireFence && acquireFenceAvailable && !resolvedState.acquireFenceSignaled) {
+            resolvedState.acquireFenceSignaled =
+                    s.bufferData->acquireFence->getStatus() != Fence::Status::Unsignaled;
+        }
+        const bool fenceSignaled =
+                !checkAcquireFence || !acquireFenceAvailable || resolvedState.acquireFenceSignaled;
         if (!fenceSignaled) {
             // check fence status
             const bool allowLatchUnsignaled =
@@ -7107,7 +7132,7 @@ status_t SurfaceFlinger::captureDisplay(const DisplayCaptureArgs& args,
     auto future = captureScreenCommon(std::move(renderAreaFuture), getLayerSnapshots, reqSize,
                                       args.pixelFormat, args.allowProtected, args.grayscale,
                                       captureListener);
-    return fenceStatus(future.get());
+    return finishScreenCapture(std::move(future), captureListener);
 }
 
 status_t SurfaceFlinger::captureDisplay(DisplayId displayId,
@@ -7157,7 +7182,7 @@ status_t SurfaceFlinger::captureDisplay(DisplayId displayId,
     auto future = captureScreenCommon(std::move(renderAreaFuture), getLayerSnapshots, size,
                                       ui::PixelFormat::RGBA_8888, kAllowProtected, kGrayscale,
                                       captureListener);
-    return fenceStatus(future.get());
+    return finishScreenCapture(std::move(future), captureListener);
 }
 
 status_t SurfaceFlinger::captureLayers(const LayerCaptureArgs& args,
@@ -7295,7 +7320,7 @@ status_t SurfaceFlinger::captureLayers(const LayerCaptureArgs& args,
     auto future = captureScreenCommon(std::move(renderAreaFuture), getLayerSnapshots, reqSize,
                                       args.pixelFormat, args.allowProtected, args.grayscale,
                                       captureListener);
-    return fenceStatus(future.get());
+    return finishScreenCapture(std::move(future), captureListener);
 }
 
 ftl::SharedFuture<FenceResult> SurfaceFlinger::captureScreenCommon(
@@ -7409,6 +7434,21 @@ ftl::SharedFuture<FenceResult> SurfaceFlinger::captureScreenCommon(
     return chain.share();
 }
 
+status_t SurfaceFlinger::finishScreenCapture(ftl::SharedFuture<FenceResult> future,
+                                             const sp<IScreenCaptureListener>& captureListener) {
+    // Errors found before composition, e.g. a failed allocation, are returned to the caller.
+    if (!captureListener || future.wait_for(0ms) == std::future_status::ready) {
+        return fenceStatus(future.get());
+    }
+
+    // The listener receives the result, so there is no need to hold the caller's Binder thread
+    // while CompositionEngine presents. Returning early lets the caller queue its next capture
+    // while this one is still being composited.
+    BackgroundExecutor::getLowPriorityInstance().sendCallbacks(
+            {[future = std::move(future)]() mutable { future.get(); }});
+    return NO_ERROR;
+}
+
 ftl::SharedFuture<FenceResult> SurfaceFlinger::renderScreenImpl(
         std::shared_ptr<const RenderArea> renderArea, GetLayerSnapshotsFunction getLayerSnapshots,
         const std::shared_ptr<renderengine::ExternalTexture>& buffer,
@@ -8147,6 +8187,11 @@ void SurfaceFlinger::onActiveDisplayChangedLocked(const DisplayDevice* inactiveD
 status_t SurfaceFlinger::addWindowInfosListener(const sp<IWindowInfosListener>& windowInfosListener,
                                                 gui::WindowInfosListenerInfo* outInfo) {
     mWindowInfosListenerInvoker->addWindowInfosListener(windowInfosListener, outInfo);
+    // The new listener has not seen any window infos yet, so the next update must be sent even if
+    // it is unchanged. This is queued behind the listener being added, and ahead of that update.
+    BackgroundExecutor::getInstance().sendCallbacks({[this]() {
+        mLastSentWindowInfos.reset();
+    }});
     setTransactionFlags(eInputInfoUpdateNeeded);
     return NO_ERROR;
 }
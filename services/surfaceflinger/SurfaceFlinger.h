@@ -745,6 +745,10 @@ private:
     void persistDisplayBrightness(bool needsComposite) REQUIRES(kMainThreadContext);
     void buildWindowInfos(std::vector<gui::WindowInfo>& outWindowInfos,
                           std::vector<gui::DisplayInfo>& outDisplayInfos);
+    // Returns whether the window and display infos differ from those last sent to window infos
+    // listeners, and remembers them if so. Only called on the BackgroundExecutor thread.
+    bool windowInfosDifferFromLastSent(const std::vector<gui::WindowInfo>&,
+                                       const std::vector<gui::DisplayInfo>&);
     void commitInputWindowCommands() REQUIRES(mStateLock);
     void updateCursorAsync();
 
@@ -856,6 +860,10 @@ private:
             const std::shared_ptr<renderengine::ExternalTexture>&, bool canCaptureBlackoutContent,
             bool regionSampling, bool grayscale, ScreenCaptureResults&) EXCLUDES(mStateLock)
             REQUIRES(kMainThreadContext);
+    // Returns the status of a capture started by captureScreenCommon. If the capture reports to a
+    // listener, composition is finished in the background rather than blocking the caller.
+    status_t finishScreenCapture(ftl::SharedFuture<FenceResult>,
+                                 const sp<IScreenCaptureListener>&);
 
     bool canAllocateHwcDisplayIdForVDS(uint64_t usage);
 
@@ -1455,6 +1463,10 @@ private:
 
     // WindowInfo ids visible during the last commit.
     std::unordered_set<int32_t> mVisibleWindowIds;
+
+    // Serialized window and display infos last sent to window infos listeners. Only accessed on
+    // the BackgroundExecutor thread.
+    std::unique_ptr<Parcel> mLastSentWindowInfos;
 };
 
 class SurfaceComposerAIDL : public gui::BnSurfaceComposer {
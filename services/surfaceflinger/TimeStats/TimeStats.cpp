@@ -25,6 +25,8 @@
 #include <utils/Timers.h>
 #include <utils/Trace.h>
 
+#include <pthread.h>
+
 #include <algorithm>
 #include <chrono>
 #include <cmath>
@@ -93,6 +95,7 @@ SurfaceflingerStatsLayerInfo_SetFrameRateVote frameRateVoteToProto(
 
 bool TimeStats::populateGlobalAtom(std::vector<uint8_t>* pulledData) {
     std::lock_guard<std::mutex> lock(mMutex);
+    drainLayerEventsLocked();
 
     if (mTimeStats.statsStartLegacy == 0) {
         return false;
@@ -145,6 +148,7 @@ bool TimeStats::populateGlobalAtom(std::vector<uint8_t>* pulledData) {
 
 bool TimeStats::populateLayerAtom(std::vector<uint8_t>* pulledData) {
     std::lock_guard<std::mutex> lock(mMutex);
+    drainLayerEventsLocked();
 
     std::vector<TimeStatsHelper::TimeStatsLayer*> dumpStats;
     uint32_t numLayers = 0;
@@ -252,6 +256,75 @@ TimeStats::TimeStats(std::optional<size_t> maxPulledLayers,
     if (maxPulledHistogramBuckets) {
         mMaxPulledHistogramBuckets = *maxPulledHistogramBuckets;
     }
+
+    mPendingLayerEvents.reserve(LAYER_EVENTS_DRAIN_BATCH_SIZE);
+    mDrainingLayerEvents.reserve(LAYER_EVENTS_DRAIN_BATCH_SIZE);
+    mDrainThread = std::thread(&TimeStats::drainThreadMain, this);
+}
+
+TimeStats::~TimeStats() {
+    {
+        std::lock_guard<std::mutex> lock(mLayerEventsMutex);
+        mDrainThreadDone = true;
+    }
+    mDrainCondition.notify_one();
+    mDrainThread.join();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    drainLayerEventsLocked();
+}
+
+void TimeStats::drainThreadMain() {
+    pthread_setname_np(pthread_self(), "TimeStats");
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mLayerEventsMutex);
+            mDrainCondition.wait(lock, [this] {
+                return mDrainThreadDone ||
+                        mPendingLayerEvents.size() >= LAYER_EVENTS_DRAIN_BATCH_SIZE;
+            });
+            if (mDrainThreadDone) return;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        drainLayerEventsLocked();
+    }
+}
+
+void TimeStats::pushLayerEvent(LayerEvent&& event) {
+    bool batchFull;
+    {
+        std::lock_guard<std::mutex> lock(mLayerEventsMutex);
+        mPendingLayerEvents.push_back(std::move(event));
+        batchFull = mPendingLayerEvents.size() == LAYER_EVENTS_DRAIN_BATCH_SIZE;
+    }
+    if (batchFull) {
+        mDrainCondition.notify_one();
+    }
+}
+
+void TimeStats::drainLayerEventsLocked() {
+    {
+        std::lock_guard<std::mutex> lock(mLayerEventsMutex);
+        std::swap(mPendingLayerEvents, mDrainingLayerEvents);
+    }
+    for (const auto& event : mDrainingLayerEvents) {
+        std::visit([this](const auto& layerEvent) { applyLayerEventLocked(layerEvent); }, event);
+    }
+    mDrainingLayerEvents.clear();
+}
+
+TimeStats::TimeRecord* TimeStats::getWaitingTimeRecordLocked(int32_t layerId,
+                                                             uint64_t frameNumber) {
+    const auto it = mTimeStatsTracker.find(layerId);
+    if (it == mTimeStatsTracker.end()) return nullptr;
+    LayerRecord& layerRecord = it->second;
+    if (layerRecord.waitData < 0 ||
+        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
+        return nullptr;
+    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
+    return timeRecord.frameTime.frameNumber == frameNumber ? &timeRecord : nullptr;
 }
 
 bool TimeStats::onPullAtom(const int atomId, std::vector<uint8_t>* pulledData) {
@@ -307,6 +380,7 @@ std::string TimeStats::miniDump() {
 
     std::string result = "TimeStats miniDump:\n";
     std::lock_guard<std::mutex> lock(mMutex);
+    drainLayerEventsLocked();
     android::base::StringAppendF(&result, "Number of layers currently being tracked is %zu\n",
                                  mTimeStatsTracker.size());
     android::base::StringAppendF(&result, "Number of layers in the stats pool is %zu\n",
@@ -581,7 +655,16 @@ void TimeStats::setPostTime(int32_t layerId, uint64_t frameNumber, const std::st
     ALOGV("[%d]-[%" PRIu64 "]-[%s]-PostTime[%" PRId64 "]", layerId, frameNumber, layerName.c_str(),
           postTime);
 
-    std::lock_guard<std::mutex> lock(mMutex);
+    pushLayerEvent(PostTimeEvent{.layerId = layerId,
+                                    .frameNumber = frameNumber,
+                                    .layerName = layerName,
+                                    .uid = uid,
+                                    .postTime = postTime,
+                                    .gameMode = gameMode});
+}
+
+void TimeStats::applyLayerEventLocked(const PostTimeEvent& event) {
+    const auto& [layerId, frameNumber, layerName, uid, postTime, gameMode] = event;
     if (!canAddNewAggregatedStats(uid, layerName, gameMode)) {
         return;
     }
@@ -624,16 +707,10 @@ void TimeStats::setLatchTime(int32_t layerId, uint64_t frameNumber, nsecs_t latc
     ATRACE_CALL();
     ALOGV("[%d]-[%" PRIu64 "]-LatchTime[%" PRId64 "]", layerId, frameNumber, latchTime);
 
-    std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
-    if (layerRecord.waitData < 0 ||
-        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
-        return;
-    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
-    if (timeRecord.frameTime.frameNumber == frameNumber) {
-        timeRecord.frameTime.latchTime = latchTime;
-    }
+    pushLayerEvent(FrameTimeEvent{.layerId = layerId,
+                                     .frameNumber = frameNumber,
+                                     .field = &FrameTime::latchTime,
+                                     .time = latchTime});
 }
 
 void TimeStats::incrementLatchSkipped(int32_t layerId, LatchSkipReason reason) {
@@ -643,7 +720,11 @@ void TimeStats::incrementLatchSkipped(int32_t layerId, LatchSkipReason reason) {
     ALOGV("[%d]-LatchSkipped-Reason[%d]", layerId,
           static_cast<std::underlying_type<LatchSkipReason>::type>(reason));
 
-    std::lock_guard<std::mutex> lock(mMutex);
+    pushLayerEvent(LatchSkippedEvent{.layerId = layerId, .reason = reason});
+}
+
+void TimeStats::applyLayerEventLocked(const LatchSkippedEvent& event) {
+    const auto [layerId, reason] = event;
     if (!mTimeStatsTracker.count(layerId)) return;
     LayerRecord& layerRecord = mTimeStatsTracker[layerId];
 
@@ -660,7 +741,11 @@ void TimeStats::incrementBadDesiredPresent(int32_t layerId) {
     ATRACE_CALL();
     ALOGV("[%d]-BadDesiredPresent", layerId);
 
-    std::lock_guard<std::mutex> lock(mMutex);
+    pushLayerEvent(BadDesiredPresentEvent{.layerId = layerId});
+}
+
+void TimeStats::applyLayerEventLocked(const BadDesiredPresentEvent& event) {
+    const int32_t layerId = event.layerId;
     if (!mTimeStatsTracker.count(layerId)) return;
     LayerRecord& layerRecord = mTimeStatsTracker[layerId];
     layerRecord.badDesiredPresentFrames++;
@@ -672,16 +757,10 @@ void TimeStats::setDesiredTime(int32_t layerId, uint64_t frameNumber, nsecs_t de
     ATRACE_CALL();
     ALOGV("[%d]-[%" PRIu64 "]-DesiredTime[%" PRId64 "]", layerId, frameNumber, desiredTime);
 
-    std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
-    if (layerRecord.waitData < 0 ||
-        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
-        return;
-    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
-    if (timeRecord.frameTime.frameNumber == frameNumber) {
-        timeRecord.frameTime.desiredTime = desiredTime;
-    }
+    pushLayerEvent(FrameTimeEvent{.layerId = layerId,
+                                     .frameNumber = frameNumber,
+                                     .field = &FrameTime::desiredTime,
+                                     .time = desiredTime});
 }
 
 void TimeStats::setAcquireTime(int32_t layerId, uint64_t frameNumber, nsecs_t acquireTime) {
@@ -690,15 +769,15 @@ void TimeStats::setAcquireTime(int32_t layerId, uint64_t frameNumber, nsecs_t ac
     ATRACE_CALL();
     ALOGV("[%d]-[%" PRIu64 "]-AcquireTime[%" PRId64 "]", layerId, frameNumber, acquireTime);
 
-    std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
-    if (layerRecord.waitData < 0 ||
-        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
-        return;
-    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
-    if (timeRecord.frameTime.frameNumber == frameNumber) {
-        timeRecord.frameTime.acquireTime = acquireTime;
+    pushLayerEvent(FrameTimeEvent{.layerId = layerId,
+                                     .frameNumber = frameNumber,
+                                     .field = &FrameTime::acquireTime,
+                                     .time = acquireTime});
+}
+
+void TimeStats::applyLayerEventLocked(const FrameTimeEvent& event) {
+    if (TimeRecord* timeRecord = getWaitingTimeRecordLocked(event.layerId, event.frameNumber)) {
+        timeRecord->frameTime.*event.field = event.time;
     }
 }
 
@@ -710,15 +789,14 @@ void TimeStats::setAcquireFence(int32_t layerId, uint64_t frameNumber,
     ALOGV("[%d]-[%" PRIu64 "]-AcquireFenceTime[%" PRId64 "]", layerId, frameNumber,
           acquireFence->getSignalTime());
 
-    std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
-    if (layerRecord.waitData < 0 ||
-        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
-        return;
-    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
-    if (timeRecord.frameTime.frameNumber == frameNumber) {
-        timeRecord.acquireFence = acquireFence;
+    pushLayerEvent(AcquireFenceEvent{.layerId = layerId,
+                                        .frameNumber = frameNumber,
+                                        .acquireFence = acquireFence});
+}
+
+void TimeStats::applyLayerEventLocked(const AcquireFenceEvent& event) {
+    if (TimeRecord* timeRecord = getWaitingTimeRecordLocked(event.layerId, event.frameNumber)) {
+        timeRecord->acquireFence = event.acquireFence;
     }
 }
 
@@ -730,21 +808,13 @@ void TimeStats::setPresentTime(int32_t layerId, uint64_t frameNumber, nsecs_t pr
     ATRACE_CALL();
     ALOGV("[%d]-[%" PRIu64 "]-PresentTime[%" PRId64 "]", layerId, frameNumber, presentTime);
 
-    std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
-    if (layerRecord.waitData < 0 ||
-        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
-        return;
-    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
-    if (timeRecord.frameTime.frameNumber == frameNumber) {
-        timeRecord.frameTime.presentTime = presentTime;
-        timeRecord.ready = true;
-        layerRecord.waitData++;
-    }
-
-    flushAvailableRecordsToStatsLocked(layerId, displayRefreshRate, renderRate, frameRateVote,
-                                       gameMode);
+    pushLayerEvent(PresentEvent{.layerId = layerId,
+                                   .frameNumber = frameNumber,
+                                   .present = presentTime,
+                                   .displayRefreshRate = displayRefreshRate,
+                                   .renderRate = renderRate,
+                                   .frameRateVote = frameRateVote,
+                                   .gameMode = gameMode});
 }
 
 void TimeStats::setPresentFence(int32_t layerId, uint64_t frameNumber,
@@ -757,21 +827,29 @@ void TimeStats::setPresentFence(int32_t layerId, uint64_t frameNumber,
     ALOGV("[%d]-[%" PRIu64 "]-PresentFenceTime[%" PRId64 "]", layerId, frameNumber,
           presentFence->getSignalTime());
 
-    std::lock_guard<std::mutex> lock(mMutex);
-    if (!mTimeStatsTracker.count(layerId)) return;
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
-    if (layerRecord.waitData < 0 ||
-        layerRecord.waitData >= static_cast<int32_t>(layerRecord.timeRecords.size()))
-        return;
-    TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
-    if (timeRecord.frameTime.frameNumber == frameNumber) {
-        timeRecord.presentFence = presentFence;
-        timeRecord.ready = true;
-        layerRecord.waitData++;
+    pushLayerEvent(PresentEvent{.layerId = layerId,
+                                   .frameNumber = frameNumber,
+                                   .present = presentFence,
+                                   .displayRefreshRate = displayRefreshRate,
+                                   .renderRate = renderRate,
+                                   .frameRateVote = frameRateVote,
+                                   .gameMode = gameMode});
+}
+
+void TimeStats::applyLayerEventLocked(const PresentEvent& event) {
+    if (TimeRecord* timeRecord = getWaitingTimeRecordLocked(event.layerId, event.frameNumber)) {
+        if (const auto* presentTime = std::get_if<nsecs_t>(&event.present)) {
+            timeRecord->frameTime.presentTime = *presentTime;
+        } else {
+            timeRecord->presentFence = std::get<std::shared_ptr<FenceTime>>(event.present);
+        }
+        timeRecord->ready = true;
+        mTimeStatsTracker[event.layerId].waitData++;
     }
 
-    flushAvailableRecordsToStatsLocked(layerId, displayRefreshRate, renderRate, frameRateVote,
-                                       gameMode);
+    if (!mTimeStatsTracker.count(event.layerId)) return;
+    flushAvailableRecordsToStatsLocked(event.layerId, event.displayRefreshRate, event.renderRate,
+                                       event.frameRateVote, event.gameMode);
 }
 
 static const constexpr int32_t kValidJankyReason = JankType::DisplayHAL |
@@ -815,8 +893,10 @@ void TimeStats::incrementJankyFrames(const JankyFramesInfo& info) {
     if (!mEnabled.load()) return;
 
     ATRACE_CALL();
-    std::lock_guard<std::mutex> lock(mMutex);
+    pushLayerEvent(info);
+}
 
+void TimeStats::applyLayerEventLocked(const JankyFramesInfo& info) {
     // Only update layer stats if we're already tracking the layer in TimeStats.
     // Otherwise, continue tracking the statistic but use a default layer name instead.
     // As an implementation detail, we do this because this method is expected to be
@@ -872,8 +952,11 @@ void TimeStats::incrementJankyFrames(const JankyFramesInfo& info) {
 void TimeStats::onDestroy(int32_t layerId) {
     ATRACE_CALL();
     ALOGV("[%d]-onDestroy", layerId);
-    std::lock_guard<std::mutex> lock(mMutex);
-    mTimeStatsTracker.erase(layerId);
+    pushLayerEvent(DestroyEvent{.layerId = layerId});
+}
+
+void TimeStats::applyLayerEventLocked(const DestroyEvent& event) {
+    mTimeStatsTracker.erase(event.layerId);
 }
 
 void TimeStats::removeTimeRecord(int32_t layerId, uint64_t frameNumber) {
@@ -882,7 +965,11 @@ void TimeStats::removeTimeRecord(int32_t layerId, uint64_t frameNumber) {
     ATRACE_CALL();
     ALOGV("[%d]-[%" PRIu64 "]-removeTimeRecord", layerId, frameNumber);
 
-    std::lock_guard<std::mutex> lock(mMutex);
+    pushLayerEvent(RemoveTimeRecordEvent{.layerId = layerId, .frameNumber = frameNumber});
+}
+
+void TimeStats::applyLayerEventLocked(const RemoveTimeRecordEvent& event) {
+    const auto [layerId, frameNumber] = event;
     if (!mTimeStatsTracker.count(layerId)) return;
     LayerRecord& layerRecord = mTimeStatsTracker[layerId];
     size_t removeAt = 0;
@@ -1034,6 +1121,7 @@ void TimeStats::enable() {
     ATRACE_CALL();
 
     std::lock_guard<std::mutex> lock(mMutex);
+    drainLayerEventsLocked();
     mEnabled.store(true);
     mTimeStats.statsStartLegacy = static_cast<int64_t>(std::time(0));
     mPowerTime.prevTime = systemTime();
@@ -1046,6 +1134,7 @@ void TimeStats::disable() {
     ATRACE_CALL();
 
     std::lock_guard<std::mutex> lock(mMutex);
+    drainLayerEventsLocked();
     flushPowerTimeLocked();
     mEnabled.store(false);
     mTimeStats.statsEndLegacy = static_cast<int64_t>(std::time(0));
@@ -1054,6 +1143,7 @@ void TimeStats::disable() {
 
 void TimeStats::clearAll() {
     std::lock_guard<std::mutex> lock(mMutex);
+    drainLayerEventsLocked();
     mTimeStats.stats.clear();
     clearGlobalLocked();
     clearLayersLocked();
@@ -1106,6 +1196,7 @@ void TimeStats::dump(bool asProto, std::optional<uint32_t> maxLayers, std::strin
     ATRACE_CALL();
 
     std::lock_guard<std::mutex> lock(mMutex);
+    drainLayerEventsLocked();
     if (mTimeStats.statsStartLegacy == 0) {
         return;
     }
@@ -16,12 +16,15 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <cstdint>
 #include <deque>
 #include <mutex>
 #include <optional>
+#include <thread>
 #include <unordered_map>
 #include <variant>
+#include <vector>
 
 #include <android/hardware/graphics/composer/2.4/IComposerClient.h>
 #include <gui/JankInfo.h>
@@ -239,11 +242,71 @@ class TimeStats : public android::TimeStats {
         std::deque<RenderEngineDuration> renderEngineDurations;
     };
 
+    // Per-layer events are queued without taking mMutex, and applied to mTimeStatsTracker when
+    // the queue is drained, either by mDrainThread once a batch has built up or before the stats
+    // are read.
+    struct PostTimeEvent {
+        int32_t layerId;
+        uint64_t frameNumber;
+        std::string layerName;
+        uid_t uid;
+        nsecs_t postTime;
+        GameMode gameMode;
+    };
+
+    // Sets one of the timestamps of the frame that is waiting for data.
+    struct FrameTimeEvent {
+        int32_t layerId;
+        uint64_t frameNumber;
+        nsecs_t FrameTime::*field;
+        nsecs_t time;
+    };
+
+    struct AcquireFenceEvent {
+        int32_t layerId;
+        uint64_t frameNumber;
+        std::shared_ptr<FenceTime> acquireFence;
+    };
+
+    struct PresentEvent {
+        int32_t layerId;
+        uint64_t frameNumber;
+        std::variant<nsecs_t, std::shared_ptr<FenceTime>> present;
+        Fps displayRefreshRate;
+        std::optional<Fps> renderRate;
+        SetFrameRateVote frameRateVote;
+        GameMode gameMode;
+    };
+
+    struct LatchSkippedEvent {
+        int32_t layerId;
+        LatchSkipReason reason;
+    };
+
+    struct BadDesiredPresentEvent {
+        int32_t layerId;
+    };
+
+    struct RemoveTimeRecordEvent {
+        int32_t layerId;
+        uint64_t frameNumber;
+    };
+
+    struct DestroyEvent {
+        int32_t layerId;
+    };
+
+    using LayerEvent =
+            std::variant<PostTimeEvent, FrameTimeEvent, AcquireFenceEvent, PresentEvent,
+                         LatchSkippedEvent, BadDesiredPresentEvent, RemoveTimeRecordEvent,
+                         DestroyEvent, JankyFramesInfo>;
+
 public:
     TimeStats();
     // For testing only for injecting custom dependencies.
     TimeStats(std::optional<size_t> maxPulledLayers,
               std::optional<size_t> maxPulledHistogramBuckets);
+    ~TimeStats() override;
 
     bool onPullAtom(const int atomId, std::vector<uint8_t>* pulledData) override;
     void parseArgs(bool asProto, const Vector<String16>& args, std::string& result) override;
@@ -293,6 +356,21 @@ public:
     static const size_t MAX_NUM_TIME_RECORDS = 64;
 
 private:
+    void pushLayerEvent(LayerEvent&&);
+    void drainLayerEventsLocked();
+    void applyLayerEventLocked(const PostTimeEvent&);
+    void applyLayerEventLocked(const FrameTimeEvent&);
+    void applyLayerEventLocked(const AcquireFenceEvent&);
+    void applyLayerEventLocked(const PresentEvent&);
+    void applyLayerEventLocked(const LatchSkippedEvent&);
+    void applyLayerEventLocked(const BadDesiredPresentEvent&);
+    void applyLayerEventLocked(const RemoveTimeRecordEvent&);
+    void applyLayerEventLocked(const DestroyEvent&);
+    void applyLayerEventLocked(const JankyFramesInfo&);
+    // Returns the record of the frame that is waiting for data, if it matches frameNumber.
+    TimeRecord* getWaitingTimeRecordLocked(int32_t layerId, uint64_t frameNumber);
+    void drainThreadMain();
+
     bool populateGlobalAtom(std::vector<uint8_t>* pulledData);
     bool populateLayerAtom(std::vector<uint8_t>* pulledData);
     bool recordReadyLocked(int32_t layerId, TimeRecord* timeRecord);
@@ -311,7 +389,16 @@ private:
     void dump(bool asProto, std::optional<uint32_t> maxLayers, std::string& result);
 
     std::atomic<bool> mEnabled = false;
+    // Events are appended to mPendingLayerEvents under mLayerEventsMutex, which is only held for
+    // the append, and swapped into mDrainingLayerEvents to be applied under mMutex. Both vectors
+    // keep their capacity, so queueing an event does not allocate once they have grown.
+    std::mutex mLayerEventsMutex;
+    std::vector<LayerEvent> mPendingLayerEvents;   // GUARDED_BY(mLayerEventsMutex)
+    std::condition_variable mDrainCondition;       // Waited on with mLayerEventsMutex.
+    bool mDrainThreadDone = false;                 // GUARDED_BY(mLayerEventsMutex)
     std::mutex mMutex;
+    std::vector<LayerEvent> mDrainingLayerEvents;  // GUARDED_BY(mMutex)
+    std::thread mDrainThread;
     TimeStatsHelper::TimeStatsGlobal mTimeStats;
     // Hashmap for LayerRecord with layerId as the hash key
     std::unordered_map<int32_t, LayerRecord> mTimeStatsTracker;
@@ -319,6 +406,8 @@ private:
     GlobalRecord mGlobalRecord;
 
     static const size_t MAX_NUM_LAYER_RECORDS = 200;
+    // Number of pending events that wakes up mDrainThread.
+    static const size_t LAYER_EVENTS_DRAIN_BATCH_SIZE = 256;
 
     static const size_t REFRESH_RATE_BUCKET_WIDTH = 30;
     static const size_t RENDER_RATE_BUCKET_WIDTH = REFRESH_RATE_BUCKET_WIDTH;
@@ -32,7 +32,8 @@
 namespace android {
 
 LayerTracing::LayerTracing()
-      : mBuffer(std::make_unique<RingBuffer<LayersTraceFileProto, LayersTraceProto>>()) {}
+      : mBuffer(std::make_unique<RingBuffer<LayersTraceFileProto, LayersTraceProto,
+                                            ProtoEntryCodec<LayersTraceProto>>>()) {}
 
 LayerTracing::~LayerTracing() = default;
 
@@ -42,6 +43,7 @@ bool LayerTracing::enable() {
         return false;
     }
     mBuffer->setSize(mBufferSizeInBytes);
+    resetDeltaLocked();
     mEnabled = true;
     return true;
 }
@@ -57,6 +59,7 @@ bool LayerTracing::disable(std::string filename, bool writeToFile) {
         mBuffer->writeToFile(fileProto, filename);
     }
     mBuffer->reset();
+    resetDeltaLocked();
     return true;
 }
 
@@ -65,6 +68,7 @@ void LayerTracing::appendToStream(std::ofstream& out) {
     LayersTraceFileProto fileProto = createTraceFileProto();
     mBuffer->appendToStream(fileProto, out);
     mBuffer->reset();
+    resetDeltaLocked();
 }
 
 bool LayerTracing::isEnabled() const {
@@ -141,7 +145,101 @@ void LayerTracing::notify(bool visibleRegionDirty, int64_t time, int64_t vsyncId
     }
     entry.mutable_displays()->Swap(displays);
     entry.set_vsync_id(vsyncId);
+
+    if (flagIsSet(LayerTracing::TRACE_DELTA)) {
+        encodeDeltaLocked(entry);
+    } else {
+        resetDeltaLocked();
+    }
     mBuffer->emplace(std::move(entry));
 }
 
+void LayerTracing::encodeDeltaLocked(LayersTraceProto& entry) {
+    const bool isKeyframe = mEntriesUntilKeyframe == 0;
+    auto& layers = *entry.mutable_layers()->mutable_layers();
+
+    std::unordered_map<int32_t, std::string> serializedLayers;
+    serializedLayers.reserve(static_cast<size_t>(layers.size()));
+    google::protobuf::RepeatedPtrField<LayerProto> changedLayers;
+    for (LayerProto& layer : layers) {
+        const int32_t id = layer.id();
+        std::string serializedLayer;
+        layer.SerializeToString(&serializedLayer);
+
+        if (!isKeyframe) {
+            entry.add_delta_layer_ids(id);
+            const auto it = mPreviousLayers.find(id);
+            if (it == mPreviousLayers.end() || it->second != serializedLayer) {
+                *changedLayers.Add() = std::move(layer);
+            }
+        }
+        serializedLayers.emplace(id, std::move(serializedLayer));
+    }
+    mPreviousLayers = std::move(serializedLayers);
+
+    if (isKeyframe) {
+        mEntriesUntilKeyframe = DELTA_KEYFRAME_INTERVAL;
+        return;
+    }
+
+    mEntriesUntilKeyframe--;
+    entry.set_is_delta(true);
+    layers.Swap(&changedLayers);
+}
+
+void LayerTracing::resetDeltaLocked() {
+    mPreviousLayers.clear();
+    mEntriesUntilKeyframe = 0;
+}
+
+void LayerTracing::expandDeltaEntries(LayersTraceFileProto& fileProto) {
+    google::protobuf::RepeatedPtrField<LayersTraceProto> entries;
+    entries.Reserve(fileProto.entry_size());
+
+    std::unordered_map<int32_t, LayerProto> layers;
+    bool hasKeyframe = false;
+    for (LayersTraceProto& entry : *fileProto.mutable_entry()) {
+        if (!entry.is_delta()) {
+            layers.clear();
+            for (const LayerProto& layer : entry.layers().layers()) {
+                layers[layer.id()] = layer;
+            }
+            hasKeyframe = true;
+            *entries.Add() = std::move(entry);
+            continue;
+        }
+
+        if (!hasKeyframe) {
+            continue;
+        }
+
+        for (LayerProto& layer : *entry.mutable_layers()->mutable_layers()) {
+            const int32_t id = layer.id();
+            layers[id] = std::move(layer);
+        }
+
+        // Layers that are not part of the delta were removed since the previous entry.
+        std::unordered_map<int32_t, LayerProto> currentLayers;
+        currentLayers.reserve(static_cast<size_t>(entry.delta_layer_ids_size()));
+        LayersProto fullLayers;
+        for (const int32_t id : entry.delta_layer_ids()) {
+            const auto it = layers.find(id);
+            if (it == layers.end()) {
+                ALOGW("Could not find layer id %d in delta entry", id);
+                continue;
+            }
+            *fullLayers.add_layers() = it->second;
+            currentLayers.emplace(id, std::move(it->second));
+        }
+        layers = std::move(currentLayers);
+
+        entry.clear_is_delta();
+        entry.clear_delta_layer_ids();
+        entry.mutable_layers()->Swap(&fullLayers);
+        *entries.Add() = std::move(entry);
+    }
+
+    fileProto.mutable_entry()->Swap(&entries);
+}
+
 } // namespace android
@@ -24,12 +24,17 @@
 
 #include <memory>
 #include <mutex>
+#include <string>
+#include <unordered_map>
 
 using namespace android::surfaceflinger;
 
 namespace android {
 
-template <typename FileProto, typename EntryProto>
+template <typename EntryProto>
+struct ProtoEntryCodec;
+
+template <typename FileProto, typename EntryProto, typename Codec>
 class RingBuffer;
 
 class SurfaceFlinger;
@@ -58,6 +63,9 @@ public:
         TRACE_HWC = 1 << 4,
         TRACE_BUFFERS = 1 << 5,
         TRACE_VIRTUAL_DISPLAYS = 1 << 6,
+        // Only record the layers that changed since the previous entry, with a full keyframe
+        // every DELTA_KEYFRAME_INTERVAL entries. See expandDeltaEntries.
+        TRACE_DELTA = 1 << 7,
         TRACE_ALL = TRACE_INPUT | TRACE_COMPOSITION | TRACE_EXTRA,
     };
     void setTraceFlags(uint32_t flags);
@@ -66,14 +74,30 @@ public:
     void setBufferSize(size_t bufferSizeInBytes);
     void dump(std::string&) const;
 
+    // Rebuilds full entries from a trace recorded with TRACE_DELTA. Delta entries that precede
+    // the first keyframe in the trace cannot be rebuilt, e.g. if the keyframe was dropped from the
+    // ring buffer, and are removed.
+    static void expandDeltaEntries(LayersTraceFileProto&);
+
 private:
     static constexpr auto FILE_NAME = "/data/misc/wmtrace/layers_trace.winscope";
+    static constexpr size_t DELTA_KEYFRAME_INTERVAL = 64;
+
+    void encodeDeltaLocked(LayersTraceProto& entry) REQUIRES(mTraceLock);
+    void resetDeltaLocked() REQUIRES(mTraceLock);
+
     uint32_t mFlags = TRACE_INPUT;
     mutable std::mutex mTraceLock;
     bool mEnabled GUARDED_BY(mTraceLock) = false;
-    std::unique_ptr<RingBuffer<LayersTraceFileProto, LayersTraceProto>> mBuffer
-            GUARDED_BY(mTraceLock);
+    std::unique_ptr<RingBuffer<LayersTraceFileProto, LayersTraceProto,
+                               ProtoEntryCodec<LayersTraceProto>>>
+            mBuffer GUARDED_BY(mTraceLock);
     size_t mBufferSizeInBytes GUARDED_BY(mTraceLock) = 20 * 1024 * 1024;
+
+    // Serialized layers of the previous entry, which delta entries are relative to.
+    std::unordered_map<int32_t, std::string> mPreviousLayers GUARDED_BY(mTraceLock);
+    // The next entry is a keyframe when this reaches 0.
+    size_t mEntriesUntilKeyframe GUARDED_BY(mTraceLock) = 0;
 };
 
 } // namespace android
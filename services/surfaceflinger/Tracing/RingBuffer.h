@@ -31,7 +31,29 @@ namespace android {
 
 class SurfaceFlinger;
 
-template <typename FileProto, typename EntryProto>
+// Stores each entry as its serialized proto.
+template <typename EntryProto>
+struct ProtoEntryCodec {
+    static std::string encode(const EntryProto& proto) {
+        std::string serializedProto;
+        proto.SerializeToString(&serializedProto);
+        return serializedProto;
+    }
+
+    static bool decode(const std::string& entry, EntryProto* outProto) {
+        return outProto->ParseFromString(entry);
+    }
+
+    static nsecs_t elapsedRealtimeNanos(const std::string& entry) {
+        EntryProto proto;
+        proto.ParseFromString(entry);
+        return proto.elapsed_realtime_nanos();
+    }
+};
+
+// The codec defines how entries are stored, and how they are converted back to EntryProto
+// when the buffer is written out.
+template <typename FileProto, typename EntryProto, typename Codec = ProtoEntryCodec<EntryProto>>
 class RingBuffer {
 public:
     size_t size() const { return mSizeInBytes; }
@@ -51,8 +73,7 @@ public:
         fileProto.mutable_entry()->Reserve(static_cast<int>(mStorage.size()) +
                                            fileProto.entry().size());
         for (const std::string& entry : mStorage) {
-            EntryProto* entryProto = fileProto.add_entry();
-            entryProto->ParseFromString(entry);
+            Codec::decode(entry, fileProto.add_entry());
         }
     }
 
@@ -103,19 +124,14 @@ public:
         return replacedEntries;
     }
 
-    std::vector<std::string> emplace(EntryProto&& proto) {
-        std::string serializedProto;
-        proto.SerializeToString(&serializedProto);
-        return emplace(std::move(serializedProto));
-    }
+    std::vector<std::string> emplace(EntryProto&& proto) { return emplace(Codec::encode(proto)); }
 
     void dump(std::string& result) const {
         std::chrono::milliseconds duration(0);
         if (frameCount() > 0) {
-            EntryProto entry;
-            entry.ParseFromString(mStorage.front());
             duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    std::chrono::nanoseconds(systemTime() - entry.elapsed_realtime_nanos()));
+                    std::chrono::nanoseconds(systemTime() -
+                                             Codec::elapsedRealtimeNanos(mStorage.front())));
         }
         const int64_t durationCount = duration.count();
         base::StringAppendF(&result,
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+
+#include "TransactionTraceRecord.h"
+
+namespace android::surfaceflinger {
+
+namespace {
+
+template <typename T>
+void append(std::string& out, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename Proto>
+void appendProto(std::string& out, const Proto& proto) {
+    append(out, static_cast<uint32_t>(proto.ByteSizeLong()));
+    proto.AppendToString(&out);
+}
+
+class Reader {
+public:
+    explicit Reader(const std::string& record) : mData(record.data()), mRemaining(record.size()) {}
+
+    template <typename T>
+    bool read(T* outValue) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (mRemaining < sizeof(T)) return false;
+        std::memcpy(outValue, mData, sizeof(T));
+        skip(sizeof(T));
+        return true;
+    }
+
+    template <typename Proto>
+    bool readProto(Proto* outProto) {
+        uint32_t size;
+        if (!read(&size) || mRemaining < size) return false;
+        const bool parsed = outProto->ParseFromArray(mData, static_cast<int>(size));
+        skip(size);
+        return parsed;
+    }
+
+private:
+    void skip(size_t size) {
+        mData += size;
+        mRemaining -= size;
+    }
+
+    const char* mData;
+    size_t mRemaining;
+};
+
+} // namespace
+
+TransactionTraceRecord::Writer::Writer(int64_t elapsedRealtimeNanos, int64_t vsyncId,
+                                       bool displaysChanged)
+      : mHeader{.elapsedRealtimeNanos = elapsedRealtimeNanos,
+                .vsyncId = vsyncId,
+                .transactionCount = 0,
+                .addedLayerCount = 0,
+                .destroyedLayerCount = 0,
+                .destroyedLayerHandleCount = 0,
+                .displayCount = 0,
+                .displaysChanged = displaysChanged} {}
+
+void TransactionTraceRecord::Writer::addTransaction(const proto::TransactionState& transaction) {
+    appendProto(mTransactions, transaction);
+    mHeader.transactionCount++;
+}
+
+void TransactionTraceRecord::Writer::addLayer(const proto::LayerCreationArgs& args) {
+    appendProto(mLayers, args);
+    mHeader.addedLayerCount++;
+}
+
+void TransactionTraceRecord::Writer::addDisplay(const proto::DisplayInfo& display) {
+    appendProto(mDisplays, display);
+    mHeader.displayCount++;
+}
+
+std::string TransactionTraceRecord::Writer::finish() {
+    mHeader.destroyedLayerCount = static_cast<uint32_t>(mDestroyedLayers.size());
+    mHeader.destroyedLayerHandleCount = static_cast<uint32_t>(mDestroyedLayerHandles.size());
+
+    std::string record;
+    record.reserve(sizeof(Header) +
+                   (mDestroyedLayers.size() + mDestroyedLayerHandles.size()) * sizeof(uint32_t) +
+                   mTransactions.size() + mLayers.size() + mDisplays.size());
+    append(record, mHeader);
+    record.append(reinterpret_cast<const char*>(mDestroyedLayers.data()),
+                  mDestroyedLayers.size() * sizeof(uint32_t));
+    record.append(reinterpret_cast<const char*>(mDestroyedLayerHandles.data()),
+                  mDestroyedLayerHandles.size() * sizeof(uint32_t));
+    record.append(mTransactions);
+    record.append(mLayers);
+    record.append(mDisplays);
+    return record;
+}
+
+std::optional<TransactionTraceRecord::Header> TransactionTraceRecord::readHeader(
+        const std::string& record) {
+    Header header;
+    if (!Reader(record).read(&header)) {
+        return std::nullopt;
+    }
+    return header;
+}
+
+bool TransactionTraceRecord::decode(const std::string& record,
+                                    proto::TransactionTraceEntry* outEntry) {
+    Reader reader(record);
+    Header header;
+    if (!reader.read(&header)) {
+        return false;
+    }
+
+    outEntry->set_elapsed_realtime_nanos(header.elapsedRealtimeNanos);
+    outEntry->set_vsync_id(header.vsyncId);
+    outEntry->set_displays_changed(header.displaysChanged != 0);
+
+    outEntry->mutable_destroyed_layers()->Reserve(static_cast<int32_t>(header.destroyedLayerCount));
+    for (uint32_t i = 0; i < header.destroyedLayerCount; i++) {
+        uint32_t layerId;
+        if (!reader.read(&layerId)) return false;
+        outEntry->add_destroyed_layers(layerId);
+    }
+
+    outEntry->mutable_destroyed_layer_handles()->Reserve(
+            static_cast<int32_t>(header.destroyedLayerHandleCount));
+    for (uint32_t i = 0; i < header.destroyedLayerHandleCount; i++) {
+        uint32_t layerId;
+        if (!reader.read(&layerId)) return false;
+        outEntry->add_destroyed_layer_handles(layerId);
+    }
+
+    outEntry->mutable_transactions()->Reserve(static_cast<int32_t>(header.transactionCount));
+    for (uint32_t i = 0; i < header.transactionCount; i++) {
+        if (!reader.readProto(outEntry->add_transactions())) return false;
+    }
+
+    outEntry->mutable_added_layers()->Reserve(static_cast<int32_t>(header.addedLayerCount));
+    for (uint32_t i = 0; i < header.addedLayerCount; i++) {
+        if (!reader.readProto(outEntry->add_added_layers())) return false;
+    }
+
+    outEntry->mutable_displays()->Reserve(static_cast<int32_t>(header.displayCount));
+    for (uint32_t i = 0; i < header.displayCount; i++) {
+        if (!reader.readProto(outEntry->add_displays())) return false;
+    }
+
+    return true;
+}
+
+} // namespace android::surfaceflinger
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <layerproto/TransactionProto.h>
+#include <utils/Timers.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace android::surfaceflinger {
+
+/*
+ * Fixed-layout binary encoding of a TransactionTraceEntry, as stored in the transaction trace
+ * ring buffer.
+ *
+ * A record starts with a fixed header followed by the destroyed layer ids and handles as packed
+ * uint32 arrays, so the entry-level fields can be read without parsing. Transactions, added
+ * layers and displays follow as length-prefixed serialized protos, which are appended straight
+ * into the record. The TransactionTraceEntry proto is only built when the trace is written out,
+ * or when a record is evicted and folded into the starting state.
+ */
+class TransactionTraceRecord {
+public:
+    struct Header {
+        int64_t elapsedRealtimeNanos;
+        int64_t vsyncId;
+        uint32_t transactionCount;
+        uint32_t addedLayerCount;
+        uint32_t destroyedLayerCount;
+        uint32_t destroyedLayerHandleCount;
+        uint32_t displayCount;
+        uint32_t displaysChanged;
+    };
+    static_assert(std::is_trivially_copyable_v<Header>);
+
+    class Writer {
+    public:
+        Writer(int64_t elapsedRealtimeNanos, int64_t vsyncId, bool displaysChanged);
+
+        void addTransaction(const proto::TransactionState&);
+        void addLayer(const proto::LayerCreationArgs&);
+        void addDestroyedLayer(uint32_t layerId) { mDestroyedLayers.push_back(layerId); }
+        void addDestroyedLayerHandle(uint32_t layerId) {
+            mDestroyedLayerHandles.push_back(layerId);
+        }
+        void addDisplay(const proto::DisplayInfo&);
+
+        // Returns the encoded record. The writer must not be used afterwards.
+        std::string finish();
+
+    private:
+        Header mHeader;
+        std::vector<uint32_t> mDestroyedLayers;
+        std::vector<uint32_t> mDestroyedLayerHandles;
+        std::string mTransactions;
+        std::string mLayers;
+        std::string mDisplays;
+    };
+
+    // Returns the header of an encoded record, or nullopt if the record is truncated.
+    static std::optional<Header> readHeader(const std::string& record);
+
+    // Decodes a record into an entry proto. Returns false if the record is malformed.
+    static bool decode(const std::string& record, proto::TransactionTraceEntry* outEntry);
+
+    // RingBuffer codec interface.
+    static nsecs_t elapsedRealtimeNanos(const std::string& record) {
+        const auto header = readHeader(record);
+        return header ? header->elapsedRealtimeNanos : 0;
+    }
+};
+
+} // namespace android::surfaceflinger
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "TransactionTracing"
+
+#include <log/log.h>
+
+#include "TransactionTraceStartingState.h"
+
+namespace android::surfaceflinger {
+
+void TransactionTraceStartingState::update(const proto::TransactionTraceEntry& entry) {
+    mTimestamp = entry.elapsed_realtime_nanos();
+    // Keep track of layer starting state so we can reconstruct the layer state as we purge
+    // transactions from the buffer.
+    for (const proto::LayerCreationArgs& addedLayer : entry.added_layers()) {
+        TracingLayerState& startingState = mStates[addedLayer.layer_id()];
+        startingState.layerId = addedLayer.layer_id();
+        mParser.fromProto(addedLayer, startingState.args);
+    }
+
+    // Merge layer states to starting transaction state.
+    for (const proto::TransactionState& transaction : entry.transactions()) {
+        for (const proto::LayerState& layerState : transaction.layer_changes()) {
+            auto it = mStates.find(layerState.layer_id());
+            if (it == mStates.end()) {
+                // TODO(b/238781169) make this log fatal when we switch over to using new fe
+                ALOGW("Could not find layer id %d", layerState.layer_id());
+                continue;
+            }
+            mParser.mergeFromProto(layerState, it->second);
+        }
+    }
+
+    for (const uint32_t destroyedLayerHandleId : entry.destroyed_layer_handles()) {
+        mRemovedLayerHandles.insert(destroyedLayerHandleId);
+    }
+
+    // Clean up stale starting states since the layer has been removed and the buffer does not
+    // contain any references to the layer.
+    for (const uint32_t destroyedLayerId : entry.destroyed_layers()) {
+        mStates.erase(destroyedLayerId);
+        mRemovedLayerHandles.erase(destroyedLayerId);
+    }
+
+    if (entry.displays_changed()) {
+        mParser.fromProto(entry.displays(), mDisplayInfos);
+    }
+}
+
+std::optional<proto::TransactionTraceEntry> TransactionTraceStartingState::toProto() {
+    if (mStates.size() == 0) {
+        return std::nullopt;
+    }
+
+    proto::TransactionTraceEntry entryProto;
+    entryProto.set_elapsed_realtime_nanos(mTimestamp);
+    entryProto.set_vsync_id(0);
+
+    entryProto.mutable_added_layers()->Reserve(static_cast<int32_t>(mStates.size()));
+    for (auto& [layerId, state] : mStates) {
+        entryProto.mutable_added_layers()->Add(mParser.toProto(state.args));
+    }
+
+    proto::TransactionState transactionProto = mParser.toProto(mStates);
+    transactionProto.set_vsync_id(0);
+    transactionProto.set_post_time(mTimestamp);
+    entryProto.mutable_transactions()->Add(std::move(transactionProto));
+
+    entryProto.mutable_destroyed_layer_handles()->Reserve(
+            static_cast<int32_t>(mRemovedLayerHandles.size()));
+    for (const uint32_t destroyedLayerHandleId : mRemovedLayerHandles) {
+        entryProto.mutable_destroyed_layer_handles()->Add(destroyedLayerHandleId);
+    }
+
+    entryProto.set_displays_changed(!mDisplayInfos.empty());
+    entryProto.mutable_displays()->Reserve(static_cast<int32_t>(mDisplayInfos.size()));
+    for (auto& [layerStack, displayInfo] : mDisplayInfos) {
+        entryProto.mutable_displays()->Add(mParser.toProto(displayInfo, layerStack.id));
+    }
+    return entryProto;
+}
+
+} // namespace android::surfaceflinger
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <layerproto/TransactionProto.h>
+#include <utils/Timers.h>
+
+#include <map>
+#include <optional>
+#include <set>
+
+#include "FrontEnd/DisplayInfo.h"
+#include "TransactionProtoParser.h"
+
+namespace android::surfaceflinger {
+
+/*
+ * Accumulates the layer and display state of transaction trace entries, so that the entries can
+ * be dropped from a trace and replaced by a single entry that recreates their state.
+ *
+ * TransactionTracing uses this for entries evicted from its ring buffer. The layer trace
+ * generator uses it to create checkpoints from which parts of a trace can be replayed.
+ */
+class TransactionTraceStartingState {
+public:
+    TransactionTraceStartingState(TransactionProtoParser& parser, nsecs_t timestamp)
+          : mParser(parser), mTimestamp(timestamp) {}
+
+    // Folds an entry into the starting state.
+    void update(const proto::TransactionTraceEntry&);
+
+    // Returns an entry that recreates the starting state, or nullopt if there are no layers.
+    std::optional<proto::TransactionTraceEntry> toProto();
+
+    size_t size() const { return mStates.size(); }
+
+private:
+    TransactionProtoParser& mParser;
+    nsecs_t mTimestamp;
+    std::map<uint32_t /* layerId */, TracingLayerState> mStates;
+    frontend::DisplayInfos mDisplayInfos;
+    std::set<uint32_t /* layerId */> mRemovedLayerHandles;
+};
+
+} // namespace android::surfaceflinger
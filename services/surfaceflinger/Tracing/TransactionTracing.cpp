@@ -31,11 +31,11 @@ namespace android {
 ANDROID_SINGLETON_STATIC_INSTANCE(android::TransactionTraceWriter)
 
 TransactionTracing::TransactionTracing()
-      : mProtoParser(std::make_unique<TransactionProtoParser::FlingerDataMapper>()) {
+      : mProtoParser(std::make_unique<TransactionProtoParser::FlingerDataMapper>()),
+        mStartingState(mProtoParser, systemTime()) {
     std::scoped_lock lock(mTraceLock);
 
     mBuffer.setSize(mBufferSizeInBytes);
-    mStartingTimestamp = systemTime();
     {
         std::scoped_lock lock(mMainThreadLock);
         mThread = std::thread(&TransactionTracing::loop, this);
@@ -84,13 +84,12 @@ proto::TransactionTraceFile TransactionTracing::createTraceFileProto() const {
 void TransactionTracing::dump(std::string& result) const {
     std::scoped_lock lock(mTraceLock);
     base::StringAppendF(&result, "  queued transactions=%zu created layers=%zu states=%zu\n",
-                        mQueuedTransactions.size(), mCreatedLayers.size(), mStartingStates.size());
+                        mQueuedTransactions.size(), mCreatedLayers.size(), mStartingState.size());
     mBuffer.dump(result);
 }
 
 void TransactionTracing::addQueuedTransaction(const TransactionState& transaction) {
-    proto::TransactionState* state = new proto::TransactionState(mProtoParser.toProto(transaction));
-    mTransactionQueue.push(state);
+    mTransactionQueue.push(mProtoParser.toProto(transaction));
 }
 
 void TransactionTracing::addCommittedTransactions(int64_t vsyncId, nsecs_t commitTime,
@@ -152,60 +151,42 @@ void TransactionTracing::addEntry(const std::vector<CommittedUpdates>& committed
     ATRACE_CALL();
     std::scoped_lock lock(mTraceLock);
     std::vector<std::string> removedEntries;
-    proto::TransactionTraceEntry entryProto;
 
     while (auto incomingTransaction = mTransactionQueue.pop()) {
-        auto transaction = *incomingTransaction;
-        mQueuedTransactions[incomingTransaction->transaction_id()] = transaction;
-        delete incomingTransaction;
+        const uint64_t transactionId = incomingTransaction->transaction_id();
+        mQueuedTransactions[transactionId] = std::move(*incomingTransaction);
     }
     for (const CommittedUpdates& update : committedUpdates) {
-        entryProto.set_elapsed_realtime_nanos(update.timestamp);
-        entryProto.set_vsync_id(update.vsyncId);
-        entryProto.mutable_added_layers()->Reserve(
-                static_cast<int32_t>(update.createdLayers.size()));
-
+        TransactionTraceRecord::Writer record(update.timestamp, update.vsyncId,
+                                              update.displayInfoChanged);
         for (const auto& args : update.createdLayers) {
-            entryProto.mutable_added_layers()->Add(std::move(mProtoParser.toProto(args)));
+            record.addLayer(mProtoParser.toProto(args));
         }
 
-        entryProto.mutable_destroyed_layers()->Reserve(
-                static_cast<int32_t>(destroyedLayers.size()));
         for (auto& destroyedLayer : destroyedLayers) {
-            entryProto.mutable_destroyed_layers()->Add(destroyedLayer);
+            record.addDestroyedLayer(destroyedLayer);
         }
-        entryProto.mutable_transactions()->Reserve(
-                static_cast<int32_t>(update.transactionIds.size()));
         for (const uint64_t& id : update.transactionIds) {
             auto it = mQueuedTransactions.find(id);
             if (it != mQueuedTransactions.end()) {
-                entryProto.mutable_transactions()->Add(std::move(it->second));
+                record.addTransaction(it->second);
                 mQueuedTransactions.erase(it);
             } else {
                 ALOGW("Could not find transaction id %" PRIu64, id);
             }
         }
 
-        entryProto.mutable_destroyed_layer_handles()->Reserve(
-                static_cast<int32_t>(update.destroyedLayerHandles.size()));
         for (auto layerId : update.destroyedLayerHandles) {
-            entryProto.mutable_destroyed_layer_handles()->Add(layerId);
+            record.addDestroyedLayerHandle(layerId);
         }
 
-        entryProto.set_displays_changed(update.displayInfoChanged);
         if (update.displayInfoChanged) {
-            entryProto.mutable_displays()->Reserve(
-                    static_cast<int32_t>(update.displayInfos.size()));
             for (auto& [layerStack, displayInfo] : update.displayInfos) {
-                entryProto.mutable_displays()->Add(
-                        std::move(mProtoParser.toProto(displayInfo, layerStack.id)));
+                record.addDisplay(mProtoParser.toProto(displayInfo, layerStack.id));
             }
         }
 
-        std::string serializedProto;
-        entryProto.SerializeToString(&serializedProto);
-        entryProto.Clear();
-        std::vector<std::string> entries = mBuffer.emplace(std::move(serializedProto));
+        std::vector<std::string> entries = mBuffer.emplace(record.finish());
         removedEntries.reserve(removedEntries.size() + entries.size());
         removedEntries.insert(removedEntries.end(), std::make_move_iterator(entries.begin()),
                               std::make_move_iterator(entries.end()));
@@ -213,8 +194,8 @@ void TransactionTracing::addEntry(const std::vector<CommittedUpdates>& committed
 
     proto::TransactionTraceEntry removedEntryProto;
     for (const std::string& removedEntry : removedEntries) {
-        removedEntryProto.ParseFromString(removedEntry);
-        updateStartingStateLocked(removedEntryProto);
+        TransactionTraceRecord::decode(removedEntry, &removedEntryProto);
+        mStartingState.update(removedEntryProto);
         removedEntryProto.Clear();
     }
     mTransactionsAddedToBufferCv.notify_one();
@@ -236,12 +217,14 @@ void TransactionTracing::flush() {
     base::ScopedLockAssertion assumeLocked(mTraceLock);
     mTransactionsAddedToBufferCv.wait_for(lock, std::chrono::milliseconds(100),
                                           [&]() REQUIRES(mTraceLock) {
-                                              proto::TransactionTraceEntry entry;
-                                              if (mBuffer.used() > 0) {
-                                                  entry.ParseFromString(mBuffer.back());
+                                              if (mBuffer.used() == 0) {
+                                                  return false;
                                               }
-                                              return mBuffer.used() > 0 &&
-                                                      entry.vsync_id() >= mLastUpdatedVsyncId;
+                                              const auto header =
+                                                      TransactionTraceRecord::readHeader(
+                                                              mBuffer.back());
+                                              return header &&
+                                                      header->vsyncId >= mLastUpdatedVsyncId;
                                           });
 }
 
@@ -267,74 +250,9 @@ void TransactionTracing::tryPushToTracingThread() {
     }
 }
 
-void TransactionTracing::updateStartingStateLocked(
-        const proto::TransactionTraceEntry& removedEntry) {
-    mStartingTimestamp = removedEntry.elapsed_realtime_nanos();
-    // Keep track of layer starting state so we can reconstruct the layer state as we purge
-    // transactions from the buffer.
-    for (const proto::LayerCreationArgs& addedLayer : removedEntry.added_layers()) {
-        TracingLayerState& startingState = mStartingStates[addedLayer.layer_id()];
-        startingState.layerId = addedLayer.layer_id();
-        mProtoParser.fromProto(addedLayer, startingState.args);
-    }
-
-    // Merge layer states to starting transaction state.
-    for (const proto::TransactionState& transaction : removedEntry.transactions()) {
-        for (const proto::LayerState& layerState : transaction.layer_changes()) {
-            auto it = mStartingStates.find(layerState.layer_id());
-            if (it == mStartingStates.end()) {
-                // TODO(b/238781169) make this log fatal when we switch over to using new fe
-                ALOGW("Could not find layer id %d", layerState.layer_id());
-                continue;
-            }
-            mProtoParser.mergeFromProto(layerState, it->second);
-        }
-    }
-
-    for (const uint32_t destroyedLayerHandleId : removedEntry.destroyed_layer_handles()) {
-        mRemovedLayerHandlesAtStart.insert(destroyedLayerHandleId);
-    }
-
-    // Clean up stale starting states since the layer has been removed and the buffer does not
-    // contain any references to the layer.
-    for (const uint32_t destroyedLayerId : removedEntry.destroyed_layers()) {
-        mStartingStates.erase(destroyedLayerId);
-        mRemovedLayerHandlesAtStart.erase(destroyedLayerId);
-    }
-
-    if (removedEntry.displays_changed()) {
-        mProtoParser.fromProto(removedEntry.displays(), mStartingDisplayInfos);
-    }
-}
-
 void TransactionTracing::addStartingStateToProtoLocked(proto::TransactionTraceFile& proto) {
-    if (mStartingStates.size() == 0) {
-        return;
-    }
-
-    proto::TransactionTraceEntry* entryProto = proto.add_entry();
-    entryProto->set_elapsed_realtime_nanos(mStartingTimestamp);
-    entryProto->set_vsync_id(0);
-
-    entryProto->mutable_added_layers()->Reserve(static_cast<int32_t>(mStartingStates.size()));
-    for (auto& [layerId, state] : mStartingStates) {
-        entryProto->mutable_added_layers()->Add(mProtoParser.toProto(state.args));
-    }
-
-    proto::TransactionState transactionProto = mProtoParser.toProto(mStartingStates);
-    transactionProto.set_vsync_id(0);
-    transactionProto.set_post_time(mStartingTimestamp);
-    entryProto->mutable_transactions()->Add(std::move(transactionProto));
-
-    entryProto->mutable_destroyed_layer_handles()->Reserve(
-            static_cast<int32_t>(mRemovedLayerHandlesAtStart.size()));
-    for (const uint32_t destroyedLayerHandleId : mRemovedLayerHandlesAtStart) {
-        entryProto->mutable_destroyed_layer_handles()->Add(destroyedLayerHandleId);
-    }
-
-    entryProto->mutable_displays()->Reserve(static_cast<int32_t>(mStartingDisplayInfos.size()));
-    for (auto& [layerStack, displayInfo] : mStartingDisplayInfos) {
-        entryProto->mutable_displays()->Add(mProtoParser.toProto(displayInfo, layerStack.id));
+    if (auto entryProto = mStartingState.toProto()) {
+        *proto.add_entry() = std::move(*entryProto);
     }
 }
 
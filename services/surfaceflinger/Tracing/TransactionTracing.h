@@ -17,6 +17,7 @@
 #pragma once
 
 #include <android-base/thread_annotations.h>
+#include <ftl/mpsc_queue.h>
 #include <layerproto/TransactionProto.h>
 #include <utils/Errors.h>
 #include <utils/Singleton.h>
@@ -29,9 +30,10 @@
 #include "FrontEnd/DisplayInfo.h"
 #include "FrontEnd/LayerCreationArgs.h"
 #include "FrontEnd/Update.h"
-#include "LocklessStack.h"
 #include "RingBuffer.h"
 #include "TransactionProtoParser.h"
+#include "TransactionTraceRecord.h"
+#include "TransactionTraceStartingState.h"
 
 using namespace android::surfaceflinger;
 
@@ -47,7 +49,8 @@ class TransactionTracingTest;
  * and stored in a map using the transaction id as key. Main thread will
  * pass the list of transaction ids that are committed every vsync and notify
  * the tracing thread. The tracing thread will then wake up and add the
- * committed transactions to the ring buffer.
+ * committed transactions to the ring buffer. Entries are stored as TransactionTraceRecords and
+ * only converted to TransactionTraceEntry protos when the buffer is written out.
  *
  * When generating SF dump state, we will flush the buffer to a file which
  * will then be included in the bugreport.
@@ -81,19 +84,15 @@ private:
     static constexpr auto FILE_PATH = "/data/misc/wmtrace/transactions_trace.winscope";
 
     mutable std::mutex mTraceLock;
-    RingBuffer<proto::TransactionTraceFile, proto::TransactionTraceEntry> mBuffer
-            GUARDED_BY(mTraceLock);
+    RingBuffer<proto::TransactionTraceFile, proto::TransactionTraceEntry, TransactionTraceRecord>
+            mBuffer GUARDED_BY(mTraceLock);
     size_t mBufferSizeInBytes GUARDED_BY(mTraceLock) = CONTINUOUS_TRACING_BUFFER_SIZE;
     std::unordered_map<uint64_t, proto::TransactionState> mQueuedTransactions
             GUARDED_BY(mTraceLock);
-    LocklessStack<proto::TransactionState> mTransactionQueue;
-    nsecs_t mStartingTimestamp GUARDED_BY(mTraceLock);
+    ftl::MpscQueue<proto::TransactionState> mTransactionQueue;
     std::unordered_map<int, proto::LayerCreationArgs> mCreatedLayers GUARDED_BY(mTraceLock);
-    std::map<uint32_t /* layerId */, TracingLayerState> mStartingStates GUARDED_BY(mTraceLock);
-    frontend::DisplayInfos mStartingDisplayInfos GUARDED_BY(mTraceLock);
-
-    std::set<uint32_t /* layerId */> mRemovedLayerHandlesAtStart GUARDED_BY(mTraceLock);
     TransactionProtoParser mProtoParser;
+    TransactionTraceStartingState mStartingState GUARDED_BY(mTraceLock);
 
     // We do not want main thread to block so main thread will try to acquire mMainThreadLock,
     // otherwise will push data to temporary container.
@@ -125,7 +124,6 @@ private:
     int32_t getLayerIdLocked(const sp<IBinder>& layerHandle) REQUIRES(mTraceLock);
     void tryPushToTracingThread() EXCLUDES(mMainThreadLock);
     void addStartingStateToProtoLocked(proto::TransactionTraceFile& proto) REQUIRES(mTraceLock);
-    void updateStartingStateLocked(const proto::TransactionTraceEntry& entry) REQUIRES(mTraceLock);
     // TEST
     // Return buffer contents as trace file proto
     proto::TransactionTraceFile writeToProto() EXCLUDES(mMainThreadLock);
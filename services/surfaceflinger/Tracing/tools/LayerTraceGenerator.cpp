@@ -23,15 +23,23 @@
 #include <log/log.h>
 #include <renderengine/ExternalTexture.h>
 #include <utils/String16.h>
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <ios>
+#include <numeric>
+#include <optional>
+#include <ostream>
 #include <string>
+#include <thread>
 #include <vector>
 #include "FrontEnd/LayerCreationArgs.h"
 #include "FrontEnd/RequestedLayerState.h"
 #include "LayerProtoHelper.h"
 #include "Tracing/LayerTracing.h"
+#include "Tracing/TransactionTraceStartingState.h"
 #include "TransactionState.h"
 #include "cutils/properties.h"
 
@@ -40,13 +48,175 @@
 namespace android {
 using namespace ftl::flag_operators;
 
+namespace {
+
+// The front end inputs recorded in a single transaction trace entry.
+struct FrontEndUpdate {
+    std::vector<std::unique_ptr<frontend::RequestedLayerState>> addedLayers;
+    std::vector<TransactionState> transactions;
+    std::vector<uint32_t> destroyedHandles;
+};
+
+FrontEndUpdate parseEntry(TransactionProtoParser& parser,
+                          const proto::TransactionTraceEntry& entry) {
+    FrontEndUpdate update;
+    update.addedLayers.reserve((size_t)entry.added_layers_size());
+    for (int j = 0; j < entry.added_layers_size(); j++) {
+        LayerCreationArgs args;
+        parser.fromProto(entry.added_layers(j), args);
+        ALOGV("       %s", args.getDebugString().c_str());
+        update.addedLayers.emplace_back(std::make_unique<frontend::RequestedLayerState>(args));
+    }
+
+    update.transactions.reserve((size_t)entry.transactions_size());
+    for (int j = 0; j < entry.transactions_size(); j++) {
+        // apply transactions
+        TransactionState transaction = parser.fromProto(entry.transactions(j));
+        for (auto& resolvedComposerState : transaction.states) {
+            if (resolvedComposerState.state.what & layer_state_t::eInputInfoChanged) {
+                if (!resolvedComposerState.state.windowInfoHandle->getInfo()->inputConfig.test(
+                            gui::WindowInfo::InputConfig::NO_INPUT_CHANNEL)) {
+                    // create a fake token since the FE expects a valid token
+                    resolvedComposerState.state.windowInfoHandle->editInfo()->token =
+                            sp<BBinder>::make();
+                }
+            }
+        }
+        update.transactions.emplace_back(std::move(transaction));
+    }
+
+    for (int j = 0; j < entry.destroyed_layers_size(); j++) {
+        ALOGV("       destroyedHandles=%d", entry.destroyed_layers(j));
+    }
+
+    update.destroyedHandles.reserve((size_t)entry.destroyed_layer_handles_size());
+    for (int j = 0; j < entry.destroyed_layer_handles_size(); j++) {
+        ALOGV("       destroyedHandles=%d", entry.destroyed_layer_handles(j));
+        update.destroyedHandles.push_back(entry.destroyed_layer_handles(j));
+    }
+    return update;
+}
+
+bool supportsBackgroundBlur() {
+    char value[PROPERTY_VALUE_MAX];
+    property_get("ro.surface_flinger.supports_background_blur", value, "0");
+    return atoi(value);
+}
+
+// Durations of one replay stage, one sample per trace entry.
+class StageTimes {
+public:
+    explicit StageTimes(const char* name) : mName(name) {}
+
+    void add(std::chrono::steady_clock::duration duration) { mSamples.push_back(duration); }
+
+    void print(std::ostream& out) {
+        if (mSamples.empty()) {
+            return;
+        }
+        std::sort(mSamples.begin(), mSamples.end());
+        const auto total = std::accumulate(mSamples.begin(), mSamples.end(),
+                                           std::chrono::steady_clock::duration::zero());
+        const auto percentile = [this](size_t p) {
+            return micros(mSamples[(mSamples.size() - 1) * p / 100]);
+        };
+        out << std::left << std::setw(12) << mName << std::right << std::fixed
+            << std::setprecision(1) << std::setw(10) << micros(total) / mSamples.size()
+            << std::setw(10) << percentile(50) << std::setw(10) << percentile(90)
+            << std::setw(10) << percentile(99) << std::setw(10) << micros(mSamples.back())
+            << std::setw(12) << micros(total) << "\n";
+    }
+
+private:
+    static double micros(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+    const char* mName;
+    std::vector<std::chrono::steady_clock::duration> mSamples;
+};
+
+} // namespace
+
 bool LayerTraceGenerator::generate(const proto::TransactionTraceFile& traceFile,
-                                   const char* outputLayersTracePath, bool onlyLastEntry) {
+                                   const char* outputLayersTracePath, bool onlyLastEntry,
+                                   size_t jobs) {
     if (traceFile.entry_size() == 0) {
         ALOGD("Trace file is empty");
         return false;
     }
 
+    const size_t entryCount = static_cast<size_t>(traceFile.entry_size());
+    jobs = std::min(jobs, entryCount / MIN_ENTRIES_PER_SEGMENT);
+    if (onlyLastEntry || jobs <= 1) {
+        return generateSegment(traceFile, 0, traceFile.entry_size(), nullptr,
+                               outputLayersTracePath, onlyLastEntry);
+    }
+
+    // Split the trace into segments of similar size. The state at the start of each segment is
+    // recreated by a checkpoint entry, so the segments can be replayed independently.
+    struct Segment {
+        int begin;
+        int end;
+        std::optional<proto::TransactionTraceEntry> checkpoint;
+        std::string outputPath;
+        bool generated = false;
+    };
+    std::vector<Segment> segments(jobs);
+
+    TransactionProtoParser parser(std::make_unique<TransactionProtoParser::FlingerDataMapper>());
+    TransactionTraceStartingState startingState(parser, 0);
+    for (size_t s = 0; s < jobs; s++) {
+        Segment& segment = segments[s];
+        segment.begin = static_cast<int>(entryCount * s / jobs);
+        segment.end = static_cast<int>(entryCount * (s + 1) / jobs);
+        segment.outputPath = std::string(outputLayersTracePath) + ".segment" + std::to_string(s);
+        if (s > 0) {
+            segment.checkpoint = startingState.toProto();
+        }
+        if (s + 1 < jobs) {
+            for (int i = segment.begin; i < segment.end; i++) {
+                startingState.update(traceFile.entry(i));
+            }
+        }
+    }
+
+    ALOGD("Generating %d transactions in %zu segments...", traceFile.entry_size(), jobs);
+    std::vector<std::thread> threads;
+    threads.reserve(jobs);
+    for (Segment& segment : segments) {
+        threads.emplace_back([this, &traceFile, segment = &segment]() {
+            segment->generated =
+                    generateSegment(traceFile, segment->begin, segment->end,
+                                    segment->checkpoint ? &*segment->checkpoint : nullptr,
+                                    segment->outputPath.c_str(), /*onlyLastEntry=*/false);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // Serialized traces can be concatenated, since repeated entries are merged when parsing.
+    bool generated = true;
+    std::ofstream out(outputLayersTracePath, std::ios::binary | std::ios::trunc);
+    for (const Segment& segment : segments) {
+        if (segment.generated) {
+            std::ifstream in(segment.outputPath, std::ios::binary);
+            out << in.rdbuf();
+        } else {
+            ALOGE("Failed to generate entries %d to %d", segment.begin, segment.end);
+            generated = false;
+        }
+        std::filesystem::remove(segment.outputPath);
+    }
+    out.close();
+    ALOGD("End of generating trace file. File written to %s", outputLayersTracePath);
+    return generated && out.good();
+}
+
+bool LayerTraceGenerator::generateSegment(const proto::TransactionTraceFile& traceFile, int begin,
+                                          int end, const proto::TransactionTraceEntry* checkpoint,
+                                          const char* outputLayersTracePath, bool onlyLastEntry) {
     TransactionProtoParser parser(std::make_unique<TransactionProtoParser::FlingerDataMapper>());
 
     // frontend
@@ -56,9 +226,7 @@ bool LayerTraceGenerator::generate(const proto::TransactionTraceFile& traceFile,
     ui::DisplayMap<ui::LayerStack, frontend::DisplayInfo> displayInfos;
 
     renderengine::ShadowSettings globalShadowSettings{.ambientColor = {1, 1, 1, 1}};
-    char value[PROPERTY_VALUE_MAX];
-    property_get("ro.surface_flinger.supports_background_blur", value, "0");
-    bool supportsBlur = atoi(value);
+    const bool supportsBlur = supportsBackgroundBlur();
 
     LayerTracing layerTracing;
     layerTracing.setTraceFlags(LayerTracing::TRACE_INPUT | LayerTracing::TRACE_BUFFERS);
@@ -68,53 +236,18 @@ bool LayerTraceGenerator::generate(const proto::TransactionTraceFile& traceFile,
     layerTracing.writeToFile(outputLayersTracePath);
     std::ofstream out(outputLayersTracePath, std::ios::binary | std::ios::app);
 
-    ALOGD("Generating %d transactions...", traceFile.entry_size());
-    for (int i = 0; i < traceFile.entry_size(); i++) {
+    // The checkpoint is replayed first, but not written to the layers trace.
+    ALOGD("Generating %d transactions...", end - begin);
+    for (int i = checkpoint ? begin - 1 : begin; i < end; i++) {
         // parse proto
-        proto::TransactionTraceEntry entry = traceFile.entry(i);
+        const proto::TransactionTraceEntry& entry = i < begin ? *checkpoint : traceFile.entry(i);
         ALOGV("    Entry %04d/%04d for time=%" PRId64 " vsyncid=%" PRId64
               " layers +%d -%d handles -%d transactions=%d",
               i, traceFile.entry_size(), entry.elapsed_realtime_nanos(), entry.vsync_id(),
               entry.added_layers_size(), entry.destroyed_layers_size(),
               entry.destroyed_layer_handles_size(), entry.transactions_size());
 
-        std::vector<std::unique_ptr<frontend::RequestedLayerState>> addedLayers;
-        addedLayers.reserve((size_t)entry.added_layers_size());
-        for (int j = 0; j < entry.added_layers_size(); j++) {
-            LayerCreationArgs args;
-            parser.fromProto(entry.added_layers(j), args);
-            ALOGV("       %s", args.getDebugString().c_str());
-            addedLayers.emplace_back(std::make_unique<frontend::RequestedLayerState>(args));
-        }
-
-        std::vector<TransactionState> transactions;
-        transactions.reserve((size_t)entry.transactions_size());
-        for (int j = 0; j < entry.transactions_size(); j++) {
-            // apply transactions
-            TransactionState transaction = parser.fromProto(entry.transactions(j));
-            for (auto& resolvedComposerState : transaction.states) {
-                if (resolvedComposerState.state.what & layer_state_t::eInputInfoChanged) {
-                    if (!resolvedComposerState.state.windowInfoHandle->getInfo()->inputConfig.test(
-                                gui::WindowInfo::InputConfig::NO_INPUT_CHANNEL)) {
-                        // create a fake token since the FE expects a valid token
-                        resolvedComposerState.state.windowInfoHandle->editInfo()->token =
-                                sp<BBinder>::make();
-                    }
-                }
-            }
-            transactions.emplace_back(std::move(transaction));
-        }
-
-        for (int j = 0; j < entry.destroyed_layers_size(); j++) {
-            ALOGV("       destroyedHandles=%d", entry.destroyed_layers(j));
-        }
-
-        std::vector<uint32_t> destroyedHandles;
-        destroyedHandles.reserve((size_t)entry.destroyed_layer_handles_size());
-        for (int j = 0; j < entry.destroyed_layer_handles_size(); j++) {
-            ALOGV("       destroyedHandles=%d", entry.destroyed_layer_handles(j));
-            destroyedHandles.push_back(entry.destroyed_layer_handles(j));
-        }
+        FrontEndUpdate update = parseEntry(parser, entry);
 
         bool displayChanged = entry.displays_changed();
         if (displayChanged) {
@@ -122,9 +255,10 @@ bool LayerTraceGenerator::generate(const proto::TransactionTraceFile& traceFile,
         }
 
         // apply updates
-        lifecycleManager.addLayers(std::move(addedLayers));
-        lifecycleManager.applyTransactions(transactions, /*ignoreUnknownHandles=*/true);
-        lifecycleManager.onHandlesDestroyed(destroyedHandles, /*ignoreUnknownHandles=*/true);
+        lifecycleManager.addLayers(std::move(update.addedLayers));
+        lifecycleManager.applyTransactions(update.transactions, /*ignoreUnknownHandles=*/true);
+        lifecycleManager.onHandlesDestroyed(update.destroyedHandles,
+                                            /*ignoreUnknownHandles=*/true);
 
         if (lifecycleManager.getGlobalChanges().test(
                     frontend::RequestedLayerState::Changes::Hierarchy)) {
@@ -158,7 +292,7 @@ bool LayerTraceGenerator::generate(const proto::TransactionTraceFile& traceFile,
                                                                   layerTracing.getFlags())
                                           .generate(hierarchyBuilder.getHierarchy());
         auto displayProtos = LayerProtoHelper::writeDisplayInfoToProto(displayInfos);
-        if (!onlyLastEntry || (i == traceFile.entry_size() - 1)) {
+        if (i >= begin && (!onlyLastEntry || (i == traceFile.entry_size() - 1))) {
             layerTracing.notify(visibleRegionsDirty, entry.elapsed_realtime_nanos(),
                                 entry.vsync_id(), &layersProto, {}, &displayProtos);
             layerTracing.appendToStream(out);
@@ -170,4 +304,107 @@ bool LayerTraceGenerator::generate(const proto::TransactionTraceFile& traceFile,
     return true;
 }
 
+bool LayerTraceGenerator::benchmark(const proto::TransactionTraceFile& traceFile,
+                                    size_t iterations, std::ostream& out) {
+    if (traceFile.entry_size() == 0) {
+        ALOGD("Trace file is empty");
+        return false;
+    }
+
+    StageTimes parseTimes("parse");
+    StageTimes applyTimes("apply");
+    StageTimes hierarchyTimes("hierarchy");
+    StageTimes snapshotTimes("snapshot");
+    StageTimes commitTimes("commit");
+
+    renderengine::ShadowSettings globalShadowSettings{.ambientColor = {1, 1, 1, 1}};
+    const bool supportsBlur = supportsBackgroundBlur();
+
+    for (size_t iteration = 0; iteration < iterations; iteration++) {
+        TransactionProtoParser parser(
+                std::make_unique<TransactionProtoParser::FlingerDataMapper>());
+        frontend::LayerLifecycleManager lifecycleManager;
+        frontend::LayerHierarchyBuilder hierarchyBuilder{{}};
+        frontend::LayerSnapshotBuilder snapshotBuilder;
+        ui::DisplayMap<ui::LayerStack, frontend::DisplayInfo> displayInfos;
+
+        for (int i = 0; i < traceFile.entry_size(); i++) {
+            const proto::TransactionTraceEntry& entry = traceFile.entry(i);
+
+            auto start = std::chrono::steady_clock::now();
+            FrontEndUpdate update = parseEntry(parser, entry);
+            const bool displayChanged = entry.displays_changed();
+            if (displayChanged) {
+                parser.fromProto(entry.displays(), displayInfos);
+            }
+            auto end = std::chrono::steady_clock::now();
+            parseTimes.add(end - start);
+
+            start = end;
+            lifecycleManager.addLayers(std::move(update.addedLayers));
+            lifecycleManager.applyTransactions(update.transactions,
+                                               /*ignoreUnknownHandles=*/true);
+            lifecycleManager.onHandlesDestroyed(update.destroyedHandles,
+                                                /*ignoreUnknownHandles=*/true);
+            end = std::chrono::steady_clock::now();
+            applyTimes.add(end - start);
+
+            start = end;
+            if (lifecycleManager.getGlobalChanges().test(
+                        frontend::RequestedLayerState::Changes::Hierarchy)) {
+                hierarchyBuilder.update(lifecycleManager.getLayers(),
+                                        lifecycleManager.getDestroyedLayers());
+            }
+            end = std::chrono::steady_clock::now();
+            hierarchyTimes.add(end - start);
+
+            start = end;
+            frontend::LayerSnapshotBuilder::Args args{.root = hierarchyBuilder.getHierarchy(),
+                                                      .layerLifecycleManager = lifecycleManager,
+                                                      .displays = displayInfos,
+                                                      .displayChanges = displayChanged,
+                                                      .globalShadowSettings = globalShadowSettings,
+                                                      .supportsBlur = supportsBlur,
+                                                      .forceFullDamage = false,
+                                                      .supportedLayerGenericMetadata = {},
+                                                      .genericLayerMetadataKeyMap = {}};
+            snapshotBuilder.update(args);
+            end = std::chrono::steady_clock::now();
+            snapshotTimes.add(end - start);
+
+            start = end;
+            lifecycleManager.commitChanges();
+            commitTimes.add(std::chrono::steady_clock::now() - start);
+        }
+    }
+
+    out << "Replayed " << traceFile.entry_size() << " entries " << iterations
+        << " time(s). Per-entry times in us:\n";
+    out << std::left << std::setw(12) << "stage" << std::right << std::setw(10) << "mean"
+        << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+        << std::setw(10) << "max" << std::setw(12) << "total" << "\n";
+    parseTimes.print(out);
+    applyTimes.print(out);
+    hierarchyTimes.print(out);
+    snapshotTimes.print(out);
+    commitTimes.print(out);
+    return true;
+}
+
+bool LayerTraceGenerator::expandDeltas(const LayersTraceFileProto& traceFile,
+                                       const char* outputLayersTracePath) {
+    LayersTraceFileProto expandedTraceFile = traceFile;
+    LayerTracing::expandDeltaEntries(expandedTraceFile);
+    ALOGD("Expanded %d entries into %d entries", traceFile.entry_size(),
+          expandedTraceFile.entry_size());
+
+    std::ofstream out(outputLayersTracePath, std::ios::binary | std::ios::trunc);
+    if (!out || !expandedTraceFile.SerializeToOstream(&out)) {
+        ALOGE("Could not write %s", outputLayersTracePath);
+        return false;
+    }
+    ALOGD("File written to %s", outputLayersTracePath);
+    return true;
+}
+
 } // namespace android
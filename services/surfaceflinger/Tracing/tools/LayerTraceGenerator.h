@@ -16,12 +16,34 @@
 
 #pragma once
 
+#include <Tracing/LayerTracing.h>
 #include <Tracing/TransactionTracing.h>
 
+#include <ostream>
+
 namespace android {
 class LayerTraceGenerator {
 public:
+    // Replays the transaction trace and writes the resulting layers trace. With more than one
+    // job, the trace is split into segments that are replayed in parallel from checkpoints.
     bool generate(const proto::TransactionTraceFile&, const char* outputLayersTracePath,
-                  bool onlyLastEntry);
+                  bool onlyLastEntry, size_t jobs = 1);
+
+    // Replays the transaction trace through the front end the given number of times, without
+    // writing a layers trace, and prints per-entry timing statistics for each stage.
+    bool benchmark(const proto::TransactionTraceFile&, size_t iterations, std::ostream& out);
+
+    // Rewrites a layers trace recorded with LayerTracing::TRACE_DELTA as a trace of full entries.
+    bool expandDeltas(const LayersTraceFileProto&, const char* outputLayersTracePath);
+
+private:
+    // Segments shorter than this are not worth replaying separately.
+    static constexpr size_t MIN_ENTRIES_PER_SEGMENT = 256;
+
+    // Replays the entries in [begin, end), starting from the state recreated by the checkpoint if
+    // there is one.
+    bool generateSegment(const proto::TransactionTraceFile&, int begin, int end,
+                         const proto::TransactionTraceEntry* checkpoint,
+                         const char* outputLayersTracePath, bool onlyLastEntry);
 };
 } // namespace android
\ No newline at end of file
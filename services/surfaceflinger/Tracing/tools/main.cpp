@@ -17,18 +17,91 @@
 #undef LOG_TAG
 #define LOG_TAG "LayerTraceGenerator"
 
+#include <algorithm>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <thread>
 
 #include "LayerTraceGenerator.h"
 
 using namespace android;
 
+static int expandDeltas(int argc, char** argv) {
+    if (argc != 4) {
+        std::cout << "Usage: " << argv[0]
+                  << " --expand-deltas [layers-trace-path] [output-layers-trace-path]\n";
+        return -1;
+    }
+
+    const char* layersTracePath = argv[2];
+    std::cout << "Parsing " << layersTracePath << "\n";
+    std::fstream input(layersTracePath, std::ios::in | std::ios::binary);
+    if (!input) {
+        std::cout << "Error: Could not open " << layersTracePath;
+        return -1;
+    }
+
+    LayersTraceFileProto layersTraceFile;
+    if (!layersTraceFile.ParseFromIstream(&input)) {
+        std::cout << "Error: Failed to parse " << layersTracePath;
+        return -1;
+    }
+
+    const char* outputLayersTracePath = argv[3];
+    std::cout << "Generating " << outputLayersTracePath << "\n";
+    if (!LayerTraceGenerator().expandDeltas(layersTraceFile, outputLayersTracePath)) {
+        std::cout << "Error: Failed to expand layers trace " << outputLayersTracePath;
+        return -1;
+    }
+    return 0;
+}
+
+static int benchmark(int argc, char** argv) {
+    // --benchmark replays the trace once, --benchmark=N replays it N times.
+    const std::string_view arg(argv[1]);
+    const size_t iterations =
+            arg.size() > 12 && arg[11] == '=' ? std::strtoul(argv[1] + 12, nullptr, 10) : 1;
+    if (argc != 3 || iterations == 0) {
+        std::cout << "Usage: " << argv[0] << " --benchmark[=N] [transaction-trace-path]\n";
+        return -1;
+    }
+
+    const char* transactionTracePath = argv[2];
+    std::cout << "Parsing " << transactionTracePath << "\n";
+    std::fstream input(transactionTracePath, std::ios::in | std::ios::binary);
+    if (!input) {
+        std::cout << "Error: Could not open " << transactionTracePath;
+        return -1;
+    }
+
+    proto::TransactionTraceFile transactionTraceFile;
+    if (!transactionTraceFile.ParseFromIstream(&input)) {
+        std::cout << "Error: Failed to parse " << transactionTracePath;
+        return -1;
+    }
+
+    if (!LayerTraceGenerator().benchmark(transactionTraceFile, iterations, std::cout)) {
+        std::cout << "Error: Failed to replay " << transactionTracePath;
+        return -1;
+    }
+    return 0;
+}
+
 int main(int argc, char** argv) {
+    if (argc > 1 && std::string_view(argv[1]) == "--expand-deltas") {
+        return expandDeltas(argc, argv);
+    }
+    if (argc > 1 && std::string_view(argv[1]).substr(0, 11) == "--benchmark") {
+        return benchmark(argc, argv);
+    }
+
     if (argc > 4) {
         std::cout << "Usage: " << argv[0]
-                  << " [transaction-trace-path] [output-layers-trace-path] [--last-entry-only]\n";
+                  << " [transaction-trace-path] [output-layers-trace-path]"
+                     " [--last-entry-only | --jobs[=N]]\n";
         return -1;
     }
 
@@ -53,11 +126,20 @@ int main(int argc, char** argv) {
     const bool generateLastEntryOnly =
             argc >= 4 && std::string_view(argv[3]) == "--last-entry-only";
 
+    // --jobs replays the trace in parallel on every core, --jobs=N on N threads.
+    size_t jobs = 1;
+    if (argc >= 4 && std::string_view(argv[3]).substr(0, 6) == "--jobs") {
+        const std::string_view arg(argv[3]);
+        jobs = arg.size() > 7 && arg[6] == '='
+                ? std::strtoul(argv[3] + 7, nullptr, 10)
+                : std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
     ALOGD("Generating %s...", outputLayersTracePath);
     std::cout << "Generating " << outputLayersTracePath << "\n";
 
     if (!LayerTraceGenerator().generate(transactionTraceFile, outputLayersTracePath,
-                                        generateLastEntryOnly)) {
+                                        generateLastEntryOnly, jobs)) {
         std::cout << "Error: Failed to generate layers trace " << outputLayersTracePath;
         return -1;
     }
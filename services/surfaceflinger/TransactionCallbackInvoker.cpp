@@ -176,6 +176,15 @@ void TransactionCallbackInvoker::addPresentFence(sp<Fence> presentFence) {
     mPresentFence = std::move(presentFence);
 }
 
+void TransactionCallbackInvoker::addReleaseBufferCallback(
+        const sp<ITransactionCompletedListener>& listener, ReleaseCallbackId callbackId,
+        sp<Fence> releaseFence, uint32_t currentMaxAcquiredBufferCount) {
+    auto& pending = mPendingReleaseBufferCallbacks[IInterface::asBinder(listener)];
+    pending.listener = listener;
+    pending.callbacks.push_back(
+            {callbackId, std::move(releaseFence), currentMaxAcquiredBufferCount});
+}
+
 void TransactionCallbackInvoker::sendCallbacks(bool onCommitOnly) {
     // For each listener
     auto completedTransactionsItr = mCompletedTransactions.begin();
@@ -214,20 +223,49 @@ void TransactionCallbackInvoker::sendCallbacks(bool onCommitOnly) {
                 // keep it as an IBinder due to consistency reasons: if we
                 // interface_cast at the IPC boundary when reading a Parcel,
                 // we get pointers that compare unequal in the SF process.
-                callbacks.emplace_back([stats = std::move(listenerStats)]() {
-                    interface_cast<ITransactionCompletedListener>(stats.listener)
-                            ->onTransactionCompleted(stats);
+                //
+                // Release buffer callbacks for the same listener are sent from the same task,
+                // ahead of the transaction callbacks, so that the client receives them together.
+                std::vector<ReleaseBufferCallback> releases;
+                if (const auto it = mPendingReleaseBufferCallbacks.find(listener);
+                    it != mPendingReleaseBufferCallbacks.end()) {
+                    releases = std::move(it->second.callbacks);
+                    mPendingReleaseBufferCallbacks.erase(it);
+                }
+                callbacks.emplace_back([stats = std::move(listenerStats),
+                                        releases = std::move(releases)]() {
+                    const auto client =
+                            interface_cast<ITransactionCompletedListener>(stats.listener);
+                    for (const auto& release : releases) {
+                        client->onReleaseBuffer(release.callbackId, release.releaseFence,
+                                                release.currentMaxAcquiredBufferCount);
+                    }
+                    client->onTransactionCompleted(stats);
                 });
             }
         }
         completedTransactionsItr++;
     }
 
+    // Send the release buffer callbacks of listeners that have no transaction callbacks.
+    for (auto& [_, pending] : mPendingReleaseBufferCallbacks) {
+        callbacks.emplace_back([pending = std::move(pending)]() {
+            for (const auto& release : pending.callbacks) {
+                pending.listener->onReleaseBuffer(release.callbackId, release.releaseFence,
+                                                  release.currentMaxAcquiredBufferCount);
+            }
+        });
+    }
+    mPendingReleaseBufferCallbacks.clear();
+
     if (mPresentFence) {
         mPresentFence.clear();
     }
 
-    BackgroundExecutor::getInstance().sendCallbacks(std::move(callbacks));
+    // Clients wait on these callbacks to reuse their buffers, so do not queue them behind other
+    // background work.
+    BackgroundExecutor::getInstance().sendCallbacks(std::move(callbacks),
+                                                    BackgroundExecutor::Priority::High);
 }
 
 // -----------------------------------------------------------------------
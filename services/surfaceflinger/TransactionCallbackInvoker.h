@@ -70,6 +70,12 @@ public:
 
     void addPresentFence(sp<Fence>);
 
+    // Queues a release buffer callback to be sent by the next sendCallbacks(), together with any
+    // transaction callbacks bound for the same listener.
+    void addReleaseBufferCallback(const sp<ITransactionCompletedListener>& listener,
+                                  ReleaseCallbackId callbackId, sp<Fence> releaseFence,
+                                  uint32_t currentMaxAcquiredBufferCount);
+
     void sendCallbacks(bool onCommitOnly);
     void clearCompletedTransactions() {
         mCompletedTransactions.clear();
@@ -87,6 +93,20 @@ private:
     std::unordered_map<sp<IBinder>, std::deque<TransactionStats>, IListenerHash>
         mCompletedTransactions;
 
+    struct ReleaseBufferCallback {
+        ReleaseCallbackId callbackId;
+        sp<Fence> releaseFence;
+        uint32_t currentMaxAcquiredBufferCount;
+    };
+
+    struct PendingReleaseBufferCallbacks {
+        sp<ITransactionCompletedListener> listener;
+        std::vector<ReleaseBufferCallback> callbacks;
+    };
+
+    std::unordered_map<sp<IBinder>, PendingReleaseBufferCallbacks, IListenerHash>
+            mPendingReleaseBufferCallbacks;
+
     sp<Fence> mPresentFence;
 };
 
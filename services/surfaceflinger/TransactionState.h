@@ -44,6 +44,9 @@ public:
     uint32_t parentId = UNASSIGNED_LAYER_ID;
     uint32_t relativeParentId = UNASSIGNED_LAYER_ID;
     uint32_t touchCropId = UNASSIGNED_LAYER_ID;
+    // True once the acquire fence of the buffer has been seen to signal. Fences never unsignal,
+    // so the fence does not need to be polled again.
+    bool acquireFenceSignaled = false;
 };
 
 struct TransactionState {
@@ -85,11 +88,12 @@ struct TransactionState {
         }
     }
 
+    // Invokes `TraverseBuffersReturnValues(ResolvedComposerState&)` visitor for matching layers.
     template <typename Visitor>
     void traverseStatesWithBuffersWhileTrue(Visitor&& visitor) {
         for (auto state = states.begin(); state != states.end();) {
             if (state->state.hasBufferChanges() && state->externalTexture && state->state.surface) {
-                int result = visitor(state->state, state->externalTexture);
+                int result = visitor(*state);
                 if (result == STOP_TRAVERSAL) return;
                 if (result == DELETE_AND_CONTINUE_TRAVERSAL) {
                     state = states.erase(state);
@@ -100,6 +104,22 @@ struct TransactionState {
         }
     }
 
+    // Polls the acquire fences that have not been seen to signal yet, and records the ones that
+    // have. This lets the readiness check at commit skip fences that signaled while the
+    // transaction was queued.
+    void updateSignaledAcquireFences() {
+        for (auto& state : states) {
+            if (state.acquireFenceSignaled || !state.state.hasBufferChanges() ||
+                !state.state.bufferData ||
+                !state.state.bufferData->flags.test(BufferData::BufferDataChange::fenceChanged) ||
+                !state.state.bufferData->acquireFence) {
+                continue;
+            }
+            state.acquireFenceSignaled =
+                    state.state.bufferData->acquireFence->getStatus() != Fence::Status::Unsignaled;
+        }
+    }
+
     // TODO(b/185535769): Remove FrameHint. Instead, reset the idle timer (of the relevant physical
     // display) on the main thread if commit leads to composite. Then, RefreshRateOverlay should be
     // able to setFrameRate once, rather than for each transaction.
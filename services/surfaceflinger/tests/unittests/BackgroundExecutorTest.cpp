@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <condition_variable>
+#include <vector>
 
 #include "BackgroundExecutor.h"
 
@@ -52,6 +53,30 @@ TEST_F(BackgroundExecutorTest, multipleProducers) {
     ASSERT_EQ(backgroundTaskCount, backgroundTaskCompleteCount);
 }
 
+TEST_F(BackgroundExecutorTest, highPriorityRunsFirst) {
+    std::mutex mutex;
+    std::condition_variable condition_variable;
+    bool blocked = true;
+    std::vector<int> order;
+
+    // Hold the executor thread so that both callbacks below are pending at once.
+    BackgroundExecutor::getInstance().sendCallbacks({[&]() {
+        std::unique_lock<std::mutex> lock{mutex};
+        condition_variable.wait(lock, [&blocked]() { return !blocked; });
+    }});
+    BackgroundExecutor::getInstance().sendCallbacks({[&]() { order.push_back(1); }});
+    BackgroundExecutor::getInstance().sendCallbacks({[&]() { order.push_back(2); }},
+                                                    BackgroundExecutor::Priority::High);
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        blocked = false;
+        condition_variable.notify_one();
+    }
+
+    BackgroundExecutor::getInstance().flushQueue();
+    EXPECT_EQ((std::vector<int>{2, 1}), order);
+}
+
 } // namespace
 
 } // namespace android
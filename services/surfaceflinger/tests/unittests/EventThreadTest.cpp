@@ -507,6 +507,40 @@ TEST_F(EventThreadTest, getLatestVsyncEventData) {
     }
 }
 
+TEST_F(EventThreadTest, sharedVsyncEventDataMatchesPostedEvent) {
+    setupEventThread(VSYNC_PERIOD);
+
+    os::ParcelFileDescriptor fd;
+    ASSERT_TRUE(mConnection->getSharedVsyncEventData(&fd).isOk());
+    const auto sharedVsyncEventData = gui::SharedVsyncEventData::map(fd.release());
+    ASSERT_NE(nullptr, sharedVsyncEventData);
+
+    VsyncEventData vsyncEventData;
+    EXPECT_FALSE(sharedVsyncEventData->read(&vsyncEventData));
+
+    mThread->requestNextVsync(mConnection);
+    expectVSyncCallbackScheduleReceived(true);
+    onVSyncEvent(123, 456, 789);
+
+    auto args = mConnectionEventCallRecorder.waitForCall();
+    ASSERT_TRUE(args.has_value());
+    const VsyncEventData postedVsyncEventData = std::get<0>(args.value()).vsync.vsyncData;
+
+    ASSERT_TRUE(sharedVsyncEventData->read(&vsyncEventData));
+    EXPECT_EQ(postedVsyncEventData.frameInterval, vsyncEventData.frameInterval);
+    EXPECT_EQ(postedVsyncEventData.preferredFrameTimelineIndex,
+              vsyncEventData.preferredFrameTimelineIndex);
+    ASSERT_EQ(postedVsyncEventData.frameTimelinesLength, vsyncEventData.frameTimelinesLength);
+    for (size_t i = 0; i < vsyncEventData.frameTimelinesLength; i++) {
+        EXPECT_EQ(postedVsyncEventData.frameTimelines[i].vsyncId,
+                  vsyncEventData.frameTimelines[i].vsyncId);
+        EXPECT_EQ(postedVsyncEventData.frameTimelines[i].deadlineTimestamp,
+                  vsyncEventData.frameTimelines[i].deadlineTimestamp);
+        EXPECT_EQ(postedVsyncEventData.frameTimelines[i].expectedPresentationTime,
+                  vsyncEventData.frameTimelines[i].expectedPresentationTime);
+    }
+}
+
 TEST_F(EventThreadTest, setVsyncRateZeroPostsNoVSyncEventsToThatConnection) {
     setupEventThread(VSYNC_PERIOD);
 
@@ -622,18 +656,44 @@ TEST_F(EventThreadTest, connectionsRemovedIfEventDeliveryError) {
     onVSyncEvent(123, 456, 789);
     expectVsyncEventReceivedByConnection("errorConnection", errorConnectionEventRecorder, 123, 1u);
 
-    // Another schedule is expected, since the connection is removed only after
-    // the next vsync is requested.
-    expectVSyncCallbackScheduleReceived(true);
+    // The connection is removed as soon as the event is dispatched, so EventThread should
+    // disable vsync callbacks right away.
+    expectVSyncCallbackScheduleReceived(false);
 
     // A subsequent event will not be seen by the connection.
     onVSyncEvent(456, 123, 0);
     EXPECT_FALSE(errorConnectionEventRecorder.waitForUnexpectedCall().has_value());
-
-    // EventThread should disable vsync callbacks with the second event
     expectVSyncCallbackScheduleReceived(false);
 }
 
+TEST_F(EventThreadTest, connectionCanRequestVsyncWhileReceivingEvent) {
+    setupEventThread(VSYNC_PERIOD);
+
+    // The connection requests the next vsync from within its event delivery, which needs the
+    // EventThread lock to be released while events are dispatched.
+    ConnectionEventRecorder reentrantConnectionEventRecorder{0};
+    sp<MockEventThreadConnection> reentrantConnection =
+            createConnection(reentrantConnectionEventRecorder);
+    EXPECT_CALL(*reentrantConnection, postEvent(_))
+            .WillOnce([&](const DisplayEventReceiver::Event& event) {
+                mThread->requestNextVsync(reentrantConnection);
+                return reentrantConnectionEventRecorder.getInvocable()(event);
+            })
+            .WillRepeatedly(Invoke(reentrantConnectionEventRecorder.getInvocable()));
+    mThread->requestNextVsync(reentrantConnection);
+    expectVSyncCallbackScheduleReceived(true);
+
+    onVSyncEvent(123, 456, 789);
+    expectVsyncEventReceivedByConnection("reentrantConnection", reentrantConnectionEventRecorder,
+                                         123, 1u);
+
+    // The request made during delivery is not lost.
+    expectVSyncCallbackScheduleReceived(true);
+    onVSyncEvent(456, 123, 0);
+    expectVsyncEventReceivedByConnection("reentrantConnection", reentrantConnectionEventRecorder,
+                                         456, 2u);
+}
+
 TEST_F(EventThreadTest, tracksEventConnections) {
     setupEventThread(VSYNC_PERIOD);
 
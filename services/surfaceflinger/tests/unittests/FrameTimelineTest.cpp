@@ -131,11 +131,24 @@ public:
         mFrameTimeline->setSfPresent(2500, presentFence1);
     }
 
+    void useClassificationThread() {
+        constexpr bool kUseBootTimeClock = true;
+        constexpr bool kClassifyOnWorkerThread = true;
+        mFrameTimeline = std::make_unique<impl::FrameTimeline>(mTimeStats, kSurfaceFlingerPid,
+                                                               kTestThresholds, !kUseBootTimeClock,
+                                                               kClassifyOnWorkerThread);
+        mTokenManager = &mFrameTimeline->mTokenManager;
+        mTraceCookieCounter = &mFrameTimeline->mTraceCookieCounter;
+        maxDisplayFrames = &mFrameTimeline->mMaxDisplayFrames;
+    }
+
+    void waitForClassification() { mFrameTimeline->waitForClassification(); }
+
     void flushTokens() {
         for (size_t i = 0; i < maxTokens; i++) {
             mTokenManager->generateTokenForPredictions({});
         }
-        EXPECT_EQ(getPredictions().size(), maxTokens);
+        EXPECT_EQ(getPredictionCount(), maxTokens);
     }
 
     SurfaceFrame& getSurfaceFrame(size_t displayFrameIdx, size_t surfaceFrameIdx) {
@@ -154,9 +167,7 @@ public:
                 a.presentTime == b.presentTime;
     }
 
-    const std::map<int64_t, TimelineItem>& getPredictions() const {
-        return mTokenManager->mPredictions;
-    }
+    size_t getPredictionCount() const { return mTokenManager->mPredictionCount; }
 
     uint32_t getNumberOfDisplayFrames() const {
         std::lock_guard<std::mutex> lock(mFrameTimeline->mMutex);
@@ -189,7 +200,7 @@ public:
 
 TEST_F(FrameTimelineTest, tokenManagerRemovesStalePredictions) {
     int64_t token1 = mTokenManager->generateTokenForPredictions({0, 0, 0});
-    EXPECT_EQ(getPredictions().size(), 1u);
+    EXPECT_EQ(getPredictionCount(), 1u);
     flushTokens();
     int64_t token2 = mTokenManager->generateTokenForPredictions({10, 20, 30});
     std::optional<TimelineItem> predictions = mTokenManager->getPredictionsForToken(token1);
@@ -201,6 +212,28 @@ TEST_F(FrameTimelineTest, tokenManagerRemovesStalePredictions) {
     EXPECT_EQ(compareTimelineItems(*predictions, TimelineItem(10, 20, 30)), true);
 }
 
+TEST_F(FrameTimelineTest, tokenManagerKeepsMostRecentPredictions) {
+    int64_t token1 = mTokenManager->generateTokenForPredictions({10, 20, 30});
+    for (size_t i = 1; i < maxTokens; i++) {
+        mTokenManager->generateTokenForPredictions({});
+    }
+    EXPECT_EQ(getPredictionCount(), maxTokens);
+
+    // token1 is the oldest token kept, and is overwritten by the next one.
+    std::optional<TimelineItem> predictions = mTokenManager->getPredictionsForToken(token1);
+    ASSERT_TRUE(predictions.has_value());
+    EXPECT_EQ(compareTimelineItems(*predictions, TimelineItem(10, 20, 30)), true);
+
+    int64_t token2 = mTokenManager->generateTokenForPredictions({40, 50, 60});
+    EXPECT_EQ(getPredictionCount(), maxTokens);
+    EXPECT_EQ(mTokenManager->getPredictionsForToken(token1).has_value(), false);
+    EXPECT_EQ(mTokenManager->getPredictionsForToken(token2 + 1).has_value(), false);
+
+    predictions = mTokenManager->getPredictionsForToken(token2);
+    ASSERT_TRUE(predictions.has_value());
+    EXPECT_EQ(compareTimelineItems(*predictions, TimelineItem(40, 50, 60)), true);
+}
+
 TEST_F(FrameTimelineTest, createSurfaceFrameForToken_getOwnerPidReturnsCorrectPid) {
     auto surfaceFrame1 =
             mFrameTimeline->createSurfaceFrameForToken({}, sPidOne, sUidOne, sLayerIdOne,
@@ -335,6 +368,34 @@ TEST_F(FrameTimelineTest, presentFenceSignaled_presentedFramesUpdated) {
     EXPECT_NE(surfaceFrame2->getJankType(), std::nullopt);
 }
 
+TEST_F(FrameTimelineTest, presentFenceSignaled_classifiedOnWorkerThread) {
+    useClassificationThread();
+
+    EXPECT_CALL(*mTimeStats, incrementJankyFrames(_));
+    auto presentFence1 = fenceFactory.createFenceTimeForTest(Fence::NO_FENCE);
+    int64_t surfaceFrameToken1 = mTokenManager->generateTokenForPredictions({10, 20, 30});
+    int64_t sfToken1 = mTokenManager->generateTokenForPredictions({22, 26, 30});
+    FrameTimelineInfo ftInfo;
+    ftInfo.vsyncId = surfaceFrameToken1;
+    ftInfo.inputEventId = sInputEventId;
+    auto surfaceFrame1 =
+            mFrameTimeline->createSurfaceFrameForToken(ftInfo, sPidOne, sUidOne, sLayerIdOne,
+                                                       sLayerNameOne, sLayerNameOne,
+                                                       /*isBuffer*/ true, sGameMode);
+    mFrameTimeline->setSfWakeUp(sfToken1, 22, Fps::fromPeriodNsecs(11));
+    surfaceFrame1->setPresentState(SurfaceFrame::PresentState::Presented);
+    mFrameTimeline->addSurfaceFrame(surfaceFrame1);
+    mFrameTimeline->setSfPresent(26, presentFence1);
+    presentFence1->signalForTest(42);
+
+    addEmptyDisplayFrame();
+    waitForClassification();
+
+    EXPECT_EQ(getDisplayFrame(0)->getActuals().presentTime, 42);
+    EXPECT_EQ(getSurfaceFrame(0, 0).getActuals().presentTime, 42);
+    EXPECT_NE(surfaceFrame1->getJankType(), std::nullopt);
+}
+
 TEST_F(FrameTimelineTest, displayFramesSlidingWindowMovesAfterLimit) {
     // Insert kMaxDisplayFrames' count of DisplayFrames to fill the deque
     int frameTimeFactor = 0;
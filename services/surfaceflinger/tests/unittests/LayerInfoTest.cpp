@@ -171,5 +171,30 @@ TEST_F(LayerInfoTest, ignoresLargePeriods) {
     ASSERT_EQ(kExpectedFps, Fps::fromPeriodNsecs(*averageFrameTime));
 }
 
+TEST_F(LayerInfoTest, publishesOnlyRequirementChanges) {
+    using LayerRequirement = RefreshRateSelector::LayerRequirement;
+    const LayerRequirement requirement{.name = "TestLayerInfo",
+                                       .vote = LayerHistory::LayerVoteType::Heuristic,
+                                       .desiredRefreshRate = 60_Hz,
+                                       .weight = 1.f};
+
+    EXPECT_TRUE(layerInfo.publishRequirement(requirement));
+    EXPECT_FALSE(layerInfo.publishRequirement(requirement));
+    ASSERT_TRUE(layerInfo.getPublishedRequirement());
+    EXPECT_EQ(requirement, *layerInfo.getPublishedRequirement());
+
+    auto changed = requirement;
+    changed.desiredRefreshRate = 30_Hz;
+    EXPECT_TRUE(layerInfo.publishRequirement(changed));
+
+    EXPECT_TRUE(layerInfo.publishRequirement(std::nullopt));
+    EXPECT_FALSE(layerInfo.publishRequirement(std::nullopt));
+
+    // An inactive layer no longer contributes to the summary.
+    EXPECT_TRUE(layerInfo.publishRequirement(requirement));
+    layerInfo.onLayerInactive(0);
+    EXPECT_FALSE(layerInfo.getPublishedRequirement());
+}
+
 } // namespace
 } // namespace android::scheduler
@@ -224,6 +224,56 @@ TEST_F(LayerSnapshotTest, ReparentingToHiddenRelativeParentHidesChild) {
     UPDATE_AND_VERIFY(mSnapshotBuilder, {1, 12, 121, 122, 1221, 2});
 }
 
+TEST_F(LayerSnapshotTest, ParallelUpdateMatchesSequentialUpdate) {
+    LayerSnapshotBuilder parallelBuilder;
+    parallelBuilder.setParallelUpdateThreads(2);
+    UPDATE_AND_VERIFY(parallelBuilder, STARTING_ZORDER);
+
+    setAlpha(1, 0.5f);
+    hideLayer(121);
+    UPDATE_AND_VERIFY(parallelBuilder, {1, 11, 111, 12, 122, 1221, 13, 2});
+    EXPECT_EQ(parallelBuilder.getSnapshot(111)->alpha, 0.5f);
+}
+
+TEST_F(LayerSnapshotTest, ParallelUpdateWithRelativeParentAcrossSubtrees) {
+    LayerSnapshotBuilder parallelBuilder;
+    parallelBuilder.setParallelUpdateThreads(2);
+    createLayer(21, 2);
+    reparentRelativeLayer(21, 11);
+    UPDATE_AND_VERIFY(parallelBuilder, {1, 11, 21, 111, 12, 121, 122, 1221, 13, 2});
+
+    hideLayer(11);
+    UPDATE_AND_VERIFY(parallelBuilder, {1, 12, 121, 122, 1221, 13, 2});
+}
+
+TEST_F(LayerSnapshotTest, PartialUpdateKeepsUnchangedSubtrees) {
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+
+    setAlpha(12, 0.5f);
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+    EXPECT_EQ(getSnapshot(1221)->alpha, 0.5f);
+    EXPECT_EQ(getSnapshot(111)->alpha, 1.f);
+    EXPECT_EQ(getSnapshot(111)->reachablilty, LayerSnapshot::Reachablilty::Reachable);
+    EXPECT_EQ(getSnapshot(2)->reachablilty, LayerSnapshot::Reachablilty::Reachable);
+
+    hideLayer(2);
+    UPDATE_AND_VERIFY(mSnapshotBuilder, {1, 11, 111, 12, 121, 122, 1221, 13});
+    EXPECT_EQ(getSnapshot(1221)->alpha, 0.5f);
+}
+
+TEST_F(LayerSnapshotTest, PartialUpdateHandlesReparentAndZ) {
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+
+    setAlpha(11, 0.5f);
+    reparentLayer(122, 11);
+    UPDATE_AND_VERIFY(mSnapshotBuilder, {1, 11, 111, 122, 1221, 12, 121, 13, 2});
+    EXPECT_EQ(getSnapshot(1221)->alpha, 0.5f);
+
+    setZ(111, -1);
+    UPDATE_AND_VERIFY(mSnapshotBuilder, {1, 111, 11, 122, 1221, 12, 121, 13, 2});
+    EXPECT_EQ(getSnapshot(111)->alpha, 0.5f);
+}
+
 TEST_F(LayerSnapshotTest, AlphaInheritedByChildren) {
     setAlpha(1, 0.5);
     setAlpha(122, 0.5);
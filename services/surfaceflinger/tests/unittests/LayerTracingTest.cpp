@@ -0,0 +1,126 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <android-base/file.h>
+#include <layerproto/LayerProtoHeader.h>
+
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Tracing/LayerTracing.h"
+
+namespace android {
+
+class LayerTracingTest : public testing::Test {
+protected:
+    LayerTracingTest() {
+        mTracing.setTraceFlags(LayerTracing::TRACE_INPUT | LayerTracing::TRACE_DELTA);
+        mTracing.enable();
+    }
+
+    void notify(int64_t vsyncId, const std::vector<std::pair<int32_t, std::string>>& layers) {
+        LayersProto layersProto;
+        for (const auto& [id, name] : layers) {
+            LayerProto* layer = layersProto.add_layers();
+            layer->set_id(id);
+            layer->set_name(name);
+        }
+        google::protobuf::RepeatedPtrField<DisplayProto> displays;
+        mTracing.notify(/*visibleRegionDirty=*/true, vsyncId, vsyncId, &layersProto, {},
+                        &displays);
+    }
+
+    LayersTraceFileProto readTrace() {
+        TemporaryFile file;
+        {
+            std::ofstream out(file.path, std::ios::binary);
+            mTracing.appendToStream(out);
+        }
+        std::ifstream in(file.path, std::ios::binary);
+        LayersTraceFileProto fileProto;
+        EXPECT_TRUE(fileProto.ParseFromIstream(&in));
+        return fileProto;
+    }
+
+    static void expectLayers(const LayersTraceProto& entry,
+                             const std::vector<std::pair<int32_t, std::string>>& layers) {
+        ASSERT_EQ(entry.layers().layers_size(), static_cast<int>(layers.size()));
+        for (int i = 0; i < entry.layers().layers_size(); i++) {
+            EXPECT_EQ(entry.layers().layers(i).id(), layers[static_cast<size_t>(i)].first);
+            EXPECT_EQ(entry.layers().layers(i).name(), layers[static_cast<size_t>(i)].second);
+        }
+    }
+
+    LayerTracing mTracing;
+};
+
+TEST_F(LayerTracingTest, recordsOnlyChangedLayers) {
+    notify(1, {{1, "a"}, {2, "b"}});
+    notify(2, {{1, "a"}, {2, "b2"}});
+    notify(3, {{2, "b2"}, {3, "c"}});
+
+    const LayersTraceFileProto fileProto = readTrace();
+    ASSERT_EQ(fileProto.entry_size(), 3);
+
+    EXPECT_FALSE(fileProto.entry(0).is_delta());
+    expectLayers(fileProto.entry(0), {{1, "a"}, {2, "b"}});
+
+    EXPECT_TRUE(fileProto.entry(1).is_delta());
+    expectLayers(fileProto.entry(1), {{2, "b2"}});
+    EXPECT_EQ(fileProto.entry(1).delta_layer_ids_size(), 2);
+
+    EXPECT_TRUE(fileProto.entry(2).is_delta());
+    expectLayers(fileProto.entry(2), {{3, "c"}});
+    ASSERT_EQ(fileProto.entry(2).delta_layer_ids_size(), 2);
+    EXPECT_EQ(fileProto.entry(2).delta_layer_ids(0), 2);
+    EXPECT_EQ(fileProto.entry(2).delta_layer_ids(1), 3);
+}
+
+TEST_F(LayerTracingTest, expandsDeltaEntries) {
+    notify(1, {{1, "a"}, {2, "b"}});
+    notify(2, {{1, "a"}, {2, "b2"}});
+    notify(3, {{2, "b2"}, {3, "c"}});
+
+    LayersTraceFileProto fileProto = readTrace();
+    LayerTracing::expandDeltaEntries(fileProto);
+    ASSERT_EQ(fileProto.entry_size(), 3);
+
+    for (const LayersTraceProto& entry : fileProto.entry()) {
+        EXPECT_FALSE(entry.is_delta());
+        EXPECT_EQ(entry.delta_layer_ids_size(), 0);
+    }
+    expectLayers(fileProto.entry(0), {{1, "a"}, {2, "b"}});
+    expectLayers(fileProto.entry(1), {{1, "a"}, {2, "b2"}});
+    expectLayers(fileProto.entry(2), {{2, "b2"}, {3, "c"}});
+}
+
+TEST_F(LayerTracingTest, dropsDeltaEntriesBeforeFirstKeyframe) {
+    notify(1, {{1, "a"}});
+    notify(2, {{1, "a2"}});
+
+    LayersTraceFileProto fileProto = readTrace();
+    ASSERT_EQ(fileProto.entry_size(), 2);
+    fileProto.mutable_entry()->DeleteSubrange(0, 1);
+
+    LayerTracing::expandDeltaEntries(fileProto);
+    EXPECT_EQ(fileProto.entry_size(), 0);
+}
+
+} // namespace android
@@ -218,5 +218,87 @@ TEST_F(PowerAdvisorTest, hintSessionUsingSecondaryVirtualDisplays) {
     mPowerAdvisor->reportActualWorkDuration();
 }
 
+TEST_F(PowerAdvisorTest, hintSessionBoostsCompositeBehindDeadline) {
+    mPowerAdvisor->onBootFinished();
+    startPowerHintSession();
+
+    // 60hz
+    const Duration vsyncPeriod{std::chrono::nanoseconds(1s) / 60};
+    const Duration compositeDuration = 6ms;
+
+    TimePoint startTime{100ns};
+
+    // The first frame only records how long composition takes.
+    EXPECT_CALL(*mMockPowerHintSession, sendHint(SessionHint::CPU_LOAD_UP)).Times(0);
+    fakeBasicFrameTiming(startTime, vsyncPeriod);
+    setExpectedTiming(vsyncPeriod, startTime + vsyncPeriod);
+    mPowerAdvisor->setCompositeStart(startTime + 2ms);
+    mPowerAdvisor->setCompositeEnd(startTime + 2ms + compositeDuration);
+
+    // Composition starting early enough to finish within the frame is not boosted.
+    startTime += vsyncPeriod;
+    fakeBasicFrameTiming(startTime, vsyncPeriod);
+    setExpectedTiming(vsyncPeriod, startTime + vsyncPeriod);
+    mPowerAdvisor->setCompositeStart(startTime + 2ms);
+    mPowerAdvisor->setCompositeEnd(startTime + 2ms + compositeDuration);
+    Mock::VerifyAndClearExpectations(mMockPowerHintSession.get());
+
+    // Composition starting too late to finish within the frame is boosted.
+    startTime += vsyncPeriod;
+    EXPECT_CALL(*mMockPowerHintSession, sendHint(SessionHint::CPU_LOAD_UP)).Times(1);
+    fakeBasicFrameTiming(startTime, vsyncPeriod);
+    setExpectedTiming(vsyncPeriod, startTime + vsyncPeriod);
+    mPowerAdvisor->setCompositeStart(startTime + 12ms);
+}
+
+TEST_F(PowerAdvisorTest, hintSessionBatchesDurationsWithinTarget) {
+    mPowerAdvisor->onBootFinished();
+    startPowerHintSession();
+    mPowerAdvisor->mHintSessionBatchSize = 2;
+
+    std::vector<DisplayId> displayIds{PhysicalDisplayId::fromPort(42u)};
+
+    // 60hz
+    const Duration vsyncPeriod{std::chrono::nanoseconds(1s) / 60};
+    const Duration presentDuration = 5ms;
+    const Duration lateDuration = 20ms;
+
+    TimePoint startTime{100ns};
+
+    const auto reportFrame = [&](Duration duration) {
+        startTime += vsyncPeriod;
+        fakeBasicFrameTiming(startTime, vsyncPeriod);
+        setExpectedTiming(vsyncPeriod, startTime + vsyncPeriod);
+        mPowerAdvisor->setDisplays(displayIds);
+        mPowerAdvisor->setSfPresentTiming(startTime, startTime + duration);
+        mPowerAdvisor->setCompositeEnd(startTime + duration);
+        mPowerAdvisor->reportActualWorkDuration();
+    };
+
+    // advisor only starts on frame 2 so do an initial no-op frame
+    fakeBasicFrameTiming(startTime, vsyncPeriod);
+    setExpectedTiming(vsyncPeriod, startTime + vsyncPeriod);
+    mPowerAdvisor->setDisplays(displayIds);
+    mPowerAdvisor->setSfPresentTiming(startTime, startTime + presentDuration);
+    mPowerAdvisor->setCompositeEnd(startTime + presentDuration);
+
+    // Durations within the target are held back until the batch is full.
+    EXPECT_CALL(*mMockPowerHintSession, reportActualWorkDuration(_)).Times(0);
+    reportFrame(presentDuration);
+    Mock::VerifyAndClearExpectations(mMockPowerHintSession.get());
+
+    EXPECT_CALL(*mMockPowerHintSession, reportActualWorkDuration(SizeIs(2))).Times(1);
+    reportFrame(presentDuration);
+    Mock::VerifyAndClearExpectations(mMockPowerHintSession.get());
+
+    // A duration over the target is reported right away.
+    const Duration expectedDuration = getErrorMargin() + lateDuration;
+    EXPECT_CALL(*mMockPowerHintSession,
+                reportActualWorkDuration(ElementsAre(
+                        Field(&WorkDuration::durationNanos, Eq(expectedDuration.ns())))))
+            .Times(1);
+    reportFrame(lateDuration);
+}
+
 } // namespace
 } // namespace android::Hwc2::impl
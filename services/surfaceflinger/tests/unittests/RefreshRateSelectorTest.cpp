@@ -2279,7 +2279,10 @@ TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_ReadsCache) {
                                                                   {90_Hz, kMode90}}},
                                                           GlobalSignals{.touch = true}};
 
-    selector.mutableGetRankedRefreshRatesCache() = {args, result};
+    selector.getRankedFrameRates(args.first, args.second);
+    auto& cache = selector.mutableGetRankedRefreshRatesCache();
+    ASSERT_EQ(1u, cache.size());
+    cache.front().result = result;
 
     EXPECT_EQ(result, selector.getRankedFrameRates(args.first, args.second));
 }
@@ -2287,7 +2290,7 @@ TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_ReadsCache) {
 TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_WritesCache) {
     auto selector = createSelector(kModes_30_60_72_90_120, kModeId60);
 
-    EXPECT_FALSE(selector.mutableGetRankedRefreshRatesCache());
+    EXPECT_TRUE(selector.mutableGetRankedRefreshRatesCache().empty());
 
     std::vector<LayerRequirement> layers = {{.weight = 1.f}, {.weight = 0.5f}};
     RefreshRateSelector::GlobalSignals globalSignals{.touch = true, .idle = true};
@@ -2295,10 +2298,41 @@ TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_WritesCache) {
     const auto result = selector.getRankedFrameRates(layers, globalSignals);
 
     const auto& cache = selector.mutableGetRankedRefreshRatesCache();
-    ASSERT_TRUE(cache);
+    ASSERT_EQ(1u, cache.size());
 
-    EXPECT_EQ(cache->arguments, std::make_pair(layers, globalSignals));
-    EXPECT_EQ(cache->result, result);
+    EXPECT_EQ(cache.front().arguments, std::make_pair(layers, globalSignals));
+    EXPECT_EQ(cache.front().result, result);
+}
+
+TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_CachesRecentInvocations) {
+    auto selector = createSelector(kModes_30_60_72_90_120, kModeId60);
+
+    std::vector<std::vector<LayerRequirement>> layersSets;
+    for (const Fps fps : {24_Hz, 30_Hz, 48_Hz, 60_Hz, 90_Hz}) {
+        layersSets.push_back({{.vote = LayerVoteType::ExplicitDefault,
+                               .desiredRefreshRate = fps,
+                               .weight = 1.f}});
+    }
+
+    const auto& cache = selector.mutableGetRankedRefreshRatesCache();
+    for (const auto& layers : layersSets) {
+        selector.getRankedFrameRates(layers, {});
+    }
+    ASSERT_EQ(4u, cache.size());
+
+    // The least recently used invocation was evicted.
+    EXPECT_EQ(layersSets[4], cache.front().arguments.first);
+    EXPECT_EQ(layersSets[1], cache.back().arguments.first);
+
+    // A cache hit moves the invocation to the front.
+    selector.getRankedFrameRates(layersSets[1], {});
+    ASSERT_EQ(4u, cache.size());
+    EXPECT_EQ(layersSets[1], cache.front().arguments.first);
+    EXPECT_EQ(layersSets[2], cache.back().arguments.first);
+
+    // Mode changes invalidate every cached invocation.
+    selector.setActiveMode(kModeId90, 90_Hz);
+    EXPECT_TRUE(selector.mutableGetRankedRefreshRatesCache().empty());
 }
 
 TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_ExplicitExactTouchBoost) {
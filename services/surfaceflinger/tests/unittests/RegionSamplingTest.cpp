@@ -106,6 +106,21 @@ TEST_F(RegionSamplingTest, bounds_checking) {
                 testing::Eq(0.0));
 }
 
+TEST_F(RegionSamplingTest, downscale_area) {
+    EXPECT_EQ(downscaleSampleArea(Rect{0, 0, 8, 4}, 4), (Rect{0, 0, 2, 1}));
+    EXPECT_EQ(downscaleSampleArea(Rect{5, 6, 7, 9}, 4), (Rect{1, 1, 2, 3}));
+    EXPECT_EQ(downscaleSampleArea(Rect{3, 3, 4, 4}, 4), (Rect{0, 0, 1, 1}));
+    EXPECT_EQ(downscaleSampleArea(Rect{10, 20, 30, 40}, 1), (Rect{10, 20, 30, 40}));
+}
+
+TEST_F(RegionSamplingTest, calculate_mean_downscaled) {
+    std::fill(buffer.begin(), buffer.end(), kWhite);
+    const Rect area = downscaleSampleArea(Rect{0, 0, kWidth * 4, kHeight * 4}, 4);
+    EXPECT_EQ(area, whole_area);
+    EXPECT_THAT(sampleArea(buffer.data(), kWidth, kHeight, kStride, kOrientation, area),
+                testing::FloatEq(1.0f));
+}
+
 } // namespace android
 
 // TODO(b/129481165): remove the #pragma below and fix conversion issues
@@ -32,6 +32,7 @@
 
 #include <chrono>
 #include <random>
+#include <thread>
 #include <unordered_set>
 
 #include "libsurfaceflinger_unittest_main.h"
@@ -1542,6 +1543,63 @@ TEST_F(TimeStatsTest, layerStatsCallback_limitsLayers) {
     EXPECT_EQ(atomList.atom(0).layer_name(), genLayerName(LAYER_ID_1));
 }
 
+TEST_F(TimeStatsTest, layerEventsAreAppliedInOrder) {
+    EXPECT_TRUE(inputCommand(InputCommand::ENABLE, FMT_STRING).empty());
+
+    // Enough events to wake up the drain thread several times while frames are being recorded.
+    // A frame only counts if its events are applied in the order they were recorded.
+    constexpr uint64_t kNumFrames = 500;
+    for (uint64_t frameNumber = 1; frameNumber <= kNumFrames; frameNumber++) {
+        insertTimeRecord(NORMAL_SEQUENCE, LAYER_ID_0, frameNumber, frameNumber * 5000000);
+    }
+
+    SFTimeStatsGlobalProto globalProto;
+    ASSERT_TRUE(globalProto.ParseFromString(inputCommand(InputCommand::DUMP_ALL, FMT_PROTO)));
+    ASSERT_EQ(1, globalProto.stats_size());
+    EXPECT_EQ(kNumFrames - 1, globalProto.stats(0).total_frames());
+}
+
+TEST_F(TimeStatsTest, layerEventsFromMultipleThreadsAreApplied) {
+    EXPECT_TRUE(inputCommand(InputCommand::ENABLE, FMT_STRING).empty());
+
+    constexpr uint64_t kNumFrames = 200;
+    std::vector<std::thread> threads;
+    for (int32_t layerId = 0; layerId < 4; layerId++) {
+        threads.emplace_back([this, layerId] {
+            for (uint64_t frameNumber = 1; frameNumber <= kNumFrames; frameNumber++) {
+                insertTimeRecord(NORMAL_SEQUENCE, layerId, frameNumber, frameNumber * 5000000);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    SFTimeStatsGlobalProto globalProto;
+    ASSERT_TRUE(globalProto.ParseFromString(inputCommand(InputCommand::DUMP_ALL, FMT_PROTO)));
+    ASSERT_EQ(4, globalProto.stats_size());
+    for (const SFTimeStatsLayerProto& layerProto : globalProto.stats()) {
+        EXPECT_EQ(kNumFrames - 1, layerProto.total_frames());
+    }
+}
+
+TEST_F(TimeStatsTest, destroyingTimeStatsStopsDrainThread) {
+    EXPECT_TRUE(inputCommand(InputCommand::ENABLE, FMT_STRING).empty());
+
+    // Leave a partial batch pending, so the drain thread is still waiting for more events.
+    insertTimeRecord(NORMAL_SEQUENCE, LAYER_ID_0, 1, 1000000);
+    insertTimeRecord(NORMAL_SEQUENCE, LAYER_ID_0, 2, 2000000);
+    mTimeStats.reset();
+
+    // Also while the drain thread may be applying a full batch.
+    mTimeStats = std::make_unique<impl::TimeStats>(std::nullopt, std::nullopt);
+    EXPECT_TRUE(inputCommand(InputCommand::ENABLE, FMT_STRING).empty());
+    for (uint64_t frameNumber = 1; frameNumber <= 100; frameNumber++) {
+        insertTimeRecord(NORMAL_SEQUENCE, LAYER_ID_0, frameNumber, frameNumber * 5000000);
+    }
+    mTimeStats.reset();
+}
+
 TEST_F(TimeStatsTest, canSurviveMonkey) {
     if (g_noSlowTests) {
         GTEST_SKIP();
@@ -1088,6 +1088,67 @@ TEST(TransactionHandlerTest, QueueTransaction) {
     EXPECT_EQ(transactionsReadyToBeApplied.front().id, 42u);
 }
 
+TEST(TransactionHandlerTest, QueueTransactionRecordsSignaledAcquireFences) {
+    const auto bufferState = [](Fence::Status status) {
+        const auto fence = sp<mock::MockFence>::make();
+        EXPECT_CALL(*fence, getStatus()).WillRepeatedly(Return(status));
+
+        ResolvedComposerState state;
+        state.state.what = layer_state_t::eBufferChanged;
+        state.state.bufferData =
+                std::make_shared<fake::BufferData>(/* bufferId */ 123L, /* width */ 1,
+                                                   /* height */ 2, /* pixelFormat */ 0,
+                                                   /* outUsage */ 0);
+        state.state.bufferData->acquireFence = fence;
+        state.state.bufferData->flags = BufferData::BufferDataChange::fenceChanged;
+        return state;
+    };
+
+    TransactionHandler handler;
+    TransactionState transaction;
+    transaction.applyToken = sp<BBinder>::make();
+    transaction.states.push_back(bufferState(Fence::Status::Signaled));
+    transaction.states.push_back(bufferState(Fence::Status::Unsignaled));
+    handler.queueTransaction(std::move(transaction));
+
+    const std::vector<TransactionState> transactions = handler.flushTransactions();
+    ASSERT_EQ(transactions.size(), 1u);
+    ASSERT_EQ(transactions[0].states.size(), 2u);
+    EXPECT_TRUE(transactions[0].states[0].acquireFenceSignaled);
+    EXPECT_FALSE(transactions[0].states[1].acquireFenceSignaled);
+}
+
+TEST(TransactionHandlerTest, ReusesDrainedQueuesWithoutRetainingApplyTokens) {
+    TransactionHandler handler;
+    sp<IBinder> firstToken = sp<BBinder>::make();
+    const wp<IBinder> weakFirstToken = firstToken;
+
+    TransactionState transaction;
+    transaction.applyToken = firstToken;
+    transaction.id = 1;
+    handler.queueTransaction(std::move(transaction));
+    firstToken.clear();
+    EXPECT_EQ(handler.flushTransactions().size(), 1u);
+    EXPECT_FALSE(handler.hasPendingTransactions());
+
+    // The drained queue does not keep the apply token alive.
+    EXPECT_EQ(nullptr, weakFirstToken.promote());
+
+    const sp<IBinder> secondToken = sp<BBinder>::make();
+    for (uint64_t id = 2; id <= 3; id++) {
+        TransactionState transaction;
+        transaction.applyToken = secondToken;
+        transaction.id = id;
+        handler.queueTransaction(std::move(transaction));
+    }
+
+    const std::vector<TransactionState> transactions = handler.flushTransactions();
+    ASSERT_EQ(transactions.size(), 2u);
+    EXPECT_EQ(transactions[0].id, 2u);
+    EXPECT_EQ(transactions[1].id, 3u);
+    EXPECT_FALSE(handler.hasPendingTransactions());
+}
+
 TEST(TransactionHandlerTest, TransactionsKeepTrackOfDirectMerges) {
     SurfaceComposerClient::Transaction transaction1, transaction2, transaction3, transaction4;
 
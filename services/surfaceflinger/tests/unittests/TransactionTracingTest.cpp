@@ -43,7 +43,7 @@ protected:
     proto::TransactionTraceEntry bufferFront() {
         std::scoped_lock<std::mutex> lock(mTracing.mTraceLock);
         proto::TransactionTraceEntry entry;
-        entry.ParseFromString(mTracing.mBuffer.front());
+        TransactionTraceRecord::decode(mTracing.mBuffer.front(), &entry);
         return entry;
     }
 
@@ -124,6 +124,51 @@ TEST_F(TransactionTracingTest, addTransactions) {
     verifyEntry(proto.entry(1), secondUpdate.transactions, secondTransactionSetVsyncId);
 }
 
+TEST(TransactionTraceRecordTest, decodesEncodedEntry) {
+    TransactionTraceRecord::Writer writer(/*elapsedRealtimeNanos=*/42, /*vsyncId=*/7,
+                                          /*displaysChanged=*/true);
+    proto::TransactionState transaction;
+    transaction.set_transaction_id(5);
+    transaction.set_pid(2);
+    writer.addTransaction(transaction);
+    proto::LayerCreationArgs layer;
+    layer.set_layer_id(3);
+    writer.addLayer(layer);
+    writer.addDestroyedLayer(4);
+    writer.addDestroyedLayerHandle(5);
+    writer.addDestroyedLayerHandle(6);
+    proto::DisplayInfo display;
+    display.set_layer_stack(1);
+    writer.addDisplay(display);
+    const std::string record = writer.finish();
+
+    const auto header = TransactionTraceRecord::readHeader(record);
+    ASSERT_TRUE(header.has_value());
+    EXPECT_EQ(header->vsyncId, 7);
+    EXPECT_EQ(TransactionTraceRecord::elapsedRealtimeNanos(record), 42);
+
+    proto::TransactionTraceEntry entry;
+    ASSERT_TRUE(TransactionTraceRecord::decode(record, &entry));
+    EXPECT_EQ(entry.elapsed_realtime_nanos(), 42);
+    EXPECT_EQ(entry.vsync_id(), 7);
+    EXPECT_TRUE(entry.displays_changed());
+    ASSERT_EQ(entry.transactions().size(), 1);
+    EXPECT_EQ(entry.transactions(0).transaction_id(), 5u);
+    EXPECT_EQ(entry.transactions(0).pid(), 2);
+    ASSERT_EQ(entry.added_layers().size(), 1);
+    EXPECT_EQ(entry.added_layers(0).layer_id(), 3u);
+    ASSERT_EQ(entry.destroyed_layers().size(), 1);
+    EXPECT_EQ(entry.destroyed_layers(0), 4u);
+    ASSERT_EQ(entry.destroyed_layer_handles().size(), 2);
+    EXPECT_EQ(entry.destroyed_layer_handles(1), 6u);
+    ASSERT_EQ(entry.displays().size(), 1);
+    EXPECT_EQ(entry.displays(0).layer_stack(), 1u);
+
+    proto::TransactionTraceEntry truncatedEntry;
+    EXPECT_FALSE(TransactionTraceRecord::decode(record.substr(0, record.size() - 1),
+                                                &truncatedEntry));
+}
+
 class TransactionTracingLayerHandlingTest : public TransactionTracingTest {
 protected:
     void SetUp() override {
@@ -533,6 +533,28 @@ TEST_F(VSyncDispatchTimerQueueTest, necessaryRearmsWhenModifying) {
     advanceToNextCallback();
 }
 
+TEST_F(VSyncDispatchTimerQueueTest, dumpsDispatchStatsOfGroupedCallbacks) {
+    EXPECT_CALL(mMockClock, alarmAt(_, 600));
+
+    CountingCallback cb0(mDispatch);
+    CountingCallback cb1(mDispatch);
+
+    mDispatch->schedule(cb0, {.workDuration = 400, .readyDuration = 0, .earliestVsync = 1000});
+    mDispatch->schedule(cb1,
+                        {.workDuration = 400 - mDispatchGroupThreshold + 1,
+                         .readyDuration = 0,
+                         .earliestVsync = 1000});
+
+    advanceToNextCallback();
+    ASSERT_THAT(cb0.mCalls.size(), Eq(1));
+    ASSERT_THAT(cb1.mCalls.size(), Eq(1));
+
+    std::string dump;
+    mDispatch->dump(dump);
+    EXPECT_THAT(dump, HasSubstr("timer wakeups: 1 callbacks dispatched: 2"));
+    EXPECT_THAT(dump, HasSubstr("dispatches: 1 mean error:"));
+}
+
 TEST_F(VSyncDispatchTimerQueueTest, modifyIntoGroup) {
     Sequence seq;
     EXPECT_CALL(mMockClock, alarmAt(_, 600)).InSequence(seq);
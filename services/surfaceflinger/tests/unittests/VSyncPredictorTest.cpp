@@ -29,6 +29,7 @@
 #include <gtest/gtest.h>
 #include <algorithm>
 #include <chrono>
+#include <string>
 #include <utility>
 
 using namespace testing;
@@ -323,6 +324,30 @@ TEST_F(VSyncPredictorTest, willBeAccurateUsingPriorResultsForRate) {
     EXPECT_THAT(model.intercept, Eq(0));
 }
 
+TEST_F(VSyncPredictorTest, keepsPriorResultsForRateWhileLearning) {
+    auto const idealPeriod = 100000;
+    auto const realPeriod = 101000;
+    auto const slowPeriod = 400000;
+    auto const simulatedVsyncs =
+            generateVsyncTimestamps(kMinimumSamplesForPrediction, realPeriod, realPeriod);
+
+    tracker.setPeriod(idealPeriod);
+    for (auto const& timestamp : simulatedVsyncs) {
+        tracker.addVsyncTimestamp(timestamp);
+    }
+    EXPECT_THAT(tracker.getVSyncPredictionModel().slope, Eq(realPeriod));
+
+    tracker.setPeriod(slowPeriod);
+    tracker.setPeriod(idealPeriod);
+
+    // A single sample after switching back is not enough to discard what was learned before.
+    EXPECT_TRUE(tracker.addVsyncTimestamp(simulatedVsyncs.back() + realPeriod));
+    EXPECT_TRUE(tracker.needsMoreSamples());
+    auto model = tracker.getVSyncPredictionModel();
+    EXPECT_THAT(model.slope, Eq(realPeriod));
+    EXPECT_THAT(model.intercept, Eq(0));
+}
+
 TEST_F(VSyncPredictorTest, idealModelPredictionsBeforeRegressionModelIsBuilt) {
     auto const simulatedVsyncs =
             generateVsyncTimestamps(kMinimumSamplesForPrediction + 1, mPeriod, 0);
@@ -545,8 +570,8 @@ TEST_F(VSyncPredictorTest, robustToDuplicateTimestamps_60hzRealTraceData) {
             198857715631, 198890885797, 198924199640, 198940873834, 198974204401,
     };
     auto constexpr idealPeriod = 16'666'666;
-    auto constexpr expectedPeriod = 16'644'742;
-    auto constexpr expectedIntercept = 125'626;
+    auto constexpr expectedPeriod = 16'661'393;
+    auto constexpr expectedIntercept = -61'364;
 
     tracker.setPeriod(idealPeriod);
     for (auto const& timestamp : simulatedVsyncs) {
@@ -557,6 +582,29 @@ TEST_F(VSyncPredictorTest, robustToDuplicateTimestamps_60hzRealTraceData) {
     EXPECT_THAT(intercept, IsCloseTo(expectedIntercept, mMaxRoundingError));
 }
 
+TEST_F(VSyncPredictorTest, robustToInPhaseOutliers) {
+    // Late samples that are still close enough to a vsync to pass validation should not skew
+    // the model.
+    auto constexpr period = 16'666'666;
+    auto constexpr lateness = 3'000'000;
+    auto simulatedVsyncs = generateVsyncTimestamps(kHistorySize, period, 0);
+    simulatedVsyncs[7] += lateness;
+    simulatedVsyncs[9] += lateness;
+
+    tracker.setPeriod(period);
+    for (auto const& timestamp : simulatedVsyncs) {
+        EXPECT_TRUE(tracker.addVsyncTimestamp(timestamp));
+    }
+    auto [slope, intercept] = tracker.getVSyncPredictionModel();
+    EXPECT_THAT(slope, IsCloseTo(period, mMaxRoundingError));
+    EXPECT_THAT(intercept, IsCloseTo(0, mMaxRoundingError));
+
+    std::string dump;
+    tracker.dump(dump);
+    EXPECT_THAT(dump,
+                HasSubstr("Prediction error: samples = 4, mean = 1500.00us, max = 3000.00us"));
+}
+
 TEST_F(VSyncPredictorTest, setRenderRateIsRespected) {
     auto last = mNow;
     for (auto i = 0u; i < kMinimumSamplesForPrediction; i++) {
@@ -59,6 +59,7 @@ public:
                 (DisplayId displayId, TimePoint earliestFrameStartTime));
     MOCK_METHOD(void, setFrameDelay, (Duration frameDelayDuration), (override));
     MOCK_METHOD(void, setCommitStart, (TimePoint commitStartTime), (override));
+    MOCK_METHOD(void, setCompositeStart, (TimePoint compositeStartTime), (override));
     MOCK_METHOD(void, setCompositeEnd, (TimePoint compositeEndTime), (override));
     MOCK_METHOD(void, setDisplays, (std::vector<DisplayId> & displayIds), (override));
     MOCK_METHOD(void, setTotalFrameTargetWorkDuration, (Duration targetDuration), (override));
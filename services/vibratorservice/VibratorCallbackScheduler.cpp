@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <chrono>
 #include <thread>
 
@@ -64,7 +65,8 @@ void CallbackScheduler::schedule(std::function<void()> callback, std::chrono::mi
         if (mCallbackThread == nullptr) {
             mCallbackThread = std::make_unique<std::thread>(&CallbackScheduler::loop, this);
         }
-        mQueue.emplace(DelayedCallback(callback, delay));
+        mQueue.emplace_back(std::move(callback), delay);
+        std::push_heap(mQueue.begin(), mQueue.end(), std::greater<DelayedCallback>());
     }
     mCondition.notify_all();
 }
@@ -76,9 +78,10 @@ void CallbackScheduler::loop() {
             // Destructor was called, so let the callback thread die.
             break;
         }
-        while (!mQueue.empty() && mQueue.top().isExpired()) {
-            DelayedCallback callback = mQueue.top();
-            mQueue.pop();
+        while (!mQueue.empty() && mQueue.front().isExpired()) {
+            std::pop_heap(mQueue.begin(), mQueue.end(), std::greater<DelayedCallback>());
+            DelayedCallback callback = std::move(mQueue.back());
+            mQueue.pop_back();
             lock.unlock();
             callback.run();
             lock.lock();
@@ -88,7 +91,7 @@ void CallbackScheduler::loop() {
             mCondition.wait(mMutex);
         } else {
             // Wait until next callback expires, or a new one is scheduled.
-            mCondition.wait_until(mMutex, mQueue.top().getExpiration());
+            mCondition.wait_until(mMutex, mQueue.front().getExpiration());
         }
     }
 }
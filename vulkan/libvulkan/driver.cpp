@@ -659,6 +659,7 @@ void CreateInfoWrapper::FilterExtension(const char* name) {
             case ProcHook::KHR_swapchain:
             case ProcHook::EXT_hdr_metadata:
             case ProcHook::EXT_swapchain_maintenance1:
+            case ProcHook::EXT_present_mode_fifo_latest_ready:
             case ProcHook::ANDROID_external_memory_android_hardware_buffer:
             case ProcHook::ANDROID_native_buffer:
             case ProcHook::GOOGLE_display_timing:
@@ -695,6 +696,7 @@ void CreateInfoWrapper::FilterExtension(const char* name) {
             case ProcHook::KHR_incremental_present:
             case ProcHook::KHR_shared_presentable_image:
             case ProcHook::GOOGLE_display_timing:
+            case ProcHook::EXT_present_mode_fifo_latest_ready:
                 hook_extensions_.set(ext_bit);
                 // return now as these extensions do not require HAL support
                 return;
@@ -1214,6 +1216,12 @@ VkResult EnumerateDeviceExtensionProperties(
                 VK_EXT_SWAPCHAIN_MAINTENANCE_1_SPEC_VERSION});
     }
 
+    if (IsFifoLatestReadySupported()) {
+        loader_extensions.push_back({
+                VK_EXT_PRESENT_MODE_FIFO_LATEST_READY_EXTENSION_NAME,
+                VK_EXT_PRESENT_MODE_FIFO_LATEST_READY_SPEC_VERSION});
+    }
+
     // enumerate our extensions first
     if (!pLayerName && pProperties) {
         uint32_t count = std::min(
@@ -1457,6 +1465,30 @@ VkResult CreateDevice(VkPhysicalDevice physicalDevice,
 
     data->driver_device = dev;
 
+    if (AcquirePipelineCacheStore()) {
+        ATRACE_BEGIN("CreateImplicitPipelineCache");
+        data->pipeline_cache_key = GetPipelineCacheKey(properties);
+        const std::vector<uint8_t> initial_data =
+            LoadPipelineCacheData(data->pipeline_cache_key);
+        const VkPipelineCacheCreateInfo cache_info = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .initialDataSize = initial_data.size(),
+            .pInitialData = initial_data.data(),
+        };
+        // The implicit cache is internal to the loader, so it uses the
+        // driver's allocator rather than the app's.
+        if (data->driver.CreatePipelineCache(dev, &cache_info, nullptr,
+                                             &data->implicit_pipeline_cache) !=
+            VK_SUCCESS) {
+            ALOGW("Failed to create the implicit pipeline cache");
+            data->implicit_pipeline_cache = VK_NULL_HANDLE;
+            ReleasePipelineCacheStore();
+        }
+        ATRACE_END();
+    }
+
     *pDevice = dev;
 
     // TODO(b/259516419) avoid getting stats from hwui
@@ -1523,6 +1555,29 @@ VkResult CreateDevice(VkPhysicalDevice physicalDevice,
 
 void DestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator) {
     DeviceData& data = GetData(device);
+
+    if (data.implicit_pipeline_cache != VK_NULL_HANDLE) {
+        ATRACE_BEGIN("DestroyImplicitPipelineCache");
+        std::vector<uint8_t> cache_data;
+        size_t size = 0;
+        if (data.driver.GetPipelineCacheData(
+                device, data.implicit_pipeline_cache, &size, nullptr) ==
+                VK_SUCCESS &&
+            size > 0) {
+            cache_data.resize(size);
+            if (data.driver.GetPipelineCacheData(
+                    device, data.implicit_pipeline_cache, &size,
+                    cache_data.data()) == VK_SUCCESS) {
+                cache_data.resize(size);
+                StorePipelineCacheData(data.pipeline_cache_key, cache_data);
+            }
+        }
+        data.driver.DestroyPipelineCache(device, data.implicit_pipeline_cache,
+                                         nullptr);
+        ReleasePipelineCacheStore();
+        ATRACE_END();
+    }
+
     data.driver.DestroyDevice(device, pAllocator);
 
     VkAllocationCallbacks local_allocator;
@@ -1671,6 +1726,72 @@ VkResult QueueSubmit(VkQueue queue,
     return data.driver.QueueSubmit(queue, submitCount, pSubmits, fence);
 }
 
+VkResult CreatePipelineCache(VkDevice device,
+                             const VkPipelineCacheCreateInfo* pCreateInfo,
+                             const VkAllocationCallbacks* pAllocator,
+                             VkPipelineCache* pPipelineCache) {
+    ATRACE_CALL();
+
+    const auto& data = GetData(device);
+    if (data.implicit_pipeline_cache == VK_NULL_HANDLE ||
+        pCreateInfo->initialDataSize != 0) {
+        return data.driver.CreatePipelineCache(device, pCreateInfo, pAllocator,
+                                               pPipelineCache);
+    }
+
+    // Seed the app's cache with the pipelines created so far, including the
+    // ones loaded from the previous runs of the app.
+    std::vector<uint8_t> initial_data;
+    size_t size = 0;
+    if (data.driver.GetPipelineCacheData(device, data.implicit_pipeline_cache,
+                                         &size, nullptr) == VK_SUCCESS &&
+        size > 0) {
+        initial_data.resize(size);
+        if (data.driver.GetPipelineCacheData(
+                device, data.implicit_pipeline_cache, &size,
+                initial_data.data()) != VK_SUCCESS) {
+            size = 0;
+        }
+    }
+
+    VkPipelineCacheCreateInfo create_info = *pCreateInfo;
+    create_info.initialDataSize = size;
+    create_info.pInitialData = size ? initial_data.data() : nullptr;
+    return data.driver.CreatePipelineCache(device, &create_info, pAllocator,
+                                           pPipelineCache);
+}
+
+VkResult CreateGraphicsPipelines(
+    VkDevice device,
+    VkPipelineCache pipelineCache,
+    uint32_t createInfoCount,
+    const VkGraphicsPipelineCreateInfo* pCreateInfos,
+    const VkAllocationCallbacks* pAllocator,
+    VkPipeline* pPipelines) {
+    const auto& data = GetData(device);
+    if (pipelineCache == VK_NULL_HANDLE)
+        pipelineCache = data.implicit_pipeline_cache;
+
+    return data.driver.CreateGraphicsPipelines(device, pipelineCache,
+                                               createInfoCount, pCreateInfos,
+                                               pAllocator, pPipelines);
+}
+
+VkResult CreateComputePipelines(VkDevice device,
+                                VkPipelineCache pipelineCache,
+                                uint32_t createInfoCount,
+                                const VkComputePipelineCreateInfo* pCreateInfos,
+                                const VkAllocationCallbacks* pAllocator,
+                                VkPipeline* pPipelines) {
+    const auto& data = GetData(device);
+    if (pipelineCache == VK_NULL_HANDLE)
+        pipelineCache = data.implicit_pipeline_cache;
+
+    return data.driver.CreateComputePipelines(device, pipelineCache,
+                                              createInfoCount, pCreateInfos,
+                                              pAllocator, pPipelines);
+}
+
 void GetPhysicalDeviceFeatures2(VkPhysicalDevice physicalDevice,
                                 VkPhysicalDeviceFeatures2* pFeatures) {
     ATRACE_CALL();
@@ -1717,6 +1838,12 @@ void GetPhysicalDeviceFeatures2(VkPhysicalDevice physicalDevice,
                 smf->swapchainMaintenance1 = true;
             } break;
 
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_MODE_FIFO_LATEST_READY_FEATURES_EXT: {
+                auto flrf = reinterpret_cast<
+                        VkPhysicalDevicePresentModeFifoLatestReadyFeaturesEXT*>(pFeats);
+                flrf->presentModeFifoLatestReady = IsFifoLatestReadySupported();
+            } break;
+
             default:
                 break;
         }
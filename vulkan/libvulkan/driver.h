@@ -30,6 +30,7 @@
 #include "api_gen.h"
 #include "driver_gen.h"
 #include "debug_report.h"
+#include "pipeline_cache.h"
 #include "swapchain.h"
 
 namespace vulkan {
@@ -87,7 +88,9 @@ struct DeviceData {
         : opaque_api_data(),
           allocator(alloc),
           debug_report_callbacks(debug_report_callbacks_),
-          driver() {}
+          driver(),
+          implicit_pipeline_cache(VK_NULL_HANDLE),
+          pipeline_cache_key() {}
 
     api::DeviceData opaque_api_data;
 
@@ -98,6 +101,10 @@ struct DeviceData {
 
     VkDevice driver_device;
     DeviceDriverTable driver;
+
+    // VK_NULL_HANDLE unless the implicit pipeline cache is enabled.
+    VkPipelineCache implicit_pipeline_cache;
+    PipelineCacheKey pipeline_cache_key;
 };
 
 bool OpenHAL();
@@ -156,6 +163,25 @@ VKAPI_ATTR VkResult QueueSubmit(VkQueue queue,
                                 uint32_t submitCount,
                                 const VkSubmitInfo* pSubmits,
                                 VkFence fence);
+VKAPI_ATTR VkResult
+CreatePipelineCache(VkDevice device,
+                    const VkPipelineCacheCreateInfo* pCreateInfo,
+                    const VkAllocationCallbacks* pAllocator,
+                    VkPipelineCache* pPipelineCache);
+VKAPI_ATTR VkResult
+CreateGraphicsPipelines(VkDevice device,
+                        VkPipelineCache pipelineCache,
+                        uint32_t createInfoCount,
+                        const VkGraphicsPipelineCreateInfo* pCreateInfos,
+                        const VkAllocationCallbacks* pAllocator,
+                        VkPipeline* pPipelines);
+VKAPI_ATTR VkResult
+CreateComputePipelines(VkDevice device,
+                       VkPipelineCache pipelineCache,
+                       uint32_t createInfoCount,
+                       const VkComputePipelineCreateInfo* pCreateInfos,
+                       const VkAllocationCallbacks* pAllocator,
+                       VkPipeline* pPipelines);
 VKAPI_ATTR void GetPhysicalDeviceFeatures2(
     VkPhysicalDevice physicalDevice,
     VkPhysicalDeviceFeatures2* pFeatures);
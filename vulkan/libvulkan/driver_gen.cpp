@@ -224,6 +224,13 @@ const ProcHook g_proc_hooks[] = {
         reinterpret_cast<PFN_vkVoidFunction>(CreateAndroidSurfaceKHR),
         nullptr,
     },
+    {
+        "vkCreateComputePipelines",
+        ProcHook::DEVICE,
+        ProcHook::EXTENSION_CORE_1_0,
+        reinterpret_cast<PFN_vkVoidFunction>(CreateComputePipelines),
+        nullptr,
+    },
     {
         "vkCreateDebugReportCallbackEXT",
         ProcHook::INSTANCE,
@@ -238,6 +245,13 @@ const ProcHook g_proc_hooks[] = {
         reinterpret_cast<PFN_vkVoidFunction>(CreateDevice),
         nullptr,
     },
+    {
+        "vkCreateGraphicsPipelines",
+        ProcHook::DEVICE,
+        ProcHook::EXTENSION_CORE_1_0,
+        reinterpret_cast<PFN_vkVoidFunction>(CreateGraphicsPipelines),
+        nullptr,
+    },
     {
         "vkCreateInstance",
         ProcHook::GLOBAL,
@@ -245,6 +259,13 @@ const ProcHook g_proc_hooks[] = {
         reinterpret_cast<PFN_vkVoidFunction>(CreateInstance),
         nullptr,
     },
+    {
+        "vkCreatePipelineCache",
+        ProcHook::DEVICE,
+        ProcHook::EXTENSION_CORE_1_0,
+        reinterpret_cast<PFN_vkVoidFunction>(CreatePipelineCache),
+        nullptr,
+    },
     {
         "vkCreateSwapchainKHR",
         ProcHook::DEVICE,
@@ -605,6 +626,7 @@ ProcHook::Extension GetProcHookExtension(const char* name) {
     if (strcmp(name, "VK_KHR_swapchain") == 0) return ProcHook::KHR_swapchain;
     if (strcmp(name, "VK_EXT_swapchain_maintenance1") == 0) return ProcHook::EXT_swapchain_maintenance1;
     if (strcmp(name, "VK_EXT_surface_maintenance1") == 0) return ProcHook::EXT_surface_maintenance1;
+    if (strcmp(name, "VK_EXT_present_mode_fifo_latest_ready") == 0) return ProcHook::EXT_present_mode_fifo_latest_ready;
     if (strcmp(name, "VK_ANDROID_external_memory_android_hardware_buffer") == 0) return ProcHook::ANDROID_external_memory_android_hardware_buffer;
     if (strcmp(name, "VK_KHR_bind_memory2") == 0) return ProcHook::KHR_bind_memory2;
     if (strcmp(name, "VK_KHR_get_physical_device_properties2") == 0) return ProcHook::KHR_get_physical_device_properties2;
@@ -691,6 +713,11 @@ bool InitDriverTable(VkDevice dev,
     INIT_PROC(true, dev, QueueSubmit);
     INIT_PROC(true, dev, CreateImage);
     INIT_PROC(true, dev, DestroyImage);
+    INIT_PROC(true, dev, CreatePipelineCache);
+    INIT_PROC(true, dev, DestroyPipelineCache);
+    INIT_PROC(true, dev, GetPipelineCacheData);
+    INIT_PROC(true, dev, CreateGraphicsPipelines);
+    INIT_PROC(true, dev, CreateComputePipelines);
     INIT_PROC(true, dev, AllocateCommandBuffers);
     INIT_PROC_EXT(KHR_external_fence_fd, true, dev, ImportFenceFdKHR);
     INIT_PROC(false, dev, BindImageMemory2);
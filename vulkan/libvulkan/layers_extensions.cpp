@@ -324,6 +324,10 @@ void* LayerLibrary::GetGPA(const Layer& layer, const std::string_view gpa_name)
 std::vector<LayerLibrary> g_layer_libraries;
 std::vector<Layer> g_instance_layers;
 
+// Set by DiscoverLayers(), and cleared once the layer paths have been scanned.
+std::mutex g_discovery_mutex;
+bool g_discovery_pending = false;
+
 void AddLayerLibrary(const std::string& path, const std::string& filename) {
     LayerLibrary library(path + "/" + filename, filename);
     if (!library.Open())
@@ -456,9 +460,15 @@ void* GetLayerGetProcAddr(const Layer& layer,
     return library.GetGPA(layer, gpa_name);
 }
 
-}  // anonymous namespace
+// Scanning the layer paths opens every layer library found to enumerate its
+// layers, so it is only done once layers are first asked for. Applications
+// that neither enable nor enumerate layers never load any.
+void EnsureLayersDiscovered() {
+    std::lock_guard<std::mutex> lock(g_discovery_mutex);
+    if (!g_discovery_pending)
+        return;
+    g_discovery_pending = false;
 
-void DiscoverLayers() {
     ATRACE_CALL();
 
     if (android::GraphicsEnv::getInstance().isDebuggable()) {
@@ -468,7 +478,15 @@ void DiscoverLayers() {
         DiscoverLayersInPathList(android::GraphicsEnv::getInstance().getLayerPaths());
 }
 
+}  // anonymous namespace
+
+void DiscoverLayers() {
+    std::lock_guard<std::mutex> lock(g_discovery_mutex);
+    g_discovery_pending = true;
+}
+
 uint32_t GetLayerCount() {
+    EnsureLayersDiscovered();
     return static_cast<uint32_t>(g_instance_layers.size());
 }
 
@@ -477,6 +495,7 @@ const Layer& GetLayer(uint32_t index) {
 }
 
 const Layer* FindLayer(const char* name) {
+    EnsureLayersDiscovered();
     auto layer =
         std::find_if(g_instance_layers.cbegin(), g_instance_layers.cend(),
                      [=](const Layer& entry) {
@@ -43,6 +43,8 @@ class LayerRef {
     const Layer* layer_;
 };
 
+// Schedules the layer paths to be scanned by the next GetLayerCount() or
+// FindLayer(), which is where layer libraries get loaded for enumeration.
 void DiscoverLayers();
 
 uint32_t GetLayerCount();
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+
+#include "pipeline_cache.h"
+
+#include <MultifileBlobCache.h>
+#include <android-base/properties.h>
+#include <graphicsenv/GraphicsEnv.h>
+#include <log/log.h>
+#include <string.h>
+#include <utils/Trace.h>
+
+#include <memory>
+#include <mutex>
+
+namespace vulkan {
+namespace driver {
+
+namespace {
+
+// Pipeline cache data holds whole pipelines, so it can be much larger than
+// the EGL blob cache entries.
+constexpr size_t kMaxPipelineCacheKeySize = sizeof(PipelineCacheKey);
+constexpr size_t kMaxPipelineCacheValueSize = 16 * 1024 * 1024;
+constexpr size_t kMaxPipelineCacheTotalSize = 32 * 1024 * 1024;
+
+std::mutex g_store_mutex;
+// Shared by all devices of the process, as they persist into the same files.
+std::unique_ptr<android::MultifileBlobCache> g_store;
+uint32_t g_store_refs = 0;
+
+}  // anonymous namespace
+
+PipelineCacheKey GetPipelineCacheKey(
+    const VkPhysicalDeviceProperties& properties) {
+    PipelineCacheKey key = {};
+    memcpy(key.pipelineCacheUUID, properties.pipelineCacheUUID,
+           sizeof(key.pipelineCacheUUID));
+    key.vendorID = properties.vendorID;
+    key.deviceID = properties.deviceID;
+    key.driverVersion = properties.driverVersion;
+    return key;
+}
+
+bool AcquirePipelineCacheStore() {
+    static const bool enabled =
+        android::base::GetBoolProperty("ro.vulkan.pipelinecache.implicit",
+                                       false);
+    if (!enabled)
+        return false;
+
+    const std::string& path =
+        android::GraphicsEnv::getInstance().getPipelineCachePath();
+    if (path.empty())
+        return false;
+
+    std::lock_guard<std::mutex> lock(g_store_mutex);
+    if (!g_store) {
+        ATRACE_NAME("CreatePipelineCacheStore");
+        g_store = std::make_unique<android::MultifileBlobCache>(
+            kMaxPipelineCacheKeySize, kMaxPipelineCacheValueSize,
+            kMaxPipelineCacheTotalSize, path);
+    }
+    g_store_refs++;
+    return true;
+}
+
+void ReleasePipelineCacheStore() {
+    std::lock_guard<std::mutex> lock(g_store_mutex);
+    if (--g_store_refs == 0) {
+        ATRACE_NAME("DestroyPipelineCacheStore");
+        g_store->finish();
+        g_store = nullptr;
+    }
+}
+
+std::vector<uint8_t> LoadPipelineCacheData(const PipelineCacheKey& key) {
+    ATRACE_CALL();
+
+    std::lock_guard<std::mutex> lock(g_store_mutex);
+    // A zero sized get returns the size of the entry without copying it.
+    EGLsizeiANDROID size = g_store->get(&key, sizeof(key), nullptr, 0);
+    if (size <= 0)
+        return {};
+
+    std::vector<uint8_t> data(static_cast<size_t>(size));
+    if (g_store->get(&key, sizeof(key), data.data(), size) != size)
+        return {};
+
+    ALOGV("Loaded %zu bytes of implicit pipeline cache data", data.size());
+    return data;
+}
+
+void StorePipelineCacheData(const PipelineCacheKey& key,
+                            const std::vector<uint8_t>& data) {
+    ATRACE_CALL();
+
+    if (data.empty() || data.size() > kMaxPipelineCacheValueSize)
+        return;
+
+    std::lock_guard<std::mutex> lock(g_store_mutex);
+    g_store->set(&key, sizeof(key), data.data(),
+                 static_cast<EGLsizeiANDROID>(data.size()));
+    ALOGV("Stored %zu bytes of implicit pipeline cache data", data.size());
+}
+
+}  // namespace driver
+}  // namespace vulkan
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIBVULKAN_PIPELINE_CACHE_H
+#define LIBVULKAN_PIPELINE_CACHE_H 1
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+namespace vulkan {
+namespace driver {
+
+// The implicit pipeline cache is a VkPipelineCache the loader creates for each
+// device. It is used for pipelines the app creates without a pipeline cache,
+// seeds the pipeline caches the app creates without initial data, and is
+// persisted per app when the device is destroyed.
+
+// Identifies the pipeline cache data of a physical device. Drivers ignore
+// incompatible initial data, so this only has to keep the data of different
+// drivers from evicting each other.
+struct PipelineCacheKey {
+    uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint32_t driverVersion;
+};
+
+PipelineCacheKey GetPipelineCacheKey(const VkPhysicalDeviceProperties& properties);
+
+// Returns true if the implicit pipeline cache is enabled for this app. Each
+// successful call must be balanced by a call to ReleasePipelineCacheStore.
+bool AcquirePipelineCacheStore();
+void ReleasePipelineCacheStore();
+
+// Load and store the persisted pipeline cache data. The store must be
+// acquired.
+std::vector<uint8_t> LoadPipelineCacheData(const PipelineCacheKey& key);
+void StorePipelineCacheData(const PipelineCacheKey& key,
+                            const std::vector<uint8_t>& data);
+
+}  // namespace driver
+}  // namespace vulkan
+
+#endif  // LIBVULKAN_PIPELINE_CACHE_H
@@ -16,6 +16,7 @@
 
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 
+#include <android-base/properties.h>
 #include <android/hardware/graphics/common/1.0/types.h>
 #include <grallocusage/GrallocUsageConversion.h>
 #include <graphicsenv/GraphicsEnv.h>
@@ -261,6 +262,8 @@ struct Swapchain {
         : surface(surface_),
           num_images(num_images_),
           mailbox_mode(present_mode == VK_PRESENT_MODE_MAILBOX_KHR),
+          fifo_latest_ready_mode(present_mode ==
+                                 VK_PRESENT_MODE_FIFO_LATEST_READY_EXT),
           pre_transform(pre_transform_),
           frame_timestamps_enabled(false),
           refresh_duration(refresh_duration_),
@@ -286,6 +289,7 @@ struct Swapchain {
     Surface& surface;
     uint32_t num_images;
     bool mailbox_mode;
+    bool fifo_latest_ready_mode;
     int pre_transform;
     bool frame_timestamps_enabled;
     int64_t refresh_duration;
@@ -592,6 +596,17 @@ android_dataspace GetNativeDataspace(VkColorSpaceKHR colorspace,
 
 }  // anonymous namespace
 
+// FIFO_LATEST_READY is FIFO, except that frames which are ready when a newer
+// frame is also ready are dropped instead of being presented one vsync
+// later. SurfaceFlinger only applies backpressure to buffers with an auto
+// timestamp, so giving every buffer an explicit one lets it latch the latest
+// ready buffer of the layer at each vsync.
+bool IsFifoLatestReadySupported() {
+    static const bool supported =
+        android::base::GetBoolProperty("ro.vulkan.fifo_latest_ready", false);
+    return supported;
+}
+
 VKAPI_ATTR
 VkResult CreateAndroidSurfaceKHR(
     VkInstance instance,
@@ -1047,6 +1062,15 @@ VkResult GetPhysicalDeviceSurfaceCapabilities2KHR(
                     case VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR:
                         compatibleModes.push_back(VK_PRESENT_MODE_SHARED_DEMAND_REFRESH_KHR);
                         break;
+                    // FIFO and FIFO_LATEST_READY only differ in the buffer
+                    // timestamps set at present time.
+                    case VK_PRESENT_MODE_FIFO_KHR:
+                        if (IsFifoLatestReadySupported())
+                            compatibleModes.push_back(VK_PRESENT_MODE_FIFO_LATEST_READY_EXT);
+                        break;
+                    case VK_PRESENT_MODE_FIFO_LATEST_READY_EXT:
+                        compatibleModes.push_back(VK_PRESENT_MODE_FIFO_KHR);
+                        break;
                     default:
                         // Other modes are only compatible with themselves.
                         // TODO: consider whether switching between FIFO and MAILBOX is reasonable
@@ -1220,6 +1244,8 @@ VkResult GetPhysicalDeviceSurfacePresentModesKHR(VkPhysicalDevice pdev,
         if (min_undequeued_buffers + 1 < max_buffer_count)
             present_modes.push_back(VK_PRESENT_MODE_MAILBOX_KHR);
         present_modes.push_back(VK_PRESENT_MODE_FIFO_KHR);
+        if (IsFifoLatestReadySupported())
+            present_modes.push_back(VK_PRESENT_MODE_FIFO_LATEST_READY_EXT);
     }
 
     VkPhysicalDevicePresentationPropertiesANDROID present_properties;
@@ -1379,6 +1405,16 @@ VkResult CreateSwapchainKHR(VkDevice device,
         return VK_ERROR_INITIALIZATION_FAILED;
     }
 
+    if (create_info->presentMode == VK_PRESENT_MODE_FIFO_LATEST_READY_EXT &&
+        !GetData(device)
+             .hook_extensions[ProcHook::EXT_present_mode_fifo_latest_ready]) {
+        ALOGE(
+            "CreateSwapchainKHR(VkSwapchainCreateInfoKHR.presentMode = "
+            "FIFO_LATEST_READY) failed: "
+            "VK_EXT_present_mode_fifo_latest_ready is not enabled");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
     ALOGV_IF(create_info->imageArrayLayers != 1,
              "swapchain imageArrayLayers=%u not supported",
              create_info->imageArrayLayers);
@@ -1387,6 +1423,7 @@ VkResult CreateSwapchainKHR(VkDevice device,
              create_info->preTransform);
     ALOGV_IF(!(create_info->presentMode == VK_PRESENT_MODE_FIFO_KHR ||
                create_info->presentMode == VK_PRESENT_MODE_MAILBOX_KHR ||
+               create_info->presentMode == VK_PRESENT_MODE_FIFO_LATEST_READY_EXT ||
                create_info->presentMode == VK_PRESENT_MODE_SHARED_DEMAND_REFRESH_KHR ||
                create_info->presentMode == VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR),
              "swapchain presentMode=%u not supported",
@@ -2144,8 +2181,19 @@ static void SetSwapchainFrameTimestamp(Swapchain &swapchain, const VkPresentTime
 }
 
 // EXT_swapchain_maintenance1 present mode change
-static bool SetSwapchainPresentMode(ANativeWindow *window, VkPresentModeKHR mode) {
-    // There is no dynamic switching between non-shared present modes.
+static bool SetSwapchainPresentMode(Swapchain& swapchain,
+                                    ANativeWindow *window,
+                                    VkPresentModeKHR mode) {
+    // Switching between FIFO and FIFO_LATEST_READY only changes how the
+    // buffers are timestamped when they are queued.
+    if (mode == VK_PRESENT_MODE_FIFO_KHR ||
+        mode == VK_PRESENT_MODE_FIFO_LATEST_READY_EXT) {
+        swapchain.fifo_latest_ready_mode =
+            mode == VK_PRESENT_MODE_FIFO_LATEST_READY_EXT;
+        return true;
+    }
+
+    // There is no other dynamic switching between non-shared present modes.
     // All we support is switching between demand and continuous refresh.
     if (!IsSharedPresentMode(mode))
         return true;
@@ -2222,10 +2270,16 @@ static VkResult PresentOneSwapchain(
                 SetSwapchainFrameTimestamp(swapchain, pTime);
             }
             if (pPresentMode) {
-                if (!SetSwapchainPresentMode(window, *pPresentMode))
+                if (!SetSwapchainPresentMode(swapchain, window, *pPresentMode))
                     swapchain_result = WorstPresentResult(swapchain_result,
                         VK_ERROR_SURFACE_LOST_KHR);
             }
+            if (swapchain.fifo_latest_ready_mode &&
+                !(pTime && pTime->desiredPresentTime)) {
+                // Ready as soon as its fence signals, see IsFifoLatestReadySupported.
+                native_window_set_buffers_timestamp(
+                    window, systemTime(SYSTEM_TIME_MONOTONIC));
+            }
 
             err = window->queueBuffer(window, img.buffer.get(), fence);
             // queueBuffer always closes fence, even on error
@@ -19,9 +19,29 @@
 
 #include <vulkan/vulkan.h>
 
+#ifndef VK_EXT_present_mode_fifo_latest_ready
+// VK_EXT_present_mode_fifo_latest_ready is newer than the Vulkan headers.
+#define VK_EXT_present_mode_fifo_latest_ready 1
+#define VK_EXT_PRESENT_MODE_FIFO_LATEST_READY_SPEC_VERSION 1
+#define VK_EXT_PRESENT_MODE_FIFO_LATEST_READY_EXTENSION_NAME "VK_EXT_present_mode_fifo_latest_ready"
+constexpr VkPresentModeKHR VK_PRESENT_MODE_FIFO_LATEST_READY_EXT =
+    static_cast<VkPresentModeKHR>(1000361000);
+constexpr VkStructureType
+    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_MODE_FIFO_LATEST_READY_FEATURES_EXT =
+        static_cast<VkStructureType>(1000361000);
+typedef struct VkPhysicalDevicePresentModeFifoLatestReadyFeaturesEXT {
+    VkStructureType sType;
+    void* pNext;
+    VkBool32 presentModeFifoLatestReady;
+} VkPhysicalDevicePresentModeFifoLatestReadyFeaturesEXT;
+#endif
+
 namespace vulkan {
 namespace driver {
 
+// Whether VK_EXT_present_mode_fifo_latest_ready is exposed on this device.
+bool IsFifoLatestReadySupported();
+
 // clang-format off
 VKAPI_ATTR VkResult CreateAndroidSurfaceKHR(VkInstance instance, const VkAndroidSurfaceCreateInfoKHR* pCreateInfo, const VkAllocationCallbacks* allocator, VkSurfaceKHR* surface);
 VKAPI_ATTR void DestroySurfaceKHR(VkInstance instance, VkSurfaceKHR surface, const VkAllocationCallbacks* allocator);
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <gui/BufferItemConsumer.h>
+#include <gui/BufferQueue.h>
+#include <gui/Surface.h>
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace android {
+namespace {
+
+constexpr const char* kFifoLatestReadyExtension = "VK_EXT_present_mode_fifo_latest_ready";
+constexpr VkPresentModeKHR kFifoLatestReadyMode = static_cast<VkPresentModeKHR>(1000361000);
+
+class SwapchainTest : public testing::Test {
+protected:
+    void SetUp() override {
+        const char* instanceExtensions[] = {VK_KHR_SURFACE_EXTENSION_NAME,
+                                            VK_KHR_ANDROID_SURFACE_EXTENSION_NAME};
+        VkApplicationInfo appInfo = {};
+        appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+        appInfo.apiVersion = VK_API_VERSION_1_1;
+        VkInstanceCreateInfo instanceInfo = {};
+        instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        instanceInfo.pApplicationInfo = &appInfo;
+        instanceInfo.enabledExtensionCount = 2;
+        instanceInfo.ppEnabledExtensionNames = instanceExtensions;
+        if (vkCreateInstance(&instanceInfo, nullptr, &mInstance) != VK_SUCCESS) {
+            GTEST_SKIP() << "Vulkan is not supported";
+        }
+
+        uint32_t count = 1;
+        const VkResult result = vkEnumeratePhysicalDevices(mInstance, &count, &mPhysicalDevice);
+        if ((result != VK_SUCCESS && result != VK_INCOMPLETE) || count == 0) {
+            GTEST_SKIP() << "No Vulkan physical device";
+        }
+
+        sp<IGraphicBufferProducer> producer;
+        sp<IGraphicBufferConsumer> consumer;
+        BufferQueue::createBufferQueue(&producer, &consumer);
+        mConsumer = sp<BufferItemConsumer>::make(consumer, GRALLOC_USAGE_HW_COMPOSER);
+        mWindow = sp<Surface>::make(producer);
+
+        VkAndroidSurfaceCreateInfoKHR surfaceInfo = {};
+        surfaceInfo.sType = VK_STRUCTURE_TYPE_ANDROID_SURFACE_CREATE_INFO_KHR;
+        surfaceInfo.window = mWindow.get();
+        ASSERT_EQ(VK_SUCCESS, vkCreateAndroidSurfaceKHR(mInstance, &surfaceInfo, nullptr, &mSurface));
+    }
+
+    void TearDown() override {
+        if (mDevice) vkDestroyDevice(mDevice, nullptr);
+        if (mSurface) vkDestroySurfaceKHR(mInstance, mSurface, nullptr);
+        if (mInstance) vkDestroyInstance(mInstance, nullptr);
+    }
+
+    bool isFifoLatestReadyExtensionAdvertised() {
+        uint32_t count = 0;
+        vkEnumerateDeviceExtensionProperties(mPhysicalDevice, nullptr, &count, nullptr);
+        std::vector<VkExtensionProperties> extensions(count);
+        vkEnumerateDeviceExtensionProperties(mPhysicalDevice, nullptr, &count, extensions.data());
+        return std::any_of(extensions.begin(), extensions.end(), [](const auto& extension) {
+            return strcmp(extension.extensionName, kFifoLatestReadyExtension) == 0;
+        });
+    }
+
+    bool isFifoLatestReadyModeAdvertised() {
+        uint32_t count = 0;
+        vkGetPhysicalDeviceSurfacePresentModesKHR(mPhysicalDevice, mSurface, &count, nullptr);
+        std::vector<VkPresentModeKHR> modes(count);
+        vkGetPhysicalDeviceSurfacePresentModesKHR(mPhysicalDevice, mSurface, &count, modes.data());
+        return std::find(modes.begin(), modes.end(), kFifoLatestReadyMode) != modes.end();
+    }
+
+    void createDevice(bool enableFifoLatestReady) {
+        const float priority = 1.f;
+        VkDeviceQueueCreateInfo queueInfo = {};
+        queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queueInfo.queueCount = 1;
+        queueInfo.pQueuePriorities = &priority;
+
+        std::vector<const char*> extensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+        if (enableFifoLatestReady) extensions.push_back(kFifoLatestReadyExtension);
+        VkDeviceCreateInfo deviceInfo = {};
+        deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        deviceInfo.queueCreateInfoCount = 1;
+        deviceInfo.pQueueCreateInfos = &queueInfo;
+        deviceInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+        deviceInfo.ppEnabledExtensionNames = extensions.data();
+        ASSERT_EQ(VK_SUCCESS, vkCreateDevice(mPhysicalDevice, &deviceInfo, nullptr, &mDevice));
+    }
+
+    VkResult createSwapchain(VkPresentModeKHR presentMode, VkSwapchainKHR* swapchain) {
+        VkSurfaceCapabilitiesKHR caps;
+        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(mPhysicalDevice, mSurface, &caps);
+
+        VkSwapchainCreateInfoKHR info = {};
+        info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+        info.surface = mSurface;
+        info.minImageCount = caps.minImageCount;
+        info.imageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+        info.imageColorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+        info.imageExtent = {64, 64};
+        info.imageArrayLayers = 1;
+        info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        info.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        info.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+        info.compositeAlpha = VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR;
+        info.presentMode = presentMode;
+        info.clipped = VK_TRUE;
+        return vkCreateSwapchainKHR(mDevice, &info, nullptr, swapchain);
+    }
+
+    VkInstance mInstance = VK_NULL_HANDLE;
+    VkPhysicalDevice mPhysicalDevice = VK_NULL_HANDLE;
+    VkSurfaceKHR mSurface = VK_NULL_HANDLE;
+    VkDevice mDevice = VK_NULL_HANDLE;
+    sp<BufferItemConsumer> mConsumer;
+    sp<Surface> mWindow;
+};
+
+TEST_F(SwapchainTest, FifoLatestReadyModeIsAdvertisedWithItsExtension) {
+    EXPECT_EQ(isFifoLatestReadyExtensionAdvertised(), isFifoLatestReadyModeAdvertised());
+}
+
+TEST_F(SwapchainTest, FifoLatestReadyRequiresItsExtension) {
+    ASSERT_NO_FATAL_FAILURE(createDevice(false));
+
+    VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+    EXPECT_EQ(VK_ERROR_INITIALIZATION_FAILED, createSwapchain(kFifoLatestReadyMode, &swapchain));
+}
+
+TEST_F(SwapchainTest, CanCreateFifoLatestReadySwapchain) {
+    if (!isFifoLatestReadyExtensionAdvertised()) {
+        GTEST_SKIP() << kFifoLatestReadyExtension << " is not supported";
+    }
+    ASSERT_NO_FATAL_FAILURE(createDevice(true));
+
+    VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+    ASSERT_EQ(VK_SUCCESS, createSwapchain(kFifoLatestReadyMode, &swapchain));
+    vkDestroySwapchainKHR(mDevice, swapchain, nullptr);
+}
+
+} // namespace
+} // namespace android
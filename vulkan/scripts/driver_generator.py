@@ -37,6 +37,7 @@ _INTERCEPTED_EXTENSIONS = [
     'VK_KHR_swapchain',
     'VK_EXT_swapchain_maintenance1',
     'VK_EXT_surface_maintenance1',
+    'VK_EXT_present_mode_fifo_latest_ready',
 ]
 
 # Extensions known to vulkan::driver level.
@@ -118,6 +119,13 @@ _NEEDED_COMMANDS = [
 
     # VK_KHR_swapchain_maintenance1 requirement
     'vkImportFenceFdKHR',
+
+    # Implicit pipeline cache
+    'vkCreatePipelineCache',
+    'vkDestroyPipelineCache',
+    'vkGetPipelineCacheData',
+    'vkCreateGraphicsPipelines',
+    'vkCreateComputePipelines',
 ]
 
 # Functions intercepted at vulkan::driver level.
@@ -144,6 +152,11 @@ _INTERCEPTED_COMMANDS = [
 
     'vkQueueSubmit',
 
+    # Implicit pipeline cache
+    'vkCreatePipelineCache',
+    'vkCreateGraphicsPipelines',
+    'vkCreateComputePipelines',
+
     # VK_KHR_swapchain v69 requirement
     'vkBindImageMemory2',
     'vkBindImageMemory2KHR',